@@ -35,21 +35,59 @@
 #include "cperf_ops.h"
 #include "cperf_test_vectors.h"
 
+/* Transforms of session-less operations: cipher, auth and AEAD */
+static struct rte_crypto_sym_xform sessionless_xforms[3];
+static struct rte_crypto_sym_xform *sessionless_xform;
+
+static inline void
+cperf_attach_session(struct rte_crypto_op *op,
+		struct rte_cryptodev_sym_session *sess,
+		const struct cperf_options *options)
+{
+	if (options->sessionless) {
+		op->sess_type = RTE_CRYPTO_OP_SESSIONLESS;
+		op->sym->xform = sessionless_xform;
+	} else
+		rte_crypto_op_attach_sym_session(op, sess);
+}
+
+/*
+ * Return the buffer size of the next operation: the fixed test buffer size,
+ * or the next entry of the IMIX size table if a distribution was given.
+ */
+static inline uint32_t
+cperf_next_buffer_size(const struct cperf_options *options,
+		uint32_t *imix_idx)
+{
+	uint32_t buffer_size;
+
+	if (options->imix_distribution_count == 0)
+		return options->test_buffer_size;
+
+	buffer_size = options->imix_buffer_sizes[*imix_idx];
+	if (++(*imix_idx) == options->pool_sz)
+		*imix_idx = 0;
+
+	return buffer_size;
+}
+
 static int
 cperf_set_ops_null_cipher(struct rte_crypto_op **ops,
 		uint32_t src_buf_offset, uint32_t dst_buf_offset,
 		uint16_t nb_ops, struct rte_cryptodev_sym_session *sess,
 		const struct cperf_options *options,
 		const struct cperf_test_vector *test_vector __rte_unused,
-		uint16_t iv_offset __rte_unused)
+		uint16_t iv_offset __rte_unused, uint32_t *imix_idx)
 {
 	uint16_t i;
 
 	for (i = 0; i < nb_ops; i++) {
 		struct rte_crypto_sym_op *sym_op = ops[i]->sym;
+		uint32_t buffer_size = cperf_next_buffer_size(options,
+				imix_idx);
 
 		ops[i]->status = RTE_CRYPTO_OP_STATUS_NOT_PROCESSED;
-		rte_crypto_op_attach_sym_session(ops[i], sess);
+		cperf_attach_session(ops[i], sess, options);
 
 		sym_op->m_src = (struct rte_mbuf *)((uint8_t *)ops[i] +
 							src_buf_offset);
@@ -62,7 +100,7 @@ cperf_set_ops_null_cipher(struct rte_crypto_op **ops,
 							dst_buf_offset);
 
 		/* cipher parameters */
-		sym_op->cipher.data.length = options->test_buffer_size;
+		sym_op->cipher.data.length = buffer_size;
 		sym_op->cipher.data.offset = 0;
 	}
 
@@ -75,15 +113,17 @@ cperf_set_ops_null_auth(struct rte_crypto_op **ops,
 		uint16_t nb_ops, struct rte_cryptodev_sym_session *sess,
 		const struct cperf_options *options,
 		const struct cperf_test_vector *test_vector __rte_unused,
-		uint16_t iv_offset __rte_unused)
+		uint16_t iv_offset __rte_unused, uint32_t *imix_idx)
 {
 	uint16_t i;
 
 	for (i = 0; i < nb_ops; i++) {
 		struct rte_crypto_sym_op *sym_op = ops[i]->sym;
+		uint32_t buffer_size = cperf_next_buffer_size(options,
+				imix_idx);
 
 		ops[i]->status = RTE_CRYPTO_OP_STATUS_NOT_PROCESSED;
-		rte_crypto_op_attach_sym_session(ops[i], sess);
+		cperf_attach_session(ops[i], sess, options);
 
 		sym_op->m_src = (struct rte_mbuf *)((uint8_t *)ops[i] +
 							src_buf_offset);
@@ -96,7 +136,7 @@ cperf_set_ops_null_auth(struct rte_crypto_op **ops,
 							dst_buf_offset);
 
 		/* auth parameters */
-		sym_op->auth.data.length = options->test_buffer_size;
+		sym_op->auth.data.length = buffer_size;
 		sym_op->auth.data.offset = 0;
 	}
 
@@ -109,15 +149,17 @@ cperf_set_ops_cipher(struct rte_crypto_op **ops,
 		uint16_t nb_ops, struct rte_cryptodev_sym_session *sess,
 		const struct cperf_options *options,
 		const struct cperf_test_vector *test_vector,
-		uint16_t iv_offset)
+		uint16_t iv_offset, uint32_t *imix_idx)
 {
 	uint16_t i;
 
 	for (i = 0; i < nb_ops; i++) {
 		struct rte_crypto_sym_op *sym_op = ops[i]->sym;
+		uint32_t buffer_size = cperf_next_buffer_size(options,
+				imix_idx);
 
 		ops[i]->status = RTE_CRYPTO_OP_STATUS_NOT_PROCESSED;
-		rte_crypto_op_attach_sym_session(ops[i], sess);
+		cperf_attach_session(ops[i], sess, options);
 
 		sym_op->m_src = (struct rte_mbuf *)((uint8_t *)ops[i] +
 							src_buf_offset);
@@ -133,9 +175,9 @@ cperf_set_ops_cipher(struct rte_crypto_op **ops,
 		if (options->cipher_algo == RTE_CRYPTO_CIPHER_SNOW3G_UEA2 ||
 				options->cipher_algo == RTE_CRYPTO_CIPHER_KASUMI_F8 ||
 				options->cipher_algo == RTE_CRYPTO_CIPHER_ZUC_EEA3)
-			sym_op->cipher.data.length = options->test_buffer_size << 3;
+			sym_op->cipher.data.length = buffer_size << 3;
 		else
-			sym_op->cipher.data.length = options->test_buffer_size;
+			sym_op->cipher.data.length = buffer_size;
 
 		sym_op->cipher.data.offset = 0;
 	}
@@ -160,15 +202,17 @@ cperf_set_ops_auth(struct rte_crypto_op **ops,
 		uint16_t nb_ops, struct rte_cryptodev_sym_session *sess,
 		const struct cperf_options *options,
 		const struct cperf_test_vector *test_vector,
-		uint16_t iv_offset)
+		uint16_t iv_offset, uint32_t *imix_idx)
 {
 	uint16_t i;
 
 	for (i = 0; i < nb_ops; i++) {
 		struct rte_crypto_sym_op *sym_op = ops[i]->sym;
+		uint32_t buffer_size = cperf_next_buffer_size(options,
+				imix_idx);
 
 		ops[i]->status = RTE_CRYPTO_OP_STATUS_NOT_PROCESSED;
-		rte_crypto_op_attach_sym_session(ops[i], sess);
+		cperf_attach_session(ops[i], sess, options);
 
 		sym_op->m_src = (struct rte_mbuf *)((uint8_t *)ops[i] +
 							src_buf_offset);
@@ -195,7 +239,7 @@ cperf_set_ops_auth(struct rte_crypto_op **ops,
 					test_vector->digest.phys_addr;
 		} else {
 
-			uint32_t offset = options->test_buffer_size;
+			uint32_t offset = buffer_size;
 			struct rte_mbuf *buf, *tbuf;
 
 			if (options->out_of_place) {
@@ -228,9 +272,9 @@ cperf_set_ops_auth(struct rte_crypto_op **ops,
 		if (options->auth_algo == RTE_CRYPTO_AUTH_SNOW3G_UIA2 ||
 				options->auth_algo == RTE_CRYPTO_AUTH_KASUMI_F9 ||
 				options->auth_algo == RTE_CRYPTO_AUTH_ZUC_EIA3)
-			sym_op->auth.data.length = options->test_buffer_size << 3;
+			sym_op->auth.data.length = buffer_size << 3;
 		else
-			sym_op->auth.data.length = options->test_buffer_size;
+			sym_op->auth.data.length = buffer_size;
 
 		sym_op->auth.data.offset = 0;
 	}
@@ -255,15 +299,17 @@ cperf_set_ops_cipher_auth(struct rte_crypto_op **ops,
 		uint16_t nb_ops, struct rte_cryptodev_sym_session *sess,
 		const struct cperf_options *options,
 		const struct cperf_test_vector *test_vector,
-		uint16_t iv_offset)
+		uint16_t iv_offset, uint32_t *imix_idx)
 {
 	uint16_t i;
 
 	for (i = 0; i < nb_ops; i++) {
 		struct rte_crypto_sym_op *sym_op = ops[i]->sym;
+		uint32_t buffer_size = cperf_next_buffer_size(options,
+				imix_idx);
 
 		ops[i]->status = RTE_CRYPTO_OP_STATUS_NOT_PROCESSED;
-		rte_crypto_op_attach_sym_session(ops[i], sess);
+		cperf_attach_session(ops[i], sess, options);
 
 		sym_op->m_src = (struct rte_mbuf *)((uint8_t *)ops[i] +
 							src_buf_offset);
@@ -279,9 +325,9 @@ cperf_set_ops_cipher_auth(struct rte_crypto_op **ops,
 		if (options->cipher_algo == RTE_CRYPTO_CIPHER_SNOW3G_UEA2 ||
 				options->cipher_algo == RTE_CRYPTO_CIPHER_KASUMI_F8 ||
 				options->cipher_algo == RTE_CRYPTO_CIPHER_ZUC_EEA3)
-			sym_op->cipher.data.length = options->test_buffer_size << 3;
+			sym_op->cipher.data.length = buffer_size << 3;
 		else
-			sym_op->cipher.data.length = options->test_buffer_size;
+			sym_op->cipher.data.length = buffer_size;
 
 		sym_op->cipher.data.offset = 0;
 
@@ -292,7 +338,7 @@ cperf_set_ops_cipher_auth(struct rte_crypto_op **ops,
 					test_vector->digest.phys_addr;
 		} else {
 
-			uint32_t offset = options->test_buffer_size;
+			uint32_t offset = buffer_size;
 			struct rte_mbuf *buf, *tbuf;
 
 			if (options->out_of_place) {
@@ -324,9 +370,9 @@ cperf_set_ops_cipher_auth(struct rte_crypto_op **ops,
 		if (options->auth_algo == RTE_CRYPTO_AUTH_SNOW3G_UIA2 ||
 				options->auth_algo == RTE_CRYPTO_AUTH_KASUMI_F9 ||
 				options->auth_algo == RTE_CRYPTO_AUTH_ZUC_EIA3)
-			sym_op->auth.data.length = options->test_buffer_size << 3;
+			sym_op->auth.data.length = buffer_size << 3;
 		else
-			sym_op->auth.data.length = options->test_buffer_size;
+			sym_op->auth.data.length = buffer_size;
 
 		sym_op->auth.data.offset = 0;
 	}
@@ -360,7 +406,7 @@ cperf_set_ops_aead(struct rte_crypto_op **ops,
 		uint16_t nb_ops, struct rte_cryptodev_sym_session *sess,
 		const struct cperf_options *options,
 		const struct cperf_test_vector *test_vector,
-		uint16_t iv_offset)
+		uint16_t iv_offset, uint32_t *imix_idx)
 {
 	uint16_t i;
 	/* AAD is placed after the IV */
@@ -369,9 +415,11 @@ cperf_set_ops_aead(struct rte_crypto_op **ops,
 
 	for (i = 0; i < nb_ops; i++) {
 		struct rte_crypto_sym_op *sym_op = ops[i]->sym;
+		uint32_t buffer_size = cperf_next_buffer_size(options,
+				imix_idx);
 
 		ops[i]->status = RTE_CRYPTO_OP_STATUS_NOT_PROCESSED;
-		rte_crypto_op_attach_sym_session(ops[i], sess);
+		cperf_attach_session(ops[i], sess, options);
 
 		sym_op->m_src = (struct rte_mbuf *)((uint8_t *)ops[i] +
 							src_buf_offset);
@@ -384,7 +432,7 @@ cperf_set_ops_aead(struct rte_crypto_op **ops,
 							dst_buf_offset);
 
 		/* AEAD parameters */
-		sym_op->aead.data.length = options->test_buffer_size;
+		sym_op->aead.data.length = buffer_size;
 		sym_op->aead.data.offset = 0;
 
 		sym_op->aead.aad.data = rte_crypto_op_ctod_offset(ops[i],
@@ -460,72 +508,64 @@ cperf_set_ops_aead(struct rte_crypto_op **ops,
 	return 0;
 }
 
-static struct rte_cryptodev_sym_session *
-cperf_create_session(struct rte_mempool *sess_mp,
-	uint8_t dev_id,
+/* Set up the transforms of the test, returns the first one of the chain */
+static struct rte_crypto_sym_xform *
+cperf_set_xforms(struct rte_crypto_sym_xform *cipher_xform,
+	struct rte_crypto_sym_xform *auth_xform,
+	struct rte_crypto_sym_xform *aead_xform,
 	const struct cperf_options *options,
 	const struct cperf_test_vector *test_vector,
 	uint16_t iv_offset)
 {
-	struct rte_crypto_sym_xform cipher_xform;
-	struct rte_crypto_sym_xform auth_xform;
-	struct rte_crypto_sym_xform aead_xform;
-	struct rte_cryptodev_sym_session *sess = NULL;
-
-	sess = rte_cryptodev_sym_session_create(sess_mp);
 	/*
 	 * cipher only
 	 */
 	if (options->op_type == CPERF_CIPHER_ONLY) {
-		cipher_xform.type = RTE_CRYPTO_SYM_XFORM_CIPHER;
-		cipher_xform.next = NULL;
-		cipher_xform.cipher.algo = options->cipher_algo;
-		cipher_xform.cipher.op = options->cipher_op;
-		cipher_xform.cipher.iv.offset = iv_offset;
+		cipher_xform->type = RTE_CRYPTO_SYM_XFORM_CIPHER;
+		cipher_xform->next = NULL;
+		cipher_xform->cipher.algo = options->cipher_algo;
+		cipher_xform->cipher.op = options->cipher_op;
+		cipher_xform->cipher.iv.offset = iv_offset;
 
 		/* cipher different than null */
 		if (options->cipher_algo != RTE_CRYPTO_CIPHER_NULL) {
-			cipher_xform.cipher.key.data =
+			cipher_xform->cipher.key.data =
 					test_vector->cipher_key.data;
-			cipher_xform.cipher.key.length =
+			cipher_xform->cipher.key.length =
 					test_vector->cipher_key.length;
-			cipher_xform.cipher.iv.length =
+			cipher_xform->cipher.iv.length =
 					test_vector->cipher_iv.length;
 		} else {
-			cipher_xform.cipher.key.data = NULL;
-			cipher_xform.cipher.key.length = 0;
-			cipher_xform.cipher.iv.length = 0;
+			cipher_xform->cipher.key.data = NULL;
+			cipher_xform->cipher.key.length = 0;
+			cipher_xform->cipher.iv.length = 0;
 		}
-		/* create crypto session */
-		rte_cryptodev_sym_session_init(dev_id, sess, &cipher_xform,
-				sess_mp);
+		return cipher_xform;
 	/*
 	 *  auth only
 	 */
 	} else if (options->op_type == CPERF_AUTH_ONLY) {
-		auth_xform.type = RTE_CRYPTO_SYM_XFORM_AUTH;
-		auth_xform.next = NULL;
-		auth_xform.auth.algo = options->auth_algo;
-		auth_xform.auth.op = options->auth_op;
+		auth_xform->type = RTE_CRYPTO_SYM_XFORM_AUTH;
+		auth_xform->next = NULL;
+		auth_xform->auth.algo = options->auth_algo;
+		auth_xform->auth.op = options->auth_op;
 
 		/* auth different than null */
 		if (options->auth_algo != RTE_CRYPTO_AUTH_NULL) {
-			auth_xform.auth.digest_length =
+			auth_xform->auth.digest_length =
 					options->digest_sz;
-			auth_xform.auth.key.length =
+			auth_xform->auth.key.length =
 					test_vector->auth_key.length;
-			auth_xform.auth.key.data = test_vector->auth_key.data;
-			auth_xform.auth.iv.length =
+			auth_xform->auth.key.data = test_vector->auth_key.data;
+			auth_xform->auth.iv.length =
 					test_vector->auth_iv.length;
 		} else {
-			auth_xform.auth.digest_length = 0;
-			auth_xform.auth.key.length = 0;
-			auth_xform.auth.key.data = NULL;
-			auth_xform.auth.iv.length = 0;
+			auth_xform->auth.digest_length = 0;
+			auth_xform->auth.key.length = 0;
+			auth_xform->auth.key.data = NULL;
+			auth_xform->auth.iv.length = 0;
 		}
-		/* create crypto session */
-		rte_cryptodev_sym_session_init(dev_id, sess, &auth_xform,
-				sess_mp);
+		return auth_xform;
 	/*
 	 * cipher and auth
 	 */
@@ -534,82 +574,104 @@ cperf_create_session(struct rte_mempool *sess_mp,
 		/*
 		 * cipher
 		 */
-		cipher_xform.type = RTE_CRYPTO_SYM_XFORM_CIPHER;
-		cipher_xform.next = NULL;
-		cipher_xform.cipher.algo = options->cipher_algo;
-		cipher_xform.cipher.op = options->cipher_op;
-		cipher_xform.cipher.iv.offset = iv_offset;
+		cipher_xform->type = RTE_CRYPTO_SYM_XFORM_CIPHER;
+		cipher_xform->next = NULL;
+		cipher_xform->cipher.algo = options->cipher_algo;
+		cipher_xform->cipher.op = options->cipher_op;
+		cipher_xform->cipher.iv.offset = iv_offset;
 
 		/* cipher different than null */
 		if (options->cipher_algo != RTE_CRYPTO_CIPHER_NULL) {
-			cipher_xform.cipher.key.data =
+			cipher_xform->cipher.key.data =
 					test_vector->cipher_key.data;
-			cipher_xform.cipher.key.length =
+			cipher_xform->cipher.key.length =
 					test_vector->cipher_key.length;
-			cipher_xform.cipher.iv.length =
+			cipher_xform->cipher.iv.length =
 					test_vector->cipher_iv.length;
 		} else {
-			cipher_xform.cipher.key.data = NULL;
-			cipher_xform.cipher.key.length = 0;
-			cipher_xform.cipher.iv.length = 0;
+			cipher_xform->cipher.key.data = NULL;
+			cipher_xform->cipher.key.length = 0;
+			cipher_xform->cipher.iv.length = 0;
 		}
 
 		/*
 		 * auth
 		 */
-		auth_xform.type = RTE_CRYPTO_SYM_XFORM_AUTH;
-		auth_xform.next = NULL;
-		auth_xform.auth.algo = options->auth_algo;
-		auth_xform.auth.op = options->auth_op;
+		auth_xform->type = RTE_CRYPTO_SYM_XFORM_AUTH;
+		auth_xform->next = NULL;
+		auth_xform->auth.algo = options->auth_algo;
+		auth_xform->auth.op = options->auth_op;
 
 		/* auth different than null */
 		if (options->auth_algo != RTE_CRYPTO_AUTH_NULL) {
-			auth_xform.auth.digest_length = options->digest_sz;
-			auth_xform.auth.iv.length = test_vector->auth_iv.length;
-			auth_xform.auth.key.length =
+			auth_xform->auth.digest_length = options->digest_sz;
+			auth_xform->auth.iv.length =
+					test_vector->auth_iv.length;
+			auth_xform->auth.key.length =
 					test_vector->auth_key.length;
-			auth_xform.auth.key.data =
+			auth_xform->auth.key.data =
 					test_vector->auth_key.data;
 		} else {
-			auth_xform.auth.digest_length = 0;
-			auth_xform.auth.key.length = 0;
-			auth_xform.auth.key.data = NULL;
-			auth_xform.auth.iv.length = 0;
+			auth_xform->auth.digest_length = 0;
+			auth_xform->auth.key.length = 0;
+			auth_xform->auth.key.data = NULL;
+			auth_xform->auth.iv.length = 0;
 		}
 
 		/* cipher then auth */
 		if (options->op_type == CPERF_CIPHER_THEN_AUTH) {
-			cipher_xform.next = &auth_xform;
-			/* create crypto session */
-			rte_cryptodev_sym_session_init(dev_id,
-					sess, &cipher_xform, sess_mp);
-		} else { /* auth then cipher */
-			auth_xform.next = &cipher_xform;
-			/* create crypto session */
-			rte_cryptodev_sym_session_init(dev_id,
-					sess, &auth_xform, sess_mp);
+			cipher_xform->next = auth_xform;
+			return cipher_xform;
 		}
+		/* auth then cipher */
+		auth_xform->next = cipher_xform;
+		return auth_xform;
 	} else { /* options->op_type == CPERF_AEAD */
-		aead_xform.type = RTE_CRYPTO_SYM_XFORM_AEAD;
-		aead_xform.next = NULL;
-		aead_xform.aead.algo = options->aead_algo;
-		aead_xform.aead.op = options->aead_op;
-		aead_xform.aead.iv.offset = iv_offset;
+		aead_xform->type = RTE_CRYPTO_SYM_XFORM_AEAD;
+		aead_xform->next = NULL;
+		aead_xform->aead.algo = options->aead_algo;
+		aead_xform->aead.op = options->aead_op;
+		aead_xform->aead.iv.offset = iv_offset;
 
-		aead_xform.aead.key.data =
+		aead_xform->aead.key.data =
 					test_vector->aead_key.data;
-		aead_xform.aead.key.length =
+		aead_xform->aead.key.length =
 					test_vector->aead_key.length;
-		aead_xform.aead.iv.length = test_vector->aead_iv.length;
+		aead_xform->aead.iv.length = test_vector->aead_iv.length;
 
-		aead_xform.aead.digest_length = options->digest_sz;
-		aead_xform.aead.aad_length =
+		aead_xform->aead.digest_length = options->digest_sz;
+		aead_xform->aead.aad_length =
 					options->aead_aad_sz;
 
-		/* Create crypto session */
-		rte_cryptodev_sym_session_init(dev_id,
-					sess, &aead_xform, sess_mp);
+		return aead_xform;
 	}
+}
+
+static struct rte_cryptodev_sym_session *
+cperf_create_session(struct rte_mempool *sess_mp,
+	uint8_t dev_id,
+	const struct cperf_options *options,
+	const struct cperf_test_vector *test_vector,
+	uint16_t iv_offset)
+{
+	struct rte_crypto_sym_xform cipher_xform;
+	struct rte_crypto_sym_xform auth_xform;
+	struct rte_crypto_sym_xform aead_xform;
+	struct rte_cryptodev_sym_session *sess = NULL;
+
+	sess = rte_cryptodev_sym_session_create(sess_mp);
+	/* create crypto session */
+	rte_cryptodev_sym_session_init(dev_id, sess,
+			cperf_set_xforms(&cipher_xform, &auth_xform,
+				&aead_xform, options, test_vector, iv_offset),
+			sess_mp);
+
+	/* session-less ops all share one read-only transform chain */
+	if (options->sessionless)
+		sessionless_xform = cperf_set_xforms(
+				&sessionless_xforms[0], &sessionless_xforms[1],
+				&sessionless_xforms[2], options, test_vector,
+				iv_offset);
 
 	return sess;
 }
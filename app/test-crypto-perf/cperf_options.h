@@ -41,6 +41,8 @@
 
 #define CPERF_CSV		("csv-friendly")
 
+#define CPERF_IMIX		("imix")
+
 /* benchmark-specific options */
 #define CPERF_PMDCC_DELAY_MS	("pmd-cyclecount-delay-ms")
 
@@ -120,6 +122,11 @@ struct cperf_options {
 	uint32_t min_burst_size;
 	uint32_t inc_burst_size;
 
+	/* IMIX: per-size weights and the per-op size table built from them */
+	uint32_t imix_distribution_list[MAX_LIST];
+	uint8_t imix_distribution_count;
+	uint32_t *imix_buffer_sizes;
+
 	/* pmd-cyclecount specific options */
 	uint32_t pmdcc_delay;
 };
@@ -83,6 +83,8 @@ usage(char *progname)
 		" --pmd-cyclecount-delay-ms N: set delay between enqueue\n"
 		"           and dequeue in pmd-cyclecount benchmarking mode\n"
 		" --csv-friendly: enable test result output CSV friendly\n"
+		" --imix W1,W2,...: run a mix of the --buffer-sz list sizes,\n"
+		"           each with the given relative weight\n"
 		" -h: prints this help\n",
 		progname);
 }
@@ -368,6 +370,22 @@ parse_buffer_sz(struct cperf_options *opts, const char *arg)
 	return 0;
 }
 
+static int
+parse_imix(struct cperf_options *opts, const char *arg)
+{
+	uint32_t min, max;
+	int ret;
+
+	ret = parse_list(arg, opts->imix_distribution_list, &min, &max);
+	if (ret < 0) {
+		RTE_LOG(ERR, USER1, "failed to parse imix distribution\n");
+		return -1;
+	}
+	opts->imix_distribution_count = ret;
+
+	return 0;
+}
+
 static int
 parse_segment_sz(struct cperf_options *opts, const char *arg)
 {
@@ -754,6 +772,8 @@ static struct option lgopts[] = {
 
 	{ CPERF_CSV, no_argument, 0, 0},
 
+	{ CPERF_IMIX, required_argument, 0, 0 },
+
 	{ CPERF_PMDCC_DELAY_MS, required_argument, 0, 0 },
 
 	{ NULL, 0, 0, 0 }
@@ -780,6 +800,9 @@ cperf_options_default(struct cperf_options *opts)
 	opts->min_burst_size = 32;
 	opts->inc_burst_size = 0;
 
+	opts->imix_distribution_count = 0;
+	opts->imix_buffer_sizes = NULL;
+
 	/*
 	 * Will be parsed from command line or set to
 	 * maximum buffer size + digest, later
@@ -852,6 +875,7 @@ cperf_opts_parse_long(int opt_idx, struct cperf_options *opts)
 		{ CPERF_AEAD_AAD_SZ,	parse_aead_aad_sz },
 		{ CPERF_DIGEST_SZ,	parse_digest_sz },
 		{ CPERF_CSV,		parse_csv_friendly},
+		{ CPERF_IMIX,		parse_imix},
 		{ CPERF_PMDCC_DELAY_MS,	parse_pmd_cyclecount_delay_ms},
 	};
 	unsigned int i;
@@ -1017,6 +1041,23 @@ cperf_options_check(struct cperf_options *options)
 		return -EINVAL;
 	}
 
+	if (options->imix_distribution_count != 0) {
+		if (options->test != CPERF_TEST_TYPE_THROUGHPUT &&
+				options->test != CPERF_TEST_TYPE_LATENCY) {
+			RTE_LOG(ERR, USER1, "IMIX is only supported by the "
+					"throughput and latency tests.\n");
+			return -EINVAL;
+		}
+
+		if (options->inc_buffer_size != 0 ||
+				options->imix_distribution_count !=
+				options->buffer_size_count) {
+			RTE_LOG(ERR, USER1, "IMIX needs one percentage per "
+					"buffer size of a buffer size list.\n");
+			return -EINVAL;
+		}
+	}
+
 	if (options->test == CPERF_TEST_TYPE_PMDCC &&
 			options->pool_sz < options->nb_descriptors) {
 		RTE_LOG(ERR, USER1, "For pmd cyclecount benchmarks, pool size "
@@ -1075,6 +1116,13 @@ cperf_options_dump(struct cperf_options *opts)
 			printf("%u ", opts->buffer_size_list[size_idx]);
 		printf("\n");
 	}
+	if (opts->imix_distribution_count != 0) {
+		printf("# imix distribution: ");
+		for (size_idx = 0; size_idx < opts->imix_distribution_count;
+				size_idx++)
+			printf("%u ", opts->imix_distribution_list[size_idx]);
+		printf("\n");
+	}
 	if (opts->inc_burst_size != 0) {
 		printf("# burst size:\n");
 		printf("#\t min: %u\n", opts->min_burst_size);
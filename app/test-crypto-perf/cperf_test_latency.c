@@ -195,6 +195,7 @@ cperf_latency_test_runner(void *arg)
 	uint16_t iv_offset = sizeof(struct rte_crypto_op) +
 		sizeof(struct rte_crypto_sym_op) +
 		sizeof(struct cperf_op_result *);
+	uint32_t imix_idx = 0;
 
 	while (test_burst_size <= ctx->options->max_burst_size) {
 		uint64_t ops_enqd = 0, ops_deqd = 0;
@@ -228,7 +229,7 @@ cperf_latency_test_runner(void *arg)
 			(ctx->populate_ops)(ops, ctx->src_buf_offset,
 					ctx->dst_buf_offset,
 					burst_size, ctx->sess, ctx->options,
-					ctx->test_vector, iv_offset);
+					ctx->test_vector, iv_offset, &imix_idx);
 
 			tsc_start = rte_rdtsc_precise();
 
@@ -76,6 +76,7 @@ struct pmd_cyclecount_state {
 	uint32_t ops_deqd;
 	uint32_t ops_enq_retries;
 	uint32_t ops_deq_retries;
+	uint32_t imix_idx;
 	double cycles_per_build;
 	double cycles_per_enq;
 	double cycles_per_deq;
@@ -193,7 +194,8 @@ pmd_cyclecount_bench_ops(struct pmd_cyclecount_state *state, uint32_t cur_op,
 				state->ctx->dst_buf_offset,
 				burst_size,
 				state->ctx->sess, state->opts,
-				state->ctx->test_vector, iv_offset);
+				state->ctx->test_vector, iv_offset,
+				&state->imix_idx);
 
 #ifdef CPERF_LINEARIZATION_ENABLE
 		/* Check if source mbufs require coalescing */
@@ -242,7 +244,8 @@ pmd_cyclecount_build_ops(struct pmd_cyclecount_state *state,
 				state->ctx->dst_buf_offset,
 				burst_size,
 				state->ctx->sess, state->opts,
-				state->ctx->test_vector, iv_offset);
+				state->ctx->test_vector, iv_offset,
+				&state->imix_idx);
 	}
 	return 0;
 }
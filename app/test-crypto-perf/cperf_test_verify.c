@@ -291,6 +291,7 @@ cperf_verify_test_runner(void *test_ctx)
 
 	uint16_t iv_offset = sizeof(struct rte_crypto_op) +
 		sizeof(struct rte_crypto_sym_op);
+	uint32_t imix_idx = 0;
 
 	while (ops_enqd_total < ctx->options->total_ops) {
 
@@ -317,7 +318,7 @@ cperf_verify_test_runner(void *test_ctx)
 		(ctx->populate_ops)(ops, ctx->src_buf_offset,
 				ctx->dst_buf_offset,
 				ops_needed, ctx->sess, ctx->options,
-				ctx->test_vector, iv_offset);
+				ctx->test_vector, iv_offset, &imix_idx);
 
 
 		/* Populate the mbuf with the test vector, for verification */
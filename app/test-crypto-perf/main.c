@@ -31,6 +31,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 
 #include <rte_eal.h>
@@ -143,8 +144,10 @@ cperf_initialize_cryptodev(struct cperf_options *opts, uint8_t *enabled_cdevs,
 		 * how many will be available for the application.
 		 */
 		if (!strcmp((const char *)opts->device_type, "crypto_scheduler") &&
+				(rte_cryptodev_scheduler_mode_get(cdev_id) ==
+				CDEV_SCHED_MODE_MULTICORE ||
 				rte_cryptodev_scheduler_mode_get(cdev_id) ==
-				CDEV_SCHED_MODE_MULTICORE)
+				CDEV_SCHED_MODE_WORK_STEALING))
 			opts->nb_qps = 1;
 #endif
 
@@ -413,6 +416,51 @@ cperf_check_test_vector(struct cperf_options *opts,
 	return 0;
 }
 
+/*
+ * Build the per-operation buffer size table of an IMIX run: each size of the
+ * buffer size list gets a share of the pool proportional to its weight, and
+ * the table is shuffled so that consecutive operations have mixed sizes.
+ * The test buffer size is set to the average size, which is what the
+ * throughput figures are computed from.
+ */
+static int
+cperf_imix_buffer_sizes_init(struct cperf_options *opts)
+{
+	uint32_t total_weight = 0, nb_sizes = 0, count, i, j, tmp;
+	uint64_t total_size = 0;
+
+	opts->imix_buffer_sizes = malloc(sizeof(uint32_t) * opts->pool_sz);
+	if (opts->imix_buffer_sizes == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < opts->imix_distribution_count; i++)
+		total_weight += opts->imix_distribution_list[i];
+
+	for (i = 0; i < opts->imix_distribution_count; i++) {
+		if (i + 1 == opts->imix_distribution_count)
+			count = opts->pool_sz - nb_sizes;
+		else
+			count = (uint64_t)opts->pool_sz *
+				opts->imix_distribution_list[i] / total_weight;
+
+		for (j = 0; j < count; j++)
+			opts->imix_buffer_sizes[nb_sizes++] =
+				opts->buffer_size_list[i];
+		total_size += (uint64_t)count * opts->buffer_size_list[i];
+	}
+
+	for (i = opts->pool_sz - 1; i > 0; i--) {
+		j = rand() % (i + 1);
+		tmp = opts->imix_buffer_sizes[i];
+		opts->imix_buffer_sizes[i] = opts->imix_buffer_sizes[j];
+		opts->imix_buffer_sizes[j] = tmp;
+	}
+
+	opts->test_buffer_size = total_size / opts->pool_sz;
+
+	return 0;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -455,6 +503,15 @@ main(int argc, char **argv)
 		goto err;
 	}
 
+	if (opts.imix_distribution_count != 0) {
+		ret = cperf_imix_buffer_sizes_init(&opts);
+		if (ret) {
+			RTE_LOG(ERR, USER1,
+					"Failed to build IMIX buffer sizes\n");
+			goto err;
+		}
+	}
+
 	nb_cryptodevs = cperf_initialize_cryptodev(&opts, enabled_cdevs,
 			session_pool_socket);
 
@@ -536,8 +593,13 @@ main(int argc, char **argv)
 		i++;
 	}
 
-	/* Get first size from range or list */
-	if (opts.inc_buffer_size != 0)
+	/*
+	 * Get first size from range or list; an IMIX run is a single pass
+	 * with the average buffer size set up above.
+	 */
+	if (opts.imix_distribution_count != 0)
+		buffer_size_idx = opts.buffer_size_count - 1;
+	else if (opts.inc_buffer_size != 0)
 		opts.test_buffer_size = opts.min_buffer_size;
 	else
 		opts.test_buffer_size = opts.buffer_size_list[0];
@@ -587,6 +649,7 @@ main(int argc, char **argv)
 		rte_cryptodev_stop(enabled_cdevs[i]);
 
 	free_test_vector(t_vec, &opts);
+	free(opts.imix_buffer_sizes);
 
 	printf("\n");
 	return EXIT_SUCCESS;
@@ -609,6 +672,7 @@ main(int argc, char **argv)
 		rte_cryptodev_stop(enabled_cdevs[i]);
 
 	free_test_vector(t_vec, &opts);
+	free(opts.imix_buffer_sizes);
 
 	printf("\n");
 	return EXIT_FAILURE;
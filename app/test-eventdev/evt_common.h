@@ -94,14 +94,16 @@ evt_has_all_types_queue(uint8_t dev_id)
 }
 
 static inline int
-evt_service_setup(uint8_t dev_id)
+evt_service_setup(uint8_t dev_id, uint8_t nb_sched_cores)
 {
 	uint32_t service_id;
 	int32_t core_cnt;
+	int32_t i;
 	unsigned int lcore = 0;
 	uint32_t core_array[RTE_MAX_LCORE];
 	uint8_t cnt;
-	uint8_t min_cnt = UINT8_MAX;
+	uint8_t min_cnt;
+	uint8_t mapped = 0;
 
 	if (evt_has_distributed_sched(dev_id))
 		return 0;
@@ -114,20 +116,36 @@ evt_service_setup(uint8_t dev_id)
 				RTE_MAX_LCORE);
 		if (core_cnt < 0)
 			return -ENOENT;
-		/* Get the core which has least number of services running. */
-		while (core_cnt--) {
-			/* Reset default mapping */
-			rte_service_map_lcore_set(service_id,
-					core_array[core_cnt], 0);
-			cnt = rte_service_lcore_count_services(
-					core_array[core_cnt]);
-			if (cnt < min_cnt) {
-				lcore = core_array[core_cnt];
-				min_cnt = cnt;
+		/* Reset default mapping */
+		for (i = 0; i < core_cnt; i++)
+			if (rte_service_map_lcore_get(service_id,
+					core_array[i]) == 1)
+				rte_service_map_lcore_set(service_id,
+						core_array[i], 0);
+		if (nb_sched_cores > 1 &&
+				!rte_service_probe_capability(service_id,
+					RTE_SERVICE_CAP_MT_SAFE)) {
+			evt_info("scheduler is not MT safe, using one core");
+			nb_sched_cores = 1;
+		}
+		/* Map to the cores which have least number of services. */
+		while (mapped < nb_sched_cores && mapped < core_cnt) {
+			min_cnt = UINT8_MAX;
+			for (i = 0; i < core_cnt; i++) {
+				if (rte_service_map_lcore_get(service_id,
+						core_array[i]) == 1)
+					continue;
+				cnt = rte_service_lcore_count_services(
+						core_array[i]);
+				if (cnt < min_cnt) {
+					lcore = core_array[i];
+					min_cnt = cnt;
+				}
 			}
+			if (rte_service_map_lcore_set(service_id, lcore, 1))
+				return -ENOENT;
+			mapped++;
 		}
-		if (rte_service_map_lcore_set(service_id, lcore, 1))
-			return -ENOENT;
 	}
 	return 0;
 }
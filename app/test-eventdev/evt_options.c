@@ -55,6 +55,7 @@ evt_options_default(struct evt_options *opt)
 	opt->pool_sz = 16 * 1024;
 	opt->wkr_deq_dep = 16;
 	opt->nb_pkts = (1ULL << 26); /* do ~64M packets */
+	opt->nb_sched_cores = 1;
 }
 
 typedef int (*option_parser_t)(struct evt_options *opt,
@@ -139,6 +140,18 @@ evt_parse_nb_pkts(struct evt_options *opt, const char *arg)
 	return ret;
 }
 
+static int
+evt_parse_nb_sched_cores(struct evt_options *opt, const char *arg)
+{
+	int ret;
+
+	ret = parser_read_uint8(&(opt->nb_sched_cores), arg);
+	if (ret == 0 && opt->nb_sched_cores == 0)
+		ret = -EINVAL;
+
+	return ret;
+}
+
 static int
 evt_parse_pool_sz(struct evt_options *opt, const char *arg)
 {
@@ -189,6 +202,8 @@ usage(char *program)
 		"\t--worker_deq_depth : dequeue depth of the worker\n"
 		"\t--fwd_latency      : perform fwd_latency measurement\n"
 		"\t--queue_priority   : enable queue priority\n"
+		"\t--nb_sched_cores   : number of service cores running the\n"
+		"\t                     scheduler, needs an MT safe scheduler\n"
 		);
 	printf("available tests:\n");
 	evt_test_dump_names();
@@ -249,6 +264,7 @@ static struct option lgopts[] = {
 	{ EVT_SCHED_TYPE_LIST,  1, 0, 0 },
 	{ EVT_FWD_LATENCY,      0, 0, 0 },
 	{ EVT_QUEUE_PRIORITY,   0, 0, 0 },
+	{ EVT_NB_SCHED_CORES,   1, 0, 0 },
 	{ EVT_HELP,             0, 0, 0 },
 	{ NULL,                 0, 0, 0 }
 };
@@ -272,6 +288,7 @@ evt_opts_parse_long(int opt_idx, struct evt_options *opt)
 		{ EVT_SCHED_TYPE_LIST, evt_parse_sched_type_list},
 		{ EVT_FWD_LATENCY, evt_parse_fwd_latency},
 		{ EVT_QUEUE_PRIORITY, evt_parse_queue_priority},
+		{ EVT_NB_SCHED_CORES, evt_parse_nb_sched_cores},
 	};
 
 	for (i = 0; i < RTE_DIM(parsermap); i++) {
@@ -58,6 +58,7 @@
 #define EVT_SCHED_TYPE_LIST      ("stlist")
 #define EVT_FWD_LATENCY          ("fwd_latency")
 #define EVT_QUEUE_PRIORITY       ("queue_priority")
+#define EVT_NB_SCHED_CORES       ("nb_sched_cores")
 #define EVT_HELP                 ("help")
 
 struct evt_options {
@@ -74,6 +75,7 @@ struct evt_options {
 	uint64_t nb_pkts;
 	uint16_t wkr_deq_dep;
 	uint8_t dev_id;
+	uint8_t nb_sched_cores;
 	uint32_t fwd_latency:1;
 	uint32_t q_priority:1;
 };
@@ -222,6 +224,12 @@ evt_dump_worker_dequeue_depth(struct evt_options *opt)
 	evt_dump("worker deq depth", "%d", opt->wkr_deq_dep);
 }
 
+static inline void
+evt_dump_nb_sched_cores(struct evt_options *opt)
+{
+	evt_dump("nb_sched_cores", "%d", opt->nb_sched_cores);
+}
+
 static inline void
 evt_dump_nb_stages(struct evt_options *opt)
 {
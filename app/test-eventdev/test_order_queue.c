@@ -192,7 +192,7 @@ order_queue_eventdev_setup(struct evt_test *test, struct evt_options *opt)
 	if (ret)
 		return ret;
 
-	ret = evt_service_setup(opt->dev_id);
+	ret = evt_service_setup(opt->dev_id, opt->nb_sched_cores);
 	if (ret) {
 		evt_err("No service lcore found to run event dev.");
 		return ret;
@@ -0,0 +1,106 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _OPENSSL_MB_HMAC_H_
+#define _OPENSSL_MB_HMAC_H_
+
+#include <stdint.h>
+
+/**
+ * Multi-buffer HMAC engine of the OPENSSL PMD.
+ *
+ * Hashes up to OPENSSL_MB_HMAC_LANES buffers at once, one buffer per
+ * 32-bit lane of the AVX2 registers. Only the functions of this file are
+ * built with AVX2 enabled, the caller must check the CPU supports it.
+ */
+
+#define OPENSSL_MB_HMAC_LANES		8
+/**< Number of buffers hashed in parallel */
+#define OPENSSL_MB_HMAC_BLOCK_SIZE	64
+/**< Block size of the supported hash functions */
+#define OPENSSL_MB_HMAC_DIGEST_MAX	32
+/**< Longest digest of the supported hash functions */
+
+/** Hash functions of the multi-buffer HMAC engine */
+enum openssl_mb_hmac_algo {
+	OPENSSL_MB_HMAC_SHA1,
+	OPENSSL_MB_HMAC_SHA256,
+};
+
+/** HMAC key, as the hash states after the inner and outer pad blocks */
+struct openssl_mb_hmac_key {
+	uint32_t inner[8];
+	/**< state after the key XOR ipad block */
+	uint32_t outer[8];
+	/**< state after the key XOR opad block */
+};
+
+/** Buffer authenticated by the multi-buffer HMAC engine */
+struct openssl_mb_hmac_job {
+	const uint8_t *src;
+	/**< data to authenticate */
+	uint32_t len;
+	/**< length of the data in bytes */
+	const struct openssl_mb_hmac_key *key;
+	/**< precomputed HMAC key */
+	uint8_t *digest;
+	/**< full length digest output */
+};
+
+/**
+ * Precompute the inner and outer states of an HMAC key.
+ *
+ * @param key	key states to fill
+ * @param algo	hash function
+ * @param data	HMAC key
+ * @param len	HMAC key length in bytes
+ */
+void
+openssl_mb_hmac_key_init(struct openssl_mb_hmac_key *key,
+		enum openssl_mb_hmac_algo algo, const uint8_t *data,
+		uint32_t len);
+
+/**
+ * Authenticate a set of buffers with the same hash function.
+ *
+ * Each job may use its own key and length; lanes finishing early are
+ * masked until the longest buffer is hashed.
+ *
+ * @param algo	hash function
+ * @param jobs	buffers to authenticate
+ * @param nb_jobs	number of jobs, at most OPENSSL_MB_HMAC_LANES
+ */
+void
+openssl_mb_hmac_run(enum openssl_mb_hmac_algo algo,
+		struct openssl_mb_hmac_job *jobs, unsigned int nb_jobs);
+
+#endif /* _OPENSSL_MB_HMAC_H_ */
@@ -0,0 +1,412 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <x86intrin.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+
+#include "openssl_mb_hmac.h"
+
+#define SHA1_DIGEST_WORDS	5
+#define SHA256_DIGEST_WORDS	8
+
+/* Padded to the SHA256 state size to share the state handling */
+static const uint32_t sha1_iv[SHA256_DIGEST_WORDS] = {
+	0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0,
+};
+
+static const uint32_t sha256_iv[SHA256_DIGEST_WORDS] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+	0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static const uint32_t sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+	0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+	0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+	0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+	0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+	0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+/* Block fed to the lanes with no data left */
+static const uint8_t mb_idle_block[OPENSSL_MB_HMAC_BLOCK_SIZE];
+
+#define ROTL(x, n) _mm256_or_si256(_mm256_slli_epi32(x, n), \
+		_mm256_srli_epi32(x, 32 - (n)))
+#define ROTR(x, n) ROTL(x, 32 - (n))
+#define ADD(x, y) _mm256_add_epi32(x, y)
+#define XOR(x, y) _mm256_xor_si256(x, y)
+#define AND(x, y) _mm256_and_si256(x, y)
+
+/* Load 32 bytes of each lane block and transpose them into 8 words */
+static inline void
+mb_load_words(__m256i w[8], const uint8_t *blk[OPENSSL_MB_HMAC_LANES],
+		unsigned int offset)
+{
+	const __m256i bswap = _mm256_set_epi8(
+			12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+			12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+	__m256i r[8], t[8], u[8];
+	unsigned int i;
+
+	for (i = 0; i < OPENSSL_MB_HMAC_LANES; i++)
+		r[i] = _mm256_loadu_si256((const __m256i *)(blk[i] + offset));
+
+	for (i = 0; i < 8; i += 2) {
+		t[i] = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+		t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+	}
+	for (i = 0; i < 8; i += 4) {
+		u[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+		u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+		u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+		u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+	}
+	for (i = 0; i < 4; i++) {
+		w[i] = _mm256_shuffle_epi8(
+			_mm256_permute2x128_si256(u[i], u[i + 4], 0x20), bswap);
+		w[i + 4] = _mm256_shuffle_epi8(
+			_mm256_permute2x128_si256(u[i], u[i + 4], 0x31), bswap);
+	}
+}
+
+#define SHA1_ROUND(t, f, k) do {					\
+	if ((t) >= 16) {						\
+		tmp = XOR(XOR(w[((t) - 3) & 15], w[((t) - 8) & 15]),	\
+			XOR(w[((t) - 14) & 15], w[(t) & 15]));		\
+		w[(t) & 15] = ROTL(tmp, 1);				\
+	}								\
+	tmp = ADD(ADD(ROTL(a, 5), f),					\
+		ADD(ADD(e, _mm256_set1_epi32(k)), w[(t) & 15]));	\
+	e = d;								\
+	d = c;								\
+	c = ROTL(b, 30);						\
+	b = a;								\
+	a = tmp;							\
+} while (0)
+
+/* Hash one block per lane, lanes out of the mask keep their state */
+static inline void
+sha1_x8_block(__m256i st[SHA1_DIGEST_WORDS],
+		const uint8_t *blk[OPENSSL_MB_HMAC_LANES], __m256i mask)
+{
+	__m256i w[16];
+	__m256i a, b, c, d, e, tmp;
+	unsigned int t;
+
+	mb_load_words(&w[0], blk, 0);
+	mb_load_words(&w[8], blk, 32);
+
+	a = st[0];
+	b = st[1];
+	c = st[2];
+	d = st[3];
+	e = st[4];
+
+	for (t = 0; t < 20; t++)
+		SHA1_ROUND(t, XOR(AND(b, c), _mm256_andnot_si256(b, d)),
+				0x5a827999);
+	for (; t < 40; t++)
+		SHA1_ROUND(t, XOR(XOR(b, c), d), 0x6ed9eba1);
+	for (; t < 60; t++)
+		SHA1_ROUND(t, _mm256_or_si256(AND(b, c),
+				AND(d, _mm256_or_si256(b, c))), 0x8f1bbcdc);
+	for (; t < 80; t++)
+		SHA1_ROUND(t, XOR(XOR(b, c), d), 0xca62c1d6);
+
+	st[0] = ADD(st[0], AND(a, mask));
+	st[1] = ADD(st[1], AND(b, mask));
+	st[2] = ADD(st[2], AND(c, mask));
+	st[3] = ADD(st[3], AND(d, mask));
+	st[4] = ADD(st[4], AND(e, mask));
+}
+
+/* One SHA256 round, the callers rotate the working variables */
+#define SHA256_ROUND(a, b, c, d, e, f, g, h, t) do {			\
+	if ((t) >= 16) {						\
+		s0 = w[((t) - 15) & 15];				\
+		s0 = XOR(XOR(ROTR(s0, 7), ROTR(s0, 18)),		\
+			_mm256_srli_epi32(s0, 3));			\
+		s1 = w[((t) - 2) & 15];					\
+		s1 = XOR(XOR(ROTR(s1, 17), ROTR(s1, 19)),		\
+			_mm256_srli_epi32(s1, 10));			\
+		w[(t) & 15] = ADD(ADD(w[(t) & 15], s0),			\
+			ADD(w[((t) - 7) & 15], s1));			\
+	}								\
+	s1 = XOR(XOR(ROTR(e, 6), ROTR(e, 11)), ROTR(e, 25));		\
+	t1 = XOR(AND(e, f), _mm256_andnot_si256(e, g));			\
+	t1 = ADD(ADD(h, s1), ADD(t1, w[(t) & 15]));			\
+	t1 = ADD(t1, _mm256_set1_epi32(sha256_k[t]));			\
+	s0 = XOR(XOR(ROTR(a, 2), ROTR(a, 13)), ROTR(a, 22));		\
+	t2 = _mm256_or_si256(AND(a, b), AND(c, _mm256_or_si256(a, b)));	\
+	d = ADD(d, t1);							\
+	h = ADD(t1, ADD(s0, t2));					\
+} while (0)
+
+static inline void
+sha256_x8_block(__m256i st[SHA256_DIGEST_WORDS],
+		const uint8_t *blk[OPENSSL_MB_HMAC_LANES], __m256i mask)
+{
+	__m256i w[16];
+	__m256i a, b, c, d, e, f, g, h, s0, s1, t1, t2;
+	unsigned int t;
+
+	mb_load_words(&w[0], blk, 0);
+	mb_load_words(&w[8], blk, 32);
+
+	a = st[0];
+	b = st[1];
+	c = st[2];
+	d = st[3];
+	e = st[4];
+	f = st[5];
+	g = st[6];
+	h = st[7];
+
+	for (t = 0; t < 64; t += 8) {
+		SHA256_ROUND(a, b, c, d, e, f, g, h, t);
+		SHA256_ROUND(h, a, b, c, d, e, f, g, t + 1);
+		SHA256_ROUND(g, h, a, b, c, d, e, f, t + 2);
+		SHA256_ROUND(f, g, h, a, b, c, d, e, t + 3);
+		SHA256_ROUND(e, f, g, h, a, b, c, d, t + 4);
+		SHA256_ROUND(d, e, f, g, h, a, b, c, t + 5);
+		SHA256_ROUND(c, d, e, f, g, h, a, b, t + 6);
+		SHA256_ROUND(b, c, d, e, f, g, h, a, t + 7);
+	}
+
+	st[0] = ADD(st[0], AND(a, mask));
+	st[1] = ADD(st[1], AND(b, mask));
+	st[2] = ADD(st[2], AND(c, mask));
+	st[3] = ADD(st[3], AND(d, mask));
+	st[4] = ADD(st[4], AND(e, mask));
+	st[5] = ADD(st[5], AND(f, mask));
+	st[6] = ADD(st[6], AND(g, mask));
+	st[7] = ADD(st[7], AND(h, mask));
+}
+
+/* Padded tail of a lane message: its last partial block and the length */
+struct mb_lane_tail {
+	uint8_t data[2 * OPENSSL_MB_HMAC_BLOCK_SIZE];
+	uint32_t nb_full;
+	uint32_t nb_blocks;
+};
+
+/*
+ * Hash the messages of nb_lanes lanes, each starting from state iv[] after
+ * prefix bytes already hashed, and store the big-endian digests.
+ */
+static void
+mb_hash(enum openssl_mb_hmac_algo algo, unsigned int nb_lanes,
+		const uint32_t *iv[], const uint8_t *src[],
+		const uint32_t len[], uint64_t prefix, uint8_t *digest[])
+{
+	struct mb_lane_tail tail[OPENSSL_MB_HMAC_LANES];
+	uint32_t words[SHA256_DIGEST_WORDS][OPENSSL_MB_HMAC_LANES];
+	uint32_t active[OPENSSL_MB_HMAC_LANES];
+	const uint8_t *blk[OPENSSL_MB_HMAC_LANES];
+	__m256i st[SHA256_DIGEST_WORDS];
+	unsigned int nb_words, i, j;
+	uint32_t b, nb_blocks = 0;
+
+	nb_words = algo == OPENSSL_MB_HMAC_SHA1 ?
+			SHA1_DIGEST_WORDS : SHA256_DIGEST_WORDS;
+
+	memset(words, 0, sizeof(words));
+	for (i = 0; i < nb_lanes; i++) {
+		uint32_t rem = len[i] % OPENSSL_MB_HMAC_BLOCK_SIZE;
+		uint64_t bits = (prefix + len[i]) * 8;
+		uint8_t *end;
+
+		tail[i].nb_full = len[i] / OPENSSL_MB_HMAC_BLOCK_SIZE;
+		tail[i].nb_blocks = tail[i].nb_full +
+			(rem + 9 > OPENSSL_MB_HMAC_BLOCK_SIZE ? 2 : 1);
+		nb_blocks = RTE_MAX(nb_blocks, tail[i].nb_blocks);
+
+		memset(tail[i].data, 0, sizeof(tail[i].data));
+		memcpy(tail[i].data, src[i] + len[i] - rem, rem);
+		tail[i].data[rem] = 0x80;
+		end = tail[i].data + (tail[i].nb_blocks - tail[i].nb_full) *
+				OPENSSL_MB_HMAC_BLOCK_SIZE;
+		bits = rte_cpu_to_be_64(bits);
+		memcpy(end - sizeof(bits), &bits, sizeof(bits));
+
+		for (j = 0; j < nb_words; j++)
+			words[j][i] = iv[i][j];
+	}
+
+	for (j = 0; j < nb_words; j++)
+		st[j] = _mm256_loadu_si256((const __m256i *)words[j]);
+
+	for (b = 0; b < nb_blocks; b++) {
+		for (i = 0; i < OPENSSL_MB_HMAC_LANES; i++) {
+			if (i >= nb_lanes || b >= tail[i].nb_blocks) {
+				blk[i] = mb_idle_block;
+				active[i] = 0;
+				continue;
+			}
+			if (b < tail[i].nb_full)
+				blk[i] = src[i] +
+					b * OPENSSL_MB_HMAC_BLOCK_SIZE;
+			else
+				blk[i] = tail[i].data + (b - tail[i].nb_full) *
+						OPENSSL_MB_HMAC_BLOCK_SIZE;
+			active[i] = UINT32_MAX;
+		}
+
+		if (algo == OPENSSL_MB_HMAC_SHA1)
+			sha1_x8_block(st, blk,
+				_mm256_loadu_si256((const __m256i *)active));
+		else
+			sha256_x8_block(st, blk,
+				_mm256_loadu_si256((const __m256i *)active));
+	}
+
+	for (j = 0; j < nb_words; j++)
+		_mm256_storeu_si256((__m256i *)words[j], st[j]);
+
+	for (i = 0; i < nb_lanes; i++) {
+		for (j = 0; j < nb_words; j++) {
+			uint32_t word = rte_cpu_to_be_32(words[j][i]);
+
+			memcpy(digest[i] + j * sizeof(word), &word,
+					sizeof(word));
+		}
+	}
+}
+
+/* Hash one block from the hash initial state, without padding */
+static void
+mb_pad_state(enum openssl_mb_hmac_algo algo, uint32_t state[8],
+		const uint8_t *pad)
+{
+	const uint32_t *iv = algo == OPENSSL_MB_HMAC_SHA1 ?
+			sha1_iv : sha256_iv;
+	const uint8_t *blk[OPENSSL_MB_HMAC_LANES];
+	uint32_t words[SHA256_DIGEST_WORDS][OPENSSL_MB_HMAC_LANES];
+	__m256i st[SHA256_DIGEST_WORDS];
+	unsigned int i;
+
+	for (i = 0; i < OPENSSL_MB_HMAC_LANES; i++)
+		blk[i] = mb_idle_block;
+	blk[0] = pad;
+
+	for (i = 0; i < SHA256_DIGEST_WORDS; i++)
+		st[i] = _mm256_set1_epi32(iv[i]);
+
+	if (algo == OPENSSL_MB_HMAC_SHA1)
+		sha1_x8_block(st, blk, _mm256_set1_epi32(-1));
+	else
+		sha256_x8_block(st, blk, _mm256_set1_epi32(-1));
+
+	for (i = 0; i < SHA256_DIGEST_WORDS; i++) {
+		_mm256_storeu_si256((__m256i *)words[i], st[i]);
+		state[i] = words[i][0];
+	}
+}
+
+void
+openssl_mb_hmac_key_init(struct openssl_mb_hmac_key *key,
+		enum openssl_mb_hmac_algo algo, const uint8_t *data,
+		uint32_t len)
+{
+	uint8_t k[OPENSSL_MB_HMAC_BLOCK_SIZE];
+	uint8_t pad[OPENSSL_MB_HMAC_BLOCK_SIZE];
+	unsigned int i;
+
+	memset(k, 0, sizeof(k));
+	if (len > OPENSSL_MB_HMAC_BLOCK_SIZE) {
+		const uint32_t *iv = algo == OPENSSL_MB_HMAC_SHA1 ?
+				sha1_iv : sha256_iv;
+		uint8_t *digest = k;
+
+		/* Keys longer than a block are replaced by their hash */
+		mb_hash(algo, 1, &iv, &data, &len, 0, &digest);
+	} else
+		memcpy(k, data, len);
+
+	for (i = 0; i < sizeof(pad); i++)
+		pad[i] = k[i] ^ 0x36;
+	mb_pad_state(algo, key->inner, pad);
+
+	for (i = 0; i < sizeof(pad); i++)
+		pad[i] = k[i] ^ 0x5c;
+	mb_pad_state(algo, key->outer, pad);
+}
+
+void
+openssl_mb_hmac_run(enum openssl_mb_hmac_algo algo,
+		struct openssl_mb_hmac_job *jobs, unsigned int nb_jobs)
+{
+	uint8_t inner[OPENSSL_MB_HMAC_LANES][OPENSSL_MB_HMAC_DIGEST_MAX];
+	const uint32_t *iv[OPENSSL_MB_HMAC_LANES];
+	const uint8_t *src[OPENSSL_MB_HMAC_LANES];
+	uint32_t len[OPENSSL_MB_HMAC_LANES] = { 0 };
+	uint8_t *digest[OPENSSL_MB_HMAC_LANES];
+	uint32_t digest_len;
+	unsigned int i;
+
+	digest_len = algo == OPENSSL_MB_HMAC_SHA1 ?
+			SHA1_DIGEST_WORDS * 4 : SHA256_DIGEST_WORDS * 4;
+
+	/* Inner hash: H((K ^ ipad) || data) */
+	for (i = 0; i < nb_jobs; i++) {
+		iv[i] = jobs[i].key->inner;
+		src[i] = jobs[i].src;
+		len[i] = jobs[i].len;
+		digest[i] = inner[i];
+	}
+	mb_hash(algo, nb_jobs, iv, src, len, OPENSSL_MB_HMAC_BLOCK_SIZE,
+			digest);
+
+	/* Outer hash: H((K ^ opad) || inner digest) */
+	for (i = 0; i < nb_jobs; i++) {
+		iv[i] = jobs[i].key->outer;
+		src[i] = inner[i];
+		len[i] = digest_len;
+		digest[i] = jobs[i].digest;
+	}
+	mb_hash(algo, nb_jobs, iv, src, len, OPENSSL_MB_HMAC_BLOCK_SIZE,
+			digest);
+}
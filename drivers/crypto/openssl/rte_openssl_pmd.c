@@ -37,6 +37,7 @@
 #include <rte_bus_vdev.h>
 #include <rte_malloc.h>
 #include <rte_cpuflags.h>
+#include <rte_jhash.h>
 
 #include <openssl/hmac.h>
 #include <openssl/evp.h>
@@ -555,6 +556,58 @@ openssl_set_session_cipher_parameters(struct openssl_session *sess,
 	return 0;
 }
 
+/* Check if the CPU runs the multi-buffer HMAC engine */
+static inline int
+openssl_mb_hmac_available(void)
+{
+#ifdef CC_AVX2_SUPPORT
+	return rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2) > 0;
+#else
+	return 0;
+#endif
+}
+
+/* Hand over the HMAC of an auth only session to the multi-buffer engine */
+static void
+openssl_set_session_mb_hmac(struct openssl_session *sess,
+		const struct rte_crypto_sym_xform *xform)
+{
+	sess->auth.hmac.mb = 0;
+
+#ifdef CC_AVX2_SUPPORT
+	if (sess->chain_order != OPENSSL_CHAIN_ONLY_AUTH ||
+			!openssl_mb_hmac_available())
+		return;
+
+	sess->auth.hmac.mb_max_len = UINT32_MAX;
+
+	switch (xform->auth.algo) {
+	case RTE_CRYPTO_AUTH_SHA1_HMAC:
+		sess->auth.hmac.mb_algo = OPENSSL_MB_HMAC_SHA1;
+		break;
+	case RTE_CRYPTO_AUTH_SHA256_HMAC:
+		sess->auth.hmac.mb_algo = OPENSSL_MB_HMAC_SHA256;
+		/*
+		 * With the SHA extensions, OpenSSL hashes one long buffer
+		 * faster than the AVX2 lanes hash eight of them.
+		 */
+		if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SHA) > 0)
+			sess->auth.hmac.mb_max_len =
+					OPENSSL_MB_HMAC_SHA_EXT_MAX_LEN;
+		break;
+	default:
+		return;
+	}
+
+	openssl_mb_hmac_key_init(&sess->auth.hmac.mb_key,
+			sess->auth.hmac.mb_algo, xform->auth.key.data,
+			xform->auth.key.length);
+	sess->auth.hmac.mb = 1;
+#else
+	RTE_SET_USED(xform);
+#endif
+}
+
 /* Set session auth parameters */
 static int
 openssl_set_session_auth_parameters(struct openssl_session *sess,
@@ -621,6 +674,8 @@ openssl_set_session_auth_parameters(struct openssl_session *sess,
 				xform->auth.key.length,
 				sess->auth.hmac.evp_algo, NULL) != 1)
 			return -EINVAL;
+
+		openssl_set_session_mb_hmac(sess, xform);
 		break;
 
 	default:
@@ -754,6 +809,218 @@ openssl_reset_session(struct openssl_session *sess)
 	}
 }
 
+/*
+ * Release the session of a session-less cache entry and wipe the keys the
+ * entry holds, in its key and in its session, before the memory is reused.
+ */
+static void
+openssl_sessless_entry_clear(struct openssl_sessless_entry *entry)
+{
+	if (entry->valid)
+		openssl_reset_session(&entry->sess);
+
+	memset(&entry->sess, 0, sizeof(entry->sess));
+	memset(&entry->key, 0, sizeof(entry->key));
+	entry->valid = 0;
+}
+
+/** Create the session-less cache of a queue pair */
+struct openssl_sessless_cache *
+openssl_sessless_cache_create(unsigned int size, int socket_id)
+{
+	struct openssl_sessless_cache *cache;
+	uint32_t nb_buckets = rte_align32pow2(size);
+	unsigned int i;
+
+	cache = rte_zmalloc_socket("OPENSSL PMD session-less cache",
+			sizeof(*cache), RTE_CACHE_LINE_SIZE, socket_id);
+	if (cache == NULL)
+		return NULL;
+
+	cache->entries = rte_zmalloc_socket("OPENSSL PMD session-less cache",
+			sizeof(*cache->entries) * size, RTE_CACHE_LINE_SIZE,
+			socket_id);
+	cache->buckets = rte_zmalloc_socket("OPENSSL PMD session-less cache",
+			sizeof(*cache->buckets) * nb_buckets,
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (cache->entries == NULL || cache->buckets == NULL) {
+		rte_free(cache->entries);
+		rte_free(cache->buckets);
+		rte_free(cache);
+		return NULL;
+	}
+
+	cache->bucket_mask = nb_buckets - 1;
+	TAILQ_INIT(&cache->lru);
+	for (i = 0; i < size; i++)
+		TAILQ_INSERT_TAIL(&cache->lru, &cache->entries[i], lru_next);
+
+	return cache;
+}
+
+/** Free the session-less cache of a queue pair and its sessions */
+void
+openssl_sessless_cache_free(struct openssl_sessless_cache *cache)
+{
+	struct openssl_sessless_entry *entry;
+
+	if (cache == NULL)
+		return;
+
+	TAILQ_FOREACH(entry, &cache->lru, lru_next)
+		openssl_sessless_entry_clear(entry);
+
+	rte_free(cache->entries);
+	rte_free(cache->buckets);
+	rte_free(cache);
+}
+
+/*
+ * Fill the cache key of a transform chain: the parameters and keys that
+ * openssl_set_session_parameters() builds a session from.
+ */
+static inline int
+openssl_sessless_key_set(struct openssl_sessless_key *key,
+		const struct rte_crypto_sym_xform *xform)
+{
+	const uint8_t *key_data;
+	unsigned int i;
+
+	memset(key->xform, 0, sizeof(key->xform));
+
+	for (i = 0; xform != NULL; i++, xform = xform->next) {
+		struct openssl_sessless_xform *x = &key->xform[i];
+
+		if (i == RTE_DIM(key->xform))
+			return -ENOTSUP;
+
+		x->type = xform->type;
+		switch (xform->type) {
+		case RTE_CRYPTO_SYM_XFORM_CIPHER:
+			x->algo = xform->cipher.algo;
+			x->op = xform->cipher.op;
+			x->key_length = xform->cipher.key.length;
+			x->iv_offset = xform->cipher.iv.offset;
+			x->iv_length = xform->cipher.iv.length;
+			key_data = xform->cipher.key.data;
+			break;
+		case RTE_CRYPTO_SYM_XFORM_AUTH:
+			x->algo = xform->auth.algo;
+			x->op = xform->auth.op;
+			x->key_length = xform->auth.key.length;
+			x->iv_offset = xform->auth.iv.offset;
+			x->iv_length = xform->auth.iv.length;
+			x->digest_length = xform->auth.digest_length;
+			key_data = xform->auth.key.data;
+			break;
+		case RTE_CRYPTO_SYM_XFORM_AEAD:
+			x->algo = xform->aead.algo;
+			x->op = xform->aead.op;
+			x->key_length = xform->aead.key.length;
+			x->iv_offset = xform->aead.iv.offset;
+			x->iv_length = xform->aead.iv.length;
+			x->digest_length = xform->aead.digest_length;
+			x->aad_length = xform->aead.aad_length;
+			key_data = xform->aead.key.data;
+			break;
+		default:
+			return -ENOTSUP;
+		}
+
+		if (x->key_length > OPENSSL_SESSLESS_KEY_MAX_LEN)
+			return -ENOTSUP;
+		if (x->key_length != 0)
+			memcpy(key->key_data[i], key_data, x->key_length);
+	}
+
+	return 0;
+}
+
+static inline uint32_t
+openssl_sessless_key_hash(const struct openssl_sessless_key *key)
+{
+	uint32_t hash = rte_jhash(key->xform, sizeof(key->xform), 0);
+
+	hash = rte_jhash(key->key_data[0], key->xform[0].key_length, hash);
+	return rte_jhash(key->key_data[1], key->xform[1].key_length, hash);
+}
+
+static inline int
+openssl_sessless_key_cmp(const struct openssl_sessless_key *key1,
+		const struct openssl_sessless_key *key2)
+{
+	return memcmp(key1->xform, key2->xform, sizeof(key1->xform)) ||
+		memcmp(key1->key_data[0], key2->key_data[0],
+			key1->xform[0].key_length) ||
+		memcmp(key1->key_data[1], key2->key_data[1],
+			key1->xform[1].key_length);
+}
+
+/*
+ * Find the session of a session-less operation in the cache, or build it
+ * in place of the least recently used one. Returns -ENOTSUP if the
+ * transforms cannot be cached, otherwise 0 with *sess set to the session,
+ * or to NULL if the transforms are invalid.
+ */
+static int
+openssl_sessless_cache_get(struct openssl_sessless_cache *cache,
+		const struct rte_crypto_sym_xform *xform,
+		struct openssl_session **sess)
+{
+	struct openssl_sessless_key key;
+	struct openssl_sessless_bucket *bucket;
+	struct openssl_sessless_entry *entry;
+	uint32_t hash;
+
+	if (unlikely(openssl_sessless_key_set(&key, xform) != 0)) {
+		cache->stats.bypassed++;
+		return -ENOTSUP;
+	}
+
+	hash = openssl_sessless_key_hash(&key);
+	bucket = &cache->buckets[hash & cache->bucket_mask];
+
+	LIST_FOREACH(entry, bucket, hash_next) {
+		if (entry->hash != hash ||
+				openssl_sessless_key_cmp(&entry->key, &key))
+			continue;
+
+		cache->stats.hits++;
+		TAILQ_REMOVE(&cache->lru, entry, lru_next);
+		TAILQ_INSERT_HEAD(&cache->lru, entry, lru_next);
+		*sess = &entry->sess;
+		return 0;
+	}
+
+	cache->stats.misses++;
+
+	entry = TAILQ_LAST(&cache->lru, openssl_sessless_lru);
+	TAILQ_REMOVE(&cache->lru, entry, lru_next);
+	if (entry->valid) {
+		cache->stats.evictions++;
+		LIST_REMOVE(entry, hash_next);
+	}
+	openssl_sessless_entry_clear(entry);
+
+	if (openssl_set_session_parameters(&entry->sess, xform) != 0) {
+		openssl_reset_session(&entry->sess);
+		memset(&entry->sess, 0, sizeof(entry->sess));
+		TAILQ_INSERT_TAIL(&cache->lru, entry, lru_next);
+		*sess = NULL;
+		return 0;
+	}
+
+	entry->sess.sessless_cached = 1;
+	entry->key = key;
+	entry->hash = hash;
+	entry->valid = 1;
+	LIST_INSERT_HEAD(bucket, entry, hash_next);
+	TAILQ_INSERT_HEAD(&cache->lru, entry, lru_next);
+	*sess = &entry->sess;
+
+	return 0;
+}
+
 /** Provide session for operation */
 static struct openssl_session *
 get_session(struct openssl_qp *qp, struct rte_crypto_op *op)
@@ -767,7 +1034,9 @@ get_session(struct openssl_qp *qp, struct rte_crypto_op *op)
 					get_session_private_data(
 					op->sym->session,
 					cryptodev_driver_id);
-	} else {
+	} else if (qp->sessless_cache == NULL ||
+			openssl_sessless_cache_get(qp->sessless_cache,
+				op->sym->xform, &sess) != 0) {
 		/* provide internal session */
 		void *_sess = NULL;
 		void *_sess_private_data = NULL;
@@ -775,20 +1044,26 @@ get_session(struct openssl_qp *qp, struct rte_crypto_op *op)
 		if (rte_mempool_get(qp->sess_mp, (void **)&_sess))
 			return NULL;
 
-		if (rte_mempool_get(qp->sess_mp, (void **)&_sess_private_data))
+		if (rte_mempool_get(qp->sess_mp,
+				(void **)&_sess_private_data)) {
+			rte_mempool_put(qp->sess_mp, _sess);
 			return NULL;
+		}
 
 		sess = (struct openssl_session *)_sess_private_data;
+		sess->sessless_cached = 0;
 
 		if (unlikely(openssl_set_session_parameters(sess,
 				op->sym->xform) != 0)) {
 			rte_mempool_put(qp->sess_mp, _sess);
 			rte_mempool_put(qp->sess_mp, _sess_private_data);
 			sess = NULL;
+		} else {
+			op->sym->session =
+				(struct rte_cryptodev_sym_session *)_sess;
+			set_session_private_data(op->sym->session,
+				cryptodev_driver_id, _sess_private_data);
 		}
-		op->sym->session = (struct rte_cryptodev_sym_session *)_sess;
-		set_session_private_data(op->sym->session, cryptodev_driver_id,
-			_sess_private_data);
 	}
 
 	if (sess == NULL)
@@ -1592,8 +1867,9 @@ process_op(struct openssl_qp *qp, struct rte_crypto_op *op,
 		break;
 	}
 
-	/* Free session if a session-less crypto op */
-	if (op->sess_type == RTE_CRYPTO_OP_SESSIONLESS) {
+	/* Free session if a session-less crypto op not served by the cache */
+	if (op->sess_type == RTE_CRYPTO_OP_SESSIONLESS &&
+			!sess->sessless_cached) {
 		openssl_reset_session(sess);
 		memset(sess, 0, sizeof(struct openssl_session));
 		memset(op->sym->session, 0,
@@ -1614,6 +1890,91 @@ process_op(struct openssl_qp *qp, struct rte_crypto_op *op,
 	return retval;
 }
 
+#ifdef CC_AVX2_SUPPORT
+/** Check if an operation can be batched into the multi-buffer engine */
+static inline int
+openssl_mb_hmac_op(struct rte_crypto_op *op, struct openssl_session *sess)
+{
+	/*
+	 * Session-less operations are left out, as later operations of the
+	 * burst may reuse their cached session.
+	 */
+	return sess->chain_order == OPENSSL_CHAIN_ONLY_AUTH &&
+		sess->auth.mode == OPENSSL_AUTH_AS_HMAC &&
+		sess->auth.hmac.mb &&
+		op->sess_type == RTE_CRYPTO_OP_WITH_SESSION &&
+		op->sym->auth.data.length <= sess->auth.hmac.mb_max_len &&
+		op->sym->auth.data.offset + op->sym->auth.data.length <=
+			rte_pktmbuf_data_len(op->sym->m_src);
+}
+
+/** Process a batch of auth only HMAC operations of contiguous data */
+static unsigned int
+process_mb_hmac_ops(struct openssl_qp *qp, struct rte_crypto_op **ops,
+		struct openssl_session **sessions, unsigned int nb_ops)
+{
+	uint8_t digests[OPENSSL_MB_HMAC_LANES][OPENSSL_MB_HMAC_DIGEST_MAX];
+	struct openssl_mb_hmac_job jobs[OPENSSL_MB_HMAC_LANES];
+	enum openssl_mb_hmac_algo algo;
+	unsigned int i, first, n;
+	struct rte_crypto_op *op;
+	struct rte_mbuf *mdst;
+	uint8_t *dst;
+
+	/*
+	 * Only process the operations that the ring can take. This queue pair
+	 * is the ring's only producer, so they are all enqueued below, and the
+	 * operations left to the caller keep their status and digest.
+	 */
+	nb_ops = RTE_MIN(nb_ops, rte_ring_free_count(qp->processed_ops));
+
+	for (i = 0; i < nb_ops; i++) {
+		op = ops[i];
+		jobs[i].src = rte_pktmbuf_mtod_offset(op->sym->m_src,
+				uint8_t *, op->sym->auth.data.offset);
+		jobs[i].len = op->sym->auth.data.length;
+		jobs[i].key = &sessions[i]->auth.hmac.mb_key;
+		jobs[i].digest = digests[i];
+	}
+
+	/* Runs of operations with the same hash function share the lanes */
+	for (first = 0; first < nb_ops; first += n) {
+		algo = sessions[first]->auth.hmac.mb_algo;
+		for (n = 1; first + n < nb_ops &&
+				sessions[first + n]->auth.hmac.mb_algo == algo;
+				n++)
+			;
+		openssl_mb_hmac_run(algo, &jobs[first], n);
+	}
+
+	for (i = 0; i < nb_ops; i++) {
+		op = ops[i];
+		op->status = RTE_CRYPTO_OP_STATUS_SUCCESS;
+
+		if (sessions[i]->auth.operation ==
+				RTE_CRYPTO_AUTH_OP_VERIFY) {
+			if (memcmp(digests[i], op->sym->auth.digest.data,
+					sessions[i]->auth.digest_length) != 0)
+				op->status = RTE_CRYPTO_OP_STATUS_AUTH_FAILED;
+		} else {
+			dst = op->sym->auth.digest.data;
+			if (dst == NULL) {
+				mdst = op->sym->m_dst ? op->sym->m_dst :
+						op->sym->m_src;
+				dst = rte_pktmbuf_mtod_offset(mdst, uint8_t *,
+						op->sym->auth.data.offset +
+						op->sym->auth.data.length);
+			}
+			memcpy(dst, digests[i],
+					sessions[i]->auth.digest_length);
+		}
+	}
+
+	return rte_ring_enqueue_burst(qp->processed_ops, (void **)ops,
+			nb_ops, NULL);
+}
+#endif
+
 /*
  *------------------------------------------------------------------------------
  * PMD Framework
@@ -1628,9 +1989,59 @@ openssl_pmd_enqueue_burst(void *queue_pair, struct rte_crypto_op **ops,
 	struct openssl_session *sess;
 	struct openssl_qp *qp = queue_pair;
 	int i, retval;
+#ifdef CC_AVX2_SUPPORT
+	struct openssl_session *mb_sessions[OPENSSL_MB_HMAC_LANES];
+	unsigned int nb_mb = 0, done;
+	int mb, end;
+#endif
 
 	for (i = 0; i < nb_ops; i++) {
+#ifdef CC_AVX2_SUPPORT
+		/*
+		 * Session-less operations are never batched. Flush the batch
+		 * before get_session() attaches an internal session to such
+		 * an operation, so that a failed flush leaves the operation
+		 * as it was, with no session to free.
+		 */
+		if (nb_mb > 0 && ops[i]->sess_type !=
+				RTE_CRYPTO_OP_WITH_SESSION) {
+			done = process_mb_hmac_ops(qp, &ops[i - nb_mb],
+					mb_sessions, nb_mb);
+			if (unlikely(done < nb_mb)) {
+				i = i - nb_mb + done;
+				goto enqueue_err;
+			}
+			nb_mb = 0;
+		}
+#endif
+
 		sess = get_session(qp, ops[i]);
+
+#ifdef CC_AVX2_SUPPORT
+		/*
+		 * Consecutive HMAC operations are hashed together, one per
+		 * lane of the multi-buffer engine; any other operation first
+		 * flushes the batch to keep the operations in order.
+		 */
+		mb = sess != NULL && openssl_mb_hmac_op(ops[i], sess);
+		if (mb)
+			mb_sessions[nb_mb++] = sess;
+
+		if (nb_mb == OPENSSL_MB_HMAC_LANES || (!mb && nb_mb > 0)) {
+			end = mb ? i + 1 : i;
+			done = process_mb_hmac_ops(qp, &ops[end - nb_mb],
+					mb_sessions, nb_mb);
+			if (unlikely(done < nb_mb)) {
+				i = end - nb_mb + done;
+				goto enqueue_err;
+			}
+			nb_mb = 0;
+		}
+
+		if (mb)
+			continue;
+#endif
+
 		if (unlikely(sess == NULL))
 			goto enqueue_err;
 
@@ -1639,6 +2050,17 @@ openssl_pmd_enqueue_burst(void *queue_pair, struct rte_crypto_op **ops,
 			goto enqueue_err;
 	}
 
+#ifdef CC_AVX2_SUPPORT
+	if (nb_mb > 0) {
+		done = process_mb_hmac_ops(qp, &ops[i - nb_mb], mb_sessions,
+				nb_mb);
+		if (unlikely(done < nb_mb)) {
+			i = i - nb_mb + done;
+			goto enqueue_err;
+		}
+	}
+#endif
+
 	qp->stats.enqueued_count += i;
 	return i;
 
@@ -1663,6 +2085,39 @@ openssl_pmd_dequeue_burst(void *queue_pair, struct rte_crypto_op **ops,
 	return nb_dequeued;
 }
 
+/** Get the statistics of the session-less caches of a device */
+int
+rte_pmd_openssl_sessless_stats_get(uint8_t dev_id,
+		struct rte_pmd_openssl_sessless_stats *stats)
+{
+	struct rte_cryptodev *dev;
+	uint16_t qp_id;
+
+	if (!rte_cryptodev_pmd_is_valid_dev(dev_id) || stats == NULL)
+		return -EINVAL;
+
+	dev = rte_cryptodev_pmd_get_dev(dev_id);
+	if (dev->driver_id != cryptodev_driver_id) {
+		OPENSSL_LOG_ERR("device %u is not an OpenSSL device", dev_id);
+		return -ENOTSUP;
+	}
+
+	memset(stats, 0, sizeof(*stats));
+	for (qp_id = 0; qp_id < dev->data->nb_queue_pairs; qp_id++) {
+		struct openssl_qp *qp = dev->data->queue_pairs[qp_id];
+
+		if (qp == NULL || qp->sessless_cache == NULL)
+			continue;
+
+		stats->hits += qp->sessless_cache->stats.hits;
+		stats->misses += qp->sessless_cache->stats.misses;
+		stats->evictions += qp->sessless_cache->stats.evictions;
+		stats->bypassed += qp->sessless_cache->stats.bypassed;
+	}
+
+	return 0;
+}
+
 /** Create OPENSSL crypto device */
 static int
 cryptodev_openssl_create(const char *name,
@@ -1691,6 +2146,9 @@ cryptodev_openssl_create(const char *name,
 			RTE_CRYPTODEV_FF_MBUF_SCATTER_GATHER;
 
 	/* Set vector instructions mode supported */
+	if (openssl_mb_hmac_available())
+		dev->feature_flags |= RTE_CRYPTODEV_FF_CPU_AVX2;
+
 	internals = dev->data->dev_private;
 
 	internals->max_nb_qpairs = init_params->max_nb_queue_pairs;
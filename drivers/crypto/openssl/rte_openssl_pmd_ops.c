@@ -559,6 +559,9 @@ openssl_pmd_stats_reset(struct rte_cryptodev *dev)
 		struct openssl_qp *qp = dev->data->queue_pairs[qp_id];
 
 		memset(&qp->stats, 0, sizeof(qp->stats));
+		if (qp->sessless_cache != NULL)
+			memset(&qp->sessless_cache->stats, 0,
+					sizeof(qp->sessless_cache->stats));
 	}
 }
 
@@ -583,8 +586,11 @@ openssl_pmd_info_get(struct rte_cryptodev *dev,
 static int
 openssl_pmd_qp_release(struct rte_cryptodev *dev, uint16_t qp_id)
 {
-	if (dev->data->queue_pairs[qp_id] != NULL) {
-		rte_free(dev->data->queue_pairs[qp_id]);
+	struct openssl_qp *qp = dev->data->queue_pairs[qp_id];
+
+	if (qp != NULL) {
+		openssl_sessless_cache_free(qp->sessless_cache);
+		rte_free(qp);
 		dev->data->queue_pairs[qp_id] = NULL;
 	}
 	return 0;
@@ -664,6 +670,14 @@ openssl_pmd_qp_setup(struct rte_cryptodev *dev, uint16_t qp_id,
 
 	qp->sess_mp = session_pool;
 
+	if (RTE_LIBRTE_PMD_OPENSSL_SESSLESS_CACHE_SIZE != 0) {
+		qp->sessless_cache = openssl_sessless_cache_create(
+				RTE_LIBRTE_PMD_OPENSSL_SESSLESS_CACHE_SIZE,
+				socket_id);
+		if (qp->sessless_cache == NULL)
+			goto qp_setup_cleanup;
+	}
+
 	memset(&qp->stats, 0, sizeof(qp->stats));
 
 	return 0;
@@ -36,6 +36,10 @@
 #include <openssl/evp.h>
 #include <openssl/hmac.h>
 #include <openssl/des.h>
+#include <sys/queue.h>
+
+#include "rte_pmd_openssl.h"
+#include "openssl_mb_hmac.h"
 
 #define CRYPTODEV_NAME_OPENSSL_PMD	crypto_openssl
 /**< Open SSL Crypto PMD device name */
@@ -86,6 +90,12 @@ enum openssl_auth_mode {
 	OPENSSL_AUTH_AS_HMAC,
 };
 
+/**
+ * Longest HMAC-SHA256 data given to the multi-buffer engine on CPUs with the
+ * SHA extensions, longer data is faster through OpenSSL
+ */
+#define OPENSSL_MB_HMAC_SHA_EXT_MAX_LEN	512
+
 /** private data structure for each OPENSSL crypto device */
 struct openssl_private {
 	unsigned int max_nb_qpairs;
@@ -106,6 +116,8 @@ struct openssl_qp {
 	/**< Session Mempool */
 	struct rte_cryptodev_stats stats;
 	/**< Queue pair statistics */
+	struct openssl_sessless_cache *sessless_cache;
+	/**< Sessions of session-less operations, NULL if disabled */
 	uint8_t temp_digest[DIGEST_LENGTH_MAX];
 	/**< Buffer used to store the digest generated
 	 * by the driver when verifying a digest provided
@@ -174,6 +186,16 @@ struct openssl_session {
 				/**< pointer to EVP algorithm function */
 				HMAC_CTX *ctx;
 				/**< pointer to EVP context structure */
+				uint8_t mb;
+				/**< HMAC of contiguous data done by the
+				 * multi-buffer engine
+				 */
+				enum openssl_mb_hmac_algo mb_algo;
+				/**< multi-buffer engine hash function */
+				uint32_t mb_max_len;
+				/**< longest data given to the engine */
+				struct openssl_mb_hmac_key mb_key;
+				/**< multi-buffer engine precomputed key */
 			} hmac;
 		};
 
@@ -183,8 +205,59 @@ struct openssl_session {
 		/**< digest length */
 	} auth;
 
+	uint8_t sessless_cached;
+	/**< session owned by the session-less cache of a queue pair */
+
 } __rte_cache_aligned;
 
+/** Longest key a session-less cache entry holds (HMAC-SHA512 block) */
+#define OPENSSL_SESSLESS_KEY_MAX_LEN 128
+
+/** Transform parameters compared by the session-less cache */
+struct openssl_sessless_xform {
+	uint16_t type;
+	uint16_t algo;
+	uint16_t op;
+	uint16_t key_length;
+	uint16_t iv_offset;
+	uint16_t iv_length;
+	uint16_t digest_length;
+	uint16_t aad_length;
+};
+
+/** Session-less cache key: parameters and keys of a transform chain */
+struct openssl_sessless_key {
+	struct openssl_sessless_xform xform[2];
+	uint8_t key_data[2][OPENSSL_SESSLESS_KEY_MAX_LEN];
+};
+
+/** Session-less cache entry */
+struct openssl_sessless_entry {
+	struct openssl_session sess;
+	/**< session built from the key, with its expanded keys */
+	struct openssl_sessless_key key;
+	uint32_t hash;
+	/**< hash of the key */
+	uint32_t valid;
+	/**< entry holds a session */
+	TAILQ_ENTRY(openssl_sessless_entry) lru_next;
+	LIST_ENTRY(openssl_sessless_entry) hash_next;
+} __rte_cache_aligned;
+
+TAILQ_HEAD(openssl_sessless_lru, openssl_sessless_entry);
+LIST_HEAD(openssl_sessless_bucket, openssl_sessless_entry);
+
+/** LRU cache of the sessions of session-less operations of a queue pair */
+struct openssl_sessless_cache {
+	struct openssl_sessless_lru lru;
+	/**< entries, most recently used first */
+	struct openssl_sessless_bucket *buckets;
+	/**< hash table of the valid entries */
+	uint32_t bucket_mask;
+	struct openssl_sessless_entry *entries;
+	struct rte_pmd_openssl_sessless_stats stats;
+};
+
 /** Set and validate OPENSSL crypto session parameters */
 extern int
 openssl_set_session_parameters(struct openssl_session *sess,
@@ -194,6 +267,14 @@ openssl_set_session_parameters(struct openssl_session *sess,
 extern void
 openssl_reset_session(struct openssl_session *sess);
 
+/** Create the session-less cache of a queue pair */
+extern struct openssl_sessless_cache *
+openssl_sessless_cache_create(unsigned int size, int socket_id);
+
+/** Free the session-less cache of a queue pair and its sessions */
+extern void
+openssl_sessless_cache_free(struct openssl_sessless_cache *cache);
+
 /** device specific operations function pointer structure */
 extern struct rte_cryptodev_ops *rte_openssl_pmd_ops;
 
@@ -0,0 +1,89 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_PMD_OPENSSL_H_
+#define _RTE_PMD_OPENSSL_H_
+
+/**
+ * @file rte_pmd_openssl.h
+ * OpenSSL crypto PMD specific functions.
+ *
+ * Each queue pair of the PMD keeps the sessions built for session-less
+ * operations in an LRU cache, keyed by their transforms and key material,
+ * so that operations reusing the keys of a recent operation do not expand
+ * them again. The cache size is set by
+ * CONFIG_RTE_LIBRTE_PMD_OPENSSL_SESSLESS_CACHE_SIZE, 0 disabling it.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Statistics of the session-less session caches of a device */
+struct rte_pmd_openssl_sessless_stats {
+	uint64_t hits;
+	/**< Operations processed with a cached session */
+	uint64_t misses;
+	/**< Operations whose session was built and added to the cache */
+	uint64_t evictions;
+	/**< Cached sessions replaced by a more recent one */
+	uint64_t bypassed;
+	/**< Operations whose transforms cannot be cached */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Get the statistics of the session-less session caches of all the queue
+ * pairs of a device. They are cleared by rte_cryptodev_stats_reset().
+ *
+ * @param dev_id
+ *   The identifier of an OpenSSL crypto device.
+ * @param stats
+ *   A pointer to a structure to be filled with the statistics.
+ * @return
+ *   - 0 on success.
+ *   - -EINVAL if *dev_id* or *stats* is invalid.
+ *   - -ENOTSUP if the device is not an OpenSSL crypto device.
+ */
+int
+rte_pmd_openssl_sessless_stats_get(uint8_t dev_id,
+		struct rte_pmd_openssl_sessless_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_PMD_OPENSSL_H_ */
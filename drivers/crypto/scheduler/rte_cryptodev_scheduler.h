@@ -69,6 +69,8 @@ extern "C" {
 #define SCHEDULER_MODE_NAME_FAIL_OVER		fail-over
 /** multi-core scheduling mode string */
 #define SCHEDULER_MODE_NAME_MULTI_CORE		multi-core
+/** work-stealing multi-core scheduling mode string */
+#define SCHEDULER_MODE_NAME_WORK_STEALING	work-stealing
 
 /**
  * Crypto scheduler PMD operation modes
@@ -85,6 +87,8 @@ enum rte_cryptodev_scheduler_mode {
 	CDEV_SCHED_MODE_FAILOVER,
 	/** multi-core mode */
 	CDEV_SCHED_MODE_MULTICORE,
+	/** work-stealing multi-core mode */
+	CDEV_SCHED_MODE_WORK_STEALING,
 
 	CDEV_SCHED_MODE_COUNT /**< number of modes */
 };
@@ -305,6 +309,8 @@ extern struct rte_cryptodev_scheduler *pkt_size_based_distr_scheduler;
 extern struct rte_cryptodev_scheduler *failover_scheduler;
 /** multi-core mode scheduler */
 extern struct rte_cryptodev_scheduler *multicore_scheduler;
+/** work-stealing multi-core mode scheduler */
+extern struct rte_cryptodev_scheduler *work_stealing_scheduler;
 
 #ifdef __cplusplus
 }
@@ -39,15 +39,21 @@
 
 #define MC_SCHED_ENQ_RING_NAME_PREFIX	"MCS_ENQR_"
 #define MC_SCHED_DEQ_RING_NAME_PREFIX	"MCS_DEQR_"
+#define WS_SCHED_ENQ_RING_NAME_PREFIX	"WSS_ENQR_"
+#define WS_SCHED_DEQ_RING_NAME_PREFIX	"WSS_DEQR_"
 
 #define MC_SCHED_BUFFER_SIZE 32
 
+/* minimum backlog of a worker for its peers to steal from it */
+#define WS_SCHED_STEAL_THRESHOLD MC_SCHED_BUFFER_SIZE
+
 #define CRYPTO_OP_STATUS_BIT_COMPLETE	0x80
 
 /** multi-core scheduler context */
 struct mc_scheduler_ctx {
 	uint32_t num_workers;             /**< Number of workers polling */
 	uint32_t stop_signal;
+	uint32_t work_stealing;           /**< Idle workers steal from peers */
 
 	struct rte_ring *sched_enq_ring[RTE_CRYPTODEV_SCHEDULER_MAX_NB_WORKER_CORES];
 	struct rte_ring *sched_deq_ring[RTE_CRYPTODEV_SCHEDULER_MAX_NB_WORKER_CORES];
@@ -108,6 +114,87 @@ schedule_enqueue_ordering(void *qp, struct rte_crypto_op **ops,
 }
 
 
+/*
+ * Ops of a session always go to the same worker, to keep the cipher context
+ * of the session warm in its cache. Sessions are spread by address.
+ */
+static inline uint32_t
+ws_session_worker(const struct rte_crypto_op *op, uint32_t num_workers)
+{
+	uint32_t hash = (uint32_t)((uintptr_t)op->sym->session >>
+			RTE_CACHE_LINE_SIZE_LOG2) * 2654435761U;
+
+	return (hash >> 16) % num_workers;
+}
+
+static inline int
+ws_same_session(const struct rte_crypto_op *op1,
+		const struct rte_crypto_op *op2)
+{
+	if (op1->sess_type != op2->sess_type)
+		return 0;
+	return op1->sess_type != RTE_CRYPTO_OP_WITH_SESSION ||
+			op1->sym->session == op2->sym->session;
+}
+
+static uint16_t
+schedule_enqueue_ws(void *qp, struct rte_crypto_op **ops, uint16_t nb_ops)
+{
+	struct mc_scheduler_qp_ctx *mc_qp_ctx =
+			((struct scheduler_qp_ctx *)qp)->private_qp_ctx;
+	struct mc_scheduler_ctx *mc_ctx = mc_qp_ctx->mc_private_ctx;
+	uint32_t worker_idx;
+	uint16_t nb_run, nb_queue_ops, processed_ops = 0;
+
+	while (processed_ops < nb_ops) {
+		/* enqueue the run of ops of the same session at once */
+		for (nb_run = 1; processed_ops + nb_run < nb_ops &&
+				ws_same_session(ops[processed_ops],
+					ops[processed_ops + nb_run]); nb_run++)
+			;
+
+		if (ops[processed_ops]->sess_type ==
+				RTE_CRYPTO_OP_WITH_SESSION)
+			worker_idx = ws_session_worker(ops[processed_ops],
+					mc_ctx->num_workers);
+		else {
+			worker_idx = mc_qp_ctx->last_enq_worker_idx;
+			if (++mc_qp_ctx->last_enq_worker_idx ==
+					mc_ctx->num_workers)
+				mc_qp_ctx->last_enq_worker_idx = 0;
+		}
+
+		/*
+		 * Stop once a worker is full, the other workers steal from it
+		 * when they are idle.
+		 */
+		nb_queue_ops = rte_ring_enqueue_burst(
+				mc_ctx->sched_enq_ring[worker_idx],
+				(void *)(&ops[processed_ops]), nb_run, NULL);
+		processed_ops += nb_queue_ops;
+		if (nb_queue_ops < nb_run)
+			break;
+	}
+
+	return processed_ops;
+}
+
+static uint16_t
+schedule_enqueue_ws_ordering(void *qp, struct rte_crypto_op **ops,
+		uint16_t nb_ops)
+{
+	struct rte_ring *order_ring =
+			((struct scheduler_qp_ctx *)qp)->order_ring;
+	uint16_t nb_ops_to_enq = get_max_enqueue_order_count(order_ring,
+			nb_ops);
+	uint16_t nb_ops_enqd = schedule_enqueue_ws(qp, ops,
+			nb_ops_to_enq);
+
+	scheduler_order_insert(order_ring, ops, nb_ops_enqd);
+
+	return nb_ops_enqd;
+}
+
 static uint16_t
 schedule_dequeue(void *qp, struct rte_crypto_op **ops, uint16_t nb_ops)
 {
@@ -179,6 +266,34 @@ slave_detach(__rte_unused struct rte_cryptodev *dev,
 	return 0;
 }
 
+/*
+ * Takes up to half of the backlog of the most loaded peer, if it has at
+ * least WS_SCHED_STEAL_THRESHOLD ops waiting.
+ */
+static uint16_t
+ws_steal_ops(struct mc_scheduler_ctx *mc_ctx, uint32_t worker_idx,
+		struct rte_crypto_op **ops)
+{
+	uint32_t i, count, victim = worker_idx;
+	uint32_t max_count = WS_SCHED_STEAL_THRESHOLD - 1;
+
+	for (i = 0; i < mc_ctx->num_workers; i++) {
+		if (i == worker_idx)
+			continue;
+		count = rte_ring_count(mc_ctx->sched_enq_ring[i]);
+		if (count > max_count) {
+			max_count = count;
+			victim = i;
+		}
+	}
+	if (victim == worker_idx)
+		return 0;
+
+	return rte_ring_mc_dequeue_burst(mc_ctx->sched_enq_ring[victim],
+			(void **)ops, RTE_MIN(max_count / 2,
+				(uint32_t)MC_SCHED_BUFFER_SIZE), NULL);
+}
+
 static int
 mc_scheduler_worker(struct rte_cryptodev *dev)
 {
@@ -198,6 +313,7 @@ mc_scheduler_worker(struct rte_cryptodev *dev)
 	uint16_t pending_deq_ops_idx = 0;
 	uint16_t inflight_ops = 0;
 	const uint8_t reordering_enabled = sched_ctx->reordering_enabled;
+	const uint32_t work_stealing = mc_ctx->work_stealing;
 
 	for (i = 0; i < (int)sched_ctx->nb_wc; i++) {
 		if (sched_ctx->wc_pool[i] == core_id) {
@@ -226,6 +342,9 @@ mc_scheduler_worker(struct rte_cryptodev *dev)
 		} else {
 			processed_ops = rte_ring_dequeue_burst(enq_ring, (void *)enq_ops,
 							MC_SCHED_BUFFER_SIZE, NULL);
+			if (processed_ops == 0 && work_stealing)
+				processed_ops = ws_steal_ops(mc_ctx, worker_idx,
+						enq_ops);
 			if (processed_ops) {
 				pending_enq_ops_idx = rte_cryptodev_enqueue_burst(
 							slave->dev_id, slave->qp_id,
@@ -284,10 +403,13 @@ scheduler_start(struct rte_cryptodev *dev)
 					sched_ctx->wc_pool[i]);
 
 	if (sched_ctx->reordering_enabled) {
-		dev->enqueue_burst = &schedule_enqueue_ordering;
+		dev->enqueue_burst = mc_ctx->work_stealing ?
+				&schedule_enqueue_ws_ordering :
+				&schedule_enqueue_ordering;
 		dev->dequeue_burst = &schedule_dequeue_ordering;
 	} else {
-		dev->enqueue_burst = &schedule_enqueue;
+		dev->enqueue_burst = mc_ctx->work_stealing ?
+				&schedule_enqueue_ws : &schedule_enqueue;
 		dev->dequeue_burst = &schedule_dequeue;
 	}
 
@@ -353,10 +475,20 @@ scheduler_config_qp(struct rte_cryptodev *dev, uint16_t qp_id)
 }
 
 static int
-scheduler_create_private_ctx(struct rte_cryptodev *dev)
+mc_scheduler_create_private_ctx(struct rte_cryptodev *dev,
+		uint32_t work_stealing)
 {
 	struct scheduler_ctx *sched_ctx = dev->data->dev_private;
 	struct mc_scheduler_ctx *mc_ctx;
+	/* the rings of a worker are dequeued by its peers when stealing */
+	const unsigned int enq_ring_flags = work_stealing ?
+			RING_F_SP_ENQ : RING_F_SC_DEQ | RING_F_SP_ENQ;
+	const char *enq_prefix = work_stealing ?
+			WS_SCHED_ENQ_RING_NAME_PREFIX :
+			MC_SCHED_ENQ_RING_NAME_PREFIX;
+	const char *deq_prefix = work_stealing ?
+			WS_SCHED_DEQ_RING_NAME_PREFIX :
+			MC_SCHED_DEQ_RING_NAME_PREFIX;
 	uint16_t i;
 
 	if (sched_ctx->private_ctx)
@@ -370,17 +502,18 @@ scheduler_create_private_ctx(struct rte_cryptodev *dev)
 	}
 
 	mc_ctx->num_workers = sched_ctx->nb_wc;
+	mc_ctx->work_stealing = work_stealing;
 	for (i = 0; i < sched_ctx->nb_wc; i++) {
 		char r_name[16];
 
-		snprintf(r_name, sizeof(r_name), MC_SCHED_ENQ_RING_NAME_PREFIX "%u", i);
+		snprintf(r_name, sizeof(r_name), "%s%u", enq_prefix, i);
 		mc_ctx->sched_enq_ring[i] = rte_ring_create(r_name, PER_SLAVE_BUFF_SIZE,
-					rte_socket_id(), RING_F_SC_DEQ | RING_F_SP_ENQ);
+					rte_socket_id(), enq_ring_flags);
 		if (!mc_ctx->sched_enq_ring[i]) {
 			CS_LOG_ERR("Cannot create ring for worker %u", i);
 			return -1;
 		}
-		snprintf(r_name, sizeof(r_name), MC_SCHED_DEQ_RING_NAME_PREFIX "%u", i);
+		snprintf(r_name, sizeof(r_name), "%s%u", deq_prefix, i);
 		mc_ctx->sched_deq_ring[i] = rte_ring_create(r_name, PER_SLAVE_BUFF_SIZE,
 					rte_socket_id(), RING_F_SC_DEQ | RING_F_SP_ENQ);
 		if (!mc_ctx->sched_deq_ring[i]) {
@@ -394,6 +527,18 @@ scheduler_create_private_ctx(struct rte_cryptodev *dev)
 	return 0;
 }
 
+static int
+scheduler_create_private_ctx(struct rte_cryptodev *dev)
+{
+	return mc_scheduler_create_private_ctx(dev, 0);
+}
+
+static int
+ws_scheduler_create_private_ctx(struct rte_cryptodev *dev)
+{
+	return mc_scheduler_create_private_ctx(dev, 1);
+}
+
 struct rte_cryptodev_scheduler_ops scheduler_mc_ops = {
 	slave_attach,
 	slave_detach,
@@ -413,3 +558,24 @@ struct rte_cryptodev_scheduler mc_scheduler = {
 };
 
 struct rte_cryptodev_scheduler *multicore_scheduler = &mc_scheduler;
+
+struct rte_cryptodev_scheduler_ops scheduler_ws_ops = {
+	slave_attach,
+	slave_detach,
+	scheduler_start,
+	scheduler_stop,
+	scheduler_config_qp,
+	ws_scheduler_create_private_ctx,
+	NULL,	/* option_set */
+	NULL	/* option_get */
+};
+
+struct rte_cryptodev_scheduler ws_scheduler = {
+		.name = "work-stealing-scheduler",
+		.description = "multi-core scheduler keeping sessions on one "
+				"core, with idle cores stealing bursts",
+		.mode = CDEV_SCHED_MODE_WORK_STEALING,
+		.ops = &scheduler_ws_ops
+};
+
+struct rte_cryptodev_scheduler *work_stealing_scheduler = &ws_scheduler;
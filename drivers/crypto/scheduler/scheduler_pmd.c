@@ -88,7 +88,9 @@ const struct scheduler_parse_map scheduler_mode_map[] = {
 	{RTE_STR(SCHEDULER_MODE_NAME_FAIL_OVER),
 			CDEV_SCHED_MODE_FAILOVER},
 	{RTE_STR(SCHEDULER_MODE_NAME_MULTI_CORE),
-			CDEV_SCHED_MODE_MULTICORE}
+			CDEV_SCHED_MODE_MULTICORE},
+	{RTE_STR(SCHEDULER_MODE_NAME_WORK_STEALING),
+			CDEV_SCHED_MODE_WORK_STEALING}
 };
 
 const struct scheduler_parse_map scheduler_ordering_map[] = {
@@ -125,7 +127,8 @@ cryptodev_scheduler_create(const char *name,
 	sched_ctx->max_nb_queue_pairs =
 			init_params->def_p.max_nb_queue_pairs;
 
-	if (init_params->mode == CDEV_SCHED_MODE_MULTICORE) {
+	if (init_params->mode == CDEV_SCHED_MODE_MULTICORE ||
+			init_params->mode == CDEV_SCHED_MODE_WORK_STEALING) {
 		uint16_t i;
 
 		sched_ctx->nb_wc = 0;
@@ -47,10 +47,36 @@
 #define NUMA_NODE_ARG "numa_node"
 #define SCHED_QUANTA_ARG "sched_quanta"
 #define CREDIT_QUANTA_ARG "credit_quanta"
+#define CQ_DEPTH_ADAPT_ARG "cq_depth_adapt"
+#define SCHED_SHARDS_ARG "sched_shards"
 
 static void
 sw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info);
 
+static void
+sw_port_release(void *port);
+
+/* The other shards schedule with their own copy of the port links, refresh
+ * it after the links set up on sw->ports change.
+ */
+static void
+sw_port_shards_update(struct sw_evdev *sw, const struct sw_port *p)
+{
+	unsigned int k;
+
+	for (k = 1; k < sw->nb_shards; k++) {
+		struct sw_port *sp;
+
+		if (sw->shards[k].ports == NULL)
+			continue;
+
+		sp = &sw->shards[k].ports[p->id];
+		sp->is_directed = p->is_directed;
+		sp->num_ordered_qids = p->num_ordered_qids;
+		sp->num_qids_mapped = p->num_qids_mapped;
+	}
+}
+
 static int
 sw_port_link(struct rte_eventdev *dev, void *port, const uint8_t queues[],
 		const uint8_t priorities[], uint16_t num)
@@ -100,6 +126,7 @@ sw_port_link(struct rte_eventdev *dev, void *port, const uint8_t queues[],
 		rte_smp_wmb();
 		q->cq_num_mapped_cqs++;
 	}
+	sw_port_shards_update(sw, p);
 	return i;
 }
 
@@ -131,6 +158,7 @@ sw_port_unlink(struct rte_eventdev *dev, void *port, uint8_t queues[],
 			}
 		}
 	}
+	sw_port_shards_update(sw, p);
 	return unlinked;
 }
 
@@ -141,7 +169,7 @@ sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 	struct sw_evdev *sw = sw_pmd_priv(dev);
 	struct sw_port *p = &sw->ports[port_id];
 	char buf[RTE_RING_NAMESIZE];
-	unsigned int i;
+	unsigned int i, k;
 
 	struct rte_event_dev_info info;
 	sw_info_get(dev, &info);
@@ -154,6 +182,9 @@ sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 		 * the sum to no leak credits
 		 */
 		int possible_inflights = p->inflight_credits + p->inflights;
+		for (k = 1; k < sw->nb_shards; k++)
+			possible_inflights +=
+				sw->shards[k].ports[port_id].inflights;
 		rte_atomic32_sub(&sw->inflights, possible_inflights);
 	}
 
@@ -198,13 +229,60 @@ sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 				port_id);
 		return -1;
 	}
-	sw->cq_ring_space[port_id] = conf->dequeue_depth;
+	sw->shards[0].cq_ring_space[port_id] = conf->dequeue_depth;
+	p->cq_depth = conf->dequeue_depth;
+	p->cq_used_last = 0;
+	p->cq_drain_max = 0;
+	p->cq_drain_samples = 0;
+	p->cq_drain_rate = 0;
 
 	/* set hist list contents to empty */
 	for (i = 0; i < SW_PORT_HIST_LIST; i++) {
 		p->hist_list[i].fid = -1;
 		p->hist_list[i].qid = -1;
 	}
+	p->rx_shard_ring[0] = p->rx_worker_ring;
+	p->cq_shard_ring[0] = p->cq_worker_ring;
+
+	/* the other shards have their own rings and scheduling state */
+	for (k = 1; k < sw->nb_shards; k++) {
+		struct sw_port *sp = &sw->shards[k].ports[port_id];
+
+		rte_event_ring_free(sp->rx_worker_ring);
+		rte_event_ring_free(sp->cq_worker_ring);
+		*sp = (struct sw_port){0};
+		sp->id = port_id;
+		sp->sw = sw;
+
+		snprintf(buf, sizeof(buf), "sw%d_p%u_s%u_rx_ring",
+				dev->data->dev_id, port_id, k);
+		sp->rx_worker_ring = rte_event_ring_create(buf,
+				MAX_SW_PROD_Q_DEPTH, dev->data->socket_id,
+				RING_F_SP_ENQ | RING_F_SC_DEQ |
+				RING_F_EXACT_SZ);
+		snprintf(buf, sizeof(buf), "sw%d_p%u_s%u_cq_ring",
+				dev->data->dev_id, port_id, k);
+		sp->cq_worker_ring = rte_event_ring_create(buf,
+				conf->dequeue_depth, dev->data->socket_id,
+				RING_F_SP_ENQ | RING_F_SC_DEQ |
+				RING_F_EXACT_SZ);
+		if (sp->rx_worker_ring == NULL || sp->cq_worker_ring == NULL) {
+			SW_LOG_ERR("Error creating shard %u rings for port %d\n",
+					k, port_id);
+			sw_port_release(p);
+			return -1;
+		}
+		sw->shards[k].cq_ring_space[port_id] = conf->dequeue_depth;
+		sp->cq_depth = conf->dequeue_depth;
+
+		for (i = 0; i < SW_PORT_HIST_LIST; i++) {
+			sp->hist_list[i].fid = -1;
+			sp->hist_list[i].qid = -1;
+		}
+		p->rx_shard_ring[k] = sp->rx_worker_ring;
+		p->cq_shard_ring[k] = sp->cq_worker_ring;
+		sp->initialized = 1;
+	}
 	dev->data->ports[port_id] = p;
 
 	rte_smp_wmb();
@@ -216,9 +294,21 @@ static void
 sw_port_release(void *port)
 {
 	struct sw_port *p = (void *)port;
+	unsigned int k;
+
 	if (p == NULL)
 		return;
 
+	for (k = 1; p->sw != NULL && k < p->sw->nb_shards; k++) {
+		struct sw_port *sp = &p->sw->shards[k].ports[p->id];
+
+		if (p->sw->shards[k].ports == NULL)
+			break;
+		rte_event_ring_free(sp->rx_worker_ring);
+		rte_event_ring_free(sp->cq_worker_ring);
+		memset(sp, 0, sizeof(*sp));
+	}
+
 	rte_event_ring_free(p->rx_worker_ring);
 	rte_event_ring_free(p->cq_worker_ring);
 	memset(p, 0, sizeof(*p));
@@ -229,6 +319,7 @@ qid_init(struct sw_evdev *sw, unsigned int idx, int type,
 		const struct rte_event_queue_conf *queue_conf)
 {
 	unsigned int i;
+	uint32_t nb_fids;
 	int dev_id = sw->data->dev_id;
 	int socket_id = sw->data->socket_id;
 	char buf[IQ_RING_NAMESIZE];
@@ -243,9 +334,24 @@ qid_init(struct sw_evdev *sw, unsigned int idx, int type,
 		}
 	}
 
+	/* Size the FID table for the flows of the queue, a power-of-2 so the
+	 * flow hash can be masked into it.
+	 */
+	nb_fids = RTE_MAX(queue_conf->nb_atomic_flows,
+			(uint32_t)SW_QID_NUM_FIDS);
+	nb_fids = RTE_MIN(rte_align32pow2(nb_fids), (uint32_t)SW_QID_MAX_FIDS);
+	rte_free(qid->fids);
+	qid->fids = rte_zmalloc_socket(NULL, nb_fids * sizeof(qid->fids[0]),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (!qid->fids) {
+		SW_LOG_DBG("fid table malloc failed\n");
+		goto cleanup;
+	}
+	qid->fid_mask = nb_fids - 1;
+
 	/* Initialize the FID structures to no pinning (-1), and zero packets */
-	const struct sw_fid_t fid = {.cq = -1, .pcount = 0};
-	for (i = 0; i < RTE_DIM(qid->fids); i++)
+	const struct sw_fid_t fid = {.cq = -1, .last_cq = -1, .pcount = 0};
+	for (i = 0; i < nb_fids; i++)
 		qid->fids[i] = fid;
 
 	qid->id = idx;
@@ -325,6 +431,9 @@ qid_init(struct sw_evdev *sw, unsigned int idx, int type,
 			iq_ring_destroy(qid->iq[i]);
 	}
 
+	rte_free(qid->fids);
+	qid->fids = NULL;
+
 	if (qid->reorder_buffer) {
 		rte_free(qid->reorder_buffer);
 		qid->reorder_buffer = NULL;
@@ -372,6 +481,7 @@ sw_queue_release(struct rte_eventdev *dev, uint8_t id)
 		rte_free(qid->reorder_buffer);
 		rte_ring_free(qid->reorder_buffer_freelist);
 	}
+	rte_free(qid->fids);
 	memset(qid, 0, sizeof(*qid));
 }
 
@@ -404,6 +514,84 @@ sw_port_def_conf(struct rte_eventdev *dev, uint8_t port_id,
 	port_conf->enqueue_depth = 16;
 }
 
+/* Allocate the port state and the rings between shards of a sharded
+ * scheduler. The state of shard 0 is always present in the device.
+ */
+static int
+sw_shards_init(struct sw_evdev *sw)
+{
+	const int dev_id = sw->data->dev_id;
+	const int socket_id = sw->data->socket_id;
+	char buf[RTE_RING_NAMESIZE];
+	unsigned int to, from;
+
+	for (to = 1; to < sw->nb_shards; to++) {
+		struct sw_shard *sh = &sw->shards[to];
+
+		if (sh->ports != NULL)
+			continue;
+		sh->ports = rte_zmalloc_socket(NULL,
+				SW_PORTS_MAX * sizeof(sh->ports[0]),
+				RTE_CACHE_LINE_SIZE, socket_id);
+		if (sh->ports == NULL) {
+			SW_LOG_ERR("Error allocating shard %u ports\n", to);
+			return -ENOMEM;
+		}
+	}
+
+	for (to = 0; to < sw->nb_shards; to++) {
+		for (from = 0; from < sw->nb_shards; from++) {
+			struct sw_xfer *x = &sw->shards[to].xfer[from];
+
+			if (from == to || x->ring != NULL)
+				continue;
+			snprintf(buf, sizeof(buf), "sw%d_x%u_%u", dev_id,
+					from, to);
+			struct rte_event_ring *existing_ring =
+					rte_event_ring_lookup(buf);
+			if (existing_ring)
+				rte_event_ring_free(existing_ring);
+			x->ring = rte_event_ring_create(buf,
+					SW_XFER_RING_SIZE, socket_id,
+					RING_F_SP_ENQ | RING_F_SC_DEQ);
+			if (x->ring == NULL) {
+				SW_LOG_ERR("Error creating shard %u to %u ring\n",
+						from, to);
+				return -ENOMEM;
+			}
+			x->buf_start = 0;
+			x->buf_count = 0;
+		}
+	}
+
+	return 0;
+}
+
+static void
+sw_shards_uninit(struct sw_evdev *sw)
+{
+	unsigned int to, from;
+
+	for (to = 0; to < sw->nb_shards; to++) {
+		struct sw_shard *sh = &sw->shards[to];
+
+		for (from = 0; from < sw->nb_shards; from++) {
+			rte_event_ring_free(sh->xfer[from].ring);
+			sh->xfer[from].ring = NULL;
+		}
+		memset(&sh->stats, 0, sizeof(sh->stats));
+		sh->sched_called = 0;
+		sh->sched_no_iq_enqueues = 0;
+		sh->sched_no_cq_enqueues = 0;
+		sh->sched_cq_qid_called = 0;
+
+		if (to == 0)
+			continue;
+		rte_free(sh->ports);
+		sh->ports = NULL;
+	}
+}
+
 static int
 sw_dev_configure(const struct rte_eventdev *dev)
 {
@@ -419,7 +607,7 @@ sw_dev_configure(const struct rte_eventdev *dev)
 	if (conf->event_dev_cfg & RTE_EVENT_DEV_CFG_PER_DEQUEUE_TIMEOUT)
 		return -ENOTSUP;
 
-	return 0;
+	return sw_shards_init(sw);
 }
 
 struct rte_eth_dev;
@@ -443,7 +631,7 @@ sw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info)
 	static const struct rte_event_dev_info evdev_sw_info = {
 			.driver_name = SW_PMD_NAME,
 			.max_event_queues = RTE_EVENT_MAX_QUEUES_PER_DEV,
-			.max_event_queue_flows = SW_QID_NUM_FIDS,
+			.max_event_queue_flows = SW_QID_MAX_FIDS,
 			.max_event_queue_priority_levels = SW_Q_PRIORITY_MAX,
 			.max_event_priority_levels = SW_IQS_MAX,
 			.max_event_ports = SW_PORTS_MAX,
@@ -470,12 +658,22 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 	fprintf(f, "EventDev %s: ports %d, qids %d\n", "todo-fix-name",
 			sw->port_count, sw->qid_count);
 
-	fprintf(f, "\trx   %"PRIu64"\n\tdrop %"PRIu64"\n\ttx   %"PRIu64"\n",
-		sw->stats.rx_pkts, sw->stats.rx_dropped, sw->stats.tx_pkts);
-	fprintf(f, "\tsched calls: %"PRIu64"\n", sw->sched_called);
-	fprintf(f, "\tsched cq/qid call: %"PRIu64"\n", sw->sched_cq_qid_called);
-	fprintf(f, "\tsched no IQ enq: %"PRIu64"\n", sw->sched_no_iq_enqueues);
-	fprintf(f, "\tsched no CQ enq: %"PRIu64"\n", sw->sched_no_cq_enqueues);
+	for (i = 0; i < sw->nb_shards; i++) {
+		const struct sw_shard *sh = &sw->shards[i];
+
+		if (sw->nb_shards > 1)
+			fprintf(f, "  Shard %u, qids %u\n", i, sh->qid_count);
+		fprintf(f, "\trx   %"PRIu64"\n\tdrop %"PRIu64"\n\ttx   %"
+			PRIu64"\n", sh->stats.rx_pkts, sh->stats.rx_dropped,
+			sh->stats.tx_pkts);
+		fprintf(f, "\tsched calls: %"PRIu64"\n", sh->sched_called);
+		fprintf(f, "\tsched cq/qid call: %"PRIu64"\n",
+			sh->sched_cq_qid_called);
+		fprintf(f, "\tsched no IQ enq: %"PRIu64"\n",
+			sh->sched_no_iq_enqueues);
+		fprintf(f, "\tsched no CQ enq: %"PRIu64"\n",
+			sh->sched_no_cq_enqueues);
+	}
 	uint32_t inflights = rte_atomic32_read(&sw->inflights);
 	uint32_t credits = sw->nb_events_limit - inflights;
 	fprintf(f, "\tinflight %d, credits: %d\n", inflights, credits);
@@ -506,6 +704,11 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 			sw->ports[i].inflight_max,
 			sw->ports[i].avg_pkt_ticks,
 			sw->ports[i].inflight_credits);
+		fprintf(f, "\tCQ depth: %u\tDequeue rate: %u"
+			"\tFlows migrated: %"PRIu64"\n",
+			sw->ports[i].cq_depth,
+			sw->ports[i].cq_drain_rate,
+			sw->ports[i].flows_migrated);
 		fprintf(f, "\tReceive burst distribution:\n");
 		float zp_percent = p->zero_polls * 100.0 / p->total_polls;
 		fprintf(f, zp_percent < 10 ? "\t\t0:%.02f%% " : "\t\t0:%.0f%% ",
@@ -572,7 +775,7 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 		}
 
 		uint32_t flow;
-		for (flow = 0; flow < RTE_DIM(qid->fids); flow++)
+		for (flow = 0; qid->fids && flow <= qid->fid_mask; flow++)
 			if (qid->fids[flow].cq != -1) {
 				affinities_per_port[qid->fids[flow].cq]++;
 				inflights += qid->fids[flow].pcount;
@@ -638,18 +841,29 @@ sw_start(struct rte_eventdev *dev)
 			return -ENOLINK;
 		}
 
+	/* spread the qids over the scheduler shards */
+	for (i = 0; i < sw->nb_shards; i++)
+		sw->shards[i].qid_count = 0;
+	for (i = 0; i < sw->qid_count; i++)
+		sw->qids[i].shard = i % sw->nb_shards;
+
+	/* the shards schedule with the port links set up on sw->ports */
+	for (i = 0; i < sw->port_count; i++)
+		sw_port_shards_update(sw, &sw->ports[i]);
+
 	/* build up our prioritized array of qids */
 	/* We don't use qsort here, as if all/multiple entries have the same
 	 * priority, the result is non-deterministic. From "man 3 qsort":
 	 * "If two members compare as equal, their order in the sorted
 	 * array is undefined."
 	 */
-	uint32_t qidx = 0;
 	for (j = 0; j <= RTE_EVENT_DEV_PRIORITY_LOWEST; j++) {
 		for (i = 0; i < sw->qid_count; i++) {
 			if (sw->qids[i].priority == j) {
-				sw->qids_prioritized[qidx] = &sw->qids[i];
-				qidx++;
+				struct sw_shard *sh =
+					&sw->shards[sw->qids[i].shard];
+				sh->qids_prioritized[sh->qid_count++] =
+					&sw->qids[i];
 			}
 		}
 	}
@@ -686,11 +900,7 @@ sw_close(struct rte_eventdev *dev)
 		sw_port_release(&sw->ports[i]);
 	sw->port_count = 0;
 
-	memset(&sw->stats, 0, sizeof(sw->stats));
-	sw->sched_called = 0;
-	sw->sched_no_iq_enqueues = 0;
-	sw->sched_no_cq_enqueues = 0;
-	sw->sched_cq_qid_called = 0;
+	sw_shards_uninit(sw);
 
 	return 0;
 }
@@ -726,6 +936,27 @@ set_credit_quanta(const char *key __rte_unused, const char *value, void *opaque)
 }
 
 
+static int
+set_cq_depth_adapt(const char *key __rte_unused, const char *value,
+		void *opaque)
+{
+	int *adapt = opaque;
+	*adapt = atoi(value);
+	if (*adapt < 0 || *adapt > 1)
+		return -1;
+	return 0;
+}
+
+static int
+set_sched_shards(const char *key __rte_unused, const char *value, void *opaque)
+{
+	int *shards = opaque;
+	*shards = atoi(value);
+	if (*shards < 1 || *shards > SW_SCHED_SHARDS_MAX)
+		return -1;
+	return 0;
+}
+
 static int32_t sw_sched_service_func(void *args)
 {
 	struct rte_eventdev *dev = args;
@@ -765,6 +996,8 @@ sw_probe(struct rte_vdev_device *vdev)
 		NUMA_NODE_ARG,
 		SCHED_QUANTA_ARG,
 		CREDIT_QUANTA_ARG,
+		CQ_DEPTH_ADAPT_ARG,
+		SCHED_SHARDS_ARG,
 		NULL
 	};
 	const char *name;
@@ -774,6 +1007,9 @@ sw_probe(struct rte_vdev_device *vdev)
 	int socket_id = rte_socket_id();
 	int sched_quanta  = SW_DEFAULT_SCHED_QUANTA;
 	int credit_quanta = SW_DEFAULT_CREDIT_QUANTA;
+	int cq_depth_adapt = 1;
+	int sched_shards = 1;
+	unsigned int i;
 
 	name = rte_vdev_device_name(vdev);
 	params = rte_vdev_device_args(vdev);
@@ -815,13 +1051,34 @@ sw_probe(struct rte_vdev_device *vdev)
 				return ret;
 			}
 
+			ret = rte_kvargs_process(kvlist, CQ_DEPTH_ADAPT_ARG,
+					set_cq_depth_adapt, &cq_depth_adapt);
+			if (ret != 0) {
+				SW_LOG_ERR(
+					"%s: Error parsing cq depth adapt parameter",
+					name);
+				rte_kvargs_free(kvlist);
+				return ret;
+			}
+
+			ret = rte_kvargs_process(kvlist, SCHED_SHARDS_ARG,
+					set_sched_shards, &sched_shards);
+			if (ret != 0) {
+				SW_LOG_ERR(
+					"%s: Error parsing sched shards parameter",
+					name);
+				rte_kvargs_free(kvlist);
+				return ret;
+			}
+
 			rte_kvargs_free(kvlist);
 		}
 	}
 
 	SW_LOG_INFO(
-			"Creating eventdev sw device %s, numa_node=%d, sched_quanta=%d, credit_quanta=%d\n",
-			name, socket_id, sched_quanta, credit_quanta);
+			"Creating eventdev sw device %s, numa_node=%d, sched_quanta=%d, credit_quanta=%d, cq_depth_adapt=%d, sched_shards=%d\n",
+			name, socket_id, sched_quanta, credit_quanta,
+			cq_depth_adapt, sched_shards);
 
 	dev = rte_event_pmd_vdev_init(name,
 			sizeof(struct sw_evdev), socket_id);
@@ -830,12 +1087,21 @@ sw_probe(struct rte_vdev_device *vdev)
 		return -EFAULT;
 	}
 	dev->dev_ops = &evdev_sw_ops;
-	dev->enqueue = sw_event_enqueue;
-	dev->enqueue_burst = sw_event_enqueue_burst;
-	dev->enqueue_new_burst = sw_event_enqueue_burst;
-	dev->enqueue_forward_burst = sw_event_enqueue_burst;
-	dev->dequeue = sw_event_dequeue;
-	dev->dequeue_burst = sw_event_dequeue_burst;
+	if (sched_shards > 1) {
+		dev->enqueue = sw_event_enqueue_sharded;
+		dev->enqueue_burst = sw_event_enqueue_burst_sharded;
+		dev->enqueue_new_burst = sw_event_enqueue_burst_sharded;
+		dev->enqueue_forward_burst = sw_event_enqueue_burst_sharded;
+		dev->dequeue = sw_event_dequeue_sharded;
+		dev->dequeue_burst = sw_event_dequeue_burst_sharded;
+	} else {
+		dev->enqueue = sw_event_enqueue;
+		dev->enqueue_burst = sw_event_enqueue_burst;
+		dev->enqueue_new_burst = sw_event_enqueue_burst;
+		dev->enqueue_forward_burst = sw_event_enqueue_burst;
+		dev->dequeue = sw_event_dequeue;
+		dev->dequeue_burst = sw_event_dequeue_burst;
+	}
 
 	if (rte_eal_process_type() != RTE_PROC_PRIMARY)
 		return 0;
@@ -846,6 +1112,15 @@ sw_probe(struct rte_vdev_device *vdev)
 	/* copy values passed from vdev command line to instance */
 	sw->credit_update_quanta = credit_quanta;
 	sw->sched_quanta = sched_quanta;
+	sw->cq_depth_adapt = cq_depth_adapt;
+
+	sw->nb_shards = sched_shards;
+	for (i = 0; i < SW_SCHED_SHARDS_MAX; i++) {
+		sw->shards[i].sw = sw;
+		sw->shards[i].id = i;
+		rte_spinlock_init(&sw->shards[i].lock);
+	}
+	sw->shards[0].ports = sw->ports;
 
 	/* register service with EAL */
 	struct rte_service_spec service;
@@ -856,6 +1131,9 @@ sw_probe(struct rte_vdev_device *vdev)
 	service.socket_id = socket_id;
 	service.callback = sw_sched_service_func;
 	service.callback_userdata = (void *)dev;
+	/* several lcores can run the service, each scheduling a shard */
+	if (sched_shards > 1)
+		service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
 
 	int32_t ret = rte_service_component_register(&service, &sw->service_id);
 	if (ret) {
@@ -890,4 +1168,5 @@ static struct rte_vdev_driver evdev_sw_pmd_drv = {
 
 RTE_PMD_REGISTER_VDEV(EVENTDEV_NAME_SW_PMD, evdev_sw_pmd_drv);
 RTE_PMD_REGISTER_PARAM_STRING(event_sw, NUMA_NODE_ARG "=<int> "
-		SCHED_QUANTA_ARG "=<int>" CREDIT_QUANTA_ARG "=<int>");
+		SCHED_QUANTA_ARG "=<int>" CREDIT_QUANTA_ARG "=<int> "
+		CQ_DEPTH_ADAPT_ARG "=<0|1> " SCHED_SHARDS_ARG "=<int>");
@@ -36,10 +36,13 @@
 #include <rte_eventdev.h>
 #include <rte_eventdev_pmd_vdev.h>
 #include <rte_atomic.h>
+#include <rte_spinlock.h>
 
 #define SW_DEFAULT_CREDIT_QUANTA 32
 #define SW_DEFAULT_SCHED_QUANTA 128
 #define SW_QID_NUM_FIDS 16384
+/* flow_id is a 20 bit field of struct rte_event */
+#define SW_QID_MAX_FIDS (1 << 20)
 #define SW_IQS_MAX 4
 #define SW_Q_PRIORITY_MAX 255
 #define SW_PORTS_MAX 64
@@ -48,6 +51,14 @@
 /* allow for lots of over-provisioning */
 #define MAX_SW_PROD_Q_DEPTH 4096
 #define SW_FRAGMENTS_MAX 16
+/* smallest CQ depth the scheduler adapts a load-balanced port down to */
+#define SW_CQ_DEPTH_MIN 8
+/* scheduler calls with a non-empty CQ sampled to adapt its depth */
+#define SW_CQ_DEPTH_SAMPLES 16
+/* max scheduler shards, each scheduling a subset of the QIDs */
+#define SW_SCHED_SHARDS_MAX 4
+/* size of the rings forwarding events from one shard to another */
+#define SW_XFER_RING_SIZE 4096
 
 /* report dequeue burst sizes in buckets */
 #define SW_DEQ_STAT_BUCKET_SHIFT 2
@@ -118,7 +129,9 @@ struct sw_point_stats {
 /* structure used to track what port a flow (FID) is pinned to */
 struct sw_fid_t {
 	/* which CQ this FID is currently pinned to */
-	int32_t cq;
+	int16_t cq;
+	/* which CQ this FID was last pinned to, to count migrations */
+	int16_t last_cq;
 	/* number of packets gone to the CQ with this FID */
 	uint32_t pcount;
 };
@@ -140,6 +153,8 @@ struct sw_qid {
 	 */
 	uint32_t id;
 	struct sw_point_stats stats;
+	/* The scheduler shard owning this QID */
+	uint8_t shard;
 
 	/* Internal priority rings for packets */
 	struct iq_ring *iq[SW_IQS_MAX];
@@ -152,8 +167,11 @@ struct sw_qid {
 	uint32_t cq_map[SW_PORTS_MAX];
 	uint64_t to_port[SW_PORTS_MAX];
 
-	/* Track flow ids for atomic load balancing */
-	struct sw_fid_t fids[SW_QID_NUM_FIDS];
+	/* Track flow ids for atomic load balancing, sized from the
+	 * nb_atomic_flows of the queue configuration
+	 */
+	struct sw_fid_t *fids;
+	uint32_t fid_mask; /* number of fids - 1, a power of 2 minus 1 */
 
 	/* Track packet order for reordering when needed */
 	struct reorder_buffer_entry *reorder_buffer; /*< pkts await reorder */
@@ -219,6 +237,18 @@ struct sw_port {
 	/* track packets in and out of this port */
 	struct sw_point_stats stats;
 
+	/* CQ depth adaptation, only for load-balanced ports. The scheduler
+	 * fills the CQ up to cq_depth events, which follows the number of
+	 * events the worker dequeues between two scheduler calls.
+	 */
+	uint16_t cq_depth;
+	uint16_t cq_used_last; /* CQ ring used count after the last flush */
+	uint16_t cq_drain_max; /* max events drained in the sample window */
+	uint16_t cq_drain_samples;
+	uint16_t cq_drain_rate; /* cq_drain_max of the last window */
+	/* atomic flows pinned to this port after being on another port */
+	uint64_t flows_migrated;
+
 
 	uint32_t pp_buf_start;
 	uint32_t pp_buf_count;
@@ -227,8 +257,62 @@ struct sw_port {
 	struct rte_event cq_buf[MAX_SW_CONS_Q_DEPTH];
 
 	uint8_t num_qids_mapped;
+
+	/* Rings to and from each scheduler shard, the rings of shard 0 being
+	 * rx_worker_ring and cq_worker_ring. Only used by the worker side of
+	 * the port in sw->ports.
+	 */
+	struct rte_event_ring *rx_shard_ring[SW_SCHED_SHARDS_MAX];
+	struct rte_event_ring *cq_shard_ring[SW_SCHED_SHARDS_MAX];
+	/* shard CQ polled first by the next dequeue */
+	uint8_t deq_shard_next;
+	/* shard each event of the last dequeue came from, so its release is
+	 * sent to the shard holding its history
+	 */
+	uint8_t deq_shard[MAX_SW_CONS_Q_DEPTH];
+};
+
+/* Events forwarded to the QIDs of a shard by another shard */
+struct sw_xfer {
+	struct rte_event_ring *ring;
+	uint32_t buf_start;
+	uint32_t buf_count;
+	struct rte_event buf[SCHED_DEQUEUE_BURST_SIZE];
 };
 
+/*
+ * A scheduler shard schedules the QIDs it owns, with its own copy of the
+ * scheduling state of each port. Shards run concurrently on the lcores
+ * mapped to the service of the device.
+ */
+struct sw_shard {
+	struct sw_evdev *sw;
+	uint8_t id;
+	rte_spinlock_t lock;
+
+	/* Scheduling state of each port for this shard. For shard 0 these
+	 * are the ports in sw->ports.
+	 */
+	struct sw_port *ports;
+
+	/* Cache how many packets are in each cq */
+	uint16_t cq_ring_space[SW_PORTS_MAX] __rte_cache_aligned;
+
+	/* Array of pointers to owned QIDs sorted by priority level */
+	uint32_t qid_count;
+	struct sw_qid *qids_prioritized[RTE_EVENT_MAX_QUEUES_PER_DEV];
+
+	/* Events from each other shard to the QIDs of this one */
+	struct sw_xfer xfer[SW_SCHED_SHARDS_MAX];
+
+	/* Stats */
+	struct sw_point_stats stats __rte_cache_aligned;
+	uint64_t sched_called;
+	uint64_t sched_no_iq_enqueues;
+	uint64_t sched_no_cq_enqueues;
+	uint64_t sched_cq_qid_called;
+} __rte_cache_aligned;
+
 struct sw_evdev {
 	struct rte_eventdev_data *data;
 
@@ -254,22 +338,16 @@ struct sw_evdev {
 	/* Internal queues - one per logical queue */
 	struct sw_qid qids[RTE_EVENT_MAX_QUEUES_PER_DEV] __rte_cache_aligned;
 
-	/* Cache how many packets are in each cq */
-	uint16_t cq_ring_space[SW_PORTS_MAX] __rte_cache_aligned;
+	/* Scheduler shards, each scheduling a subset of the QIDs */
+	uint8_t nb_shards;
+	struct sw_shard shards[SW_SCHED_SHARDS_MAX];
 
-	/* Array of pointers to load-balanced QIDs sorted by priority level */
-	struct sw_qid *qids_prioritized[RTE_EVENT_MAX_QUEUES_PER_DEV];
-
-	/* Stats */
-	struct sw_point_stats stats __rte_cache_aligned;
-	uint64_t sched_called;
 	int32_t sched_quanta;
-	uint64_t sched_no_iq_enqueues;
-	uint64_t sched_no_cq_enqueues;
-	uint64_t sched_cq_qid_called;
 
 	uint8_t started;
 	uint32_t credit_update_quanta;
+	/* set when CQ depths adapt to the worker dequeue rates */
+	uint8_t cq_depth_adapt;
 
 	/* store num stats and offset of the stats for each port */
 	uint16_t xstats_count_per_port[SW_PORTS_MAX];
@@ -301,6 +379,13 @@ uint16_t sw_event_enqueue_burst(void *port, const struct rte_event ev[],
 uint16_t sw_event_dequeue(void *port, struct rte_event *ev, uint64_t wait);
 uint16_t sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
 			uint64_t wait);
+uint16_t sw_event_enqueue_sharded(void *port, const struct rte_event *ev);
+uint16_t sw_event_enqueue_burst_sharded(void *port, const struct rte_event ev[],
+		uint16_t num);
+uint16_t sw_event_dequeue_sharded(void *port, struct rte_event *ev,
+		uint64_t wait);
+uint16_t sw_event_dequeue_burst_sharded(void *port, struct rte_event *ev,
+		uint16_t num, uint64_t wait);
 void sw_event_schedule(struct rte_eventdev *dev);
 int sw_xstats_init(struct sw_evdev *dev);
 int sw_xstats_uninit(struct sw_evdev *dev);
@@ -50,12 +50,59 @@
 #define PRIO_TO_IQ(prio) (prio >> 6)
 
 #define MAX_PER_IQ_DEQUEUE 48
-#define FLOWID_MASK (SW_QID_NUM_FIDS-1)
 /* use cheap bit mixing, we only need to lose a few bits */
-#define SW_HASH_FLOWID(f) (((f) ^ (f >> 10)) & FLOWID_MASK)
+#define SW_HASH_FLOWID(f, mask) (((f) ^ (f >> 10)) & (mask))
+
+/* Reduce the CQ space seen by the scheduler to the adapted CQ depth */
+static __rte_always_inline void
+sw_cq_space_clamp(struct sw_shard *sh, uint32_t cq)
+{
+	const struct sw_port *p = &sh->ports[cq];
+	const uint16_t reserved =
+		rte_event_ring_get_capacity(p->cq_worker_ring) - p->cq_depth;
+
+	sh->cq_ring_space[cq] = sh->cq_ring_space[cq] > reserved ?
+			sh->cq_ring_space[cq] - reserved : 0;
+}
+
+/* Load of a CQ for atomic flow placement: the events scheduled to the port
+ * and not yet released, which includes the events its worker is processing.
+ * A CQ without space is never the least loaded.
+ */
+static __rte_always_inline uint32_t
+sw_cq_load(const struct sw_shard *sh, uint32_t cq)
+{
+	if (sh->cq_ring_space[cq] == 0)
+		return UINT32_MAX;
+	return sh->ports[cq].inflights;
+}
+
+/* Ring carrying events from this shard to the shard owning a QID */
+static __rte_always_inline struct rte_event_ring *
+sw_xfer_ring(const struct sw_shard *sh, const struct sw_qid *qid)
+{
+	return sh->sw->shards[qid->shard].xfer[sh->id].ring;
+}
+
+static __rte_always_inline int
+sw_xfer_full(const struct sw_shard *sh, const struct sw_qid *qid)
+{
+	return rte_event_ring_free_count(sw_xfer_ring(sh, qid)) == 0;
+}
+
+/* Forward an event to a QID of another shard, returns 0 if the ring to
+ * that shard is full
+ */
+static __rte_always_inline unsigned int
+sw_xfer_enqueue(struct sw_shard *sh, const struct sw_qid *qid,
+		const struct rte_event *qe)
+{
+	return rte_event_ring_enqueue_burst(sw_xfer_ring(sh, qid), qe, 1,
+			NULL);
+}
 
 static inline uint32_t
-sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
+sw_schedule_atomic_to_cq(struct sw_shard *sh, struct sw_qid * const qid,
 		uint32_t iq_num, unsigned int count)
 {
 	struct rte_event qes[MAX_PER_IQ_DEQUEUE]; /* count <= MAX */
@@ -74,7 +121,8 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 	iq_ring_dequeue_burst(qid->iq[iq_num], qes, count);
 	for (i = 0; i < count; i++) {
 		const struct rte_event *qe = &qes[i];
-		const uint16_t flow_id = SW_HASH_FLOWID(qes[i].flow_id);
+		const uint32_t flow_id = SW_HASH_FLOWID(qes[i].flow_id,
+				qid->fid_mask);
 		struct sw_fid_t *fid = &qid->fids[flow_id];
 		int cq = fid->cq;
 
@@ -84,34 +132,39 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 				qid->cq_next_tx = 0;
 			cq = qid->cq_map[cq_idx];
 
-			/* find least used */
-			int cq_free_cnt = sw->cq_ring_space[cq];
+			/* The flow has no event in flight, so it can move to
+			 * any port: find the least loaded one.
+			 */
+			uint32_t cq_load = sw_cq_load(sh, cq);
 			for (cq_idx = 0; cq_idx < qid->cq_num_mapped_cqs;
 					cq_idx++) {
 				int test_cq = qid->cq_map[cq_idx];
-				int test_cq_free = sw->cq_ring_space[test_cq];
-				if (test_cq_free > cq_free_cnt) {
+				uint32_t test_cq_load = sw_cq_load(sh, test_cq);
+				if (test_cq_load < cq_load) {
 					cq = test_cq;
-					cq_free_cnt = test_cq_free;
+					cq_load = test_cq_load;
 				}
 			}
 
+			if (fid->last_cq >= 0 && fid->last_cq != cq)
+				sh->ports[cq].flows_migrated++;
 			fid->cq = cq; /* this pins early */
+			fid->last_cq = cq;
 		}
 
-		if (sw->cq_ring_space[cq] == 0 ||
-				sw->ports[cq].inflights == SW_PORT_HIST_LIST) {
+		if (sh->cq_ring_space[cq] == 0 ||
+				sh->ports[cq].inflights == SW_PORT_HIST_LIST) {
 			blocked_qes[nb_blocked++] = *qe;
 			continue;
 		}
 
-		struct sw_port *p = &sw->ports[cq];
+		struct sw_port *p = &sh->ports[cq];
 
 		/* at this point we can queue up the packet on the cq_buf */
 		fid->pcount++;
 		p->cq_buf[p->cq_buf_count++] = *qe;
 		p->inflights++;
-		sw->cq_ring_space[cq]--;
+		sh->cq_ring_space[cq]--;
 
 		int head = (p->hist_head++ & (SW_PORT_HIST_LIST-1));
 		p->hist_list[head].fid = flow_id;
@@ -122,12 +175,13 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 		qid->to_port[cq]++;
 
 		/* if we just filled in the last slot, flush the buffer */
-		if (sw->cq_ring_space[cq] == 0) {
+		if (sh->cq_ring_space[cq] == 0) {
 			struct rte_event_ring *worker = p->cq_worker_ring;
 			rte_event_ring_enqueue_burst(worker, p->cq_buf,
 					p->cq_buf_count,
-					&sw->cq_ring_space[cq]);
+					&sh->cq_ring_space[cq]);
 			p->cq_buf_count = 0;
+			sw_cq_space_clamp(sh, cq);
 		}
 	}
 	iq_ring_put_back(qid->iq[iq_num], blocked_qes, nb_blocked);
@@ -136,7 +190,7 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 }
 
 static inline uint32_t
-sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
+sw_schedule_parallel_to_cq(struct sw_shard *sh, struct sw_qid * const qid,
 		uint32_t iq_num, unsigned int count, int keep_order)
 {
 	uint32_t i;
@@ -172,27 +226,28 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 			if (++cq_idx == qid->cq_num_mapped_cqs)
 				cq_idx = 0;
 		} while (rte_event_ring_free_count(
-				sw->ports[cq].cq_worker_ring) == 0 ||
-				sw->ports[cq].inflights == SW_PORT_HIST_LIST);
+				sh->ports[cq].cq_worker_ring) == 0 ||
+				sh->ports[cq].inflights == SW_PORT_HIST_LIST);
 
-		struct sw_port *p = &sw->ports[cq];
-		if (sw->cq_ring_space[cq] == 0 ||
+		struct sw_port *p = &sh->ports[cq];
+		if (sh->cq_ring_space[cq] == 0 ||
 				p->inflights == SW_PORT_HIST_LIST)
 			break;
 
-		sw->cq_ring_space[cq]--;
+		sh->cq_ring_space[cq]--;
 
 		qid->stats.tx_pkts++;
 
 		const int head = (p->hist_head & (SW_PORT_HIST_LIST-1));
-		p->hist_list[head].fid = SW_HASH_FLOWID(qe->flow_id);
+		p->hist_list[head].fid = SW_HASH_FLOWID(qe->flow_id,
+				qid->fid_mask);
 		p->hist_list[head].qid = qid_id;
 
 		if (keep_order)
 			rte_ring_sc_dequeue(qid->reorder_buffer_freelist,
 					(void *)&p->hist_list[head].rob_entry);
 
-		sw->ports[cq].cq_buf[sw->ports[cq].cq_buf_count++] = *qe;
+		sh->ports[cq].cq_buf[sh->ports[cq].cq_buf_count++] = *qe;
 		iq_ring_pop(qid->iq[iq_num]);
 
 		rte_compiler_barrier();
@@ -206,14 +261,14 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 }
 
 static uint32_t
-sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
+sw_schedule_dir_to_cq(struct sw_shard *sh, struct sw_qid * const qid,
 		uint32_t iq_num, unsigned int count __rte_unused)
 {
 	uint32_t cq_id = qid->cq_map[0];
-	struct sw_port *port = &sw->ports[cq_id];
+	struct sw_port *port = &sh->ports[cq_id];
 
 	/* get max burst enq size for cq_ring */
-	uint32_t count_free = sw->cq_ring_space[cq_id];
+	uint32_t count_free = sh->cq_ring_space[cq_id];
 	if (count_free == 0)
 		return 0;
 
@@ -228,21 +283,21 @@ sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 	port->stats.tx_pkts += ret;
 
 	/* Subtract credits from cached value */
-	sw->cq_ring_space[cq_id] -= ret;
+	sh->cq_ring_space[cq_id] -= ret;
 
 	return ret;
 }
 
 static uint32_t
-sw_schedule_qid_to_cq(struct sw_evdev *sw)
+sw_schedule_qid_to_cq(struct sw_shard *sh)
 {
 	uint32_t pkts = 0;
 	uint32_t qid_idx;
 
-	sw->sched_cq_qid_called++;
+	sh->sched_cq_qid_called++;
 
-	for (qid_idx = 0; qid_idx < sw->qid_count; qid_idx++) {
-		struct sw_qid *qid = sw->qids_prioritized[qid_idx];
+	for (qid_idx = 0; qid_idx < sh->qid_count; qid_idx++) {
+		struct sw_qid *qid = sh->qids_prioritized[qid_idx];
 
 		int type = qid->type;
 		int iq_num = PKT_MASK_TO_IQ(qid->iq_pkt_mask);
@@ -256,13 +311,13 @@ sw_schedule_qid_to_cq(struct sw_evdev *sw)
 
 		if (count > 0) {
 			if (type == SW_SCHED_TYPE_DIRECT)
-				pkts_done += sw_schedule_dir_to_cq(sw, qid,
+				pkts_done += sw_schedule_dir_to_cq(sh, qid,
 						iq_num, count);
 			else if (type == RTE_SCHED_TYPE_ATOMIC)
-				pkts_done += sw_schedule_atomic_to_cq(sw, qid,
+				pkts_done += sw_schedule_atomic_to_cq(sh, qid,
 						iq_num, count);
 			else
-				pkts_done += sw_schedule_parallel_to_cq(sw, qid,
+				pkts_done += sw_schedule_parallel_to_cq(sh, qid,
 						iq_num, count,
 						type == RTE_SCHED_TYPE_ORDERED);
 		}
@@ -284,8 +339,9 @@ sw_schedule_qid_to_cq(struct sw_evdev *sw)
  * contiguous in that array, this function accepts a "range" of QIDs to scan.
  */
 static uint16_t
-sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
+sw_schedule_reorder(struct sw_shard *sh, int qid_start, int qid_end)
 {
+	struct sw_evdev *sw = sh->sw;
 	/* Perform egress reordering */
 	struct rte_event *qe;
 	uint32_t pkts_iter = 0;
@@ -294,7 +350,8 @@ sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
 		struct sw_qid *qid = &sw->qids[qid_start];
 		int i, num_entries_in_use;
 
-		if (qid->type != RTE_SCHED_TYPE_ORDERED)
+		if (qid->type != RTE_SCHED_TYPE_ORDERED ||
+				qid->shard != sh->id)
 			continue;
 
 		num_entries_in_use = rte_ring_free_count(
@@ -320,12 +377,20 @@ sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
 				dest_iq  = PRIO_TO_IQ(qe->priority);
 
 				if (dest_qid >= sw->qid_count) {
-					sw->stats.rx_dropped++;
+					sh->stats.rx_dropped++;
 					continue;
 				}
 
 				struct sw_qid *dest_qid_ptr =
 					&sw->qids[dest_qid];
+
+				if (dest_qid_ptr->shard != sh->id) {
+					if (!sw_xfer_enqueue(sh, dest_qid_ptr,
+							qe))
+						break;
+					continue;
+				}
+
 				const struct iq_ring *dest_iq_ptr =
 					dest_qid_ptr->iq[dest_iq];
 				if (iq_ring_free_count(dest_iq_ptr) == 0)
@@ -365,9 +430,9 @@ sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
 }
 
 static __rte_always_inline void
-sw_refill_pp_buf(struct sw_evdev *sw, struct sw_port *port)
+sw_refill_pp_buf(struct sw_shard *sh, struct sw_port *port)
 {
-	RTE_SET_USED(sw);
+	RTE_SET_USED(sh);
 	struct rte_event_ring *worker = port->rx_worker_ring;
 	port->pp_buf_start = 0;
 	port->pp_buf_count = rte_event_ring_dequeue_burst(worker, port->pp_buf,
@@ -375,15 +440,16 @@ sw_refill_pp_buf(struct sw_evdev *sw, struct sw_port *port)
 }
 
 static __rte_always_inline uint32_t
-__pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
+__pull_port_lb(struct sw_shard *sh, uint32_t port_id, int allow_reorder)
 {
 	static struct reorder_buffer_entry dummy_rob;
+	struct sw_evdev *sw = sh->sw;
 	uint32_t pkts_iter = 0;
-	struct sw_port *port = &sw->ports[port_id];
+	struct sw_port *port = &sh->ports[port_id];
 
 	/* If shadow ring has 0 pkts, pull from worker ring */
 	if (port->pp_buf_count == 0)
-		sw_refill_pp_buf(sw, port);
+		sw_refill_pp_buf(sh, port);
 
 	while (port->pp_buf_count) {
 		const struct rte_event *qe = &port->pp_buf[port->pp_buf_start];
@@ -403,10 +469,18 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 		 */
 		uint32_t iq_num = PRIO_TO_IQ(qe->priority);
 		struct sw_qid *qid = &sw->qids[qe->queue_id];
+		/* a forward to a QID of another shard goes through the ring
+		 * to that shard. Only valid events carry a QID, so the QID
+		 * of a release is not looked at.
+		 */
+		int foreign = 0;
 
-		if ((flags & QE_FLAG_VALID) &&
-				iq_ring_free_count(qid->iq[iq_num]) == 0)
-			break;
+		if (flags & QE_FLAG_VALID) {
+			foreign = (qid->shard != sh->id);
+			if (unlikely(foreign) ? sw_xfer_full(sh, qid) :
+					iq_ring_free_count(qid->iq[iq_num]) == 0)
+				break;
+		}
 
 		/* now process based on flags. Note that for directed
 		 * queues, the enqueue_flush masks off all but the
@@ -458,7 +532,7 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 				 */
 				int num_frag = rob_entry->num_fragments;
 				if (num_frag == SW_FRAGMENTS_MAX)
-					sw->stats.rx_dropped++;
+					sh->stats.rx_dropped++;
 				else {
 					int idx = rob_entry->num_fragments++;
 					rob_entry->fragments[idx] = *qe;
@@ -466,6 +540,11 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 				goto end_qe;
 			}
 
+			if (unlikely(foreign)) {
+				sw_xfer_enqueue(sh, qid, qe);
+				goto end_qe;
+			}
+
 			/* Use the iq_num from above to push the QE
 			 * into the qid at the right priority
 			 */
@@ -486,26 +565,27 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 }
 
 static uint32_t
-sw_schedule_pull_port_lb(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_lb(struct sw_shard *sh, uint32_t port_id)
 {
-	return __pull_port_lb(sw, port_id, 1);
+	return __pull_port_lb(sh, port_id, 1);
 }
 
 static uint32_t
-sw_schedule_pull_port_no_reorder(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_no_reorder(struct sw_shard *sh, uint32_t port_id)
 {
-	return __pull_port_lb(sw, port_id, 0);
+	return __pull_port_lb(sh, port_id, 0);
 }
 
 static uint32_t
-sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_dir(struct sw_shard *sh, uint32_t port_id)
 {
+	struct sw_evdev *sw = sh->sw;
 	uint32_t pkts_iter = 0;
-	struct sw_port *port = &sw->ports[port_id];
+	struct sw_port *port = &sh->ports[port_id];
 
 	/* If shadow ring has 0 pkts, pull from worker ring */
 	if (port->pp_buf_count == 0)
-		sw_refill_pp_buf(sw, port);
+		sw_refill_pp_buf(sh, port);
 
 	while (port->pp_buf_count) {
 		const struct rte_event *qe = &port->pp_buf[port->pp_buf_start];
@@ -540,19 +620,105 @@ sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
 	return pkts_iter;
 }
 
-void
-sw_event_schedule(struct rte_eventdev *dev)
+/*
+ * Adapt the depth of the CQs of load-balanced ports to the rate their
+ * workers dequeue at: over a window of scheduler calls, the CQ depth is set
+ * to twice the most events a worker dequeued between two calls. A slow
+ * worker then holds few events in its CQ, which stay in the QID for the
+ * other ports, while a fast worker always has events to dequeue. The CQ
+ * space seen by the scheduler is refreshed with the worker progress.
+ */
+static void
+sw_cq_depth_adapt(struct sw_shard *sh)
 {
-	struct sw_evdev *sw = sw_pmd_priv(dev);
+	uint32_t i;
+
+	for (i = 0; i < sh->sw->port_count; i++) {
+		struct sw_port *p = &sh->ports[i];
+		const uint16_t cap =
+			rte_event_ring_get_capacity(p->cq_worker_ring);
+		const uint16_t used = rte_event_ring_count(p->cq_worker_ring);
+
+		if (p->is_directed)
+			continue;
+
+		if (p->cq_used_last) {
+			/* only the worker dequeues since the last flush */
+			const uint16_t drained = p->cq_used_last - used;
+
+			if (drained > p->cq_drain_max)
+				p->cq_drain_max = drained;
+			if (++p->cq_drain_samples == SW_CQ_DEPTH_SAMPLES) {
+				/* no dequeue at all tells nothing of the
+				 * worker rate, keep the depth
+				 */
+				if (p->cq_drain_max)
+					p->cq_depth = RTE_MIN(cap, RTE_MAX(
+						SW_CQ_DEPTH_MIN,
+						2 * p->cq_drain_max));
+				p->cq_drain_rate = p->cq_drain_max;
+				p->cq_drain_max = 0;
+				p->cq_drain_samples = 0;
+			}
+		}
+
+		sh->cq_ring_space[i] = cap - used;
+		sw_cq_space_clamp(sh, i);
+	}
+}
+
+/* Pull the events forwarded to the QIDs of this shard by another shard */
+static uint32_t
+sw_schedule_pull_xfer(struct sw_shard *sh, uint32_t from)
+{
+	struct sw_xfer *x = &sh->xfer[from];
+	uint32_t pkts_iter = 0;
+
+	if (x->buf_count == 0) {
+		x->buf_start = 0;
+		x->buf_count = rte_event_ring_dequeue_burst(x->ring, x->buf,
+				RTE_DIM(x->buf), NULL);
+	}
+
+	while (x->buf_count) {
+		const struct rte_event *qe = &x->buf[x->buf_start];
+		uint32_t iq_num = PRIO_TO_IQ(qe->priority);
+		struct sw_qid *qid = &sh->sw->qids[qe->queue_id];
+		struct iq_ring *iq_ring = qid->iq[iq_num];
+
+		if (iq_ring_free_count(iq_ring) == 0)
+			break; /* move to next shard */
+
+		qid->iq_pkt_mask |= (1 << (iq_num));
+		iq_ring_enqueue(iq_ring, qe);
+		qid->iq_pkt_count[iq_num]++;
+		qid->stats.rx_pkts++;
+		pkts_iter++;
+
+		x->buf_start++;
+		x->buf_count--;
+	}
+
+	return pkts_iter;
+}
+
+static void
+sw_shard_schedule(struct sw_shard *sh)
+{
+	struct sw_evdev *sw = sh->sw;
+	struct sw_port *ports = sh->ports;
 	uint32_t in_pkts, out_pkts;
 	uint32_t out_pkts_total = 0, in_pkts_total = 0;
 	int32_t sched_quanta = sw->sched_quanta;
 	uint32_t i;
 
-	sw->sched_called++;
+	sh->sched_called++;
 	if (!sw->started)
 		return;
 
+	if (sw->cq_depth_adapt)
+		sw_cq_depth_adapt(sh);
+
 	do {
 		uint32_t in_pkts_this_iteration = 0;
 
@@ -560,22 +726,27 @@ sw_event_schedule(struct rte_eventdev *dev)
 		do {
 			in_pkts = 0;
 			for (i = 0; i < sw->port_count; i++)
-				if (sw->ports[i].is_directed)
-					in_pkts += sw_schedule_pull_port_dir(sw, i);
-				else if (sw->ports[i].num_ordered_qids > 0)
-					in_pkts += sw_schedule_pull_port_lb(sw, i);
+				if (ports[i].is_directed)
+					in_pkts += sw_schedule_pull_port_dir(sh, i);
+				else if (ports[i].num_ordered_qids > 0)
+					in_pkts += sw_schedule_pull_port_lb(sh, i);
 				else
-					in_pkts += sw_schedule_pull_port_no_reorder(sw, i);
+					in_pkts += sw_schedule_pull_port_no_reorder(sh, i);
+
+			/* Pull from the other shards */
+			for (i = 0; i < sw->nb_shards; i++)
+				if (i != sh->id)
+					in_pkts += sw_schedule_pull_xfer(sh, i);
 
 			/* QID scan for re-ordered */
-			in_pkts += sw_schedule_reorder(sw, 0,
+			in_pkts += sw_schedule_reorder(sh, 0,
 					sw->qid_count);
 			in_pkts_this_iteration += in_pkts;
 		} while (in_pkts > 4 &&
 				(int)in_pkts_this_iteration < sched_quanta);
 
 		out_pkts = 0;
-		out_pkts += sw_schedule_qid_to_cq(sw);
+		out_pkts += sw_schedule_qid_to_cq(sh);
 		out_pkts_total += out_pkts;
 		in_pkts_total += in_pkts_this_iteration;
 
@@ -587,17 +758,50 @@ sw_event_schedule(struct rte_eventdev *dev)
 	 * worker cores: aka, do the ring transfers batched.
 	 */
 	for (i = 0; i < sw->port_count; i++) {
-		struct rte_event_ring *worker = sw->ports[i].cq_worker_ring;
-		rte_event_ring_enqueue_burst(worker, sw->ports[i].cq_buf,
-				sw->ports[i].cq_buf_count,
-				&sw->cq_ring_space[i]);
-		sw->ports[i].cq_buf_count = 0;
+		struct rte_event_ring *worker = ports[i].cq_worker_ring;
+		rte_event_ring_enqueue_burst(worker, ports[i].cq_buf,
+				ports[i].cq_buf_count,
+				&sh->cq_ring_space[i]);
+		ports[i].cq_buf_count = 0;
+		ports[i].cq_used_last =
+			rte_event_ring_get_capacity(worker) -
+			sh->cq_ring_space[i];
+		sw_cq_space_clamp(sh, i);
 	}
 
-	sw->stats.tx_pkts += out_pkts_total;
-	sw->stats.rx_pkts += in_pkts_total;
+	sh->stats.tx_pkts += out_pkts_total;
+	sh->stats.rx_pkts += in_pkts_total;
+
+	sh->sched_no_iq_enqueues += (in_pkts_total == 0);
+	sh->sched_no_cq_enqueues += (out_pkts_total == 0);
+
+}
+
+void
+sw_event_schedule(struct rte_eventdev *dev)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	uint32_t shard;
+	uint32_t i;
 
-	sw->sched_no_iq_enqueues += (in_pkts_total == 0);
-	sw->sched_no_cq_enqueues += (out_pkts_total == 0);
+	if (sw->nb_shards == 1) {
+		sw_shard_schedule(&sw->shards[0]);
+		return;
+	}
+
+	/* The service is multi-thread safe with several shards: each lcore
+	 * running it starts from a different shard, and schedules the shards
+	 * not being scheduled by another lcore.
+	 */
+	shard = rte_lcore_id() % sw->nb_shards;
+	for (i = 0; i < sw->nb_shards; i++) {
+		struct sw_shard *sh = &sw->shards[shard];
 
+		if (rte_spinlock_trylock(&sh->lock)) {
+			sw_shard_schedule(sh);
+			rte_spinlock_unlock(&sh->lock);
+		}
+		if (++shard == sw->nb_shards)
+			shard = 0;
+	}
 }
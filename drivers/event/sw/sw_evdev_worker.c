@@ -38,8 +38,16 @@
 
 #define PORT_ENQUEUE_MAX_BURST_SIZE 64
 
+/* Shard which scheduled the oldest dequeued event not yet released */
+static __rte_always_inline uint8_t
+sw_release_shard(const struct sw_port *p)
+{
+	return p->deq_shard[p->last_dequeue_burst_sz -
+			p->outstanding_releases];
+}
+
 static inline void
-sw_event_release(struct sw_port *p, uint8_t index)
+sw_event_release(struct sw_port *p, uint8_t index, const int sharded)
 {
 	/*
 	 * Drops the next outstanding event in our history. Used on dequeue
@@ -52,7 +60,9 @@ sw_event_release(struct sw_port *p, uint8_t index)
 	ev.op = sw_qe_flag_map[RTE_EVENT_OP_RELEASE];
 
 	uint16_t free_count;
-	rte_event_ring_enqueue_burst(p->rx_worker_ring, &ev, 1, &free_count);
+	rte_event_ring_enqueue_burst(sharded ?
+			p->rx_shard_ring[sw_release_shard(p)] :
+			p->rx_worker_ring, &ev, 1, &free_count);
 
 	/* each release returns one credit */
 	p->outstanding_releases--;
@@ -77,11 +87,38 @@ enqueue_burst_with_ops(struct rte_event_ring *r, const struct rte_event *events,
 	return rte_event_ring_enqueue_burst(r, tmp_evs, n, NULL);
 }
 
-uint16_t
-sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
+/*
+ * Enqueue the runs of consecutive events going to the same shard, stopping
+ * at the first shard ring which is full.
+ */
+static inline unsigned int
+enqueue_burst_sharded(struct sw_port *p, const struct rte_event *events,
+		unsigned int n, uint8_t *ops, const uint8_t *shards)
+{
+	unsigned int enq = 0;
+
+	while (enq < n) {
+		unsigned int run = 1;
+		unsigned int ret;
+
+		while (enq + run < n && shards[enq + run] == shards[enq])
+			run++;
+		ret = enqueue_burst_with_ops(p->rx_shard_ring[shards[enq]],
+				&events[enq], run, &ops[enq]);
+		enq += ret;
+		if (ret != run)
+			break;
+	}
+	return enq;
+}
+
+static __rte_always_inline uint16_t
+__sw_event_enqueue_burst(void *port, const struct rte_event ev[],
+		uint16_t num, const int sharded)
 {
 	int32_t i;
 	uint8_t new_ops[PORT_ENQUEUE_MAX_BURST_SIZE];
+	uint8_t shards[PORT_ENQUEUE_MAX_BURST_SIZE];
 	struct sw_port *p = port;
 	struct sw_evdev *sw = (void *)p->sw;
 	uint32_t sw_inflights = rte_atomic32_read(&sw->inflights);
@@ -123,6 +160,20 @@ sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
 		new_ops[i] = sw_qe_flag_map[op];
 		new_ops[i] &= ~(invalid_qid << QE_FLAG_VALID_SHIFT);
 
+		/* Route releases and forwards to the shard holding the history
+		 * of the event they complete, and new events to the shard of
+		 * their QID.
+		 */
+		if (sharded) {
+			if ((new_ops[i] & QE_FLAG_COMPLETE) && outstanding &&
+					!p->is_directed)
+				shards[i] = sw_release_shard(p);
+			else if (invalid_qid)
+				shards[i] = 0;
+			else
+				shards[i] = sw->qids[ev[i].queue_id].shard;
+		}
+
 		/* FWD and RELEASE packets will both resolve to taken (assuming
 		 * correct usage of the API), providing very high correct
 		 * prediction rate.
@@ -141,7 +192,9 @@ sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
 	p->inflight_credits -= forwards * p->is_directed;
 
 	/* returns number of events actually enqueued */
-	uint32_t enq = enqueue_burst_with_ops(p->rx_worker_ring, ev, i,
+	uint32_t enq = sharded ?
+			enqueue_burst_sharded(p, ev, i, new_ops, shards) :
+			enqueue_burst_with_ops(p->rx_worker_ring, ev, i,
 					     new_ops);
 	if (p->outstanding_releases == 0 && p->last_dequeue_burst_sz != 0) {
 		uint64_t burst_ticks = rte_get_timer_cycles() -
@@ -155,6 +208,12 @@ sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
 	return enq;
 }
 
+uint16_t
+sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
+{
+	return __sw_event_enqueue_burst(port, ev, num, 0);
+}
+
 uint16_t
 sw_event_enqueue(void *port, const struct rte_event *ev)
 {
@@ -162,10 +221,51 @@ sw_event_enqueue(void *port, const struct rte_event *ev)
 }
 
 uint16_t
-sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
-		uint64_t wait)
+sw_event_enqueue_burst_sharded(void *port, const struct rte_event ev[],
+		uint16_t num)
+{
+	return __sw_event_enqueue_burst(port, ev, num, 1);
+}
+
+uint16_t
+sw_event_enqueue_sharded(void *port, const struct rte_event *ev)
+{
+	return sw_event_enqueue_burst_sharded(port, ev, 1);
+}
+
+/*
+ * Dequeue from the CQ of each shard in turn, starting from a different
+ * shard on each call, and record the shard of each event for its release.
+ */
+static inline uint16_t
+dequeue_burst_sharded(struct sw_port *p, struct rte_event *ev, uint16_t num)
+{
+	const uint8_t nb_shards = p->sw->nb_shards;
+	uint8_t shard = p->deq_shard_next;
+	uint16_t ndeq = 0;
+	uint8_t i;
+
+	num = RTE_MIN(num, RTE_DIM(p->deq_shard));
+	for (i = 0; i < nb_shards && ndeq < num; i++) {
+		uint16_t n = rte_event_ring_dequeue_burst(
+				p->cq_shard_ring[shard], &ev[ndeq],
+				num - ndeq, NULL);
+
+		memset(&p->deq_shard[ndeq], shard, n);
+		ndeq += n;
+		if (++shard == nb_shards)
+			shard = 0;
+	}
+	if (++p->deq_shard_next == nb_shards)
+		p->deq_shard_next = 0;
+
+	return ndeq;
+}
+
+static __rte_always_inline uint16_t
+__sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
+		const int sharded)
 {
-	RTE_SET_USED(wait);
 	struct sw_port *p = (void *)port;
 	struct sw_evdev *sw = (void *)p->sw;
 	struct rte_event_ring *ring = p->cq_worker_ring;
@@ -176,11 +276,12 @@ sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
 		uint16_t out_rels = p->outstanding_releases;
 		uint16_t i;
 		for (i = 0; i < out_rels; i++)
-			sw_event_release(p, i);
+			sw_event_release(p, i, sharded);
 	}
 
 	/* returns number of events actually dequeued */
-	uint16_t ndeq = rte_event_ring_dequeue_burst(ring, ev, num, NULL);
+	uint16_t ndeq = sharded ? dequeue_burst_sharded(p, ev, num) :
+			rte_event_ring_dequeue_burst(ring, ev, num, NULL);
 	if (unlikely(ndeq == 0)) {
 		p->outstanding_releases = 0;
 		p->zero_polls++;
@@ -205,8 +306,30 @@ sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
 	return ndeq;
 }
 
+uint16_t
+sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
+		uint64_t wait)
+{
+	RTE_SET_USED(wait);
+	return __sw_event_dequeue_burst(port, ev, num, 0);
+}
+
 uint16_t
 sw_event_dequeue(void *port, struct rte_event *ev, uint64_t wait)
 {
 	return sw_event_dequeue_burst(port, ev, 1, wait);
 }
+
+uint16_t
+sw_event_dequeue_burst_sharded(void *port, struct rte_event *ev, uint16_t num,
+		uint64_t wait)
+{
+	RTE_SET_USED(wait);
+	return __sw_event_dequeue_burst(port, ev, num, 1);
+}
+
+uint16_t
+sw_event_dequeue_sharded(void *port, struct rte_event *ev, uint64_t wait)
+{
+	return sw_event_dequeue_burst_sharded(port, ev, 1, wait);
+}
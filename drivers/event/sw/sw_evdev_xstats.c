@@ -52,6 +52,9 @@ enum xstats_type {
 	tx_free,
 	pkt_cycles,
 	poll_return, /* for zero-count and used also for port bucket loop */
+	migrated,
+	cq_depth,
+	deq_rate,
 	/* qid_specific */
 	iq_size,
 	iq_used,
@@ -75,17 +78,47 @@ struct sw_xstats_entry {
 	uint64_t reset_value; /* an offset to be taken away to emulate resets */
 };
 
+static uint64_t
+get_dev_shard_stat(const struct sw_shard *sh, enum xstats_type type)
+{
+	switch (type) {
+	case rx: return sh->stats.rx_pkts;
+	case tx: return sh->stats.tx_pkts;
+	case dropped: return sh->stats.rx_dropped;
+	case calls: return sh->sched_called;
+	case no_iq_enq: return sh->sched_no_iq_enqueues;
+	case no_cq_enq: return sh->sched_no_cq_enqueues;
+	default: return -1;
+	}
+}
+
 static uint64_t
 get_dev_stat(const struct sw_evdev *sw, uint16_t obj_idx __rte_unused,
 		enum xstats_type type, int extra_arg __rte_unused)
+{
+	uint64_t val = 0;
+	unsigned int i;
+
+	for (i = 0; i < sw->nb_shards; i++)
+		val += get_dev_shard_stat(&sw->shards[i], type);
+	return val;
+}
+
+/* port stats kept by the scheduler, per shard */
+static uint64_t
+get_port_shard_stat(const struct sw_port *p, enum xstats_type type)
 {
 	switch (type) {
-	case rx: return sw->stats.rx_pkts;
-	case tx: return sw->stats.tx_pkts;
-	case dropped: return sw->stats.rx_dropped;
-	case calls: return sw->sched_called;
-	case no_iq_enq: return sw->sched_no_iq_enqueues;
-	case no_cq_enq: return sw->sched_no_cq_enqueues;
+	case rx: return p->stats.rx_pkts;
+	case tx: return p->stats.tx_pkts;
+	case inflight: return p->inflights;
+	case rx_used: return rte_event_ring_count(p->rx_worker_ring);
+	case rx_free: return rte_event_ring_free_count(p->rx_worker_ring);
+	case tx_used: return rte_event_ring_count(p->cq_worker_ring);
+	case tx_free: return rte_event_ring_free_count(p->cq_worker_ring);
+	case migrated: return p->flows_migrated;
+	case cq_depth: return p->cq_depth;
+	case deq_rate: return p->cq_drain_rate;
 	default: return -1;
 	}
 }
@@ -95,21 +128,20 @@ get_port_stat(const struct sw_evdev *sw, uint16_t obj_idx,
 		enum xstats_type type, int extra_arg __rte_unused)
 {
 	const struct sw_port *p = &sw->ports[obj_idx];
+	uint64_t val = 0;
+	unsigned int i;
 
 	switch (type) {
-	case rx: return p->stats.rx_pkts;
-	case tx: return p->stats.tx_pkts;
 	case dropped: return p->stats.rx_dropped;
-	case inflight: return p->inflights;
 	case pkt_cycles: return p->avg_pkt_ticks;
 	case calls: return p->total_polls;
 	case credits: return p->inflight_credits;
 	case poll_return: return p->zero_polls;
-	case rx_used: return rte_event_ring_count(p->rx_worker_ring);
-	case rx_free: return rte_event_ring_free_count(p->rx_worker_ring);
-	case tx_used: return rte_event_ring_count(p->cq_worker_ring);
-	case tx_free: return rte_event_ring_free_count(p->cq_worker_ring);
-	default: return -1;
+	default:
+		for (i = 0; i < sw->nb_shards; i++)
+			val += get_port_shard_stat(
+					&sw->shards[i].ports[obj_idx], type);
+		return val;
 	}
 }
 
@@ -139,7 +171,7 @@ get_qid_stat(const struct sw_evdev *sw, uint16_t obj_idx,
 		do {
 			uint64_t infl = 0;
 			unsigned int i;
-			for (i = 0; i < RTE_DIM(qid->fids); i++)
+			for (i = 0; i < qid->fid_mask + 1; i++)
 				infl += qid->fids[i].pcount;
 			return infl;
 		} while (0);
@@ -174,7 +206,7 @@ get_qid_port_stat(const struct sw_evdev *sw, uint16_t obj_idx,
 		do {
 			uint64_t pin = 0;
 			unsigned int i;
-			for (i = 0; i < RTE_DIM(qid->fids); i++)
+			for (i = 0; i < qid->fid_mask + 1; i++)
 				if (qid->fids[i].cq == port)
 					pin++;
 			return pin;
@@ -218,16 +250,19 @@ sw_xstats_init(struct sw_evdev *sw)
 			"rx_ring_used", "rx_ring_free",
 			"cq_ring_used", "cq_ring_free",
 			"dequeue_calls", "dequeues_returning_0",
+			"flows_migrated", "cq_depth", "dequeue_rate",
 	};
 	static const enum xstats_type port_types[] = { rx, tx, dropped,
 			inflight, pkt_cycles, credits,
 			rx_used, rx_free, tx_used, tx_free,
 			calls, poll_return,
+			migrated, cq_depth, deq_rate,
 	};
 	static const uint8_t port_reset_allowed[] = {1, 1, 1,
 			0, 1, 0,
 			0, 0, 0, 0,
 			1, 1,
+			1, 0, 0,
 	};
 
 	static const char * const port_bucket_stats[] = {
@@ -36,12 +36,14 @@
 
 #include <rte_eal.h>
 #include <rte_common.h>
+#include <rte_cycles.h>
 #include <rte_errno.h>
 #include <rte_ethdev.h>
 #include <rte_lcore.h>
 #include <rte_malloc.h>
 #include <rte_mbuf.h>
 #include <rte_mempool.h>
+#include <rte_pause.h>
 #include <rte_ring.h>
 #include <rte_reorder.h>
 
@@ -50,6 +52,7 @@
 
 #define MAX_PKTS_BURST 32
 #define REORDER_BUFFER_SIZE 8192
+#define REORDER_MP_TIMEOUT_US 100
 #define MBUF_PER_POOL 65535
 #define MBUF_POOL_CACHE_SIZE 250
 
@@ -60,6 +63,7 @@
 
 unsigned int portmask;
 unsigned int disable_reorder;
+unsigned int mp_reorder;
 volatile uint8_t quit_signal;
 
 static struct rte_mempool *mbuf_pool;
@@ -69,6 +73,7 @@ static struct rte_eth_conf port_conf_default;
 struct worker_thread_args {
 	struct rte_ring *ring_in;
 	struct rte_ring *ring_out;
+	struct rte_reorder_mp_buffer *buffer;
 };
 
 struct send_thread_args {
@@ -149,8 +154,12 @@ pktmbuf_free_bulk(struct rte_mbuf *mbuf_table[], unsigned n)
 static void
 print_usage(const char *prgname)
 {
-	printf("%s [EAL options] -- -p PORTMASK\n"
-			"  -p PORTMASK: hexadecimal bitmask of ports to configure\n",
+	printf("%s [EAL options] -- -p PORTMASK [--disable-reorder | "
+			"--mp-reorder]\n"
+			"  -p PORTMASK: hexadecimal bitmask of ports to configure\n"
+			"  --disable-reorder: transmit packets without reordering\n"
+			"  --mp-reorder: workers insert packets directly in a "
+			"multi-producer reorder buffer\n",
 			prgname);
 }
 
@@ -181,6 +190,7 @@ parse_args(int argc, char **argv)
 	char *prgname = argv[0];
 	static struct option lgopts[] = {
 		{"disable-reorder", 0, 0, 0},
+		{"mp-reorder", 0, 0, 0},
 		{NULL, 0, 0, 0}
 	};
 
@@ -204,13 +214,17 @@ parse_args(int argc, char **argv)
 				printf("reorder disabled\n");
 				disable_reorder = 1;
 			}
+			if (!strcmp(lgopts[option_index].name, "mp-reorder")) {
+				printf("multi-producer reorder enabled\n");
+				mp_reorder = 1;
+			}
 			break;
 		default:
 			print_usage(prgname);
 			return -1;
 		}
 	}
-	if (optind <= 1) {
+	if (optind <= 1 || (disable_reorder && mp_reorder)) {
 		print_usage(prgname);
 		return -1;
 	}
@@ -442,10 +456,38 @@ rx_thread(struct rte_ring *ring_out)
 	return 0;
 }
 
+/**
+ * Inserts the processed mbufs in the multi-producer reorder buffer, waiting
+ * for the send thread to make room for early ones.
+ */
+static void
+worker_reorder_mp(struct rte_reorder_mp_buffer *buffer,
+		struct rte_mbuf **mbufs, uint16_t nb_mbufs)
+{
+	uint16_t i, nb_failed = 0;
+	int ret;
+
+	for (i = 0; i < nb_mbufs; i++) {
+		while ((ret = rte_reorder_mp_insert(buffer, mbufs[i])) != 0 &&
+				rte_errno == ENOSPC && !quit_signal)
+			rte_pause();
+		if (unlikely(ret != 0)) {
+			/* Late pkts were skipped already, drop them */
+			rte_pktmbuf_free(mbufs[i]);
+			nb_failed++;
+		}
+	}
+
+	__sync_fetch_and_add(&app_stats.wkr.enqueue_pkts, nb_mbufs - nb_failed);
+	if (unlikely(nb_failed != 0))
+		__sync_fetch_and_add(&app_stats.wkr.enqueue_failed_pkts,
+				nb_failed);
+}
+
 /**
  * This thread takes bursts of packets from the rx_to_workers ring and
  * Changes the input port value to output port value. And feds it to
- * workers_to_tx
+ * workers_to_tx, or to the multi-producer reorder buffer.
  */
 static int
 worker_thread(void *args_ptr)
@@ -479,6 +521,12 @@ worker_thread(void *args_ptr)
 		for (i = 0; i < burst_size;)
 			burst_buffer[i++]->port ^= xor_val;
 
+		if (args->buffer != NULL) {
+			worker_reorder_mp(args->buffer, burst_buffer,
+					burst_size);
+			continue;
+		}
+
 		/* enqueue the modified mbufs to workers_to_tx ring */
 		ret = rte_ring_enqueue_burst(ring_out, (void *)burst_buffer,
 				burst_size, NULL);
@@ -580,6 +628,53 @@ send_thread(struct send_thread_args *args)
 	return 0;
 }
 
+/**
+ * Drain the mbufs inserted in order by the workers in the multi-producer
+ * reorder buffer, and transmit them.
+ */
+static int
+send_thread_mp(struct rte_reorder_mp_buffer *buffer)
+{
+	unsigned int i, dret;
+	uint8_t outp;
+	unsigned sent;
+	struct rte_mbuf *rombufs[MAX_PKTS_BURST];
+	struct rte_eth_dev_tx_buffer *outbuf;
+	static struct rte_eth_dev_tx_buffer *tx_buffer[RTE_MAX_ETHPORTS];
+
+	RTE_LOG(INFO, REORDERAPP, "%s() started on lcore %u\n", __func__,
+							rte_lcore_id());
+
+	configure_tx_buffers(tx_buffer);
+
+	while (!quit_signal) {
+
+		dret = rte_reorder_mp_drain(buffer, rombufs, MAX_PKTS_BURST);
+		if (unlikely(dret == 0))
+			continue;
+
+		app_stats.tx.dequeue_pkts += dret;
+
+		for (i = 0; i < dret; i++) {
+			outp = rombufs[i]->port;
+			/* skip ports that are not enabled */
+			if ((portmask & (1 << outp)) == 0) {
+				rte_pktmbuf_free(rombufs[i]);
+				continue;
+			}
+
+			outbuf = tx_buffer[outp];
+			sent = rte_eth_tx_buffer(outp, 0, outbuf, rombufs[i]);
+			if (sent)
+				app_stats.tx.ro_tx_pkts += sent;
+		}
+	}
+
+	free_tx_buffers(tx_buffer);
+
+	return 0;
+}
+
 /**
  * Dequeue mbufs from the workers_to_tx ring and transmit them
  */
@@ -635,7 +730,7 @@ main(int argc, char **argv)
 	unsigned int lcore_id, last_lcore_id, master_lcore_id;
 	uint16_t port_id;
 	uint16_t nb_ports_available;
-	struct worker_thread_args worker_args = {NULL, NULL};
+	struct worker_thread_args worker_args = {NULL, NULL, NULL};
 	struct send_thread_args send_args = {NULL, NULL};
 	struct rte_ring *rx_to_workers;
 	struct rte_ring *workers_to_tx;
@@ -711,7 +806,14 @@ main(int argc, char **argv)
 	if (workers_to_tx == NULL)
 		rte_exit(EXIT_FAILURE, "%s\n", rte_strerror(rte_errno));
 
-	if (!disable_reorder) {
+	if (mp_reorder) {
+		worker_args.buffer = rte_reorder_mp_create("PKT_RO_MP",
+				rte_socket_id(), REORDER_BUFFER_SIZE,
+				rte_get_timer_hz() * REORDER_MP_TIMEOUT_US /
+				1000000);
+		if (worker_args.buffer == NULL)
+			rte_exit(EXIT_FAILURE, "%s\n", rte_strerror(rte_errno));
+	} else if (!disable_reorder) {
 		send_args.buffer = rte_reorder_create("PKT_RO", rte_socket_id(),
 				REORDER_BUFFER_SIZE);
 		if (send_args.buffer == NULL)
@@ -730,7 +832,11 @@ main(int argc, char **argv)
 			rte_eal_remote_launch(worker_thread, (void *)&worker_args,
 					lcore_id);
 
-	if (disable_reorder) {
+	if (mp_reorder) {
+		/* Start send_thread_mp() on the last slave core */
+		rte_eal_remote_launch((lcore_function_t *)send_thread_mp,
+				worker_args.buffer, last_lcore_id);
+	} else if (disable_reorder) {
 		/* Start tx_thread() on the last slave core */
 		rte_eal_remote_launch((lcore_function_t *)tx_thread, workers_to_tx,
 				last_lcore_id);
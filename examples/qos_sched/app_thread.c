@@ -81,8 +81,10 @@ get_pkt_sched(struct rte_mbuf *m, uint32_t *subport, uint32_t *pipe,
 void
 app_rx_thread(struct thread_conf **confs)
 {
-	uint32_t i, nb_rx;
+	uint32_t i, w, nb_rx;
 	struct rte_mbuf *rx_mbufs[burst_conf.rx_burst] __rte_cache_aligned;
+	struct rte_mbuf *wt_mbufs[APP_MAX_WORKERS][burst_conf.rx_burst];
+	uint32_t nb_wt[APP_MAX_WORKERS];
 	struct thread_conf *conf;
 	int conf_idx = 0;
 
@@ -99,19 +101,48 @@ app_rx_thread(struct thread_conf **confs)
 		if (likely(nb_rx != 0)) {
 			APP_STATS_ADD(conf->stat.nb_rx, nb_rx);
 
-			for(i = 0; i < nb_rx; i++) {
-				get_pkt_sched(rx_mbufs[i],
-						&subport, &pipe, &traffic_class, &queue, &color);
-				rte_sched_port_pkt_write(rx_mbufs[i], subport, pipe,
-						traffic_class, queue, (enum rte_meter_color) color);
-			}
+			if (likely(conf->n_workers == 1)) {
+				for(i = 0; i < nb_rx; i++) {
+					get_pkt_sched(rx_mbufs[i],
+							&subport, &pipe, &traffic_class, &queue, &color);
+					rte_sched_port_pkt_write(rx_mbufs[i], subport, pipe,
+							traffic_class, queue, (enum rte_meter_color) color);
+				}
+
+				if (unlikely(rte_ring_sp_enqueue_bulk(conf->rx_ring,
+						(void **)rx_mbufs, nb_rx, NULL) == 0)) {
+					for(i = 0; i < nb_rx; i++) {
+						rte_pktmbuf_free(rx_mbufs[i]);
+
+						APP_STATS_ADD(conf->stat.nb_drop, 1);
+					}
+				}
+			} else {
+				/* dispatch each packet to the worker owning its subport */
+				memset(nb_wt, 0, sizeof(nb_wt));
 
-			if (unlikely(rte_ring_sp_enqueue_bulk(conf->rx_ring,
-					(void **)rx_mbufs, nb_rx, NULL) == 0)) {
 				for(i = 0; i < nb_rx; i++) {
-					rte_pktmbuf_free(rx_mbufs[i]);
+					get_pkt_sched(rx_mbufs[i],
+							&subport, &pipe, &traffic_class, &queue, &color);
+					w = subport / conf->n_subports_per_worker;
+					subport = subport % conf->n_subports_per_worker;
+					rte_sched_port_pkt_write(rx_mbufs[i], subport, pipe,
+							traffic_class, queue, (enum rte_meter_color) color);
+					wt_mbufs[w][nb_wt[w]++] = rx_mbufs[i];
+				}
+
+				for (w = 0; w < conf->n_workers; w++) {
+					if (nb_wt[w] == 0)
+						continue;
+
+					if (unlikely(rte_ring_sp_enqueue_bulk(conf->rx_rings[w],
+							(void **)wt_mbufs[w], nb_wt[w], NULL) == 0)) {
+						for(i = 0; i < nb_wt[w]; i++) {
+							rte_pktmbuf_free(wt_mbufs[w][i]);
 
-					APP_STATS_ADD(conf->stat.nb_drop, 1);
+							APP_STATS_ADD(conf->stat.nb_drop, 1);
+						}
+					}
 				}
 			}
 		}
@@ -230,7 +261,7 @@ app_worker_thread(struct thread_conf **confs)
 		nb_pkt = rte_sched_port_dequeue(conf->sched_port, mbufs,
 					burst_conf.qos_dequeue);
 		if (likely(nb_pkt > 0))
-			while (rte_ring_sp_enqueue_bulk(conf->tx_ring,
+			while (rte_ring_enqueue_bulk(conf->tx_ring,
 					(void **)mbufs, nb_pkt, NULL) == 0)
 				; /* empty body */
 
@@ -66,6 +66,8 @@ static const char usage[] =
 	"Application mandatory parameters:                                              \n"
 	"    --pfc \"RX PORT, TX PORT, RX LCORE, WT LCORE\" : Packet flow configuration \n"
 	"           multiple pfc can be configured in command line                      \n"
+	"    --wts \"LCORE, ...\" : Additional WT lcores for the preceding pfc, each    \n"
+	"           one scheduling its own share of the subports (requires TX LCORE)    \n"
 	"                                                                               \n"
 	"Application optional parameters:                                               \n"
         "    --i     : run in interactive mode (default value is %u)                    \n"
@@ -255,13 +257,14 @@ app_parse_flow_conf(const char *conf_str)
 	pconf->rx_port = vals[0];
 	pconf->tx_port = vals[1];
 	pconf->rx_core = (uint8_t)vals[2];
-	pconf->wt_core = (uint8_t)vals[3];
+	pconf->wt_core[0] = (uint8_t)vals[3];
+	pconf->n_workers = 1;
 	if (ret == 5)
 		pconf->tx_core = (uint8_t)vals[4];
 	else
-		pconf->tx_core = pconf->wt_core;
+		pconf->tx_core = pconf->wt_core[0];
 
-	if (pconf->rx_core == pconf->wt_core) {
+	if (pconf->rx_core == pconf->wt_core[0]) {
 		RTE_LOG(ERR, APP, "pfc %u: rx thread and worker thread cannot share same core\n", nb_pfc);
 		return -1;
 	}
@@ -298,7 +301,7 @@ app_parse_flow_conf(const char *conf_str)
 	mask = 1lu << pconf->rx_core;
 	app_used_core_mask |= mask;
 
-	mask = 1lu << pconf->wt_core;
+	mask = 1lu << pconf->wt_core[0];
 	app_used_core_mask |= mask;
 
 	mask = 1lu << pconf->tx_core;
@@ -309,6 +312,60 @@ app_parse_flow_conf(const char *conf_str)
 	return 0;
 }
 
+static int
+app_parse_worker_conf(const char *conf_str)
+{
+	int ret, i;
+	uint32_t vals[APP_MAX_WORKERS - 1];
+	struct flow_conf *pconf;
+	uint64_t mask;
+
+	if (nb_pfc == 0) {
+		RTE_LOG(ERR, APP, "wts must follow a pfc\n");
+		return -1;
+	}
+
+	pconf = &qos_conf[nb_pfc - 1];
+	if (pconf->n_workers != 1) {
+		RTE_LOG(ERR, APP, "pfc %u: wts is configured already\n", nb_pfc - 1);
+		return -1;
+	}
+	if (pconf->tx_core == pconf->wt_core[0]) {
+		RTE_LOG(ERR, APP, "pfc %u: multiple worker threads require a "
+				"separate tx thread\n", nb_pfc - 1);
+		return -1;
+	}
+
+	ret = app_parse_opt_vals(conf_str, ',', APP_MAX_WORKERS - 1, vals);
+	if (ret <= 0)
+		return -1;
+
+	for (i = 0; i < ret; i++) {
+		uint32_t core = (uint8_t)vals[i];
+		uint32_t w;
+
+		if ((core == pconf->rx_core) || (core == pconf->tx_core)) {
+			RTE_LOG(ERR, APP, "pfc %u: worker core %u is used already\n",
+					nb_pfc - 1, core);
+			return -1;
+		}
+		for (w = 0; w < pconf->n_workers; w++) {
+			if (core == pconf->wt_core[w]) {
+				RTE_LOG(ERR, APP, "pfc %u: worker core %u is used already\n",
+						nb_pfc - 1, core);
+				return -1;
+			}
+		}
+
+		mask = 1lu << core;
+		app_used_core_mask |= mask;
+
+		pconf->wt_core[pconf->n_workers++] = core;
+	}
+
+	return 0;
+}
+
 static int
 app_parse_burst_conf(const char *conf_str)
 {
@@ -342,6 +399,7 @@ app_parse_args(int argc, char **argv)
 
 	static struct option lgopts[] = {
 		{ "pfc", 1, 0, 0 },
+		{ "wts", 1, 0, 0 },
 		{ "mst", 1, 0, 0 },
 		{ "rsz", 1, 0, 0 },
 		{ "bsz", 1, 0, 0 },
@@ -382,6 +440,14 @@ app_parse_args(int argc, char **argv)
 					}
 					break;
 				}
+				if (str_is(optname, "wts")) {
+					ret = app_parse_worker_conf(optarg);
+					if (ret) {
+						RTE_LOG(ERR, APP, "Invalid worker configuration %s\n", optarg);
+						return -1;
+					}
+					break;
+				}
 				if (str_is(optname, "mst")) {
 					app_master_core = (uint32_t)atoi(optarg);
 					break;
@@ -470,16 +536,20 @@ app_parse_args(int argc, char **argv)
 					qos_conf[i].rx_core);
 			return -1;
 		}
-		if (qos_conf[i].wt_core >= nb_lcores) {
-			RTE_LOG(ERR, APP, "pfc %u: invalid WT lcore index %u\n", i + 1,
-					qos_conf[i].wt_core);
-			return -1;
-		}
 		uint32_t rx_sock = rte_lcore_to_socket_id(qos_conf[i].rx_core);
-		uint32_t wt_sock = rte_lcore_to_socket_id(qos_conf[i].wt_core);
-		if (rx_sock != wt_sock) {
-			RTE_LOG(ERR, APP, "pfc %u: RX and WT must be on the same socket\n", i + 1);
-			return -1;
+		uint32_t w;
+
+		for (w = 0; w < qos_conf[i].n_workers; w++) {
+			if (qos_conf[i].wt_core[w] >= nb_lcores) {
+				RTE_LOG(ERR, APP, "pfc %u: invalid WT lcore index %u\n", i + 1,
+						qos_conf[i].wt_core[w]);
+				return -1;
+			}
+			uint32_t wt_sock = rte_lcore_to_socket_id(qos_conf[i].wt_core[w]);
+			if (rx_sock != wt_sock) {
+				RTE_LOG(ERR, APP, "pfc %u: RX and WT must be on the same socket\n", i + 1);
+				return -1;
+			}
 		}
 		app_numa_mask |= 1 << rte_lcore_to_socket_id(qos_conf[i].rx_core);
 	}
@@ -254,42 +254,61 @@ struct rte_sched_port_params port_params = {
 #endif /* RTE_SCHED_RED */
 };
 
+/*
+ * When the output port is split across several workers, each worker gets a
+ * port scheduler instance running at the full port rate and handling
+ * n_subports_per_port / n_workers of the port subports, starting at subport
+ * worker * n_subports_per_port / n_workers.
+ */
 static struct rte_sched_port *
-app_init_sched_port(uint32_t portid, uint32_t socketid)
+app_init_sched_port(uint32_t portid, uint32_t socketid, uint32_t worker,
+	uint32_t n_workers)
 {
-	static char port_name[32]; /* static as referenced from global port_params*/
+	static char port_name[APP_MAX_WORKERS][32]; /* static as referenced from port params*/
+	struct rte_sched_port_params params;
 	struct rte_eth_link link;
 	struct rte_sched_port *port = NULL;
-	uint32_t pipe, subport;
+	uint32_t pipe, subport, subport_base;
 	int err;
 
 	rte_eth_link_get(portid, &link);
 
 	port_params.socket = socketid;
 	port_params.rate = (uint64_t) link.link_speed * 1000 * 1000 / 8;
-	snprintf(port_name, sizeof(port_name), "port_%d", portid);
-	port_params.name = port_name;
-
-	port = rte_sched_port_config(&port_params);
+	if (n_workers == 1)
+		snprintf(port_name[worker], sizeof(port_name[worker]), "port_%d",
+			portid);
+	else
+		snprintf(port_name[worker], sizeof(port_name[worker]), "port_%d_%u",
+			portid, worker);
+	port_params.name = port_name[worker];
+
+	params = port_params;
+	params.n_subports_per_port = port_params.n_subports_per_port / n_workers;
+	subport_base = worker * params.n_subports_per_port;
+
+	port = rte_sched_port_config(&params);
 	if (port == NULL){
 		rte_exit(EXIT_FAILURE, "Unable to config sched port\n");
 	}
 
-	for (subport = 0; subport < port_params.n_subports_per_port; subport ++) {
-		err = rte_sched_subport_config(port, subport, &subport_params[subport]);
+	for (subport = 0; subport < params.n_subports_per_port; subport ++) {
+		uint32_t s = subport_base + subport;
+
+		err = rte_sched_subport_config(port, subport, &subport_params[s]);
 		if (err) {
 			rte_exit(EXIT_FAILURE, "Unable to config sched subport %u, err=%d\n",
-					subport, err);
+					s, err);
 		}
 
 		for (pipe = 0; pipe < port_params.n_pipes_per_subport; pipe ++) {
-			if (app_pipe_to_profile[subport][pipe] != -1) {
+			if (app_pipe_to_profile[s][pipe] != -1) {
 				err = rte_sched_pipe_config(port, subport, pipe,
-						app_pipe_to_profile[subport][pipe]);
+						app_pipe_to_profile[s][pipe]);
 				if (err) {
 					rte_exit(EXIT_FAILURE, "Unable to config sched pipe %u "
 							"for profile %d, err=%d\n", pipe,
-							app_pipe_to_profile[subport][pipe], err);
+							app_pipe_to_profile[s][pipe], err);
 				}
 			}
 		}
@@ -298,6 +317,40 @@ app_init_sched_port(uint32_t portid, uint32_t socketid)
 	return port;
 }
 
+/*
+ * The workers of the same output port share its rate through a port group:
+ * each worker dequeue takes at most one dequeue burst worth of credits.
+ */
+static struct rte_sched_port_group *
+app_init_sched_group(struct flow_conf *flow, uint32_t socketid)
+{
+	static char group_name[MAX_DATA_STREAMS][32];
+	struct rte_sched_port_group_params params;
+	struct rte_sched_port_group *group;
+	uint32_t pfc = flow - qos_conf;
+	uint32_t w;
+
+	snprintf(group_name[pfc], sizeof(group_name[pfc]), "group_%u", pfc);
+
+	params.name = group_name[pfc];
+	params.socket = socketid;
+	params.rate = port_params.rate;
+	params.n_ports = flow->n_workers;
+	params.credits_per_dequeue = burst_conf.qos_dequeue * port_params.mtu;
+	params.credits_max = flow->n_workers * params.credits_per_dequeue;
+
+	group = rte_sched_port_group_create(&params);
+	if (group == NULL)
+		rte_exit(EXIT_FAILURE, "Unable to create sched port group\n");
+
+	for (w = 0; w < flow->n_workers; w++)
+		if (rte_sched_port_group_add(group, flow->sched_port[w]) != 0)
+			rte_exit(EXIT_FAILURE, "Unable to add worker %u to sched "
+					"port group\n", w);
+
+	return group;
+}
+
 static int
 app_load_cfg_profile(const char *profile)
 {
@@ -332,21 +385,37 @@ int app_init(void)
 	/* Initialize each active flow */
 	for(i = 0; i < nb_pfc; i++) {
 		uint32_t socket = rte_lcore_to_socket_id(qos_conf[i].rx_core);
+		uint32_t n_workers = qos_conf[i].n_workers;
 		struct rte_ring *ring;
+		uint32_t w;
+
+		if (port_params.n_subports_per_port % n_workers)
+			rte_exit(EXIT_FAILURE, "pfc %u: %u subports cannot be split "
+					"across %u workers\n", i,
+					port_params.n_subports_per_port, n_workers);
+
+		for (w = 0; w < n_workers; w++) {
+			if (w == 0)
+				snprintf(ring_name, MAX_NAME_LEN, "ring-%u-%u", i,
+						qos_conf[i].rx_core);
+			else
+				snprintf(ring_name, MAX_NAME_LEN, "ring-%u-%u-%u", i,
+						qos_conf[i].rx_core, w);
+			ring = rte_ring_lookup(ring_name);
+			if (ring == NULL)
+				qos_conf[i].rx_ring[w] = rte_ring_create(ring_name,
+					ring_conf.ring_size, socket,
+					RING_F_SP_ENQ | RING_F_SC_DEQ);
+			else
+				qos_conf[i].rx_ring[w] = ring;
+		}
 
-		snprintf(ring_name, MAX_NAME_LEN, "ring-%u-%u", i, qos_conf[i].rx_core);
-		ring = rte_ring_lookup(ring_name);
-		if (ring == NULL)
-			qos_conf[i].rx_ring = rte_ring_create(ring_name, ring_conf.ring_size,
-			 	socket, RING_F_SP_ENQ | RING_F_SC_DEQ);
-		else
-			qos_conf[i].rx_ring = ring;
-
+		/* all the workers write to the same tx ring */
 		snprintf(ring_name, MAX_NAME_LEN, "ring-%u-%u", i, qos_conf[i].tx_core);
 		ring = rte_ring_lookup(ring_name);
 		if (ring == NULL)
 			qos_conf[i].tx_ring = rte_ring_create(ring_name, ring_conf.ring_size,
-				socket, RING_F_SP_ENQ | RING_F_SC_DEQ);
+				socket, (n_workers == 1 ? RING_F_SP_ENQ : 0) | RING_F_SC_DEQ);
 		else
 			qos_conf[i].tx_ring = ring;
 
@@ -363,7 +432,13 @@ int app_init(void)
 		app_init_port(qos_conf[i].rx_port, qos_conf[i].mbuf_pool);
 		app_init_port(qos_conf[i].tx_port, qos_conf[i].mbuf_pool);
 
-		qos_conf[i].sched_port = app_init_sched_port(qos_conf[i].tx_port, socket);
+		for (w = 0; w < n_workers; w++)
+			qos_conf[i].sched_port[w] = app_init_sched_port(
+				qos_conf[i].tx_port, socket, w, n_workers);
+
+		if (n_workers > 1)
+			qos_conf[i].sched_group = app_init_sched_group(&qos_conf[i],
+				socket);
 	}
 
 	RTE_LOG(INFO, APP, "time stamp clock running at %" PRIu64 " Hz\n",
@@ -61,7 +61,7 @@ static int
 app_main_loop(__attribute__((unused))void *dummy)
 {
 	uint32_t lcore_id;
-	uint32_t i, mode;
+	uint32_t i, w, mode;
 	uint32_t rx_idx = 0;
 	uint32_t wt_idx = 0;
 	uint32_t tx_idx = 0;
@@ -82,8 +82,12 @@ app_main_loop(__attribute__((unused))void *dummy)
 
 		if (flow->rx_core == lcore_id) {
 			flow->rx_thread.rx_port = flow->rx_port;
-			flow->rx_thread.rx_ring =  flow->rx_ring;
+			flow->rx_thread.rx_ring =  flow->rx_ring[0];
 			flow->rx_thread.rx_queue = flow->rx_queue;
+			flow->rx_thread.rx_rings = flow->rx_ring;
+			flow->rx_thread.n_workers = flow->n_workers;
+			flow->rx_thread.n_subports_per_worker =
+				port_params.n_subports_per_port / flow->n_workers;
 
 			rx_confs[rx_idx++] = &flow->rx_thread;
 
@@ -98,13 +102,18 @@ app_main_loop(__attribute__((unused))void *dummy)
 
 			mode |= APP_TX_MODE;
 		}
-		if (flow->wt_core == lcore_id) {
-			flow->wt_thread.rx_ring =  flow->rx_ring;
-			flow->wt_thread.tx_ring =  flow->tx_ring;
-			flow->wt_thread.tx_port =  flow->tx_port;
-			flow->wt_thread.sched_port =  flow->sched_port;
+		for (w = 0; w < flow->n_workers; w++) {
+			struct thread_conf *wt_thread = &flow->wt_thread[w];
 
-			wt_confs[wt_idx++] = &flow->wt_thread;
+			if (flow->wt_core[w] != lcore_id)
+				continue;
+
+			wt_thread->rx_ring =  flow->rx_ring[w];
+			wt_thread->tx_ring =  flow->tx_ring;
+			wt_thread->tx_port =  flow->tx_port;
+			wt_thread->sched_port =  flow->sched_port[w];
+
+			wt_confs[wt_idx++] = wt_thread;
 
 			mode |= APP_WT_MODE;
 		}
@@ -200,6 +209,15 @@ app_stat(void)
 		memcpy(&tx_stats[i], &stats, sizeof(stats));
 
 #if APP_COLLECT_STAT
+		struct thread_stat wt_stat = {0, 0};
+		uint32_t w;
+
+		for (w = 0; w < flow->n_workers; w++) {
+			wt_stat.nb_rx += flow->wt_thread[w].stat.nb_rx;
+			wt_stat.nb_drop += flow->wt_thread[w].stat.nb_drop;
+			memset(&flow->wt_thread[w].stat, 0, sizeof(struct thread_stat));
+		}
+
 		printf("-------+------------+------------+\n");
 		printf("       |  received  |   dropped  |\n");
 		printf("-------+------------+------------+\n");
@@ -207,13 +225,12 @@ app_stat(void)
 			flow->rx_thread.stat.nb_rx,
 			flow->rx_thread.stat.nb_drop);
 		printf("QOS+TX | %10" PRIu64 " | %10" PRIu64 " |   pps: %"PRIu64 " \n",
-			flow->wt_thread.stat.nb_rx,
-			flow->wt_thread.stat.nb_drop,
-			flow->wt_thread.stat.nb_rx - flow->wt_thread.stat.nb_drop);
+			wt_stat.nb_rx,
+			wt_stat.nb_drop,
+			wt_stat.nb_rx - wt_stat.nb_drop);
 		printf("-------+------------+------------+\n");
 
 		memset(&flow->rx_thread.stat, 0, sizeof(struct thread_stat));
-		memset(&flow->wt_thread.stat, 0, sizeof(struct thread_stat));
 #endif
 	}
 }
@@ -77,6 +77,7 @@ extern "C" {
 #endif
 
 #define MAX_DATA_STREAMS (APP_MAX_LCORE/2)
+#define APP_MAX_WORKERS		8
 #define MAX_SCHED_SUBPORTS		8
 #define MAX_SCHED_PIPES		4096
 
@@ -114,6 +115,11 @@ struct thread_conf
 	struct rte_ring *tx_ring;
 	struct rte_sched_port *sched_port;
 
+	/* RX thread dispatching to several workers */
+	struct rte_ring **rx_rings;
+	uint32_t n_workers;
+	uint32_t n_subports_per_worker;
+
 #if APP_COLLECT_STAT
 	struct thread_stat stat;
 #endif
@@ -123,19 +129,21 @@ struct thread_conf
 struct flow_conf
 {
 	uint32_t rx_core;
-	uint32_t wt_core;
+	uint32_t wt_core[APP_MAX_WORKERS];
 	uint32_t tx_core;
+	uint32_t n_workers;
 	uint16_t rx_port;
 	uint16_t tx_port;
 	uint16_t rx_queue;
 	uint16_t tx_queue;
-	struct rte_ring *rx_ring;
+	struct rte_ring *rx_ring[APP_MAX_WORKERS];
 	struct rte_ring *tx_ring;
-	struct rte_sched_port *sched_port;
+	struct rte_sched_port *sched_port[APP_MAX_WORKERS];
+	struct rte_sched_port_group *sched_group;
 	struct rte_mempool *mbuf_pool;
 
 	struct thread_conf rx_thread;
-	struct thread_conf wt_thread;
+	struct thread_conf wt_thread[APP_MAX_WORKERS];
 	struct thread_conf tx_thread;
 };
 
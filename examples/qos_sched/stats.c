@@ -36,6 +36,18 @@
 
 #include "main.h"
 
+/* returns the worker scheduler of a subport and its index within it */
+static struct rte_sched_port *
+app_sched_port(struct flow_conf *flow, uint32_t *subport_id)
+{
+	uint32_t n_subports = port_params.n_subports_per_port / flow->n_workers;
+	struct rte_sched_port *port = flow->sched_port[*subport_id / n_subports];
+
+	*subport_id %= n_subports;
+
+	return port;
+}
+
 int
 qavg_q(uint16_t port_id, uint32_t subport_id, uint32_t pipe_id, uint8_t tc,
 		uint8_t q)
@@ -54,7 +66,7 @@ qavg_q(uint16_t port_id, uint32_t subport_id, uint32_t pipe_id, uint8_t tc,
                         || tc >= RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE || q >= RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS)
                 return -1;
 
-        port = qos_conf[i].sched_port;
+        port = app_sched_port(&qos_conf[i], &subport_id);
 
         queue_id = RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * (subport_id * port_params.n_pipes_per_subport + pipe_id);
         queue_id = queue_id + (tc * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS + q);
@@ -92,7 +104,7 @@ qavg_tcpipe(uint16_t port_id, uint32_t subport_id, uint32_t pipe_id,
                         || tc >= RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE)
                 return -1;
 
-        port = qos_conf[i].sched_port;
+        port = app_sched_port(&qos_conf[i], &subport_id);
 
         queue_id = RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * (subport_id * port_params.n_pipes_per_subport + pipe_id);
 
@@ -131,7 +143,7 @@ qavg_pipe(uint16_t port_id, uint32_t subport_id, uint32_t pipe_id)
         if (i == nb_pfc || subport_id >= port_params.n_subports_per_port || pipe_id >= port_params.n_pipes_per_subport)
                 return -1;
 
-        port = qos_conf[i].sched_port;
+        port = app_sched_port(&qos_conf[i], &subport_id);
 
         queue_id = RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * (subport_id * port_params.n_pipes_per_subport + pipe_id);
 
@@ -170,7 +182,7 @@ qavg_tcsubport(uint16_t port_id, uint32_t subport_id, uint8_t tc)
         if (i == nb_pfc || subport_id >= port_params.n_subports_per_port || tc >= RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE)
                 return -1;
 
-        port = qos_conf[i].sched_port;
+        port = app_sched_port(&qos_conf[i], &subport_id);
 
         average = 0;
 
@@ -212,7 +224,7 @@ qavg_subport(uint16_t port_id, uint32_t subport_id)
         if (i == nb_pfc || subport_id >= port_params.n_subports_per_port)
                 return -1;
 
-        port = qos_conf[i].sched_port;
+        port = app_sched_port(&qos_conf[i], &subport_id);
 
         average = 0;
 
@@ -253,7 +265,7 @@ subport_stat(uint16_t port_id, uint32_t subport_id)
         if (i == nb_pfc || subport_id >= port_params.n_subports_per_port)
                 return -1;
 
-        port = qos_conf[i].sched_port;
+        port = app_sched_port(&qos_conf[i], &subport_id);
 	memset (tc_ov, 0, sizeof(tc_ov));
 
         rte_sched_subport_read_stats(port, subport_id, &stats, tc_ov);
@@ -290,7 +302,7 @@ pipe_stat(uint16_t port_id, uint32_t subport_id, uint32_t pipe_id)
         if (i == nb_pfc || subport_id >= port_params.n_subports_per_port || pipe_id >= port_params.n_pipes_per_subport)
                 return -1;
 
-        port = qos_conf[i].sched_port;
+        port = app_sched_port(&qos_conf[i], &subport_id);
 
         queue_id = RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * (subport_id * port_params.n_pipes_per_subport + pipe_id);
 
@@ -233,22 +233,30 @@ populate_efd_table(void)
 {
 	unsigned int i;
 	int32_t ret;
-	uint32_t ip_dst;
+	uint32_t *ip_dst;
+	efd_value_t *node_id;
 	uint8_t socket_id = rte_socket_id();
-	uint64_t node_id;
 
-	/* Add flows in table */
+	ip_dst = rte_malloc(NULL, num_flows * sizeof(*ip_dst), 0);
+	node_id = rte_malloc(NULL, num_flows * sizeof(*node_id), 0);
+	if (ip_dst == NULL || node_id == NULL)
+		rte_exit(EXIT_FAILURE, "Unable to allocate EFD keys\n");
+
 	for (i = 0; i < num_flows; i++) {
-		node_id = i % num_nodes;
-
-		ip_dst = rte_cpu_to_be_32(i);
-		ret = rte_efd_update(efd_table, socket_id,
-				(void *)&ip_dst, (efd_value_t)node_id);
-		if (ret < 0)
-			rte_exit(EXIT_FAILURE, "Unable to add entry %u in "
-					"EFD table\n", i);
+		ip_dst[i] = rte_cpu_to_be_32(i);
+		node_id[i] = (efd_value_t)(i % num_nodes);
 	}
 
+	/* Add all flows in table at once, using all available lcores */
+	ret = rte_efd_build(efd_table, socket_id, num_flows, ip_dst, node_id,
+			rte_lcore_count());
+	if (ret != 0)
+		rte_exit(EXIT_FAILURE, "Unable to add 0x%x entries in "
+				"EFD table\n", num_flows);
+
+	rte_free(ip_dst);
+	rte_free(node_id);
+
 	printf("EFD table: Adding 0x%x keys\n", num_flows);
 }
 
@@ -195,6 +195,8 @@ struct rte_acl_ctx {
 	uint32_t            max_rules;
 	uint32_t            rule_sz;
 	uint32_t            num_rules;
+	struct acl_delta   *delta;     /* incremental updates, if enabled. */
+	uint32_t            build_threads; /* max threads for rte_acl_build. */
 	uint32_t            num_categories;
 	uint32_t            num_tries;
 	uint32_t            match_index;
@@ -215,6 +217,26 @@ int rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 typedef int (*rte_acl_classify_t)
 (const struct rte_acl_ctx *, const uint8_t **, uint32_t *, uint32_t, uint32_t);
 
+/*
+ * Incremental updates (delta tries) support.
+ */
+void acl_delta_fold(struct rte_acl_ctx *ctx);
+
+void acl_delta_sync(struct rte_acl_ctx *ctx);
+
+void acl_delta_reset_rules(struct rte_acl_ctx *ctx);
+
+void acl_delta_free(struct rte_acl_ctx *ctx);
+
+void acl_delta_dump(const struct rte_acl_ctx *ctx);
+
+int acl_delta_active(const struct rte_acl_ctx *ctx);
+
+int
+acl_delta_classify(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t num, uint32_t categories,
+	rte_acl_classify_t fn);
+
 /*
  * Different implementations of ACL classify.
  */
@@ -230,6 +252,10 @@ int
 rte_acl_classify_avx2(const struct rte_acl_ctx *ctx, const uint8_t **data,
 	uint32_t *results, uint32_t num, uint32_t categories);
 
+int
+rte_acl_classify_avx512(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t num, uint32_t categories);
+
 int
 rte_acl_classify_neon(const struct rte_acl_ctx *ctx, const uint8_t **data,
 	uint32_t *results, uint32_t num, uint32_t categories);
@@ -114,6 +114,20 @@ struct acl_build_context {
 	/* memory free lists for nodes and blocks used for node ptrs */
 	struct acl_mem_block      blocks[MEM_BLOCK_NUM];
 	struct rte_acl_node       *node_free_list;
+
+	/* tries that are (re)built by helper threads. */
+	uint32_t                  num_workers;
+	struct acl_build_worker   *workers[RTE_ACL_MAX_TRIES];
+	struct tb_mem_pool        trie_pool[RTE_ACL_MAX_TRIES];
+};
+
+/* Helper thread that builds one trie with its own build context. */
+struct acl_build_worker {
+	pthread_t                 tid;
+	int32_t                   rc;
+	uint32_t                  trie;
+	struct rte_acl_build_rule *rule_sets[RTE_ACL_MAX_TRIES];
+	struct acl_build_context  bcx;
 };
 
 static int acl_merge_trie(struct acl_build_context *context,
@@ -1300,10 +1314,156 @@ build_one_trie(struct acl_build_context *context,
 	return last;
 }
 
+static void *
+acl_worker_main(void *arg)
+{
+	int32_t rc;
+	struct acl_build_worker *wrk;
+	struct rte_acl_build_rule *last;
+
+	wrk = arg;
+
+	/* helper thread runs out of memory. */
+	rc = sigsetjmp(wrk->bcx.pool.fail, 0);
+	if (rc != 0) {
+		wrk->rc = rc;
+		return NULL;
+	}
+
+	last = build_one_trie(&wrk->bcx, wrk->rule_sets, wrk->trie, INT32_MAX);
+	if (wrk->bcx.bld_tries[wrk->trie].trie == NULL || last != NULL)
+		wrk->rc = -ENOMEM;
+	else
+		wrk->rc = 0;
+
+	return NULL;
+}
+
+/*
+ * Wait for the helper thread that builds n-th trie
+ * and take over the results of its work.
+ */
+static int
+acl_worker_join(struct acl_build_context *context, uint32_t n)
+{
+	int32_t rc;
+	struct acl_build_worker *wrk;
+
+	wrk = context->workers[n];
+	pthread_join(wrk->tid, NULL);
+
+	context->workers[n] = NULL;
+	context->num_workers--;
+
+	/* trie nodes have to stay around till the end of the build. */
+	context->trie_pool[n] = wrk->bcx.pool;
+
+	rc = wrk->rc;
+	if (rc == 0) {
+		context->tries[n] = wrk->bcx.tries[n];
+		context->bld_tries[n] = wrk->bcx.bld_tries[n];
+		memcpy(context->data_indexes[n], wrk->bcx.data_indexes[n],
+			sizeof(context->data_indexes[n]));
+		context->tries[n].data_index = context->data_indexes[n];
+		context->num_nodes += wrk->bcx.num_nodes;
+	} else
+		RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", n);
+
+	free(wrk);
+	return rc;
+}
+
+static int
+acl_worker_join_all(struct acl_build_context *context)
+{
+	int32_t rc, ret;
+	uint32_t n;
+
+	ret = 0;
+	for (n = 0; n != RTE_DIM(context->workers); n++) {
+		if (context->workers[n] != NULL) {
+			rc = acl_worker_join(context, n);
+			ret = (ret == 0) ? rc : ret;
+		}
+	}
+	return ret;
+}
+
+/*
+ * Start a helper thread to rebuild n-th trie.
+ */
+static int
+acl_worker_start(struct acl_build_context *context,
+	struct rte_acl_build_rule *rule_sets[RTE_ACL_MAX_TRIES], uint32_t n)
+{
+	int32_t rc;
+	struct acl_build_worker *wrk;
+
+	wrk = calloc(1, sizeof(*wrk));
+	if (wrk == NULL)
+		return -ENOMEM;
+
+	wrk->trie = n;
+	wrk->rule_sets[n] = rule_sets[n];
+	wrk->bcx.acx = context->acx;
+	wrk->bcx.pool.alignment = context->pool.alignment;
+	wrk->bcx.pool.min_alloc = context->pool.min_alloc;
+	wrk->bcx.cfg = context->cfg;
+	wrk->bcx.category_mask = context->category_mask;
+	wrk->bcx.node_max = context->node_max;
+
+	rc = pthread_create(&wrk->tid, NULL, acl_worker_main, wrk);
+	if (rc != 0) {
+		free(wrk);
+		return -rc;
+	}
+
+	context->workers[n] = wrk;
+	context->num_workers++;
+	return 0;
+}
+
+/*
+ * Rebuild n-th trie for the reduced rule-set,
+ * either in the current or in the helper thread.
+ */
+static int
+acl_rebuild_trie(struct acl_build_context *context,
+	struct rte_acl_build_rule *rule_sets[RTE_ACL_MAX_TRIES], uint32_t n)
+{
+	int32_t rc;
+	uint32_t i;
+	struct rte_acl_build_rule *last;
+
+	if (context->acx->build_threads > 1) {
+
+		/* all allowed threads are busy, wait for the oldest one. */
+		if (context->num_workers + 1 >= context->acx->build_threads) {
+			for (i = 0; context->workers[i] == NULL; i++)
+				;
+			rc = acl_worker_join(context, i);
+			if (rc != 0)
+				return rc;
+		}
+
+		/* if no thread can be started, do it by ourselves. */
+		if (acl_worker_start(context, rule_sets, n) == 0)
+			return 0;
+	}
+
+	last = build_one_trie(context, rule_sets, n, INT32_MAX);
+	if (context->bld_tries[n].trie == NULL || last != NULL) {
+		RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", n);
+		return -ENOMEM;
+	}
+	return 0;
+}
+
 static int
 acl_build_tries(struct acl_build_context *context,
 	struct rte_acl_build_rule *head)
 {
+	int32_t rc;
 	uint32_t n, num_tries;
 	struct rte_acl_config *config;
 	struct rte_acl_build_rule *last;
@@ -1363,14 +1523,15 @@ acl_build_tries(struct acl_build_context *context,
 		 * Rebuild the trie for the reduced rule-set.
 		 * Don't try to split it any further.
 		 */
-		last = build_one_trie(context, rule_sets, n, INT32_MAX);
-		if (context->bld_tries[n].trie == NULL || last != NULL) {
-			RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", n);
-			return -ENOMEM;
-		}
-
+		rc = acl_rebuild_trie(context, rule_sets, n);
+		if (rc != 0)
+			return rc;
 	}
 
+	rc = acl_worker_join_all(context);
+	if (rc != 0)
+		return rc;
+
 	context->num_tries = num_tries;
 	return 0;
 }
@@ -1379,6 +1540,11 @@ static void
 acl_build_log(const struct acl_build_context *ctx)
 {
 	uint32_t n;
+	size_t alloc;
+
+	alloc = ctx->pool.alloc;
+	for (n = 0; n != RTE_DIM(ctx->trie_pool); n++)
+		alloc += ctx->trie_pool[n].alloc;
 
 	RTE_LOG(DEBUG, ACL, "Build phase for ACL \"%s\":\n"
 		"node limit for tree split: %u\n"
@@ -1387,7 +1553,7 @@ acl_build_log(const struct acl_build_context *ctx)
 		ctx->acx->name,
 		ctx->node_max,
 		ctx->num_nodes,
-		ctx->pool.alloc);
+		alloc);
 
 	for (n = 0; n < RTE_DIM(ctx->tries); n++) {
 		if (ctx->tries[n].count != 0)
@@ -1485,6 +1651,7 @@ acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
 		RTE_LOG(ERR, ACL,
 			"ACL context: %s, %s() failed with error code: %d\n",
 			bcx->acx->name, __func__, rc);
+		acl_worker_join_all(bcx);
 		return rc;
 	}
 
@@ -1499,6 +1666,9 @@ acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
 	} else {
 		/* build internal trie representation. */
 		rc = acl_build_tries(bcx, bcx->build_rules);
+
+		/* wait for helper threads, if the build failed half-way. */
+		acl_worker_join_all(bcx);
 	}
 	return rc;
 }
@@ -1550,7 +1720,7 @@ int
 rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 {
 	int32_t rc;
-	uint32_t n;
+	uint32_t i, n;
 	size_t max_size;
 	struct acl_build_context bcx;
 
@@ -1558,6 +1728,10 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 	if (rc != 0)
 		return rc;
 
+	/* apply pending incremental updates to the rules. */
+	if (ctx->delta != NULL)
+		acl_delta_fold(ctx);
+
 	acl_build_reset(ctx);
 
 	if (cfg->max_size == 0) {
@@ -1585,6 +1759,9 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 
 				/* copy in build config. */
 				ctx->config = *cfg;
+
+				if (ctx->delta != NULL)
+					acl_delta_sync(ctx);
 			}
 		}
 
@@ -1592,6 +1769,8 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 
 		/* cleanup after build. */
 		tb_free_pool(&bcx.pool);
+		for (i = 0; i != RTE_DIM(bcx.trie_pool); i++)
+			tb_free_pool(&bcx.trie_pool[i]);
 	}
 
 	return rc;
@@ -0,0 +1,728 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rte_acl.h>
+#include "acl.h"
+
+/*
+ * Incremental updates support.
+ * The context built by rte_acl_build() (main tries) is never modified
+ * by the incremental API. Instead all updates go into a small secondary
+ * context (delta tries) that is rebuilt on every update:
+ * - added rules are placed into the delta as is.
+ * - deleted main rules are marked as dead. Any result from the main tries
+ *   that refers to a dead rule is ignored. To keep results correct,
+ *   all live main rules that overlap with the deleted one are copied into
+ *   the delta as shadow entries, so the next best match is still found.
+ * At classify time results from the main and delta tries are combined
+ * based on the rule priorities.
+ * When the delta becomes full, all updates are folded back into the main
+ * tries with a full rebuild.
+ */
+
+#define ACL_DELTA_BURST	64
+
+enum {
+	ACL_REF_DEAD = 1,   /* main rule is deleted. */
+	ACL_REF_SHADOW = 2, /* delta entry is a copy of live main rule. */
+};
+
+struct acl_rule_ref {
+	uint32_t userdata;
+	int32_t  priority;
+	uint32_t flags;
+	uint32_t idx;       /* position of the rule in the rules array. */
+};
+
+struct acl_delta {
+	struct rte_acl_ctx  *trie;      /* context with the delta rules. */
+	struct acl_rule_ref *main_ref;  /* main rules, sorted by userdata. */
+	struct acl_rule_ref *delta_ref; /* delta rules, sorted by userdata. */
+	uint32_t             num_main;
+	uint32_t             num_dead;
+	uint32_t             num_shadow;
+	uint32_t             discard;   /* rules were reset by the user. */
+	uint64_t             num_add;
+	uint64_t             num_del;
+	uint64_t             num_merge;
+};
+
+static int
+acl_ref_cmp(const void *a, const void *b)
+{
+	const struct acl_rule_ref *ra, *rb;
+
+	ra = a;
+	rb = b;
+	return (ra->userdata > rb->userdata) - (ra->userdata < rb->userdata);
+}
+
+static struct acl_rule_ref *
+acl_ref_find(struct acl_rule_ref *ref, uint32_t num, uint32_t userdata)
+{
+	struct acl_rule_ref key;
+
+	key.userdata = userdata;
+	return bsearch(&key, ref, num, sizeof(ref[0]), acl_ref_cmp);
+}
+
+static inline const struct rte_acl_rule *
+acl_rule_at(const struct rte_acl_ctx *ctx, uint32_t idx)
+{
+	return (const struct rte_acl_rule *)
+		((uintptr_t)ctx->rules + (size_t)idx * ctx->rule_sz);
+}
+
+static uint64_t
+acl_field_value(const union rte_acl_field_types *v, uint8_t size)
+{
+	switch (size) {
+	case sizeof(uint8_t):
+		return v->u8;
+	case sizeof(uint16_t):
+		return v->u16;
+	case sizeof(uint32_t):
+		return v->u32;
+	default:
+		return v->u64;
+	}
+}
+
+/*
+ * Convert a field into [lo, hi] range of values it matches.
+ */
+static void
+acl_field_range(const struct rte_acl_field_def *def,
+	const struct rte_acl_field *fld, uint64_t *lo, uint64_t *hi)
+{
+	uint32_t bits;
+	uint64_t msk, v, m;
+
+	bits = def->size * CHAR_BIT;
+	msk = (bits == 64) ? UINT64_MAX : (UINT64_C(1) << bits) - 1;
+	v = acl_field_value(&fld->value, def->size);
+	m = acl_field_value(&fld->mask_range, def->size);
+
+	if (def->type == RTE_ACL_FIELD_TYPE_RANGE) {
+		*lo = v;
+		*hi = m;
+	} else {
+		m = (m == 0) ? 0 : (msk << (bits - m)) & msk;
+		*lo = v & m;
+		*hi = *lo | (~m & msk);
+	}
+}
+
+/*
+ * Check could any input match both rules.
+ */
+static int
+acl_rule_overlap(const struct rte_acl_config *cfg,
+	const struct rte_acl_rule *r1, const struct rte_acl_rule *r2)
+{
+	uint32_t i, n;
+	uint64_t lo1, hi1, lo2, hi2, m;
+	const struct rte_acl_field_def *def;
+
+	if ((r1->data.category_mask & r2->data.category_mask) == 0)
+		return 0;
+
+	for (i = 0; i != cfg->num_fields; i++) {
+
+		def = cfg->defs + i;
+		n = def->field_index;
+
+		if (def->type == RTE_ACL_FIELD_TYPE_BITMASK) {
+			m = acl_field_value(&r1->field[n].mask_range,
+				def->size) & acl_field_value(
+				&r2->field[n].mask_range, def->size);
+			if (((acl_field_value(&r1->field[n].value, def->size) ^
+					acl_field_value(&r2->field[n].value,
+					def->size)) & m) != 0)
+				return 0;
+		} else {
+			acl_field_range(def, r1->field + n, &lo1, &hi1);
+			acl_field_range(def, r2->field + n, &lo2, &hi2);
+			if (lo1 > hi2 || lo2 > hi1)
+				return 0;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Rebuild sorted references to the rules stored in the context.
+ */
+static void
+acl_ref_fill(struct acl_rule_ref *ref, const struct rte_acl_ctx *ctx)
+{
+	uint32_t i;
+	const struct rte_acl_rule *r;
+
+	for (i = 0; i != ctx->num_rules; i++) {
+		r = acl_rule_at(ctx, i);
+		ref[i].userdata = r->data.userdata;
+		ref[i].priority = r->data.priority;
+		ref[i].flags = 0;
+		ref[i].idx = i;
+	}
+	qsort(ref, ctx->num_rules, sizeof(ref[0]), acl_ref_cmp);
+}
+
+static int
+acl_delta_build(struct rte_acl_ctx *ctx)
+{
+	int32_t rc;
+	struct acl_delta *dlt;
+
+	dlt = ctx->delta;
+
+	/* empty delta is never searched, rte_acl_build() would fail on it. */
+	if (dlt->trie->num_rules == 0)
+		return 0;
+
+	rc = rte_acl_build(dlt->trie, &ctx->config);
+	if (rc != 0)
+		RTE_LOG(ERR, ACL, "%s(%s): delta build failed, error: %d\n",
+			__func__, ctx->name, rc);
+	return rc;
+}
+
+/*
+ * Remove rule from the delta, last rule is moved into its place.
+ */
+static void
+acl_delta_remove(struct acl_delta *dlt, struct acl_rule_ref *ref)
+{
+	uint32_t idx, last;
+	struct rte_acl_ctx *trie;
+	struct acl_rule_ref *mv;
+
+	trie = dlt->trie;
+	idx = ref->idx;
+	last = trie->num_rules - 1;
+
+	if ((ref->flags & ACL_REF_SHADOW) != 0)
+		dlt->num_shadow--;
+
+	/* remove reference first, it keeps the array sorted. */
+	memmove(ref, ref + 1, ((dlt->delta_ref + last) - ref) * sizeof(*ref));
+
+	if (idx != last) {
+		memcpy((void *)(uintptr_t)acl_rule_at(trie, idx),
+			acl_rule_at(trie, last), trie->rule_sz);
+		mv = acl_ref_find(dlt->delta_ref, last,
+			acl_rule_at(trie, idx)->data.userdata);
+		mv->idx = idx;
+	}
+
+	trie->num_rules = last;
+}
+
+/*
+ * Append rule to the delta, caller has to check for available space.
+ */
+static void
+acl_delta_append(struct acl_delta *dlt, const struct rte_acl_rule *r,
+	uint32_t flags)
+{
+	uint32_t i, n;
+	struct rte_acl_ctx *trie;
+	struct acl_rule_ref *ref;
+
+	trie = dlt->trie;
+	n = trie->num_rules;
+
+	if (r != acl_rule_at(trie, n))
+		memcpy((void *)(uintptr_t)acl_rule_at(trie, n), r,
+			trie->rule_sz);
+	trie->num_rules = n + 1;
+
+	/* insertion into sorted array, delta is expected to be small. */
+	ref = dlt->delta_ref;
+	for (i = n; i != 0 && ref[i - 1].userdata > r->data.userdata; i--)
+		ref[i] = ref[i - 1];
+
+	ref[i].userdata = r->data.userdata;
+	ref[i].priority = r->data.priority;
+	ref[i].flags = flags;
+	ref[i].idx = n;
+
+	if ((flags & ACL_REF_SHADOW) != 0)
+		dlt->num_shadow++;
+}
+
+/*
+ * Copy all live main rules that overlap with the given one into the delta.
+ * Returns -ENOSPC if the delta doesn't have enough room for them.
+ */
+static int
+acl_delta_shadow(struct rte_acl_ctx *ctx, const struct rte_acl_rule *dr)
+{
+	uint32_t i, n;
+	struct acl_delta *dlt;
+	const struct rte_acl_rule *r;
+	struct acl_rule_ref *ref;
+
+	dlt = ctx->delta;
+	n = dlt->trie->max_rules - dlt->trie->num_rules;
+
+	for (i = 0; i != ctx->num_rules; i++) {
+
+		r = acl_rule_at(ctx, i);
+		if (r == dr || acl_rule_overlap(&ctx->config, r, dr) == 0)
+			continue;
+
+		ref = acl_ref_find(dlt->main_ref, dlt->num_main,
+			r->data.userdata);
+		if (ref == NULL || (ref->flags & ACL_REF_DEAD) != 0 ||
+				acl_ref_find(dlt->delta_ref,
+				dlt->trie->num_rules,
+				r->data.userdata) != NULL)
+			continue;
+
+		if (n-- == 0)
+			return -ENOSPC;
+
+		acl_delta_append(dlt, r, ACL_REF_SHADOW);
+	}
+
+	return 0;
+}
+
+/*
+ * Move delta rules into the main rules array and drop dead main rules.
+ * Called by rte_acl_build() before building the main tries.
+ */
+void
+acl_delta_fold(struct rte_acl_ctx *ctx)
+{
+	uint32_t i, j, n;
+	struct acl_delta *dlt;
+	struct acl_rule_ref *ref;
+	const struct rte_acl_rule *r;
+
+	dlt = ctx->delta;
+
+	if (dlt->discard == 0) {
+
+		/* compact main rules, skip the dead ones. */
+		n = 0;
+		for (i = 0; dlt->num_dead != 0 && i != ctx->num_rules; i++) {
+			r = acl_rule_at(ctx, i);
+			ref = acl_ref_find(dlt->main_ref, dlt->num_main,
+				r->data.userdata);
+			if (ref != NULL && (ref->flags & ACL_REF_DEAD) != 0)
+				continue;
+			if (n != i)
+				memcpy((void *)(uintptr_t)acl_rule_at(ctx, n),
+					r, ctx->rule_sz);
+			n++;
+		}
+		if (dlt->num_dead != 0)
+			ctx->num_rules = n;
+
+		/* append delta rules, shadow entries are already there. */
+		for (i = 0; i != dlt->trie->num_rules; i++) {
+			j = dlt->delta_ref[i].idx;
+			if ((dlt->delta_ref[i].flags & ACL_REF_SHADOW) != 0 ||
+					ctx->num_rules == ctx->max_rules)
+				continue;
+			memcpy((void *)(uintptr_t)acl_rule_at(ctx,
+				ctx->num_rules), acl_rule_at(dlt->trie, j),
+				ctx->rule_sz);
+			ctx->num_rules++;
+		}
+	}
+
+	dlt->num_main = 0;
+	dlt->num_dead = 0;
+	dlt->num_shadow = 0;
+	dlt->discard = 0;
+	dlt->trie->num_rules = 0;
+}
+
+/*
+ * Refresh main rules references after successful build.
+ */
+void
+acl_delta_sync(struct rte_acl_ctx *ctx)
+{
+	struct acl_delta *dlt;
+
+	dlt = ctx->delta;
+	acl_ref_fill(dlt->main_ref, ctx);
+	dlt->num_main = ctx->num_rules;
+	dlt->num_merge++;
+}
+
+void
+acl_delta_reset_rules(struct rte_acl_ctx *ctx)
+{
+	ctx->delta->discard = 1;
+}
+
+void
+acl_delta_free(struct rte_acl_ctx *ctx)
+{
+	struct acl_delta *dlt;
+
+	dlt = ctx->delta;
+	if (dlt == NULL)
+		return;
+
+	rte_free(dlt->trie->mem);
+	rte_free(dlt->trie);
+	rte_free(dlt->main_ref);
+	rte_free(dlt->delta_ref);
+	rte_free(dlt);
+	ctx->delta = NULL;
+}
+
+void
+acl_delta_dump(const struct rte_acl_ctx *ctx)
+{
+	const struct acl_delta *dlt;
+
+	dlt = ctx->delta;
+	printf("  delta_max_rules=%"PRIu32"\n", dlt->trie->max_rules);
+	printf("  delta_rules=%"PRIu32"\n", dlt->trie->num_rules);
+	printf("  delta_shadow_rules=%"PRIu32"\n", dlt->num_shadow);
+	printf("  dead_rules=%"PRIu32"\n", dlt->num_dead);
+	printf("  delta_adds=%"PRIu64"\n", dlt->num_add);
+	printf("  delta_dels=%"PRIu64"\n", dlt->num_del);
+	printf("  delta_merges=%"PRIu64"\n", dlt->num_merge);
+}
+
+static inline int32_t
+acl_ref_priority(struct acl_rule_ref *ref, uint32_t num, uint32_t userdata)
+{
+	const struct acl_rule_ref *r;
+
+	r = acl_ref_find(ref, num, userdata);
+	if (r == NULL || (r->flags & ACL_REF_DEAD) != 0)
+		return INT32_MIN;
+	return r->priority;
+}
+
+/*
+ * Classify against both main and delta tries.
+ * For each category the result with the higher priority wins,
+ * on equal priorities newer (delta) rule is preferred.
+ */
+int
+acl_delta_classify(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t num, uint32_t categories,
+	rte_acl_classify_t fn)
+{
+	int32_t rc, mp, dp;
+	uint32_t i, k, n, *res;
+	uint32_t dres[ACL_DELTA_BURST * RTE_ACL_MAX_CATEGORIES];
+	struct acl_delta *dlt;
+
+	dlt = ctx->delta;
+
+	rc = fn(ctx, data, results, num, categories);
+	if (rc != 0)
+		return rc;
+
+	for (i = 0; i < num; i += n) {
+
+		n = RTE_MIN(num - i, (uint32_t)ACL_DELTA_BURST);
+		res = results + i * categories;
+
+		if (dlt->trie->num_rules != 0) {
+			rc = fn(dlt->trie, data + i, dres, n, categories);
+			if (rc != 0)
+				return rc;
+		} else
+			memset(dres, 0, n * categories * sizeof(dres[0]));
+
+		for (k = 0; k != n * categories; k++) {
+
+			mp = INT32_MIN;
+			if (res[k] != 0)
+				mp = acl_ref_priority(dlt->main_ref,
+					dlt->num_main, res[k]);
+			if (mp == INT32_MIN)
+				res[k] = 0;
+
+			if (dres[k] != 0) {
+				dp = acl_ref_priority(dlt->delta_ref,
+					dlt->trie->num_rules, dres[k]);
+				if (dp >= mp)
+					res[k] = dres[k];
+			}
+		}
+	}
+
+	return 0;
+}
+
+int
+rte_acl_delta_setup(struct rte_acl_ctx *ctx, uint32_t max_rules)
+{
+	size_t sz;
+	struct acl_delta *dlt;
+	struct rte_acl_ctx *trie;
+
+	if (ctx == NULL || max_rules == 0 || ctx->rule_sz == 0)
+		return -EINVAL;
+	if (ctx->delta != NULL)
+		return -EEXIST;
+
+	dlt = rte_zmalloc_socket(ctx->name, sizeof(*dlt), RTE_CACHE_LINE_SIZE,
+		ctx->socket_id);
+	sz = sizeof(*trie) + (size_t)max_rules * ctx->rule_sz;
+	trie = rte_zmalloc_socket(ctx->name, sz, RTE_CACHE_LINE_SIZE,
+		ctx->socket_id);
+	if (dlt == NULL || trie == NULL) {
+		RTE_LOG(ERR, ACL,
+			"allocation of %zu bytes on socket %d for %s failed\n",
+			sz, ctx->socket_id, ctx->name);
+		rte_free(dlt);
+		rte_free(trie);
+		return -ENOMEM;
+	}
+
+	dlt->main_ref = rte_zmalloc_socket(ctx->name,
+		ctx->max_rules * sizeof(dlt->main_ref[0]),
+		RTE_CACHE_LINE_SIZE, ctx->socket_id);
+	dlt->delta_ref = rte_zmalloc_socket(ctx->name,
+		max_rules * sizeof(dlt->delta_ref[0]),
+		RTE_CACHE_LINE_SIZE, ctx->socket_id);
+	if (dlt->main_ref == NULL || dlt->delta_ref == NULL) {
+		RTE_LOG(ERR, ACL, "%s(%s): cannot allocate rule references\n",
+			__func__, ctx->name);
+		rte_free(dlt->main_ref);
+		rte_free(dlt->delta_ref);
+		rte_free(dlt);
+		rte_free(trie);
+		return -ENOMEM;
+	}
+
+	trie->rules = trie + 1;
+	trie->max_rules = max_rules;
+	trie->rule_sz = ctx->rule_sz;
+	trie->socket_id = ctx->socket_id;
+	trie->alg = ctx->alg;
+	snprintf(trie->name, sizeof(trie->name), "%s", ctx->name);
+
+	dlt->trie = trie;
+	ctx->delta = dlt;
+
+	/* context was already built, pick up its rules. */
+	if (ctx->config.num_fields != 0) {
+		acl_delta_sync(ctx);
+		dlt->num_merge = 0;
+	}
+
+	return 0;
+}
+
+/*
+ * Full rebuild with the current configuration.
+ * Note that build config has to be copied, as rte_acl_build()
+ * resets the context before using it.
+ */
+static int
+acl_delta_rebuild(struct rte_acl_ctx *ctx)
+{
+	struct rte_acl_config cfg;
+
+	cfg = ctx->config;
+	return rte_acl_build(ctx, &cfg);
+}
+
+static int
+acl_delta_check(const struct rte_acl_ctx *ctx)
+{
+	if (ctx == NULL || ctx->delta == NULL ||
+			ctx->config.num_fields == 0 ||
+			ctx->delta->discard != 0)
+		return -EINVAL;
+	return 0;
+}
+
+int
+rte_acl_delta_merge(struct rte_acl_ctx *ctx)
+{
+	int32_t rc;
+
+	rc = acl_delta_check(ctx);
+	if (rc != 0)
+		return rc;
+
+	return acl_delta_rebuild(ctx);
+}
+
+int
+rte_acl_delta_add_rules(struct rte_acl_ctx *ctx,
+	const struct rte_acl_rule *rules, uint32_t num)
+{
+	int32_t rc;
+	uint32_t i, live;
+	struct acl_delta *dlt;
+	const struct rte_acl_rule *r;
+	struct acl_rule_ref *ref;
+
+	rc = acl_delta_check(ctx);
+	if (rc != 0 || rules == NULL)
+		return -EINVAL;
+
+	dlt = ctx->delta;
+
+	/* check for duplicates, userdata is used as rule id. */
+	for (i = 0; i != num; i++) {
+		r = (const struct rte_acl_rule *)
+			((uintptr_t)rules + (size_t)i * ctx->rule_sz);
+		if (r->data.userdata == 0)
+			return -EINVAL;
+		ref = acl_ref_find(dlt->main_ref, dlt->num_main,
+			r->data.userdata);
+		if ((ref != NULL && (ref->flags & ACL_REF_DEAD) == 0) ||
+				acl_ref_find(dlt->delta_ref,
+				dlt->trie->num_rules,
+				r->data.userdata) != NULL)
+			return -EEXIST;
+	}
+
+	/* make sure all rules can be merged into the main context. */
+	live = dlt->num_main - dlt->num_dead +
+		dlt->trie->num_rules - dlt->num_shadow;
+	if (live + num > ctx->max_rules)
+		return -ENOMEM;
+
+	/* no room left in the delta, fold it into main tries. */
+	if (dlt->trie->num_rules + num > dlt->trie->max_rules) {
+
+		rc = acl_delta_rebuild(ctx);
+		if (rc != 0)
+			return rc;
+
+		/* too many rules for the delta, do full build. */
+		if (num > dlt->trie->max_rules) {
+			rc = rte_acl_add_rules(ctx, rules, num);
+			if (rc == 0)
+				rc = acl_delta_rebuild(ctx);
+			if (rc == 0)
+				dlt->num_add += num;
+			return rc;
+		}
+	}
+
+	rc = rte_acl_add_rules(dlt->trie, rules, num);
+	if (rc != 0)
+		return rc;
+
+	/* rte_acl_add_rules() placed new rules at the end, fix references. */
+	dlt->trie->num_rules -= num;
+	for (i = 0; i != num; i++)
+		acl_delta_append(dlt, acl_rule_at(dlt->trie,
+			dlt->trie->num_rules), 0);
+
+	rc = acl_delta_build(ctx);
+	if (rc == 0) {
+		dlt->num_add += num;
+		return 0;
+	}
+
+	/* take new rules out and rebuild, so the context stays unchanged. */
+	for (i = 0; i != num; i++) {
+		r = (const struct rte_acl_rule *)
+			((uintptr_t)rules + (size_t)i * ctx->rule_sz);
+		acl_delta_remove(dlt, acl_ref_find(dlt->delta_ref,
+			dlt->trie->num_rules, r->data.userdata));
+	}
+	acl_delta_build(ctx);
+	return rc;
+}
+
+int
+rte_acl_delta_del_rules(struct rte_acl_ctx *ctx, const uint32_t *userdata,
+	uint32_t num)
+{
+	int32_t rc;
+	uint32_t i, merge;
+	struct acl_delta *dlt;
+	struct acl_rule_ref *dref, *mref;
+
+	rc = acl_delta_check(ctx);
+	if (rc != 0 || userdata == NULL)
+		return -EINVAL;
+
+	dlt = ctx->delta;
+
+	for (i = 0; i != num; i++) {
+		mref = acl_ref_find(dlt->main_ref, dlt->num_main, userdata[i]);
+		dref = acl_ref_find(dlt->delta_ref, dlt->trie->num_rules,
+			userdata[i]);
+		if ((mref == NULL || (mref->flags & ACL_REF_DEAD) != 0) &&
+				dref == NULL)
+			return -ENOENT;
+	}
+
+	merge = 0;
+	for (i = 0; i != num; i++) {
+
+		dref = acl_ref_find(dlt->delta_ref, dlt->trie->num_rules,
+			userdata[i]);
+		if (dref != NULL)
+			acl_delta_remove(dlt, dref);
+
+		mref = acl_ref_find(dlt->main_ref, dlt->num_main, userdata[i]);
+		if (mref == NULL || (mref->flags & ACL_REF_DEAD) != 0)
+			continue;
+
+		mref->flags |= ACL_REF_DEAD;
+		dlt->num_dead++;
+
+		if (merge == 0 && acl_delta_shadow(ctx,
+				acl_rule_at(ctx, mref->idx)) != 0)
+			merge = 1;
+	}
+
+	dlt->num_del += num;
+
+	if (merge != 0)
+		return acl_delta_rebuild(ctx);
+
+	return acl_delta_build(ctx);
+}
+
+int
+acl_delta_active(const struct rte_acl_ctx *ctx)
+{
+	return ctx->delta->num_dead != 0 || ctx->delta->trie->num_rules != 0;
+}
@@ -443,21 +443,112 @@ acl_gen_node(struct rte_acl_node *node, uint64_t *node_array,
 	}
 }
 
+/*
+ * Per-trie state for the generation phase.
+ * Tries never share nodes, so each of them can be processed independently.
+ */
+struct acl_gen_trie {
+	struct rte_acl_node      *root;
+	uint64_t                 *node_array;
+	uint64_t                 no_match;
+	int                      num_categories;
+	struct acl_node_counters counts;
+	struct rte_acl_indices   indices;
+};
+
+struct acl_gen_thread {
+	pthread_t                tid;
+	int                      started;
+	uint32_t                 first;
+	uint32_t                 step;
+	uint32_t                 num;
+	struct acl_gen_trie      *gt;
+	void (*fn)(struct acl_gen_trie *);
+};
+
+static void
+acl_gen_count_trie(struct acl_gen_trie *gt)
+{
+	acl_count_trie_types(&gt->counts, gt->root, gt->no_match, 1);
+}
+
+static void
+acl_gen_trie(struct acl_gen_trie *gt)
+{
+	acl_gen_node(gt->root, gt->node_array, gt->no_match, &gt->indices,
+		gt->num_categories);
+}
+
+static void *
+acl_gen_thread_main(void *arg)
+{
+	uint32_t n;
+	struct acl_gen_thread *th;
+
+	th = arg;
+	for (n = th->first; n < th->num; n += th->step)
+		th->fn(th->gt + n);
+	return NULL;
+}
+
+/*
+ * Invoke fn() for each trie, spreading tries over up to num_threads threads.
+ */
+static void
+acl_gen_run(void (*fn)(struct acl_gen_trie *), struct acl_gen_trie gt[],
+	uint32_t num_tries, uint32_t num_threads)
+{
+	uint32_t i, n;
+	struct acl_gen_thread th[RTE_ACL_MAX_TRIES];
+
+	n = RTE_MIN(num_threads, num_tries);
+	n = RTE_MAX(n, 1U);
+
+	for (i = 0; i != n; i++) {
+		th[i].started = 0;
+		th[i].first = i;
+		th[i].step = n;
+		th[i].num = num_tries;
+		th[i].gt = gt;
+		th[i].fn = fn;
+	}
+
+	for (i = 1; i != n; i++)
+		th[i].started = (pthread_create(&th[i].tid, NULL,
+			acl_gen_thread_main, th + i) == 0);
+
+	acl_gen_thread_main(th);
+
+	/* if some thread failed to start, do its work by ourselves. */
+	for (i = 1; i != n; i++) {
+		if (th[i].started)
+			pthread_join(th[i].tid, NULL);
+		else
+			acl_gen_thread_main(th + i);
+	}
+}
+
 static void
 acl_calc_counts_indices(struct acl_node_counters *counts,
-	struct rte_acl_indices *indices,
-	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
-	uint64_t no_match)
+	struct rte_acl_indices *indices, struct acl_gen_trie gt[],
+	uint32_t num_tries, uint32_t num_threads)
 {
 	uint32_t n;
+	struct rte_acl_indices idx;
 
 	memset(indices, 0, sizeof(*indices));
 	memset(counts, 0, sizeof(*counts));
 
 	/* Get stats on nodes */
+	acl_gen_run(acl_gen_count_trie, gt, num_tries, num_threads);
+
 	for (n = 0; n < num_tries; n++) {
-		acl_count_trie_types(counts, node_bld_trie[n].trie,
-			no_match, 1);
+		counts->match += gt[n].counts.match;
+		counts->single += gt[n].counts.single;
+		counts->quad += gt[n].counts.quad;
+		counts->quad_vectors += gt[n].counts.quad_vectors;
+		counts->dfa += gt[n].counts.dfa;
+		counts->dfa_gr64 += gt[n].counts.dfa_gr64;
 	}
 
 	indices->dfa_index = RTE_ACL_DFA_SIZE + 1;
@@ -468,6 +559,20 @@ acl_calc_counts_indices(struct acl_node_counters *counts,
 	indices->match_start = RTE_ALIGN(indices->match_start,
 		(XMM_SIZE / sizeof(uint64_t)));
 	indices->match_index = 1;
+
+	/*
+	 * Each trie gets its own part of every node region, placed right
+	 * after the previous trie's one, so the layout is the same as
+	 * if all tries were generated one after another.
+	 */
+	idx = *indices;
+	for (n = 0; n < num_tries; n++) {
+		gt[n].indices = idx;
+		idx.dfa_index += gt[n].counts.dfa_gr64 * RTE_ACL_DFA_GR64_SIZE;
+		idx.quad_index += gt[n].counts.quad_vectors;
+		idx.single_index += gt[n].counts.single;
+		idx.match_index += gt[n].counts.match;
+	}
 }
 
 /*
@@ -481,16 +586,24 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	void *mem;
 	size_t total_size;
 	uint64_t *node_array, no_match;
-	uint32_t n, match_index;
+	uint32_t n, match_index, num_threads;
 	struct rte_acl_match_results *match;
 	struct acl_node_counters counts;
 	struct rte_acl_indices indices;
+	struct acl_gen_trie gt[RTE_ACL_MAX_TRIES];
 
 	no_match = RTE_ACL_NODE_MATCH;
+	num_threads = ctx->build_threads;
+
+	memset(gt, 0, sizeof(gt));
+	for (n = 0; n < num_tries; n++) {
+		gt[n].root = node_bld_trie[n].trie;
+		gt[n].no_match = no_match;
+		gt[n].num_categories = num_categories;
+	}
 
 	/* Fill counts and indices arrays from the nodes. */
-	acl_calc_counts_indices(&counts, &indices,
-		node_bld_trie, num_tries, no_match);
+	acl_calc_counts_indices(&counts, &indices, gt, num_tries, num_threads);
 
 	/* Allocate runtime memory (align to cache boundary) */
 	total_size = RTE_ALIGN(data_index_sz, RTE_CACHE_LINE_SIZE) +
@@ -534,11 +647,12 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	match = ((struct rte_acl_match_results *)(node_array + match_index));
 	memset(match, 0, sizeof(*match));
 
-	for (n = 0; n < num_tries; n++) {
+	for (n = 0; n < num_tries; n++)
+		gt[n].node_array = node_array;
 
-		acl_gen_node(node_bld_trie[n].trie, node_array, no_match,
-			&indices, num_categories);
+	acl_gen_run(acl_gen_trie, gt, num_tries, num_threads);
 
+	for (n = 0; n < num_tries; n++) {
 		if (node_bld_trie[n].trie->node_index == no_match)
 			trie[n].root_index = 0;
 		else
@@ -556,6 +670,9 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	ctx->trans_table = node_array;
 	memcpy(ctx->trie, trie, sizeof(ctx->trie));
 
+	if (num_tries != 0)
+		indices = gt[num_tries - 1].indices;
+
 	acl_gen_log_stats(ctx, &counts, &indices, max_size);
 	return 0;
 }
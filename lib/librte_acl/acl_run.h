@@ -37,6 +37,7 @@
 #include <rte_acl.h>
 #include "acl.h"
 
+#define MAX_SEARCHES_AVX32	32
 #define MAX_SEARCHES_AVX16	16
 #define MAX_SEARCHES_SSE8	8
 #define MAX_SEARCHES_ALTIVEC8	8
@@ -0,0 +1,337 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "acl_run_sse.h"
+
+/*
+ * Each 512-bit register holds 16 32-bit values, one per flow.
+ */
+#define	ZMM_FLOWS	(ZMM_SIZE / sizeof(uint32_t))
+
+static const rte_zmm_t zmm_match_mask = {
+	.u32 = {
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+	},
+};
+
+static const rte_zmm_t zmm_index_mask = {
+	.u32 = {
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+	},
+};
+
+static const rte_zmm_t zmm_shuffle_input = {
+	.u32 = {
+		0x00000000, 0x04040404, 0x08080808, 0x0c0c0c0c,
+		0x00000000, 0x04040404, 0x08080808, 0x0c0c0c0c,
+		0x00000000, 0x04040404, 0x08080808, 0x0c0c0c0c,
+		0x00000000, 0x04040404, 0x08080808, 0x0c0c0c0c,
+	},
+};
+
+static const rte_zmm_t zmm_ones_8 = {
+	.u32 = {
+		0x01010101, 0x01010101, 0x01010101, 0x01010101,
+		0x01010101, 0x01010101, 0x01010101, 0x01010101,
+		0x01010101, 0x01010101, 0x01010101, 0x01010101,
+		0x01010101, 0x01010101, 0x01010101, 0x01010101,
+	},
+};
+
+static const rte_zmm_t zmm_ones_16 = {
+	.u32 = {
+		0x00010001, 0x00010001, 0x00010001, 0x00010001,
+		0x00010001, 0x00010001, 0x00010001, 0x00010001,
+		0x00010001, 0x00010001, 0x00010001, 0x00010001,
+		0x00010001, 0x00010001, 0x00010001, 0x00010001,
+	},
+};
+
+static const rte_zmm_t zmm_range_base = {
+	.u32 = {
+		0xffffff00, 0xffffff04, 0xffffff08, 0xffffff0c,
+		0xffffff00, 0xffffff04, 0xffffff08, 0xffffff0c,
+		0xffffff00, 0xffffff04, 0xffffff08, 0xffffff0c,
+		0xffffff00, 0xffffff04, 0xffffff08, 0xffffff0c,
+	},
+};
+
+/* permutation indexes to split 64-bit transitions into low/high halves. */
+static const rte_zmm_t zmm_pmidx_lo = {
+	.u32 = {
+		0, 2, 4, 6, 8, 10, 12, 14,
+		16, 18, 20, 22, 24, 26, 28, 30,
+	},
+};
+
+static const rte_zmm_t zmm_pmidx_hi = {
+	.u32 = {
+		1, 3, 5, 7, 9, 11, 13, 15,
+		17, 19, 21, 23, 25, 27, 29, 31,
+	},
+};
+
+/*
+ * Calculate the address of the next transition for 16 flows.
+ * Same algorithm as ACL_TR_CALC_ADDR(), but node type selection is done
+ * with mask registers instead of byte blends.
+ */
+static __rte_always_inline __m512i
+calc_addr16(__m512i index_mask, __m512i next_input, __m512i shuffle_input,
+	__m512i ones_8, __m512i ones_16, __m512i range_base,
+	__m512i tr_lo, __m512i tr_hi)
+{
+	__mmask64 qm;
+	__mmask16 dfa_msk;
+	__m512i addr, in, node_type, r, t;
+	__m512i dfa_ofs, quad_ofs;
+
+	in = _mm512_shuffle_epi8(next_input, shuffle_input);
+
+	/* Calc node type and node addr */
+	node_type = _mm512_andnot_si512(index_mask, tr_lo);
+	addr = _mm512_and_si512(index_mask, tr_lo);
+
+	/* mask for DFA type(0) nodes */
+	dfa_msk = _mm512_testn_epi32_mask(node_type, node_type);
+
+	/* DFA calculations. */
+	r = _mm512_srli_epi32(in, 30);
+	r = _mm512_add_epi8(r, range_base);
+	t = _mm512_srli_epi32(in, 24);
+	r = _mm512_shuffle_epi8(tr_hi, r);
+
+	dfa_ofs = _mm512_sub_epi32(t, r);
+
+	/* QUAD/SINGLE calculations. */
+	qm = _mm512_cmpgt_epi8_mask(in, tr_hi);
+	t = _mm512_maskz_mov_epi8(qm, ones_8);
+	t = _mm512_maddubs_epi16(t, ones_8);
+	quad_ofs = _mm512_madd_epi16(t, ones_16);
+
+	/* blend DFA and QUAD/SINGLE. */
+	t = _mm512_mask_mov_epi32(quad_ofs, dfa_msk, dfa_ofs);
+
+	/* calculate address for next transitions. */
+	return _mm512_add_epi32(addr, t);
+}
+
+/*
+ * Process 16 transitions in parallel.
+ * tr_lo contains low 32 bits for 16 transitions.
+ * tr_hi contains high 32 bits for 16 transitions.
+ * next_input contains up to 4 input bytes for 16 flows.
+ */
+static __rte_always_inline __m512i
+transition16(__m512i next_input, const uint64_t *trans, __m512i *tr_lo,
+	__m512i *tr_hi)
+{
+	const int32_t *tr;
+	__m512i addr;
+
+	tr = (const int32_t *)(uintptr_t)trans;
+
+	/* Calculate the address (array index) for all 16 transitions. */
+	addr = calc_addr16(zmm_index_mask.z, next_input, zmm_shuffle_input.z,
+		zmm_ones_8.z, zmm_ones_16.z, zmm_range_base.z, *tr_lo, *tr_hi);
+
+	/* load lower 32 bits of 16 transactions at once. */
+	*tr_lo = _mm512_i32gather_epi32(addr, tr, sizeof(trans[0]));
+
+	next_input = _mm512_srli_epi32(next_input, CHAR_BIT);
+
+	/* load high 32 bits of 16 transactions at once. */
+	*tr_hi = _mm512_i32gather_epi32(addr, tr + 1, sizeof(trans[0]));
+
+	return next_input;
+}
+
+/*
+ * Process matches for 16 flows.
+ * Only flows selected by the msk are updated with their next transitions.
+ */
+static inline void
+acl_process_matches_avx512x16(const struct rte_acl_ctx *ctx,
+	struct parms *parms, struct acl_flow_data *flows, uint32_t slot,
+	__mmask16 msk, __m512i *tr_lo, __m512i *tr_hi)
+{
+	uint32_t i, m;
+	uint64_t tr;
+	uint32_t lo[ZMM_FLOWS], hi[ZMM_FLOWS];
+
+	_mm512_storeu_si512(lo, *tr_lo);
+	_mm512_storeu_si512(hi, *tr_hi);
+
+	for (m = msk; m != 0; m &= m - 1) {
+
+		i = rte_bsf32(m);
+
+		/*
+		 * Low 32bits of each transition are enough
+		 * to process the match.
+		 */
+		tr = acl_match_check(lo[i], slot + i, ctx, parms, flows,
+			resolve_priority_sse);
+		lo[i] = (uint32_t)tr;
+		hi[i] = tr >> (sizeof(uint32_t) * CHAR_BIT);
+	}
+
+	/* Keep transitions with NOMATCH intact. */
+	*tr_lo = _mm512_mask_loadu_epi32(*tr_lo, msk, lo);
+	*tr_hi = _mm512_mask_loadu_epi32(*tr_hi, msk, hi);
+}
+
+static inline void
+acl_match_check_avx512x16(const struct rte_acl_ctx *ctx, struct parms *parms,
+	struct acl_flow_data *flows, uint32_t slot,
+	__m512i *tr_lo, __m512i *tr_hi, __m512i match_mask)
+{
+	__mmask16 msk;
+
+	/* test for match node */
+	msk = _mm512_test_epi32_mask(*tr_lo, match_mask);
+
+	while (msk != 0) {
+		acl_process_matches_avx512x16(ctx, parms, flows, slot,
+			msk, tr_lo, tr_hi);
+		msk = _mm512_test_epi32_mask(*tr_lo, match_mask);
+	}
+}
+
+/*
+ * Gather 4 bytes of input data for 16 flows.
+ */
+static __rte_always_inline __m512i
+get_next_4bytes_avx512x16(struct parms *parms, uint32_t slot)
+{
+	uint32_t i;
+	uint32_t in[ZMM_FLOWS];
+
+	for (i = 0; i != RTE_DIM(in); i++)
+		in[i] = GET_NEXT_4BYTES(parms, slot + i);
+
+	return _mm512_loadu_si512(in);
+}
+
+/*
+ * Execute trie traversal for up to 16 * num flows in parallel.
+ * Several independent register sets help to hide the gather latency.
+ */
+static __rte_always_inline int
+search_avx512xn(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories,
+	uint32_t num)
+{
+	uint32_t i, k, n;
+	struct acl_flow_data flows;
+	uint64_t index_array[MAX_SEARCHES_AVX32];
+	struct completion cmplt[MAX_SEARCHES_AVX32];
+	struct parms parms[MAX_SEARCHES_AVX32];
+	__m512i input[MAX_SEARCHES_AVX32 / ZMM_FLOWS];
+	__m512i tr_lo[MAX_SEARCHES_AVX32 / ZMM_FLOWS];
+	__m512i tr_hi[MAX_SEARCHES_AVX32 / ZMM_FLOWS];
+	__m512i t0, t1;
+
+	n = num * ZMM_FLOWS;
+	acl_set_flow(&flows, cmplt, n, data, results,
+		total_packets, categories, ctx->trans_table);
+
+	for (i = 0; i != n; i++) {
+		cmplt[i].count = 0;
+		index_array[i] = acl_start_next_trie(&flows, parms, i, ctx);
+	}
+
+	for (k = 0; k != num; k++) {
+
+		/* split 64-bit transitions into low and high halves. */
+		t0 = _mm512_loadu_si512(index_array + k * ZMM_FLOWS);
+		t1 = _mm512_loadu_si512(index_array + k * ZMM_FLOWS +
+			ZMM_FLOWS / 2);
+		tr_lo[k] = _mm512_permutex2var_epi32(t0, zmm_pmidx_lo.z, t1);
+		tr_hi[k] = _mm512_permutex2var_epi32(t0, zmm_pmidx_hi.z, t1);
+
+		/* Check for any matches. */
+		acl_match_check_avx512x16(ctx, parms, &flows, k * ZMM_FLOWS,
+			&tr_lo[k], &tr_hi[k], zmm_match_mask.z);
+	}
+
+	while (flows.started > 0) {
+
+		for (k = 0; k != num; k++)
+			input[k] = get_next_4bytes_avx512x16(parms,
+				k * ZMM_FLOWS);
+
+		for (i = 0; i != sizeof(uint32_t); i++) {
+			for (k = 0; k != num; k++)
+				input[k] = transition16(input[k], flows.trans,
+					&tr_lo[k], &tr_hi[k]);
+		}
+
+		/* Check for any matches. */
+		for (k = 0; k != num; k++)
+			acl_match_check_avx512x16(ctx, parms, &flows,
+				k * ZMM_FLOWS, &tr_lo[k], &tr_hi[k],
+				zmm_match_mask.z);
+	}
+
+	return 0;
+}
+
+static inline int
+search_avx512x16(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories)
+{
+	return search_avx512xn(ctx, data, results, total_packets, categories,
+		1);
+}
+
+static inline int
+search_avx512x32(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories)
+{
+	return search_avx512xn(ctx, data, results, total_packets, categories,
+		2);
+}
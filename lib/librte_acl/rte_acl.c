@@ -55,6 +55,20 @@ rte_acl_classify_avx2(__rte_unused const struct rte_acl_ctx *ctx,
 	return -ENOTSUP;
 }
 
+/*
+ * If the compiler doesn't support AVX512 instructions,
+ * then the dummy one would be used instead for AVX512 classify method.
+ */
+int __attribute__ ((weak))
+rte_acl_classify_avx512(__rte_unused const struct rte_acl_ctx *ctx,
+	__rte_unused const uint8_t **data,
+	__rte_unused uint32_t *results,
+	__rte_unused uint32_t num,
+	__rte_unused uint32_t categories)
+{
+	return -ENOTSUP;
+}
+
 int __attribute__ ((weak))
 rte_acl_classify_sse(__rte_unused const struct rte_acl_ctx *ctx,
 	__rte_unused const uint8_t **data,
@@ -92,6 +106,7 @@ static const rte_acl_classify_t classify_fns[] = {
 	[RTE_ACL_CLASSIFY_AVX2] = rte_acl_classify_avx2,
 	[RTE_ACL_CLASSIFY_NEON] = rte_acl_classify_neon,
 	[RTE_ACL_CLASSIFY_ALTIVEC] = rte_acl_classify_altivec,
+	[RTE_ACL_CLASSIFY_AVX512] = rte_acl_classify_avx512,
 };
 
 /* by default, use always available scalar code path. */
@@ -110,15 +125,32 @@ rte_acl_set_ctx_classify(struct rte_acl_ctx *ctx, enum rte_acl_classify_alg alg)
 	if (ctx == NULL || (uint32_t)alg >= RTE_DIM(classify_fns))
 		return -EINVAL;
 
+	if (alg == RTE_ACL_CLASSIFY_DEFAULT)
+		alg = rte_acl_default_classify;
+
 	ctx->alg = alg;
 	return 0;
 }
 
+int
+rte_acl_set_ctx_build_threads(struct rte_acl_ctx *ctx, uint32_t num_threads)
+{
+	RTE_BUILD_BUG_ON(RTE_ACL_MAX_BUILD_THREADS > RTE_ACL_MAX_TRIES);
+
+	if (ctx == NULL || num_threads == 0 ||
+			num_threads > RTE_ACL_MAX_BUILD_THREADS)
+		return -EINVAL;
+
+	ctx->build_threads = num_threads;
+	return 0;
+}
+
 /*
  * Select highest available classify method as default one.
- * Note that CLASSIFY_AVX2 should be set as a default only
+ * Note that CLASSIFY_AVX2 (CLASSIFY_AVX512) should be set as a default only
  * if both conditions are met:
- * at build time compiler supports AVX2 and target cpu supports AVX2.
+ * at build time compiler supports AVX2 (AVX512F and AVX512BW)
+ * and target cpu supports them.
  */
 RTE_INIT(rte_acl_init)
 {
@@ -132,6 +164,12 @@ RTE_INIT(rte_acl_init)
 #elif defined(RTE_ARCH_PPC_64)
 	alg = RTE_ACL_CLASSIFY_ALTIVEC;
 #else
+#ifdef CC_AVX512_SUPPORT
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) > 0 &&
+			rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512BW) > 0)
+		alg = RTE_ACL_CLASSIFY_AVX512;
+	else
+#endif
 #ifdef CC_AVX2_SUPPORT
 	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
 		alg = RTE_ACL_CLASSIFY_AVX2;
@@ -154,6 +192,10 @@ rte_acl_classify_alg(const struct rte_acl_ctx *ctx, const uint8_t **data,
 			((RTE_ACL_RESULTS_MULTIPLIER - 1) & categories) != 0)
 		return -EINVAL;
 
+	if (ctx->delta != NULL && acl_delta_active(ctx))
+		return acl_delta_classify(ctx, data, results, num, categories,
+			classify_fns[alg]);
+
 	return classify_fns[alg](ctx, data, results, num, categories);
 }
 
@@ -216,6 +258,7 @@ rte_acl_free(struct rte_acl_ctx *ctx)
 
 	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
 
+	acl_delta_free(ctx);
 	rte_free(ctx->mem);
 	rte_free(ctx);
 	rte_free(te);
@@ -349,8 +392,11 @@ rte_acl_add_rules(struct rte_acl_ctx *ctx, const struct rte_acl_rule *rules,
 void
 rte_acl_reset_rules(struct rte_acl_ctx *ctx)
 {
-	if (ctx != NULL)
+	if (ctx != NULL) {
 		ctx->num_rules = 0;
+		if (ctx->delta != NULL)
+			acl_delta_reset_rules(ctx);
+	}
 }
 
 /*
@@ -381,6 +427,10 @@ rte_acl_dump(const struct rte_acl_ctx *ctx)
 	printf("  num_rules=%"PRIu32"\n", ctx->num_rules);
 	printf("  num_categories=%"PRIu32"\n", ctx->num_categories);
 	printf("  num_tries=%"PRIu32"\n", ctx->num_tries);
+	if (ctx->build_threads > 1)
+		printf("  build_threads=%"PRIu32"\n", ctx->build_threads);
+	if (ctx->delta != NULL)
+		acl_delta_dump(ctx);
 }
 
 /*
@@ -53,6 +53,9 @@ extern "C" {
 #define RTE_ACL_MAX_LEVELS 64
 #define RTE_ACL_MAX_FIELDS 64
 
+/** Max number of threads rte_acl_build() can use, one per trie at most. */
+#define RTE_ACL_MAX_BUILD_THREADS 8
+
 union rte_acl_field_types {
 	uint8_t  u8;
 	uint16_t u16;
@@ -260,6 +263,103 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg);
 void
 rte_acl_reset(struct rte_acl_ctx *ctx);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Enable incremental rule updates for the ACL context.
+ * Rules added or deleted with rte_acl_delta_add_rules() and
+ * rte_acl_delta_del_rules() are kept in a small secondary set of tries
+ * (delta), which is rebuilt on each update instead of the whole context.
+ * rte_acl_classify() consults both main and delta tries in one call.
+ * Once the delta is full, it is merged into the main tries by a full
+ * rte_acl_build(). Every rte_acl_build() merges pending updates too.
+ * Rule userdata is used as rule identifier and has to be unique and
+ * non-zero for all rules in the context.
+ * This function is not multi-thread safe.
+ *
+ * @param ctx
+ *   ACL context to enable incremental updates for.
+ * @param max_rules
+ *   Maximum number of rules in the delta before it gets merged.
+ *   Note that deletion of a rule may use several delta entries:
+ *   all rules that overlap with the deleted one are copied into the delta.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - -EEXIST if incremental updates are already enabled.
+ *   - -ENOMEM if couldn't allocate enough memory.
+ *   - Zero if operation completed successfully.
+ */
+int
+rte_acl_delta_setup(struct rte_acl_ctx *ctx, uint32_t max_rules);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Add rules to the ACL context without full rebuild.
+ * The context has to be built with rte_acl_build() at least once.
+ * This function is not multi-thread safe, in particular it can't be
+ * called concurrently with rte_acl_classify() for the same context.
+ *
+ * @param ctx
+ *   ACL context to add rules to.
+ * @param rules
+ *   Array of rules to add, in the same format as for rte_acl_add_rules().
+ * @param num
+ *   Number of elements in the input array of rules.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - -EEXIST if a rule with the same userdata already exists.
+ *   - -ENOMEM if there is no space in the ACL context for these rules.
+ *   - Negative error code if the build failed, no rules are added then.
+ *   - Zero if operation completed successfully.
+ */
+int
+rte_acl_delta_add_rules(struct rte_acl_ctx *ctx,
+	const struct rte_acl_rule *rules, uint32_t num);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Delete rules from the ACL context without full rebuild.
+ * This function is not multi-thread safe, in particular it can't be
+ * called concurrently with rte_acl_classify() for the same context.
+ *
+ * @param ctx
+ *   ACL context to delete rules from.
+ * @param userdata
+ *   Array of userdata values of the rules to delete.
+ * @param num
+ *   Number of elements in the userdata array.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - -ENOENT if one of the rules doesn't exist, no rules are deleted.
+ *   - Zero if operation completed successfully.
+ */
+int
+rte_acl_delta_del_rules(struct rte_acl_ctx *ctx, const uint32_t *userdata,
+	uint32_t num);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Merge pending incremental updates into the main tries.
+ * Equivalent to rte_acl_build() with the current build configuration.
+ * This function is not multi-thread safe.
+ *
+ * @param ctx
+ *   ACL context to merge updates for.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - Negative error code if build failed.
+ *   - Zero if operation completed successfully.
+ */
+int
+rte_acl_delta_merge(struct rte_acl_ctx *ctx);
+
 /**
  *  Available implementations of ACL classify.
  */
@@ -270,6 +370,7 @@ enum rte_acl_classify_alg {
 	RTE_ACL_CLASSIFY_AVX2 = 3,    /**< requires AVX2 support. */
 	RTE_ACL_CLASSIFY_NEON = 4,    /**< requires NEON support. */
 	RTE_ACL_CLASSIFY_ALTIVEC = 5,    /**< requires ALTIVEC support. */
+	RTE_ACL_CLASSIFY_AVX512 = 6,  /**< requires AVX512F/BW support. */
 	RTE_ACL_CLASSIFY_NUM          /* should always be the last one. */
 };
 
@@ -355,6 +456,8 @@ rte_acl_classify_alg(const struct rte_acl_ctx *ctx,
  *   ACL context to change classify function for.
  * @param alg
  *   New default classify algorithm for given ACL context.
+ *   RTE_ACL_CLASSIFY_DEFAULT selects the highest classify method
+ *   available on the given CPU.
  *   It is the caller responsibility to ensure that the value refers to the
  *   existing algorithm, and that it could be run on the given CPU.
  * @return
@@ -365,6 +468,30 @@ extern int
 rte_acl_set_ctx_classify(struct rte_acl_ctx *ctx,
 	enum rte_acl_classify_alg alg);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Set the maximum number of threads rte_acl_build() may use for a given
+ * ACL context. Tries are built and converted into the run-time
+ * representation concurrently by helper threads, spawned on each build.
+ * The run-time structures produced are identical to the ones built by
+ * one thread.
+ *
+ * @param ctx
+ *   ACL context to change number of build threads for.
+ * @param num_threads
+ *   Number of threads, including the calling one, to use for the build.
+ *   1 (the default) performs the whole build in the calling thread.
+ *   Can not exceed RTE_ACL_MAX_BUILD_THREADS, the maximum number of
+ *   tries per context.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - Zero if operation completed successfully.
+ */
+int
+rte_acl_set_ctx_build_threads(struct rte_acl_ctx *ctx, uint32_t num_threads);
+
 /**
  * Dump an ACL context structure to the console.
  *
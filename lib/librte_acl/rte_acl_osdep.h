@@ -51,6 +51,7 @@
 #include <stdarg.h>
 #include <stdlib.h>
 #include <sys/queue.h>
+#include <pthread.h>
 
 /*
  * Common defines.
@@ -113,8 +113,14 @@ struct rte_crypto_op {
 	uint8_t sess_type;
 	/**< operation session type */
 
-	uint8_t reserved[5];
+	uint8_t reserved[3];
 	/**< Reserved bytes to fill 64 bits for future additions */
+	uint16_t private_data_offset;
+	/**< Offset of the application private data of the operation, from
+	 * the start of the rte_crypto_op, 0 if there is none. The private
+	 * data is left untouched by the library and the PMDs, it is used
+	 * for example by the event crypto adapter.
+	 */
 	struct rte_mempool *mempool;
 	/**< crypto operation mempool which operation is allocated from */
 
@@ -140,6 +146,7 @@ __rte_crypto_op_reset(struct rte_crypto_op *op, enum rte_crypto_op_type type)
 	op->type = type;
 	op->status = RTE_CRYPTO_OP_STATUS_NOT_PROCESSED;
 	op->sess_type = RTE_CRYPTO_OP_SESSIONLESS;
+	op->private_data_offset = 0;
 
 	switch (type) {
 	case RTE_CRYPTO_OP_TYPE_SYMMETRIC:
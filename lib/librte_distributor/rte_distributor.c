@@ -75,6 +75,12 @@ rte_distributor_request_pkt_v1705(struct rte_distributor *d,
 		return;
 	}
 
+	if (d->alg_type == RTE_DIST_ALG_AFFINITY) {
+		rte_distributor_request_pkt_affinity(d, worker_id, oldpkt,
+				count);
+		return;
+	}
+
 	retptr64 = &(buf->retptr64[0]);
 	/* Spin while handshake bits are set (scheduler clears it) */
 	while (unlikely(*retptr64 & RTE_DISTRIB_GET_BUF)) {
@@ -125,6 +131,10 @@ rte_distributor_poll_pkt_v1705(struct rte_distributor *d,
 		return (pkts[0]) ? 1 : 0;
 	}
 
+	if (d->alg_type == RTE_DIST_ALG_AFFINITY)
+		return rte_distributor_poll_pkt_affinity(d, worker_id, pkts,
+				RTE_DIST_BURST_SIZE);
+
 	/* If bit is set, return */
 	if (buf->bufptr64[0] & RTE_DISTRIB_GET_BUF)
 		return -1;
@@ -167,6 +177,10 @@ rte_distributor_get_pkt_v1705(struct rte_distributor *d,
 			return -EINVAL;
 	}
 
+	if (d->alg_type == RTE_DIST_ALG_AFFINITY)
+		return rte_distributor_get_pkt_affinity(d, worker_id, pkts,
+				RTE_DIST_BURST_SIZE, oldpkt, return_count);
+
 	rte_distributor_request_pkt(d, worker_id, oldpkt, return_count);
 
 	count = rte_distributor_poll_pkt(d, worker_id, pkts);
@@ -201,6 +215,10 @@ rte_distributor_return_pkt_v1705(struct rte_distributor *d,
 			return -EINVAL;
 	}
 
+	if (d->alg_type == RTE_DIST_ALG_AFFINITY)
+		return rte_distributor_return_pkt_affinity(d, worker_id,
+				oldpkt, num);
+
 	for (i = 0; i < RTE_DIST_BURST_SIZE; i++)
 		/* Switch off the return bit first */
 		buf->retptr64[i] &= ~RTE_DISTRIB_RETURN_BUF;
@@ -219,6 +237,24 @@ MAP_STATIC_SYMBOL(int rte_distributor_return_pkt(struct rte_distributor *d,
 		unsigned int worker_id, struct rte_mbuf **oldpkt, int num),
 		rte_distributor_return_pkt_v1705);
 
+int
+rte_distributor_get_pkt_burst(struct rte_distributor *d,
+		unsigned int worker_id, struct rte_mbuf **pkts,
+		unsigned int max_pkts, struct rte_mbuf **oldpkt,
+		unsigned int retcount)
+{
+	if (d->alg_type == RTE_DIST_ALG_AFFINITY)
+		return rte_distributor_get_pkt_affinity(d, worker_id, pkts,
+				max_pkts, oldpkt, retcount);
+
+	/* the other modes fill up to a cache line of packets */
+	if (max_pkts < (d->alg_type == RTE_DIST_ALG_SINGLE ?
+			1 : RTE_DIST_BURST_SIZE))
+		return -EINVAL;
+
+	return rte_distributor_get_pkt(d, worker_id, pkts, oldpkt, retcount);
+}
+
 /**** APIs called on distributor core ***/
 
 /* stores a packet returned from a worker inside the returns array */
@@ -379,6 +415,9 @@ rte_distributor_process_v1705(struct rte_distributor *d,
 		return rte_distributor_process_v20(d->d_v20, mbufs, num_mbufs);
 	}
 
+	if (d->alg_type == RTE_DIST_ALG_AFFINITY)
+		return rte_distributor_process_affinity(d, mbufs, num_mbufs);
+
 	if (unlikely(num_mbufs == 0)) {
 		/* Flush out all non-full cache-lines to workers. */
 		for (wid = 0 ; wid < d->num_workers; wid++) {
@@ -508,8 +547,7 @@ rte_distributor_returned_pkts_v1705(struct rte_distributor *d,
 		struct rte_mbuf **mbufs, unsigned int max_mbufs)
 {
 	struct rte_distributor_returned_pkts *returns = &d->returns;
-	unsigned int retval = (max_mbufs < returns->count) ?
-			max_mbufs : returns->count;
+	unsigned int retval;
 	unsigned int i;
 
 	if (d->alg_type == RTE_DIST_ALG_SINGLE) {
@@ -518,6 +556,11 @@ rte_distributor_returned_pkts_v1705(struct rte_distributor *d,
 				mbufs, max_mbufs);
 	}
 
+	if (d->alg_type == RTE_DIST_ALG_AFFINITY)
+		rte_distributor_returns_affinity(d);
+
+	retval = (max_mbufs < returns->count) ? max_mbufs : returns->count;
+
 	for (i = 0; i < retval; i++) {
 		unsigned int idx = (returns->start + i) &
 				RTE_DISTRIB_RETURNS_MASK;
@@ -564,6 +607,9 @@ rte_distributor_flush_v1705(struct rte_distributor *d)
 		return rte_distributor_flush_v20(d->d_v20);
 	}
 
+	if (d->alg_type == RTE_DIST_ALG_AFFINITY)
+		return rte_distributor_flush_affinity(d);
+
 	flushed = total_outstanding(d);
 
 	while (total_outstanding(d) > 0)
@@ -596,6 +642,11 @@ rte_distributor_clear_returns_v1705(struct rte_distributor *d)
 		return;
 	}
 
+	if (d->alg_type == RTE_DIST_ALG_AFFINITY) {
+		rte_distributor_clear_returns_affinity(d);
+		return;
+	}
+
 	/* throw away returns, so workers can exit */
 	for (wkr = 0; wkr < d->num_workers; wkr++)
 		d->bufs[wkr].retptr64[0] = 0;
@@ -662,6 +713,17 @@ rte_distributor_create_v1705(const char *name,
 	d->dist_match_fn = RTE_DIST_MATCH_VECTOR;
 #endif
 
+	d->aff = NULL;
+	if (alg_type == RTE_DIST_ALG_AFFINITY) {
+		int ret = rte_distributor_affinity_init(d, socket_id);
+
+		if (ret != 0) {
+			rte_memzone_free(mz);
+			rte_errno = -ret;
+			return NULL;
+		}
+	}
+
 	/*
 	 * Set up the backlog tags so they're pointing at the second cache
 	 * line for performance during flow matching
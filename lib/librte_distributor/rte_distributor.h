@@ -49,9 +49,13 @@ extern "C" {
 enum rte_distributor_alg_type {
 	RTE_DIST_ALG_BURST = 0,
 	RTE_DIST_ALG_SINGLE,
+	RTE_DIST_ALG_AFFINITY,
 	RTE_DIST_NUM_ALG_TYPES
 };
 
+/** Maximum weight of a worker, see rte_distributor_set_worker_weight() */
+#define RTE_DIST_WEIGHT_MAX 16
+
 struct rte_distributor;
 struct rte_mbuf;
 
@@ -72,6 +76,13 @@ struct rte_mbuf;
  *   Call the legacy API, or use the new burst API. legacy uses 32-bit
  *   flow ID, and works on a single packet at a time. Latest uses 15-
  *   bit flow ID and works on up to 8 packets at a time to workers.
+ *   The affinity API keeps a table mapping the 32-bit flow IDs to workers
+ *   across calls instead of matching them against the packets in flight,
+ *   and passes packets to workers through rings, so workers can take
+ *   bursts of any size with rte_distributor_get_pkt_burst(). In this mode
+ *   packets of a worker which calls rte_distributor_return_pkt() are
+ *   moved to other workers on the next call to rte_distributor_process()
+ *   or rte_distributor_flush().
  * @return
  *   The newly created distributor instance
  */
@@ -136,7 +147,8 @@ rte_distributor_returned_pkts(struct rte_distributor *d,
 
 /**
  * Flush the distributor component, so that there are no in-flight or
- * backlogged packets awaiting processing
+ * backlogged packets awaiting processing. In affinity mode, it also returns
+ * once the array of returned packets is full.
  *
  * This should only be called on the same lcore as rte_distributor_process()
  *
@@ -160,6 +172,33 @@ rte_distributor_flush(struct rte_distributor *d);
 void
 rte_distributor_clear_returns(struct rte_distributor *d);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Set the relative capacity of a worker of an affinity mode distributor.
+ * New flows are given to the worker with the lowest number of outstanding
+ * packets relative to its weight, and idle flows move away from a worker
+ * once it has more than its weight times 32 packets outstanding.
+ * All workers have a weight of 1 after creation.
+ *
+ * This should only be called on the same lcore as rte_distributor_process()
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number
+ * @param weight
+ *   Weight of the worker, from 1 to RTE_DIST_WEIGHT_MAX
+ * @return
+ *   - 0 on success
+ *   - -EINVAL if a parameter is invalid
+ *   - -ENOTSUP if the distributor is not in affinity mode
+ */
+int
+rte_distributor_set_worker_weight(struct rte_distributor *d,
+		unsigned int worker_id, unsigned int weight);
+
 /*  *** APIS to be called on the worker lcores ***  */
 /*
  * The following APIs are the public APIs which are designed for use on
@@ -195,6 +234,40 @@ rte_distributor_get_pkt(struct rte_distributor *d,
 	unsigned int worker_id, struct rte_mbuf **pkts,
 	struct rte_mbuf **oldpkt, unsigned int retcount);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * API called by a worker to get new packets to process, like
+ * rte_distributor_get_pkt() but with the size of the pkts array given. In
+ * affinity mode, up to max_pkts packets are returned. The other modes
+ * return up to 8 packets, or a single one for the legacy API, and fail if
+ * the array is smaller than that.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param pkts
+ *   The mbufs pointer array to be filled in
+ * @param max_pkts
+ *   The size of the pkts array
+ * @param oldpkt
+ *   The previous packets, if any, being processed by the worker
+ * @param retcount
+ *   The number of packets being returned
+ *
+ * @return
+ *   The number of packets in the pkts array, or -EINVAL if max_pkts is too
+ *   small for the distributor mode
+ */
+int
+rte_distributor_get_pkt_burst(struct rte_distributor *d,
+	unsigned int worker_id, struct rte_mbuf **pkts,
+	unsigned int max_pkts, struct rte_mbuf **oldpkt,
+	unsigned int retcount);
+
 /**
  * API called by a worker to return a completed packet without requesting a
  * new packet, for example, because a worker thread is shutting down
@@ -0,0 +1,544 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <rte_mbuf.h>
+#include <rte_memory.h>
+#include <rte_malloc.h>
+#include <rte_ring.h>
+#include <rte_atomic.h>
+#include <rte_errno.h>
+#include <rte_pause.h>
+
+#include "rte_distributor_private.h"
+#include "rte_distributor.h"
+
+/*
+ * In affinity mode the distributor remembers which worker each flow was
+ * last sent to. A flow stays on that worker while the worker has not
+ * finished all packets sent to it up to the last packet of the flow, which
+ * keeps packets of a flow in order without matching tags against the
+ * packets in flight. Once idle, a flow stays on its worker unless that
+ * worker is loaded beyond its weighted quanta, in which case it moves to
+ * the least loaded worker.
+ */
+
+/* maps a 32-bit tag to an entry of the flow table */
+static inline uint32_t
+flow_idx(uint32_t tag)
+{
+	return (tag * 0x9e3779b1) >> (32 - RTE_DIST_AFFINITY_FLOWS_BITS);
+}
+
+/* stores a packet returned from a worker inside the returns array */
+static inline void
+store_return(uintptr_t oldbuf, struct rte_distributor *d,
+		unsigned int *ret_start, unsigned int *ret_count)
+{
+	if (!oldbuf)
+		return;
+	/* store returns in a circular buffer */
+	d->returns.mbufs[(*ret_start + *ret_count) & RTE_DISTRIB_RETURNS_MASK]
+			= (void *)oldbuf;
+	*ret_start += (*ret_count == RTE_DISTRIB_RETURNS_MASK);
+	*ret_count += (*ret_count != RTE_DISTRIB_RETURNS_MASK);
+}
+
+/*
+ * Moves the packets returned by a worker to the returns array. Packets which
+ * don't fit are left in the worker ring. If force is set and that ring is
+ * full, a burst of the oldest returns is overwritten, as in the other modes,
+ * so that the worker never blocks on an application which doesn't collect
+ * its returns.
+ */
+static unsigned int
+handle_returns(struct rte_distributor *d, unsigned int wkr, int force)
+{
+	struct rte_distributor_worker *wk = &d->aff->wkr[wkr];
+	struct rte_mbuf *pkts[RTE_DIST_AFFINITY_BURST_SIZE];
+	unsigned int ret_start = d->returns.start,
+			ret_count = d->returns.count;
+	unsigned int count = 0;
+	unsigned int i, n, max;
+
+	do {
+		max = RTE_MIN(RTE_DISTRIB_RETURNS_MASK - ret_count,
+				RTE_DIST_AFFINITY_BURST_SIZE);
+		if (max == 0) {
+			if (!force || !rte_ring_full(wk->ret_ring))
+				break;
+			max = RTE_DIST_AFFINITY_BURST_SIZE;
+		}
+		n = rte_ring_sc_dequeue_burst(wk->ret_ring, (void **)pkts,
+				max, NULL);
+		for (i = 0; i < n; i++)
+			store_return((uintptr_t)pkts[i], d, &ret_start,
+					&ret_count);
+		count += n;
+	} while (n == max);
+
+	d->returns.start = ret_start;
+	d->returns.count = ret_count;
+	return count;
+}
+
+/* sends the backlog of a worker, waiting for room in its ring if needed */
+static void
+release(struct rte_distributor *d, unsigned int wkr)
+{
+	struct rte_distributor_worker *wk = &d->aff->wkr[wkr];
+	unsigned int sent = 0;
+
+	for (;;) {
+		sent += rte_ring_sp_enqueue_burst(wk->rx_ring,
+				(void * const *)&wk->pkts[sent],
+				wk->count - sent, NULL);
+		if (sent == wk->count)
+			break;
+		/* the worker may be waiting for room to return packets */
+		handle_returns(d, wkr, 1);
+		rte_pause();
+	}
+	wk->count = 0;
+}
+
+static void
+release_all(struct rte_distributor *d)
+{
+	unsigned int wkr;
+
+	for (wkr = 0; wkr < d->num_workers; wkr++)
+		if (d->aff->wkr[wkr].count)
+			release(d, wkr);
+}
+
+/* returns the active worker with the lowest load to weight ratio */
+static int
+least_loaded(const struct rte_distributor *d)
+{
+	const struct rte_distributor_worker *wk;
+	uint32_t load, best_load = 0, best_weight = 1;
+	unsigned int wkr;
+	int best = -1;
+
+	for (wkr = 0; wkr < d->num_workers; wkr++) {
+		wk = &d->aff->wkr[wkr];
+		if (wk->state_snap != RTE_DIST_WKR_ACTIVE)
+			continue;
+		load = wk->sent - wk->done_snap;
+		if (best < 0 || (uint64_t)load * best_weight <
+				(uint64_t)best_load * wk->weight) {
+			best = wkr;
+			best_load = load;
+			best_weight = wk->weight;
+		}
+	}
+	return best;
+}
+
+/* adds a packet to the backlog of the worker its flow is pinned to */
+static inline void
+assign(struct rte_distributor *d, struct rte_mbuf *mb)
+{
+	struct rte_distributor_affinity *aff = d->aff;
+	struct rte_distributor_flow *f = &aff->flows[flow_idx(mb->hash.usr)];
+	struct rte_distributor_worker *wk = &aff->wkr[f->wkr];
+	int wkr;
+
+	/*
+	 * A flow with packets not yet processed stays on its worker. An idle
+	 * flow is moved if its worker is gone or has too much work queued.
+	 */
+	if (wk->state_snap == RTE_DIST_WKR_IDLE ||
+			(int32_t)(wk->done_snap - f->seq) >= 0) {
+		if (wk->state_snap != RTE_DIST_WKR_ACTIVE ||
+				wk->sent - wk->done_snap >=
+				wk->weight * RTE_DIST_AFFINITY_QUANTA) {
+			wkr = least_loaded(d);
+			if (wkr >= 0) {
+				f->wkr = wkr;
+				wk = &aff->wkr[wkr];
+			}
+		}
+	}
+
+	if (unlikely(wk->count == RTE_DIST_AFFINITY_BURST_SIZE))
+		release(d, f->wkr);
+	wk->pkts[wk->count++] = mb;
+	f->seq = ++wk->sent;
+}
+
+/*
+ * Takes back the packets queued to a worker which has shut down, and hands
+ * them to the other workers.
+ */
+static void
+steal(struct rte_distributor *d, unsigned int wkr)
+{
+	struct rte_distributor_affinity *aff = d->aff;
+	struct rte_distributor_worker *wk = &aff->wkr[wkr];
+	unsigned int i, n;
+
+	if (!rte_atomic32_cmpset(&wk->state, RTE_DIST_WKR_EXITED,
+			RTE_DIST_WKR_STEALING))
+		return;
+
+	n = rte_ring_sc_dequeue_burst(wk->rx_ring, (void **)aff->stolen,
+			RTE_DIM(aff->stolen), NULL);
+	/* the stolen packets are the last ones sent to the worker */
+	wk->sent -= n;
+	wk->state_snap = RTE_DIST_WKR_IDLE;
+	rte_smp_wmb();
+	wk->state = RTE_DIST_WKR_IDLE;
+
+	for (i = 0; i < n; i++)
+		assign(d, aff->stolen[i]);
+}
+
+/*
+ * Takes a snapshot of the worker progress, collects the returned packets
+ * and moves the packets of workers which have shut down.
+ */
+static void
+poll_workers(struct rte_distributor *d)
+{
+	struct rte_distributor_worker *wk;
+	unsigned int wkr, active = 0;
+
+	for (wkr = 0; wkr < d->num_workers; wkr++) {
+		wk = &d->aff->wkr[wkr];
+		wk->state_snap = wk->state;
+		rte_smp_rmb();
+		wk->done_snap = wk->done;
+		active += (wk->state_snap == RTE_DIST_WKR_ACTIVE);
+		handle_returns(d, wkr, 1);
+	}
+
+	if (active == 0)
+		return;
+
+	for (wkr = 0; wkr < d->num_workers; wkr++)
+		if (d->aff->wkr[wkr].state_snap == RTE_DIST_WKR_EXITED)
+			steal(d, wkr);
+}
+
+/* makes workers waiting for packets return an empty burst */
+static void
+wake_workers(struct rte_distributor *d)
+{
+	unsigned int wkr;
+
+	for (wkr = 0; wkr < d->num_workers; wkr++)
+		d->aff->wkr[wkr].wake++;
+}
+
+/* number of packets queued to workers which can process them */
+static unsigned int
+total_outstanding(const struct rte_distributor *d)
+{
+	const struct rte_distributor_worker *wk;
+	unsigned int wkr, active = 0, exited = 0;
+
+	for (wkr = 0; wkr < d->num_workers; wkr++) {
+		wk = &d->aff->wkr[wkr];
+		if (wk->state == RTE_DIST_WKR_ACTIVE)
+			active += rte_ring_count(wk->rx_ring);
+		else if (wk->state == RTE_DIST_WKR_EXITED)
+			exited += rte_ring_count(wk->rx_ring);
+	}
+
+	/* packets of exited workers can only be moved to active ones */
+	return active ? active + exited : 0;
+}
+
+int
+rte_distributor_process_affinity(struct rte_distributor *d,
+		struct rte_mbuf **mbufs, unsigned int num_mbufs)
+{
+	unsigned int i;
+
+	poll_workers(d);
+
+	if (unlikely(num_mbufs == 0)) {
+		release_all(d);
+		wake_workers(d);
+		return 0;
+	}
+
+	for (i = 0; i < num_mbufs; i++)
+		if (likely(mbufs[i] != NULL))
+			assign(d, mbufs[i]);
+
+	release_all(d);
+
+	return num_mbufs;
+}
+
+void
+rte_distributor_returns_affinity(struct rte_distributor *d)
+{
+	unsigned int wkr;
+
+	for (wkr = 0; wkr < d->num_workers; wkr++)
+		handle_returns(d, wkr, 0);
+}
+
+int
+rte_distributor_flush_affinity(struct rte_distributor *d)
+{
+	unsigned int flushed;
+
+	flushed = total_outstanding(d);
+
+	/*
+	 * Stop once the returns array is full, so that no returned packet is
+	 * lost while waiting for the workers.
+	 */
+	while (total_outstanding(d) > 0 &&
+			d->returns.count < RTE_DISTRIB_RETURNS_MASK) {
+		poll_workers(d);
+		release_all(d);
+		rte_pause();
+	}
+
+	/*
+	 * Send empty burst to all workers to allow them to exit
+	 * gracefully, should they need to.
+	 */
+	wake_workers(d);
+
+	rte_distributor_returns_affinity(d);
+
+	return flushed;
+}
+
+void
+rte_distributor_clear_returns_affinity(struct rte_distributor *d)
+{
+	struct rte_mbuf *pkts[RTE_DIST_AFFINITY_BURST_SIZE];
+	unsigned int wkr;
+
+	/* throw away returns, so workers can exit */
+	for (wkr = 0; wkr < d->num_workers; wkr++)
+		while (rte_ring_sc_dequeue_burst(d->aff->wkr[wkr].ret_ring,
+				(void **)pkts, RTE_DIM(pkts), NULL) != 0)
+			;
+	d->returns.start = d->returns.count = 0;
+}
+
+/**** APIs called by workers ****/
+
+/* marks a worker which shut down as active again */
+static void
+worker_resume(struct rte_distributor_worker *wk)
+{
+	uint32_t state;
+
+	while ((state = wk->state) != RTE_DIST_WKR_ACTIVE) {
+		/* wait for the distributor to finish moving our packets */
+		if (state == RTE_DIST_WKR_STEALING) {
+			rte_pause();
+			continue;
+		}
+		rte_atomic32_cmpset(&wk->state, state, RTE_DIST_WKR_ACTIVE);
+	}
+}
+
+void
+rte_distributor_request_pkt_affinity(struct rte_distributor *d,
+		unsigned int worker_id, struct rte_mbuf **oldpkt,
+		unsigned int count)
+{
+	struct rte_distributor_worker *wk = &d->aff->wkr[worker_id];
+	unsigned int n = 0;
+
+	if (unlikely(wk->state != RTE_DIST_WKR_ACTIVE))
+		worker_resume(wk);
+
+	while (n < count) {
+		n += rte_ring_sp_enqueue_burst(wk->ret_ring,
+				(void * const *)&oldpkt[n], count - n, NULL);
+		if (n < count)
+			rte_pause();
+	}
+
+	/*
+	 * All packets received so far have been processed, so their flows
+	 * may be given to other workers.
+	 */
+	rte_smp_wmb();
+	wk->done = wk->received;
+}
+
+int
+rte_distributor_poll_pkt_affinity(struct rte_distributor *d,
+		unsigned int worker_id, struct rte_mbuf **pkts,
+		unsigned int max_pkts)
+{
+	struct rte_distributor_worker *wk = &d->aff->wkr[worker_id];
+	uint32_t wake;
+	unsigned int n;
+
+	n = rte_ring_sc_dequeue_burst(wk->rx_ring, (void **)pkts, max_pkts,
+			NULL);
+	if (n) {
+		wk->received += n;
+		return n;
+	}
+
+	wake = wk->wake;
+	if (wake != wk->wake_seen) {
+		wk->wake_seen = wake;
+		return 0;
+	}
+	return -1;
+}
+
+int
+rte_distributor_get_pkt_affinity(struct rte_distributor *d,
+		unsigned int worker_id, struct rte_mbuf **pkts,
+		unsigned int max_pkts, struct rte_mbuf **oldpkt,
+		unsigned int retcount)
+{
+	int count;
+
+	rte_distributor_request_pkt_affinity(d, worker_id, oldpkt, retcount);
+
+	count = rte_distributor_poll_pkt_affinity(d, worker_id, pkts,
+			max_pkts);
+	while (count == -1) {
+		rte_pause();
+		count = rte_distributor_poll_pkt_affinity(d, worker_id, pkts,
+				max_pkts);
+	}
+	return count;
+}
+
+int
+rte_distributor_return_pkt_affinity(struct rte_distributor *d,
+		unsigned int worker_id, struct rte_mbuf **oldpkt,
+		unsigned int num)
+{
+	struct rte_distributor_worker *wk = &d->aff->wkr[worker_id];
+
+	rte_distributor_request_pkt_affinity(d, worker_id, oldpkt, num);
+
+	/* let the distributor move the packets still queued to us */
+	rte_smp_wmb();
+	wk->state = RTE_DIST_WKR_EXITED;
+
+	return 0;
+}
+
+/**** Setup ****/
+
+/*
+ * The ring names are derived from the distributor name when they fit, and
+ * from the distributor address otherwise, so that a truncated name cannot
+ * collide with the rings of another distributor.
+ */
+static struct rte_ring *
+affinity_ring_create(struct rte_distributor *d, char type,
+		unsigned int worker_id, unsigned int socket_id)
+{
+	char ring_name[RTE_RING_NAMESIZE];
+	int ret;
+
+	ret = snprintf(ring_name, sizeof(ring_name),
+			RTE_DISTRIB_PREFIX"%s_%c%u", d->name, type, worker_id);
+	if (ret < 0 || ret >= (int)sizeof(ring_name))
+		snprintf(ring_name, sizeof(ring_name),
+				RTE_DISTRIB_PREFIX"%p_%c%u", (void *)d, type,
+				worker_id);
+
+	return rte_ring_create(ring_name, RTE_DIST_AFFINITY_RING_SIZE,
+			socket_id, RING_F_SP_ENQ | RING_F_SC_DEQ);
+}
+
+int
+rte_distributor_affinity_init(struct rte_distributor *d,
+		unsigned int socket_id)
+{
+	struct rte_distributor_affinity *aff;
+	struct rte_distributor_worker *wk;
+	unsigned int i;
+
+	if (d->num_workers == 0)
+		return -EINVAL;
+
+	aff = rte_zmalloc_socket(d->name, sizeof(*aff), RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (aff == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < d->num_workers; i++) {
+		wk = &aff->wkr[i];
+		wk->weight = 1;
+
+		wk->rx_ring = affinity_ring_create(d, 'r', i, socket_id);
+		wk->ret_ring = affinity_ring_create(d, 't', i, socket_id);
+		if (wk->rx_ring == NULL || wk->ret_ring == NULL)
+			goto err;
+	}
+
+	/* spread the flows over the workers to begin with */
+	for (i = 0; i < RTE_DIST_AFFINITY_FLOWS; i++)
+		aff->flows[i].wkr = i % d->num_workers;
+
+	d->aff = aff;
+	return 0;
+
+err:
+	for (i = 0; i < d->num_workers; i++) {
+		rte_ring_free(aff->wkr[i].rx_ring);
+		rte_ring_free(aff->wkr[i].ret_ring);
+	}
+	rte_free(aff);
+	return -ENOMEM;
+}
+
+int
+rte_distributor_set_worker_weight(struct rte_distributor *d,
+		unsigned int worker_id, unsigned int weight)
+{
+	if (d == NULL || worker_id >= d->num_workers || weight == 0 ||
+			weight > RTE_DIST_WEIGHT_MAX)
+		return -EINVAL;
+
+	if (d->alg_type != RTE_DIST_ALG_AFFINITY)
+		return -ENOTSUP;
+
+	d->aff->wkr[worker_id].weight = weight;
+	return 0;
+}
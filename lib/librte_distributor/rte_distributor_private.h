@@ -158,6 +158,66 @@ struct rte_distributor_buffer {
 	int count __rte_cache_aligned;       /* <= number of current mbufs */
 };
 
+/*
+ * Affinity mode: flows are looked up in a table of RTE_DIST_AFFINITY_FLOWS
+ * entries indexed by a hash of the tag, and packets are passed to and from
+ * workers through a pair of rings per worker.
+ */
+#define RTE_DIST_AFFINITY_FLOWS_BITS 12
+#define RTE_DIST_AFFINITY_FLOWS (1 << RTE_DIST_AFFINITY_FLOWS_BITS)
+#define RTE_DIST_AFFINITY_RING_SIZE 1024
+#define RTE_DIST_AFFINITY_BURST_SIZE 64U
+/**
+ * Number of packets a worker of weight one may have outstanding before
+ * idle flows pinned to it are moved to a less loaded worker.
+ */
+#define RTE_DIST_AFFINITY_QUANTA 32
+
+/* Worker states in affinity mode */
+#define RTE_DIST_WKR_ACTIVE 0   /**< worker is polling for packets */
+#define RTE_DIST_WKR_EXITED 1   /**< worker called rte_distributor_return_pkt */
+#define RTE_DIST_WKR_STEALING 2 /**< distributor is moving its packets */
+#define RTE_DIST_WKR_IDLE 3     /**< packets moved, flows no longer pinned */
+
+/* Entry of the flow affinity table */
+struct rte_distributor_flow {
+	uint32_t seq; /**< value of worker sent count after last packet */
+	uint32_t wkr; /**< worker the flow is pinned to */
+};
+
+/*
+ * Per worker state in affinity mode, split in cache lines by writer, so
+ * that the distributor and the worker don't share written cache lines.
+ */
+struct rte_distributor_worker {
+	/* written by the worker */
+	volatile uint32_t done __rte_cache_aligned;
+		/**< number of packets processed by the worker */
+	volatile uint32_t state;
+	uint32_t received;  /**< number of packets dequeued by the worker */
+	uint32_t wake_seen; /**< last value of wake seen by the worker */
+
+	/* written by the distributor, read by the worker */
+	struct rte_ring *rx_ring __rte_cache_aligned; /* <= to worker */
+	struct rte_ring *ret_ring;                    /* <= from worker */
+	volatile uint32_t wake; /**< incremented to send an empty burst */
+
+	/* private to the distributor */
+	uint32_t sent __rte_cache_aligned; /**< number of packets sent */
+	uint32_t done_snap;  /**< value of done when process was called */
+	uint32_t state_snap; /**< value of state when process was called */
+	uint32_t weight;
+	unsigned int count;  /**< number of packets in the backlog */
+	struct rte_mbuf *pkts[RTE_DIST_AFFINITY_BURST_SIZE];
+};
+
+struct rte_distributor_affinity {
+	struct rte_distributor_worker wkr[RTE_DISTRIB_MAX_WORKERS];
+	struct rte_distributor_flow flows[RTE_DIST_AFFINITY_FLOWS];
+	struct rte_mbuf *stolen[RTE_DIST_AFFINITY_RING_SIZE];
+		/**< packets taken back from a worker which shut down */
+};
+
 struct rte_distributor {
 	TAILQ_ENTRY(rte_distributor) next;    /**< Next in list. */
 
@@ -183,6 +243,8 @@ struct rte_distributor {
 	enum rte_distributor_match_function dist_match_fn;
 
 	struct rte_distributor_v20 *d_v20;
+
+	struct rte_distributor_affinity *aff; /**< affinity mode state */
 };
 
 void
@@ -195,6 +257,44 @@ find_match_vec(struct rte_distributor *d,
 			uint16_t *data_ptr,
 			uint16_t *output_ptr);
 
+int
+rte_distributor_affinity_init(struct rte_distributor *d,
+		unsigned int socket_id);
+
+int
+rte_distributor_process_affinity(struct rte_distributor *d,
+		struct rte_mbuf **mbufs, unsigned int num_mbufs);
+
+void
+rte_distributor_returns_affinity(struct rte_distributor *d);
+
+int
+rte_distributor_flush_affinity(struct rte_distributor *d);
+
+void
+rte_distributor_clear_returns_affinity(struct rte_distributor *d);
+
+void
+rte_distributor_request_pkt_affinity(struct rte_distributor *d,
+		unsigned int worker_id, struct rte_mbuf **oldpkt,
+		unsigned int count);
+
+int
+rte_distributor_poll_pkt_affinity(struct rte_distributor *d,
+		unsigned int worker_id, struct rte_mbuf **pkts,
+		unsigned int max_pkts);
+
+int
+rte_distributor_get_pkt_affinity(struct rte_distributor *d,
+		unsigned int worker_id, struct rte_mbuf **pkts,
+		unsigned int max_pkts, struct rte_mbuf **oldpkt,
+		unsigned int retcount);
+
+int
+rte_distributor_return_pkt_affinity(struct rte_distributor *d,
+		unsigned int worker_id, struct rte_mbuf **oldpkt,
+		unsigned int num);
+
 #ifdef __cplusplus
 }
 #endif
@@ -37,6 +37,11 @@
 #include <errno.h>
 #include <stdarg.h>
 #include <sys/queue.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #include <rte_log.h>
 #include <rte_eal_memconfig.h>
@@ -519,6 +524,71 @@ efd_search_hash(struct rte_efd_table * const table,
 	return 0;
 }
 
+/*
+ * Allocate one online table per socket specified in the bitmask
+ * and select the lookup function
+ */
+static int
+efd_alloc_online(struct rte_efd_table *table, uint8_t online_cpu_socket_bitmask)
+{
+	uint8_t socket_id;
+	uint64_t online_table_size = table->num_chunks *
+			sizeof(struct efd_online_chunk) +
+			EFD_NUM_CHUNK_PADDING_BYTES;
+
+	for (socket_id = 0; socket_id < RTE_MAX_NUMA_NODES; socket_id++) {
+		if ((online_cpu_socket_bitmask >> socket_id) & 0x01) {
+			/*
+			 * Allocate all of the EFD table chunks (the online portion)
+			 * as a continuous block
+			 */
+			table->chunks[socket_id] =
+				(struct efd_online_chunk *) rte_zmalloc_socket(
+				NULL,
+				online_table_size,
+				RTE_CACHE_LINE_SIZE,
+				socket_id);
+			if (table->chunks[socket_id] == NULL) {
+				RTE_LOG(ERR, EFD,
+						"Allocating EFD online table on "
+						"socket %u failed\n",
+						socket_id);
+				return -ENOMEM;
+			}
+			RTE_LOG(DEBUG, EFD,
+					"Allocated EFD online table of size "
+					"%"PRIu64" bytes (%.2f MB) on socket %u\n",
+					online_table_size,
+					(float) online_table_size /
+						(1024.0F * 1024.0F),
+					socket_id);
+		}
+	}
+
+#if defined(RTE_ARCH_X86)
+	/*
+	 * For less than 4 bits, scalar function performs better
+	 * than vectorised version
+	 */
+	if (RTE_EFD_VALUE_NUM_BITS > 3 && rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
+		table->lookup_fn = EFD_LOOKUP_AVX2;
+	else
+#endif
+#if defined(RTE_ARCH_ARM64)
+	/*
+	 * For less than or equal to 16 bits, scalar function performs better
+	 * than vectorised version
+	 */
+	if (RTE_EFD_VALUE_NUM_BITS > 16 &&
+	    rte_cpu_get_flag_enabled(RTE_CPUFLAG_NEON))
+		table->lookup_fn = EFD_LOOKUP_NEON;
+	else
+#endif
+		table->lookup_fn = EFD_LOOKUP_SCALAR;
+
+	return 0;
+}
+
 struct rte_efd_table *
 rte_efd_create(const char *name, uint32_t max_num_rules, uint32_t key_len,
 		uint8_t online_cpu_socket_bitmask, uint8_t offline_cpu_socket)
@@ -631,62 +701,8 @@ rte_efd_create(const char *name, uint32_t max_num_rules, uint32_t key_len,
 		table->chunks[socket_id] = NULL;
 	table->offline_chunks = NULL;
 
-	/*
-	 * Allocate one online table per socket specified
-	 * in the user-supplied bitmask
-	 */
-	uint64_t online_table_size = num_chunks * sizeof(struct efd_online_chunk) +
-			EFD_NUM_CHUNK_PADDING_BYTES;
-
-	for (socket_id = 0; socket_id < RTE_MAX_NUMA_NODES; socket_id++) {
-		if ((online_cpu_socket_bitmask >> socket_id) & 0x01) {
-			/*
-			 * Allocate all of the EFD table chunks (the online portion)
-			 * as a continuous block
-			 */
-			table->chunks[socket_id] =
-				(struct efd_online_chunk *) rte_zmalloc_socket(
-				NULL,
-				online_table_size,
-				RTE_CACHE_LINE_SIZE,
-				socket_id);
-			if (table->chunks[socket_id] == NULL) {
-				RTE_LOG(ERR, EFD,
-						"Allocating EFD online table on "
-						"socket %u failed\n",
-						socket_id);
-				goto error_unlock_exit;
-			}
-			RTE_LOG(DEBUG, EFD,
-					"Allocated EFD online table of size "
-					"%"PRIu64" bytes (%.2f MB) on socket %u\n",
-					online_table_size,
-					(float) online_table_size /
-						(1024.0F * 1024.0F),
-					socket_id);
-		}
-	}
-
-#if defined(RTE_ARCH_X86)
-	/*
-	 * For less than 4 bits, scalar function performs better
-	 * than vectorised version
-	 */
-	if (RTE_EFD_VALUE_NUM_BITS > 3 && rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
-		table->lookup_fn = EFD_LOOKUP_AVX2;
-	else
-#endif
-#if defined(RTE_ARCH_ARM64)
-	/*
-	 * For less than or equal to 16 bits, scalar function performs better
-	 * than vectorised version
-	 */
-	if (RTE_EFD_VALUE_NUM_BITS > 16 &&
-	    rte_cpu_get_flag_enabled(RTE_CPUFLAG_NEON))
-		table->lookup_fn = EFD_LOOKUP_NEON;
-	else
-#endif
-		table->lookup_fn = EFD_LOOKUP_SCALAR;
+	if (efd_alloc_online(table, online_cpu_socket_bitmask) != 0)
+		goto error_unlock_exit;
 
 	/*
 	 * Allocate the EFD table offline portion (with the actual rules
@@ -721,7 +737,9 @@ rte_efd_create(const char *name, uint32_t max_num_rules, uint32_t key_len,
 			offline_cpu_socket, 0);
 	if (r == NULL) {
 		RTE_LOG(ERR, EFD, "memory allocation failed\n");
-		goto error_unlock_exit;
+		/* Table is already listed, free it without the lock held */
+		rte_efd_free(table);
+		return NULL;
 	}
 
 	/* Populate free slots ring. Entry zero is reserved for key misses. */
@@ -733,6 +751,7 @@ rte_efd_create(const char *name, uint32_t max_num_rules, uint32_t key_len,
 
 error_unlock_exit:
 	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+	rte_free(te);
 	rte_efd_free(table);
 
 	return NULL;
@@ -768,10 +787,27 @@ void
 rte_efd_free(struct rte_efd_table *table)
 {
 	uint8_t socket_id;
+	struct rte_efd_list *efd_list;
+	struct rte_tailq_entry *te;
 
 	if (table == NULL)
 		return;
 
+	efd_list = RTE_TAILQ_CAST(rte_efd_tailq.head, rte_efd_list);
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	/* Remove the table from the list, if it was ever added to it */
+	TAILQ_FOREACH(te, efd_list, next) {
+		if (te->data == (void *) table)
+			break;
+	}
+	if (te != NULL)
+		TAILQ_REMOVE(efd_list, te, next);
+
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+	rte_free(te);
+
 	for (socket_id = 0; socket_id < RTE_MAX_NUMA_NODES; socket_id++)
 		rte_free(table->chunks[socket_id]);
 
@@ -1174,6 +1210,10 @@ rte_efd_update(struct rte_efd_table * const table, const unsigned int socket_id,
 	uint8_t new_bin_choice = 0;
 	struct efd_online_group_entry entry;
 
+	/* Table restored from a snapshot can't be updated */
+	if (unlikely(table->offline_chunks == NULL))
+		return RTE_EFD_UPDATE_FAILED;
+
 	int status = efd_compute_update(table, socket_id, key, value,
 			&chunk_id, &group_id, &bin_id,
 			&new_bin_choice, &entry);
@@ -1189,6 +1229,543 @@ rte_efd_update(struct rte_efd_table * const table, const unsigned int socket_id,
 	return status;
 }
 
+/*
+ * Bulk build support.
+ * Keys are first distributed among chunks, then each chunk is rebuilt
+ * from scratch: bins are assigned to the least loaded of their candidate
+ * groups and a perfect hash is computed once per group.
+ * Chunks are independent, so they are spread over several threads.
+ */
+
+/** Max number of attempts to move a bin out of a group with no perfect hash */
+#define EFD_BUILD_MAX_BIN_MOVES	(EFD_MAX_GROUP_NUM_BINS)
+
+/** Scratch area used to rebuild one chunk */
+struct efd_build_chunk {
+	uint32_t num_rules;
+	/**< Number of (existing and new) rules in the chunk */
+	uint16_t bin_size[EFD_CHUNK_NUM_BINS];
+	/**< Number of rules in each bin */
+	uint16_t bin_start[EFD_CHUNK_NUM_BINS];
+	/**< Index of the first rule of each bin in the sorted arrays */
+	uint8_t bin_choice[EFD_CHUNK_NUM_BINS];
+	/**< Chosen bin to group permutation */
+	uint8_t bin_order[EFD_CHUNK_NUM_BINS];
+	/**< Bins sorted by size, in descending order */
+	uint32_t group_size[EFD_CHUNK_NUM_GROUPS];
+	/**< Number of rules assigned to each group */
+	uint32_t *key_idx;
+	/**< Index of the key in the table key array or of the input key */
+	efd_value_t *value;
+	uint8_t *bin_id;
+	uint8_t *is_new;
+	/**< Non zero if key_idx refers to the input key */
+	uint32_t *sorted;
+	/**< Rule indexes sorted by bin */
+};
+
+/** Per thread state of the bulk build */
+struct efd_build_worker {
+	pthread_t tid;
+	int started;
+	int status;
+	uint32_t first_chunk;
+	uint32_t chunk_step;
+	uint32_t new_rules;
+	struct efd_build_chunk bc;
+	struct efd_offline_chunk_rules scratch;
+	/**< Offline groups being rebuilt, committed only on success */
+
+	struct rte_efd_table *table;
+	unsigned int socket_id;
+	const uint8_t *keys;
+	const efd_value_t *values;
+	const uint32_t *hashes;
+	const uint32_t *order;
+	const uint32_t *chunk_start;
+};
+
+static int
+efd_build_scratch_alloc(struct efd_build_chunk *bc, uint32_t max_rules)
+{
+	bc->key_idx = rte_malloc(NULL, max_rules * sizeof(bc->key_idx[0]), 0);
+	bc->value = rte_malloc(NULL, max_rules * sizeof(bc->value[0]), 0);
+	bc->bin_id = rte_malloc(NULL, max_rules * sizeof(bc->bin_id[0]), 0);
+	bc->is_new = rte_malloc(NULL, max_rules * sizeof(bc->is_new[0]), 0);
+	bc->sorted = rte_malloc(NULL, max_rules * sizeof(bc->sorted[0]), 0);
+
+	if (bc->key_idx == NULL || bc->value == NULL || bc->bin_id == NULL ||
+			bc->is_new == NULL || bc->sorted == NULL)
+		return -ENOMEM;
+	return 0;
+}
+
+static void
+efd_build_scratch_free(struct efd_build_chunk *bc)
+{
+	rte_free(bc->key_idx);
+	rte_free(bc->value);
+	rte_free(bc->bin_id);
+	rte_free(bc->is_new);
+	rte_free(bc->sorted);
+}
+
+/*
+ * Collect existing rules and new keys of the chunk, sorted by bin.
+ * A new key that is already present (in the table or earlier in the input)
+ * only updates the value of the existing rule.
+ */
+static void
+efd_build_collect(struct efd_build_worker *wrk, uint32_t chunk_id)
+{
+	struct efd_build_chunk *bc = &wrk->bc;
+	struct rte_efd_table *table = wrk->table;
+	const struct efd_offline_chunk_rules *chunk =
+			&table->offline_chunks[chunk_id];
+	const struct efd_offline_group_rules *group;
+	uint32_t i, j, k, n, bin_id, key_idx;
+	const void *key;
+
+	n = 0;
+	for (i = 0; i < EFD_CHUNK_NUM_GROUPS; i++) {
+		group = &chunk->group_rules[i];
+		for (j = 0; j < group->num_rules; j++) {
+			bc->key_idx[n] = group->key_idx[j];
+			bc->value[n] = group->value[j];
+			bc->bin_id[n] = group->bin_id[j];
+			bc->is_new[n] = 0;
+			n++;
+		}
+	}
+
+	for (i = wrk->chunk_start[chunk_id];
+			i < wrk->chunk_start[chunk_id + 1]; i++) {
+		key_idx = wrk->order[i];
+		bc->key_idx[n] = key_idx;
+		bc->value[n] = wrk->values[key_idx];
+		bc->bin_id[n] = efd_get_bin_id(table, wrk->hashes[key_idx]);
+		bc->is_new[n] = 1;
+		n++;
+	}
+
+	/* Sort rules by bin, keeping the original order within each bin */
+	memset(bc->bin_size, 0, sizeof(bc->bin_size));
+	for (i = 0; i < n; i++)
+		bc->bin_size[bc->bin_id[i]]++;
+
+	for (i = 0, k = 0; i < EFD_CHUNK_NUM_BINS; i++) {
+		bc->bin_start[i] = k;
+		k += bc->bin_size[i];
+	}
+
+	memset(bc->bin_size, 0, sizeof(bc->bin_size));
+	for (i = 0; i < n; i++) {
+		bin_id = bc->bin_id[i];
+		bc->sorted[bc->bin_start[bin_id] + bc->bin_size[bin_id]++] = i;
+	}
+
+	/* Drop duplicates, the last value for the key wins */
+	for (bin_id = 0; bin_id < EFD_CHUNK_NUM_BINS; bin_id++) {
+		uint32_t *rules = bc->sorted + bc->bin_start[bin_id];
+
+		for (i = 0, k = 0; i < bc->bin_size[bin_id]; i++) {
+			n = rules[i];
+			if (bc->is_new[n] != 0) {
+				key = wrk->keys + (size_t)bc->key_idx[n] *
+						table->key_len;
+				for (j = 0; j < k; j++) {
+					const void *key_stored = (bc->is_new[rules[j]] != 0) ?
+						wrk->keys + (size_t)bc->key_idx[rules[j]] *
+							table->key_len :
+						EFD_KEY(bc->key_idx[rules[j]], table);
+					if (memcmp(key_stored, key,
+							table->key_len) == 0)
+						break;
+				}
+				if (j != k) {
+					bc->value[rules[j]] = bc->value[n];
+					continue;
+				}
+			}
+			rules[k++] = n;
+		}
+		bc->bin_size[bin_id] = k;
+	}
+
+	bc->num_rules = 0;
+	for (bin_id = 0; bin_id < EFD_CHUNK_NUM_BINS; bin_id++)
+		bc->num_rules += bc->bin_size[bin_id];
+}
+
+/*
+ * Assign bins to groups, biggest bins first, each one to the least loaded
+ * of its candidate groups.
+ */
+static int
+efd_build_balance(struct efd_build_chunk *bc)
+{
+	uint32_t i, n, bin_id, group_id, best_size;
+	uint8_t choice, best_choice;
+	uint16_t size_start[EFD_MAX_GROUP_NUM_RULES + 2];
+
+	/* Sort bins by size (counting sort), biggest first */
+	memset(size_start, 0, sizeof(size_start));
+	for (bin_id = 0; bin_id < EFD_CHUNK_NUM_BINS; bin_id++) {
+		if (bc->bin_size[bin_id] > EFD_MAX_GROUP_NUM_RULES)
+			return RTE_EFD_UPDATE_FAILED;
+		size_start[EFD_MAX_GROUP_NUM_RULES - bc->bin_size[bin_id] + 1]++;
+	}
+	for (i = 1; i < RTE_DIM(size_start); i++)
+		size_start[i] += size_start[i - 1];
+	for (bin_id = 0; bin_id < EFD_CHUNK_NUM_BINS; bin_id++) {
+		n = EFD_MAX_GROUP_NUM_RULES - bc->bin_size[bin_id];
+		bc->bin_order[size_start[n]++] = bin_id;
+	}
+
+	memset(bc->group_size, 0, sizeof(bc->group_size));
+	for (i = 0; i < EFD_CHUNK_NUM_BINS; i++) {
+		bin_id = bc->bin_order[i];
+		best_choice = 0;
+		best_size = UINT32_MAX;
+		for (choice = 0; choice < EFD_CHUNK_NUM_BIN_TO_GROUP_SETS;
+				choice++) {
+			group_id = efd_bin_to_group[choice][bin_id];
+			if (bc->group_size[group_id] < best_size) {
+				best_size = bc->group_size[group_id];
+				best_choice = choice;
+			}
+		}
+
+		if (best_size + bc->bin_size[bin_id] > EFD_MAX_GROUP_NUM_RULES)
+			return RTE_EFD_UPDATE_FAILED;
+
+		group_id = efd_bin_to_group[best_choice][bin_id];
+		bc->group_size[group_id] += bc->bin_size[bin_id];
+		bc->bin_choice[bin_id] = best_choice;
+	}
+
+	return 0;
+}
+
+/*
+ * Move rules of the bin into the group in the offline table.
+ */
+static void
+efd_build_fill_bin(const struct efd_build_chunk *bc, uint32_t bin_id,
+		struct efd_offline_group_rules *group)
+{
+	uint32_t i, n;
+	const uint32_t *rules = bc->sorted + bc->bin_start[bin_id];
+
+	for (i = 0; i < bc->bin_size[bin_id]; i++) {
+		n = rules[i];
+		group->key_idx[group->num_rules] = bc->key_idx[n];
+		group->value[group->num_rules] = bc->value[n];
+		group->bin_id[group->num_rules] = bin_id;
+		group->num_rules++;
+	}
+}
+
+/*
+ * Perfect hash search failed for the group, try to move one of its bins
+ * into another candidate group, where hash could be found for both groups.
+ */
+static int
+efd_build_repair(struct rte_efd_table *table, struct efd_build_chunk *bc,
+		struct efd_offline_chunk_rules *chunk,
+		struct efd_online_group_entry *entries, uint32_t group_id)
+{
+	uint32_t i, bin_id, new_group_id, moves;
+	uint8_t choice;
+	struct efd_offline_group_rules *group, *new_group;
+	struct efd_online_group_entry entry, new_entry;
+
+	group = &chunk->group_rules[group_id];
+	moves = 0;
+
+	for (i = 0; i < EFD_CHUNK_NUM_BINS && moves < EFD_BUILD_MAX_BIN_MOVES;
+			i++) {
+		bin_id = bc->bin_order[i];
+		if (bc->bin_size[bin_id] == 0 || efd_bin_to_group
+				[bc->bin_choice[bin_id]][bin_id] != group_id)
+			continue;
+
+		for (choice = 0; choice < EFD_CHUNK_NUM_BIN_TO_GROUP_SETS;
+				choice++) {
+			new_group_id = efd_bin_to_group[choice][bin_id];
+			new_group = &chunk->group_rules[new_group_id];
+			if (new_group_id == group_id ||
+					new_group->num_rules +
+					bc->bin_size[bin_id] >
+					EFD_MAX_GROUP_NUM_RULES)
+				continue;
+
+			moves++;
+			move_groups(bin_id, bc->bin_size[bin_id], new_group,
+					group);
+
+			entry = entries[group_id];
+			new_entry = entries[new_group_id];
+			if (efd_search_hash(table, group, &entry) == 0 &&
+					efd_search_hash(table, new_group,
+						&new_entry) == 0) {
+				entries[group_id] = entry;
+				entries[new_group_id] = new_entry;
+				bc->bin_choice[bin_id] = choice;
+				return 0;
+			}
+
+			revert_groups(group, new_group, bc->bin_size[bin_id]);
+		}
+	}
+
+	return RTE_EFD_UPDATE_FAILED;
+}
+
+/*
+ * Rebuild offline and online parts of the chunk
+ * from existing rules and new keys.
+ */
+static int
+efd_build_chunk(struct efd_build_worker *wrk, uint32_t chunk_id)
+{
+	struct efd_build_chunk *bc = &wrk->bc;
+	struct rte_efd_table *table = wrk->table;
+	struct efd_offline_chunk_rules *chunk =
+			&table->offline_chunks[chunk_id];
+	struct efd_offline_chunk_rules *scratch = &wrk->scratch;
+	struct efd_online_chunk *online =
+			&table->chunks[wrk->socket_id][chunk_id];
+	struct efd_online_group_entry entries[EFD_CHUNK_NUM_GROUPS];
+	uint8_t bin_choice_list[RTE_DIM(online->bin_choice_list)];
+	void *slots[EFD_TARGET_CHUNK_MAX_NUM_RULES];
+	uint32_t i, n, bin_id, group_id, num_new, num_rules;
+	int ret;
+
+	efd_build_collect(wrk, chunk_id);
+
+	ret = efd_build_balance(bc);
+	if (ret != 0) {
+		RTE_LOG(ERR, EFD, "Too many keys for chunk %u\n", chunk_id);
+		return ret;
+	}
+
+	/* Allocate key slots for new keys */
+	num_new = 0;
+	for (bin_id = 0; bin_id < EFD_CHUNK_NUM_BINS; bin_id++) {
+		for (i = 0; i < bc->bin_size[bin_id]; i++) {
+			n = bc->sorted[bc->bin_start[bin_id] + i];
+			num_new += bc->is_new[n];
+		}
+	}
+
+	if (num_new != 0 && rte_ring_mc_dequeue_bulk(table->free_slots,
+			slots, num_new, NULL) == 0) {
+		RTE_LOG(ERR, EFD, "No free key slots for chunk %u\n",
+			chunk_id);
+		return RTE_EFD_UPDATE_FAILED;
+	}
+
+	num_new = 0;
+	for (bin_id = 0; bin_id < EFD_CHUNK_NUM_BINS; bin_id++) {
+		for (i = 0; i < bc->bin_size[bin_id]; i++) {
+			n = bc->sorted[bc->bin_start[bin_id] + i];
+			if (bc->is_new[n] == 0)
+				continue;
+			rte_memcpy(EFD_KEY((uintptr_t)slots[num_new], table),
+				wrk->keys + (size_t)bc->key_idx[n] *
+					table->key_len,
+				table->key_len);
+			bc->key_idx[n] = (uintptr_t)slots[num_new];
+			bc->is_new[n] = 0;
+			num_new++;
+		}
+	}
+
+	/*
+	 * Refill the offline groups into a scratch copy, so that a failure
+	 * leaves the chunk as it was and later rebuilds start from the
+	 * rules the online table was built from.
+	 */
+	for (group_id = 0; group_id < EFD_CHUNK_NUM_GROUPS; group_id++)
+		scratch->group_rules[group_id].num_rules = 0;
+
+	for (bin_id = 0; bin_id < EFD_CHUNK_NUM_BINS; bin_id++) {
+		group_id = efd_bin_to_group[bc->bin_choice[bin_id]][bin_id];
+		efd_build_fill_bin(bc, bin_id, &scratch->group_rules[group_id]);
+	}
+	scratch->num_rules = bc->num_rules;
+
+	/* Compute perfect hash for each group */
+	memcpy(entries, online->groups, sizeof(entries));
+	for (group_id = 0; group_id < EFD_CHUNK_NUM_GROUPS; group_id++) {
+		if (efd_search_hash(table, &scratch->group_rules[group_id],
+				&entries[group_id]) == 0)
+			continue;
+
+		ret = efd_build_repair(table, bc, scratch, entries, group_id);
+		if (ret != 0) {
+			RTE_LOG(ERR, EFD, "Failed to find perfect hash for "
+				"chunk %u group %u\n", chunk_id, group_id);
+			/* Give back the key slots taken for new keys */
+			if (num_new != 0)
+				rte_ring_mp_enqueue_bulk(table->free_slots,
+						slots, num_new, NULL);
+			return ret;
+		}
+	}
+
+	/* Commit the offline groups */
+	num_rules = 0;
+	for (group_id = 0; group_id < EFD_CHUNK_NUM_GROUPS; group_id++)
+		num_rules += chunk->group_rules[group_id].num_rules;
+	wrk->new_rules += bc->num_rules - num_rules;
+	memcpy(chunk, scratch, sizeof(*chunk));
+
+	memset(bin_choice_list, 0, sizeof(bin_choice_list));
+	for (bin_id = 0; bin_id < EFD_CHUNK_NUM_BINS; bin_id++)
+		bin_choice_list[bin_id / EFD_CHUNK_NUM_BIN_TO_GROUP_SETS] |=
+			bc->bin_choice[bin_id] << ((bin_id & 0x3) * 2);
+
+	/* Update the online table across all sockets */
+	for (i = 0; i < RTE_MAX_NUMA_NODES; i++) {
+		if (table->chunks[i] != NULL) {
+			memcpy(table->chunks[i][chunk_id].groups, entries,
+					sizeof(entries));
+			memcpy(table->chunks[i][chunk_id].bin_choice_list,
+					bin_choice_list,
+					sizeof(bin_choice_list));
+		}
+	}
+
+	return 0;
+}
+
+static void *
+efd_build_worker_main(void *arg)
+{
+	struct efd_build_worker *wrk = arg;
+	uint32_t chunk_id;
+
+	for (chunk_id = wrk->first_chunk;
+			chunk_id < wrk->table->num_chunks && wrk->status == 0;
+			chunk_id += wrk->chunk_step) {
+		/* Skip chunks with no new keys */
+		if (wrk->chunk_start[chunk_id] != wrk->chunk_start[chunk_id + 1])
+			wrk->status = efd_build_chunk(wrk, chunk_id);
+	}
+
+	return NULL;
+}
+
+int
+rte_efd_build(struct rte_efd_table *table, unsigned int socket_id,
+		uint32_t num_keys, const void *keys, const efd_value_t *values,
+		unsigned int num_threads)
+{
+	struct efd_build_worker *wrk;
+	uint32_t *hashes, *order, *chunk_start;
+	uint32_t i, chunk_id, max_new;
+	int ret;
+
+	if (table == NULL || socket_id >= RTE_MAX_NUMA_NODES ||
+			table->chunks[socket_id] == NULL ||
+			(num_keys != 0 && (keys == NULL || values == NULL)) ||
+			num_threads == 0)
+		return -EINVAL;
+
+	/* Table restored from a snapshot can't be updated */
+	if (table->offline_chunks == NULL)
+		return -ENOTSUP;
+
+	if (num_keys == 0)
+		return 0;
+
+	num_threads = RTE_MIN(num_threads, table->num_chunks);
+
+	hashes = rte_malloc(NULL, num_keys * sizeof(hashes[0]), 0);
+	order = rte_malloc(NULL, num_keys * sizeof(order[0]), 0);
+	chunk_start = rte_zmalloc(NULL,
+			(table->num_chunks + 1) * sizeof(chunk_start[0]), 0);
+	wrk = rte_zmalloc(NULL, num_threads * sizeof(wrk[0]), 0);
+	if (hashes == NULL || order == NULL || chunk_start == NULL ||
+			wrk == NULL) {
+		ret = -ENOMEM;
+		goto exit;
+	}
+
+	/* Distribute keys among chunks */
+	for (i = 0; i < num_keys; i++) {
+		hashes[i] = EFD_HASH((const uint8_t *)keys +
+				(size_t)i * table->key_len, table);
+		chunk_start[efd_get_chunk_id(table, hashes[i]) + 1]++;
+	}
+
+	max_new = 0;
+	for (chunk_id = 0; chunk_id < table->num_chunks; chunk_id++) {
+		max_new = RTE_MAX(max_new, chunk_start[chunk_id + 1]);
+		chunk_start[chunk_id + 1] += chunk_start[chunk_id];
+	}
+
+	for (i = 0; i < num_keys; i++) {
+		chunk_id = efd_get_chunk_id(table, hashes[i]);
+		order[chunk_start[chunk_id]++] = i;
+	}
+
+	/* Shift start positions back after the fill */
+	for (chunk_id = table->num_chunks; chunk_id != 0; chunk_id--)
+		chunk_start[chunk_id] = chunk_start[chunk_id - 1];
+	chunk_start[0] = 0;
+
+	ret = 0;
+	for (i = 0; i < num_threads && ret == 0; i++) {
+		wrk[i].table = table;
+		wrk[i].socket_id = socket_id;
+		wrk[i].keys = keys;
+		wrk[i].values = values;
+		wrk[i].hashes = hashes;
+		wrk[i].order = order;
+		wrk[i].chunk_start = chunk_start;
+		wrk[i].first_chunk = i;
+		wrk[i].chunk_step = num_threads;
+		ret = efd_build_scratch_alloc(&wrk[i].bc,
+				EFD_TARGET_CHUNK_MAX_NUM_RULES + max_new);
+	}
+	if (ret != 0)
+		goto exit;
+
+	/* Run the build, current thread takes the first share of chunks */
+	for (i = 1; i < num_threads; i++)
+		wrk[i].started = (pthread_create(&wrk[i].tid, NULL,
+				efd_build_worker_main, &wrk[i]) == 0);
+
+	efd_build_worker_main(&wrk[0]);
+
+	for (i = 1; i < num_threads; i++) {
+		if (wrk[i].started)
+			pthread_join(wrk[i].tid, NULL);
+		else
+			efd_build_worker_main(&wrk[i]);
+	}
+
+	for (i = 0; i < num_threads; i++) {
+		table->num_rules += wrk[i].new_rules;
+		if (ret == 0)
+			ret = wrk[i].status;
+	}
+
+exit:
+	if (wrk != NULL) {
+		for (i = 0; i < num_threads; i++)
+			efd_build_scratch_free(&wrk[i].bc);
+	}
+	rte_free(wrk);
+	rte_free(chunk_start);
+	rte_free(order);
+	rte_free(hashes);
+	return ret;
+}
+
 int
 rte_efd_delete(struct rte_efd_table * const table, const unsigned int socket_id,
 		const void *key, efd_value_t * const prev_value)
@@ -1197,6 +1774,9 @@ rte_efd_delete(struct rte_efd_table * const table, const unsigned int socket_id,
 	uint32_t chunk_id, bin_id;
 	uint8_t not_found = 1;
 
+	if (unlikely(table->offline_chunks == NULL))
+		return not_found;
+
 	efd_compute_ids(table, key, &chunk_id, &bin_id);
 
 	struct efd_offline_chunk_rules * const chunk =
@@ -1362,3 +1942,286 @@ void rte_efd_lookup_bulk(const struct rte_efd_table * const table,
 				table->lookup_fn);
 	}
 }
+
+/*
+ * Snapshot of the online table: header followed by the chunks array.
+ */
+#define EFD_SNAPSHOT_MAGIC	0x31444645 /* "EFD1" */
+#define EFD_SNAPSHOT_VERSION	1
+
+struct efd_snapshot_hdr {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t value_bits;
+	/**< RTE_EFD_VALUE_NUM_BITS the table was built with */
+	uint32_t chunk_size;
+	/**< Size of the online chunk structure */
+	uint32_t key_len;
+	uint32_t num_chunks;
+	uint32_t num_rules;
+	uint32_t max_num_rules;
+	uint32_t data_crc;
+	/**< Checksum of the chunks array */
+	uint32_t reserved;
+};
+
+static uint32_t
+efd_snapshot_crc(const struct efd_online_chunk *chunks, uint32_t num_chunks)
+{
+	uint32_t i, crc;
+
+	crc = 0;
+	for (i = 0; i < num_chunks; i++)
+		crc = rte_hash_crc(&chunks[i], sizeof(chunks[i]), crc);
+	return crc;
+}
+
+static void
+efd_snapshot_fill_hdr(const struct rte_efd_table *table,
+		const struct efd_online_chunk *chunks,
+		struct efd_snapshot_hdr *hdr)
+{
+	memset(hdr, 0, sizeof(*hdr));
+	hdr->magic = EFD_SNAPSHOT_MAGIC;
+	hdr->version = EFD_SNAPSHOT_VERSION;
+	hdr->value_bits = RTE_EFD_VALUE_NUM_BITS;
+	hdr->chunk_size = sizeof(struct efd_online_chunk);
+	hdr->key_len = table->key_len;
+	hdr->num_chunks = table->num_chunks;
+	hdr->num_rules = table->num_rules;
+	hdr->max_num_rules = table->max_num_rules;
+	hdr->data_crc = efd_snapshot_crc(chunks, table->num_chunks);
+}
+
+size_t
+rte_efd_snapshot_size(const struct rte_efd_table *table)
+{
+	if (table == NULL)
+		return 0;
+
+	return sizeof(struct efd_snapshot_hdr) +
+		(size_t)table->num_chunks * sizeof(struct efd_online_chunk);
+}
+
+int
+rte_efd_snapshot(const struct rte_efd_table *table, unsigned int socket_id,
+		void *buf, size_t size)
+{
+	struct efd_snapshot_hdr hdr;
+	const struct efd_online_chunk *chunks;
+
+	if (table == NULL || buf == NULL || socket_id >= RTE_MAX_NUMA_NODES ||
+			table->chunks[socket_id] == NULL)
+		return -EINVAL;
+
+	if (size < rte_efd_snapshot_size(table))
+		return -ENOSPC;
+
+	chunks = table->chunks[socket_id];
+	efd_snapshot_fill_hdr(table, chunks, &hdr);
+
+	memcpy(buf, &hdr, sizeof(hdr));
+	memcpy(RTE_PTR_ADD(buf, sizeof(hdr)), chunks,
+		(size_t)table->num_chunks * sizeof(chunks[0]));
+	return 0;
+}
+
+static int
+efd_write_full(int fd, const void *buf, size_t size)
+{
+	ssize_t n;
+
+	while (size != 0) {
+		n = write(fd, buf, size);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		buf = RTE_PTR_ADD(buf, n);
+		size -= n;
+	}
+	return 0;
+}
+
+int
+rte_efd_snapshot_save(const struct rte_efd_table *table,
+		unsigned int socket_id, const char *path)
+{
+	struct efd_snapshot_hdr hdr;
+	const struct efd_online_chunk *chunks;
+	int fd, ret;
+
+	if (table == NULL || path == NULL || socket_id >= RTE_MAX_NUMA_NODES ||
+			table->chunks[socket_id] == NULL)
+		return -EINVAL;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		ret = -errno;
+		RTE_LOG(ERR, EFD, "Cannot open %s: %s\n", path,
+			strerror(errno));
+		return ret;
+	}
+
+	chunks = table->chunks[socket_id];
+	efd_snapshot_fill_hdr(table, chunks, &hdr);
+
+	ret = efd_write_full(fd, &hdr, sizeof(hdr));
+	if (ret == 0)
+		ret = efd_write_full(fd, chunks,
+			(size_t)table->num_chunks * sizeof(chunks[0]));
+	if (ret != 0)
+		RTE_LOG(ERR, EFD, "Cannot write %s: %s\n", path,
+			strerror(-ret));
+
+	close(fd);
+	return ret;
+}
+
+struct rte_efd_table *
+rte_efd_restore(const char *name, const void *buf, size_t size,
+		uint8_t online_cpu_socket_bitmask)
+{
+	const struct efd_snapshot_hdr *hdr = buf;
+	const struct efd_online_chunk *chunks;
+	struct rte_efd_table *table = NULL;
+	struct rte_efd_list *efd_list;
+	struct rte_tailq_entry *te;
+	uint8_t socket_id;
+
+	if (name == NULL || buf == NULL || online_cpu_socket_bitmask == 0 ||
+			size < sizeof(*hdr)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	if (hdr->magic != EFD_SNAPSHOT_MAGIC ||
+			hdr->version != EFD_SNAPSHOT_VERSION ||
+			hdr->value_bits != RTE_EFD_VALUE_NUM_BITS ||
+			hdr->chunk_size != sizeof(struct efd_online_chunk) ||
+			!rte_is_power_of_2(hdr->num_chunks) ||
+			size < sizeof(*hdr) + (size_t)hdr->num_chunks *
+				sizeof(struct efd_online_chunk)) {
+		RTE_LOG(ERR, EFD, "Invalid or incompatible EFD snapshot\n");
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	chunks = RTE_PTR_ADD(buf, sizeof(*hdr));
+	if (efd_snapshot_crc(chunks, hdr->num_chunks) != hdr->data_crc) {
+		RTE_LOG(ERR, EFD, "EFD snapshot checksum mismatch\n");
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	efd_list = RTE_TAILQ_CAST(rte_efd_tailq.head, rte_efd_list);
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	TAILQ_FOREACH(te, efd_list, next)
+	{
+		table = (struct rte_efd_table *) te->data;
+		if (strncmp(name, table->name, RTE_EFD_NAMESIZE) == 0)
+			break;
+	}
+
+	table = NULL;
+	if (te != NULL) {
+		rte_errno = EEXIST;
+		te = NULL;
+		goto error_unlock_exit;
+	}
+
+	te = rte_zmalloc("EFD_TAILQ_ENTRY", sizeof(*te), 0);
+	table = rte_zmalloc(NULL, sizeof(*table), RTE_CACHE_LINE_SIZE);
+	if (te == NULL || table == NULL) {
+		RTE_LOG(ERR, EFD, "Allocating EFD table management structure "
+				"failed\n");
+		rte_errno = ENOMEM;
+		goto error_unlock_exit;
+	}
+
+	snprintf(table->name, sizeof(table->name), "%s", name);
+	table->key_len = hdr->key_len;
+	table->max_num_rules = hdr->max_num_rules;
+	table->num_rules = hdr->num_rules;
+	table->num_chunks = hdr->num_chunks;
+	table->num_chunks_shift = rte_bsf32(hdr->num_chunks);
+
+	if (efd_alloc_online(table, online_cpu_socket_bitmask) != 0) {
+		rte_errno = ENOMEM;
+		goto error_unlock_exit;
+	}
+
+	for (socket_id = 0; socket_id < RTE_MAX_NUMA_NODES; socket_id++) {
+		if (table->chunks[socket_id] != NULL)
+			memcpy(table->chunks[socket_id], chunks,
+				(size_t)table->num_chunks * sizeof(chunks[0]));
+	}
+
+	te->data = (void *) table;
+	TAILQ_INSERT_TAIL(efd_list, te, next);
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	RTE_LOG(DEBUG, EFD, "Restored EFD table %s with %u chunks "
+			"and %u entries\n", name, table->num_chunks,
+			table->num_rules);
+	return table;
+
+error_unlock_exit:
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+	rte_free(te);
+	rte_efd_free(table);
+	return NULL;
+}
+
+struct rte_efd_table *
+rte_efd_restore_file(const char *name, const char *path,
+		uint8_t online_cpu_socket_bitmask)
+{
+	struct rte_efd_table *table;
+	struct stat st;
+	void *buf;
+	int fd;
+
+	if (path == NULL) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		rte_errno = errno;
+		RTE_LOG(ERR, EFD, "Cannot open %s: %s\n", path,
+			strerror(errno));
+		return NULL;
+	}
+
+	if (fstat(fd, &st) != 0) {
+		rte_errno = errno;
+		close(fd);
+		return NULL;
+	}
+
+	if (st.st_size == 0) {
+		rte_errno = EINVAL;
+		close(fd);
+		return NULL;
+	}
+
+	buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (buf == MAP_FAILED) {
+		rte_errno = errno;
+		RTE_LOG(ERR, EFD, "Cannot map %s: %s\n", path,
+			strerror(errno));
+		return NULL;
+	}
+
+	table = rte_efd_restore(name, buf, st.st_size,
+			online_cpu_socket_bitmask);
+
+	munmap(buf, st.st_size);
+	return table;
+}
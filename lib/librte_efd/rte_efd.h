@@ -41,6 +41,7 @@
  */
 
 #include <stdint.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -229,6 +230,48 @@ int
 rte_efd_update(struct rte_efd_table *table, unsigned int socket_id,
 	const void *key, efd_value_t value);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Inserts or updates many key/value pairs at once.
+ * Instead of recomputing the perfect hash of a group for every key,
+ * each chunk touched by the new keys is rebuilt once: its bins are
+ * rebalanced among groups and a perfect hash is computed per group.
+ * Chunks are processed in parallel by up to num_threads threads
+ * (the calling one included).
+ * Existing entries of the table are preserved; if a key is present
+ * several times, the last value wins.
+ * This operation is not multi-thread safe, and lookups on the
+ * table should not be performed while it is in progress.
+ *
+ * @param table
+ *   EFD table to reference
+ * @param socket_id
+ *   Socket ID to use to lookup existing values (ideally caller's socket id)
+ * @param num_keys
+ *   Number of keys to insert
+ * @param keys
+ *   Array of num_keys keys, each of the table key length, stored contiguously
+ * @param values
+ *   Array of num_keys values to associate with the keys
+ * @param num_threads
+ *   Maximum number of threads to use for the build
+ *
+ * @return
+ *   0 - success
+ *   RTE_EFD_UPDATE_FAILED
+ *     Either the EFD failed to find a suitable perfect hash or a chunk was full
+ *     This is a fatal error, and the table is now in an indeterminate state
+ *   -EINVAL - invalid parameters
+ *   -ENOTSUP - table was restored from a snapshot and is read-only
+ *   -ENOMEM - not enough memory for the build
+ */
+int
+rte_efd_build(struct rte_efd_table *table, unsigned int socket_id,
+	uint32_t num_keys, const void *keys, const efd_value_t *values,
+	unsigned int num_threads);
+
 /**
  * Removes any value currently associated with the specified key from the table
  * This operation is not multi-thread safe
@@ -301,6 +344,123 @@ rte_efd_lookup_bulk(const struct rte_efd_table *table, unsigned int socket_id,
 		int num_keys, const void **key_list,
 		efd_value_t *value_list);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Returns the size of the buffer needed to store a snapshot of the
+ * online (lookup) part of the table.
+ *
+ * @param table
+ *   EFD table to reference
+ *
+ * @return
+ *   Snapshot size in bytes, or 0 if table is NULL
+ */
+size_t
+rte_efd_snapshot_size(const struct rte_efd_table *table);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Stores a snapshot of the online (lookup) part of the table into a
+ * memory region. Keys and the offline part of the table are not saved,
+ * so a table restored from the snapshot can only be used for lookups.
+ * The snapshot can be restored only by a binary built with the same
+ * RTE_EFD_VALUE_NUM_BITS for the same CPU architecture.
+ *
+ * @param table
+ *   EFD table to reference
+ * @param socket_id
+ *   Socket ID of the online table copy to save
+ * @param buf
+ *   Memory region to store the snapshot into
+ * @param size
+ *   Size of the memory region, at least rte_efd_snapshot_size() bytes
+ *
+ * @return
+ *   0 - success
+ *   -EINVAL - invalid parameters
+ *   -ENOSPC - memory region is too small
+ */
+int
+rte_efd_snapshot(const struct rte_efd_table *table, unsigned int socket_id,
+	void *buf, size_t size);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Stores a snapshot of the online (lookup) part of the table into a file.
+ * See rte_efd_snapshot() for details.
+ *
+ * @param table
+ *   EFD table to reference
+ * @param socket_id
+ *   Socket ID of the online table copy to save
+ * @param path
+ *   Path of the file to create or overwrite
+ *
+ * @return
+ *   0 on success, negative errno value otherwise
+ */
+int
+rte_efd_snapshot_save(const struct rte_efd_table *table,
+	unsigned int socket_id, const char *path);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Creates a lookup-only EFD table from a snapshot stored in a memory
+ * region, e.g. a mapped file. The snapshot is copied into per-socket
+ * online tables, so the memory region can be released afterwards.
+ * rte_efd_update(), rte_efd_build() and rte_efd_delete() fail
+ * on such a table.
+ *
+ * @param name
+ *   EFD table name
+ * @param buf
+ *   Memory region containing the snapshot
+ * @param size
+ *   Size of the memory region
+ * @param online_cpu_socket_bitmask
+ *   Bitmask specifying which sockets should get a copy of the online table.
+ *   LSB = socket 0, etc.
+ *
+ * @return
+ *   EFD table, or NULL on error with rte_errno set appropriately.
+ *   Possible rte_errno values include:
+ *    - EINVAL - invalid parameters, or corrupted/incompatible snapshot
+ *    - EEXIST - a table with the same name already exists
+ *    - ENOMEM - not enough memory for the table
+ */
+struct rte_efd_table *
+rte_efd_restore(const char *name, const void *buf, size_t size,
+	uint8_t online_cpu_socket_bitmask);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Creates a lookup-only EFD table from a snapshot file created with
+ * rte_efd_snapshot_save(). See rte_efd_restore() for details.
+ *
+ * @param name
+ *   EFD table name
+ * @param path
+ *   Path of the snapshot file
+ * @param online_cpu_socket_bitmask
+ *   Bitmask specifying which sockets should get a copy of the online table.
+ *
+ * @return
+ *   EFD table, or NULL on error with rte_errno set appropriately
+ */
+struct rte_efd_table *
+rte_efd_restore_file(const char *name, const char *path,
+	uint8_t online_cpu_socket_bitmask);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,904 @@
+/*
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cryptodev.h>
+#include <rte_cryptodev_pmd.h>
+#include <rte_errno.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_memzone.h>
+#include <rte_service_component.h>
+#include <rte_spinlock.h>
+
+#include "rte_eventdev.h"
+#include "rte_eventdev_pmd.h"
+#include "rte_event_crypto_adapter.h"
+
+#define BATCH_SIZE			32
+#define DEFAULT_MAX_NB			128
+#define CRYPTO_ADAPTER_OPS_BUFFER_SZ	(2 * BATCH_SIZE)
+#define CRYPTO_ADAPTER_EVENT_BUFFER_SZ	(4 * BATCH_SIZE)
+
+#define CRYPTO_ADAPTER_SERVICE_NAME_LEN	32
+#define CRYPTO_ADAPTER_MEM_NAME_LEN	32
+
+/* Crypto operations waiting to be enqueued to a queue pair */
+struct crypto_ops_buffer {
+	/* Count of operations in this buffer */
+	uint16_t count;
+	/* Array of operations in this buffer */
+	struct rte_crypto_op *op_buffer[CRYPTO_ADAPTER_OPS_BUFFER_SZ];
+};
+
+/* Per queue pair */
+struct crypto_queue_pair_info {
+	/* Set if the queue pair is added to the adapter */
+	int qp_enabled;
+	/* Operations to be submitted, in OP_FORWARD mode */
+	struct crypto_ops_buffer buf;
+};
+
+/* Per cryptodev */
+struct crypto_device_info {
+	/* Array of queue pair info, NULL if no queue pair is added */
+	struct crypto_queue_pair_info *qpairs;
+	/* Size of the qpairs array */
+	uint16_t nb_qpairs;
+	/* Count of queue pairs added to the adapter */
+	uint16_t nb_dev_qpairs;
+};
+
+/*
+ * There is an instance of this struct per queue pair added to the adapter
+ */
+struct crypto_qp_poll_entry {
+	/* Cryptodev to poll */
+	uint8_t cdev_id;
+	/* Queue pair to poll */
+	uint16_t qp_id;
+};
+
+/* Events of completed operations waiting to be enqueued */
+struct crypto_event_buffer {
+	/* Count of events in this buffer */
+	uint16_t count;
+	/* Array of events in this buffer */
+	struct rte_event events[CRYPTO_ADAPTER_EVENT_BUFFER_SZ];
+};
+
+struct rte_event_crypto_adapter {
+	/* Event device identifier */
+	uint8_t eventdev_id;
+	/* Event port identifier */
+	uint8_t event_port_id;
+	/* Adapter mode */
+	enum rte_event_crypto_adapter_mode mode;
+	/* Lock to serialize config updates with service function */
+	rte_spinlock_t lock;
+	/* Max crypto operations processed in any service function call */
+	uint32_t max_nb;
+	/* Per cryptodev structure, indexed by cryptodev identifier */
+	struct crypto_device_info *cdevs;
+	/* Queue pairs that need to be polled */
+	struct crypto_qp_poll_entry *qp_poll;
+	/* Size of the qp_poll array */
+	uint16_t nb_qp_polled;
+	/* Next entry in qp_poll[] to begin polling */
+	uint16_t qp_poll_pos;
+	/* Event burst buffer */
+	struct crypto_event_buffer event_buffer;
+	/* Per adapter stats */
+	struct rte_event_crypto_adapter_stats stats;
+	/* Configuration callback argument */
+	void *conf_arg;
+	/* Set if default_cb is being used */
+	int default_cb_arg;
+	/* Total count of queue pairs in adapter */
+	uint32_t nb_qps;
+	/* Memory allocation name */
+	char mem_name[CRYPTO_ADAPTER_MEM_NAME_LEN];
+	/* Socket identifier cached from eventdev */
+	int socket_id;
+	/* Per adapter EAL service */
+	uint32_t service_id;
+} __rte_cache_aligned;
+
+static struct rte_event_crypto_adapter **event_crypto_adapter;
+
+static inline int
+valid_id(uint8_t id)
+{
+	return id < RTE_EVENT_CRYPTO_ADAPTER_MAX_INSTANCE;
+}
+
+#define RTE_EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, retval) do { \
+	if (!valid_id(id)) { \
+		RTE_EDEV_LOG_ERR("Invalid crypto adapter id = %d\n", id); \
+		return retval; \
+	} \
+} while (0)
+
+static inline struct rte_event_crypto_adapter *
+id_to_crypto_adapter(uint8_t id)
+{
+	return event_crypto_adapter ?
+		event_crypto_adapter[id] : NULL;
+}
+
+static inline union rte_event_crypto_metadata *
+eca_op_metadata(struct rte_crypto_op *op)
+{
+	if (unlikely(op == NULL || op->private_data_offset == 0))
+		return NULL;
+
+	return (union rte_event_crypto_metadata *)
+		((uint8_t *)op + op->private_data_offset);
+}
+
+static void
+eca_op_drop(struct rte_event_crypto_adapter *adapter,
+	struct rte_crypto_op *op)
+{
+	adapter->stats.op_drop_count++;
+	if (op == NULL)
+		return;
+	if (op->type == RTE_CRYPTO_OP_TYPE_SYMMETRIC)
+		rte_pktmbuf_free(op->sym->m_src);
+	rte_crypto_op_free(op);
+}
+
+/* Enqueue buffered events to event device */
+static inline uint16_t
+eca_flush_event_buffer(struct rte_event_crypto_adapter *adapter)
+{
+	struct crypto_event_buffer *buf = &adapter->event_buffer;
+	struct rte_event_crypto_adapter_stats *stats = &adapter->stats;
+
+	uint16_t n = rte_event_enqueue_new_burst(adapter->eventdev_id,
+					adapter->event_port_id,
+					buf->events,
+					buf->count);
+	if (n != buf->count) {
+		memmove(buf->events,
+			&buf->events[n],
+			(buf->count - n) * sizeof(struct rte_event));
+		stats->event_enq_retry++;
+	}
+
+	buf->count -= n;
+	stats->event_enq_count += n;
+
+	return n;
+}
+
+/* Submit the buffered operations of a queue pair to the cryptodev */
+static inline void
+eca_flush_ops_buffer(struct rte_event_crypto_adapter *adapter,
+	uint8_t cdev_id, uint16_t qp_id, struct crypto_ops_buffer *buf)
+{
+	struct rte_event_crypto_adapter_stats *stats = &adapter->stats;
+	uint16_t n;
+
+	n = rte_cryptodev_enqueue_burst(cdev_id, qp_id, buf->op_buffer,
+					buf->count);
+	if (n != buf->count) {
+		memmove(buf->op_buffer,
+			&buf->op_buffer[n],
+			(buf->count - n) * sizeof(buf->op_buffer[0]));
+		stats->crypto_enq_retry++;
+	}
+
+	buf->count -= n;
+	stats->crypto_enq_count += n;
+}
+
+/*
+ * Submit the buffered operations of all the queue pairs. Returns 0 if a
+ * buffer doesn't have room for a burst of operations any more, i.e. the
+ * adapter must not dequeue events until the cryptodev has made progress.
+ */
+static int
+eca_flush_ops_buffers(struct rte_event_crypto_adapter *adapter)
+{
+	struct crypto_queue_pair_info *qp_info;
+	struct crypto_qp_poll_entry *e;
+	int room = 1;
+	uint16_t i;
+
+	for (i = 0; i < adapter->nb_qp_polled; i++) {
+		e = &adapter->qp_poll[i];
+		qp_info = &adapter->cdevs[e->cdev_id].qpairs[e->qp_id];
+		if (qp_info->buf.count == 0)
+			continue;
+		eca_flush_ops_buffer(adapter, e->cdev_id, e->qp_id,
+				&qp_info->buf);
+		if (qp_info->buf.count > CRYPTO_ADAPTER_OPS_BUFFER_SZ -
+				BATCH_SIZE)
+			room = 0;
+	}
+
+	return room;
+}
+
+/*
+ * Buffer the crypto operations of events dequeued from the adapter port,
+ * per queue pair. The flow identifier of the event is saved in the
+ * response metadata so that the completion event keeps it.
+ */
+static void
+eca_enq_events(struct rte_event_crypto_adapter *adapter,
+	struct rte_event *ev, uint16_t num)
+{
+	union rte_event_crypto_metadata *m;
+	struct crypto_device_info *dev_info;
+	struct crypto_queue_pair_info *qp_info;
+	struct crypto_ops_buffer *buf;
+	struct rte_crypto_op *op;
+	uint16_t cdev_id, qp_id;
+	uint16_t i;
+
+	for (i = 0; i < num; i++) {
+		op = ev[i].event_ptr;
+		m = eca_op_metadata(op);
+		if (unlikely(m == NULL)) {
+			eca_op_drop(adapter, op);
+			continue;
+		}
+
+		cdev_id = m->request_info.cdev_id;
+		qp_id = m->request_info.queue_pair_id;
+		dev_info = cdev_id < RTE_CRYPTO_MAX_DEVS ?
+			&adapter->cdevs[cdev_id] : NULL;
+		if (unlikely(dev_info == NULL || qp_id >= dev_info->nb_qpairs ||
+				!dev_info->qpairs[qp_id].qp_enabled)) {
+			eca_op_drop(adapter, op);
+			continue;
+		}
+
+		m->response_info.flow_id = ev[i].flow_id;
+		qp_info = &dev_info->qpairs[qp_id];
+		buf = &qp_info->buf;
+		buf->op_buffer[buf->count++] = op;
+		if (buf->count >= BATCH_SIZE)
+			eca_flush_ops_buffer(adapter, cdev_id, qp_id, buf);
+	}
+}
+
+/*
+ * Dequeues crypto operation events from the adapter port and submits the
+ * operations to the cryptodev queue pairs.
+ *
+ * The operations of a burst of events are buffered per queue pair and each
+ * buffer is submitted as a burst. A queue pair buffer has room for two
+ * bursts: if the cryptodev doesn't accept the operations of a queue pair,
+ * the adapter stops dequeuing events, which back pressures the event
+ * device.
+ */
+static unsigned int
+eca_enq_run(struct rte_event_crypto_adapter *adapter, unsigned int max_enq)
+{
+	struct rte_event_crypto_adapter_stats *stats = &adapter->stats;
+	struct rte_event ev[BATCH_SIZE];
+	unsigned int nb_enq = 0;
+	uint16_t n;
+
+	while (nb_enq < max_enq) {
+		if (eca_flush_ops_buffers(adapter) == 0)
+			return nb_enq;
+
+		stats->event_poll_count++;
+		n = rte_event_dequeue_burst(adapter->eventdev_id,
+					adapter->event_port_id, ev,
+					BATCH_SIZE, 0);
+		if (n == 0)
+			break;
+
+		stats->event_deq_count += n;
+		eca_enq_events(adapter, ev, n);
+		nb_enq += n;
+	}
+
+	eca_flush_ops_buffers(adapter);
+	return nb_enq;
+}
+
+static inline void
+eca_fill_event_buffer(struct rte_event_crypto_adapter *adapter,
+	struct rte_crypto_op **ops, uint16_t num)
+{
+	struct crypto_event_buffer *buf = &adapter->event_buffer;
+	union rte_event_crypto_metadata *m;
+	struct rte_event *ev;
+	uint16_t i;
+
+	for (i = 0; i < num; i++) {
+		m = eca_op_metadata(ops[i]);
+		if (unlikely(m == NULL)) {
+			eca_op_drop(adapter, ops[i]);
+			continue;
+		}
+
+		ev = &buf->events[buf->count++];
+		ev->event = m->response_info.event;
+		ev->op = RTE_EVENT_OP_NEW;
+		ev->event_type = RTE_EVENT_TYPE_CRYPTODEV;
+		ev->event_ptr = ops[i];
+	}
+}
+
+/*
+ * Dequeues completed operations from the queue pairs added to the adapter,
+ * in round robin, and enqueues them to the event device. As for the Rx
+ * adapter, a queue pair is not polled if the event buffer doesn't have room
+ * for a burst of completions.
+ */
+static unsigned int
+eca_deq_run(struct rte_event_crypto_adapter *adapter, unsigned int max_deq)
+{
+	struct rte_event_crypto_adapter_stats *stats = &adapter->stats;
+	struct crypto_event_buffer *buf = &adapter->event_buffer;
+	struct rte_crypto_op *ops[BATCH_SIZE];
+	struct crypto_qp_poll_entry *e;
+	unsigned int nb_deq = 0;
+	uint16_t pos, i, n;
+
+	pos = adapter->qp_poll_pos;
+	for (i = 0; i < adapter->nb_qp_polled; i++) {
+		if (buf->count >= BATCH_SIZE)
+			eca_flush_event_buffer(adapter);
+		if (BATCH_SIZE > (CRYPTO_ADAPTER_EVENT_BUFFER_SZ - buf->count))
+			break;
+
+		e = &adapter->qp_poll[pos];
+		if (++pos == adapter->nb_qp_polled)
+			pos = 0;
+
+		n = rte_cryptodev_dequeue_burst(e->cdev_id, e->qp_id, ops,
+						BATCH_SIZE);
+		if (n == 0)
+			continue;
+
+		stats->crypto_deq_count += n;
+		eca_fill_event_buffer(adapter, ops, n);
+		nb_deq += n;
+		if (nb_deq > max_deq)
+			break;
+	}
+	adapter->qp_poll_pos = pos;
+
+	if (buf->count)
+		eca_flush_event_buffer(adapter);
+
+	return nb_deq;
+}
+
+static int
+event_crypto_adapter_service_func(void *args)
+{
+	struct rte_event_crypto_adapter *adapter = args;
+	unsigned int nb = 0, n;
+
+	if (rte_spinlock_trylock(&adapter->lock) == 0)
+		return 0;
+
+	while (nb < adapter->max_nb) {
+		n = 0;
+		if (adapter->mode == RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD)
+			n = eca_enq_run(adapter, adapter->max_nb - nb);
+		n += eca_deq_run(adapter, adapter->max_nb - nb);
+		if (n == 0)
+			break;
+		nb += n;
+	}
+
+	rte_spinlock_unlock(&adapter->lock);
+	return 0;
+}
+
+static int
+rte_event_crypto_adapter_init(void)
+{
+	const char *name = "rte_event_crypto_adapter_array";
+	const struct rte_memzone *mz;
+	unsigned int sz;
+
+	sz = sizeof(*event_crypto_adapter) *
+	    RTE_EVENT_CRYPTO_ADAPTER_MAX_INSTANCE;
+	sz = RTE_ALIGN(sz, RTE_CACHE_LINE_SIZE);
+
+	mz = rte_memzone_lookup(name);
+	if (mz == NULL) {
+		mz = rte_memzone_reserve_aligned(name, sz, rte_socket_id(), 0,
+						 RTE_CACHE_LINE_SIZE);
+		if (mz == NULL) {
+			RTE_EDEV_LOG_ERR("failed to reserve memzone err = %"
+					PRId32, rte_errno);
+			return -rte_errno;
+		}
+	}
+
+	event_crypto_adapter = mz->addr;
+	return 0;
+}
+
+static int
+default_conf_cb(uint8_t id, uint8_t dev_id,
+		struct rte_event_crypto_adapter_conf *conf, void *arg)
+{
+	int ret;
+	struct rte_eventdev *dev;
+	struct rte_event_dev_config dev_conf;
+	int started;
+	uint8_t port_id;
+	struct rte_event_port_conf *port_conf = arg;
+
+	RTE_SET_USED(id);
+
+	dev = &rte_eventdevs[dev_id];
+	dev_conf = dev->data->dev_conf;
+
+	started = dev->data->dev_started;
+	if (started)
+		rte_event_dev_stop(dev_id);
+	port_id = dev_conf.nb_event_ports;
+	dev_conf.nb_event_ports += 1;
+	ret = rte_event_dev_configure(dev_id, &dev_conf);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("failed to configure event dev %u\n",
+						dev_id);
+		if (started)
+			rte_event_dev_start(dev_id);
+		return ret;
+	}
+
+	ret = rte_event_port_setup(dev_id, port_id, port_conf);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("failed to setup event port %u\n",
+					port_id);
+		return ret;
+	}
+
+	conf->event_port_id = port_id;
+	conf->max_nb = DEFAULT_MAX_NB;
+	if (started)
+		rte_event_dev_start(dev_id);
+	return ret;
+}
+
+static int
+init_service(struct rte_event_crypto_adapter *adapter, uint8_t id)
+{
+	int ret;
+	struct rte_service_spec service;
+
+	memset(&service, 0, sizeof(service));
+	snprintf(service.name, CRYPTO_ADAPTER_SERVICE_NAME_LEN,
+		"rte_event_crypto_adapter_%d", id);
+	service.socket_id = adapter->socket_id;
+	service.callback = event_crypto_adapter_service_func;
+	service.callback_userdata = adapter;
+	/* Service function handles locking for queue pair add/del updates */
+	service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
+	ret = rte_service_component_register(&service, &adapter->service_id);
+	if (ret)
+		RTE_EDEV_LOG_ERR("failed to register service %s err = %" PRId32,
+			service.name, ret);
+	return ret;
+}
+
+/* Rebuild the array of queue pairs to poll */
+static int
+eca_poll_list_calc(struct rte_event_crypto_adapter *adapter)
+{
+	struct crypto_qp_poll_entry *qp_poll = NULL;
+	struct crypto_device_info *dev_info;
+	uint32_t n = 0;
+	uint16_t d, q;
+
+	if (adapter->nb_qps) {
+		qp_poll = rte_zmalloc_socket(adapter->mem_name,
+				adapter->nb_qps * sizeof(*qp_poll),
+				RTE_CACHE_LINE_SIZE, adapter->socket_id);
+		if (qp_poll == NULL)
+			return -ENOMEM;
+
+		for (d = 0; d < RTE_CRYPTO_MAX_DEVS; d++) {
+			dev_info = &adapter->cdevs[d];
+			if (dev_info->qpairs == NULL)
+				continue;
+			for (q = 0; q < dev_info->nb_qpairs; q++) {
+				if (!dev_info->qpairs[q].qp_enabled)
+					continue;
+				qp_poll[n].cdev_id = d;
+				qp_poll[n].qp_id = q;
+				n++;
+			}
+		}
+	}
+
+	rte_free(adapter->qp_poll);
+	adapter->qp_poll = qp_poll;
+	adapter->nb_qp_polled = n;
+	adapter->qp_poll_pos = 0;
+	return 0;
+}
+
+static void
+eca_update_qp_info(struct rte_event_crypto_adapter *adapter,
+		struct crypto_device_info *dev_info, uint8_t cdev_id,
+		int32_t queue_pair_id, uint8_t add)
+{
+	struct crypto_queue_pair_info *qp_info;
+	uint16_t i;
+
+	if (queue_pair_id == -1) {
+		for (i = 0; i < dev_info->nb_qpairs; i++)
+			eca_update_qp_info(adapter, dev_info, cdev_id, i,
+					add);
+		return;
+	}
+
+	qp_info = &dev_info->qpairs[queue_pair_id];
+	if (qp_info->qp_enabled == !!add)
+		return;
+
+	if (!add) {
+		/* Submit the pending operations, drop the rejected ones */
+		if (qp_info->buf.count)
+			eca_flush_ops_buffer(adapter, cdev_id, queue_pair_id,
+					&qp_info->buf);
+		for (i = 0; i < qp_info->buf.count; i++)
+			eca_op_drop(adapter, qp_info->buf.op_buffer[i]);
+		qp_info->buf.count = 0;
+	}
+
+	qp_info->qp_enabled = !!add;
+	adapter->nb_qps += add ? 1 : -1;
+	dev_info->nb_dev_qpairs += add ? 1 : -1;
+}
+
+int
+rte_event_crypto_adapter_create_ext(uint8_t id, uint8_t dev_id,
+				rte_event_crypto_adapter_conf_cb conf_cb,
+				enum rte_event_crypto_adapter_mode mode,
+				void *conf_arg)
+{
+	struct rte_event_crypto_adapter *adapter;
+	struct rte_event_crypto_adapter_conf adapter_conf;
+	char mem_name[CRYPTO_ADAPTER_MEM_NAME_LEN];
+	int socket_id;
+	int ret;
+
+	RTE_EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	if (conf_cb == NULL || (mode != RTE_EVENT_CRYPTO_ADAPTER_OP_NEW &&
+			mode != RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD))
+		return -EINVAL;
+
+	if (event_crypto_adapter == NULL) {
+		ret = rte_event_crypto_adapter_init();
+		if (ret)
+			return ret;
+	}
+
+	adapter = id_to_crypto_adapter(id);
+	if (adapter != NULL) {
+		RTE_EDEV_LOG_ERR("Crypto adapter exists id = %" PRIu8, id);
+		return -EEXIST;
+	}
+
+	socket_id = rte_event_dev_socket_id(dev_id);
+	snprintf(mem_name, CRYPTO_ADAPTER_MEM_NAME_LEN,
+		"rte_event_crypto_adapter_%d", id);
+
+	adapter = rte_zmalloc_socket(mem_name, sizeof(*adapter),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (adapter == NULL) {
+		RTE_EDEV_LOG_ERR("failed to get mem for crypto adapter");
+		return -ENOMEM;
+	}
+
+	adapter->cdevs = rte_zmalloc_socket(mem_name,
+			RTE_CRYPTO_MAX_DEVS * sizeof(*adapter->cdevs), 0,
+			socket_id);
+	if (adapter->cdevs == NULL) {
+		RTE_EDEV_LOG_ERR("failed to get mem for crypto devices");
+		rte_free(adapter);
+		return -ENOMEM;
+	}
+
+	adapter->eventdev_id = dev_id;
+	adapter->mode = mode;
+	adapter->socket_id = socket_id;
+	adapter->conf_arg = conf_arg;
+	adapter->default_cb_arg = conf_cb == default_conf_cb;
+	strcpy(adapter->mem_name, mem_name);
+	rte_spinlock_init(&adapter->lock);
+
+	ret = conf_cb(id, dev_id, &adapter_conf, conf_arg);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("configuration callback failed err = %" PRId32,
+			ret);
+		goto err_free;
+	}
+	adapter->event_port_id = adapter_conf.event_port_id;
+	adapter->max_nb = adapter_conf.max_nb;
+
+	ret = init_service(adapter, id);
+	if (ret)
+		goto err_free;
+
+	event_crypto_adapter[id] = adapter;
+	return 0;
+
+err_free:
+	rte_free(adapter->cdevs);
+	rte_free(adapter);
+	return ret;
+}
+
+int
+rte_event_crypto_adapter_create(uint8_t id, uint8_t dev_id,
+		struct rte_event_port_conf *port_config,
+		enum rte_event_crypto_adapter_mode mode)
+{
+	struct rte_event_port_conf *pc;
+	int ret;
+
+	if (port_config == NULL)
+		return -EINVAL;
+	RTE_EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	pc = rte_malloc(NULL, sizeof(*pc), 0);
+	if (pc == NULL)
+		return -ENOMEM;
+	*pc = *port_config;
+	ret = rte_event_crypto_adapter_create_ext(id, dev_id,
+					default_conf_cb,
+					mode,
+					pc);
+	if (ret)
+		rte_free(pc);
+	return ret;
+}
+
+int
+rte_event_crypto_adapter_free(uint8_t id)
+{
+	struct rte_event_crypto_adapter *adapter;
+
+	RTE_EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_crypto_adapter(id);
+	if (adapter == NULL)
+		return -EINVAL;
+
+	if (adapter->nb_qps) {
+		RTE_EDEV_LOG_ERR("%" PRIu32 " queue pairs not deleted",
+				adapter->nb_qps);
+		return -EBUSY;
+	}
+
+	rte_service_component_runstate_set(adapter->service_id, 0);
+	rte_service_component_unregister(adapter->service_id);
+	if (adapter->default_cb_arg)
+		rte_free(adapter->conf_arg);
+	rte_free(adapter->cdevs);
+	rte_free(adapter);
+	event_crypto_adapter[id] = NULL;
+
+	return 0;
+}
+
+int
+rte_event_crypto_adapter_queue_pair_add(uint8_t id, uint8_t cdev_id,
+					int32_t queue_pair_id)
+{
+	struct rte_event_crypto_adapter *adapter;
+	struct crypto_device_info *dev_info;
+	uint16_t nb_qpairs;
+	int ret;
+
+	RTE_EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_crypto_adapter(id);
+	if (adapter == NULL || !rte_cryptodev_pmd_is_valid_dev(cdev_id))
+		return -EINVAL;
+
+	nb_qpairs = rte_cryptodev_queue_pair_count(cdev_id);
+	if (queue_pair_id != -1 &&
+			(queue_pair_id < 0 || queue_pair_id >= nb_qpairs)) {
+		RTE_EDEV_LOG_ERR("Invalid queue pair id %" PRId32,
+				queue_pair_id);
+		return -EINVAL;
+	}
+
+	dev_info = &adapter->cdevs[cdev_id];
+
+	rte_spinlock_lock(&adapter->lock);
+	if (dev_info->qpairs == NULL) {
+		dev_info->qpairs = rte_zmalloc_socket(adapter->mem_name,
+				nb_qpairs * sizeof(*dev_info->qpairs), 0,
+				adapter->socket_id);
+		if (dev_info->qpairs == NULL) {
+			rte_spinlock_unlock(&adapter->lock);
+			return -ENOMEM;
+		}
+		dev_info->nb_qpairs = nb_qpairs;
+	}
+
+	eca_update_qp_info(adapter, dev_info, cdev_id, queue_pair_id, 1);
+	ret = eca_poll_list_calc(adapter);
+	if (ret)
+		eca_update_qp_info(adapter, dev_info, cdev_id, queue_pair_id,
+				0);
+	rte_spinlock_unlock(&adapter->lock);
+
+	if (ret == 0)
+		rte_service_component_runstate_set(adapter->service_id, 1);
+
+	return ret;
+}
+
+int
+rte_event_crypto_adapter_queue_pair_del(uint8_t id, uint8_t cdev_id,
+					int32_t queue_pair_id)
+{
+	struct rte_event_crypto_adapter *adapter;
+	struct crypto_device_info *dev_info;
+	int ret;
+
+	RTE_EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_crypto_adapter(id);
+	if (adapter == NULL || cdev_id >= RTE_CRYPTO_MAX_DEVS)
+		return -EINVAL;
+
+	dev_info = &adapter->cdevs[cdev_id];
+	if (dev_info->qpairs == NULL || (queue_pair_id != -1 &&
+			(queue_pair_id < 0 ||
+			 queue_pair_id >= dev_info->nb_qpairs)))
+		return -EINVAL;
+
+	rte_spinlock_lock(&adapter->lock);
+	eca_update_qp_info(adapter, dev_info, cdev_id, queue_pair_id, 0);
+	ret = eca_poll_list_calc(adapter);
+	if (ret)
+		RTE_EDEV_LOG_ERR("poll list recalculation failed %" PRId32,
+				ret);
+
+	if (dev_info->nb_dev_qpairs == 0) {
+		rte_free(dev_info->qpairs);
+		dev_info->qpairs = NULL;
+		dev_info->nb_qpairs = 0;
+	}
+	rte_spinlock_unlock(&adapter->lock);
+
+	rte_service_component_runstate_set(adapter->service_id,
+			adapter->nb_qps != 0);
+
+	return ret;
+}
+
+static int
+crypto_adapter_ctrl(uint8_t id, int start)
+{
+	struct rte_event_crypto_adapter *adapter;
+
+	RTE_EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+	adapter = id_to_crypto_adapter(id);
+	if (adapter == NULL)
+		return -EINVAL;
+
+	return rte_service_runstate_set(adapter->service_id, start);
+}
+
+int
+rte_event_crypto_adapter_start(uint8_t id)
+{
+	return crypto_adapter_ctrl(id, 1);
+}
+
+int
+rte_event_crypto_adapter_stop(uint8_t id)
+{
+	return crypto_adapter_ctrl(id, 0);
+}
+
+int
+rte_event_crypto_adapter_stats_get(uint8_t id,
+				struct rte_event_crypto_adapter_stats *stats)
+{
+	struct rte_event_crypto_adapter *adapter;
+
+	RTE_EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_crypto_adapter(id);
+	if (adapter == NULL || stats == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&adapter->lock);
+	*stats = adapter->stats;
+	rte_spinlock_unlock(&adapter->lock);
+	return 0;
+}
+
+int
+rte_event_crypto_adapter_stats_reset(uint8_t id)
+{
+	struct rte_event_crypto_adapter *adapter;
+
+	RTE_EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_crypto_adapter(id);
+	if (adapter == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&adapter->lock);
+	memset(&adapter->stats, 0, sizeof(adapter->stats));
+	rte_spinlock_unlock(&adapter->lock);
+	return 0;
+}
+
+int
+rte_event_crypto_adapter_service_id_get(uint8_t id, uint32_t *service_id)
+{
+	struct rte_event_crypto_adapter *adapter;
+
+	RTE_EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_crypto_adapter(id);
+	if (adapter == NULL || service_id == NULL)
+		return -EINVAL;
+
+	*service_id = adapter->service_id;
+	return 0;
+}
+
+int
+rte_event_crypto_adapter_event_port_get(uint8_t id, uint8_t *event_port_id)
+{
+	struct rte_event_crypto_adapter *adapter;
+
+	RTE_EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_crypto_adapter(id);
+	if (adapter == NULL || event_port_id == NULL)
+		return -EINVAL;
+
+	*event_port_id = adapter->event_port_id;
+	return 0;
+}
@@ -0,0 +1,829 @@
+/*
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_ethdev.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_memzone.h>
+#include <rte_service_component.h>
+#include <rte_spinlock.h>
+
+#include "rte_eventdev.h"
+#include "rte_eventdev_pmd.h"
+#include "rte_event_eth_tx_adapter.h"
+
+#define BATCH_SIZE		32
+#define DEFAULT_MAX_NB_TX	128
+/* Transmit retries before the packets of a burst are dropped */
+#define TXA_RETRY_CNT		100
+/* Service function calls after which all the Tx buffers are flushed */
+#define TXA_FLUSH_THRESHOLD	1024
+
+#define TXA_SERVICE_NAME_LEN	32
+#define TXA_MEM_NAME_LEN	32
+
+/* Per Tx queue */
+struct txa_queue_info {
+	/* Set if the Tx queue is added to the adapter */
+	int added;
+	/* Ethernet port identifier */
+	uint16_t port_id;
+	/* Tx queue identifier */
+	uint16_t queue_id;
+	/* Packets waiting to be transmitted */
+	struct rte_eth_dev_tx_buffer *tx_buf;
+	/* Stats of the ethernet port */
+	struct rte_event_eth_tx_adapter_stats *stats;
+};
+
+/* Per ethernet port */
+struct txa_ethdev_info {
+	/* Array of Tx queue info, NULL if no queue is added */
+	struct txa_queue_info *queues;
+	/* Size of the queues array */
+	uint16_t nb_queues;
+	/* Count of Tx queues added to the adapter */
+	uint16_t nb_dev_queues;
+	/* Per port stats */
+	struct rte_event_eth_tx_adapter_stats stats;
+};
+
+struct rte_event_eth_tx_adapter {
+	/* Event device identifier */
+	uint8_t eventdev_id;
+	/* Event port identifier */
+	uint8_t event_port_id;
+	/* Lock to serialize config updates with service function */
+	rte_spinlock_t lock;
+	/* Max mbufs processed in any service function call */
+	uint32_t max_nb_tx;
+	/* Per ethernet port structure, indexed by port identifier */
+	struct txa_ethdev_info *txa_ethdev;
+	/* Tx queues added to the adapter, flushed by the service function */
+	struct txa_queue_info **txq_list;
+	/* Size of the txq_list array */
+	uint16_t nb_txq_list;
+	/* Service function calls since the last flush of all Tx queues */
+	uint32_t loop_cnt;
+	/* Packets dropped for lack of a Tx queue added to the adapter */
+	uint64_t tx_dropped;
+	/* Configuration callback argument */
+	void *conf_arg;
+	/* Set if default_cb is being used */
+	int default_cb_arg;
+	/* Total count of Tx queues in adapter */
+	uint32_t nb_queues;
+	/* Memory allocation name */
+	char mem_name[TXA_MEM_NAME_LEN];
+	/* Socket identifier cached from eventdev */
+	int socket_id;
+	/* Per adapter EAL service */
+	uint32_t service_id;
+} __rte_cache_aligned;
+
+static struct rte_event_eth_tx_adapter **event_eth_tx_adapter;
+
+static inline int
+valid_id(uint8_t id)
+{
+	return id < RTE_EVENT_ETH_TX_ADAPTER_MAX_INSTANCE;
+}
+
+#define RTE_EVENT_ETH_TX_ADAPTER_ID_VALID_OR_ERR_RET(id, retval) do { \
+	if (!valid_id(id)) { \
+		RTE_EDEV_LOG_ERR("Invalid eth Tx adapter id = %d\n", id); \
+		return retval; \
+	} \
+} while (0)
+
+static inline struct rte_event_eth_tx_adapter *
+id_to_tx_adapter(uint8_t id)
+{
+	return event_eth_tx_adapter ?
+		event_eth_tx_adapter[id] : NULL;
+}
+
+/*
+ * Error callback of the Tx buffers, called with the packets of a burst that
+ * the Tx queue didn't accept. The transmission is retried a bounded number
+ * of times, so that a stalled port doesn't block the service function, and
+ * the remaining packets are dropped.
+ */
+static void
+txa_buffer_retry(struct rte_mbuf **pkts, uint16_t unsent, void *userdata)
+{
+	struct txa_queue_info *tqi = userdata;
+	struct rte_event_eth_tx_adapter_stats *stats = tqi->stats;
+	uint16_t sent = 0;
+	uint16_t retry = 0;
+	uint16_t i;
+
+	while (sent < unsent && retry < TXA_RETRY_CNT) {
+		retry++;
+		sent += rte_eth_tx_burst(tqi->port_id, tqi->queue_id,
+					&pkts[sent], unsent - sent);
+	}
+
+	for (i = sent; i < unsent; i++)
+		rte_pktmbuf_free(pkts[i]);
+
+	stats->tx_retry += retry;
+	stats->tx_packets += sent;
+	stats->tx_dropped += unsent - sent;
+}
+
+static inline void
+txa_flush_queue(struct txa_queue_info *tqi)
+{
+	tqi->stats->tx_packets += rte_eth_tx_buffer_flush(tqi->port_id,
+						tqi->queue_id, tqi->tx_buf);
+}
+
+static void
+txa_flush_all(struct rte_event_eth_tx_adapter *adapter)
+{
+	struct txa_queue_info *tqi;
+	uint16_t i;
+
+	for (i = 0; i < adapter->nb_txq_list; i++) {
+		tqi = adapter->txq_list[i];
+		if (tqi->tx_buf->length)
+			txa_flush_queue(tqi);
+	}
+}
+
+static inline struct txa_queue_info *
+txa_get_queue_info(struct rte_event_eth_tx_adapter *adapter,
+		uint16_t port_id, uint16_t queue_id)
+{
+	struct txa_ethdev_info *dev_info;
+
+	if (unlikely(port_id >= RTE_MAX_ETHPORTS))
+		return NULL;
+
+	dev_info = &adapter->txa_ethdev[port_id];
+	if (unlikely(queue_id >= dev_info->nb_queues ||
+			!dev_info->queues[queue_id].added))
+		return NULL;
+
+	return &dev_info->queues[queue_id];
+}
+
+/*
+ * Buffer the packets of a burst of mbuf events per Tx queue. A buffer is
+ * transmitted by rte_eth_tx_buffer() when it holds a full burst.
+ */
+static void
+txa_tx_events(struct rte_event_eth_tx_adapter *adapter,
+	struct rte_event *ev, uint16_t num)
+{
+	struct txa_queue_info *tqi;
+	struct rte_mbuf *m;
+	uint16_t i;
+
+	for (i = 0; i < num; i++) {
+		m = ev[i].mbuf;
+		tqi = txa_get_queue_info(adapter, m->port,
+				rte_event_eth_tx_adapter_txq_get(m));
+		if (unlikely(tqi == NULL)) {
+			rte_pktmbuf_free(m);
+			adapter->tx_dropped++;
+			continue;
+		}
+
+		tqi->stats->tx_packets += rte_eth_tx_buffer(tqi->port_id,
+						tqi->queue_id, tqi->tx_buf, m);
+	}
+}
+
+/*
+ * Dequeues mbuf events from the adapter port and transmits their packets.
+ * The Tx buffers are flushed when the event port has been drained, or every
+ * TXA_FLUSH_THRESHOLD calls if it isn't, to bound the latency of the
+ * packets of low rate Tx queues.
+ */
+static int
+event_eth_tx_adapter_service_func(void *args)
+{
+	struct rte_event_eth_tx_adapter *adapter = args;
+	struct rte_event ev[BATCH_SIZE];
+	uint32_t nb_tx = 0;
+	uint16_t n = 0;
+
+	if (rte_spinlock_trylock(&adapter->lock) == 0)
+		return 0;
+
+	while (nb_tx < adapter->max_nb_tx) {
+		n = rte_event_dequeue_burst(adapter->eventdev_id,
+					adapter->event_port_id, ev,
+					BATCH_SIZE, 0);
+		if (n == 0)
+			break;
+
+		txa_tx_events(adapter, ev, n);
+		nb_tx += n;
+		if (n < BATCH_SIZE)
+			break;
+	}
+
+	if (n < BATCH_SIZE || ++adapter->loop_cnt >= TXA_FLUSH_THRESHOLD) {
+		txa_flush_all(adapter);
+		adapter->loop_cnt = 0;
+	}
+
+	rte_spinlock_unlock(&adapter->lock);
+	return 0;
+}
+
+static int
+rte_event_eth_tx_adapter_init(void)
+{
+	const char *name = "rte_event_eth_tx_adapter_array";
+	const struct rte_memzone *mz;
+	unsigned int sz;
+
+	sz = sizeof(*event_eth_tx_adapter) *
+	    RTE_EVENT_ETH_TX_ADAPTER_MAX_INSTANCE;
+	sz = RTE_ALIGN(sz, RTE_CACHE_LINE_SIZE);
+
+	mz = rte_memzone_lookup(name);
+	if (mz == NULL) {
+		mz = rte_memzone_reserve_aligned(name, sz, rte_socket_id(), 0,
+						 RTE_CACHE_LINE_SIZE);
+		if (mz == NULL) {
+			RTE_EDEV_LOG_ERR("failed to reserve memzone err = %"
+					PRId32, rte_errno);
+			return -rte_errno;
+		}
+	}
+
+	event_eth_tx_adapter = mz->addr;
+	return 0;
+}
+
+static int
+default_conf_cb(uint8_t id, uint8_t dev_id,
+		struct rte_event_eth_tx_adapter_conf *conf, void *arg)
+{
+	int ret;
+	struct rte_eventdev *dev;
+	struct rte_event_dev_config dev_conf;
+	int started;
+	uint8_t port_id;
+	struct rte_event_port_conf *port_conf = arg;
+
+	RTE_SET_USED(id);
+
+	dev = &rte_eventdevs[dev_id];
+	dev_conf = dev->data->dev_conf;
+
+	started = dev->data->dev_started;
+	if (started)
+		rte_event_dev_stop(dev_id);
+	port_id = dev_conf.nb_event_ports;
+	dev_conf.nb_event_ports += 1;
+	ret = rte_event_dev_configure(dev_id, &dev_conf);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("failed to configure event dev %u\n",
+						dev_id);
+		if (started)
+			rte_event_dev_start(dev_id);
+		return ret;
+	}
+
+	ret = rte_event_port_setup(dev_id, port_id, port_conf);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("failed to setup event port %u\n",
+					port_id);
+		return ret;
+	}
+
+	conf->event_port_id = port_id;
+	conf->max_nb_tx = DEFAULT_MAX_NB_TX;
+	if (started)
+		rte_event_dev_start(dev_id);
+	return ret;
+}
+
+static int
+init_service(struct rte_event_eth_tx_adapter *adapter, uint8_t id)
+{
+	int ret;
+	struct rte_service_spec service;
+
+	memset(&service, 0, sizeof(service));
+	snprintf(service.name, TXA_SERVICE_NAME_LEN,
+		"rte_event_eth_tx_adapter_%d", id);
+	service.socket_id = adapter->socket_id;
+	service.callback = event_eth_tx_adapter_service_func;
+	service.callback_userdata = adapter;
+	/* Service function handles locking for queue add/del updates */
+	service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
+	ret = rte_service_component_register(&service, &adapter->service_id);
+	if (ret)
+		RTE_EDEV_LOG_ERR("failed to register service %s err = %" PRId32,
+			service.name, ret);
+	return ret;
+}
+
+/* Rebuild the array of Tx queues flushed by the service function */
+static int
+txa_txq_list_calc(struct rte_event_eth_tx_adapter *adapter)
+{
+	struct txa_queue_info **txq_list = NULL;
+	struct txa_ethdev_info *dev_info;
+	uint32_t n = 0;
+	uint16_t d, q;
+
+	if (adapter->nb_queues) {
+		txq_list = rte_zmalloc_socket(adapter->mem_name,
+				adapter->nb_queues * sizeof(*txq_list),
+				RTE_CACHE_LINE_SIZE, adapter->socket_id);
+		if (txq_list == NULL)
+			return -ENOMEM;
+
+		for (d = 0; d < RTE_MAX_ETHPORTS; d++) {
+			dev_info = &adapter->txa_ethdev[d];
+			if (dev_info->queues == NULL)
+				continue;
+			for (q = 0; q < dev_info->nb_queues; q++) {
+				if (dev_info->queues[q].added)
+					txq_list[n++] = &dev_info->queues[q];
+			}
+		}
+	}
+
+	rte_free(adapter->txq_list);
+	adapter->txq_list = txq_list;
+	adapter->nb_txq_list = n;
+	return 0;
+}
+
+static int
+txa_queue_info_init(struct rte_event_eth_tx_adapter *adapter,
+		struct txa_ethdev_info *dev_info, uint16_t port_id,
+		uint16_t queue_id)
+{
+	struct txa_queue_info *tqi = &dev_info->queues[queue_id];
+
+	tqi->tx_buf = rte_zmalloc_socket(adapter->mem_name,
+				RTE_ETH_TX_BUFFER_SIZE(BATCH_SIZE), 0,
+				adapter->socket_id);
+	if (tqi->tx_buf == NULL)
+		return -ENOMEM;
+
+	rte_eth_tx_buffer_init(tqi->tx_buf, BATCH_SIZE);
+	rte_eth_tx_buffer_set_err_callback(tqi->tx_buf, txa_buffer_retry,
+					tqi);
+	tqi->port_id = port_id;
+	tqi->queue_id = queue_id;
+	tqi->stats = &dev_info->stats;
+	return 0;
+}
+
+static int
+txa_update_queue_info(struct rte_event_eth_tx_adapter *adapter,
+		struct txa_ethdev_info *dev_info, uint16_t port_id,
+		int32_t queue_id, uint8_t add)
+{
+	struct txa_queue_info *tqi;
+	uint16_t i;
+	int ret;
+
+	if (queue_id == -1) {
+		for (i = 0; i < dev_info->nb_queues; i++) {
+			ret = txa_update_queue_info(adapter, dev_info,
+						port_id, i, add);
+			if (ret)
+				return ret;
+		}
+		return 0;
+	}
+
+	tqi = &dev_info->queues[queue_id];
+	if (tqi->added == !!add)
+		return 0;
+
+	if (add) {
+		ret = txa_queue_info_init(adapter, dev_info, port_id,
+					queue_id);
+		if (ret)
+			return ret;
+	} else {
+		/* Transmit the buffered packets, drop the rejected ones */
+		txa_flush_queue(tqi);
+		rte_free(tqi->tx_buf);
+		tqi->tx_buf = NULL;
+	}
+
+	tqi->added = !!add;
+	adapter->nb_queues += add ? 1 : -1;
+	dev_info->nb_dev_queues += add ? 1 : -1;
+	return 0;
+}
+
+static void
+txa_ethdev_info_release(struct txa_ethdev_info *dev_info)
+{
+	if (dev_info->nb_dev_queues)
+		return;
+
+	rte_free(dev_info->queues);
+	dev_info->queues = NULL;
+	dev_info->nb_queues = 0;
+}
+
+int
+rte_event_eth_tx_adapter_create_ext(uint8_t id, uint8_t dev_id,
+				rte_event_eth_tx_adapter_conf_cb conf_cb,
+				void *conf_arg)
+{
+	struct rte_event_eth_tx_adapter *adapter;
+	struct rte_event_eth_tx_adapter_conf adapter_conf;
+	char mem_name[TXA_MEM_NAME_LEN];
+	int socket_id;
+	int ret;
+
+	RTE_EVENT_ETH_TX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	if (conf_cb == NULL)
+		return -EINVAL;
+
+	if (event_eth_tx_adapter == NULL) {
+		ret = rte_event_eth_tx_adapter_init();
+		if (ret)
+			return ret;
+	}
+
+	adapter = id_to_tx_adapter(id);
+	if (adapter != NULL) {
+		RTE_EDEV_LOG_ERR("Eth Tx adapter exists id = %" PRIu8, id);
+		return -EEXIST;
+	}
+
+	socket_id = rte_event_dev_socket_id(dev_id);
+	snprintf(mem_name, TXA_MEM_NAME_LEN,
+		"rte_event_eth_tx_adapter_%d", id);
+
+	adapter = rte_zmalloc_socket(mem_name, sizeof(*adapter),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (adapter == NULL) {
+		RTE_EDEV_LOG_ERR("failed to get mem for eth Tx adapter");
+		return -ENOMEM;
+	}
+
+	adapter->txa_ethdev = rte_zmalloc_socket(mem_name,
+			RTE_MAX_ETHPORTS * sizeof(*adapter->txa_ethdev), 0,
+			socket_id);
+	if (adapter->txa_ethdev == NULL) {
+		RTE_EDEV_LOG_ERR("failed to get mem for eth devices");
+		rte_free(adapter);
+		return -ENOMEM;
+	}
+
+	adapter->eventdev_id = dev_id;
+	adapter->socket_id = socket_id;
+	adapter->conf_arg = conf_arg;
+	adapter->default_cb_arg = conf_cb == default_conf_cb;
+	strcpy(adapter->mem_name, mem_name);
+	rte_spinlock_init(&adapter->lock);
+
+	ret = conf_cb(id, dev_id, &adapter_conf, conf_arg);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("configuration callback failed err = %" PRId32,
+			ret);
+		goto err_free;
+	}
+	adapter->event_port_id = adapter_conf.event_port_id;
+	adapter->max_nb_tx = adapter_conf.max_nb_tx;
+
+	ret = init_service(adapter, id);
+	if (ret)
+		goto err_free;
+
+	event_eth_tx_adapter[id] = adapter;
+	return 0;
+
+err_free:
+	rte_free(adapter->txa_ethdev);
+	rte_free(adapter);
+	return ret;
+}
+
+int
+rte_event_eth_tx_adapter_create(uint8_t id, uint8_t dev_id,
+		struct rte_event_port_conf *port_config)
+{
+	struct rte_event_port_conf *pc;
+	int ret;
+
+	if (port_config == NULL)
+		return -EINVAL;
+	RTE_EVENT_ETH_TX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	pc = rte_malloc(NULL, sizeof(*pc), 0);
+	if (pc == NULL)
+		return -ENOMEM;
+	*pc = *port_config;
+	ret = rte_event_eth_tx_adapter_create_ext(id, dev_id,
+					default_conf_cb,
+					pc);
+	if (ret)
+		rte_free(pc);
+	return ret;
+}
+
+int
+rte_event_eth_tx_adapter_free(uint8_t id)
+{
+	struct rte_event_eth_tx_adapter *adapter;
+
+	RTE_EVENT_ETH_TX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_tx_adapter(id);
+	if (adapter == NULL)
+		return -EINVAL;
+
+	if (adapter->nb_queues) {
+		RTE_EDEV_LOG_ERR("%" PRIu32 " Tx queues not deleted",
+				adapter->nb_queues);
+		return -EBUSY;
+	}
+
+	rte_service_component_runstate_set(adapter->service_id, 0);
+	rte_service_component_unregister(adapter->service_id);
+	if (adapter->default_cb_arg)
+		rte_free(adapter->conf_arg);
+	rte_free(adapter->txq_list);
+	rte_free(adapter->txa_ethdev);
+	rte_free(adapter);
+	event_eth_tx_adapter[id] = NULL;
+
+	return 0;
+}
+
+int
+rte_event_eth_tx_adapter_queue_add(uint8_t id, uint16_t eth_dev_id,
+				int32_t queue)
+{
+	uint64_t added[RTE_MAX_QUEUES_PER_PORT / 64];
+	struct rte_event_eth_tx_adapter *adapter;
+	struct txa_ethdev_info *dev_info;
+	uint16_t nb_queues, first, last, q;
+	int ret;
+
+	RTE_EVENT_ETH_TX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(eth_dev_id, -EINVAL);
+
+	adapter = id_to_tx_adapter(id);
+	if (adapter == NULL)
+		return -EINVAL;
+
+	nb_queues = rte_eth_devices[eth_dev_id].data->nb_tx_queues;
+	if (queue != -1 && (queue < 0 || queue >= nb_queues)) {
+		RTE_EDEV_LOG_ERR("Invalid Tx queue id %" PRId32, queue);
+		return -EINVAL;
+	}
+
+	dev_info = &adapter->txa_ethdev[eth_dev_id];
+
+	rte_spinlock_lock(&adapter->lock);
+	if (dev_info->queues == NULL) {
+		if (nb_queues == 0) {
+			rte_spinlock_unlock(&adapter->lock);
+			return -EINVAL;
+		}
+		dev_info->queues = rte_zmalloc_socket(adapter->mem_name,
+				nb_queues * sizeof(*dev_info->queues), 0,
+				adapter->socket_id);
+		if (dev_info->queues == NULL) {
+			rte_spinlock_unlock(&adapter->lock);
+			return -ENOMEM;
+		}
+		dev_info->nb_queues = nb_queues;
+	}
+
+	/* Keep track of the queues added by this call, to only remove these
+	 * on failure
+	 */
+	memset(added, 0, sizeof(added));
+	first = queue == -1 ? 0 : queue;
+	last = queue == -1 ? dev_info->nb_queues : queue + 1;
+	ret = 0;
+	for (q = first; q < last && ret == 0; q++) {
+		if (dev_info->queues[q].added)
+			continue;
+		ret = txa_update_queue_info(adapter, dev_info, eth_dev_id, q,
+					1);
+		if (ret == 0)
+			added[q / 64] |= UINT64_C(1) << (q % 64);
+	}
+	if (ret == 0)
+		ret = txa_txq_list_calc(adapter);
+	if (ret) {
+		for (q = first; q < last; q++) {
+			if (added[q / 64] & (UINT64_C(1) << (q % 64)))
+				txa_update_queue_info(adapter, dev_info,
+						eth_dev_id, q, 0);
+		}
+		txa_txq_list_calc(adapter);
+		txa_ethdev_info_release(dev_info);
+	}
+	rte_spinlock_unlock(&adapter->lock);
+
+	if (ret == 0)
+		rte_service_component_runstate_set(adapter->service_id, 1);
+
+	return ret;
+}
+
+int
+rte_event_eth_tx_adapter_queue_del(uint8_t id, uint16_t eth_dev_id,
+				int32_t queue)
+{
+	struct rte_event_eth_tx_adapter *adapter;
+	struct txa_ethdev_info *dev_info;
+	int ret;
+
+	RTE_EVENT_ETH_TX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_tx_adapter(id);
+	if (adapter == NULL || eth_dev_id >= RTE_MAX_ETHPORTS)
+		return -EINVAL;
+
+	dev_info = &adapter->txa_ethdev[eth_dev_id];
+	if (dev_info->queues == NULL || (queue != -1 &&
+			(queue < 0 || queue >= dev_info->nb_queues)))
+		return -EINVAL;
+
+	rte_spinlock_lock(&adapter->lock);
+	txa_update_queue_info(adapter, dev_info, eth_dev_id, queue, 0);
+	ret = txa_txq_list_calc(adapter);
+	if (ret)
+		RTE_EDEV_LOG_ERR("Tx queue list recalculation failed %" PRId32,
+				ret);
+	txa_ethdev_info_release(dev_info);
+	rte_spinlock_unlock(&adapter->lock);
+
+	rte_service_component_runstate_set(adapter->service_id,
+			adapter->nb_queues != 0);
+
+	return ret;
+}
+
+static int
+tx_adapter_ctrl(uint8_t id, int start)
+{
+	struct rte_event_eth_tx_adapter *adapter;
+
+	RTE_EVENT_ETH_TX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+	adapter = id_to_tx_adapter(id);
+	if (adapter == NULL)
+		return -EINVAL;
+
+	return rte_service_runstate_set(adapter->service_id, start);
+}
+
+int
+rte_event_eth_tx_adapter_start(uint8_t id)
+{
+	return tx_adapter_ctrl(id, 1);
+}
+
+int
+rte_event_eth_tx_adapter_stop(uint8_t id)
+{
+	return tx_adapter_ctrl(id, 0);
+}
+
+int
+rte_event_eth_tx_adapter_stats_get(uint8_t id,
+				struct rte_event_eth_tx_adapter_stats *stats)
+{
+	struct rte_event_eth_tx_adapter *adapter;
+	struct rte_event_eth_tx_adapter_stats *dev_stats;
+	uint16_t i;
+
+	RTE_EVENT_ETH_TX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_tx_adapter(id);
+	if (adapter == NULL || stats == NULL)
+		return -EINVAL;
+
+	memset(stats, 0, sizeof(*stats));
+	rte_spinlock_lock(&adapter->lock);
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
+		dev_stats = &adapter->txa_ethdev[i].stats;
+		stats->tx_retry += dev_stats->tx_retry;
+		stats->tx_packets += dev_stats->tx_packets;
+		stats->tx_dropped += dev_stats->tx_dropped;
+	}
+	stats->tx_dropped += adapter->tx_dropped;
+	rte_spinlock_unlock(&adapter->lock);
+	return 0;
+}
+
+int
+rte_event_eth_tx_adapter_port_stats_get(uint8_t id, uint16_t eth_dev_id,
+				struct rte_event_eth_tx_adapter_stats *stats)
+{
+	struct rte_event_eth_tx_adapter *adapter;
+
+	RTE_EVENT_ETH_TX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_tx_adapter(id);
+	if (adapter == NULL || eth_dev_id >= RTE_MAX_ETHPORTS ||
+			stats == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&adapter->lock);
+	*stats = adapter->txa_ethdev[eth_dev_id].stats;
+	rte_spinlock_unlock(&adapter->lock);
+	return 0;
+}
+
+int
+rte_event_eth_tx_adapter_stats_reset(uint8_t id)
+{
+	struct rte_event_eth_tx_adapter *adapter;
+	uint16_t i;
+
+	RTE_EVENT_ETH_TX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_tx_adapter(id);
+	if (adapter == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&adapter->lock);
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++)
+		memset(&adapter->txa_ethdev[i].stats, 0,
+			sizeof(adapter->txa_ethdev[i].stats));
+	adapter->tx_dropped = 0;
+	rte_spinlock_unlock(&adapter->lock);
+	return 0;
+}
+
+int
+rte_event_eth_tx_adapter_service_id_get(uint8_t id, uint32_t *service_id)
+{
+	struct rte_event_eth_tx_adapter *adapter;
+
+	RTE_EVENT_ETH_TX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_tx_adapter(id);
+	if (adapter == NULL || service_id == NULL)
+		return -EINVAL;
+
+	*service_id = adapter->service_id;
+	return 0;
+}
+
+int
+rte_event_eth_tx_adapter_event_port_get(uint8_t id, uint8_t *event_port_id)
+{
+	struct rte_event_eth_tx_adapter *adapter;
+
+	RTE_EVENT_ETH_TX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_tx_adapter(id);
+	if (adapter == NULL || event_port_id == NULL)
+		return -EINVAL;
+
+	*event_port_id = adapter->event_port_id;
+	return 0;
+}
@@ -0,0 +1,698 @@
+/*
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_cycles.h>
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_memzone.h>
+#include <rte_service_component.h>
+#include <rte_spinlock.h>
+
+#include "rte_eventdev.h"
+#include "rte_eventdev_pmd.h"
+#include "rte_event_timer_adapter.h"
+
+#define TIMER_EVENT_BUFFER_SIZE		128
+#define TIMER_WHEEL_MAX_SLOTS		(1 << 18)
+
+#define TIMER_ADAPTER_SERVICE_NAME_LEN	32
+#define TIMER_ADAPTER_MEM_NAME_LEN	32
+
+#define NSEC_PER_SEC			1000000000ULL
+
+/*
+ * Links an armed timer in its wheel slot, overlaid on the impl_opaque
+ * field of the timer. The slots are singly linked lists, and pprev points
+ * to the pointer that references the timer so it can be unlinked in O(1).
+ */
+struct timer_entry {
+	struct rte_event_timer *next;
+	struct rte_event_timer **pprev;
+	uint64_t expiry;	/* Expiry tick */
+};
+
+#define TIMER_ENTRY(t) ((struct timer_entry *)(t)->impl_opaque)
+
+/* Events of expired timers waiting to be enqueued */
+struct timer_event_buffer {
+	/* Count of events in this buffer */
+	uint16_t count;
+	/* Array of events in this buffer */
+	struct rte_event events[TIMER_EVENT_BUFFER_SIZE];
+};
+
+struct rte_event_timer_adapter {
+	/* Lock to serialize timer arm/cancel with the service function */
+	rte_spinlock_t lock;
+	/* Timing wheel, a list of timers per slot */
+	struct rte_event_timer **wheel;
+	/* Number of wheel slots - 1 */
+	uint64_t wheel_mask;
+	/* Next tick to be processed by the service function */
+	uint64_t cur_tick;
+	/* Timer cycles at tick 0 */
+	uint64_t start_cycles;
+	/* Timer cycles per tick */
+	uint64_t cycles_per_tick;
+	/* Max timeout in ticks */
+	uint64_t max_tmo_ticks;
+	/* Count of armed timers */
+	uint64_t nb_armed;
+	/* Max count of armed timers */
+	uint64_t nb_timers;
+	/* Event device identifier */
+	uint8_t eventdev_id;
+	/* Event port identifier */
+	uint8_t event_port_id;
+	/* Event burst buffer */
+	struct timer_event_buffer event_buffer;
+	/* Per adapter stats */
+	struct rte_event_timer_adapter_stats stats;
+	/* Configuration callback argument */
+	void *conf_arg;
+	/* Set if default_cb is being used */
+	int default_cb_arg;
+	/* Memory allocation name */
+	char mem_name[TIMER_ADAPTER_MEM_NAME_LEN];
+	/* Socket identifier cached from eventdev */
+	int socket_id;
+	/* Per adapter EAL service */
+	uint32_t service_id;
+} __rte_cache_aligned;
+
+static struct rte_event_timer_adapter **event_timer_adapter;
+
+static inline int
+valid_id(uint8_t id)
+{
+	return id < RTE_EVENT_TIMER_ADAPTER_MAX_INSTANCE;
+}
+
+#define RTE_EVENT_TIMER_ADAPTER_ID_VALID_OR_ERR_RET(id, retval) do { \
+	if (!valid_id(id)) { \
+		RTE_EDEV_LOG_ERR("Invalid timer adapter id = %d\n", id); \
+		return retval; \
+	} \
+} while (0)
+
+static inline struct rte_event_timer_adapter *
+id_to_timer_adapter(uint8_t id)
+{
+	return event_timer_adapter ?
+		event_timer_adapter[id] : NULL;
+}
+
+/* Current tick of the adapter clock */
+static inline uint64_t
+timer_adapter_tick(const struct rte_event_timer_adapter *adapter)
+{
+	return (rte_get_timer_cycles() - adapter->start_cycles) /
+		adapter->cycles_per_tick;
+}
+
+static inline void
+wheel_insert(struct rte_event_timer_adapter *adapter,
+	struct rte_event_timer *tim, uint64_t expiry)
+{
+	struct timer_entry *e = TIMER_ENTRY(tim);
+	struct rte_event_timer **slot;
+
+	slot = &adapter->wheel[expiry & adapter->wheel_mask];
+	e->expiry = expiry;
+	e->next = *slot;
+	e->pprev = slot;
+	if (*slot != NULL)
+		TIMER_ENTRY(*slot)->pprev = &e->next;
+	*slot = tim;
+}
+
+static inline void
+wheel_remove(struct rte_event_timer *tim)
+{
+	struct timer_entry *e = TIMER_ENTRY(tim);
+
+	*e->pprev = e->next;
+	if (e->next != NULL)
+		TIMER_ENTRY(e->next)->pprev = e->pprev;
+}
+
+/* Enqueue buffered events to event device */
+static inline uint16_t
+flush_event_buffer(struct rte_event_timer_adapter *adapter)
+{
+	struct timer_event_buffer *buf = &adapter->event_buffer;
+	struct rte_event_timer_adapter_stats *stats = &adapter->stats;
+
+	uint16_t n = rte_event_enqueue_new_burst(adapter->eventdev_id,
+					adapter->event_port_id,
+					buf->events,
+					buf->count);
+	if (n != buf->count) {
+		memmove(buf->events,
+			&buf->events[n],
+			(buf->count - n) * sizeof(struct rte_event));
+		stats->ev_enq_retry++;
+	}
+
+	buf->count -= n;
+	stats->ev_enq_count += n;
+
+	return n;
+}
+
+/*
+ * Expire the timers of the ticks that are over, i.e. the ticks before
+ * *now*, so that a timer never expires before its timeout. A slot holds
+ * the timers of all the ticks equal to its index modulo the number of
+ * slots, so only the timers whose expiry tick is over are removed. If the
+ * service function is late by more than a wheel turn, each slot is only
+ * visited once.
+ *
+ * If the event device back pressures the adapter, the remaining expired
+ * timers are left in the wheel until the next call.
+ */
+static void
+timer_wheel_expire(struct rte_event_timer_adapter *adapter, uint64_t now)
+{
+	struct timer_event_buffer *buf = &adapter->event_buffer;
+	struct rte_event_timer_adapter_stats *stats = &adapter->stats;
+	struct rte_event_timer *tim, *next;
+	struct rte_event *ev;
+	uint64_t nb_ticks, i;
+
+	if (adapter->cur_tick >= now)
+		return;
+
+	nb_ticks = RTE_MIN(now - adapter->cur_tick, adapter->wheel_mask + 1);
+	for (i = 0; i < nb_ticks; i++) {
+		tim = adapter->wheel[(adapter->cur_tick + i) &
+			adapter->wheel_mask];
+		for (; tim != NULL; tim = next) {
+			next = TIMER_ENTRY(tim)->next;
+			if (TIMER_ENTRY(tim)->expiry >= now)
+				continue;
+
+			if (buf->count == TIMER_EVENT_BUFFER_SIZE &&
+					flush_event_buffer(adapter) == 0) {
+				adapter->cur_tick += i;
+				stats->adapter_tick_count += i;
+				return;
+			}
+
+			wheel_remove(tim);
+			tim->state = RTE_EVENT_TIMER_NOT_ARMED;
+			adapter->nb_armed--;
+			stats->evtim_exp_count++;
+
+			ev = &buf->events[buf->count++];
+			*ev = tim->ev;
+			ev->op = RTE_EVENT_OP_NEW;
+			ev->event_type = RTE_EVENT_TYPE_TIMER;
+			ev->event_ptr = tim;
+		}
+	}
+
+	stats->adapter_tick_count += now - adapter->cur_tick;
+	adapter->cur_tick = now;
+}
+
+static int
+event_timer_adapter_service_func(void *args)
+{
+	struct rte_event_timer_adapter *adapter = args;
+
+	if (rte_spinlock_trylock(&adapter->lock) == 0)
+		return 0;
+	timer_wheel_expire(adapter, timer_adapter_tick(adapter));
+	if (adapter->event_buffer.count)
+		flush_event_buffer(adapter);
+	rte_spinlock_unlock(&adapter->lock);
+	return 0;
+}
+
+static int
+rte_event_timer_adapter_init(void)
+{
+	const char *name = "rte_event_timer_adapter_array";
+	const struct rte_memzone *mz;
+	unsigned int sz;
+
+	sz = sizeof(*event_timer_adapter) *
+	    RTE_EVENT_TIMER_ADAPTER_MAX_INSTANCE;
+	sz = RTE_ALIGN(sz, RTE_CACHE_LINE_SIZE);
+
+	mz = rte_memzone_lookup(name);
+	if (mz == NULL) {
+		mz = rte_memzone_reserve_aligned(name, sz, rte_socket_id(), 0,
+						 RTE_CACHE_LINE_SIZE);
+		if (mz == NULL) {
+			RTE_EDEV_LOG_ERR("failed to reserve memzone err = %"
+					PRId32, rte_errno);
+			return -rte_errno;
+		}
+	}
+
+	event_timer_adapter = mz->addr;
+	return 0;
+}
+
+static int
+default_port_conf_cb(uint8_t id, uint8_t dev_id, uint8_t *event_port_id,
+		void *arg)
+{
+	int ret;
+	struct rte_eventdev *dev;
+	struct rte_event_dev_config dev_conf;
+	int started;
+	uint8_t port_id;
+	struct rte_event_port_conf *port_conf = arg;
+
+	RTE_SET_USED(id);
+
+	dev = &rte_eventdevs[dev_id];
+	dev_conf = dev->data->dev_conf;
+
+	started = dev->data->dev_started;
+	if (started)
+		rte_event_dev_stop(dev_id);
+	port_id = dev_conf.nb_event_ports;
+	dev_conf.nb_event_ports += 1;
+	ret = rte_event_dev_configure(dev_id, &dev_conf);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("failed to configure event dev %u\n",
+						dev_id);
+		if (started)
+			rte_event_dev_start(dev_id);
+		return ret;
+	}
+
+	ret = rte_event_port_setup(dev_id, port_id, port_conf);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("failed to setup event port %u\n",
+					port_id);
+		return ret;
+	}
+
+	*event_port_id = port_id;
+	if (started)
+		rte_event_dev_start(dev_id);
+	return ret;
+}
+
+static int
+init_service(struct rte_event_timer_adapter *adapter, uint8_t id)
+{
+	int ret;
+	struct rte_service_spec service;
+
+	memset(&service, 0, sizeof(service));
+	snprintf(service.name, TIMER_ADAPTER_SERVICE_NAME_LEN,
+		"rte_event_timer_adapter_%d", id);
+	service.socket_id = adapter->socket_id;
+	service.callback = event_timer_adapter_service_func;
+	service.callback_userdata = adapter;
+	/* Service function handles locking for timer arm/cancel */
+	service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
+	ret = rte_service_component_register(&service, &adapter->service_id);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("failed to register service %s err = %" PRId32,
+			service.name, ret);
+		return ret;
+	}
+
+	rte_service_component_runstate_set(adapter->service_id, 1);
+	return 0;
+}
+
+int
+rte_event_timer_adapter_create_ext(uint8_t id, uint8_t dev_id,
+				const struct rte_event_timer_adapter_conf *conf,
+				rte_event_timer_adapter_port_conf_cb conf_cb,
+				void *conf_arg)
+{
+	struct rte_event_timer_adapter *adapter;
+	char mem_name[TIMER_ADAPTER_MEM_NAME_LEN];
+	uint64_t cycles_per_tick, max_tmo_ticks, nb_slots;
+	double tick_cycles;
+	int socket_id;
+	int ret;
+
+	RTE_BUILD_BUG_ON(sizeof(struct timer_entry) >
+		sizeof(((struct rte_event_timer *)0)->impl_opaque));
+
+	RTE_EVENT_TIMER_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	if (conf == NULL || conf_cb == NULL || conf->timer_tick_ns == 0 ||
+			conf->nb_timers == 0)
+		return -EINVAL;
+
+	/* Rounded up so that a timer never expires before its timeout */
+	tick_cycles = (double)conf->timer_tick_ns * rte_get_timer_hz() /
+			NSEC_PER_SEC;
+	cycles_per_tick = (uint64_t)tick_cycles;
+	if (tick_cycles > cycles_per_tick)
+		cycles_per_tick++;
+	max_tmo_ticks = conf->max_tmo_ns / conf->timer_tick_ns;
+	if (cycles_per_tick == 0 || max_tmo_ticks == 0) {
+		RTE_EDEV_LOG_ERR("Invalid timer resolution %" PRIu64
+			" ns or max timeout %" PRIu64 " ns",
+			conf->timer_tick_ns, conf->max_tmo_ns);
+		return -EINVAL;
+	}
+
+	if (event_timer_adapter == NULL) {
+		ret = rte_event_timer_adapter_init();
+		if (ret)
+			return ret;
+	}
+
+	adapter = id_to_timer_adapter(id);
+	if (adapter != NULL) {
+		RTE_EDEV_LOG_ERR("Timer adapter exists id = %" PRIu8, id);
+		return -EEXIST;
+	}
+
+	socket_id = rte_event_dev_socket_id(dev_id);
+	snprintf(mem_name, TIMER_ADAPTER_MEM_NAME_LEN,
+		"rte_event_timer_adapter_%d", id);
+
+	adapter = rte_zmalloc_socket(mem_name, sizeof(*adapter),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (adapter == NULL) {
+		RTE_EDEV_LOG_ERR("failed to get mem for timer adapter");
+		return -ENOMEM;
+	}
+
+	/*
+	 * One slot per tick up to the max timeout, the timers of a slot
+	 * are then all due when the slot is visited. Beyond the max
+	 * number of slots, a slot holds timers of several wheel turns.
+	 */
+	nb_slots = rte_align64pow2(RTE_MIN(max_tmo_ticks + 1,
+			(uint64_t)TIMER_WHEEL_MAX_SLOTS));
+	adapter->wheel = rte_zmalloc_socket(mem_name,
+			nb_slots * sizeof(*adapter->wheel),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (adapter->wheel == NULL) {
+		RTE_EDEV_LOG_ERR("failed to get mem for timer wheel");
+		rte_free(adapter);
+		return -ENOMEM;
+	}
+
+	adapter->wheel_mask = nb_slots - 1;
+	adapter->cycles_per_tick = cycles_per_tick;
+	adapter->max_tmo_ticks = max_tmo_ticks;
+	adapter->nb_timers = conf->nb_timers;
+	adapter->eventdev_id = dev_id;
+	adapter->socket_id = socket_id;
+	adapter->conf_arg = conf_arg;
+	adapter->default_cb_arg = conf_cb == default_port_conf_cb;
+	strcpy(adapter->mem_name, mem_name);
+	rte_spinlock_init(&adapter->lock);
+
+	ret = conf_cb(id, dev_id, &adapter->event_port_id, conf_arg);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("configuration callback failed err = %" PRId32,
+			ret);
+		goto err_free;
+	}
+
+	ret = init_service(adapter, id);
+	if (ret)
+		goto err_free;
+
+	adapter->start_cycles = rte_get_timer_cycles();
+	event_timer_adapter[id] = adapter;
+	return 0;
+
+err_free:
+	rte_free(adapter->wheel);
+	rte_free(adapter);
+	return ret;
+}
+
+int
+rte_event_timer_adapter_create(uint8_t id, uint8_t dev_id,
+		const struct rte_event_timer_adapter_conf *conf,
+		struct rte_event_port_conf *port_config)
+{
+	struct rte_event_port_conf *pc;
+	int ret;
+
+	if (port_config == NULL)
+		return -EINVAL;
+	RTE_EVENT_TIMER_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	pc = rte_malloc(NULL, sizeof(*pc), 0);
+	if (pc == NULL)
+		return -ENOMEM;
+	*pc = *port_config;
+	ret = rte_event_timer_adapter_create_ext(id, dev_id, conf,
+					default_port_conf_cb,
+					pc);
+	if (ret)
+		rte_free(pc);
+	return ret;
+}
+
+int
+rte_event_timer_adapter_free(uint8_t id)
+{
+	struct rte_event_timer_adapter *adapter;
+
+	RTE_EVENT_TIMER_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_timer_adapter(id);
+	if (adapter == NULL)
+		return -EINVAL;
+
+	if (adapter->nb_armed) {
+		RTE_EDEV_LOG_ERR("%" PRIu64 " timers still armed",
+				adapter->nb_armed);
+		return -EBUSY;
+	}
+
+	rte_service_component_runstate_set(adapter->service_id, 0);
+	rte_service_component_unregister(adapter->service_id);
+	if (adapter->default_cb_arg)
+		rte_free(adapter->conf_arg);
+	rte_free(adapter->wheel);
+	rte_free(adapter);
+	event_timer_adapter[id] = NULL;
+
+	return 0;
+}
+
+static int
+timer_adapter_ctrl(uint8_t id, int start)
+{
+	struct rte_event_timer_adapter *adapter;
+
+	RTE_EVENT_TIMER_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+	adapter = id_to_timer_adapter(id);
+	if (adapter == NULL)
+		return -EINVAL;
+
+	return rte_service_runstate_set(adapter->service_id, start);
+}
+
+int
+rte_event_timer_adapter_start(uint8_t id)
+{
+	return timer_adapter_ctrl(id, 1);
+}
+
+int
+rte_event_timer_adapter_stop(uint8_t id)
+{
+	return timer_adapter_ctrl(id, 0);
+}
+
+int
+rte_event_timer_adapter_service_id_get(uint8_t id, uint32_t *service_id)
+{
+	struct rte_event_timer_adapter *adapter;
+
+	RTE_EVENT_TIMER_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_timer_adapter(id);
+	if (adapter == NULL || service_id == NULL)
+		return -EINVAL;
+
+	*service_id = adapter->service_id;
+	return 0;
+}
+
+int
+rte_event_timer_adapter_stats_get(uint8_t id,
+			struct rte_event_timer_adapter_stats *stats)
+{
+	struct rte_event_timer_adapter *adapter;
+
+	RTE_EVENT_TIMER_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_timer_adapter(id);
+	if (adapter == NULL || stats == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&adapter->lock);
+	*stats = adapter->stats;
+	rte_spinlock_unlock(&adapter->lock);
+	return 0;
+}
+
+int
+rte_event_timer_adapter_stats_reset(uint8_t id)
+{
+	struct rte_event_timer_adapter *adapter;
+
+	RTE_EVENT_TIMER_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = id_to_timer_adapter(id);
+	if (adapter == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&adapter->lock);
+	memset(&adapter->stats, 0, sizeof(adapter->stats));
+	rte_spinlock_unlock(&adapter->lock);
+	return 0;
+}
+
+uint16_t
+rte_event_timer_arm_burst(uint8_t id, struct rte_event_timer **timers,
+		uint16_t nb_timers)
+{
+	struct rte_event_timer_adapter *adapter;
+	struct rte_event_timer *tim;
+	uint64_t now;
+	uint16_t i;
+
+	adapter = valid_id(id) ? id_to_timer_adapter(id) : NULL;
+	if (adapter == NULL || timers == NULL) {
+		rte_errno = EINVAL;
+		return 0;
+	}
+
+	rte_spinlock_lock(&adapter->lock);
+
+	/*
+	 * The service function may have processed the current tick, the
+	 * expiry tick must not be before the next tick it processes.
+	 */
+	now = RTE_MAX(timer_adapter_tick(adapter), adapter->cur_tick);
+
+	for (i = 0; i < nb_timers; i++) {
+		tim = timers[i];
+		if (unlikely(tim->state == RTE_EVENT_TIMER_ARMED)) {
+			rte_errno = EALREADY;
+			break;
+		}
+		if (unlikely(tim->timeout_ticks == 0)) {
+			tim->state = RTE_EVENT_TIMER_ERROR_TOOEARLY;
+			rte_errno = EINVAL;
+			break;
+		}
+		if (unlikely(tim->timeout_ticks > adapter->max_tmo_ticks)) {
+			tim->state = RTE_EVENT_TIMER_ERROR_TOOLATE;
+			rte_errno = EINVAL;
+			break;
+		}
+		if (unlikely(adapter->nb_armed == adapter->nb_timers)) {
+			rte_errno = ENOSPC;
+			break;
+		}
+
+		wheel_insert(adapter, tim, now + tim->timeout_ticks);
+		tim->state = RTE_EVENT_TIMER_ARMED;
+		adapter->nb_armed++;
+	}
+	adapter->stats.evtim_arm_count += i;
+
+	rte_spinlock_unlock(&adapter->lock);
+	return i;
+}
+
+uint16_t
+rte_event_timer_arm_tmo_tick_burst(uint8_t id,
+		struct rte_event_timer **timers, uint64_t timeout_ticks,
+		uint16_t nb_timers)
+{
+	uint16_t i;
+
+	if (timers == NULL) {
+		rte_errno = EINVAL;
+		return 0;
+	}
+
+	for (i = 0; i < nb_timers; i++)
+		timers[i]->timeout_ticks = timeout_ticks;
+
+	return rte_event_timer_arm_burst(id, timers, nb_timers);
+}
+
+uint16_t
+rte_event_timer_cancel_burst(uint8_t id, struct rte_event_timer **timers,
+		uint16_t nb_timers)
+{
+	struct rte_event_timer_adapter *adapter;
+	struct rte_event_timer *tim;
+	uint16_t i;
+
+	adapter = valid_id(id) ? id_to_timer_adapter(id) : NULL;
+	if (adapter == NULL || timers == NULL) {
+		rte_errno = EINVAL;
+		return 0;
+	}
+
+	rte_spinlock_lock(&adapter->lock);
+
+	for (i = 0; i < nb_timers; i++) {
+		tim = timers[i];
+		if (unlikely(tim->state != RTE_EVENT_TIMER_ARMED)) {
+			rte_errno = tim->state == RTE_EVENT_TIMER_CANCELED ?
+				EALREADY : EINVAL;
+			break;
+		}
+
+		wheel_remove(tim);
+		tim->state = RTE_EVENT_TIMER_CANCELED;
+	}
+	adapter->nb_armed -= i;
+	adapter->stats.evtim_cancel_count += i;
+
+	rte_spinlock_unlock(&adapter->lock);
+	return i;
+}
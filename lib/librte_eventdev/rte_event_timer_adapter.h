@@ -0,0 +1,459 @@
+/*
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_EVENT_TIMER_ADAPTER_
+#define _RTE_EVENT_TIMER_ADAPTER_
+
+/**
+ * @file
+ *
+ * RTE Event Timer Adapter
+ *
+ * An event timer adapter delivers the expiry of timers as events: when an
+ * armed event timer expires, the adapter enqueues the event held by the
+ * timer to the event queue selected by the application. Timer expiry is
+ * then scheduled like any other event, e.g. flow aging or retransmission
+ * timers of a flow can be processed in the atomic context of that flow.
+ *
+ * The adapter uses an EAL service core function which runs a hashed timing
+ * wheel: each timer is linked, through memory inside the timer itself, in
+ * the wheel slot of its expiry tick, so arming and cancelling a timer is
+ * O(1) and the adapter allocates nothing per timer. The service function
+ * walks the slots of the ticks elapsed since its previous run and enqueues
+ * the events of the expired timers to the event device.
+ *
+ * The event timer adapter's functions are:
+ *  - rte_event_timer_adapter_create_ext()
+ *  - rte_event_timer_adapter_create()
+ *  - rte_event_timer_adapter_free()
+ *  - rte_event_timer_adapter_start()
+ *  - rte_event_timer_adapter_stop()
+ *  - rte_event_timer_adapter_service_id_get()
+ *  - rte_event_timer_adapter_stats_get()
+ *  - rte_event_timer_adapter_stats_reset()
+ *  - rte_event_timer_arm_burst()
+ *  - rte_event_timer_arm_tmo_tick_burst()
+ *  - rte_event_timer_cancel_burst()
+ *
+ * The application creates an adapter with a timer resolution, a maximum
+ * timeout and a maximum number of armed timers, using
+ * rte_event_timer_adapter_create_ext() or rte_event_timer_adapter_create().
+ * It then starts the adapter and assigns a service core to the service
+ * function of the adapter, whose ID is returned by
+ * rte_event_timer_adapter_service_id_get().
+ *
+ * Timeouts are expressed in adapter ticks of timer_tick_ns nanoseconds. The
+ * adapter clock starts when the adapter is created and doesn't stop with the
+ * adapter: timers which expire while the adapter is stopped are delivered
+ * when it is started again. A timer expires no earlier than its timeout
+ * after it is armed, and at most one tick plus the service function
+ * latency later.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include <rte_service.h>
+
+#include "rte_eventdev.h"
+
+#define RTE_EVENT_TIMER_ADAPTER_MAX_INSTANCE 32
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Event timer adapter configuration structure
+ */
+struct rte_event_timer_adapter_conf {
+	uint64_t timer_tick_ns;
+	/**< Timer resolution, i.e. duration of an adapter tick, in
+	 * nanoseconds.
+	 */
+	uint64_t max_tmo_ns;
+	/**< Maximum timeout of a timer in nanoseconds. */
+	uint64_t nb_timers;
+	/**< Maximum number of timers armed at the same time. */
+	uint64_t flags;
+	/**< Adapter flags, none defined yet. */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Function type used for the event port configuration callback, invoked
+ * when creating the adapter, to get the event port the adapter enqueues
+ * timer expiry events to.
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @param dev_id
+ *  Event device identifier.
+ *
+ * @param [out] event_port_id
+ *  Event port identifier, to be filled in by the callback.
+ *
+ * @param arg
+ *  Argument to the callback. This is the same as the conf_arg passed to the
+ *  rte_event_timer_adapter_create_ext().
+ */
+typedef int (*rte_event_timer_adapter_port_conf_cb) (uint8_t id,
+			uint8_t dev_id, uint8_t *event_port_id, void *arg);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Event timer states
+ */
+enum rte_event_timer_state {
+	RTE_EVENT_TIMER_NOT_ARMED = 0,
+	/**< Timer is not armed, or it has expired. */
+	RTE_EVENT_TIMER_ARMED = 1,
+	/**< Timer is armed. */
+	RTE_EVENT_TIMER_CANCELED = 2,
+	/**< Timer was canceled before it expired. */
+	RTE_EVENT_TIMER_ERROR_TOOEARLY = -1,
+	/**< Arming failed, the timeout is zero. */
+	RTE_EVENT_TIMER_ERROR_TOOLATE = -2,
+	/**< Arming failed, the timeout exceeds the maximum timeout of the
+	 * adapter.
+	 */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Event timer. The memory of an event timer is owned by the application,
+ * and must remain valid while the timer is armed and until its expiry
+ * event has been dequeued.
+ */
+struct rte_event_timer {
+	struct rte_event ev;
+	/**<
+	 * Event enqueued to the event device when the timer expires. The
+	 * application sets the following fields:
+	 *  - queue_id: Targeted event queue.
+	 *  - sched_type: Scheduling type of the event.
+	 *  - priority: Event priority.
+	 *  - flow_id, sub_event_type: Passed through.
+	 *
+	 * The adapter sets ev.op to RTE_EVENT_OP_NEW, ev.event_type to
+	 * RTE_EVENT_TYPE_TIMER and ev.event_ptr to the expired timer in the
+	 * enqueued event.
+	 */
+	volatile enum rte_event_timer_state state;
+	/**< State of the timer, set by the adapter. */
+	uint64_t timeout_ticks;
+	/**< Timeout in adapter ticks, relative to the time the timer is
+	 * armed.
+	 */
+	uint64_t impl_opaque[3];
+	/**< Implementation-specific data, links the timer in the adapter. */
+	uint8_t user_meta[0];
+	/**< Memory available to the application. */
+} __rte_cache_aligned;
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * A structure used to retrieve statistics for an event timer adapter
+ * instance.
+ */
+struct rte_event_timer_adapter_stats {
+	uint64_t adapter_tick_count;
+	/**< Number of ticks processed by the service function */
+	uint64_t evtim_arm_count;
+	/**< Number of timers armed */
+	uint64_t evtim_cancel_count;
+	/**< Number of timers canceled */
+	uint64_t evtim_exp_count;
+	/**< Number of timers expired */
+	uint64_t ev_enq_count;
+	/**< Eventdev enqueue count */
+	uint64_t ev_enq_retry;
+	/**< Eventdev enqueue retry count */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Create a new event timer adapter with the specified identifier.
+ *
+ * @param id
+ *  The identifier of the event timer adapter.
+ *
+ * @param dev_id
+ *  The identifier of the event device the adapter enqueues events to.
+ *
+ * @param conf
+ *  Timer configuration of the adapter.
+ *
+ * @param conf_cb
+ *  Callback function that returns the event port used by the adapter.
+ *
+ * @param conf_arg
+ *  Argument that is passed to the conf_cb function.
+ *
+ * @return
+ *   - 0: Success
+ *   - <0: Error code on failure
+ */
+int rte_event_timer_adapter_create_ext(uint8_t id, uint8_t dev_id,
+				const struct rte_event_timer_adapter_conf *conf,
+				rte_event_timer_adapter_port_conf_cb conf_cb,
+				void *conf_arg);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Create a new event timer adapter with the specified identifier.
+ * This function uses an internal configuration function that reconfigures
+ * the event device with an additional event port, and sets up the event
+ * port using the port_config parameter passed into this function. In case
+ * the application needs more control of the event port, it should use the
+ * rte_event_timer_adapter_create_ext() version.
+ *
+ * @param id
+ *  The identifier of the event timer adapter.
+ *
+ * @param dev_id
+ *  The identifier of the event device the adapter enqueues events to.
+ *
+ * @param conf
+ *  Timer configuration of the adapter.
+ *
+ * @param port_config
+ *  Configuration of the event port created for the adapter.
+ *
+ * @return
+ *   - 0: Success
+ *   - <0: Error code on failure
+ */
+int rte_event_timer_adapter_create(uint8_t id, uint8_t dev_id,
+				const struct rte_event_timer_adapter_conf *conf,
+				struct rte_event_port_conf *port_config);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Free an event timer adapter
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @return
+ *   - 0: Success
+ *   - <0: Error code on failure, If the adapter still has armed timers,
+ *      the function returns -EBUSY.
+ */
+int rte_event_timer_adapter_free(uint8_t id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Start an event timer adapter
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @return
+ *  - 0: Success, Adapter started correctly.
+ *  - <0: Error code on failure.
+ */
+int rte_event_timer_adapter_start(uint8_t id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Stop an event timer adapter. Armed timers stay armed, and the ones that
+ * expire while the adapter is stopped are delivered once it is started.
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @return
+ *  - 0: Success, Adapter stopped correctly.
+ *  - <0: Error code on failure.
+ */
+int rte_event_timer_adapter_stop(uint8_t id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Retrieve the service ID of an adapter.
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @param [out] service_id
+ *  A pointer to a uint32_t, to be filled in with the service id.
+ *
+ * @return
+ *  - 0: Success
+ *  - <0: Error code on failure.
+ */
+int rte_event_timer_adapter_service_id_get(uint8_t id, uint32_t *service_id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Retrieve statistics for an adapter
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @param [out] stats
+ *  A pointer to structure used to retrieve statistics for an adapter.
+ *
+ * @return
+ *  - 0: Success, retrieved successfully.
+ *  - <0: Error code on failure.
+ */
+int rte_event_timer_adapter_stats_get(uint8_t id,
+				struct rte_event_timer_adapter_stats *stats);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Reset statistics for an adapter.
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @return
+ *  - 0: Success, statistics reset successfully.
+ *  - <0: Error code on failure.
+ */
+int rte_event_timer_adapter_stats_reset(uint8_t id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Arm a burst of event timers, each with its own timeout_ticks. A timer
+ * can be armed again once it has expired or has been canceled.
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @param timers
+ *  Pointer to an array of event timers to arm.
+ *
+ * @param nb_timers
+ *  Number of event timers in the array.
+ *
+ * @return
+ *  The number of timers armed, which are the first ones of the array. If
+ *  it is less than nb_timers, rte_errno is set and the state of the first
+ *  timer that wasn't armed may be updated:
+ *  - EINVAL: Invalid adapter identifier, or invalid timeout of the timer,
+ *    whose state is set to RTE_EVENT_TIMER_ERROR_TOOEARLY or
+ *    RTE_EVENT_TIMER_ERROR_TOOLATE.
+ *  - EALREADY: The timer is already armed.
+ *  - ENOSPC: The maximum number of armed timers is reached.
+ */
+uint16_t rte_event_timer_arm_burst(uint8_t id,
+				struct rte_event_timer **timers,
+				uint16_t nb_timers);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Arm a burst of event timers with the same timeout, which is written to
+ * the timeout_ticks field of each timer.
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @param timers
+ *  Pointer to an array of event timers to arm.
+ *
+ * @param timeout_ticks
+ *  Timeout of the timers in adapter ticks.
+ *
+ * @param nb_timers
+ *  Number of event timers in the array.
+ *
+ * @return
+ *  The number of timers armed, as rte_event_timer_arm_burst().
+ */
+uint16_t rte_event_timer_arm_tmo_tick_burst(uint8_t id,
+				struct rte_event_timer **timers,
+				uint64_t timeout_ticks,
+				uint16_t nb_timers);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Cancel a burst of armed event timers. The expiry events of canceled
+ * timers are not enqueued.
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @param timers
+ *  Pointer to an array of event timers to cancel.
+ *
+ * @param nb_timers
+ *  Number of event timers in the array.
+ *
+ * @return
+ *  The number of timers canceled, which are the first ones of the array.
+ *  If it is less than nb_timers, rte_errno is set:
+ *  - EINVAL: Invalid adapter identifier, or the timer is not armed.
+ *  - EALREADY: The timer is already canceled.
+ */
+uint16_t rte_event_timer_cancel_burst(uint8_t id,
+				struct rte_event_timer **timers,
+				uint16_t nb_timers);
+
+#ifdef __cplusplus
+}
+#endif
+#endif	/* _RTE_EVENT_TIMER_ADAPTER_ */
@@ -0,0 +1,112 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_malloc.h>
+
+#include "gro_flow_index.h"
+
+void
+gro_flow_index_init(struct gro_flow_index *idx,
+		uint32_t *buckets,
+		uint32_t nb_buckets,
+		struct gro_flow_key_link *keys,
+		uint32_t nb_keys,
+		struct gro_flow_item_link *items,
+		uint32_t nb_items)
+{
+	uint32_t i;
+
+	idx->buckets = buckets;
+	idx->keys = keys;
+	idx->items = items;
+	idx->bucket_mask = nb_buckets - 1;
+
+	for (i = 0; i < nb_buckets; i++)
+		buckets[i] = INVALID_ARRAY_INDEX;
+
+	/* chain all keys and items in the free lists */
+	for (i = 0; i < nb_keys; i++)
+		keys[i].next = (i + 1 < nb_keys) ? i + 1 : INVALID_ARRAY_INDEX;
+	idx->free_key = (nb_keys > 0) ? 0 : INVALID_ARRAY_INDEX;
+
+	for (i = 0; i < nb_items; i++)
+		items[i].next = (i + 1 < nb_items) ?
+			i + 1 : INVALID_ARRAY_INDEX;
+	idx->free_item = (nb_items > 0) ? 0 : INVALID_ARRAY_INDEX;
+
+	idx->age_head = INVALID_ARRAY_INDEX;
+	idx->age_tail = INVALID_ARRAY_INDEX;
+}
+
+int
+gro_flow_index_create(struct gro_flow_index *idx,
+		uint16_t socket_id,
+		uint32_t nb_keys,
+		uint32_t nb_items)
+{
+	size_t buckets_size, keys_size, items_size;
+	uint32_t nb_buckets;
+	uint8_t *mem;
+
+	nb_buckets = rte_align32pow2(nb_keys);
+	buckets_size = RTE_ALIGN_CEIL(sizeof(uint32_t) * nb_buckets,
+			RTE_CACHE_LINE_SIZE);
+	keys_size = RTE_ALIGN_CEIL(sizeof(struct gro_flow_key_link) *
+			nb_keys, RTE_CACHE_LINE_SIZE);
+	items_size = sizeof(struct gro_flow_item_link) * nb_items;
+
+	/* the bucket array comes first, on its own cache lines */
+	mem = rte_malloc_socket(__func__,
+			buckets_size + keys_size + items_size,
+			RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (mem == NULL)
+		return -ENOMEM;
+
+	gro_flow_index_init(idx, (uint32_t *)mem, nb_buckets,
+			(struct gro_flow_key_link *)(mem + buckets_size),
+			nb_keys,
+			(struct gro_flow_item_link *)(mem + buckets_size +
+				keys_size),
+			nb_items);
+	return 0;
+}
+
+void
+gro_flow_index_destroy(struct gro_flow_index *idx)
+{
+	rte_free(idx->buckets);
+	idx->buckets = NULL;
+}
@@ -0,0 +1,243 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GRO_FLOW_INDEX_H_
+#define _GRO_FLOW_INDEX_H_
+
+#include <stdint.h>
+
+#include <rte_common.h>
+
+#define INVALID_ARRAY_INDEX 0xffffffffUL
+
+/*
+ * The flow index is shared by the reassembly tables to avoid linear
+ * scans of their key and item arrays. It keeps:
+ *  - a hash index of the keys: the keys of a bucket are chained by
+ *    their next field, in a cache aligned array of bucket heads.
+ *  - the lists of free keys and free items, chained by their next
+ *    field, so that allocating a key or an item is O(1).
+ *  - the age list of the items, from the oldest to the newest one,
+ *    so that a timeout flush only walks the expired items. Items are
+ *    appended to the list when they are inserted, which keeps it
+ *    ordered as long as the start times given to the tables don't
+ *    decrease.
+ * The key and item contents stay in the arrays of the tables; the
+ * index only works on their array indexes.
+ */
+
+/* hash and next key in the bucket, or in the free list */
+struct gro_flow_key_link {
+	uint32_t hash;
+	uint32_t next;
+};
+
+/* age list links of an item and the index of its key */
+struct gro_flow_item_link {
+	uint32_t prev;
+	/* newer item, or next item in the free list */
+	uint32_t next;
+	uint32_t key_idx;
+};
+
+struct gro_flow_index {
+	/* first key of each bucket */
+	uint32_t *buckets;
+	struct gro_flow_key_link *keys;
+	struct gro_flow_item_link *items;
+	uint32_t bucket_mask;
+	/* heads of the free key and free item lists */
+	uint32_t free_key;
+	uint32_t free_item;
+	/* oldest and newest items */
+	uint32_t age_head;
+	uint32_t age_tail;
+};
+
+/**
+ * This function allocates the arrays of a flow index on a socket and
+ * initializes it. The number of buckets is the number of keys rounded
+ * up to a power of 2.
+ *
+ * @return
+ *  0 on success, -ENOMEM if the allocation fails.
+ */
+int gro_flow_index_create(struct gro_flow_index *idx,
+		uint16_t socket_id,
+		uint32_t nb_keys,
+		uint32_t nb_items);
+
+/**
+ * This function frees the arrays allocated by gro_flow_index_create().
+ */
+void gro_flow_index_destroy(struct gro_flow_index *idx);
+
+/**
+ * This function initializes a flow index on arrays provided by the
+ * caller, e.g. on the stack. nb_buckets must be a power of 2.
+ */
+void gro_flow_index_init(struct gro_flow_index *idx,
+		uint32_t *buckets,
+		uint32_t nb_buckets,
+		struct gro_flow_key_link *keys,
+		uint32_t nb_keys,
+		struct gro_flow_item_link *items,
+		uint32_t nb_items);
+
+/*
+ * return the first key of the bucket with the given hash value, or
+ * INVALID_ARRAY_INDEX. Keys with another hash value are skipped, the
+ * caller still has to compare the key contents.
+ */
+static inline uint32_t
+gro_flow_key_first(const struct gro_flow_index *idx, uint32_t hash)
+{
+	uint32_t key_idx = idx->buckets[hash & idx->bucket_mask];
+
+	while (key_idx != INVALID_ARRAY_INDEX &&
+			idx->keys[key_idx].hash != hash)
+		key_idx = idx->keys[key_idx].next;
+	return key_idx;
+}
+
+/* return the next key of the bucket with the same hash value */
+static inline uint32_t
+gro_flow_key_next(const struct gro_flow_index *idx, uint32_t key_idx)
+{
+	uint32_t hash = idx->keys[key_idx].hash;
+
+	do {
+		key_idx = idx->keys[key_idx].next;
+	} while (key_idx != INVALID_ARRAY_INDEX &&
+			idx->keys[key_idx].hash != hash);
+	return key_idx;
+}
+
+/* take a free key and add it into the bucket of the hash value */
+static inline uint32_t
+gro_flow_key_alloc(struct gro_flow_index *idx, uint32_t hash)
+{
+	uint32_t key_idx = idx->free_key;
+	uint32_t *bucket;
+
+	if (key_idx == INVALID_ARRAY_INDEX)
+		return INVALID_ARRAY_INDEX;
+	idx->free_key = idx->keys[key_idx].next;
+
+	bucket = &idx->buckets[hash & idx->bucket_mask];
+	idx->keys[key_idx].hash = hash;
+	idx->keys[key_idx].next = *bucket;
+	*bucket = key_idx;
+
+	return key_idx;
+}
+
+/* remove a key from its bucket and put it back into the free list */
+static inline void
+gro_flow_key_free(struct gro_flow_index *idx, uint32_t key_idx)
+{
+	uint32_t *prev = &idx->buckets[idx->keys[key_idx].hash &
+		idx->bucket_mask];
+
+	while (*prev != key_idx)
+		prev = &idx->keys[*prev].next;
+	*prev = idx->keys[key_idx].next;
+
+	idx->keys[key_idx].next = idx->free_key;
+	idx->free_key = key_idx;
+}
+
+/* take a free item for a key and append it to the age list */
+static inline uint32_t
+gro_flow_item_alloc(struct gro_flow_index *idx, uint32_t key_idx)
+{
+	uint32_t item_idx = idx->free_item;
+	struct gro_flow_item_link *item;
+
+	if (item_idx == INVALID_ARRAY_INDEX)
+		return INVALID_ARRAY_INDEX;
+	item = &idx->items[item_idx];
+	idx->free_item = item->next;
+
+	item->key_idx = key_idx;
+	item->next = INVALID_ARRAY_INDEX;
+	item->prev = idx->age_tail;
+	if (idx->age_tail != INVALID_ARRAY_INDEX)
+		idx->items[idx->age_tail].next = item_idx;
+	else
+		idx->age_head = item_idx;
+	idx->age_tail = item_idx;
+
+	return item_idx;
+}
+
+/* remove an item from the age list and put it into the free list */
+static inline void
+gro_flow_item_free(struct gro_flow_index *idx, uint32_t item_idx)
+{
+	struct gro_flow_item_link *item = &idx->items[item_idx];
+
+	if (item->prev != INVALID_ARRAY_INDEX)
+		idx->items[item->prev].next = item->next;
+	else
+		idx->age_head = item->next;
+	if (item->next != INVALID_ARRAY_INDEX)
+		idx->items[item->next].prev = item->prev;
+	else
+		idx->age_tail = item->prev;
+
+	item->next = idx->free_item;
+	idx->free_item = item_idx;
+}
+
+/* return the oldest item, or INVALID_ARRAY_INDEX if there is none */
+static inline uint32_t
+gro_flow_item_oldest(const struct gro_flow_index *idx)
+{
+	return idx->age_head;
+}
+
+/* return the item inserted after the given one */
+static inline uint32_t
+gro_flow_item_newer(const struct gro_flow_index *idx, uint32_t item_idx)
+{
+	return idx->items[item_idx].next;
+}
+
+/* return the key of an item */
+static inline uint32_t
+gro_flow_item_key(const struct gro_flow_index *idx, uint32_t item_idx)
+{
+	return idx->items[item_idx].key_idx;
+}
+
+#endif
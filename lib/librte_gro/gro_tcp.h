@@ -0,0 +1,271 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef _GRO_TCP_H_
+#define _GRO_TCP_H_
+
+#include <rte_mbuf.h>
+#include <rte_tcp.h>
+
+#include "gro_flow_index.h"
+
+/*
+ * the max value of the IPv4 total length and of the IPv6
+ * payload length fields.
+ */
+#define GRO_MAX_LENGTH UINT16_MAX
+
+/*
+ * item structure shared by the TCP reassembly tables. It keeps
+ * a packet, which may be the result of several merged packets.
+ */
+struct gro_tcp_item {
+	/*
+	 * first segment of the packet. If the value
+	 * is NULL, it means the item is empty.
+	 */
+	struct rte_mbuf *firstseg;
+	/* last segment of the packet */
+	struct rte_mbuf *lastseg;
+	/*
+	 * the time when the first packet is inserted
+	 * into the table. If a packet in the table is
+	 * merged with an incoming packet, this value
+	 * won't be updated. We set this value only
+	 * when the first packet is inserted into the
+	 * table.
+	 */
+	uint64_t start_time;
+	/*
+	 * we use next_pkt_idx to chain the packets that
+	 * have same key value but can't be merged together.
+	 */
+	uint32_t next_pkt_idx;
+	/* the sequence number of the packet */
+	uint32_t sent_seq;
+	/* the IP ID of the packet, unused for IPv6 */
+	uint16_t ip_id;
+	/* the number of merged packets */
+	uint16_t nb_merged;
+};
+
+/*
+ * insert a packet into a free item of the array, for the key key_idx.
+ * If prev_idx is valid, chain the new item after it in the same item
+ * group.
+ */
+static inline uint32_t
+gro_tcp_insert_new_item(struct gro_flow_index *idx,
+		struct gro_tcp_item *items,
+		uint32_t *item_num,
+		uint32_t key_idx,
+		struct rte_mbuf *pkt,
+		uint16_t ip_id,
+		uint32_t sent_seq,
+		uint32_t prev_idx,
+		uint64_t start_time)
+{
+	uint32_t item_idx;
+
+	item_idx = gro_flow_item_alloc(idx, key_idx);
+	if (item_idx == INVALID_ARRAY_INDEX)
+		return INVALID_ARRAY_INDEX;
+
+	items[item_idx].firstseg = pkt;
+	items[item_idx].lastseg = rte_pktmbuf_lastseg(pkt);
+	items[item_idx].start_time = start_time;
+	items[item_idx].next_pkt_idx = INVALID_ARRAY_INDEX;
+	items[item_idx].sent_seq = sent_seq;
+	items[item_idx].ip_id = ip_id;
+	items[item_idx].nb_merged = 1;
+	(*item_num)++;
+
+	/* if the previous packet exists, chain the new one with it */
+	if (prev_idx != INVALID_ARRAY_INDEX) {
+		items[item_idx].next_pkt_idx = items[prev_idx].next_pkt_idx;
+		items[prev_idx].next_pkt_idx = item_idx;
+	}
+
+	return item_idx;
+}
+
+static inline uint32_t
+gro_tcp_delete_item(struct gro_flow_index *idx,
+		struct gro_tcp_item *items,
+		uint32_t *item_num,
+		uint32_t item_idx,
+		uint32_t prev_item_idx)
+{
+	uint32_t next_idx = items[item_idx].next_pkt_idx;
+
+	/* set NULL to firstseg to indicate it's an empty item */
+	items[item_idx].firstseg = NULL;
+	gro_flow_item_free(idx, item_idx);
+	(*item_num)--;
+	if (prev_item_idx != INVALID_ARRAY_INDEX)
+		items[prev_item_idx].next_pkt_idx = next_idx;
+
+	return next_idx;
+}
+
+/*
+ * return the item before item_idx in the item group starting at
+ * start_idx, or INVALID_ARRAY_INDEX if item_idx is the first one.
+ */
+static inline uint32_t
+gro_tcp_find_prev_item(const struct gro_tcp_item *items,
+		uint32_t start_idx,
+		uint32_t item_idx)
+{
+	uint32_t prev_idx = INVALID_ARRAY_INDEX;
+
+	while (start_idx != item_idx) {
+		prev_idx = start_idx;
+		start_idx = items[start_idx].next_pkt_idx;
+	}
+	return prev_idx;
+}
+
+/*
+ * merge two TCP packets without updating checksums.
+ * If cmp is larger than 0, append the new packet to the
+ * original packet. Otherwise, pre-pend the new packet to
+ * the original packet.
+ *
+ * hdr_len is the length of all the headers of the new packet,
+ * which are removed from the tail packet. len_ofs is the offset
+ * of the IP header whose length field must hold the merged packet.
+ */
+static inline int
+merge_two_tcp_packets(struct gro_tcp_item *item,
+		struct rte_mbuf *pkt,
+		int cmp,
+		uint32_t sent_seq,
+		uint16_t ip_id,
+		uint16_t hdr_len,
+		uint16_t len_ofs)
+{
+	struct rte_mbuf *pkt_head, *pkt_tail, *lastseg;
+	uint32_t tcp_datalen;
+
+	if (cmp > 0) {
+		pkt_head = item->firstseg;
+		pkt_tail = pkt;
+	} else {
+		pkt_head = pkt;
+		pkt_tail = item->firstseg;
+	}
+
+	/* check if the packet length will be beyond the max value */
+	tcp_datalen = pkt_tail->pkt_len - hdr_len;
+	if (pkt_head->pkt_len - len_ofs + tcp_datalen > GRO_MAX_LENGTH)
+		return 0;
+
+	/* remove packet header for the tail packet */
+	rte_pktmbuf_adj(pkt_tail, hdr_len);
+
+	/* chain two packets together */
+	if (cmp > 0) {
+		item->lastseg->next = pkt;
+		item->lastseg = rte_pktmbuf_lastseg(pkt);
+		/* update IP ID to the larger value */
+		item->ip_id = ip_id;
+	} else {
+		lastseg = rte_pktmbuf_lastseg(pkt);
+		lastseg->next = item->firstseg;
+		item->firstseg = pkt;
+		/* update sent_seq to the smaller value */
+		item->sent_seq = sent_seq;
+	}
+	item->nb_merged++;
+
+	/* update mbuf metadata for the merged packet */
+	pkt_head->nb_segs += pkt_tail->nb_segs;
+	pkt_head->pkt_len += pkt_tail->pkt_len;
+
+	return 1;
+}
+
+/*
+ * check if the new packet and the packet of the item are neighbors
+ * with the same TCP options. l2_offset is the length of the headers
+ * before mbuf l2_len, i.e. of the outer headers of tunneled packets.
+ * If is_atomic is set, the IP IDs are not checked (e.g. IPv6).
+ *
+ * Return 1 to append the new packet, -1 to pre-pend it and 0 if
+ * the packets can't be merged.
+ */
+static inline int
+check_seq_option(struct gro_tcp_item *item,
+		struct tcp_hdr *tcp_hdr,
+		uint32_t sent_seq,
+		uint16_t ip_id,
+		uint16_t tcp_hl,
+		uint16_t tcp_dl,
+		uint16_t l2_offset,
+		uint8_t is_atomic)
+{
+	struct rte_mbuf *pkt_orig = item->firstseg;
+	struct tcp_hdr *tcp_hdr_orig;
+	uint16_t tcp_hl_orig;
+	uint32_t len;
+
+	tcp_hdr_orig = (struct tcp_hdr *)(rte_pktmbuf_mtod(pkt_orig, char *) +
+			l2_offset + pkt_orig->l2_len + pkt_orig->l3_len);
+	tcp_hl_orig = pkt_orig->l4_len;
+
+	/* check if TCP option fields equal. If not, return 0. */
+	len = RTE_MAX(tcp_hl, tcp_hl_orig) - sizeof(struct tcp_hdr);
+	if ((tcp_hl != tcp_hl_orig) ||
+			((len > 0) && (memcmp(tcp_hdr + 1,
+					tcp_hdr_orig + 1,
+					len) != 0)))
+		return 0;
+
+	/* check if the two packets are neighbors */
+	len = pkt_orig->pkt_len - l2_offset - pkt_orig->l2_len -
+		pkt_orig->l3_len - tcp_hl_orig;
+	if ((sent_seq == (item->sent_seq + len)) &&
+			(is_atomic || (ip_id == (uint16_t)(item->ip_id + 1))))
+		/* append the new packet */
+		return 1;
+	else if (((sent_seq + tcp_dl) == item->sent_seq) &&
+			(is_atomic || ((uint16_t)(ip_id + item->nb_merged) ==
+				item->ip_id)))
+		/* pre-pend the new packet */
+		return -1;
+
+	return 0;
+}
+
+#endif
@@ -61,7 +61,7 @@ gro_tcp4_tbl_create(uint16_t socket_id,
 	if (tbl == NULL)
 		return NULL;
 
-	size = sizeof(struct gro_tcp4_item) * entries_num;
+	size = sizeof(struct gro_tcp_item) * entries_num;
 	tbl->items = rte_zmalloc_socket(__func__,
 			size,
 			RTE_CACHE_LINE_SIZE,
@@ -87,6 +87,14 @@ gro_tcp4_tbl_create(uint16_t socket_id,
 		tbl->keys[i].start_index = INVALID_ARRAY_INDEX;
 	tbl->max_key_num = entries_num;
 
+	if (gro_flow_index_create(&tbl->idx, socket_id, entries_num,
+				entries_num) < 0) {
+		rte_free(tbl->keys);
+		rte_free(tbl->items);
+		rte_free(tbl);
+		return NULL;
+	}
+
 	return tbl;
 }
 
@@ -98,191 +106,42 @@ gro_tcp4_tbl_destroy(void *tbl)
 	if (tcp_tbl) {
 		rte_free(tcp_tbl->items);
 		rte_free(tcp_tbl->keys);
+		gro_flow_index_destroy(&tcp_tbl->idx);
 	}
 	rte_free(tcp_tbl);
 }
 
-/*
- * merge two TCP/IPv4 packets without updating checksums.
- * If cmp is larger than 0, append the new packet to the
- * original packet. Otherwise, pre-pend the new packet to
- * the original packet.
- */
-static inline int
-merge_two_tcp4_packets(struct gro_tcp4_item *item_src,
-		struct rte_mbuf *pkt,
-		uint16_t ip_id,
-		uint32_t sent_seq,
-		int cmp)
-{
-	struct rte_mbuf *pkt_head, *pkt_tail, *lastseg;
-	uint16_t tcp_datalen;
-
-	if (cmp > 0) {
-		pkt_head = item_src->firstseg;
-		pkt_tail = pkt;
-	} else {
-		pkt_head = pkt;
-		pkt_tail = item_src->firstseg;
-	}
-
-	/* check if the packet length will be beyond the max value */
-	tcp_datalen = pkt_tail->pkt_len - pkt_tail->l2_len -
-		pkt_tail->l3_len - pkt_tail->l4_len;
-	if (pkt_head->pkt_len - pkt_head->l2_len + tcp_datalen >
-			TCP4_MAX_L3_LENGTH)
-		return 0;
-
-	/* remove packet header for the tail packet */
-	rte_pktmbuf_adj(pkt_tail,
-			pkt_tail->l2_len +
-			pkt_tail->l3_len +
-			pkt_tail->l4_len);
-
-	/* chain two packets together */
-	if (cmp > 0) {
-		item_src->lastseg->next = pkt;
-		item_src->lastseg = rte_pktmbuf_lastseg(pkt);
-		/* update IP ID to the larger value */
-		item_src->ip_id = ip_id;
-	} else {
-		lastseg = rte_pktmbuf_lastseg(pkt);
-		lastseg->next = item_src->firstseg;
-		item_src->firstseg = pkt;
-		/* update sent_seq to the smaller value */
-		item_src->sent_seq = sent_seq;
-	}
-	item_src->nb_merged++;
-
-	/* update mbuf metadata for the merged packet */
-	pkt_head->nb_segs += pkt_tail->nb_segs;
-	pkt_head->pkt_len += pkt_tail->pkt_len;
-
-	return 1;
-}
-
-static inline int
-check_seq_option(struct gro_tcp4_item *item,
-		struct tcp_hdr *tcp_hdr,
-		uint16_t tcp_hl,
-		uint16_t tcp_dl,
-		uint16_t ip_id,
-		uint32_t sent_seq)
-{
-	struct rte_mbuf *pkt0 = item->firstseg;
-	struct ipv4_hdr *ipv4_hdr0;
-	struct tcp_hdr *tcp_hdr0;
-	uint16_t tcp_hl0, tcp_dl0;
-	uint16_t len;
-
-	ipv4_hdr0 = (struct ipv4_hdr *)(rte_pktmbuf_mtod(pkt0, char *) +
-			pkt0->l2_len);
-	tcp_hdr0 = (struct tcp_hdr *)((char *)ipv4_hdr0 + pkt0->l3_len);
-	tcp_hl0 = pkt0->l4_len;
-
-	/* check if TCP option fields equal. If not, return 0. */
-	len = RTE_MAX(tcp_hl, tcp_hl0) - sizeof(struct tcp_hdr);
-	if ((tcp_hl != tcp_hl0) ||
-			((len > 0) && (memcmp(tcp_hdr + 1,
-					tcp_hdr0 + 1,
-					len) != 0)))
-		return 0;
-
-	/* check if the two packets are neighbors */
-	tcp_dl0 = pkt0->pkt_len - pkt0->l2_len - pkt0->l3_len - tcp_hl0;
-	if ((sent_seq == (item->sent_seq + tcp_dl0)) &&
-			(ip_id == (item->ip_id + 1)))
-		/* append the new packet */
-		return 1;
-	else if (((sent_seq + tcp_dl) == item->sent_seq) &&
-			((ip_id + item->nb_merged) == item->ip_id))
-		/* pre-pend the new packet */
-		return -1;
-	else
-		return 0;
-}
-
-static inline uint32_t
-find_an_empty_item(struct gro_tcp4_tbl *tbl)
-{
-	uint32_t i;
-	uint32_t max_item_num = tbl->max_item_num;
-
-	for (i = 0; i < max_item_num; i++)
-		if (tbl->items[i].firstseg == NULL)
-			return i;
-	return INVALID_ARRAY_INDEX;
-}
-
-static inline uint32_t
-find_an_empty_key(struct gro_tcp4_tbl *tbl)
-{
-	uint32_t i;
-	uint32_t max_key_num = tbl->max_key_num;
-
-	for (i = 0; i < max_key_num; i++)
-		if (tbl->keys[i].start_index == INVALID_ARRAY_INDEX)
-			return i;
-	return INVALID_ARRAY_INDEX;
-}
-
 static inline uint32_t
 insert_new_item(struct gro_tcp4_tbl *tbl,
+		uint32_t key_idx,
 		struct rte_mbuf *pkt,
 		uint16_t ip_id,
 		uint32_t sent_seq,
 		uint32_t prev_idx,
 		uint64_t start_time)
 {
-	uint32_t item_idx;
-
-	item_idx = find_an_empty_item(tbl);
-	if (item_idx == INVALID_ARRAY_INDEX)
-		return INVALID_ARRAY_INDEX;
-
-	tbl->items[item_idx].firstseg = pkt;
-	tbl->items[item_idx].lastseg = rte_pktmbuf_lastseg(pkt);
-	tbl->items[item_idx].start_time = start_time;
-	tbl->items[item_idx].next_pkt_idx = INVALID_ARRAY_INDEX;
-	tbl->items[item_idx].sent_seq = sent_seq;
-	tbl->items[item_idx].ip_id = ip_id;
-	tbl->items[item_idx].nb_merged = 1;
-	tbl->item_num++;
-
-	/* if the previous packet exists, chain the new one with it */
-	if (prev_idx != INVALID_ARRAY_INDEX) {
-		tbl->items[item_idx].next_pkt_idx =
-			tbl->items[prev_idx].next_pkt_idx;
-		tbl->items[prev_idx].next_pkt_idx = item_idx;
-	}
-
-	return item_idx;
+	return gro_tcp_insert_new_item(&tbl->idx, tbl->items,
+			&tbl->item_num, key_idx, pkt, ip_id, sent_seq,
+			prev_idx, start_time);
 }
 
 static inline uint32_t
 delete_item(struct gro_tcp4_tbl *tbl, uint32_t item_idx,
 		uint32_t prev_item_idx)
 {
-	uint32_t next_idx = tbl->items[item_idx].next_pkt_idx;
-
-	/* set NULL to firstseg to indicate it's an empty item */
-	tbl->items[item_idx].firstseg = NULL;
-	tbl->item_num--;
-	if (prev_item_idx != INVALID_ARRAY_INDEX)
-		tbl->items[prev_item_idx].next_pkt_idx = next_idx;
-
-	return next_idx;
+	return gro_tcp_delete_item(&tbl->idx, tbl->items, &tbl->item_num,
+			item_idx, prev_item_idx);
 }
 
 static inline uint32_t
 insert_new_key(struct gro_tcp4_tbl *tbl,
 		struct tcp4_key *key_src,
-		uint32_t item_idx)
+		uint32_t hash)
 {
 	struct tcp4_key *key_dst;
 	uint32_t key_idx;
 
-	key_idx = find_an_empty_key(tbl);
+	key_idx = gro_flow_key_alloc(&tbl->idx, hash);
 	if (key_idx == INVALID_ARRAY_INDEX)
 		return INVALID_ARRAY_INDEX;
 
@@ -296,13 +155,19 @@ insert_new_key(struct gro_tcp4_tbl *tbl,
 	key_dst->src_port = key_src->src_port;
 	key_dst->dst_port = key_src->dst_port;
 
-	/* non-INVALID_ARRAY_INDEX value indicates this key is valid */
-	tbl->keys[key_idx].start_index = item_idx;
 	tbl->key_num++;
 
 	return key_idx;
 }
 
+static inline void
+delete_key(struct gro_tcp4_tbl *tbl, uint32_t key_idx)
+{
+	tbl->keys[key_idx].start_index = INVALID_ARRAY_INDEX;
+	gro_flow_key_free(&tbl->idx, key_idx);
+	tbl->key_num--;
+}
+
 static inline int
 is_same_key(struct tcp4_key k1, struct tcp4_key k2)
 {
@@ -323,7 +188,7 @@ is_same_key(struct tcp4_key k1, struct tcp4_key k2)
  * update packet length for the flushed packet.
  */
 static inline void
-update_header(struct gro_tcp4_item *item)
+update_header(struct gro_tcp_item *item)
 {
 	struct ipv4_hdr *ipv4_hdr;
 	struct rte_mbuf *pkt = item->firstseg;
@@ -347,7 +212,7 @@ gro_tcp4_reassemble(struct rte_mbuf *pkt,
 
 	struct tcp4_key key;
 	uint32_t cur_idx, prev_idx, item_idx;
-	uint32_t i, max_key_num;
+	uint32_t i, hash;
 	int cmp;
 
 	eth_hdr = rte_pktmbuf_mtod(pkt, struct ether_hdr *);
@@ -377,29 +242,32 @@ gro_tcp4_reassemble(struct rte_mbuf *pkt,
 	key.dst_port = tcp_hdr->dst_port;
 	key.recv_ack = tcp_hdr->recv_ack;
 
-	/* search for a key */
-	max_key_num = tbl->max_key_num;
-	for (i = 0; i < max_key_num; i++) {
-		if ((tbl->keys[i].start_index != INVALID_ARRAY_INDEX) &&
-				is_same_key(tbl->keys[i].key, key))
+	/* search for a key in the bucket of its hash value */
+	hash = tcp4_key_hash(&key);
+	for (i = gro_flow_key_first(&tbl->idx, hash);
+			i != INVALID_ARRAY_INDEX;
+			i = gro_flow_key_next(&tbl->idx, i)) {
+		if (is_same_key(tbl->keys[i].key, key))
 			break;
 	}
 
 	/* can't find a key, so insert a new key and a new item. */
-	if (i == tbl->max_key_num) {
-		item_idx = insert_new_item(tbl, pkt, ip_id, sent_seq,
-				INVALID_ARRAY_INDEX, start_time);
-		if (item_idx == INVALID_ARRAY_INDEX)
+	if (i == INVALID_ARRAY_INDEX) {
+		i = insert_new_key(tbl, &key, hash);
+		if (i == INVALID_ARRAY_INDEX)
 			return -1;
-		if (insert_new_key(tbl, &key, item_idx) ==
-				INVALID_ARRAY_INDEX) {
+		item_idx = insert_new_item(tbl, i, pkt, ip_id, sent_seq,
+				INVALID_ARRAY_INDEX, start_time);
+		if (item_idx == INVALID_ARRAY_INDEX) {
 			/*
-			 * fail to insert a new key, so
-			 * delete the inserted item
+			 * fail to insert a new item, so
+			 * delete the inserted key
 			 */
-			delete_item(tbl, item_idx, INVALID_ARRAY_INDEX);
+			delete_key(tbl, i);
 			return -1;
 		}
+		/* non-INVALID_ARRAY_INDEX value indicates the key is valid */
+		tbl->keys[i].start_index = item_idx;
 		return 0;
 	}
 
@@ -408,18 +276,19 @@ gro_tcp4_reassemble(struct rte_mbuf *pkt,
 	prev_idx = cur_idx;
 	do {
 		cmp = check_seq_option(&(tbl->items[cur_idx]), tcp_hdr,
-				pkt->l4_len, tcp_dl, ip_id, sent_seq);
+				sent_seq, ip_id, pkt->l4_len, tcp_dl, 0, 0);
 		if (cmp) {
-			if (merge_two_tcp4_packets(&(tbl->items[cur_idx]),
-						pkt, ip_id,
-						sent_seq, cmp))
+			if (merge_two_tcp_packets(&(tbl->items[cur_idx]),
+						pkt, cmp, sent_seq, ip_id,
+						pkt->l2_len + pkt->l3_len +
+						pkt->l4_len, pkt->l2_len))
 				return 1;
 			/*
 			 * fail to merge two packets since the packet
 			 * length will be greater than the max value.
 			 * So insert the packet into the item group.
 			 */
-			if (insert_new_item(tbl, pkt, ip_id, sent_seq,
+			if (insert_new_item(tbl, i, pkt, ip_id, sent_seq,
 						prev_idx, start_time) ==
 					INVALID_ARRAY_INDEX)
 				return -1;
@@ -433,7 +302,7 @@ gro_tcp4_reassemble(struct rte_mbuf *pkt,
 	 * can't find a packet in the item group to merge,
 	 * so insert the packet into the item group.
 	 */
-	if (insert_new_item(tbl, pkt, ip_id, sent_seq, prev_idx,
+	if (insert_new_item(tbl, i, pkt, ip_id, sent_seq, prev_idx,
 				start_time) == INVALID_ARRAY_INDEX)
 		return -1;
 
@@ -447,48 +316,38 @@ gro_tcp4_tbl_timeout_flush(struct gro_tcp4_tbl *tbl,
 		uint16_t nb_out)
 {
 	uint16_t k = 0;
-	uint32_t i, j;
-	uint32_t max_key_num = tbl->max_key_num;
-
-	for (i = 0; i < max_key_num; i++) {
-		/* all keys have been checked, return immediately */
-		if (tbl->key_num == 0)
-			return k;
-
-		j = tbl->keys[i].start_index;
-		while (j != INVALID_ARRAY_INDEX) {
-			if (tbl->items[j].start_time <= flush_timestamp) {
-				out[k++] = tbl->items[j].firstseg;
-				if (tbl->items[j].nb_merged > 1)
-					update_header(&(tbl->items[j]));
-				/*
-				 * delete the item and get
-				 * the next packet index
-				 */
-				j = delete_item(tbl, j,
-						INVALID_ARRAY_INDEX);
-
-				/*
-				 * delete the key as all of
-				 * packets are flushed
-				 */
-				if (j == INVALID_ARRAY_INDEX) {
-					tbl->keys[i].start_index =
-						INVALID_ARRAY_INDEX;
-					tbl->key_num--;
-				} else
-					/* update start_index of the key */
-					tbl->keys[i].start_index = j;
-
-				if (k == nb_out)
-					return k;
-			} else
-				/*
-				 * left packets of this key won't be
-				 * timeout, so go to check other keys.
-				 */
-				break;
+	uint32_t i, j, next_idx, key_idx, prev_idx;
+
+	/* walk the items from the oldest one */
+	i = gro_flow_item_oldest(&tbl->idx);
+	while (i != INVALID_ARRAY_INDEX && k < nb_out) {
+		/* newer packets won't be timeout either */
+		if (tbl->items[i].start_time > flush_timestamp)
+			break;
+
+		next_idx = gro_flow_item_newer(&tbl->idx, i);
+		key_idx = gro_flow_item_key(&tbl->idx, i);
+
+		out[k++] = tbl->items[i].firstseg;
+		if (tbl->items[i].nb_merged > 1)
+			update_header(&(tbl->items[i]));
+
+		/* delete the item and unchain it from its item group */
+		prev_idx = gro_tcp_find_prev_item(tbl->items,
+				tbl->keys[key_idx].start_index, i);
+		j = delete_item(tbl, i, prev_idx);
+		if (prev_idx == INVALID_ARRAY_INDEX) {
+			/*
+			 * delete the key if all of its packets are
+			 * flushed, otherwise update its start_index.
+			 */
+			if (j == INVALID_ARRAY_INDEX)
+				delete_key(tbl, key_idx);
+			else
+				tbl->keys[key_idx].start_index = j;
 		}
+
+		i = next_idx;
 	}
 	return k;
 }
@@ -33,14 +33,12 @@
 #ifndef _GRO_TCP4_H_
 #define _GRO_TCP4_H_
 
-#define INVALID_ARRAY_INDEX 0xffffffffUL
-#define GRO_TCP4_TBL_MAX_ITEM_NUM (1024UL * 1024UL)
+#include <rte_ether.h>
+#include <rte_jhash.h>
 
-/*
- * the max L3 length of a TCP/IPv4 packet. The L3 length
- * is the sum of ipv4 header, tcp header and L4 payload.
- */
-#define TCP4_MAX_L3_LENGTH UINT16_MAX
+#include "gro_tcp.h"
+
+#define GRO_TCP4_TBL_MAX_ITEM_NUM (1024UL * 1024UL)
 
 /* criteria of mergeing packets */
 struct tcp4_key {
@@ -64,42 +62,12 @@ struct gro_tcp4_key {
 	uint32_t start_index;
 };
 
-struct gro_tcp4_item {
-	/*
-	 * first segment of the packet. If the value
-	 * is NULL, it means the item is empty.
-	 */
-	struct rte_mbuf *firstseg;
-	/* last segment of the packet */
-	struct rte_mbuf *lastseg;
-	/*
-	 * the time when the first packet is inserted
-	 * into the table. If a packet in the table is
-	 * merged with an incoming packet, this value
-	 * won't be updated. We set this value only
-	 * when the first packet is inserted into the
-	 * table.
-	 */
-	uint64_t start_time;
-	/*
-	 * we use next_pkt_idx to chain the packets that
-	 * have same key value but can't be merged together.
-	 */
-	uint32_t next_pkt_idx;
-	/* the sequence number of the packet */
-	uint32_t sent_seq;
-	/* the IP ID of the packet */
-	uint16_t ip_id;
-	/* the number of merged packets */
-	uint16_t nb_merged;
-};
-
 /*
  * TCP/IPv4 reassembly table structure.
  */
 struct gro_tcp4_tbl {
 	/* item array */
-	struct gro_tcp4_item *items;
+	struct gro_tcp_item *items;
 	/* key array */
 	struct gro_tcp4_key *keys;
 	/* current item number */
@@ -110,8 +78,18 @@ struct gro_tcp4_tbl {
 	uint32_t max_item_num;
 	/* key array size */
 	uint32_t max_key_num;
+	/* hash index of the keys and age list of the items */
+	struct gro_flow_index idx;
 };
 
+static inline uint32_t
+tcp4_key_hash(const struct tcp4_key *key)
+{
+	return rte_jhash_3words(key->ip_src_addr, key->ip_dst_addr,
+			((uint32_t)key->src_port << 16) | key->dst_port,
+			key->recv_ack);
+}
+
 /**
  * This function creates a TCP/IPv4 reassembly table.
  *
@@ -175,7 +153,8 @@ int32_t gro_tcp4_reassemble(struct rte_mbuf *pkt,
  * This function flushes timeout packets in a TCP/IPv4 reassembly table
  * to applications, and without updating checksums for merged packets.
  * The max number of flushed timeout packets is the element number of
- * the array which is used to keep flushed packets.
+ * the array which is used to keep flushed packets. Packets are flushed
+ * from the oldest one, and only the timeout ones are visited.
  *
  * @param tbl
  *  a pointer that points to a TCP GRO table.
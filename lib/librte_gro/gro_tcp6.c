@@ -0,0 +1,374 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+
+#include "gro_tcp6.h"
+
+void *
+gro_tcp6_tbl_create(uint16_t socket_id,
+		uint16_t max_flow_num,
+		uint16_t max_item_per_flow)
+{
+	struct gro_tcp6_tbl *tbl;
+	size_t size;
+	uint32_t entries_num, i;
+
+	entries_num = max_flow_num * max_item_per_flow;
+	entries_num = RTE_MIN(entries_num, GRO_TCP6_TBL_MAX_ITEM_NUM);
+
+	if (entries_num == 0)
+		return NULL;
+
+	tbl = rte_zmalloc_socket(__func__,
+			sizeof(struct gro_tcp6_tbl),
+			RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (tbl == NULL)
+		return NULL;
+
+	size = sizeof(struct gro_tcp_item) * entries_num;
+	tbl->items = rte_zmalloc_socket(__func__,
+			size,
+			RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (tbl->items == NULL) {
+		rte_free(tbl);
+		return NULL;
+	}
+	tbl->max_item_num = entries_num;
+
+	size = sizeof(struct gro_tcp6_key) * entries_num;
+	tbl->keys = rte_zmalloc_socket(__func__,
+			size,
+			RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (tbl->keys == NULL) {
+		rte_free(tbl->items);
+		rte_free(tbl);
+		return NULL;
+	}
+	/* INVALID_ARRAY_INDEX indicates empty key */
+	for (i = 0; i < entries_num; i++)
+		tbl->keys[i].start_index = INVALID_ARRAY_INDEX;
+	tbl->max_key_num = entries_num;
+
+	if (gro_flow_index_create(&tbl->idx, socket_id, entries_num,
+				entries_num) < 0) {
+		rte_free(tbl->keys);
+		rte_free(tbl->items);
+		rte_free(tbl);
+		return NULL;
+	}
+
+	return tbl;
+}
+
+void
+gro_tcp6_tbl_destroy(void *tbl)
+{
+	struct gro_tcp6_tbl *tcp_tbl = tbl;
+
+	if (tcp_tbl) {
+		rte_free(tcp_tbl->items);
+		rte_free(tcp_tbl->keys);
+		gro_flow_index_destroy(&tcp_tbl->idx);
+	}
+	rte_free(tcp_tbl);
+}
+
+static inline uint32_t
+insert_new_item(struct gro_tcp6_tbl *tbl,
+		uint32_t key_idx,
+		struct rte_mbuf *pkt,
+		uint32_t sent_seq,
+		uint32_t prev_idx,
+		uint64_t start_time)
+{
+	/* IPv6 has no IP ID */
+	return gro_tcp_insert_new_item(&tbl->idx, tbl->items,
+			&tbl->item_num, key_idx, pkt, 0, sent_seq,
+			prev_idx, start_time);
+}
+
+static inline uint32_t
+delete_item(struct gro_tcp6_tbl *tbl, uint32_t item_idx,
+		uint32_t prev_item_idx)
+{
+	return gro_tcp_delete_item(&tbl->idx, tbl->items, &tbl->item_num,
+			item_idx, prev_item_idx);
+}
+
+static inline uint32_t
+insert_new_key(struct gro_tcp6_tbl *tbl,
+		struct tcp6_key *key_src,
+		uint32_t hash)
+{
+	struct tcp6_key *key_dst;
+	uint32_t key_idx;
+
+	key_idx = gro_flow_key_alloc(&tbl->idx, hash);
+	if (key_idx == INVALID_ARRAY_INDEX)
+		return INVALID_ARRAY_INDEX;
+
+	key_dst = &(tbl->keys[key_idx].key);
+
+	ether_addr_copy(&(key_src->eth_saddr), &(key_dst->eth_saddr));
+	ether_addr_copy(&(key_src->eth_daddr), &(key_dst->eth_daddr));
+	memcpy(key_dst->ip_src_addr, key_src->ip_src_addr,
+			sizeof(key_dst->ip_src_addr));
+	memcpy(key_dst->ip_dst_addr, key_src->ip_dst_addr,
+			sizeof(key_dst->ip_dst_addr));
+	key_dst->vtc_flow = key_src->vtc_flow;
+	key_dst->recv_ack = key_src->recv_ack;
+	key_dst->src_port = key_src->src_port;
+	key_dst->dst_port = key_src->dst_port;
+
+	tbl->key_num++;
+
+	return key_idx;
+}
+
+static inline void
+delete_key(struct gro_tcp6_tbl *tbl, uint32_t key_idx)
+{
+	tbl->keys[key_idx].start_index = INVALID_ARRAY_INDEX;
+	gro_flow_key_free(&tbl->idx, key_idx);
+	tbl->key_num--;
+}
+
+static inline int
+is_same_key(const struct tcp6_key *k1, const struct tcp6_key *k2)
+{
+	if (is_same_ether_addr(&k1->eth_saddr, &k2->eth_saddr) == 0)
+		return 0;
+
+	if (is_same_ether_addr(&k1->eth_daddr, &k2->eth_daddr) == 0)
+		return 0;
+
+	return ((k1->recv_ack == k2->recv_ack) &&
+			(k1->src_port == k2->src_port) &&
+			(k1->dst_port == k2->dst_port) &&
+			(k1->vtc_flow == k2->vtc_flow) &&
+			(memcmp(k1->ip_src_addr, k2->ip_src_addr,
+				sizeof(k1->ip_src_addr)) == 0) &&
+			(memcmp(k1->ip_dst_addr, k2->ip_dst_addr,
+				sizeof(k1->ip_dst_addr)) == 0));
+}
+
+/*
+ * update packet length for the flushed packet.
+ */
+static inline void
+update_header(struct gro_tcp_item *item)
+{
+	struct ipv6_hdr *ipv6_hdr;
+	struct rte_mbuf *pkt = item->firstseg;
+
+	ipv6_hdr = (struct ipv6_hdr *)(rte_pktmbuf_mtod(pkt, char *) +
+			pkt->l2_len);
+	ipv6_hdr->payload_len = rte_cpu_to_be_16(pkt->pkt_len -
+			pkt->l2_len - sizeof(struct ipv6_hdr));
+}
+
+int32_t
+gro_tcp6_reassemble(struct rte_mbuf *pkt,
+		struct gro_tcp6_tbl *tbl,
+		uint64_t start_time)
+{
+	struct ether_hdr *eth_hdr;
+	struct ipv6_hdr *ipv6_hdr;
+	struct tcp_hdr *tcp_hdr;
+	uint32_t sent_seq;
+	uint16_t tcp_dl;
+
+	struct tcp6_key key;
+	uint32_t cur_idx, prev_idx, item_idx;
+	uint32_t i, hash;
+	int cmp;
+
+	eth_hdr = rte_pktmbuf_mtod(pkt, struct ether_hdr *);
+	ipv6_hdr = (struct ipv6_hdr *)((char *)eth_hdr + pkt->l2_len);
+	tcp_hdr = (struct tcp_hdr *)((char *)ipv6_hdr + pkt->l3_len);
+
+	/*
+	 * if FIN, SYN, RST, PSH, URG, ECE or
+	 * CWR is set, return immediately.
+	 */
+	if (tcp_hdr->tcp_flags != TCP_ACK_FLAG)
+		return -1;
+	/* packets with extension headers aren't merged */
+	if (ipv6_hdr->proto != IPPROTO_TCP)
+		return -1;
+	/* if payload length is 0, return immediately */
+	tcp_dl = rte_be_to_cpu_16(ipv6_hdr->payload_len) +
+		sizeof(struct ipv6_hdr) - pkt->l3_len - pkt->l4_len;
+	if (tcp_dl == 0)
+		return -1;
+
+	sent_seq = rte_be_to_cpu_32(tcp_hdr->sent_seq);
+
+	ether_addr_copy(&(eth_hdr->s_addr), &(key.eth_saddr));
+	ether_addr_copy(&(eth_hdr->d_addr), &(key.eth_daddr));
+	memcpy(key.ip_src_addr, ipv6_hdr->src_addr, sizeof(key.ip_src_addr));
+	memcpy(key.ip_dst_addr, ipv6_hdr->dst_addr, sizeof(key.ip_dst_addr));
+	key.vtc_flow = ipv6_hdr->vtc_flow;
+	key.src_port = tcp_hdr->src_port;
+	key.dst_port = tcp_hdr->dst_port;
+	key.recv_ack = tcp_hdr->recv_ack;
+
+	/* search for a key in the bucket of its hash value */
+	hash = tcp6_key_hash(&key);
+	for (i = gro_flow_key_first(&tbl->idx, hash);
+			i != INVALID_ARRAY_INDEX;
+			i = gro_flow_key_next(&tbl->idx, i)) {
+		if (is_same_key(&tbl->keys[i].key, &key))
+			break;
+	}
+
+	/* can't find a key, so insert a new key and a new item. */
+	if (i == INVALID_ARRAY_INDEX) {
+		i = insert_new_key(tbl, &key, hash);
+		if (i == INVALID_ARRAY_INDEX)
+			return -1;
+		item_idx = insert_new_item(tbl, i, pkt, sent_seq,
+				INVALID_ARRAY_INDEX, start_time);
+		if (item_idx == INVALID_ARRAY_INDEX) {
+			/*
+			 * fail to insert a new item, so
+			 * delete the inserted key
+			 */
+			delete_key(tbl, i);
+			return -1;
+		}
+		/* non-INVALID_ARRAY_INDEX value indicates the key is valid */
+		tbl->keys[i].start_index = item_idx;
+		return 0;
+	}
+
+	/* traverse all packets in the item group to find one to merge */
+	cur_idx = tbl->keys[i].start_index;
+	prev_idx = cur_idx;
+	do {
+		cmp = check_seq_option(&(tbl->items[cur_idx]), tcp_hdr,
+				sent_seq, 0, pkt->l4_len, tcp_dl, 0, 1);
+		if (cmp) {
+			if (merge_two_tcp_packets(&(tbl->items[cur_idx]),
+						pkt, cmp, sent_seq, 0,
+						pkt->l2_len + pkt->l3_len +
+						pkt->l4_len, pkt->l2_len +
+						sizeof(struct ipv6_hdr)))
+				return 1;
+			/*
+			 * fail to merge two packets since the packet
+			 * length will be greater than the max value.
+			 * So insert the packet into the item group.
+			 */
+			if (insert_new_item(tbl, i, pkt, sent_seq,
+						prev_idx, start_time) ==
+					INVALID_ARRAY_INDEX)
+				return -1;
+			return 0;
+		}
+		prev_idx = cur_idx;
+		cur_idx = tbl->items[cur_idx].next_pkt_idx;
+	} while (cur_idx != INVALID_ARRAY_INDEX);
+
+	/*
+	 * can't find a packet in the item group to merge,
+	 * so insert the packet into the item group.
+	 */
+	if (insert_new_item(tbl, i, pkt, sent_seq, prev_idx,
+				start_time) == INVALID_ARRAY_INDEX)
+		return -1;
+
+	return 0;
+}
+
+uint16_t
+gro_tcp6_tbl_timeout_flush(struct gro_tcp6_tbl *tbl,
+		uint64_t flush_timestamp,
+		struct rte_mbuf **out,
+		uint16_t nb_out)
+{
+	uint16_t k = 0;
+	uint32_t i, j, next_idx, key_idx, prev_idx;
+
+	/* walk the items from the oldest one */
+	i = gro_flow_item_oldest(&tbl->idx);
+	while (i != INVALID_ARRAY_INDEX && k < nb_out) {
+		/* newer packets won't be timeout either */
+		if (tbl->items[i].start_time > flush_timestamp)
+			break;
+
+		next_idx = gro_flow_item_newer(&tbl->idx, i);
+		key_idx = gro_flow_item_key(&tbl->idx, i);
+
+		out[k++] = tbl->items[i].firstseg;
+		if (tbl->items[i].nb_merged > 1)
+			update_header(&(tbl->items[i]));
+
+		/* delete the item and unchain it from its item group */
+		prev_idx = gro_tcp_find_prev_item(tbl->items,
+				tbl->keys[key_idx].start_index, i);
+		j = delete_item(tbl, i, prev_idx);
+		if (prev_idx == INVALID_ARRAY_INDEX) {
+			/*
+			 * delete the key if all of its packets are
+			 * flushed, otherwise update its start_index.
+			 */
+			if (j == INVALID_ARRAY_INDEX)
+				delete_key(tbl, key_idx);
+			else
+				tbl->keys[key_idx].start_index = j;
+		}
+
+		i = next_idx;
+	}
+	return k;
+}
+
+uint32_t
+gro_tcp6_tbl_pkt_count(void *tbl)
+{
+	struct gro_tcp6_tbl *gro_tbl = tbl;
+
+	if (gro_tbl)
+		return gro_tbl->item_num;
+
+	return 0;
+}
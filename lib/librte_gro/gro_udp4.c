@@ -0,0 +1,479 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_ip.h>
+
+#include "gro_udp4.h"
+
+void *
+gro_udp4_tbl_create(uint16_t socket_id,
+		uint16_t max_flow_num,
+		uint16_t max_item_per_flow)
+{
+	struct gro_udp4_tbl *tbl;
+	size_t size;
+	uint32_t entries_num, i;
+
+	entries_num = max_flow_num * max_item_per_flow;
+	entries_num = RTE_MIN(entries_num, GRO_UDP4_TBL_MAX_ITEM_NUM);
+
+	if (entries_num == 0)
+		return NULL;
+
+	tbl = rte_zmalloc_socket(__func__,
+			sizeof(struct gro_udp4_tbl),
+			RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (tbl == NULL)
+		return NULL;
+
+	size = sizeof(struct gro_udp4_item) * entries_num;
+	tbl->items = rte_zmalloc_socket(__func__,
+			size,
+			RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (tbl->items == NULL) {
+		rte_free(tbl);
+		return NULL;
+	}
+	tbl->max_item_num = entries_num;
+
+	size = sizeof(struct gro_udp4_key) * entries_num;
+	tbl->keys = rte_zmalloc_socket(__func__,
+			size,
+			RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (tbl->keys == NULL) {
+		rte_free(tbl->items);
+		rte_free(tbl);
+		return NULL;
+	}
+	/* INVALID_ARRAY_INDEX indicates empty key */
+	for (i = 0; i < entries_num; i++)
+		tbl->keys[i].start_index = INVALID_ARRAY_INDEX;
+	tbl->max_key_num = entries_num;
+
+	if (gro_flow_index_create(&tbl->idx, socket_id, entries_num,
+				entries_num) < 0) {
+		rte_free(tbl->keys);
+		rte_free(tbl->items);
+		rte_free(tbl);
+		return NULL;
+	}
+
+	return tbl;
+}
+
+void
+gro_udp4_tbl_destroy(void *tbl)
+{
+	struct gro_udp4_tbl *udp_tbl = tbl;
+
+	if (udp_tbl) {
+		rte_free(udp_tbl->items);
+		rte_free(udp_tbl->keys);
+		gro_flow_index_destroy(&udp_tbl->idx);
+	}
+	rte_free(udp_tbl);
+}
+
+static inline uint32_t
+insert_new_item(struct gro_udp4_tbl *tbl,
+		uint32_t key_idx,
+		struct rte_mbuf *pkt,
+		uint16_t frag_offset,
+		uint8_t is_last_frag,
+		uint32_t prev_idx,
+		uint64_t start_time)
+{
+	uint32_t item_idx;
+
+	item_idx = gro_flow_item_alloc(&tbl->idx, key_idx);
+	if (item_idx == INVALID_ARRAY_INDEX)
+		return INVALID_ARRAY_INDEX;
+
+	tbl->items[item_idx].firstseg = pkt;
+	tbl->items[item_idx].lastseg = rte_pktmbuf_lastseg(pkt);
+	tbl->items[item_idx].start_time = start_time;
+	tbl->items[item_idx].next_pkt_idx = INVALID_ARRAY_INDEX;
+	tbl->items[item_idx].frag_offset = frag_offset;
+	tbl->items[item_idx].is_last_frag = is_last_frag;
+	tbl->items[item_idx].nb_merged = 1;
+	tbl->item_num++;
+
+	/* if the previous packet exists, chain the new one with it */
+	if (prev_idx != INVALID_ARRAY_INDEX) {
+		tbl->items[item_idx].next_pkt_idx =
+			tbl->items[prev_idx].next_pkt_idx;
+		tbl->items[prev_idx].next_pkt_idx = item_idx;
+	}
+
+	return item_idx;
+}
+
+static inline uint32_t
+delete_item(struct gro_udp4_tbl *tbl, uint32_t item_idx,
+		uint32_t prev_item_idx)
+{
+	uint32_t next_idx = tbl->items[item_idx].next_pkt_idx;
+
+	/* set NULL to firstseg to indicate it's an empty item */
+	tbl->items[item_idx].firstseg = NULL;
+	gro_flow_item_free(&tbl->idx, item_idx);
+	tbl->item_num--;
+	if (prev_item_idx != INVALID_ARRAY_INDEX)
+		tbl->items[prev_item_idx].next_pkt_idx = next_idx;
+
+	return next_idx;
+}
+
+/*
+ * return the item before item_idx in the item group starting at
+ * start_idx, or INVALID_ARRAY_INDEX if item_idx is the first one.
+ */
+static inline uint32_t
+find_prev_item(struct gro_udp4_tbl *tbl,
+		uint32_t start_idx,
+		uint32_t item_idx)
+{
+	uint32_t prev_idx = INVALID_ARRAY_INDEX;
+
+	while (start_idx != item_idx) {
+		prev_idx = start_idx;
+		start_idx = tbl->items[start_idx].next_pkt_idx;
+	}
+	return prev_idx;
+}
+
+static inline uint32_t
+insert_new_key(struct gro_udp4_tbl *tbl,
+		const struct udp4_key *key_src,
+		uint32_t hash)
+{
+	uint32_t key_idx;
+
+	key_idx = gro_flow_key_alloc(&tbl->idx, hash);
+	if (key_idx == INVALID_ARRAY_INDEX)
+		return INVALID_ARRAY_INDEX;
+
+	tbl->keys[key_idx].key = *key_src;
+
+	tbl->key_num++;
+
+	return key_idx;
+}
+
+static inline void
+delete_key(struct gro_udp4_tbl *tbl, uint32_t key_idx)
+{
+	tbl->keys[key_idx].start_index = INVALID_ARRAY_INDEX;
+	gro_flow_key_free(&tbl->idx, key_idx);
+	tbl->key_num--;
+}
+
+static inline int
+is_same_udp4_key(const struct udp4_key *k1, const struct udp4_key *k2)
+{
+	if (is_same_ether_addr(&k1->eth_saddr, &k2->eth_saddr) == 0)
+		return 0;
+
+	if (is_same_ether_addr(&k1->eth_daddr, &k2->eth_daddr) == 0)
+		return 0;
+
+	return ((k1->ip_src_addr == k2->ip_src_addr) &&
+			(k1->ip_dst_addr == k2->ip_dst_addr) &&
+			(k1->ip_id == k2->ip_id));
+}
+
+/*
+ * check if the new fragment and the packet of the item are contiguous.
+ * Return 1 to append the new fragment, -1 to pre-pend it and 0 if
+ * they can't be merged.
+ */
+static inline int
+udp4_check_neighbor(struct gro_udp4_item *item,
+		uint16_t frag_offset,
+		uint16_t ip_dl,
+		uint8_t is_last_frag)
+{
+	struct rte_mbuf *pkt_orig = item->firstseg;
+	uint16_t len;
+
+	len = pkt_orig->pkt_len - pkt_orig->l2_len - pkt_orig->l3_len;
+	if ((item->is_last_frag == 0) &&
+			(frag_offset == item->frag_offset + len))
+		/* append the new fragment */
+		return 1;
+	else if ((is_last_frag == 0) &&
+			(frag_offset + ip_dl == item->frag_offset))
+		/* pre-pend the new fragment */
+		return -1;
+
+	return 0;
+}
+
+/*
+ * merge two UDP/IPv4 fragments without updating checksums.
+ */
+static inline int
+merge_two_udp4_packets(struct gro_udp4_item *item,
+		struct rte_mbuf *pkt,
+		int cmp,
+		uint16_t frag_offset,
+		uint8_t is_last_frag)
+{
+	struct rte_mbuf *pkt_head, *pkt_tail, *lastseg;
+	uint32_t ip_dl;
+
+	if (cmp > 0) {
+		pkt_head = item->firstseg;
+		pkt_tail = pkt;
+	} else {
+		pkt_head = pkt;
+		pkt_tail = item->firstseg;
+	}
+
+	/* check if the IPv4 packet length will be beyond the max value */
+	ip_dl = pkt_tail->pkt_len - pkt_tail->l2_len - pkt_tail->l3_len;
+	if (pkt_head->pkt_len - pkt_head->l2_len + ip_dl > GRO_MAX_LENGTH)
+		return 0;
+
+	/* remove packet header for the tail packet */
+	rte_pktmbuf_adj(pkt_tail, pkt_tail->l2_len + pkt_tail->l3_len);
+
+	/* chain two packets together */
+	if (cmp > 0) {
+		item->lastseg->next = pkt;
+		item->lastseg = rte_pktmbuf_lastseg(pkt);
+		item->is_last_frag = is_last_frag;
+	} else {
+		lastseg = rte_pktmbuf_lastseg(pkt);
+		lastseg->next = item->firstseg;
+		item->firstseg = pkt;
+		item->frag_offset = frag_offset;
+	}
+	item->nb_merged++;
+
+	/* update mbuf metadata for the merged packet */
+	pkt_head->nb_segs += pkt_tail->nb_segs;
+	pkt_head->pkt_len += pkt_tail->pkt_len;
+
+	return 1;
+}
+
+/*
+ * update packet length and fragment offset for the flushed packet.
+ */
+static inline void
+update_header(struct gro_udp4_item *item)
+{
+	struct ipv4_hdr *ipv4_hdr;
+	struct rte_mbuf *pkt = item->firstseg;
+	uint16_t frag_offset;
+
+	ipv4_hdr = (struct ipv4_hdr *)(rte_pktmbuf_mtod(pkt, char *) +
+			pkt->l2_len);
+	ipv4_hdr->total_length = rte_cpu_to_be_16(pkt->pkt_len -
+			pkt->l2_len);
+
+	frag_offset = rte_be_to_cpu_16(ipv4_hdr->fragment_offset);
+	frag_offset &= ~(IPV4_HDR_OFFSET_MASK | IPV4_HDR_MF_FLAG);
+	frag_offset |= item->frag_offset / IPV4_HDR_OFFSET_UNITS;
+	if (item->is_last_frag == 0)
+		frag_offset |= IPV4_HDR_MF_FLAG;
+	ipv4_hdr->fragment_offset = rte_cpu_to_be_16(frag_offset);
+}
+
+int32_t
+gro_udp4_reassemble(struct rte_mbuf *pkt,
+		struct gro_udp4_tbl *tbl,
+		uint64_t start_time)
+{
+	struct ether_hdr *eth_hdr;
+	struct ipv4_hdr *ipv4_hdr;
+	uint16_t ip_dl, frag_offset;
+	uint8_t is_last_frag;
+
+	struct udp4_key key;
+	uint32_t cur_idx, prev_idx, item_idx;
+	uint32_t i, hash;
+	int cmp;
+
+	eth_hdr = rte_pktmbuf_mtod(pkt, struct ether_hdr *);
+	ipv4_hdr = (struct ipv4_hdr *)((char *)eth_hdr + pkt->l2_len);
+
+	/* only UDP fragments are merged */
+	if (ipv4_hdr->next_proto_id != IPPROTO_UDP)
+		return -1;
+	frag_offset = rte_be_to_cpu_16(ipv4_hdr->fragment_offset);
+	is_last_frag = (frag_offset & IPV4_HDR_MF_FLAG) == 0;
+	frag_offset = (frag_offset & IPV4_HDR_OFFSET_MASK) *
+		IPV4_HDR_OFFSET_UNITS;
+	if (is_last_frag && frag_offset == 0)
+		return -1;
+
+	/* if payload length is 0, return immediately */
+	ip_dl = rte_be_to_cpu_16(ipv4_hdr->total_length) - pkt->l3_len;
+	if (ip_dl == 0)
+		return -1;
+
+	ether_addr_copy(&(eth_hdr->s_addr), &(key.eth_saddr));
+	ether_addr_copy(&(eth_hdr->d_addr), &(key.eth_daddr));
+	key.ip_src_addr = ipv4_hdr->src_addr;
+	key.ip_dst_addr = ipv4_hdr->dst_addr;
+	key.ip_id = ipv4_hdr->packet_id;
+
+	/* search for a key in the bucket of its hash value */
+	hash = udp4_key_hash(&key);
+	for (i = gro_flow_key_first(&tbl->idx, hash);
+			i != INVALID_ARRAY_INDEX;
+			i = gro_flow_key_next(&tbl->idx, i)) {
+		if (is_same_udp4_key(&tbl->keys[i].key, &key))
+			break;
+	}
+
+	/* can't find a key, so insert a new key and a new item. */
+	if (i == INVALID_ARRAY_INDEX) {
+		i = insert_new_key(tbl, &key, hash);
+		if (i == INVALID_ARRAY_INDEX)
+			return -1;
+		item_idx = insert_new_item(tbl, i, pkt, frag_offset,
+				is_last_frag, INVALID_ARRAY_INDEX, start_time);
+		if (item_idx == INVALID_ARRAY_INDEX) {
+			/*
+			 * fail to insert a new item, so
+			 * delete the inserted key
+			 */
+			delete_key(tbl, i);
+			return -1;
+		}
+		/* non-INVALID_ARRAY_INDEX value indicates the key is valid */
+		tbl->keys[i].start_index = item_idx;
+		return 0;
+	}
+
+	/* traverse all packets in the item group to find one to merge */
+	cur_idx = tbl->keys[i].start_index;
+	prev_idx = cur_idx;
+	do {
+		cmp = udp4_check_neighbor(&(tbl->items[cur_idx]),
+				frag_offset, ip_dl, is_last_frag);
+		if (cmp) {
+			if (merge_two_udp4_packets(&(tbl->items[cur_idx]),
+						pkt, cmp, frag_offset,
+						is_last_frag))
+				return 1;
+			/*
+			 * fail to merge two packets since the packet
+			 * length will be greater than the max value.
+			 * So insert the packet into the item group.
+			 */
+			if (insert_new_item(tbl, i, pkt, frag_offset,
+						is_last_frag, prev_idx,
+						start_time) ==
+					INVALID_ARRAY_INDEX)
+				return -1;
+			return 0;
+		}
+		prev_idx = cur_idx;
+		cur_idx = tbl->items[cur_idx].next_pkt_idx;
+	} while (cur_idx != INVALID_ARRAY_INDEX);
+
+	/*
+	 * can't find a packet in the item group to merge,
+	 * so insert the packet into the item group.
+	 */
+	if (insert_new_item(tbl, i, pkt, frag_offset, is_last_frag, prev_idx,
+				start_time) == INVALID_ARRAY_INDEX)
+		return -1;
+
+	return 0;
+}
+
+uint16_t
+gro_udp4_tbl_timeout_flush(struct gro_udp4_tbl *tbl,
+		uint64_t flush_timestamp,
+		struct rte_mbuf **out,
+		uint16_t nb_out)
+{
+	uint16_t k = 0;
+	uint32_t i, j, next_idx, key_idx, prev_idx;
+
+	/* walk the items from the oldest one */
+	i = gro_flow_item_oldest(&tbl->idx);
+	while (i != INVALID_ARRAY_INDEX && k < nb_out) {
+		/* newer packets won't be timeout either */
+		if (tbl->items[i].start_time > flush_timestamp)
+			break;
+
+		next_idx = gro_flow_item_newer(&tbl->idx, i);
+		key_idx = gro_flow_item_key(&tbl->idx, i);
+
+		out[k++] = tbl->items[i].firstseg;
+		if (tbl->items[i].nb_merged > 1)
+			update_header(&(tbl->items[i]));
+
+		/* delete the item and unchain it from its item group */
+		prev_idx = find_prev_item(tbl,
+				tbl->keys[key_idx].start_index, i);
+		j = delete_item(tbl, i, prev_idx);
+		if (prev_idx == INVALID_ARRAY_INDEX) {
+			/*
+			 * delete the key if all of its packets are
+			 * flushed, otherwise update its start_index.
+			 */
+			if (j == INVALID_ARRAY_INDEX)
+				delete_key(tbl, key_idx);
+			else
+				tbl->keys[key_idx].start_index = j;
+		}
+
+		i = next_idx;
+	}
+	return k;
+}
+
+uint32_t
+gro_udp4_tbl_pkt_count(void *tbl)
+{
+	struct gro_udp4_tbl *gro_tbl = tbl;
+
+	if (gro_tbl)
+		return gro_tbl->item_num;
+
+	return 0;
+}
@@ -0,0 +1,492 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
+#include <rte_tcp.h>
+
+#include "gro_vxlan_tcp4.h"
+
+void *
+gro_vxlan_tcp4_tbl_create(uint16_t socket_id,
+		uint16_t max_flow_num,
+		uint16_t max_item_per_flow)
+{
+	struct gro_vxlan_tcp4_tbl *tbl;
+	size_t size;
+	uint32_t entries_num, i;
+
+	entries_num = max_flow_num * max_item_per_flow;
+	entries_num = RTE_MIN(entries_num, GRO_VXLAN_TCP4_TBL_MAX_ITEM_NUM);
+
+	if (entries_num == 0)
+		return NULL;
+
+	tbl = rte_zmalloc_socket(__func__,
+			sizeof(struct gro_vxlan_tcp4_tbl),
+			RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (tbl == NULL)
+		return NULL;
+
+	size = sizeof(struct gro_vxlan_tcp4_item) * entries_num;
+	tbl->items = rte_zmalloc_socket(__func__,
+			size,
+			RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (tbl->items == NULL) {
+		rte_free(tbl);
+		return NULL;
+	}
+	tbl->max_item_num = entries_num;
+
+	size = sizeof(struct gro_vxlan_tcp4_key) * entries_num;
+	tbl->keys = rte_zmalloc_socket(__func__,
+			size,
+			RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (tbl->keys == NULL) {
+		rte_free(tbl->items);
+		rte_free(tbl);
+		return NULL;
+	}
+	/* INVALID_ARRAY_INDEX indicates empty key */
+	for (i = 0; i < entries_num; i++)
+		tbl->keys[i].start_index = INVALID_ARRAY_INDEX;
+	tbl->max_key_num = entries_num;
+
+	if (gro_flow_index_create(&tbl->idx, socket_id, entries_num,
+				entries_num) < 0) {
+		rte_free(tbl->keys);
+		rte_free(tbl->items);
+		rte_free(tbl);
+		return NULL;
+	}
+
+	return tbl;
+}
+
+void
+gro_vxlan_tcp4_tbl_destroy(void *tbl)
+{
+	struct gro_vxlan_tcp4_tbl *vxlan_tbl = tbl;
+
+	if (vxlan_tbl) {
+		rte_free(vxlan_tbl->items);
+		rte_free(vxlan_tbl->keys);
+		gro_flow_index_destroy(&vxlan_tbl->idx);
+	}
+	rte_free(vxlan_tbl);
+}
+
+static inline uint32_t
+insert_new_item(struct gro_vxlan_tcp4_tbl *tbl,
+		uint32_t key_idx,
+		struct rte_mbuf *pkt,
+		uint16_t outer_ip_id,
+		uint16_t ip_id,
+		uint32_t sent_seq,
+		uint32_t prev_idx,
+		uint64_t start_time)
+{
+	struct gro_tcp_item *inner;
+	uint32_t item_idx;
+
+	item_idx = gro_flow_item_alloc(&tbl->idx, key_idx);
+	if (item_idx == INVALID_ARRAY_INDEX)
+		return INVALID_ARRAY_INDEX;
+
+	inner = &tbl->items[item_idx].inner_item;
+	inner->firstseg = pkt;
+	inner->lastseg = rte_pktmbuf_lastseg(pkt);
+	inner->start_time = start_time;
+	inner->next_pkt_idx = INVALID_ARRAY_INDEX;
+	inner->sent_seq = sent_seq;
+	inner->ip_id = ip_id;
+	inner->nb_merged = 1;
+	tbl->items[item_idx].outer_ip_id = outer_ip_id;
+	tbl->item_num++;
+
+	/* if the previous packet exists, chain the new one with it */
+	if (prev_idx != INVALID_ARRAY_INDEX) {
+		inner->next_pkt_idx =
+			tbl->items[prev_idx].inner_item.next_pkt_idx;
+		tbl->items[prev_idx].inner_item.next_pkt_idx = item_idx;
+	}
+
+	return item_idx;
+}
+
+static inline uint32_t
+delete_item(struct gro_vxlan_tcp4_tbl *tbl, uint32_t item_idx,
+		uint32_t prev_item_idx)
+{
+	uint32_t next_idx = tbl->items[item_idx].inner_item.next_pkt_idx;
+
+	/* set NULL to firstseg to indicate it's an empty item */
+	tbl->items[item_idx].inner_item.firstseg = NULL;
+	gro_flow_item_free(&tbl->idx, item_idx);
+	tbl->item_num--;
+	if (prev_item_idx != INVALID_ARRAY_INDEX)
+		tbl->items[prev_item_idx].inner_item.next_pkt_idx = next_idx;
+
+	return next_idx;
+}
+
+/*
+ * return the item before item_idx in the item group starting at
+ * start_idx, or INVALID_ARRAY_INDEX if item_idx is the first one.
+ */
+static inline uint32_t
+find_prev_item(struct gro_vxlan_tcp4_tbl *tbl,
+		uint32_t start_idx,
+		uint32_t item_idx)
+{
+	uint32_t prev_idx = INVALID_ARRAY_INDEX;
+
+	while (start_idx != item_idx) {
+		prev_idx = start_idx;
+		start_idx = tbl->items[start_idx].inner_item.next_pkt_idx;
+	}
+	return prev_idx;
+}
+
+static inline uint32_t
+insert_new_key(struct gro_vxlan_tcp4_tbl *tbl,
+		const struct vxlan_tcp4_key *key_src,
+		uint32_t hash)
+{
+	uint32_t key_idx;
+
+	key_idx = gro_flow_key_alloc(&tbl->idx, hash);
+	if (key_idx == INVALID_ARRAY_INDEX)
+		return INVALID_ARRAY_INDEX;
+
+	tbl->keys[key_idx].key = *key_src;
+
+	tbl->key_num++;
+
+	return key_idx;
+}
+
+static inline void
+delete_key(struct gro_vxlan_tcp4_tbl *tbl, uint32_t key_idx)
+{
+	tbl->keys[key_idx].start_index = INVALID_ARRAY_INDEX;
+	gro_flow_key_free(&tbl->idx, key_idx);
+	tbl->key_num--;
+}
+
+static inline int
+is_same_vxlan_tcp4_key(const struct vxlan_tcp4_key *k1,
+		const struct vxlan_tcp4_key *k2)
+{
+	const struct tcp4_key *i1 = &k1->inner_key;
+	const struct tcp4_key *i2 = &k2->inner_key;
+
+	if (is_same_ether_addr(&k1->outer_eth_saddr,
+				&k2->outer_eth_saddr) == 0 ||
+			is_same_ether_addr(&k1->outer_eth_daddr,
+				&k2->outer_eth_daddr) == 0 ||
+			is_same_ether_addr(&i1->eth_saddr,
+				&i2->eth_saddr) == 0 ||
+			is_same_ether_addr(&i1->eth_daddr,
+				&i2->eth_daddr) == 0)
+		return 0;
+
+	return ((k1->outer_ip_src_addr == k2->outer_ip_src_addr) &&
+			(k1->outer_ip_dst_addr == k2->outer_ip_dst_addr) &&
+			(k1->outer_src_port == k2->outer_src_port) &&
+			(k1->outer_dst_port == k2->outer_dst_port) &&
+			(k1->vxlan_hdr.vx_flags == k2->vxlan_hdr.vx_flags) &&
+			(k1->vxlan_hdr.vx_vni == k2->vxlan_hdr.vx_vni) &&
+			(i1->ip_src_addr == i2->ip_src_addr) &&
+			(i1->ip_dst_addr == i2->ip_dst_addr) &&
+			(i1->recv_ack == i2->recv_ack) &&
+			(i1->src_port == i2->src_port) &&
+			(i1->dst_port == i2->dst_port));
+}
+
+/*
+ * check if the inner packets are neighbors and if the outer
+ * IP IDs are consecutive as well.
+ */
+static inline int
+check_vxlan_seq_option(struct gro_vxlan_tcp4_item *item,
+		struct rte_mbuf *pkt,
+		struct tcp_hdr *tcp_hdr,
+		uint32_t sent_seq,
+		uint16_t outer_ip_id,
+		uint16_t ip_id,
+		uint16_t tcp_dl)
+{
+	int cmp;
+
+	cmp = check_seq_option(&item->inner_item, tcp_hdr, sent_seq, ip_id,
+			pkt->l4_len, tcp_dl,
+			pkt->outer_l2_len + pkt->outer_l3_len, 0);
+
+	if ((cmp > 0) && (outer_ip_id == (uint16_t)(item->outer_ip_id + 1)))
+		return 1;
+	else if ((cmp < 0) && ((uint16_t)(outer_ip_id +
+				item->inner_item.nb_merged) ==
+				item->outer_ip_id))
+		return -1;
+
+	return 0;
+}
+
+/*
+ * update the outer IPv4, outer UDP and inner IPv4 length fields
+ * of the flushed packet.
+ */
+static inline void
+update_vxlan_header(struct gro_vxlan_tcp4_item *item)
+{
+	struct ipv4_hdr *ipv4_hdr;
+	struct udp_hdr *udp_hdr;
+	struct rte_mbuf *pkt = item->inner_item.firstseg;
+	uint16_t len;
+
+	/* outer IPv4 header */
+	ipv4_hdr = (struct ipv4_hdr *)(rte_pktmbuf_mtod(pkt, char *) +
+			pkt->outer_l2_len);
+	len = pkt->pkt_len - pkt->outer_l2_len;
+	ipv4_hdr->total_length = rte_cpu_to_be_16(len);
+
+	/* outer UDP header */
+	udp_hdr = (struct udp_hdr *)((char *)ipv4_hdr + pkt->outer_l3_len);
+	len -= pkt->outer_l3_len;
+	udp_hdr->dgram_len = rte_cpu_to_be_16(len);
+
+	/* inner IPv4 header */
+	ipv4_hdr = (struct ipv4_hdr *)((char *)udp_hdr + pkt->l2_len);
+	len -= pkt->l2_len;
+	ipv4_hdr->total_length = rte_cpu_to_be_16(len);
+}
+
+int32_t
+gro_vxlan_tcp4_reassemble(struct rte_mbuf *pkt,
+		struct gro_vxlan_tcp4_tbl *tbl,
+		uint64_t start_time)
+{
+	struct ether_hdr *outer_eth_hdr, *eth_hdr;
+	struct ipv4_hdr *outer_ipv4_hdr, *ipv4_hdr;
+	struct udp_hdr *udp_hdr;
+	struct vxlan_hdr *vxlan_hdr;
+	struct tcp_hdr *tcp_hdr;
+	uint32_t sent_seq;
+	uint16_t tcp_dl, ip_id, outer_ip_id;
+
+	struct vxlan_tcp4_key key;
+	uint32_t cur_idx, prev_idx, item_idx;
+	uint32_t i, hash;
+	int cmp;
+
+	outer_eth_hdr = rte_pktmbuf_mtod(pkt, struct ether_hdr *);
+	outer_ipv4_hdr = (struct ipv4_hdr *)((char *)outer_eth_hdr +
+			pkt->outer_l2_len);
+	udp_hdr = (struct udp_hdr *)((char *)outer_ipv4_hdr +
+			pkt->outer_l3_len);
+	vxlan_hdr = (struct vxlan_hdr *)(udp_hdr + 1);
+	eth_hdr = (struct ether_hdr *)(vxlan_hdr + 1);
+	ipv4_hdr = (struct ipv4_hdr *)((char *)udp_hdr + pkt->l2_len);
+	tcp_hdr = (struct tcp_hdr *)((char *)ipv4_hdr + pkt->l3_len);
+
+	/*
+	 * if FIN, SYN, RST, PSH, URG, ECE or
+	 * CWR is set, return immediately.
+	 */
+	if (tcp_hdr->tcp_flags != TCP_ACK_FLAG)
+		return -1;
+	/* if payload length is 0, return immediately */
+	tcp_dl = rte_be_to_cpu_16(ipv4_hdr->total_length) - pkt->l3_len -
+		pkt->l4_len;
+	if (tcp_dl == 0)
+		return -1;
+
+	outer_ip_id = rte_be_to_cpu_16(outer_ipv4_hdr->packet_id);
+	ip_id = rte_be_to_cpu_16(ipv4_hdr->packet_id);
+	sent_seq = rte_be_to_cpu_32(tcp_hdr->sent_seq);
+
+	ether_addr_copy(&(eth_hdr->s_addr), &(key.inner_key.eth_saddr));
+	ether_addr_copy(&(eth_hdr->d_addr), &(key.inner_key.eth_daddr));
+	key.inner_key.ip_src_addr = ipv4_hdr->src_addr;
+	key.inner_key.ip_dst_addr = ipv4_hdr->dst_addr;
+	key.inner_key.recv_ack = tcp_hdr->recv_ack;
+	key.inner_key.src_port = tcp_hdr->src_port;
+	key.inner_key.dst_port = tcp_hdr->dst_port;
+
+	key.vxlan_hdr.vx_flags = vxlan_hdr->vx_flags;
+	key.vxlan_hdr.vx_vni = vxlan_hdr->vx_vni;
+	ether_addr_copy(&(outer_eth_hdr->s_addr), &(key.outer_eth_saddr));
+	ether_addr_copy(&(outer_eth_hdr->d_addr), &(key.outer_eth_daddr));
+	key.outer_ip_src_addr = outer_ipv4_hdr->src_addr;
+	key.outer_ip_dst_addr = outer_ipv4_hdr->dst_addr;
+	key.outer_src_port = udp_hdr->src_port;
+	key.outer_dst_port = udp_hdr->dst_port;
+
+	/* search for a key in the bucket of its hash value */
+	hash = vxlan_tcp4_key_hash(&key);
+	for (i = gro_flow_key_first(&tbl->idx, hash);
+			i != INVALID_ARRAY_INDEX;
+			i = gro_flow_key_next(&tbl->idx, i)) {
+		if (is_same_vxlan_tcp4_key(&tbl->keys[i].key, &key))
+			break;
+	}
+
+	/* can't find a key, so insert a new key and a new item. */
+	if (i == INVALID_ARRAY_INDEX) {
+		i = insert_new_key(tbl, &key, hash);
+		if (i == INVALID_ARRAY_INDEX)
+			return -1;
+		item_idx = insert_new_item(tbl, i, pkt, outer_ip_id, ip_id,
+				sent_seq, INVALID_ARRAY_INDEX, start_time);
+		if (item_idx == INVALID_ARRAY_INDEX) {
+			/*
+			 * fail to insert a new item, so
+			 * delete the inserted key
+			 */
+			delete_key(tbl, i);
+			return -1;
+		}
+		/* non-INVALID_ARRAY_INDEX value indicates the key is valid */
+		tbl->keys[i].start_index = item_idx;
+		return 0;
+	}
+
+	/* traverse all packets in the item group to find one to merge */
+	cur_idx = tbl->keys[i].start_index;
+	prev_idx = cur_idx;
+	do {
+		cmp = check_vxlan_seq_option(&(tbl->items[cur_idx]), pkt,
+				tcp_hdr, sent_seq, outer_ip_id, ip_id, tcp_dl);
+		if (cmp) {
+			if (merge_two_tcp_packets(
+						&(tbl->items[cur_idx].inner_item),
+						pkt, cmp, sent_seq, ip_id,
+						pkt->outer_l2_len +
+						pkt->outer_l3_len +
+						pkt->l2_len + pkt->l3_len +
+						pkt->l4_len,
+						pkt->outer_l2_len)) {
+				/* update outer IP ID to the larger value */
+				if (cmp > 0)
+					tbl->items[cur_idx].outer_ip_id =
+						outer_ip_id;
+				return 1;
+			}
+			/*
+			 * fail to merge two packets since the packet
+			 * length will be greater than the max value.
+			 * So insert the packet into the item group.
+			 */
+			if (insert_new_item(tbl, i, pkt, outer_ip_id, ip_id,
+						sent_seq, prev_idx,
+						start_time) ==
+					INVALID_ARRAY_INDEX)
+				return -1;
+			return 0;
+		}
+		prev_idx = cur_idx;
+		cur_idx = tbl->items[cur_idx].inner_item.next_pkt_idx;
+	} while (cur_idx != INVALID_ARRAY_INDEX);
+
+	/*
+	 * can't find a packet in the item group to merge,
+	 * so insert the packet into the item group.
+	 */
+	if (insert_new_item(tbl, i, pkt, outer_ip_id, ip_id, sent_seq,
+				prev_idx, start_time) == INVALID_ARRAY_INDEX)
+		return -1;
+
+	return 0;
+}
+
+uint16_t
+gro_vxlan_tcp4_tbl_timeout_flush(struct gro_vxlan_tcp4_tbl *tbl,
+		uint64_t flush_timestamp,
+		struct rte_mbuf **out,
+		uint16_t nb_out)
+{
+	uint16_t k = 0;
+	uint32_t i, j, next_idx, key_idx, prev_idx;
+
+	/* walk the items from the oldest one */
+	i = gro_flow_item_oldest(&tbl->idx);
+	while (i != INVALID_ARRAY_INDEX && k < nb_out) {
+		/* newer packets won't be timeout either */
+		if (tbl->items[i].inner_item.start_time > flush_timestamp)
+			break;
+
+		next_idx = gro_flow_item_newer(&tbl->idx, i);
+		key_idx = gro_flow_item_key(&tbl->idx, i);
+
+		out[k++] = tbl->items[i].inner_item.firstseg;
+		if (tbl->items[i].inner_item.nb_merged > 1)
+			update_vxlan_header(&(tbl->items[i]));
+
+		/* delete the item and unchain it from its item group */
+		prev_idx = find_prev_item(tbl,
+				tbl->keys[key_idx].start_index, i);
+		j = delete_item(tbl, i, prev_idx);
+		if (prev_idx == INVALID_ARRAY_INDEX) {
+			/*
+			 * delete the key if all of its packets are
+			 * flushed, otherwise update its start_index.
+			 */
+			if (j == INVALID_ARRAY_INDEX)
+				delete_key(tbl, key_idx);
+			else
+				tbl->keys[key_idx].start_index = j;
+		}
+
+		i = next_idx;
+	}
+	return k;
+}
+
+uint32_t
+gro_vxlan_tcp4_tbl_pkt_count(void *tbl)
+{
+	struct gro_vxlan_tcp4_tbl *gro_tbl = tbl;
+
+	if (gro_tbl)
+		return gro_tbl->item_num;
+
+	return 0;
+}
@@ -0,0 +1,189 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef _GRO_VXLAN_TCP4_H_
+#define _GRO_VXLAN_TCP4_H_
+
+#include "gro_tcp4.h"
+
+#define GRO_VXLAN_TCP4_TBL_MAX_ITEM_NUM (1024UL * 1024UL)
+
+/* criteria of merging VXLAN packets */
+struct vxlan_tcp4_key {
+	/* criteria of the inner TCP/IPv4 packet */
+	struct tcp4_key inner_key;
+	/* VXLAN flags and VNI */
+	struct vxlan_hdr vxlan_hdr;
+	struct ether_addr outer_eth_saddr;
+	struct ether_addr outer_eth_daddr;
+	uint32_t outer_ip_src_addr;
+	uint32_t outer_ip_dst_addr;
+	uint16_t outer_src_port;
+	uint16_t outer_dst_port;
+};
+
+struct gro_vxlan_tcp4_key {
+	struct vxlan_tcp4_key key;
+	/*
+	 * the index of the first packet in the item group.
+	 * If the value is INVALID_ARRAY_INDEX, it means
+	 * the key is empty.
+	 */
+	uint32_t start_index;
+};
+
+struct gro_vxlan_tcp4_item {
+	/* inner TCP/IPv4 packet information */
+	struct gro_tcp_item inner_item;
+	/* the IP ID of the outer IPv4 header */
+	uint16_t outer_ip_id;
+};
+
+/*
+ * VXLAN (with an outer IPv4 header) reassembly table structure.
+ */
+struct gro_vxlan_tcp4_tbl {
+	/* item array */
+	struct gro_vxlan_tcp4_item *items;
+	/* key array */
+	struct gro_vxlan_tcp4_key *keys;
+	/* current item number */
+	uint32_t item_num;
+	/* current key num */
+	uint32_t key_num;
+	/* item array size */
+	uint32_t max_item_num;
+	/* key array size */
+	uint32_t max_key_num;
+	/* hash index of the keys and age list of the items */
+	struct gro_flow_index idx;
+};
+
+static inline uint32_t
+vxlan_tcp4_key_hash(const struct vxlan_tcp4_key *key)
+{
+	return rte_jhash_3words(tcp4_key_hash(&key->inner_key),
+			key->vxlan_hdr.vx_vni, key->outer_src_port, 0);
+}
+
+/**
+ * This function creates a VXLAN reassembly table for VXLAN packets
+ * which have an outer IPv4 header and an inner TCP/IPv4 packet.
+ *
+ * @param socket_id
+ *  socket index for allocating the reassembly table
+ * @param max_flow_num
+ *  the maximum number of flows in the table
+ * @param max_item_per_flow
+ *  the maximum packet number per flow.
+ *
+ * @return
+ *  if create successfully, return a pointer which points to the
+ *  created VXLAN GRO table. Otherwise, return NULL.
+ */
+void *gro_vxlan_tcp4_tbl_create(uint16_t socket_id,
+		uint16_t max_flow_num,
+		uint16_t max_item_per_flow);
+
+/**
+ * This function destroys a VXLAN reassembly table.
+ *
+ * @param tbl
+ *  a pointer points to the VXLAN reassembly table.
+ */
+void gro_vxlan_tcp4_tbl_destroy(void *tbl);
+
+/**
+ * This function merges a VXLAN packet which has an outer IPv4 header
+ * and an inner TCP/IPv4 packet. It doesn't check if the packet has
+ * correct checksums and doesn't re-calculate checksums for the merged
+ * packet. Besides, it assumes the mbuf outer_l2_len, outer_l3_len,
+ * l2_len (outer UDP, VXLAN and inner Ethernet headers), l3_len and
+ * l4_len fields are set. Packets whose inner TCP header has another
+ * flag than ACK, or without inner TCP payload, are returned
+ * immediately.
+ *
+ * @param pkt
+ *  packet to reassemble.
+ * @param tbl
+ *  a pointer that points to a VXLAN reassembly table.
+ * @start_time
+ *  the start time that the packet is inserted into the table
+ *
+ * @return
+ *  if the packet doesn't have inner TCP payload, or has another inner
+ *  TCP flag than ACK, or there is no available space in the table to
+ *  insert a new item or a new key, return a negative value. If the
+ *  packet is merged successfully, return an positive value. If the
+ *  packet is inserted into the table, return 0.
+ */
+int32_t gro_vxlan_tcp4_reassemble(struct rte_mbuf *pkt,
+		struct gro_vxlan_tcp4_tbl *tbl,
+		uint64_t start_time);
+
+/**
+ * This function flushes timeout packets in the VXLAN reassembly table,
+ * and without updating checksums. Packets are flushed from the oldest
+ * one, and only the timeout ones are visited.
+ *
+ * @param tbl
+ *  a pointer that points to a VXLAN GRO table.
+ * @param flush_timestamp
+ *  this function flushes packets which are inserted into the table
+ *  before or at the flush_timestamp.
+ * @param out
+ *  pointer array which is used to keep flushed packets.
+ * @param nb_out
+ *  the element number of out. It's also the max number of timeout
+ *  packets that can be flushed finally.
+ *
+ * @return
+ *  the number of packets that are returned.
+ */
+uint16_t gro_vxlan_tcp4_tbl_timeout_flush(struct gro_vxlan_tcp4_tbl *tbl,
+		uint64_t flush_timestamp,
+		struct rte_mbuf **out,
+		uint16_t nb_out);
+
+/**
+ * This function returns the number of the packets in a VXLAN
+ * reassembly table.
+ *
+ * @param tbl
+ *  pointer points to a VXLAN reassembly table.
+ *
+ * @return
+ *  the number of packets in the table
+ */
+uint32_t gro_vxlan_tcp4_tbl_pkt_count(void *tbl);
+#endif
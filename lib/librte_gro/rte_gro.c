@@ -37,6 +37,9 @@
 
 #include "rte_gro.h"
 #include "gro_tcp4.h"
+#include "gro_tcp6.h"
+#include "gro_udp4.h"
+#include "gro_vxlan_tcp4.h"
 
 typedef void *(*gro_tbl_create_fn)(uint16_t socket_id,
 		uint16_t max_flow_num,
@@ -45,11 +48,44 @@ typedef void (*gro_tbl_destroy_fn)(void *tbl);
 typedef uint32_t (*gro_tbl_pkt_count_fn)(void *tbl);
 
 static gro_tbl_create_fn tbl_create_fn[RTE_GRO_TYPE_MAX_NUM] = {
-		gro_tcp4_tbl_create, NULL};
+		gro_tcp4_tbl_create, gro_vxlan_tcp4_tbl_create,
+		gro_udp4_tbl_create, gro_tcp6_tbl_create, NULL};
 static gro_tbl_destroy_fn tbl_destroy_fn[RTE_GRO_TYPE_MAX_NUM] = {
-			gro_tcp4_tbl_destroy, NULL};
+			gro_tcp4_tbl_destroy, gro_vxlan_tcp4_tbl_destroy,
+			gro_udp4_tbl_destroy, gro_tcp6_tbl_destroy, NULL};
 static gro_tbl_pkt_count_fn tbl_pkt_count_fn[RTE_GRO_TYPE_MAX_NUM] = {
-			gro_tcp4_tbl_pkt_count, NULL};
+			gro_tcp4_tbl_pkt_count, gro_vxlan_tcp4_tbl_pkt_count,
+			gro_udp4_tbl_pkt_count, gro_tcp6_tbl_pkt_count, NULL};
+
+#define IS_IPV4_TCP_PKT(ptype) (RTE_ETH_IS_IPV4_HDR(ptype) && \
+		(((ptype) & RTE_PTYPE_L4_MASK) == RTE_PTYPE_L4_TCP) && \
+		(RTE_ETH_IS_TUNNEL_PKT(ptype) == 0))
+
+#define IS_IPV6_TCP_PKT(ptype) (RTE_ETH_IS_IPV6_HDR(ptype) && \
+		(((ptype) & RTE_PTYPE_L4_MASK) == RTE_PTYPE_L4_TCP) && \
+		(RTE_ETH_IS_TUNNEL_PKT(ptype) == 0))
+
+/* UDP/IPv4 fragments are reported either as UDP or as fragments */
+#define IS_IPV4_UDP_PKT(ptype) (RTE_ETH_IS_IPV4_HDR(ptype) && \
+		((((ptype) & RTE_PTYPE_L4_MASK) == RTE_PTYPE_L4_UDP) || \
+		 (((ptype) & RTE_PTYPE_L4_MASK) == RTE_PTYPE_L4_FRAG)) && \
+		(RTE_ETH_IS_TUNNEL_PKT(ptype) == 0))
+
+#define IS_INNER_IPV4_HDR(ptype) \
+		((((ptype) & RTE_PTYPE_INNER_L3_MASK) == \
+			RTE_PTYPE_INNER_L3_IPV4) || \
+		(((ptype) & RTE_PTYPE_INNER_L3_MASK) == \
+			RTE_PTYPE_INNER_L3_IPV4_EXT) || \
+		(((ptype) & RTE_PTYPE_INNER_L3_MASK) == \
+			RTE_PTYPE_INNER_L3_IPV4_EXT_UNKNOWN))
+
+#define IS_IPV4_VXLAN_TCP4_PKT(ptype) (RTE_ETH_IS_IPV4_HDR(ptype) && \
+		(((ptype) & RTE_PTYPE_L4_MASK) == RTE_PTYPE_L4_UDP) && \
+		(((ptype) & RTE_PTYPE_TUNNEL_MASK) == \
+			RTE_PTYPE_TUNNEL_VXLAN) && \
+		IS_INNER_IPV4_HDR(ptype) && \
+		(((ptype) & RTE_PTYPE_INNER_L4_MASK) == \
+			RTE_PTYPE_INNER_L4_TCP))
 
 /*
  * GRO context structure, which is used to merge packets. It keeps
@@ -138,55 +174,161 @@ rte_gro_reassemble_burst(struct rte_mbuf **pkts,
 	/* allocate a reassembly table for TCP/IPv4 GRO */
 	struct gro_tcp4_tbl tcp_tbl;
 	struct gro_tcp4_key tcp_keys[RTE_GRO_MAX_BURST_ITEM_NUM];
-	struct gro_tcp4_item tcp_items[RTE_GRO_MAX_BURST_ITEM_NUM] = {{0} };
+	struct gro_tcp_item tcp_items[RTE_GRO_MAX_BURST_ITEM_NUM] = {{0} };
+	uint32_t tcp_buckets[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_flow_key_link tcp_key_links[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_flow_item_link tcp_item_links[RTE_GRO_MAX_BURST_ITEM_NUM];
+
+	/* allocate a reassembly table for TCP/IPv6 GRO */
+	struct gro_tcp6_tbl tcp6_tbl;
+	struct gro_tcp6_key tcp6_keys[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_tcp_item tcp6_items[RTE_GRO_MAX_BURST_ITEM_NUM] = {{0} };
+	uint32_t tcp6_buckets[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_flow_key_link tcp6_key_links[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_flow_item_link tcp6_item_links[RTE_GRO_MAX_BURST_ITEM_NUM];
+
+	/* allocate a reassembly table for UDP/IPv4 GRO */
+	struct gro_udp4_tbl udp_tbl;
+	struct gro_udp4_key udp_keys[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_udp4_item udp_items[RTE_GRO_MAX_BURST_ITEM_NUM] = {{0} };
+	uint32_t udp_buckets[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_flow_key_link udp_key_links[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_flow_item_link udp_item_links[RTE_GRO_MAX_BURST_ITEM_NUM];
+
+	/* allocate a reassembly table for VXLAN GRO */
+	struct gro_vxlan_tcp4_tbl vxlan_tbl;
+	struct gro_vxlan_tcp4_key vxlan_keys[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_vxlan_tcp4_item vxlan_items[RTE_GRO_MAX_BURST_ITEM_NUM] = {
+		{{0}, 0} };
+	uint32_t vxlan_buckets[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_flow_key_link vxlan_key_links[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_flow_item_link vxlan_item_links[RTE_GRO_MAX_BURST_ITEM_NUM];
 
 	struct rte_mbuf *unprocess_pkts[nb_pkts];
 	uint16_t unprocess_num = 0;
 	int32_t ret;
 	uint64_t current_time;
+	uint32_t nb_buckets;
+	uint8_t do_tcp4_gro = 0, do_tcp6_gro = 0, do_udp4_gro = 0,
+		do_vxlan_gro = 0;
 
-	if ((param->gro_types & RTE_GRO_TCP_IPV4) == 0)
+	if ((param->gro_types & (RTE_GRO_TCP_IPV4 | RTE_GRO_TCP_IPV6 |
+					RTE_GRO_UDP_IPV4 |
+					RTE_GRO_IPV4_VXLAN_TCP_IPV4)) == 0)
 		return nb_pkts;
 
 	/* get the actual number of packets */
 	item_num = RTE_MIN(nb_pkts, (param->max_flow_num *
 			param->max_item_per_flow));
 	item_num = RTE_MIN(item_num, RTE_GRO_MAX_BURST_ITEM_NUM);
+	nb_buckets = rte_align32pow2(item_num);
+
+	if (param->gro_types & RTE_GRO_TCP_IPV4) {
+		for (i = 0; i < item_num; i++)
+			tcp_keys[i].start_index = INVALID_ARRAY_INDEX;
+
+		tcp_tbl.keys = tcp_keys;
+		tcp_tbl.items = tcp_items;
+		tcp_tbl.key_num = 0;
+		tcp_tbl.item_num = 0;
+		tcp_tbl.max_key_num = item_num;
+		tcp_tbl.max_item_num = item_num;
+		gro_flow_index_init(&tcp_tbl.idx, tcp_buckets, nb_buckets,
+				tcp_key_links, item_num,
+				tcp_item_links, item_num);
+		do_tcp4_gro = 1;
+	}
 
-	for (i = 0; i < item_num; i++)
-		tcp_keys[i].start_index = INVALID_ARRAY_INDEX;
+	if (param->gro_types & RTE_GRO_TCP_IPV6) {
+		for (i = 0; i < item_num; i++)
+			tcp6_keys[i].start_index = INVALID_ARRAY_INDEX;
+
+		tcp6_tbl.keys = tcp6_keys;
+		tcp6_tbl.items = tcp6_items;
+		tcp6_tbl.key_num = 0;
+		tcp6_tbl.item_num = 0;
+		tcp6_tbl.max_key_num = item_num;
+		tcp6_tbl.max_item_num = item_num;
+		gro_flow_index_init(&tcp6_tbl.idx, tcp6_buckets, nb_buckets,
+				tcp6_key_links, item_num,
+				tcp6_item_links, item_num);
+		do_tcp6_gro = 1;
+	}
 
-	tcp_tbl.keys = tcp_keys;
-	tcp_tbl.items = tcp_items;
-	tcp_tbl.key_num = 0;
-	tcp_tbl.item_num = 0;
-	tcp_tbl.max_key_num = item_num;
-	tcp_tbl.max_item_num = item_num;
+	if (param->gro_types & RTE_GRO_UDP_IPV4) {
+		for (i = 0; i < item_num; i++)
+			udp_keys[i].start_index = INVALID_ARRAY_INDEX;
+
+		udp_tbl.keys = udp_keys;
+		udp_tbl.items = udp_items;
+		udp_tbl.key_num = 0;
+		udp_tbl.item_num = 0;
+		udp_tbl.max_key_num = item_num;
+		udp_tbl.max_item_num = item_num;
+		gro_flow_index_init(&udp_tbl.idx, udp_buckets, nb_buckets,
+				udp_key_links, item_num,
+				udp_item_links, item_num);
+		do_udp4_gro = 1;
+	}
+
+	if (param->gro_types & RTE_GRO_IPV4_VXLAN_TCP_IPV4) {
+		for (i = 0; i < item_num; i++)
+			vxlan_keys[i].start_index = INVALID_ARRAY_INDEX;
+
+		vxlan_tbl.keys = vxlan_keys;
+		vxlan_tbl.items = vxlan_items;
+		vxlan_tbl.key_num = 0;
+		vxlan_tbl.item_num = 0;
+		vxlan_tbl.max_key_num = item_num;
+		vxlan_tbl.max_item_num = item_num;
+		gro_flow_index_init(&vxlan_tbl.idx, vxlan_buckets, nb_buckets,
+				vxlan_key_links, item_num,
+				vxlan_item_links, item_num);
+		do_vxlan_gro = 1;
+	}
 
 	current_time = rte_rdtsc();
 
 	for (i = 0; i < nb_pkts; i++) {
-		if ((pkts[i]->packet_type & (RTE_PTYPE_L3_IPV4 |
-					RTE_PTYPE_L4_TCP)) ==
-				(RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L4_TCP)) {
-			ret = gro_tcp4_reassemble(pkts[i],
-					&tcp_tbl,
+		uint32_t ptype = pkts[i]->packet_type;
+
+		if (do_vxlan_gro && IS_IPV4_VXLAN_TCP4_PKT(ptype))
+			ret = gro_vxlan_tcp4_reassemble(pkts[i], &vxlan_tbl,
+					current_time);
+		else if (do_tcp4_gro && IS_IPV4_TCP_PKT(ptype))
+			ret = gro_tcp4_reassemble(pkts[i], &tcp_tbl,
 					current_time);
-			if (ret > 0)
-				/* merge successfully */
-				nb_after_gro--;
-			else if (ret < 0) {
-				unprocess_pkts[unprocess_num++] =
-					pkts[i];
-			}
-		} else
+		else if (do_tcp6_gro && IS_IPV6_TCP_PKT(ptype))
+			ret = gro_tcp6_reassemble(pkts[i], &tcp6_tbl,
+					current_time);
+		else if (do_udp4_gro && IS_IPV4_UDP_PKT(ptype))
+			ret = gro_udp4_reassemble(pkts[i], &udp_tbl,
+					current_time);
+		else
+			ret = -1;
+
+		if (ret > 0)
+			/* merge successfully */
+			nb_after_gro--;
+		else if (ret < 0)
 			unprocess_pkts[unprocess_num++] = pkts[i];
 	}
 
 	/* re-arrange GROed packets */
 	if (nb_after_gro < nb_pkts) {
-		i = gro_tcp4_tbl_timeout_flush(&tcp_tbl, current_time,
-				pkts, nb_pkts);
+		i = 0;
+		if (do_vxlan_gro)
+			i += gro_vxlan_tcp4_tbl_timeout_flush(&vxlan_tbl,
+					current_time, &pkts[i], nb_pkts - i);
+		if (do_tcp4_gro)
+			i += gro_tcp4_tbl_timeout_flush(&tcp_tbl,
+					current_time, &pkts[i], nb_pkts - i);
+		if (do_tcp6_gro)
+			i += gro_tcp6_tbl_timeout_flush(&tcp6_tbl,
+					current_time, &pkts[i], nb_pkts - i);
+		if (do_udp4_gro)
+			i += gro_udp4_tbl_timeout_flush(&udp_tbl,
+					current_time, &pkts[i], nb_pkts - i);
 		if (unprocess_num > 0) {
 			memcpy(&pkts[i], unprocess_pkts,
 					sizeof(struct rte_mbuf *) *
@@ -205,23 +347,41 @@ rte_gro_reassemble(struct rte_mbuf **pkts,
 	uint16_t i, unprocess_num = 0;
 	struct rte_mbuf *unprocess_pkts[nb_pkts];
 	struct gro_ctx *gro_ctx = ctx;
+	void *tcp_tbl, *tcp6_tbl, *udp_tbl, *vxlan_tbl;
 	uint64_t current_time;
+	int32_t ret;
 
-	if ((gro_ctx->gro_types & RTE_GRO_TCP_IPV4) == 0)
+	if ((gro_ctx->gro_types & (RTE_GRO_TCP_IPV4 | RTE_GRO_TCP_IPV6 |
+					RTE_GRO_UDP_IPV4 |
+					RTE_GRO_IPV4_VXLAN_TCP_IPV4)) == 0)
 		return nb_pkts;
 
+	tcp_tbl = gro_ctx->tbls[RTE_GRO_TCP_IPV4_INDEX];
+	tcp6_tbl = gro_ctx->tbls[RTE_GRO_TCP_IPV6_INDEX];
+	udp_tbl = gro_ctx->tbls[RTE_GRO_UDP_IPV4_INDEX];
+	vxlan_tbl = gro_ctx->tbls[RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX];
+
 	current_time = rte_rdtsc();
 
 	for (i = 0; i < nb_pkts; i++) {
-		if ((pkts[i]->packet_type & (RTE_PTYPE_L3_IPV4 |
-					RTE_PTYPE_L4_TCP)) ==
-				(RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L4_TCP)) {
-			if (gro_tcp4_reassemble(pkts[i],
-						gro_ctx->tbls
-						[RTE_GRO_TCP_IPV4_INDEX],
-						current_time) < 0)
-				unprocess_pkts[unprocess_num++] = pkts[i];
-		} else
+		uint32_t ptype = pkts[i]->packet_type;
+
+		if (vxlan_tbl && IS_IPV4_VXLAN_TCP4_PKT(ptype))
+			ret = gro_vxlan_tcp4_reassemble(pkts[i], vxlan_tbl,
+					current_time);
+		else if (tcp_tbl && IS_IPV4_TCP_PKT(ptype))
+			ret = gro_tcp4_reassemble(pkts[i], tcp_tbl,
+					current_time);
+		else if (tcp6_tbl && IS_IPV6_TCP_PKT(ptype))
+			ret = gro_tcp6_reassemble(pkts[i], tcp6_tbl,
+					current_time);
+		else if (udp_tbl && IS_IPV4_UDP_PKT(ptype))
+			ret = gro_udp4_reassemble(pkts[i], udp_tbl,
+					current_time);
+		else
+			ret = -1;
+
+		if (ret < 0)
 			unprocess_pkts[unprocess_num++] = pkts[i];
 	}
 	if (unprocess_num > 0) {
@@ -242,17 +402,46 @@ rte_gro_timeout_flush(void *ctx,
 {
 	struct gro_ctx *gro_ctx = ctx;
 	uint64_t flush_timestamp;
+	uint16_t num = 0;
 
 	gro_types = gro_types & gro_ctx->gro_types;
 	flush_timestamp = rte_rdtsc() - timeout_cycles;
 
+	if (gro_types & RTE_GRO_IPV4_VXLAN_TCP_IPV4) {
+		num += gro_vxlan_tcp4_tbl_timeout_flush(
+				gro_ctx->tbls[RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX],
+				flush_timestamp,
+				&out[num], max_nb_out - num);
+		if (num == max_nb_out)
+			return num;
+	}
+
 	if (gro_types & RTE_GRO_TCP_IPV4) {
-		return gro_tcp4_tbl_timeout_flush(
+		num += gro_tcp4_tbl_timeout_flush(
 				gro_ctx->tbls[RTE_GRO_TCP_IPV4_INDEX],
 				flush_timestamp,
-				out, max_nb_out);
+				&out[num], max_nb_out - num);
+		if (num == max_nb_out)
+			return num;
 	}
-	return 0;
+
+	if (gro_types & RTE_GRO_TCP_IPV6) {
+		num += gro_tcp6_tbl_timeout_flush(
+				gro_ctx->tbls[RTE_GRO_TCP_IPV6_INDEX],
+				flush_timestamp,
+				&out[num], max_nb_out - num);
+		if (num == max_nb_out)
+			return num;
+	}
+
+	if (gro_types & RTE_GRO_UDP_IPV4) {
+		num += gro_udp4_tbl_timeout_flush(
+				gro_ctx->tbls[RTE_GRO_UDP_IPV4_INDEX],
+				flush_timestamp,
+				&out[num], max_nb_out - num);
+	}
+
+	return num;
 }
 
 uint64_t
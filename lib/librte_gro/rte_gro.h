@@ -51,12 +51,21 @@ extern "C" {
  */
 #define RTE_GRO_TYPE_MAX_NUM 64
 /**< the max number of supported GRO types */
-#define RTE_GRO_TYPE_SUPPORT_NUM 1
+#define RTE_GRO_TYPE_SUPPORT_NUM 4
 /**< the number of currently supported GRO types */
 
 #define RTE_GRO_TCP_IPV4_INDEX 0
 #define RTE_GRO_TCP_IPV4 (1ULL << RTE_GRO_TCP_IPV4_INDEX)
 /**< TCP/IPv4 GRO flag */
+#define RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX 1
+#define RTE_GRO_IPV4_VXLAN_TCP_IPV4 (1ULL << RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX)
+/**< VXLAN GRO flag: outer IPv4 header, inner TCP/IPv4 packet */
+#define RTE_GRO_UDP_IPV4_INDEX 2
+#define RTE_GRO_UDP_IPV4 (1ULL << RTE_GRO_UDP_IPV4_INDEX)
+/**< UDP/IPv4 GRO flag, merging IP fragments of UDP datagrams */
+#define RTE_GRO_TCP_IPV6_INDEX 3
+#define RTE_GRO_TCP_IPV6 (1ULL << RTE_GRO_TCP_IPV6_INDEX)
+/**< TCP/IPv6 GRO flag */
 
 /**
  * A structure which is used to create GRO context objects or tell
@@ -109,11 +118,17 @@ void rte_gro_ctx_destroy(void *ctx);
  * packets at a time. It assumes that all inputted packets are with
  * correct checksums. That is, applications should guarantee all
  * inputted packets are correct. Besides, it doesn't re-calculate
- * checksums for merged packets. If inputted packets are IP fragmented,
- * this function assumes them are complete (i.e. with L4 header). After
+ * checksums for merged packets. Except for UDP/IPv4 GRO, which merges
+ * IP fragments, if inputted packets are IP fragmented, this function
+ * assumes them are complete (i.e. with L4 header). After
  * finishing processing, it returns all GROed packets to applications
  * immediately.
  *
+ * The packet_type and the l2_len, l3_len and l4_len fields of the mbufs
+ * must be set. For VXLAN packets, outer_l2_len and outer_l3_len must be
+ * set as well, and l2_len is the length of the outer UDP, VXLAN and
+ * inner Ethernet headers.
+ *
  * @param pkts
  *  a pointer array which points to the packets to reassemble. Besides,
  *  it keeps mbuf addresses for the GROed packets.
@@ -139,8 +154,9 @@ uint16_t rte_gro_reassemble_burst(struct rte_mbuf **pkts,
  * the packets in the reassembly tables of a given GRO context. This
  * function assumes all inputted packets are with correct checksums.
  * And it won't update checksums if two packets are merged. Besides,
- * if inputted packets are IP fragmented, this function assumes they
- * are complete packets (i.e. with L4 header).
+ * except for UDP/IPv4 GRO, if inputted packets are IP fragmented, this
+ * function assumes they are complete packets (i.e. with L4 header).
+ * The mbuf fields must be set as for rte_gro_reassemble_burst().
  *
  * If the inputted packets don't have data or are with unsupported GRO
  * types etc., they won't be processed and are returned to applications.
@@ -134,6 +134,19 @@ ipv6_frag_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
 	*v2 = (v << 7) + (v >> 14);
 }
 
+uint32_t
+ip_frag_key_hash(const struct ip_frag_key *key)
+{
+	uint32_t sig1, sig2;
+
+	if (key->key_len == IPV4_KEYLEN)
+		ipv4_frag_hash(key, &sig1, &sig2);
+	else
+		ipv6_frag_hash(key, &sig1, &sig2);
+
+	return sig1;
+}
+
 struct rte_mbuf *
 ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
 	struct rte_mbuf *mb, uint16_t ofs, uint16_t len, uint16_t more_frags)
@@ -414,3 +427,33 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 	*stale = old;
 	return NULL;
 }
+
+/*
+ * Walk the LRU list from its head and delete all timed-out entries.
+ * Entries are appended to the tail on add/reuse, so the list is sorted
+ * by start time and the walk stops at the first live entry.
+ */
+uint32_t
+ip_frag_tbl_del_expired(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, uint64_t tms)
+{
+	struct ip_frag_pkt *fp;
+	uint64_t max_cycles;
+	uint32_t n;
+
+	max_cycles = tbl->max_cycles;
+
+	for (n = 0; (fp = TAILQ_FIRST(&tbl->lru)) != NULL &&
+			max_cycles + fp->start < tms; n++) {
+
+		/* keep enough room on death row for a full entry. */
+		if (dr->cnt + IP_MAX_FRAG_NUM > RTE_DIM(dr->row))
+			break;
+
+		if (tbl->last == fp)
+			tbl->last = NULL;
+		ip_frag_tbl_del(tbl, dr, fp);
+	}
+
+	return n;
+}
@@ -311,6 +311,62 @@ struct rte_mbuf * rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		struct rte_ip_frag_death_row *dr,
 		struct rte_mbuf *mb, uint64_t tms, struct ipv4_hdr *ip_hdr);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Compute the hash of the <src addr, dst addr, id> triple that identifies
+ * the datagram an IPv4 fragment belongs to. All fragments of the same
+ * datagram produce the same value, so it can be used to steer fragments
+ * between several fragmentation tables, each owned by one lcore.
+ *
+ * @param ip_hdr
+ *   Pointer to the IPV4 header inside the fragment.
+ * @return
+ *   32-bit hash value.
+ */
+uint32_t rte_ipv4_frag_hash(const struct ipv4_hdr *ip_hdr);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Compute the hash of the <src addr, dst addr, id> triple that identifies
+ * the datagram an IPv6 fragment belongs to.
+ *
+ * @param ip_hdr
+ *   Pointer to the IPv6 header.
+ * @param frag_hdr
+ *   Pointer to the IPv6 fragment extension header.
+ * @return
+ *   32-bit hash value.
+ */
+uint32_t rte_ipv6_frag_hash(const struct ipv6_hdr *ip_hdr,
+		const struct ipv6_extension_fragment *frag_hdr);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Map a fragment hash returned by rte_ipv4_frag_hash() or
+ * rte_ipv6_frag_hash() to one of *nb_tables* fragmentation tables.
+ * The upper bits of the hash are used, as the lower ones select the
+ * bucket inside the table: this keeps the buckets of every table evenly
+ * loaded whatever the number of tables.
+ *
+ * @param hash
+ *   Fragment hash.
+ * @param nb_tables
+ *   Number of fragmentation tables, must be non-zero.
+ * @return
+ *   Table index in the [0, nb_tables - 1] range.
+ */
+static inline uint32_t
+rte_ip_frag_table_select(uint32_t hash, uint32_t nb_tables)
+{
+	return (uint32_t)(((uint64_t)hash * nb_tables) >> 32);
+}
+
 /**
  * Check if the IPv4 packet is fragmented
  *
@@ -342,6 +398,49 @@ void rte_ip_frag_free_death_row(struct rte_ip_frag_death_row *dr,
 		uint32_t prefetch);
 
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Delete all entries that have been waiting for their fragments longer
+ * than the table TTL. Entries are kept in arrival order, so the cost is
+ * proportional to the number of expired entries rather than to the table
+ * size. Calling it periodically keeps stale datagrams from holding mbufs
+ * until a colliding lookup reclaims them.
+ * The walk stops early if the death row has no room left for another
+ * entry: free the death row and call it again in that case.
+ *
+ * @param tbl
+ *   Fragmentation table.
+ * @param dr
+ *   Death row to free buffers to.
+ * @param tms
+ *   Current timestamp.
+ * @return
+ *   Number of deleted entries.
+ */
+uint32_t
+rte_ip_frag_table_del_expired_entries(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, uint64_t tms);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Read fragmentation table statistics.
+ * Counters are only updated when RTE_LIBRTE_IP_FRAG_TBL_STAT is enabled.
+ *
+ * @param tbl
+ *   Fragmentation table to read statistics from.
+ * @param stat
+ *   Structure to copy the statistics to.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters.
+ */
+int
+rte_ip_frag_table_statistics_get(const struct rte_ip_frag_tbl *tbl,
+		struct ip_frag_tbl_stat *stat);
+
 /**
  * Dump fragmentation table statistics to file.
  *
@@ -33,6 +33,7 @@
 
 #include <stddef.h>
 #include <stdio.h>
+#include <errno.h>
 
 #include <rte_memory.h>
 #include <rte_log.h>
@@ -122,6 +123,26 @@ rte_ip_frag_table_destroy(struct rte_ip_frag_tbl *tbl)
 	rte_free(tbl);
 }
 
+/* delete timed-out entries from the fragmentation table */
+uint32_t
+rte_ip_frag_table_del_expired_entries(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, uint64_t tms)
+{
+	return ip_frag_tbl_del_expired(tbl, dr, tms);
+}
+
+/* copy frag table statistics */
+int
+rte_ip_frag_table_statistics_get(const struct rte_ip_frag_tbl *tbl,
+	struct ip_frag_tbl_stat *stat)
+{
+	if (tbl == NULL || stat == NULL)
+		return -EINVAL;
+
+	*stat = tbl->stat;
+	return 0;
+}
+
 /* dump frag table statistics to file */
 void
 rte_ip_frag_table_statistics_dump(FILE *f, const struct rte_ip_frag_tbl *tbl)
@@ -188,3 +188,26 @@ rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 
 	return mb;
 }
+
+/*
+ * Hash the <src addr, dst addr, id> triple of an IPv4 fragment.
+ */
+uint32_t
+rte_ipv4_frag_hash(const struct ipv4_hdr *ip_hdr)
+{
+	struct ip_frag_key key;
+	uint64_t src, dst;
+
+	/* same in-memory layout as the key built on reassembly. */
+	src = ip_hdr->src_addr;
+	dst = ip_hdr->dst_addr;
+#if RTE_BYTE_ORDER == RTE_LITTLE_ENDIAN
+	key.src_dst[0] = src | dst << 32;
+#else
+	key.src_dst[0] = src << 32 | dst;
+#endif
+	key.id = ip_hdr->packet_id;
+	key.key_len = IPV4_KEYLEN;
+
+	return ip_frag_key_hash(&key);
+}
@@ -229,3 +229,20 @@ rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 
 	return mb;
 }
+
+/*
+ * Hash the <src addr, dst addr, id> triple of an IPv6 fragment.
+ */
+uint32_t
+rte_ipv6_frag_hash(const struct ipv6_hdr *ip_hdr,
+	const struct ipv6_extension_fragment *frag_hdr)
+{
+	struct ip_frag_key key;
+
+	rte_memcpy(&key.src_dst[0], ip_hdr->src_addr, 16);
+	rte_memcpy(&key.src_dst[2], ip_hdr->dst_addr, 16);
+	key.id = frag_hdr->id;
+	key.key_len = IPV6_KEYLEN;
+
+	return ip_frag_key_hash(&key);
+}
@@ -212,6 +212,15 @@ extern "C" {
 
 /* add new TX flags here */
 
+/**
+ * UDP fragmentation offload. To segment a UDP/IPv4 datagram into IP
+ * fragments:
+ *  - set the PKT_TX_UDP_SEG flag in mbuf->ol_flags
+ *  - set the flag PKT_TX_IPV4
+ *  - fill the mbuf offload information: l2_len, l3_len, l4_len, tso_segsz
+ */
+#define PKT_TX_UDP_SEG       (1ULL << 41)
+
 /**
  * Request security offload processing on the TX packet.
  */
@@ -336,6 +345,7 @@ extern "C" {
 		PKT_TX_L4_MASK |         \
 		PKT_TX_OUTER_IP_CKSUM |  \
 		PKT_TX_TCP_SEG |         \
+		PKT_TX_UDP_SEG |         \
 		PKT_TX_IEEE1588_TMST |	 \
 		PKT_TX_QINQ_PKT |        \
 		PKT_TX_VLAN_PKT |        \
@@ -530,6 +540,15 @@ struct rte_mbuf {
 			uint32_t lo;
 			uint32_t hi;
 		} sched;          /**< Hierarchical scheduler */
+		struct {
+			uint32_t reserved1;
+			uint16_t reserved2;
+			uint16_t txq;
+			/**< The event eth Tx adapter uses this field to
+			 * store the Tx queue identifier.
+			 * @see rte_event_eth_tx_adapter_txq_set()
+			 */
+		} txadapter;      /**< Eventdev ethdev Tx adapter */
 		uint32_t usr;	  /**< User defined tags. See rte_distributor_process() */
 	} hash;                   /**< hash information */
 
@@ -42,6 +42,7 @@
 #include "rte_member.h"
 #include "rte_member_ht.h"
 #include "rte_member_vbf.h"
+#include "rte_member_cf.h"
 
 int librte_member_logtype;
 
@@ -103,6 +104,12 @@ rte_member_free(struct rte_member_setsum *setsum)
 	case RTE_MEMBER_TYPE_VBF:
 		rte_member_free_vbf(setsum);
 		break;
+	case RTE_MEMBER_TYPE_CF:
+		rte_member_free_cf(setsum);
+		break;
+	case RTE_MEMBER_TYPE_CBF:
+		rte_member_free_cbf(setsum);
+		break;
 	default:
 		break;
 	}
@@ -176,6 +183,12 @@ rte_member_create(const struct rte_member_parameters *params)
 	case RTE_MEMBER_TYPE_VBF:
 		ret = rte_member_create_vbf(setsum, params);
 		break;
+	case RTE_MEMBER_TYPE_CF:
+		ret = rte_member_create_cf(setsum, params);
+		break;
+	case RTE_MEMBER_TYPE_CBF:
+		ret = rte_member_create_cbf(setsum, params);
+		break;
 	default:
 		goto error_unlock_exit;
 	}
@@ -208,6 +221,10 @@ rte_member_add(const struct rte_member_setsum *setsum, const void *key,
 		return rte_member_add_ht(setsum, key, set_id);
 	case RTE_MEMBER_TYPE_VBF:
 		return rte_member_add_vbf(setsum, key, set_id);
+	case RTE_MEMBER_TYPE_CF:
+		return rte_member_add_cf(setsum, key, set_id);
+	case RTE_MEMBER_TYPE_CBF:
+		return rte_member_add_cbf(setsum, key, set_id);
 	default:
 		return -EINVAL;
 	}
@@ -224,7 +241,10 @@ rte_member_lookup(const struct rte_member_setsum *setsum, const void *key,
 	case RTE_MEMBER_TYPE_HT:
 		return rte_member_lookup_ht(setsum, key, set_id);
 	case RTE_MEMBER_TYPE_VBF:
+	case RTE_MEMBER_TYPE_CBF:
 		return rte_member_lookup_vbf(setsum, key, set_id);
+	case RTE_MEMBER_TYPE_CF:
+		return rte_member_lookup_cf(setsum, key, set_id);
 	default:
 		return -EINVAL;
 	}
@@ -243,8 +263,12 @@ rte_member_lookup_bulk(const struct rte_member_setsum *setsum,
 		return rte_member_lookup_bulk_ht(setsum, keys, num_keys,
 				set_ids);
 	case RTE_MEMBER_TYPE_VBF:
+	case RTE_MEMBER_TYPE_CBF:
 		return rte_member_lookup_bulk_vbf(setsum, keys, num_keys,
 				set_ids);
+	case RTE_MEMBER_TYPE_CF:
+		return rte_member_lookup_bulk_cf(setsum, keys, num_keys,
+				set_ids);
 	default:
 		return -EINVAL;
 	}
@@ -262,8 +286,12 @@ rte_member_lookup_multi(const struct rte_member_setsum *setsum, const void *key,
 		return rte_member_lookup_multi_ht(setsum, key, match_per_key,
 				set_id);
 	case RTE_MEMBER_TYPE_VBF:
+	case RTE_MEMBER_TYPE_CBF:
 		return rte_member_lookup_multi_vbf(setsum, key, match_per_key,
 				set_id);
+	case RTE_MEMBER_TYPE_CF:
+		return rte_member_lookup_multi_cf(setsum, key, match_per_key,
+				set_id);
 	default:
 		return -EINVAL;
 	}
@@ -284,8 +312,12 @@ rte_member_lookup_multi_bulk(const struct rte_member_setsum *setsum,
 		return rte_member_lookup_multi_bulk_ht(setsum, keys, num_keys,
 				max_match_per_key, match_count, set_ids);
 	case RTE_MEMBER_TYPE_VBF:
+	case RTE_MEMBER_TYPE_CBF:
 		return rte_member_lookup_multi_bulk_vbf(setsum, keys, num_keys,
 				max_match_per_key, match_count, set_ids);
+	case RTE_MEMBER_TYPE_CF:
+		return rte_member_lookup_multi_bulk_cf(setsum, keys, num_keys,
+				max_match_per_key, match_count, set_ids);
 	default:
 		return -EINVAL;
 	}
@@ -301,6 +333,10 @@ rte_member_delete(const struct rte_member_setsum *setsum, const void *key,
 	switch (setsum->type) {
 	case RTE_MEMBER_TYPE_HT:
 		return rte_member_delete_ht(setsum, key, set_id);
+	case RTE_MEMBER_TYPE_CF:
+		return rte_member_delete_cf(setsum, key, set_id);
+	case RTE_MEMBER_TYPE_CBF:
+		return rte_member_delete_cbf(setsum, key, set_id);
 	/* current vBF implementation does not support delete function */
 	case RTE_MEMBER_TYPE_VBF:
 	default:
@@ -320,6 +356,12 @@ rte_member_reset(const struct rte_member_setsum *setsum)
 	case RTE_MEMBER_TYPE_VBF:
 		rte_member_reset_vbf(setsum);
 		return;
+	case RTE_MEMBER_TYPE_CF:
+		rte_member_reset_cf(setsum);
+		return;
+	case RTE_MEMBER_TYPE_CBF:
+		rte_member_reset_cbf(setsum);
+		return;
 	default:
 		return;
 	}
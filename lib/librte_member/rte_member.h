@@ -39,9 +39,10 @@
  * The Membership Library is an extension and generalization of a traditional
  * filter (for example Bloom Filter and cuckoo filter) structure that has
  * multiple usages in a variety of workloads and applications. The library is
- * used to test if a key belongs to certain sets. Two types of such
- * "set-summary" structures are implemented: hash-table based (HT) and vector
- * bloom filter (vBF). For HT setsummary, two subtypes or modes are available,
+ * used to test if a key belongs to certain sets. Four types of such
+ * "set-summary" structures are implemented: hash-table based (HT), vector
+ * bloom filter (vBF), cuckoo filter (CF) and counting vector bloom filter
+ * (CBF). For HT setsummary, two subtypes or modes are available,
  * cache and non-cache modes. The table below summarize some properties of
  * the different implementations.
  *
@@ -68,6 +69,20 @@
  * |          |                     | not overwrite  |                         |
  * |          |                     | existing key.  |                         |
  * +----------+---------------------+----------------+-------------------------+
+ *
+ * +==========+=====================+==========================================+
+ * |   type   |      cbf            |     cf                                   |
+ * +==========+=====================+==========================================+
+ * |structure |  vbf plus a counter |  cuckoo filter: buckets of fingerprints  |
+ * |          |  per bit            |  of 8, 16 or 32 bits                     |
+ * +----------+---------------------+------------------------------------------+
+ * |set id    | limited by bf count |           [1, 0x7fff]                    |
+ * |          | up to 32.           |                                          |
+ * +----------+---------------------+------------------------------------------+
+ * |usages &  | same as vbf, with   | can delete, big set range, fingerprint   |
+ * |properties| deletion support,   | size derived from the user-specified     |
+ * |          | more memory.        | false-positive rate, no false negative.  |
+ * +----------+---------------------+------------------------------------------+
  * -->
  */
 
@@ -90,6 +105,8 @@ typedef uint16_t member_set_t;
 #define RTE_MEMBER_LOOKUP_BULK_MAX 64
 /** Entry count per bucket in hash table based mode. */
 #define RTE_MEMBER_BUCKET_ENTRIES 16
+/** Entry count per bucket in cuckoo filter mode. */
+#define RTE_MEMBER_CF_BUCKET_ENTRIES 8
 /** Maximum number of characters in setsum name. */
 #define RTE_MEMBER_NAMESIZE 32
 
@@ -128,6 +145,8 @@ struct rte_member_parameters;
 enum rte_member_setsum_type {
 	RTE_MEMBER_TYPE_HT = 0,  /**< Hash table based set summary. */
 	RTE_MEMBER_TYPE_VBF,     /**< Vector of bloom filters. */
+	RTE_MEMBER_TYPE_CF,      /**< Cuckoo filter. */
+	RTE_MEMBER_TYPE_CBF,     /**< Vector of counting bloom filters. */
 	RTE_MEMBER_NUM_TYPE
 };
 
@@ -167,6 +186,14 @@ struct rte_member_setsum {
 	/* Second cache line should start here. */
 	uint32_t socket_id;          /* NUMA Socket ID for memory. */
 	char name[RTE_MEMBER_NAMESIZE]; /* Name of this set summary. */
+
+	/* Cuckoo filter, also uses bucket_cnt and bucket_mask. */
+	uint32_t fp_len;		/* Fingerprint length in bytes. */
+	uint32_t fp_mask;		/* Bit mask to get the fingerprint. */
+	uint32_t bucket_size;		/* Size of a bucket in bytes. */
+
+	/* Counting bloom filter, also uses the vBF fields. */
+	uint8_t *counters;		/* One counter per bit of each bf. */
 } __rte_cache_aligned;
 
 /**
@@ -190,6 +217,13 @@ struct rte_member_parameters {
 	 *
 	 * vBF setsummary is a vector of bloom filters. It is used when number
 	 * of sets is not big (less than 32 for current implementation).
+	 *
+	 * CF setsummary is a cuckoo filter. Like non-cache HT it supports
+	 * deletion and many sets, but the fingerprint size is chosen from
+	 * the false positive rate.
+	 *
+	 * CBF setsummary is a vBF with a counter per bit, so that keys can
+	 * also be deleted, at the cost of more memory.
 	 */
 	enum rte_member_setsum_type type;
 
@@ -223,8 +257,12 @@ struct rte_member_parameters {
 	 * likely to become full before the number of inserted keys equal to the
 	 * total number of entries.
 	 *
-	 * For vBF, num_keys equal to the expected number of keys that will
-	 * be inserted into the vBF. The implementation assumes the keys are
+	 * For CF, num_keys is the number of keys the filter must be able to
+	 * hold. Buckets are added so that the table is at most 95% full
+	 * with that number of keys.
+	 *
+	 * For vBF and CBF, num_keys equal to the expected number of keys that
+	 * will be inserted into the vBF. The implementation assumes the keys are
 	 * evenly distributed to each BF in vBF. This is used to calculate the
 	 * number of bits we need for each BF. User does not specify the size of
 	 * each BF directly because the optimal size depends on the num_keys
@@ -239,7 +277,8 @@ struct rte_member_parameters {
 	uint32_t key_len;
 
 	/**
-	 * num_set is only used for vBF, but not used for HT setsummary.
+	 * num_set is only used for vBF and CBF, but not used for HT and CF
+	 * setsummaries.
 	 *
 	 * num_set is equal to the number of BFs in vBF. For current
 	 * implementation, it only supports 1,2,4,8,16,32 BFs in one vBF set
@@ -250,8 +289,8 @@ struct rte_member_parameters {
 	uint32_t num_set;
 
 	/**
-	 * false_positive_rate is only used for vBF, but not used for HT
-	 * setsummary.
+	 * false_positive_rate is only used for vBF, CBF and CF, but not used
+	 * for HT setsummary.
 	 *
 	 * For vBF, false_positive_rate is the user-defined false positive rate
 	 * given expected number of inserted keys (num_keys). It is used to
@@ -267,6 +306,11 @@ struct rte_member_parameters {
 	 * to number of entries (num_keys) divided by entry count per bucket
 	 * (RTE_MEMBER_BUCKET_ENTRIES). Thus, the false_positive_rate is not
 	 * directly set by users for HT mode.
+	 *
+	 * For CF, the false positive rate is in the order of
+	 * 2 * entries_per_bucket / 2^fingerprint_bits. The smallest
+	 * fingerprint size (8, 16 or 32 bits) that gives a rate below
+	 * false_positive_rate is used.
 	 */
 	float false_positive_rate;
 
@@ -440,9 +484,10 @@ rte_member_lookup_multi_bulk(const struct rte_member_setsum *setsum,
  *   The set id associated with the key that needs to be added. Different mode
  *   supports different set_id ranges. 0 cannot be used as set_id since
  *   RTE_MEMBER_NO_MATCH by default is set as 0.
- *   For HT mode, the set_id has range as [1, 0x7FFF], MSB is reserved.
- *   For vBF mode the set id is limited by the num_set parameter when create
- *   the set-summary.
+ *   For HT and CF modes, the set_id has range as [1, 0x7FFF], MSB is
+ *   reserved.
+ *   For vBF and CBF modes the set id is limited by the num_set parameter
+ *   when create the set-summary.
  * @return
  *   HT (cache mode) and vBF should never fail unless the set_id is not in the
  *   valid range. In such case -EINVAL is returned.
@@ -453,7 +498,9 @@ rte_member_lookup_multi_bulk(const struct rte_member_setsum *setsum,
  *   Return 0 for HT (cache mode) if the add does not cause
  *   eviction, return 1 otherwise. Return 0 for non-cache mode if success,
  *   -ENOSPC for full, and 1 if cuckoo eviction happens.
- *   Always returns 0 for vBF mode.
+ *   Return 0 for CF if success, -ENOSPC for full, and 1 if cuckoo
+ *   eviction happens.
+ *   Always returns 0 for vBF and CBF modes.
  */
 int
 rte_member_add(const struct rte_member_setsum *setsum, const void *key,
@@ -490,15 +537,18 @@ rte_member_reset(const struct rte_member_setsum *setsum);
  *
  * Delete items from the set-summary. Note that vBF does not support deletion
  * in current implementation. For vBF, error code of -EINVAL will be returned.
+ * Use CBF instead of vBF when deletion is needed.
  *
  * @param setsum
  *   Pointer to the set-summary.
  * @param key
  *   Pointer of the key to be deleted.
  * @param set_id
- *   For HT mode, we need both key and its corresponding set_id to
+ *   For HT and CF modes, we need both key and its corresponding set_id to
  *   properly delete the key. Without set_id, we may delete other keys with the
  *   same signature.
+ *   For CBF mode, the key is removed from the bloom filter of set_id only,
+ *   and it must have been added to it before.
  * @return
  *   If no entry found to delete, an error code of -ENOENT could be returned.
  */
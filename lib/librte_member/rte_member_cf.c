@@ -0,0 +1,480 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_prefetch.h>
+#include <rte_log.h>
+
+#include "rte_member.h"
+#include "rte_member_ht.h"
+#include "rte_member_cf.h"
+
+#if defined(RTE_ARCH_X86)
+#include "rte_member_cf_x86.h"
+#endif
+
+/*
+ * The cuckoo filter is a table of buckets of RTE_MEMBER_CF_BUCKET_ENTRIES
+ * entries. Each entry holds a fingerprint of the key (fp_len bytes) and
+ * the set id of the key. Within a bucket all the fingerprints are stored
+ * first, then all the set ids, so that a bucket can be compared to a
+ * fingerprint with a few vector instructions.
+ * Free entries are marked with RTE_MEMBER_NO_MATCH as set id.
+ *
+ * Unlike HT mode, the fingerprint size is derived from the requested
+ * false positive rate: a lookup compares the fingerprint with the
+ * 2 * RTE_MEMBER_CF_BUCKET_ENTRIES entries of its two buckets, hence the
+ * false positive rate is bounded by 2 * RTE_MEMBER_CF_BUCKET_ENTRIES /
+ * 2^(8 * fp_len).
+ */
+
+/* MSB of the set id is set to indicate an entry is being pushed */
+#define CF_PUSHED_FLAG ((member_set_t)(1U << (sizeof(member_set_t) * 8 - 1)))
+
+static inline uint8_t *
+cf_bucket(const struct rte_member_setsum *ss, uint32_t bkt_idx)
+{
+	return (uint8_t *)ss->table + (size_t)bkt_idx * ss->bucket_size;
+}
+
+static inline member_set_t *
+cf_sets(const struct rte_member_setsum *ss, uint8_t *bkt)
+{
+	return (member_set_t *)(bkt +
+			ss->fp_len * RTE_MEMBER_CF_BUCKET_ENTRIES);
+}
+
+static inline uint32_t
+cf_get_fp(const struct rte_member_setsum *ss, const uint8_t *bkt,
+		uint32_t i)
+{
+	switch (ss->fp_len) {
+	case 1:
+		return bkt[i];
+	case 2:
+		return ((const uint16_t *)bkt)[i];
+	default:
+		return ((const uint32_t *)bkt)[i];
+	}
+}
+
+static inline void
+cf_set_fp(const struct rte_member_setsum *ss, uint8_t *bkt, uint32_t i,
+		uint32_t fp)
+{
+	switch (ss->fp_len) {
+	case 1:
+		bkt[i] = fp;
+		break;
+	case 2:
+		((uint16_t *)bkt)[i] = fp;
+		break;
+	default:
+		((uint32_t *)bkt)[i] = fp;
+		break;
+	}
+}
+
+/*
+ * Alternative bucket of an entry, derived from its current bucket and its
+ * fingerprint only ("partial-key cuckoo hashing"). The fingerprint is
+ * scrambled first so that short fingerprints still spread over the whole
+ * table.
+ */
+static inline uint32_t
+cf_alt_bucket(const struct rte_member_setsum *ss, uint32_t bkt_idx,
+		uint32_t fp)
+{
+	return (bkt_idx ^ (fp * 0x5bd1e995)) & ss->bucket_mask;
+}
+
+static inline void
+cf_get_buckets_index(const struct rte_member_setsum *ss, const void *key,
+		uint32_t *prim_bkt, uint32_t *sec_bkt, uint32_t *fp)
+{
+	uint32_t first_hash = MEMBER_HASH_FUNC(key, ss->key_len,
+						ss->prim_hash_seed);
+	uint32_t sec_hash = MEMBER_HASH_FUNC(&first_hash, sizeof(uint32_t),
+						ss->sec_hash_seed);
+
+	*fp = first_hash & ss->fp_mask;
+	*prim_bkt = sec_hash & ss->bucket_mask;
+	*sec_bkt = cf_alt_bucket(ss, *prim_bkt, *fp);
+}
+
+/* Returns the mask of used entries of the bucket matching fp */
+static inline uint32_t
+search_bucket_cf(const struct rte_member_setsum *ss, uint8_t *bkt,
+		uint32_t fp)
+{
+#if defined(RTE_ARCH_X86) && defined(RTE_MACHINE_CPUFLAG_SSE2)
+	return search_bucket_cf_sse(bkt, fp, ss->fp_len);
+#else
+	const member_set_t *sets = cf_sets(ss, bkt);
+	uint32_t i, hitmask = 0;
+
+	for (i = 0; i < RTE_MEMBER_CF_BUCKET_ENTRIES; i++) {
+		if (sets[i] != RTE_MEMBER_NO_MATCH &&
+				cf_get_fp(ss, bkt, i) == fp)
+			hitmask |= 1U << i;
+	}
+	return hitmask;
+#endif
+}
+
+static inline void
+search_bucket_multi_cf(const struct rte_member_setsum *ss, uint8_t *bkt,
+		uint32_t fp, uint32_t *counter, uint32_t match_per_key,
+		member_set_t *set_id)
+{
+	const member_set_t *sets = cf_sets(ss, bkt);
+	uint32_t hitmask = search_bucket_cf(ss, bkt, fp);
+
+	while (hitmask && *counter < match_per_key) {
+		uint32_t hit_idx = __builtin_ctz(hitmask);
+
+		set_id[(*counter)++] = sets[hit_idx];
+		hitmask &= hitmask - 1;
+	}
+}
+
+int
+rte_member_create_cf(struct rte_member_setsum *ss,
+		const struct rte_member_parameters *params)
+{
+	uint32_t num_buckets;
+	double fp_rate;
+
+	if (params->num_keys == 0 ||
+			params->num_keys > RTE_MEMBER_ENTRIES_MAX ||
+			params->false_positive_rate <= 0 ||
+			params->false_positive_rate > 1) {
+		rte_errno = EINVAL;
+		RTE_MEMBER_LOG(ERR,
+			"Membership CF create with invalid parameters\n");
+		return -EINVAL;
+	}
+
+	/* Smallest fingerprint meeting the requested false positive rate */
+	for (ss->fp_len = 1; ; ss->fp_len <<= 1) {
+		fp_rate = 2.0 * RTE_MEMBER_CF_BUCKET_ENTRIES /
+				pow(2.0, 8.0 * ss->fp_len);
+		if (fp_rate <= params->false_positive_rate ||
+				ss->fp_len == sizeof(uint32_t))
+			break;
+	}
+	ss->fp_mask = (uint32_t)((1ULL << (8 * ss->fp_len)) - 1);
+	ss->bucket_size = RTE_MEMBER_CF_BUCKET_ENTRIES *
+			(ss->fp_len + sizeof(member_set_t));
+
+	num_buckets = rte_align32pow2((uint32_t)ceil(params->num_keys /
+			(RTE_MEMBER_CF_BUCKET_ENTRIES *
+			 RTE_MEMBER_CF_LOAD_FACTOR)));
+	/* Two distinct buckets are needed for cuckoo displacement */
+	if (num_buckets < 2)
+		num_buckets = 2;
+
+	ss->table = rte_zmalloc_socket(NULL,
+			(size_t)num_buckets * ss->bucket_size,
+			RTE_CACHE_LINE_SIZE, ss->socket_id);
+	if (ss->table == NULL) {
+		RTE_MEMBER_LOG(ERR, "memory allocation failed for CF "
+						"setsummary\n");
+		return -ENOMEM;
+	}
+
+	ss->bucket_cnt = num_buckets;
+	ss->bucket_mask = num_buckets - 1;
+
+	RTE_MEMBER_LOG(DEBUG, "Cuckoo filter created, "
+			"the table has %u buckets of %u entries, "
+			"%u-bit fingerprints, false positive rate %.8f\n",
+			num_buckets, RTE_MEMBER_CF_BUCKET_ENTRIES,
+			ss->fp_len * 8, fp_rate);
+	return 0;
+}
+
+int
+rte_member_lookup_cf(const struct rte_member_setsum *ss,
+		const void *key, member_set_t *set_id)
+{
+	uint32_t prim_bucket, sec_bucket, fp, hitmask;
+	uint8_t *bkt;
+
+	cf_get_buckets_index(ss, key, &prim_bucket, &sec_bucket, &fp);
+
+	bkt = cf_bucket(ss, prim_bucket);
+	hitmask = search_bucket_cf(ss, bkt, fp);
+	if (hitmask == 0) {
+		bkt = cf_bucket(ss, sec_bucket);
+		hitmask = search_bucket_cf(ss, bkt, fp);
+	}
+	if (hitmask != 0) {
+		*set_id = cf_sets(ss, bkt)[__builtin_ctz(hitmask)];
+		return 1;
+	}
+
+	*set_id = RTE_MEMBER_NO_MATCH;
+	return 0;
+}
+
+uint32_t
+rte_member_lookup_bulk_cf(const struct rte_member_setsum *ss,
+		const void **keys, uint32_t num_keys, member_set_t *set_ids)
+{
+	uint32_t i;
+	uint32_t num_matches = 0;
+	uint32_t hitmask;
+	uint8_t *bkt;
+	uint32_t fp[RTE_MEMBER_LOOKUP_BULK_MAX];
+	uint32_t prim_buckets[RTE_MEMBER_LOOKUP_BULK_MAX];
+	uint32_t sec_buckets[RTE_MEMBER_LOOKUP_BULK_MAX];
+
+	for (i = 0; i < num_keys; i++) {
+		cf_get_buckets_index(ss, keys[i], &prim_buckets[i],
+				&sec_buckets[i], &fp[i]);
+		rte_prefetch0(cf_bucket(ss, prim_buckets[i]));
+		rte_prefetch0(cf_bucket(ss, sec_buckets[i]));
+	}
+
+	for (i = 0; i < num_keys; i++) {
+		bkt = cf_bucket(ss, prim_buckets[i]);
+		hitmask = search_bucket_cf(ss, bkt, fp[i]);
+		if (hitmask == 0) {
+			bkt = cf_bucket(ss, sec_buckets[i]);
+			hitmask = search_bucket_cf(ss, bkt, fp[i]);
+		}
+		if (hitmask != 0) {
+			set_ids[i] = cf_sets(ss, bkt)[__builtin_ctz(hitmask)];
+			num_matches++;
+		} else
+			set_ids[i] = RTE_MEMBER_NO_MATCH;
+	}
+	return num_matches;
+}
+
+uint32_t
+rte_member_lookup_multi_cf(const struct rte_member_setsum *ss,
+		const void *key, uint32_t match_per_key,
+		member_set_t *set_id)
+{
+	uint32_t num_matches = 0;
+	uint32_t prim_bucket, sec_bucket, fp;
+
+	cf_get_buckets_index(ss, key, &prim_bucket, &sec_bucket, &fp);
+
+	search_bucket_multi_cf(ss, cf_bucket(ss, prim_bucket), fp,
+			&num_matches, match_per_key, set_id);
+	search_bucket_multi_cf(ss, cf_bucket(ss, sec_bucket), fp,
+			&num_matches, match_per_key, set_id);
+	return num_matches;
+}
+
+uint32_t
+rte_member_lookup_multi_bulk_cf(const struct rte_member_setsum *ss,
+		const void **keys, uint32_t num_keys, uint32_t match_per_key,
+		uint32_t *match_count,
+		member_set_t *set_ids)
+{
+	uint32_t i;
+	uint32_t num_matches = 0;
+	uint32_t match_cnt_tmp;
+	uint32_t fp[RTE_MEMBER_LOOKUP_BULK_MAX];
+	uint32_t prim_buckets[RTE_MEMBER_LOOKUP_BULK_MAX];
+	uint32_t sec_buckets[RTE_MEMBER_LOOKUP_BULK_MAX];
+
+	for (i = 0; i < num_keys; i++) {
+		cf_get_buckets_index(ss, keys[i], &prim_buckets[i],
+				&sec_buckets[i], &fp[i]);
+		rte_prefetch0(cf_bucket(ss, prim_buckets[i]));
+		rte_prefetch0(cf_bucket(ss, sec_buckets[i]));
+	}
+
+	for (i = 0; i < num_keys; i++) {
+		match_cnt_tmp = 0;
+		search_bucket_multi_cf(ss, cf_bucket(ss, prim_buckets[i]),
+				fp[i], &match_cnt_tmp, match_per_key,
+				&set_ids[i * match_per_key]);
+		search_bucket_multi_cf(ss, cf_bucket(ss, sec_buckets[i]),
+				fp[i], &match_cnt_tmp, match_per_key,
+				&set_ids[i * match_per_key]);
+		match_count[i] = match_cnt_tmp;
+		if (match_cnt_tmp != 0)
+			num_matches++;
+	}
+	return num_matches;
+}
+
+/* Insert into a free entry of the bucket, returns -1 if it is full */
+static inline int
+cf_try_insert(const struct rte_member_setsum *ss, uint32_t bkt_idx,
+		uint32_t fp, member_set_t set_id)
+{
+	uint8_t *bkt = cf_bucket(ss, bkt_idx);
+	member_set_t *sets = cf_sets(ss, bkt);
+	uint32_t i;
+
+	for (i = 0; i < RTE_MEMBER_CF_BUCKET_ENTRIES; i++) {
+		if (sets[i] == RTE_MEMBER_NO_MATCH) {
+			cf_set_fp(ss, bkt, i, fp);
+			sets[i] = set_id;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/*
+ * Free an entry of a bucket by pushing one of its entries to its
+ * alternative bucket, recursively. Same as make_space_bucket() of HT mode,
+ * so a failed insertion leaves the filter unchanged.
+ * Returns the index of the freed entry, or -ENOSPC.
+ */
+static int
+cf_make_space(const struct rte_member_setsum *ss, uint32_t bkt_idx,
+		unsigned int *nr_pushes)
+{
+	uint8_t *bkt = cf_bucket(ss, bkt_idx);
+	member_set_t *sets = cf_sets(ss, bkt);
+	uint32_t next_idx[RTE_MEMBER_CF_BUCKET_ENTRIES];
+	uint32_t fp;
+	unsigned int i;
+	int ret;
+
+	/*
+	 * Look for an entry whose alternative bucket has room. Entries
+	 * being pushed further up the cuckoo path must stay where they are.
+	 */
+	for (i = 0; i < RTE_MEMBER_CF_BUCKET_ENTRIES; i++) {
+		if (sets[i] & CF_PUSHED_FLAG)
+			continue;
+		fp = cf_get_fp(ss, bkt, i);
+		next_idx[i] = cf_alt_bucket(ss, bkt_idx, fp);
+		if (cf_try_insert(ss, next_idx[i], fp, sets[i]) == 0)
+			return i;
+	}
+
+	/* Pick entry that has not been pushed yet */
+	for (i = 0; i < RTE_MEMBER_CF_BUCKET_ENTRIES; i++)
+		if ((sets[i] & CF_PUSHED_FLAG) == 0)
+			break;
+
+	if (i == RTE_MEMBER_CF_BUCKET_ENTRIES ||
+			++(*nr_pushes) > RTE_MEMBER_CF_MAX_PUSHES)
+		return -ENOSPC;
+
+	sets[i] |= CF_PUSHED_FLAG;
+	ret = cf_make_space(ss, next_idx[i], nr_pushes);
+	sets[i] &= ~CF_PUSHED_FLAG;
+	if (ret < 0)
+		return ret;
+
+	/* Move the entry in the slot freed in its alternative bucket */
+	fp = cf_get_fp(ss, bkt, i);
+	bkt = cf_bucket(ss, next_idx[i]);
+	cf_set_fp(ss, bkt, ret, fp);
+	cf_sets(ss, bkt)[ret] = sets[i];
+	return i;
+}
+
+int
+rte_member_add_cf(const struct rte_member_setsum *ss,
+		const void *key, member_set_t set_id)
+{
+	int ret;
+	unsigned int nr_pushes = 0;
+	uint32_t prim_bucket, sec_bucket, fp, select_bucket;
+
+	if (set_id == RTE_MEMBER_NO_MATCH || (set_id & CF_PUSHED_FLAG) != 0)
+		return -EINVAL;
+
+	cf_get_buckets_index(ss, key, &prim_bucket, &sec_bucket, &fp);
+
+	if (cf_try_insert(ss, prim_bucket, fp, set_id) == 0 ||
+			cf_try_insert(ss, sec_bucket, fp, set_id) == 0)
+		return 0;
+
+	/* Pick prim or sec for recursive displacement */
+	select_bucket = (fp & 1) ? prim_bucket : sec_bucket;
+	ret = cf_make_space(ss, select_bucket, &nr_pushes);
+	if (ret < 0)
+		return ret;
+
+	cf_set_fp(ss, cf_bucket(ss, select_bucket), ret, fp);
+	cf_sets(ss, cf_bucket(ss, select_bucket))[ret] = set_id;
+	return 1;
+}
+
+void
+rte_member_free_cf(struct rte_member_setsum *ss)
+{
+	rte_free(ss->table);
+}
+
+int
+rte_member_delete_cf(const struct rte_member_setsum *ss, const void *key,
+		member_set_t set_id)
+{
+	uint32_t bkt_idx[2], fp, hitmask, i;
+	member_set_t *sets;
+	uint8_t *bkt;
+
+	cf_get_buckets_index(ss, key, &bkt_idx[0], &bkt_idx[1], &fp);
+
+	for (i = 0; i < RTE_DIM(bkt_idx); i++) {
+		bkt = cf_bucket(ss, bkt_idx[i]);
+		sets = cf_sets(ss, bkt);
+		hitmask = search_bucket_cf(ss, bkt, fp);
+		while (hitmask) {
+			uint32_t hit_idx = __builtin_ctz(hitmask);
+
+			if (sets[hit_idx] == set_id) {
+				sets[hit_idx] = RTE_MEMBER_NO_MATCH;
+				return 0;
+			}
+			hitmask &= hitmask - 1;
+		}
+	}
+	return -ENOENT;
+}
+
+void
+rte_member_reset_cf(const struct rte_member_setsum *ss)
+{
+	memset(ss->table, 0, (size_t)ss->bucket_cnt * ss->bucket_size);
+}
@@ -0,0 +1,88 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_MEMBER_CF_X86_H_
+#define _RTE_MEMBER_CF_X86_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <x86intrin.h>
+
+#include "rte_member_cf.h"
+
+#if defined(RTE_MACHINE_CPUFLAG_SSE2)
+
+/*
+ * Compare a fingerprint with all the entries of a cuckoo filter bucket at
+ * once. Returns a bitmask with bit i set if entry i is used and matches.
+ */
+static inline uint32_t
+search_bucket_cf_sse(const uint8_t *bkt, uint32_t fp, uint32_t fp_len)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i sets = _mm_loadu_si128((const __m128i *)
+			(bkt + fp_len * RTE_MEMBER_CF_BUCKET_ENTRIES));
+	__m128i hit;
+
+	switch (fp_len) {
+	case 1:
+		hit = _mm_cmpeq_epi8(_mm_loadl_epi64((const __m128i *)bkt),
+				_mm_set1_epi8((char)fp));
+		/* Widen to one 16-bit lane per entry, like the set ids */
+		hit = _mm_unpacklo_epi8(hit, hit);
+		break;
+	case 2:
+		hit = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)bkt),
+				_mm_set1_epi16((short)fp));
+		break;
+	default:
+		hit = _mm_packs_epi32(
+			_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)bkt),
+				_mm_set1_epi32((int)fp)),
+			_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)bkt + 1),
+				_mm_set1_epi32((int)fp)));
+		break;
+	}
+	/* Free entries hold RTE_MEMBER_NO_MATCH and never match */
+	hit = _mm_andnot_si128(_mm_cmpeq_epi16(sets, zero), hit);
+	return _mm_movemask_epi8(_mm_packs_epi16(hit, zero));
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_MEMBER_CF_X86_H_ */
@@ -187,6 +187,18 @@ set_bit(uint32_t bit_loc, const struct rte_member_setsum *ss, int32_t set)
 			1UL << (((bit_loc & (a - 1)) << mul_shift) + set - 1);
 }
 
+static inline void
+clear_bit(uint32_t bit_loc, const struct rte_member_setsum *ss, int32_t set)
+{
+	uint32_t *vbf = ss->table;
+	uint32_t div_shift = ss->div_shift;
+	uint32_t mul_shift = ss->mul_shift;
+	uint32_t a = 32 >> mul_shift;
+
+	vbf[bit_loc >> div_shift] &=
+			~(1UL << (((bit_loc & (a - 1)) << mul_shift) + set - 1));
+}
+
 int
 rte_member_lookup_vbf(const struct rte_member_setsum *ss, const void *key,
 		member_set_t *set_id)
@@ -348,3 +360,114 @@ rte_member_reset_vbf(const struct rte_member_setsum *ss)
 	uint32_t *vbf = ss->table;
 	memset(vbf, 0, (ss->num_set * ss->bits) >> 3);
 }
+
+/*
+ * Counting vBF (CBF).
+ * The bit array is the same as for vBF, and lookups use the vBF functions.
+ * In addition, every bit of every BF has an 8-bit counter of the keys
+ * that set it, stored with the counters of the same location in all BFs
+ * next to each other. Deleting a key decrements its counters, and clears
+ * the bits whose counter drops to zero.
+ * A counter that reaches 255 saturates: it is never decremented again and
+ * its bit stays set, which can only cause false positives.
+ */
+int
+rte_member_create_cbf(struct rte_member_setsum *ss,
+		const struct rte_member_parameters *params)
+{
+	int ret;
+
+	ret = rte_member_create_vbf(ss, params);
+	if (ret < 0)
+		return ret;
+
+	ss->counters = rte_zmalloc_socket(NULL,
+			(size_t)ss->num_set * ss->bits,
+			RTE_CACHE_LINE_SIZE, ss->socket_id);
+	if (ss->counters == NULL) {
+		rte_free(ss->table);
+		ss->table = NULL;
+		return -ENOMEM;
+	}
+
+	RTE_MEMBER_LOG(DEBUG, "counting vector bloom filter created, "
+		"with %u counters\n", ss->num_set * ss->bits);
+	return 0;
+}
+
+static inline uint8_t *
+cbf_counter(const struct rte_member_setsum *ss, uint32_t bit_loc,
+		member_set_t set_id)
+{
+	return &ss->counters[((size_t)bit_loc << ss->mul_shift) + set_id - 1];
+}
+
+int
+rte_member_add_cbf(const struct rte_member_setsum *ss,
+		const void *key, member_set_t set_id)
+{
+	uint32_t i, h1, h2;
+	uint32_t bit_loc;
+	uint8_t *cnt;
+
+	if (set_id > ss->num_set || set_id == RTE_MEMBER_NO_MATCH)
+		return -EINVAL;
+
+	h1 = MEMBER_HASH_FUNC(key, ss->key_len, ss->prim_hash_seed);
+	h2 = MEMBER_HASH_FUNC(&h1, sizeof(uint32_t), ss->sec_hash_seed);
+
+	for (i = 0; i < ss->num_hashes; i++) {
+		bit_loc = (h1 + i * h2) & ss->bit_mask;
+		cnt = cbf_counter(ss, bit_loc, set_id);
+		if (*cnt != UINT8_MAX)
+			(*cnt)++;
+		set_bit(bit_loc, ss, set_id);
+	}
+	return 0;
+}
+
+int
+rte_member_delete_cbf(const struct rte_member_setsum *ss,
+		const void *key, member_set_t set_id)
+{
+	uint32_t i, h1, h2;
+	uint32_t bit_loc;
+	uint8_t *cnt;
+
+	if (set_id > ss->num_set || set_id == RTE_MEMBER_NO_MATCH)
+		return -EINVAL;
+
+	h1 = MEMBER_HASH_FUNC(key, ss->key_len, ss->prim_hash_seed);
+	h2 = MEMBER_HASH_FUNC(&h1, sizeof(uint32_t), ss->sec_hash_seed);
+
+	/* Do not touch the counters if the key is not in the BF */
+	for (i = 0; i < ss->num_hashes; i++) {
+		bit_loc = (h1 + i * h2) & ss->bit_mask;
+		if (*cbf_counter(ss, bit_loc, set_id) == 0)
+			return -ENOENT;
+	}
+
+	for (i = 0; i < ss->num_hashes; i++) {
+		bit_loc = (h1 + i * h2) & ss->bit_mask;
+		cnt = cbf_counter(ss, bit_loc, set_id);
+		if (*cnt == 0 || *cnt == UINT8_MAX)
+			continue;
+		if (--(*cnt) == 0)
+			clear_bit(bit_loc, ss, set_id);
+	}
+	return 0;
+}
+
+void
+rte_member_free_cbf(struct rte_member_setsum *ss)
+{
+	rte_free(ss->counters);
+	rte_free(ss->table);
+}
+
+void
+rte_member_reset_cbf(const struct rte_member_setsum *ss)
+{
+	rte_member_reset_vbf(ss);
+	memset(ss->counters, 0, (size_t)ss->num_set * ss->bits);
+}
@@ -75,6 +75,24 @@ rte_member_free_vbf(struct rte_member_setsum *ss);
 void
 rte_member_reset_vbf(const struct rte_member_setsum *setsum);
 
+int
+rte_member_create_cbf(struct rte_member_setsum *ss,
+		const struct rte_member_parameters *params);
+
+int
+rte_member_add_cbf(const struct rte_member_setsum *setsum,
+		const void *key, member_set_t set_id);
+
+int
+rte_member_delete_cbf(const struct rte_member_setsum *setsum,
+		const void *key, member_set_t set_id);
+
+void
+rte_member_free_cbf(struct rte_member_setsum *ss);
+
+void
+rte_member_reset_cbf(const struct rte_member_setsum *setsum);
+
 #ifdef __cplusplus
 }
 #endif
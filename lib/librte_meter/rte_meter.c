@@ -48,7 +48,16 @@
 static void
 rte_meter_get_tb_params(uint64_t hz, uint64_t rate, uint64_t *tb_period, uint64_t *tb_bytes_per_period)
 {
-	double period = ((double) hz) / ((double) rate);
+	double period;
+
+	/* Token bucket never refilled (RFC 4115 allows zero rates) */
+	if (rate == 0) {
+		*tb_bytes_per_period = 0;
+		*tb_period = RTE_METER_TB_PERIOD_MIN;
+		return;
+	}
+
+	period = ((double) hz) / ((double) rate);
 
 	if (period >= RTE_METER_TB_PERIOD_MIN) {
 		*tb_bytes_per_period = 1;
@@ -60,12 +69,13 @@ rte_meter_get_tb_params(uint64_t hz, uint64_t rate, uint64_t *tb_period, uint64_
 }
 
 int
-rte_meter_srtcm_config(struct rte_meter_srtcm *m, struct rte_meter_srtcm_params *params)
+rte_meter_srtcm_profile_config(struct rte_meter_srtcm_profile *p,
+	struct rte_meter_srtcm_params *params)
 {
 	uint64_t hz;
 
 	/* Check input parameters */
-	if ((m == NULL) || (params == NULL)) {
+	if ((p == NULL) || (params == NULL)) {
 		return -1;
 	}
 
@@ -73,27 +83,61 @@ rte_meter_srtcm_config(struct rte_meter_srtcm *m, struct rte_meter_srtcm_params
 		return -2;
 	}
 
-	/* Initialize srTCM run-time structure */
+	/* Initialize srTCM profile */
 	hz = rte_get_tsc_hz();
-	m->time = rte_get_tsc_cycles();
-	m->tc = m->cbs = params->cbs;
-	m->te = m->ebs = params->ebs;
-	rte_meter_get_tb_params(hz, params->cir, &m->cir_period, &m->cir_bytes_per_period);
+	p->cbs = params->cbs;
+	p->ebs = params->ebs;
+	rte_meter_get_tb_params(hz, params->cir, &p->cir_period, &p->cir_bytes_per_period);
 
 	RTE_LOG(INFO, METER, "Low level srTCM config: \n"
 		"\tCIR period = %" PRIu64 ", CIR bytes per period = %" PRIu64 "\n",
-		m->cir_period, m->cir_bytes_per_period);
+		p->cir_period, p->cir_bytes_per_period);
 
 	return 0;
 }
 
 int
-rte_meter_trtcm_config(struct rte_meter_trtcm *m, struct rte_meter_trtcm_params *params)
+rte_meter_srtcm_runtime_config(struct rte_meter_srtcm_runtime *m,
+	struct rte_meter_srtcm_profile *p)
+{
+	/* Check input parameters */
+	if ((m == NULL) || (p == NULL)) {
+		return -1;
+	}
+
+	/* Initialize srTCM run-time structure */
+	m->time = rte_get_tsc_cycles();
+	m->tc = p->cbs;
+	m->te = p->ebs;
+
+	return 0;
+}
+
+int
+rte_meter_srtcm_config(struct rte_meter_srtcm *m, struct rte_meter_srtcm_params *params)
+{
+	int status;
+
+	/* Check input parameters */
+	if (m == NULL) {
+		return -1;
+	}
+
+	status = rte_meter_srtcm_profile_config(&m->p, params);
+	if (status)
+		return status;
+
+	return rte_meter_srtcm_runtime_config(&m->rt, &m->p);
+}
+
+int
+rte_meter_trtcm_profile_config(struct rte_meter_trtcm_profile *p,
+	struct rte_meter_trtcm_params *params)
 {
 	uint64_t hz;
 
 	/* Check input parameters */
-	if ((m == NULL) || (params == NULL)) {
+	if ((p == NULL) || (params == NULL)) {
 		return -1;
 	}
 
@@ -102,19 +146,104 @@ rte_meter_trtcm_config(struct rte_meter_trtcm *m, struct rte_meter_trtcm_params
 		return -2;
 	}
 
-	/* Initialize trTCM run-time structure */
+	/* Initialize trTCM profile */
 	hz = rte_get_tsc_hz();
-	m->time_tc = m->time_tp = rte_get_tsc_cycles();
-	m->tc = m->cbs = params->cbs;
-	m->tp = m->pbs = params->pbs;
-	rte_meter_get_tb_params(hz, params->cir, &m->cir_period, &m->cir_bytes_per_period);
-	rte_meter_get_tb_params(hz, params->pir, &m->pir_period, &m->pir_bytes_per_period);
+	p->cbs = params->cbs;
+	p->pbs = params->pbs;
+	rte_meter_get_tb_params(hz, params->cir, &p->cir_period, &p->cir_bytes_per_period);
+	rte_meter_get_tb_params(hz, params->pir, &p->pir_period, &p->pir_bytes_per_period);
 
 	RTE_LOG(INFO, METER, "Low level trTCM config: \n"
 		"\tCIR period = %" PRIu64 ", CIR bytes per period = %" PRIu64 "\n"
 		"\tPIR period = %" PRIu64 ", PIR bytes per period = %" PRIu64 "\n",
-		m->cir_period, m->cir_bytes_per_period,
-		m->pir_period, m->pir_bytes_per_period);
+		p->cir_period, p->cir_bytes_per_period,
+		p->pir_period, p->pir_bytes_per_period);
+
+	return 0;
+}
+
+int
+rte_meter_trtcm_runtime_config(struct rte_meter_trtcm_runtime *m,
+	struct rte_meter_trtcm_profile *p)
+{
+	/* Check input parameters */
+	if ((m == NULL) || (p == NULL)) {
+		return -1;
+	}
+
+	/* Initialize trTCM run-time structure */
+	m->time_tc = m->time_tp = rte_get_tsc_cycles();
+	m->tc = p->cbs;
+	m->tp = p->pbs;
+
+	return 0;
+}
+
+int
+rte_meter_trtcm_config(struct rte_meter_trtcm *m, struct rte_meter_trtcm_params *params)
+{
+	int status;
+
+	/* Check input parameters */
+	if (m == NULL) {
+		return -1;
+	}
+
+	status = rte_meter_trtcm_profile_config(&m->p, params);
+	if (status)
+		return status;
+
+	return rte_meter_trtcm_runtime_config(&m->rt, &m->p);
+}
+
+int
+rte_meter_trtcm_rfc4115_profile_config(
+	struct rte_meter_trtcm_rfc4115_profile *p,
+	struct rte_meter_trtcm_rfc4115_params *params)
+{
+	uint64_t hz;
+
+	/* Check input parameters */
+	if ((p == NULL) || (params == NULL)) {
+		return -1;
+	}
+
+	if (((params->cbs == 0) && (params->ebs == 0)) ||
+		((params->cir != 0) && (params->cbs == 0)) ||
+		((params->eir != 0) && (params->ebs == 0))) {
+		return -2;
+	}
+
+	/* Initialize RFC 4115 trTCM profile */
+	hz = rte_get_tsc_hz();
+	p->cbs = params->cbs;
+	p->ebs = params->ebs;
+	rte_meter_get_tb_params(hz, params->cir, &p->cir_period, &p->cir_bytes_per_period);
+	rte_meter_get_tb_params(hz, params->eir, &p->eir_period, &p->eir_bytes_per_period);
+
+	RTE_LOG(INFO, METER, "Low level RFC 4115 trTCM config: \n"
+		"\tCIR period = %" PRIu64 ", CIR bytes per period = %" PRIu64 "\n"
+		"\tEIR period = %" PRIu64 ", EIR bytes per period = %" PRIu64 "\n",
+		p->cir_period, p->cir_bytes_per_period,
+		p->eir_period, p->eir_bytes_per_period);
+
+	return 0;
+}
+
+int
+rte_meter_trtcm_rfc4115_runtime_config(
+	struct rte_meter_trtcm_rfc4115_runtime *m,
+	struct rte_meter_trtcm_rfc4115_profile *p)
+{
+	/* Check input parameters */
+	if ((m == NULL) || (p == NULL)) {
+		return -1;
+	}
+
+	/* Initialize RFC 4115 trTCM run-time structure */
+	m->time_tc = m->time_te = rte_get_tsc_cycles();
+	m->tc = p->cbs;
+	m->te = p->ebs;
 
 	return 0;
 }
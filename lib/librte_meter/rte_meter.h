@@ -45,11 +45,21 @@ extern "C" {
  * Traffic metering algorithms:
  *    1. Single Rate Three Color Marker (srTCM): defined by IETF RFC 2697
  *    2. Two Rate Three Color Marker (trTCM): defined by IETF RFC 2698
+ *    3. Two Rate Three Color Marker (trTCM): defined by IETF RFC 4115
+ *
+ * Each metered traffic flow can either use a self-contained meter object
+ * (e.g. struct rte_meter_srtcm), or a small run-time context (e.g. struct
+ * rte_meter_srtcm_runtime) paired with a meter profile (e.g. struct
+ * rte_meter_srtcm_profile) storing the configuration that is shared by all
+ * the flows with the same parameters. The latter is preferred for large
+ * numbers of flows, as it reduces the cache footprint per flow.
  *
  ***/
 
 #include <stdint.h>
 
+#include <rte_prefetch.h>
+
 /*
  * Application Programmer's Interface (API)
  *
@@ -82,12 +92,48 @@ struct rte_meter_trtcm_params {
 	uint64_t pbs; /**< Peak Burst Size (PBS). Measured in bytes. */
 };
 
+/** trTCM parameters per metered traffic flow, as defined by RFC 4115. The
+CIR, EIR, CBS and EBS parameters only count bytes of IP packets and do not
+include link specific headers. At least one of the CBS or EBS parameters has to
+be greater than zero, and each one of them has to be greater than zero when its
+associated rate (CIR and EIR respectively) is non-zero. */
+struct rte_meter_trtcm_rfc4115_params {
+	uint64_t cir; /**< Committed Information Rate (CIR). Measured in bytes per second. */
+	uint64_t eir; /**< Excess Information Rate (EIR). Measured in bytes per second. */
+	uint64_t cbs; /**< Committed Burst Size (CBS). Measured in bytes. */
+	uint64_t ebs; /**< Excess Burst Size (EBS). Measured in bytes. */
+};
+
 /** Internal data structure storing the srTCM run-time context per metered traffic flow. */
 struct rte_meter_srtcm;
 
 /** Internal data structure storing the trTCM run-time context per metered traffic flow. */
 struct rte_meter_trtcm;
 
+/** Internal data structure storing the srTCM configuration shared by several
+metered traffic flows. */
+struct rte_meter_srtcm_profile;
+
+/** Internal data structure storing the srTCM run-time state per metered traffic
+flow, to be used with a srTCM profile. */
+struct rte_meter_srtcm_runtime;
+
+/** Internal data structure storing the trTCM configuration shared by several
+metered traffic flows. */
+struct rte_meter_trtcm_profile;
+
+/** Internal data structure storing the trTCM run-time state per metered traffic
+flow, to be used with a trTCM profile. */
+struct rte_meter_trtcm_runtime;
+
+/** Internal data structure storing the RFC 4115 trTCM configuration shared by
+several metered traffic flows. */
+struct rte_meter_trtcm_rfc4115_profile;
+
+/** Internal data structure storing the RFC 4115 trTCM run-time state per metered
+traffic flow, to be used with a RFC 4115 trTCM profile. */
+struct rte_meter_trtcm_rfc4115_runtime;
+
 /**
  * srTCM configuration per metered traffic flow
  *
@@ -116,6 +162,110 @@ int
 rte_meter_trtcm_config(struct rte_meter_trtcm *m,
 	struct rte_meter_trtcm_params *params);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * srTCM profile configuration
+ *
+ * @param p
+ *    Pointer to pre-allocated srTCM profile data structure
+ * @param params
+ *    srTCM profile parameters
+ * @return
+ *    0 upon success, error code otherwise
+ */
+int
+rte_meter_srtcm_profile_config(struct rte_meter_srtcm_profile *p,
+	struct rte_meter_srtcm_params *params);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * srTCM run-time context configuration per metered traffic flow
+ *
+ * @param m
+ *    Pointer to pre-allocated srTCM run-time data structure
+ * @param p
+ *    srTCM profile of the metered traffic flow
+ * @return
+ *    0 upon success, error code otherwise
+ */
+int
+rte_meter_srtcm_runtime_config(struct rte_meter_srtcm_runtime *m,
+	struct rte_meter_srtcm_profile *p);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * trTCM profile configuration
+ *
+ * @param p
+ *    Pointer to pre-allocated trTCM profile data structure
+ * @param params
+ *    trTCM profile parameters
+ * @return
+ *    0 upon success, error code otherwise
+ */
+int
+rte_meter_trtcm_profile_config(struct rte_meter_trtcm_profile *p,
+	struct rte_meter_trtcm_params *params);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * trTCM run-time context configuration per metered traffic flow
+ *
+ * @param m
+ *    Pointer to pre-allocated trTCM run-time data structure
+ * @param p
+ *    trTCM profile of the metered traffic flow
+ * @return
+ *    0 upon success, error code otherwise
+ */
+int
+rte_meter_trtcm_runtime_config(struct rte_meter_trtcm_runtime *m,
+	struct rte_meter_trtcm_profile *p);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * RFC 4115 trTCM profile configuration
+ *
+ * @param p
+ *    Pointer to pre-allocated RFC 4115 trTCM profile data structure
+ * @param params
+ *    RFC 4115 trTCM profile parameters
+ * @return
+ *    0 upon success, error code otherwise
+ */
+int
+rte_meter_trtcm_rfc4115_profile_config(
+	struct rte_meter_trtcm_rfc4115_profile *p,
+	struct rte_meter_trtcm_rfc4115_params *params);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * RFC 4115 trTCM run-time context configuration per metered traffic flow
+ *
+ * @param m
+ *    Pointer to pre-allocated RFC 4115 trTCM run-time data structure
+ * @param p
+ *    RFC 4115 trTCM profile of the metered traffic flow
+ * @return
+ *    0 upon success, error code otherwise
+ */
+int
+rte_meter_trtcm_rfc4115_runtime_config(
+	struct rte_meter_trtcm_rfc4115_runtime *m,
+	struct rte_meter_trtcm_rfc4115_profile *p);
+
 /**
  * srTCM color blind traffic metering
  *
@@ -190,28 +340,368 @@ rte_meter_trtcm_color_aware_check(struct rte_meter_trtcm *m,
 	uint32_t pkt_len,
 	enum rte_meter_color pkt_color);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * srTCM color blind traffic metering
+ *
+ * @param m
+ *    Handle to srTCM run-time context
+ * @param p
+ *    Handle to srTCM profile of the metered traffic flow
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Length of the current IP packet (measured in bytes)
+ * @return
+ *    Color assigned to the current IP packet
+ */
+static inline enum rte_meter_color
+rte_meter_srtcm_runtime_color_blind_check(struct rte_meter_srtcm_runtime *m,
+	struct rte_meter_srtcm_profile *p,
+	uint64_t time,
+	uint32_t pkt_len);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * srTCM color aware traffic metering
+ *
+ * @param m
+ *    Handle to srTCM run-time context
+ * @param p
+ *    Handle to srTCM profile of the metered traffic flow
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Length of the current IP packet (measured in bytes)
+ * @param pkt_color
+ *    Input color of the current IP packet
+ * @return
+ *    Color assigned to the current IP packet
+ */
+static inline enum rte_meter_color
+rte_meter_srtcm_runtime_color_aware_check(struct rte_meter_srtcm_runtime *m,
+	struct rte_meter_srtcm_profile *p,
+	uint64_t time,
+	uint32_t pkt_len,
+	enum rte_meter_color pkt_color);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * srTCM color blind traffic metering of a burst of packets, each one against
+ * its own metered traffic flow. The run-time contexts and profiles of the
+ * next packets are prefetched while the current packet is metered.
+ *
+ * @param m
+ *    Array of handles to srTCM run-time contexts, one per packet
+ * @param p
+ *    Array of handles to srTCM profiles, one per packet
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of IP packet lengths (measured in bytes)
+ * @param pkt_color
+ *    Array where the colors assigned to the packets are written
+ * @param n_pkts
+ *    Number of packets
+ */
+static inline void
+rte_meter_srtcm_runtime_color_blind_check_burst(
+	struct rte_meter_srtcm_runtime **m,
+	struct rte_meter_srtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *pkt_color,
+	uint32_t n_pkts);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * srTCM color aware traffic metering of a burst of packets, each one against
+ * its own metered traffic flow. The run-time contexts and profiles of the
+ * next packets are prefetched while the current packet is metered.
+ *
+ * @param m
+ *    Array of handles to srTCM run-time contexts, one per packet
+ * @param p
+ *    Array of handles to srTCM profiles, one per packet
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of IP packet lengths (measured in bytes)
+ * @param pkt_color
+ *    Array of packet colors: input colors on entry, overwritten with the
+ *    colors assigned to the packets on return
+ * @param n_pkts
+ *    Number of packets
+ */
+static inline void
+rte_meter_srtcm_runtime_color_aware_check_burst(
+	struct rte_meter_srtcm_runtime **m,
+	struct rte_meter_srtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *pkt_color,
+	uint32_t n_pkts);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * trTCM color blind traffic metering
+ *
+ * @param m
+ *    Handle to trTCM run-time context
+ * @param p
+ *    Handle to trTCM profile of the metered traffic flow
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Length of the current IP packet (measured in bytes)
+ * @return
+ *    Color assigned to the current IP packet
+ */
+static inline enum rte_meter_color
+rte_meter_trtcm_runtime_color_blind_check(struct rte_meter_trtcm_runtime *m,
+	struct rte_meter_trtcm_profile *p,
+	uint64_t time,
+	uint32_t pkt_len);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * trTCM color aware traffic metering
+ *
+ * @param m
+ *    Handle to trTCM run-time context
+ * @param p
+ *    Handle to trTCM profile of the metered traffic flow
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Length of the current IP packet (measured in bytes)
+ * @param pkt_color
+ *    Input color of the current IP packet
+ * @return
+ *    Color assigned to the current IP packet
+ */
+static inline enum rte_meter_color
+rte_meter_trtcm_runtime_color_aware_check(struct rte_meter_trtcm_runtime *m,
+	struct rte_meter_trtcm_profile *p,
+	uint64_t time,
+	uint32_t pkt_len,
+	enum rte_meter_color pkt_color);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * trTCM color blind traffic metering of a burst of packets, each one against
+ * its own metered traffic flow. The run-time contexts and profiles of the
+ * next packets are prefetched while the current packet is metered.
+ *
+ * @param m
+ *    Array of handles to trTCM run-time contexts, one per packet
+ * @param p
+ *    Array of handles to trTCM profiles, one per packet
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of IP packet lengths (measured in bytes)
+ * @param pkt_color
+ *    Array where the colors assigned to the packets are written
+ * @param n_pkts
+ *    Number of packets
+ */
+static inline void
+rte_meter_trtcm_runtime_color_blind_check_burst(
+	struct rte_meter_trtcm_runtime **m,
+	struct rte_meter_trtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *pkt_color,
+	uint32_t n_pkts);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * trTCM color aware traffic metering of a burst of packets, each one against
+ * its own metered traffic flow. The run-time contexts and profiles of the
+ * next packets are prefetched while the current packet is metered.
+ *
+ * @param m
+ *    Array of handles to trTCM run-time contexts, one per packet
+ * @param p
+ *    Array of handles to trTCM profiles, one per packet
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of IP packet lengths (measured in bytes)
+ * @param pkt_color
+ *    Array of packet colors: input colors on entry, overwritten with the
+ *    colors assigned to the packets on return
+ * @param n_pkts
+ *    Number of packets
+ */
+static inline void
+rte_meter_trtcm_runtime_color_aware_check_burst(
+	struct rte_meter_trtcm_runtime **m,
+	struct rte_meter_trtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *pkt_color,
+	uint32_t n_pkts);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * RFC 4115 trTCM color blind traffic metering
+ *
+ * @param m
+ *    Handle to RFC 4115 trTCM run-time context
+ * @param p
+ *    Handle to RFC 4115 trTCM profile of the metered traffic flow
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Length of the current IP packet (measured in bytes)
+ * @return
+ *    Color assigned to the current IP packet
+ */
+static inline enum rte_meter_color
+rte_meter_trtcm_rfc4115_runtime_color_blind_check(struct rte_meter_trtcm_rfc4115_runtime *m,
+	struct rte_meter_trtcm_rfc4115_profile *p,
+	uint64_t time,
+	uint32_t pkt_len);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * RFC 4115 trTCM color aware traffic metering
+ *
+ * @param m
+ *    Handle to RFC 4115 trTCM run-time context
+ * @param p
+ *    Handle to RFC 4115 trTCM profile of the metered traffic flow
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Length of the current IP packet (measured in bytes)
+ * @param pkt_color
+ *    Input color of the current IP packet
+ * @return
+ *    Color assigned to the current IP packet
+ */
+static inline enum rte_meter_color
+rte_meter_trtcm_rfc4115_runtime_color_aware_check(struct rte_meter_trtcm_rfc4115_runtime *m,
+	struct rte_meter_trtcm_rfc4115_profile *p,
+	uint64_t time,
+	uint32_t pkt_len,
+	enum rte_meter_color pkt_color);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * RFC 4115 trTCM color blind traffic metering of a burst of packets, each one against
+ * its own metered traffic flow. The run-time contexts and profiles of the
+ * next packets are prefetched while the current packet is metered.
+ *
+ * @param m
+ *    Array of handles to RFC 4115 trTCM run-time contexts, one per packet
+ * @param p
+ *    Array of handles to RFC 4115 trTCM profiles, one per packet
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of IP packet lengths (measured in bytes)
+ * @param pkt_color
+ *    Array where the colors assigned to the packets are written
+ * @param n_pkts
+ *    Number of packets
+ */
+static inline void
+rte_meter_trtcm_rfc4115_runtime_color_blind_check_burst(
+	struct rte_meter_trtcm_rfc4115_runtime **m,
+	struct rte_meter_trtcm_rfc4115_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *pkt_color,
+	uint32_t n_pkts);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * RFC 4115 trTCM color aware traffic metering of a burst of packets, each one against
+ * its own metered traffic flow. The run-time contexts and profiles of the
+ * next packets are prefetched while the current packet is metered.
+ *
+ * @param m
+ *    Array of handles to RFC 4115 trTCM run-time contexts, one per packet
+ * @param p
+ *    Array of handles to RFC 4115 trTCM profiles, one per packet
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of IP packet lengths (measured in bytes)
+ * @param pkt_color
+ *    Array of packet colors: input colors on entry, overwritten with the
+ *    colors assigned to the packets on return
+ * @param n_pkts
+ *    Number of packets
+ */
+static inline void
+rte_meter_trtcm_rfc4115_runtime_color_aware_check_burst(
+	struct rte_meter_trtcm_rfc4115_runtime **m,
+	struct rte_meter_trtcm_rfc4115_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *pkt_color,
+	uint32_t n_pkts);
+
 /*
  * Inline implementation of run-time methods
  *
  ***/
 
-/* Internal data structure storing the srTCM run-time context per metered traffic flow. */
-struct rte_meter_srtcm {
-	uint64_t time; /* Time of latest update of C and E token buckets */
-	uint64_t tc;   /* Number of bytes currently available in the committed (C) token bucket */
-	uint64_t te;   /* Number of bytes currently available in the excess (E) token bucket */
+#ifndef RTE_METER_PREFETCH_OFFSET
+#define RTE_METER_PREFETCH_OFFSET 4 /* Burst check prefetch distance */
+#endif
+
+/* Internal data structure storing the srTCM configuration shared by several metered traffic flows. */
+struct rte_meter_srtcm_profile {
 	uint64_t cbs;  /* Upper limit for C token bucket */
 	uint64_t ebs;  /* Upper limit for E token bucket */
 	uint64_t cir_period; /* Number of CPU cycles for one update of C and E token buckets */
 	uint64_t cir_bytes_per_period; /* Number of bytes to add to C and E token buckets on each update */
 };
 
-/* Internal data structure storing the trTCM run-time context per metered traffic flow. */
-struct rte_meter_trtcm {
-	uint64_t time_tc; /* Time of latest update of C token bucket */
-	uint64_t time_tp; /* Time of latest update of E token bucket */
-	uint64_t tc;      /* Number of bytes currently available in the committed (C) token bucket */
-	uint64_t tp;      /* Number of bytes currently available in the peak (P) token bucket */
+/* Internal data structure storing the srTCM run-time state per metered traffic flow. */
+struct rte_meter_srtcm_runtime {
+	uint64_t time; /* Time of latest update of C and E token buckets */
+	uint64_t tc;   /* Number of bytes currently available in the committed (C) token bucket */
+	uint64_t te;   /* Number of bytes currently available in the excess (E) token bucket */
+};
+
+/* Internal data structure storing the srTCM run-time context per metered traffic flow. */
+struct rte_meter_srtcm {
+	struct rte_meter_srtcm_runtime rt; /* Run-time state */
+	struct rte_meter_srtcm_profile p;  /* Configuration */
+};
+
+/* Internal data structure storing the trTCM configuration shared by several metered traffic flows. */
+struct rte_meter_trtcm_profile {
 	uint64_t cbs;     /* Upper limit for C token bucket */
 	uint64_t pbs;     /* Upper limit for P token bucket */
 	uint64_t cir_period; /* Number of CPU cycles for one update of C token bucket */
@@ -220,8 +710,41 @@ struct rte_meter_trtcm {
 	uint64_t pir_bytes_per_period; /* Number of bytes to add to P token bucket on each update */
 };
 
+/* Internal data structure storing the trTCM run-time state per metered traffic flow. */
+struct rte_meter_trtcm_runtime {
+	uint64_t time_tc; /* Time of latest update of C token bucket */
+	uint64_t time_tp; /* Time of latest update of P token bucket */
+	uint64_t tc;      /* Number of bytes currently available in the committed (C) token bucket */
+	uint64_t tp;      /* Number of bytes currently available in the peak (P) token bucket */
+};
+
+/* Internal data structure storing the trTCM run-time context per metered traffic flow. */
+struct rte_meter_trtcm {
+	struct rte_meter_trtcm_runtime rt; /* Run-time state */
+	struct rte_meter_trtcm_profile p;  /* Configuration */
+};
+
+/* Internal data structure storing the RFC 4115 trTCM configuration shared by several metered traffic flows. */
+struct rte_meter_trtcm_rfc4115_profile {
+	uint64_t cbs;     /* Upper limit for C token bucket */
+	uint64_t ebs;     /* Upper limit for E token bucket */
+	uint64_t cir_period; /* Number of CPU cycles for one update of C token bucket */
+	uint64_t cir_bytes_per_period; /* Number of bytes to add to C token bucket on each update */
+	uint64_t eir_period; /* Number of CPU cycles for one update of E token bucket */
+	uint64_t eir_bytes_per_period; /* Number of bytes to add to E token bucket on each update */
+};
+
+/* Internal data structure storing the RFC 4115 trTCM run-time state per metered traffic flow. */
+struct rte_meter_trtcm_rfc4115_runtime {
+	uint64_t time_tc; /* Time of latest update of C token bucket */
+	uint64_t time_te; /* Time of latest update of E token bucket */
+	uint64_t tc;      /* Number of bytes currently available in the committed (C) token bucket */
+	uint64_t te;      /* Number of bytes currently available in the excess (E) token bucket */
+};
+
 static inline enum rte_meter_color
-rte_meter_srtcm_color_blind_check(struct rte_meter_srtcm *m,
+rte_meter_srtcm_runtime_color_blind_check(struct rte_meter_srtcm_runtime *m,
+	struct rte_meter_srtcm_profile *p,
 	uint64_t time,
 	uint32_t pkt_len)
 {
@@ -229,17 +752,17 @@ rte_meter_srtcm_color_blind_check(struct rte_meter_srtcm *m,
 
 	/* Bucket update */
 	time_diff = time - m->time;
-	n_periods = time_diff / m->cir_period;
-	m->time += n_periods * m->cir_period;
+	n_periods = time_diff / p->cir_period;
+	m->time += n_periods * p->cir_period;
 
 	/* Put the tokens overflowing from tc into te bucket */
-	tc = m->tc + n_periods * m->cir_bytes_per_period;
+	tc = m->tc + n_periods * p->cir_bytes_per_period;
 	te = m->te;
-	if (tc > m->cbs) {
-		te += (tc - m->cbs);
-		if (te > m->ebs)
-			te = m->ebs;
-		tc = m->cbs;
+	if (tc > p->cbs) {
+		te += (tc - p->cbs);
+		if (te > p->ebs)
+			te = p->ebs;
+		tc = p->cbs;
 	}
 
 	/* Color logic */
@@ -261,7 +784,8 @@ rte_meter_srtcm_color_blind_check(struct rte_meter_srtcm *m,
 }
 
 static inline enum rte_meter_color
-rte_meter_srtcm_color_aware_check(struct rte_meter_srtcm *m,
+rte_meter_srtcm_runtime_color_aware_check(struct rte_meter_srtcm_runtime *m,
+	struct rte_meter_srtcm_profile *p,
 	uint64_t time,
 	uint32_t pkt_len,
 	enum rte_meter_color pkt_color)
@@ -270,17 +794,17 @@ rte_meter_srtcm_color_aware_check(struct rte_meter_srtcm *m,
 
 	/* Bucket update */
 	time_diff = time - m->time;
-	n_periods = time_diff / m->cir_period;
-	m->time += n_periods * m->cir_period;
+	n_periods = time_diff / p->cir_period;
+	m->time += n_periods * p->cir_period;
 
 	/* Put the tokens overflowing from tc into te bucket */
-	tc = m->tc + n_periods * m->cir_bytes_per_period;
+	tc = m->tc + n_periods * p->cir_bytes_per_period;
 	te = m->te;
-	if (tc > m->cbs) {
-		te += (tc - m->cbs);
-		if (te > m->ebs)
-			te = m->ebs;
-		tc = m->cbs;
+	if (tc > p->cbs) {
+		te += (tc - p->cbs);
+		if (te > p->ebs)
+			te = p->ebs;
+		tc = p->cbs;
 	}
 
 	/* Color logic */
@@ -302,7 +826,8 @@ rte_meter_srtcm_color_aware_check(struct rte_meter_srtcm *m,
 }
 
 static inline enum rte_meter_color
-rte_meter_trtcm_color_blind_check(struct rte_meter_trtcm *m,
+rte_meter_trtcm_runtime_color_blind_check(struct rte_meter_trtcm_runtime *m,
+	struct rte_meter_trtcm_profile *p,
 	uint64_t time,
 	uint32_t pkt_len)
 {
@@ -311,18 +836,18 @@ rte_meter_trtcm_color_blind_check(struct rte_meter_trtcm *m,
 	/* Bucket update */
 	time_diff_tc = time - m->time_tc;
 	time_diff_tp = time - m->time_tp;
-	n_periods_tc = time_diff_tc / m->cir_period;
-	n_periods_tp = time_diff_tp / m->pir_period;
-	m->time_tc += n_periods_tc * m->cir_period;
-	m->time_tp += n_periods_tp * m->pir_period;
+	n_periods_tc = time_diff_tc / p->cir_period;
+	n_periods_tp = time_diff_tp / p->pir_period;
+	m->time_tc += n_periods_tc * p->cir_period;
+	m->time_tp += n_periods_tp * p->pir_period;
 
-	tc = m->tc + n_periods_tc * m->cir_bytes_per_period;
-	if (tc > m->cbs)
-		tc = m->cbs;
+	tc = m->tc + n_periods_tc * p->cir_bytes_per_period;
+	if (tc > p->cbs)
+		tc = p->cbs;
 
-	tp = m->tp + n_periods_tp * m->pir_bytes_per_period;
-	if (tp > m->pbs)
-		tp = m->pbs;
+	tp = m->tp + n_periods_tp * p->pir_bytes_per_period;
+	if (tp > p->pbs)
+		tp = p->pbs;
 
 	/* Color logic */
 	if (tp < pkt_len) {
@@ -343,7 +868,8 @@ rte_meter_trtcm_color_blind_check(struct rte_meter_trtcm *m,
 }
 
 static inline enum rte_meter_color
-rte_meter_trtcm_color_aware_check(struct rte_meter_trtcm *m,
+rte_meter_trtcm_runtime_color_aware_check(struct rte_meter_trtcm_runtime *m,
+	struct rte_meter_trtcm_profile *p,
 	uint64_t time,
 	uint32_t pkt_len,
 	enum rte_meter_color pkt_color)
@@ -353,18 +879,18 @@ rte_meter_trtcm_color_aware_check(struct rte_meter_trtcm *m,
 	/* Bucket update */
 	time_diff_tc = time - m->time_tc;
 	time_diff_tp = time - m->time_tp;
-	n_periods_tc = time_diff_tc / m->cir_period;
-	n_periods_tp = time_diff_tp / m->pir_period;
-	m->time_tc += n_periods_tc * m->cir_period;
-	m->time_tp += n_periods_tp * m->pir_period;
+	n_periods_tc = time_diff_tc / p->cir_period;
+	n_periods_tp = time_diff_tp / p->pir_period;
+	m->time_tc += n_periods_tc * p->cir_period;
+	m->time_tp += n_periods_tp * p->pir_period;
 
-	tc = m->tc + n_periods_tc * m->cir_bytes_per_period;
-	if (tc > m->cbs)
-		tc = m->cbs;
+	tc = m->tc + n_periods_tc * p->cir_bytes_per_period;
+	if (tc > p->cbs)
+		tc = p->cbs;
 
-	tp = m->tp + n_periods_tp * m->pir_bytes_per_period;
-	if (tp > m->pbs)
-		tp = m->pbs;
+	tp = m->tp + n_periods_tp * p->pir_bytes_per_period;
+	if (tp > p->pbs)
+		tp = p->pbs;
 
 	/* Color logic */
 	if ((pkt_color == e_RTE_METER_RED) || (tp < pkt_len)) {
@@ -384,6 +910,293 @@ rte_meter_trtcm_color_aware_check(struct rte_meter_trtcm *m,
 	return e_RTE_METER_GREEN;
 }
 
+static inline enum rte_meter_color
+rte_meter_trtcm_rfc4115_runtime_color_blind_check(
+	struct rte_meter_trtcm_rfc4115_runtime *m,
+	struct rte_meter_trtcm_rfc4115_profile *p,
+	uint64_t time,
+	uint32_t pkt_len)
+{
+	uint64_t time_diff_tc, time_diff_te, n_periods_tc, n_periods_te, tc, te;
+
+	/* Bucket update: unlike RFC 2697, the two buckets are independent */
+	time_diff_tc = time - m->time_tc;
+	time_diff_te = time - m->time_te;
+	n_periods_tc = time_diff_tc / p->cir_period;
+	n_periods_te = time_diff_te / p->eir_period;
+	m->time_tc += n_periods_tc * p->cir_period;
+	m->time_te += n_periods_te * p->eir_period;
+
+	tc = m->tc + n_periods_tc * p->cir_bytes_per_period;
+	if (tc > p->cbs)
+		tc = p->cbs;
+
+	te = m->te + n_periods_te * p->eir_bytes_per_period;
+	if (te > p->ebs)
+		te = p->ebs;
+
+	/* Color logic */
+	if (tc >= pkt_len) {
+		m->tc = tc - pkt_len;
+		m->te = te;
+		return e_RTE_METER_GREEN;
+	}
+
+	if (te >= pkt_len) {
+		m->tc = tc;
+		m->te = te - pkt_len;
+		return e_RTE_METER_YELLOW;
+	}
+
+	m->tc = tc;
+	m->te = te;
+	return e_RTE_METER_RED;
+}
+
+static inline enum rte_meter_color
+rte_meter_trtcm_rfc4115_runtime_color_aware_check(
+	struct rte_meter_trtcm_rfc4115_runtime *m,
+	struct rte_meter_trtcm_rfc4115_profile *p,
+	uint64_t time,
+	uint32_t pkt_len,
+	enum rte_meter_color pkt_color)
+{
+	uint64_t time_diff_tc, time_diff_te, n_periods_tc, n_periods_te, tc, te;
+
+	/* Bucket update: unlike RFC 2697, the two buckets are independent */
+	time_diff_tc = time - m->time_tc;
+	time_diff_te = time - m->time_te;
+	n_periods_tc = time_diff_tc / p->cir_period;
+	n_periods_te = time_diff_te / p->eir_period;
+	m->time_tc += n_periods_tc * p->cir_period;
+	m->time_te += n_periods_te * p->eir_period;
+
+	tc = m->tc + n_periods_tc * p->cir_bytes_per_period;
+	if (tc > p->cbs)
+		tc = p->cbs;
+
+	te = m->te + n_periods_te * p->eir_bytes_per_period;
+	if (te > p->ebs)
+		te = p->ebs;
+
+	/* Color logic */
+	if ((pkt_color == e_RTE_METER_GREEN) && (tc >= pkt_len)) {
+		m->tc = tc - pkt_len;
+		m->te = te;
+		return e_RTE_METER_GREEN;
+	}
+
+	if ((pkt_color != e_RTE_METER_RED) && (te >= pkt_len)) {
+		m->tc = tc;
+		m->te = te - pkt_len;
+		return e_RTE_METER_YELLOW;
+	}
+
+	m->tc = tc;
+	m->te = te;
+	return e_RTE_METER_RED;
+}
+
+static inline void
+rte_meter_srtcm_runtime_color_blind_check_burst(
+	struct rte_meter_srtcm_runtime **m,
+	struct rte_meter_srtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *pkt_color,
+	uint32_t n_pkts)
+{
+	uint32_t i;
+
+	for (i = 0; (i < n_pkts) && (i < RTE_METER_PREFETCH_OFFSET); i++) {
+		rte_prefetch0(m[i]);
+		rte_prefetch0(p[i]);
+	}
+
+	for (i = 0; i < n_pkts; i++) {
+		if (i + RTE_METER_PREFETCH_OFFSET < n_pkts) {
+			rte_prefetch0(m[i + RTE_METER_PREFETCH_OFFSET]);
+			rte_prefetch0(p[i + RTE_METER_PREFETCH_OFFSET]);
+		}
+
+		pkt_color[i] = rte_meter_srtcm_runtime_color_blind_check(m[i],
+			p[i], time, pkt_len[i]);
+	}
+}
+
+static inline void
+rte_meter_srtcm_runtime_color_aware_check_burst(
+	struct rte_meter_srtcm_runtime **m,
+	struct rte_meter_srtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *pkt_color,
+	uint32_t n_pkts)
+{
+	uint32_t i;
+
+	for (i = 0; (i < n_pkts) && (i < RTE_METER_PREFETCH_OFFSET); i++) {
+		rte_prefetch0(m[i]);
+		rte_prefetch0(p[i]);
+	}
+
+	for (i = 0; i < n_pkts; i++) {
+		if (i + RTE_METER_PREFETCH_OFFSET < n_pkts) {
+			rte_prefetch0(m[i + RTE_METER_PREFETCH_OFFSET]);
+			rte_prefetch0(p[i + RTE_METER_PREFETCH_OFFSET]);
+		}
+
+		pkt_color[i] = rte_meter_srtcm_runtime_color_aware_check(m[i],
+			p[i], time, pkt_len[i], pkt_color[i]);
+	}
+}
+
+static inline void
+rte_meter_trtcm_runtime_color_blind_check_burst(
+	struct rte_meter_trtcm_runtime **m,
+	struct rte_meter_trtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *pkt_color,
+	uint32_t n_pkts)
+{
+	uint32_t i;
+
+	for (i = 0; (i < n_pkts) && (i < RTE_METER_PREFETCH_OFFSET); i++) {
+		rte_prefetch0(m[i]);
+		rte_prefetch0(p[i]);
+	}
+
+	for (i = 0; i < n_pkts; i++) {
+		if (i + RTE_METER_PREFETCH_OFFSET < n_pkts) {
+			rte_prefetch0(m[i + RTE_METER_PREFETCH_OFFSET]);
+			rte_prefetch0(p[i + RTE_METER_PREFETCH_OFFSET]);
+		}
+
+		pkt_color[i] = rte_meter_trtcm_runtime_color_blind_check(m[i],
+			p[i], time, pkt_len[i]);
+	}
+}
+
+static inline void
+rte_meter_trtcm_runtime_color_aware_check_burst(
+	struct rte_meter_trtcm_runtime **m,
+	struct rte_meter_trtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *pkt_color,
+	uint32_t n_pkts)
+{
+	uint32_t i;
+
+	for (i = 0; (i < n_pkts) && (i < RTE_METER_PREFETCH_OFFSET); i++) {
+		rte_prefetch0(m[i]);
+		rte_prefetch0(p[i]);
+	}
+
+	for (i = 0; i < n_pkts; i++) {
+		if (i + RTE_METER_PREFETCH_OFFSET < n_pkts) {
+			rte_prefetch0(m[i + RTE_METER_PREFETCH_OFFSET]);
+			rte_prefetch0(p[i + RTE_METER_PREFETCH_OFFSET]);
+		}
+
+		pkt_color[i] = rte_meter_trtcm_runtime_color_aware_check(m[i],
+			p[i], time, pkt_len[i], pkt_color[i]);
+	}
+}
+
+static inline void
+rte_meter_trtcm_rfc4115_runtime_color_blind_check_burst(
+	struct rte_meter_trtcm_rfc4115_runtime **m,
+	struct rte_meter_trtcm_rfc4115_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *pkt_color,
+	uint32_t n_pkts)
+{
+	uint32_t i;
+
+	for (i = 0; (i < n_pkts) && (i < RTE_METER_PREFETCH_OFFSET); i++) {
+		rte_prefetch0(m[i]);
+		rte_prefetch0(p[i]);
+	}
+
+	for (i = 0; i < n_pkts; i++) {
+		if (i + RTE_METER_PREFETCH_OFFSET < n_pkts) {
+			rte_prefetch0(m[i + RTE_METER_PREFETCH_OFFSET]);
+			rte_prefetch0(p[i + RTE_METER_PREFETCH_OFFSET]);
+		}
+
+		pkt_color[i] = rte_meter_trtcm_rfc4115_runtime_color_blind_check(m[i],
+			p[i], time, pkt_len[i]);
+	}
+}
+
+static inline void
+rte_meter_trtcm_rfc4115_runtime_color_aware_check_burst(
+	struct rte_meter_trtcm_rfc4115_runtime **m,
+	struct rte_meter_trtcm_rfc4115_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *pkt_color,
+	uint32_t n_pkts)
+{
+	uint32_t i;
+
+	for (i = 0; (i < n_pkts) && (i < RTE_METER_PREFETCH_OFFSET); i++) {
+		rte_prefetch0(m[i]);
+		rte_prefetch0(p[i]);
+	}
+
+	for (i = 0; i < n_pkts; i++) {
+		if (i + RTE_METER_PREFETCH_OFFSET < n_pkts) {
+			rte_prefetch0(m[i + RTE_METER_PREFETCH_OFFSET]);
+			rte_prefetch0(p[i + RTE_METER_PREFETCH_OFFSET]);
+		}
+
+		pkt_color[i] = rte_meter_trtcm_rfc4115_runtime_color_aware_check(m[i],
+			p[i], time, pkt_len[i], pkt_color[i]);
+	}
+}
+
+static inline enum rte_meter_color
+rte_meter_srtcm_color_blind_check(struct rte_meter_srtcm *m,
+	uint64_t time,
+	uint32_t pkt_len)
+{
+	return rte_meter_srtcm_runtime_color_blind_check(&m->rt, &m->p,
+		time, pkt_len);
+}
+
+static inline enum rte_meter_color
+rte_meter_srtcm_color_aware_check(struct rte_meter_srtcm *m,
+	uint64_t time,
+	uint32_t pkt_len,
+	enum rte_meter_color pkt_color)
+{
+	return rte_meter_srtcm_runtime_color_aware_check(&m->rt, &m->p,
+		time, pkt_len, pkt_color);
+}
+
+static inline enum rte_meter_color
+rte_meter_trtcm_color_blind_check(struct rte_meter_trtcm *m,
+	uint64_t time,
+	uint32_t pkt_len)
+{
+	return rte_meter_trtcm_runtime_color_blind_check(&m->rt, &m->p,
+		time, pkt_len);
+}
+
+static inline enum rte_meter_color
+rte_meter_trtcm_color_aware_check(struct rte_meter_trtcm *m,
+	uint64_t time,
+	uint32_t pkt_len,
+	enum rte_meter_color pkt_color)
+{
+	return rte_meter_trtcm_runtime_color_aware_check(&m->rt, &m->p,
+		time, pkt_len, pkt_color);
+}
+
 #ifdef __cplusplus
 }
 #endif
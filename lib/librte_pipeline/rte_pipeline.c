@@ -343,6 +343,14 @@ rte_table_check_params(struct rte_pipeline *p,
 		return -EINVAL;
 	}
 
+	if ((params->ops->f_reader_enter == NULL) !=
+		(params->ops->f_reader_exit == NULL)) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: only one of f_reader_enter and f_reader_exit "
+			"function pointers is NULL\n", __func__);
+		return -EINVAL;
+	}
+
 	/* De we have room for one more table? */
 	if (p->num_tables == RTE_PIPELINE_TABLE_MAX) {
 		RTE_LOG(ERR, PIPELINE,
@@ -1343,6 +1351,7 @@ int
 rte_pipeline_run(struct rte_pipeline *p)
 {
 	struct rte_port_in *port_in = p->port_in_next;
+	uint64_t tables_read_mask = 0;
 	uint32_t n_pkts, table_id;
 
 	if (port_in == NULL)
@@ -1375,8 +1384,17 @@ rte_pipeline_run(struct rte_pipeline *p)
 		struct rte_table *table;
 		uint64_t lookup_hit_mask, lookup_miss_mask;
 
-		/* Lookup */
+		/*
+		 * Lookup. The table read-side section lasts until all the table
+		 * entries of the burst have been used by the actions.
+		 */
 		table = &p->tables[table_id];
+		if ((table->ops.f_reader_enter != NULL) &&
+			((tables_read_mask & (1LLU << table_id)) == 0)) {
+			table->ops.f_reader_enter(table->h_table);
+			tables_read_mask |= 1LLU << table_id;
+		}
+
 		table->ops.f_lookup(table->h_table, p->pkts, p->pkts_mask,
 			&lookup_hit_mask, (void **) p->entries);
 		lookup_miss_mask = p->pkts_mask & (~lookup_hit_mask);
@@ -1472,6 +1490,15 @@ rte_pipeline_run(struct rte_pipeline *p)
 	rte_pipeline_action_handler_drop(p,
 		p->action_mask0[RTE_PIPELINE_ACTION_DROP]);
 
+	/* Table read-side sections end */
+	for ( ; tables_read_mask != 0;
+		tables_read_mask &= tables_read_mask - 1) {
+		struct rte_table *table =
+			&p->tables[__builtin_ctzll(tables_read_mask)];
+
+		table->ops.f_reader_exit(table->h_table);
+	}
+
 	/* Pick candidate for next port IN to serve */
 	p->port_in_next = port_in->next;
 
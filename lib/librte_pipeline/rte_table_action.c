@@ -0,0 +1,2169 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_memcpy.h>
+#include <rte_prefetch.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+
+#include "rte_table_action.h"
+
+#define rte_htons rte_cpu_to_be_16
+#define rte_htonl rte_cpu_to_be_32
+
+#define rte_ntohs rte_be_to_cpu_16
+#define rte_ntohl rte_be_to_cpu_32
+
+/**
+ * RTE_TABLE_ACTION_FWD
+ */
+#define fwd_data rte_pipeline_table_entry
+
+static int
+fwd_apply(struct fwd_data *data,
+	struct rte_table_action_fwd_params *p)
+{
+	data->action = p->action;
+
+	if (p->action == RTE_PIPELINE_ACTION_PORT)
+		data->port_id = p->id;
+
+	if (p->action == RTE_PIPELINE_ACTION_TABLE)
+		data->table_id = p->id;
+
+	return 0;
+}
+
+/**
+ * RTE_TABLE_ACTION_MTR
+ */
+static int
+mtr_cfg_check(struct rte_table_action_mtr_config *mtr)
+{
+	if ((mtr->n_tc == 0) ||
+		(mtr->n_tc > RTE_TABLE_ACTION_TC_MAX))
+		return -EINVAL;
+
+	return 0;
+}
+
+#define METER_PROFILES_MAX                                 32
+
+/* Meter profile, shared by all the table rules using it. */
+struct meter_profile_data {
+	struct rte_meter_trtcm_profile profile;
+	uint32_t profile_id;
+	int valid;
+};
+
+static struct meter_profile_data *
+meter_profile_data_find(struct meter_profile_data *mp,
+	uint32_t mp_size,
+	uint32_t profile_id)
+{
+	uint32_t i;
+
+	for (i = 0; i < mp_size; i++) {
+		struct meter_profile_data *mp_data = &mp[i];
+
+		if (mp_data->valid && (mp_data->profile_id == profile_id))
+			return mp_data;
+	}
+
+	return NULL;
+}
+
+static struct meter_profile_data *
+meter_profile_data_find_unused(struct meter_profile_data *mp,
+	uint32_t mp_size)
+{
+	uint32_t i;
+
+	for (i = 0; i < mp_size; i++) {
+		struct meter_profile_data *mp_data = &mp[i];
+
+		if (!mp_data->valid)
+			return mp_data;
+	}
+
+	return NULL;
+}
+
+/* Per traffic class meter context. Only the meter run-time state is stored
+ * per table rule, the meter profile is referenced by its index in the meter
+ * profile table of the action object. The packet counters are indexed by the
+ * policer action, so the drop counter immediately follows the per color ones.
+ */
+struct mtr_trtcm_data {
+	struct rte_meter_trtcm_runtime trtcm;
+	uint64_t n_packets[RTE_TABLE_ACTION_POLICER_MAX];
+	uint32_t profile_index;
+	uint8_t policer[e_RTE_METER_COLORS];
+};
+
+static size_t
+mtr_data_size(struct rte_table_action_mtr_config *mtr)
+{
+	return mtr->n_tc * sizeof(struct mtr_trtcm_data);
+}
+
+struct dscp_table_entry_data {
+	uint32_t tc;
+	enum rte_meter_color color;
+};
+
+struct dscp_table_data {
+	struct dscp_table_entry_data entry[RTE_TABLE_ACTION_DSCP_MAX];
+};
+
+static int
+mtr_apply_check(struct rte_table_action_mtr_params *p,
+	struct rte_table_action_mtr_config *cfg,
+	struct meter_profile_data *mp,
+	uint32_t mp_size)
+{
+	uint32_t i;
+
+	if (p->tc_mask != RTE_LEN2MASK(cfg->n_tc, uint32_t))
+		return -EINVAL;
+
+	for (i = 0; i < cfg->n_tc; i++) {
+		uint32_t j;
+
+		if (meter_profile_data_find(mp, mp_size,
+			p->mtr[i].meter_profile_id) == NULL)
+			return -EINVAL;
+
+		for (j = 0; j < e_RTE_METER_COLORS; j++)
+			if ((uint32_t)p->mtr[i].policer[j] >=
+				RTE_TABLE_ACTION_POLICER_MAX)
+				return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int
+mtr_apply(struct mtr_trtcm_data *data,
+	struct rte_table_action_mtr_params *p,
+	struct rte_table_action_mtr_config *cfg,
+	struct meter_profile_data *mp,
+	uint32_t mp_size)
+{
+	uint32_t i;
+	int status;
+
+	status = mtr_apply_check(p, cfg, mp, mp_size);
+	if (status)
+		return status;
+
+	for (i = 0; i < cfg->n_tc; i++) {
+		struct mtr_trtcm_data *d = &data[i];
+		struct rte_table_action_mtr_tc_params *tc = &p->mtr[i];
+		struct meter_profile_data *mp_data;
+		uint32_t j;
+
+		mp_data = meter_profile_data_find(mp, mp_size,
+			tc->meter_profile_id);
+
+		status = rte_meter_trtcm_runtime_config(&d->trtcm,
+			&mp_data->profile);
+		if (status)
+			return status;
+
+		d->profile_index = mp_data - mp;
+
+		memset(d->n_packets, 0, sizeof(d->n_packets));
+
+		for (j = 0; j < e_RTE_METER_COLORS; j++)
+			d->policer[j] = (uint8_t)tc->policer[j];
+	}
+
+	return 0;
+}
+
+static __rte_always_inline uint64_t
+pkt_work_mtr(struct mtr_trtcm_data *data,
+	struct dscp_table_data *dscp_table,
+	struct meter_profile_data *mp,
+	uint64_t time,
+	uint32_t dscp,
+	uint16_t total_length)
+{
+	struct dscp_table_entry_data *dscp_entry = &dscp_table->entry[dscp];
+	struct mtr_trtcm_data *d = &data[dscp_entry->tc];
+	enum rte_meter_color color;
+	uint32_t policer;
+
+	color = rte_meter_trtcm_runtime_color_aware_check(&d->trtcm,
+		&mp[d->profile_index].profile,
+		time,
+		total_length,
+		dscp_entry->color);
+
+	policer = d->policer[color];
+	d->n_packets[policer]++;
+
+	return policer == RTE_TABLE_ACTION_POLICER_DROP;
+}
+
+/**
+ * RTE_TABLE_ACTION_ENCAP
+ */
+static int
+encap_valid(enum rte_table_action_encap_type encap)
+{
+	switch (encap) {
+	case RTE_TABLE_ACTION_ENCAP_ETHER:
+	case RTE_TABLE_ACTION_ENCAP_VLAN:
+	case RTE_TABLE_ACTION_ENCAP_QINQ:
+	case RTE_TABLE_ACTION_ENCAP_MPLS:
+	case RTE_TABLE_ACTION_ENCAP_VXLAN:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+static int
+encap_cfg_check(struct rte_table_action_encap_config *encap)
+{
+	uint64_t valid_mask = 0;
+	uint32_t i;
+
+	for (i = 0; i < 64; i++)
+		if (encap_valid((enum rte_table_action_encap_type)i))
+			valid_mask |= 1LLU << i;
+
+	if ((encap->encap_mask == 0) ||
+		(encap->encap_mask & ~valid_mask))
+		return -ENOTSUP;
+
+	return 0;
+}
+
+struct encap_ether_data {
+	struct ether_hdr ether;
+} __attribute__((__packed__));
+
+#define VLAN(pcp, dei, vid)                                \
+	((uint16_t)((((uint64_t)(pcp)) & 0x7LLU) << 13) |  \
+	((((uint64_t)(dei)) & 0x1LLU) << 12) |             \
+	(((uint64_t)(vid)) & 0xFFFLLU))                    \
+
+struct encap_vlan_data {
+	struct ether_hdr ether;
+	struct vlan_hdr vlan;
+} __attribute__((__packed__));
+
+struct encap_qinq_data {
+	struct ether_hdr ether;
+	struct vlan_hdr svlan;
+	struct vlan_hdr cvlan;
+} __attribute__((__packed__));
+
+#define ETHER_TYPE_MPLS_UNICAST                            0x8847
+
+#define ETHER_TYPE_MPLS_MULTICAST                          0x8848
+
+#define MPLS(label, tc, s, ttl)                            \
+	((uint32_t)(((((uint64_t)(label)) & 0xFFFFFLLU) << 12) |\
+	((((uint64_t)(tc)) & 0x7LLU) << 9) |               \
+	((((uint64_t)(s)) & 0x1LLU) << 8) |                \
+	(((uint64_t)(ttl)) & 0xFFLLU)))
+
+struct encap_mpls_data {
+	struct ether_hdr ether;
+	uint32_t mpls[RTE_TABLE_ACTION_MPLS_LABELS_MAX];
+	uint32_t mpls_count;
+} __attribute__((__packed__));
+
+#define VXLAN_FLAGS                                        0x08000000
+
+#define IP_VERSION_4                                       0x40
+
+/* Default IPv4 header length = 5 words of 4 bytes each */
+#define IP_HDR_LENGTH                                      0x05
+
+struct encap_vxlan_ipv4_data {
+	struct ether_hdr ether;
+	struct ipv4_hdr ipv4;
+	struct udp_hdr udp;
+	struct vxlan_hdr vxlan;
+} __attribute__((__packed__));
+
+struct encap_vxlan_ipv4_vlan_data {
+	struct ether_hdr ether;
+	struct vlan_hdr vlan;
+	struct ipv4_hdr ipv4;
+	struct udp_hdr udp;
+	struct vxlan_hdr vxlan;
+} __attribute__((__packed__));
+
+struct encap_vxlan_ipv6_data {
+	struct ether_hdr ether;
+	struct ipv6_hdr ipv6;
+	struct udp_hdr udp;
+	struct vxlan_hdr vxlan;
+} __attribute__((__packed__));
+
+struct encap_vxlan_ipv6_vlan_data {
+	struct ether_hdr ether;
+	struct vlan_hdr vlan;
+	struct ipv6_hdr ipv6;
+	struct udp_hdr udp;
+	struct vxlan_hdr vxlan;
+} __attribute__((__packed__));
+
+/* Per rule encap context: the encapsulation type selected for the rule,
+ * followed by the pre-built header that gets pushed onto the packet.
+ */
+struct encap_data {
+	uint32_t type;
+	uint32_t reserved;
+	uint8_t hdr[0];
+};
+
+static size_t
+encap_hdr_size(enum rte_table_action_encap_type type,
+	struct rte_table_action_encap_config *cfg)
+{
+	switch (type) {
+	case RTE_TABLE_ACTION_ENCAP_ETHER:
+		return sizeof(struct encap_ether_data);
+
+	case RTE_TABLE_ACTION_ENCAP_VLAN:
+		return sizeof(struct encap_vlan_data);
+
+	case RTE_TABLE_ACTION_ENCAP_QINQ:
+		return sizeof(struct encap_qinq_data);
+
+	case RTE_TABLE_ACTION_ENCAP_MPLS:
+		return sizeof(struct encap_mpls_data);
+
+	case RTE_TABLE_ACTION_ENCAP_VXLAN:
+		if (cfg->vxlan.ip_version)
+			return cfg->vxlan.vlan ?
+				sizeof(struct encap_vxlan_ipv4_vlan_data) :
+				sizeof(struct encap_vxlan_ipv4_data);
+		return cfg->vxlan.vlan ?
+			sizeof(struct encap_vxlan_ipv6_vlan_data) :
+			sizeof(struct encap_vxlan_ipv6_data);
+
+	default:
+		return 0;
+	}
+}
+
+static size_t
+encap_data_size(struct rte_table_action_encap_config *encap)
+{
+	size_t size = 0;
+	uint32_t i;
+
+	for (i = 0; i < 64; i++) {
+		size_t hdr_size;
+
+		if ((encap->encap_mask & (1LLU << i)) == 0)
+			continue;
+
+		hdr_size = encap_hdr_size((enum rte_table_action_encap_type)i,
+			encap);
+		if (hdr_size > size)
+			size = hdr_size;
+	}
+
+	return sizeof(struct encap_data) + size;
+}
+
+static int
+encap_apply_check(struct rte_table_action_encap_params *p,
+	struct rte_table_action_encap_config *cfg)
+{
+	if ((encap_valid(p->type) == 0) ||
+		((cfg->encap_mask & (1LLU << p->type)) == 0))
+		return -EINVAL;
+
+	switch (p->type) {
+	case RTE_TABLE_ACTION_ENCAP_MPLS:
+		if ((p->mpls.mpls_count == 0) ||
+			(p->mpls.mpls_count > RTE_TABLE_ACTION_MPLS_LABELS_MAX))
+			return -EINVAL;
+		return 0;
+
+	default:
+		return 0;
+	}
+}
+
+static void
+encap_ether_hdr_set(struct ether_hdr *ether,
+	struct rte_table_action_ether_hdr *p,
+	uint16_t ether_type)
+{
+	ether_addr_copy(&p->da, &ether->d_addr);
+	ether_addr_copy(&p->sa, &ether->s_addr);
+	ether->ether_type = rte_htons(ether_type);
+}
+
+static void
+encap_vlan_hdr_set(struct vlan_hdr *vlan,
+	struct rte_table_action_vlan_hdr *p,
+	uint16_t ether_type)
+{
+	vlan->vlan_tci = rte_htons(VLAN(p->pcp, p->dei, p->vid));
+	vlan->eth_proto = rte_htons(ether_type);
+}
+
+static void
+encap_ether_apply(void *data,
+	struct rte_table_action_encap_params *p,
+	struct rte_table_action_common_config *common_cfg)
+{
+	struct encap_ether_data *d = data;
+	uint16_t ethertype = (common_cfg->ip_version) ?
+		ETHER_TYPE_IPv4 :
+		ETHER_TYPE_IPv6;
+
+	encap_ether_hdr_set(&d->ether, &p->ether.ether, ethertype);
+}
+
+static void
+encap_vlan_apply(void *data,
+	struct rte_table_action_encap_params *p,
+	struct rte_table_action_common_config *common_cfg)
+{
+	struct encap_vlan_data *d = data;
+	uint16_t ethertype = (common_cfg->ip_version) ?
+		ETHER_TYPE_IPv4 :
+		ETHER_TYPE_IPv6;
+
+	encap_ether_hdr_set(&d->ether, &p->vlan.ether, ETHER_TYPE_VLAN);
+	encap_vlan_hdr_set(&d->vlan, &p->vlan.vlan, ethertype);
+}
+
+static void
+encap_qinq_apply(void *data,
+	struct rte_table_action_encap_params *p,
+	struct rte_table_action_common_config *common_cfg)
+{
+	struct encap_qinq_data *d = data;
+	uint16_t ethertype = (common_cfg->ip_version) ?
+		ETHER_TYPE_IPv4 :
+		ETHER_TYPE_IPv6;
+
+	encap_ether_hdr_set(&d->ether, &p->qinq.ether, ETHER_TYPE_QINQ);
+	encap_vlan_hdr_set(&d->svlan, &p->qinq.svlan, ETHER_TYPE_VLAN);
+	encap_vlan_hdr_set(&d->cvlan, &p->qinq.cvlan, ethertype);
+}
+
+static void
+encap_mpls_apply(void *data,
+	struct rte_table_action_encap_params *p)
+{
+	struct encap_mpls_data *d = data;
+	uint16_t ethertype = (p->mpls.unicast) ?
+		ETHER_TYPE_MPLS_UNICAST :
+		ETHER_TYPE_MPLS_MULTICAST;
+	uint32_t i;
+
+	encap_ether_hdr_set(&d->ether, &p->mpls.ether, ethertype);
+
+	for (i = 0; i < p->mpls.mpls_count - 1; i++)
+		d->mpls[i] = rte_htonl(MPLS(p->mpls.mpls[i].label,
+			p->mpls.mpls[i].tc,
+			0,
+			p->mpls.mpls[i].ttl));
+
+	d->mpls[i] = rte_htonl(MPLS(p->mpls.mpls[i].label,
+		p->mpls.mpls[i].tc,
+		1,
+		p->mpls.mpls[i].ttl));
+
+	d->mpls_count = p->mpls.mpls_count;
+}
+
+static void
+encap_vxlan_ipv4_hdr_set(struct ipv4_hdr *ipv4,
+	struct rte_table_action_encap_vxlan_params *p)
+{
+	ipv4->version_ihl = IP_VERSION_4 | IP_HDR_LENGTH;
+	ipv4->type_of_service = p->ipv4.dscp << 2;
+	ipv4->total_length = 0; /* not pre-computed */
+	ipv4->packet_id = 0;
+	ipv4->fragment_offset = 0;
+	ipv4->time_to_live = p->ipv4.ttl;
+	ipv4->next_proto_id = IPPROTO_UDP;
+	ipv4->hdr_checksum = 0;
+	ipv4->src_addr = rte_htonl(p->ipv4.sa);
+	ipv4->dst_addr = rte_htonl(p->ipv4.da);
+
+	/* Partial checksum: the total length is added per packet */
+	ipv4->hdr_checksum = rte_ipv4_cksum(ipv4);
+}
+
+static void
+encap_vxlan_ipv6_hdr_set(struct ipv6_hdr *ipv6,
+	struct rte_table_action_encap_vxlan_params *p)
+{
+	ipv6->vtc_flow = rte_htonl((6 << 28) |
+		(((uint32_t)p->ipv6.dscp) << 22) |
+		(p->ipv6.flow_label & 0xFFFFF));
+	ipv6->payload_len = 0; /* not pre-computed */
+	ipv6->proto = IPPROTO_UDP;
+	ipv6->hop_limits = p->ipv6.hop_limit;
+	memcpy(ipv6->src_addr, p->ipv6.sa, sizeof(ipv6->src_addr));
+	memcpy(ipv6->dst_addr, p->ipv6.da, sizeof(ipv6->dst_addr));
+}
+
+static void
+encap_vxlan_udp_hdr_set(struct udp_hdr *udp,
+	struct vxlan_hdr *vxlan,
+	struct rte_table_action_encap_vxlan_params *p)
+{
+	udp->src_port = rte_htons(p->udp.sp);
+	udp->dst_port = rte_htons(p->udp.dp);
+	udp->dgram_len = 0; /* not pre-computed */
+	udp->dgram_cksum = 0;
+
+	vxlan->vx_flags = rte_htonl(VXLAN_FLAGS);
+	vxlan->vx_vni = rte_htonl((p->vni & 0xFFFFFF) << 8);
+}
+
+static void
+encap_vxlan_apply(void *data,
+	struct rte_table_action_encap_params *p,
+	struct rte_table_action_encap_config *cfg)
+{
+	struct rte_table_action_encap_vxlan_params *v = &p->vxlan;
+	uint16_t ethertype = (cfg->vxlan.ip_version) ?
+		ETHER_TYPE_IPv4 :
+		ETHER_TYPE_IPv6;
+
+	if (cfg->vxlan.ip_version && cfg->vxlan.vlan) {
+		struct encap_vxlan_ipv4_vlan_data *d = data;
+
+		encap_ether_hdr_set(&d->ether, &v->ether, ETHER_TYPE_VLAN);
+		encap_vlan_hdr_set(&d->vlan, &v->vlan, ethertype);
+		encap_vxlan_ipv4_hdr_set(&d->ipv4, v);
+		encap_vxlan_udp_hdr_set(&d->udp, &d->vxlan, v);
+	} else if (cfg->vxlan.ip_version) {
+		struct encap_vxlan_ipv4_data *d = data;
+
+		encap_ether_hdr_set(&d->ether, &v->ether, ethertype);
+		encap_vxlan_ipv4_hdr_set(&d->ipv4, v);
+		encap_vxlan_udp_hdr_set(&d->udp, &d->vxlan, v);
+	} else if (cfg->vxlan.vlan) {
+		struct encap_vxlan_ipv6_vlan_data *d = data;
+
+		encap_ether_hdr_set(&d->ether, &v->ether, ETHER_TYPE_VLAN);
+		encap_vlan_hdr_set(&d->vlan, &v->vlan, ethertype);
+		encap_vxlan_ipv6_hdr_set(&d->ipv6, v);
+		encap_vxlan_udp_hdr_set(&d->udp, &d->vxlan, v);
+	} else {
+		struct encap_vxlan_ipv6_data *d = data;
+
+		encap_ether_hdr_set(&d->ether, &v->ether, ethertype);
+		encap_vxlan_ipv6_hdr_set(&d->ipv6, v);
+		encap_vxlan_udp_hdr_set(&d->udp, &d->vxlan, v);
+	}
+}
+
+static int
+encap_apply(struct encap_data *data,
+	struct rte_table_action_encap_params *p,
+	struct rte_table_action_encap_config *cfg,
+	struct rte_table_action_common_config *common_cfg)
+{
+	int status;
+
+	/* Check input arguments */
+	status = encap_apply_check(p, cfg);
+	if (status)
+		return status;
+
+	data->type = p->type;
+
+	switch (p->type) {
+	case RTE_TABLE_ACTION_ENCAP_ETHER:
+		encap_ether_apply(data->hdr, p, common_cfg);
+		return 0;
+
+	case RTE_TABLE_ACTION_ENCAP_VLAN:
+		encap_vlan_apply(data->hdr, p, common_cfg);
+		return 0;
+
+	case RTE_TABLE_ACTION_ENCAP_QINQ:
+		encap_qinq_apply(data->hdr, p, common_cfg);
+		return 0;
+
+	case RTE_TABLE_ACTION_ENCAP_MPLS:
+		encap_mpls_apply(data->hdr, p);
+		return 0;
+
+	case RTE_TABLE_ACTION_ENCAP_VXLAN:
+		encap_vxlan_apply(data->hdr, p, cfg);
+		return 0;
+
+	default:
+		return -EINVAL;
+	}
+}
+
+/* Push the fixed size L2 header in front of the IP header. Any L2 header the
+ * input packet had is overwritten.
+ */
+static __rte_always_inline void
+encap_l2(void *dst, const void *src, uint32_t n)
+{
+	dst = ((uint8_t *) dst) - n;
+	rte_memcpy(dst, src, n);
+}
+
+/* The header size is known at build time for each of the callers, so the
+ * copy is done with a few plain loads and stores instead of rte_memcpy().
+ */
+static __rte_always_inline void
+pkt_work_encap_l2(struct rte_mbuf *mbuf,
+	void *ip,
+	const void *hdr,
+	uint32_t hdr_size,
+	uint16_t total_length,
+	uint32_t ip_offset)
+{
+	memcpy(((uint8_t *) ip) - hdr_size, hdr, hdr_size);
+	mbuf->data_off = ip_offset - (sizeof(struct rte_mbuf) + hdr_size);
+	mbuf->pkt_len = mbuf->data_len = total_length + hdr_size;
+}
+
+static __rte_always_inline uint16_t
+ipv4_cksum_add(uint16_t cksum, uint16_t value)
+{
+	uint32_t c = (uint16_t) ~cksum;
+
+	c += value;
+	c = (c & 0xFFFF) + (c >> 16);
+	c = (c & 0xFFFF) + (c >> 16);
+
+	return (uint16_t) ~c;
+}
+
+/* Push the VXLAN outer headers in front of the current packet data, i.e. the
+ * full input frame becomes the VXLAN payload. Returns non-zero when there is
+ * not enough headroom in the packet buffer.
+ */
+static __rte_always_inline uint64_t
+pkt_work_encap_vxlan(struct rte_mbuf *mbuf,
+	const void *hdr,
+	struct rte_table_action_encap_config *cfg)
+{
+	uint32_t inner_length = mbuf->pkt_len;
+	uint16_t udp_length = (uint16_t)(inner_length +
+		sizeof(struct udp_hdr) + sizeof(struct vxlan_hdr));
+	struct udp_hdr *udp;
+
+	if (cfg->vxlan.ip_version) {
+		struct ipv4_hdr *ipv4;
+		uint16_t ipv4_length = udp_length + sizeof(struct ipv4_hdr);
+
+		if (cfg->vxlan.vlan) {
+			struct encap_vxlan_ipv4_vlan_data *d =
+				(struct encap_vxlan_ipv4_vlan_data *)
+				rte_pktmbuf_prepend(mbuf, sizeof(*d));
+
+			if (unlikely(d == NULL))
+				return 1;
+
+			rte_memcpy(d, hdr, sizeof(*d));
+			ipv4 = &d->ipv4;
+			udp = &d->udp;
+		} else {
+			struct encap_vxlan_ipv4_data *d =
+				(struct encap_vxlan_ipv4_data *)
+				rte_pktmbuf_prepend(mbuf, sizeof(*d));
+
+			if (unlikely(d == NULL))
+				return 1;
+
+			rte_memcpy(d, hdr, sizeof(*d));
+			ipv4 = &d->ipv4;
+			udp = &d->udp;
+		}
+
+		ipv4->total_length = rte_htons(ipv4_length);
+		ipv4->hdr_checksum = ipv4_cksum_add(ipv4->hdr_checksum,
+			ipv4->total_length);
+	} else {
+		struct ipv6_hdr *ipv6;
+
+		if (cfg->vxlan.vlan) {
+			struct encap_vxlan_ipv6_vlan_data *d =
+				(struct encap_vxlan_ipv6_vlan_data *)
+				rte_pktmbuf_prepend(mbuf, sizeof(*d));
+
+			if (unlikely(d == NULL))
+				return 1;
+
+			rte_memcpy(d, hdr, sizeof(*d));
+			ipv6 = &d->ipv6;
+			udp = &d->udp;
+		} else {
+			struct encap_vxlan_ipv6_data *d =
+				(struct encap_vxlan_ipv6_data *)
+				rte_pktmbuf_prepend(mbuf, sizeof(*d));
+
+			if (unlikely(d == NULL))
+				return 1;
+
+			rte_memcpy(d, hdr, sizeof(*d));
+			ipv6 = &d->ipv6;
+			udp = &d->udp;
+		}
+
+		ipv6->payload_len = rte_htons(udp_length);
+	}
+
+	udp->dgram_len = rte_htons(udp_length);
+
+	return 0;
+}
+
+static __rte_always_inline uint64_t
+pkt_work_encap(struct rte_mbuf *mbuf,
+	struct encap_data *data,
+	struct rte_table_action_encap_config *cfg,
+	void *ip,
+	uint16_t total_length,
+	uint32_t ip_offset)
+{
+	switch (data->type) {
+	case RTE_TABLE_ACTION_ENCAP_ETHER:
+		pkt_work_encap_l2(mbuf, ip, data->hdr,
+			sizeof(struct encap_ether_data),
+			total_length, ip_offset);
+		return 0;
+
+	case RTE_TABLE_ACTION_ENCAP_VLAN:
+		pkt_work_encap_l2(mbuf, ip, data->hdr,
+			sizeof(struct encap_vlan_data),
+			total_length, ip_offset);
+		return 0;
+
+	case RTE_TABLE_ACTION_ENCAP_QINQ:
+		pkt_work_encap_l2(mbuf, ip, data->hdr,
+			sizeof(struct encap_qinq_data),
+			total_length, ip_offset);
+		return 0;
+
+	case RTE_TABLE_ACTION_ENCAP_MPLS:
+	{
+		struct encap_mpls_data *mpls =
+			(struct encap_mpls_data *) data->hdr;
+		uint32_t mpls_size = mpls->mpls_count * sizeof(uint32_t);
+
+		/* MPLS label stack first, then the Ethernet header */
+		encap_l2(ip, mpls->mpls, mpls_size);
+		encap_l2(((uint8_t *) ip) - mpls_size, &mpls->ether,
+			sizeof(struct ether_hdr));
+		mbuf->data_off = ip_offset - (sizeof(struct rte_mbuf) +
+			sizeof(struct ether_hdr) + mpls_size);
+		mbuf->pkt_len = mbuf->data_len = total_length +
+			sizeof(struct ether_hdr) + mpls_size;
+		return 0;
+	}
+
+	case RTE_TABLE_ACTION_ENCAP_VXLAN:
+		return pkt_work_encap_vxlan(mbuf, data->hdr, cfg);
+
+	default:
+		return 0;
+	}
+}
+
+/**
+ * RTE_TABLE_ACTION_NAT
+ */
+static int
+nat_cfg_check(struct rte_table_action_nat_config *nat)
+{
+	if ((nat->proto != IPPROTO_TCP) &&
+		(nat->proto != IPPROTO_UDP))
+		return -ENOTSUP;
+
+	return 0;
+}
+
+struct nat_ipv4_data {
+	uint32_t addr;
+	uint16_t port;
+} __attribute__((__packed__));
+
+struct nat_ipv6_data {
+	uint8_t addr[16];
+	uint16_t port;
+} __attribute__((__packed__));
+
+static size_t
+nat_data_size(struct rte_table_action_nat_config *nat __rte_unused,
+	struct rte_table_action_common_config *common)
+{
+	int ip_version = common->ip_version;
+
+	return (ip_version) ?
+		sizeof(struct nat_ipv4_data) :
+		sizeof(struct nat_ipv6_data);
+}
+
+static int
+nat_apply_check(struct rte_table_action_nat_params *p,
+	struct rte_table_action_common_config *cfg)
+{
+	if ((p->ip_version && (cfg->ip_version == 0)) ||
+		((p->ip_version == 0) && cfg->ip_version))
+		return -EINVAL;
+
+	return 0;
+}
+
+static int
+nat_apply(void *data,
+	struct rte_table_action_nat_params *p,
+	struct rte_table_action_common_config *cfg)
+{
+	int status;
+
+	/* Check input arguments */
+	status = nat_apply_check(p, cfg);
+	if (status)
+		return status;
+
+	/* Apply */
+	if (p->ip_version) {
+		struct nat_ipv4_data *d = data;
+
+		d->addr = rte_htonl(p->addr.ipv4);
+		d->port = rte_htons(p->port);
+	} else {
+		struct nat_ipv6_data *d = data;
+
+		memcpy(d->addr, p->addr.ipv6, sizeof(d->addr));
+		d->port = rte_htons(p->port);
+	}
+
+	return 0;
+}
+
+/* Incremental one's complement checksum update (RFC 1624). All the values are
+ * in network byte order; the one's complement sum does not depend on the
+ * byte order as long as it is the same for all the operands.
+ */
+static __rte_always_inline uint16_t
+nat_ipv4_checksum_update(uint16_t cksum0,
+	uint32_t ip0,
+	uint32_t ip1)
+{
+	int32_t cksum1;
+
+	cksum1 = cksum0;
+	cksum1 = ~cksum1 & 0xFFFF;
+
+	/* Subtract ip0 (one's complement logic) */
+	cksum1 -= (ip0 >> 16) + (ip0 & 0xFFFF);
+	cksum1 = (cksum1 & 0xFFFF) + (cksum1 >> 16);
+	cksum1 = (cksum1 & 0xFFFF) + (cksum1 >> 16);
+
+	/* Add ip1 (one's complement logic) */
+	cksum1 += (ip1 >> 16) + (ip1 & 0xFFFF);
+	cksum1 = (cksum1 & 0xFFFF) + (cksum1 >> 16);
+	cksum1 = (cksum1 & 0xFFFF) + (cksum1 >> 16);
+
+	return (uint16_t)(~cksum1);
+}
+
+static __rte_always_inline uint16_t
+nat_ipv4_tcp_udp_checksum_update(uint16_t cksum0,
+	uint32_t ip0,
+	uint32_t ip1,
+	uint16_t port0,
+	uint16_t port1)
+{
+	int32_t cksum1;
+
+	cksum1 = cksum0;
+	cksum1 = ~cksum1 & 0xFFFF;
+
+	/* Subtract ip0 and port 0 (one's complement logic) */
+	cksum1 -= (ip0 >> 16) + (ip0 & 0xFFFF) + port0;
+	cksum1 = (cksum1 & 0xFFFF) + (cksum1 >> 16);
+	cksum1 = (cksum1 & 0xFFFF) + (cksum1 >> 16);
+
+	/* Add ip1 and port1 (one's complement logic) */
+	cksum1 += (ip1 >> 16) + (ip1 & 0xFFFF) + port1;
+	cksum1 = (cksum1 & 0xFFFF) + (cksum1 >> 16);
+	cksum1 = (cksum1 & 0xFFFF) + (cksum1 >> 16);
+
+	return (uint16_t)(~cksum1);
+}
+
+static __rte_always_inline uint16_t
+nat_ipv6_tcp_udp_checksum_update(uint16_t cksum0,
+	const uint8_t *ip0,
+	const uint8_t *ip1,
+	uint16_t port0,
+	uint16_t port1)
+{
+	const unaligned_uint16_t *a0 = (const unaligned_uint16_t *) ip0;
+	const unaligned_uint16_t *a1 = (const unaligned_uint16_t *) ip1;
+	int32_t cksum1;
+	uint32_t i;
+
+	cksum1 = cksum0;
+	cksum1 = ~cksum1 & 0xFFFF;
+
+	/* Subtract ip0 and port 0 (one's complement logic) */
+	for (i = 0; i < 8; i++)
+		cksum1 -= a0[i];
+	cksum1 -= port0;
+	cksum1 = (cksum1 & 0xFFFF) + (cksum1 >> 16);
+	cksum1 = (cksum1 & 0xFFFF) + (cksum1 >> 16);
+
+	/* Add ip1 and port1 (one's complement logic) */
+	for (i = 0; i < 8; i++)
+		cksum1 += a1[i];
+	cksum1 += port1;
+	cksum1 = (cksum1 & 0xFFFF) + (cksum1 >> 16);
+	cksum1 = (cksum1 & 0xFFFF) + (cksum1 >> 16);
+
+	return (uint16_t)(~cksum1);
+}
+
+/* A zero UDP checksum means no checksum for IPv4, so it is left untouched,
+ * while a computed checksum of zero is transmitted as all ones.
+ */
+static __rte_always_inline void
+nat_udp_checksum_set(struct udp_hdr *udp, uint16_t cksum)
+{
+	udp->dgram_cksum = (cksum == 0) ? 0xFFFF : cksum;
+}
+
+static __rte_always_inline void
+pkt_ipv4_work_nat(struct ipv4_hdr *ip,
+	struct nat_ipv4_data *data,
+	struct rte_table_action_nat_config *cfg)
+{
+	if (cfg->source_nat) {
+		if (cfg->proto == IPPROTO_TCP) {
+			struct tcp_hdr *tcp = (struct tcp_hdr *) &ip[1];
+			uint16_t ip_cksum, tcp_cksum;
+
+			ip_cksum = nat_ipv4_checksum_update(ip->hdr_checksum,
+				ip->src_addr,
+				data->addr);
+
+			tcp_cksum = nat_ipv4_tcp_udp_checksum_update(tcp->cksum,
+				ip->src_addr,
+				data->addr,
+				tcp->src_port,
+				data->port);
+
+			ip->src_addr = data->addr;
+			ip->hdr_checksum = ip_cksum;
+			tcp->src_port = data->port;
+			tcp->cksum = tcp_cksum;
+		} else {
+			struct udp_hdr *udp = (struct udp_hdr *) &ip[1];
+			uint16_t ip_cksum, udp_cksum;
+
+			ip_cksum = nat_ipv4_checksum_update(ip->hdr_checksum,
+				ip->src_addr,
+				data->addr);
+
+			if (udp->dgram_cksum) {
+				udp_cksum = nat_ipv4_tcp_udp_checksum_update(
+					udp->dgram_cksum,
+					ip->src_addr,
+					data->addr,
+					udp->src_port,
+					data->port);
+				nat_udp_checksum_set(udp, udp_cksum);
+			}
+
+			ip->src_addr = data->addr;
+			ip->hdr_checksum = ip_cksum;
+			udp->src_port = data->port;
+		}
+	} else {
+		if (cfg->proto == IPPROTO_TCP) {
+			struct tcp_hdr *tcp = (struct tcp_hdr *) &ip[1];
+			uint16_t ip_cksum, tcp_cksum;
+
+			ip_cksum = nat_ipv4_checksum_update(ip->hdr_checksum,
+				ip->dst_addr,
+				data->addr);
+
+			tcp_cksum = nat_ipv4_tcp_udp_checksum_update(tcp->cksum,
+				ip->dst_addr,
+				data->addr,
+				tcp->dst_port,
+				data->port);
+
+			ip->dst_addr = data->addr;
+			ip->hdr_checksum = ip_cksum;
+			tcp->dst_port = data->port;
+			tcp->cksum = tcp_cksum;
+		} else {
+			struct udp_hdr *udp = (struct udp_hdr *) &ip[1];
+			uint16_t ip_cksum, udp_cksum;
+
+			ip_cksum = nat_ipv4_checksum_update(ip->hdr_checksum,
+				ip->dst_addr,
+				data->addr);
+
+			if (udp->dgram_cksum) {
+				udp_cksum = nat_ipv4_tcp_udp_checksum_update(
+					udp->dgram_cksum,
+					ip->dst_addr,
+					data->addr,
+					udp->dst_port,
+					data->port);
+				nat_udp_checksum_set(udp, udp_cksum);
+			}
+
+			ip->dst_addr = data->addr;
+			ip->hdr_checksum = ip_cksum;
+			udp->dst_port = data->port;
+		}
+	}
+}
+
+static __rte_always_inline void
+pkt_ipv6_work_nat(struct ipv6_hdr *ip,
+	struct nat_ipv6_data *data,
+	struct rte_table_action_nat_config *cfg)
+{
+	uint8_t *addr = (cfg->source_nat) ? ip->src_addr : ip->dst_addr;
+
+	if (cfg->proto == IPPROTO_TCP) {
+		struct tcp_hdr *tcp = (struct tcp_hdr *) &ip[1];
+
+		if (cfg->source_nat) {
+			tcp->cksum = nat_ipv6_tcp_udp_checksum_update(
+				tcp->cksum,
+				addr,
+				data->addr,
+				tcp->src_port,
+				data->port);
+			tcp->src_port = data->port;
+		} else {
+			tcp->cksum = nat_ipv6_tcp_udp_checksum_update(
+				tcp->cksum,
+				addr,
+				data->addr,
+				tcp->dst_port,
+				data->port);
+			tcp->dst_port = data->port;
+		}
+	} else {
+		struct udp_hdr *udp = (struct udp_hdr *) &ip[1];
+		uint16_t udp_cksum;
+
+		if (cfg->source_nat) {
+			udp_cksum = nat_ipv6_tcp_udp_checksum_update(
+				udp->dgram_cksum,
+				addr,
+				data->addr,
+				udp->src_port,
+				data->port);
+			udp->src_port = data->port;
+		} else {
+			udp_cksum = nat_ipv6_tcp_udp_checksum_update(
+				udp->dgram_cksum,
+				addr,
+				data->addr,
+				udp->dst_port,
+				data->port);
+			udp->dst_port = data->port;
+		}
+
+		nat_udp_checksum_set(udp, udp_cksum);
+	}
+
+	rte_memcpy(addr, data->addr, 16);
+}
+
+/**
+ * RTE_TABLE_ACTION_TTL
+ */
+struct ttl_data {
+	uint64_t n_packets;
+	uint64_t decrement;
+};
+
+static int
+ttl_apply(void *data,
+	struct rte_table_action_ttl_params *p)
+{
+	struct ttl_data *d = data;
+
+	d->decrement = (p->decrement) ? 1 : 0;
+	d->n_packets = 0;
+
+	return 0;
+}
+
+static __rte_always_inline uint64_t
+pkt_ipv4_work_ttl(struct ipv4_hdr *ip,
+	struct ttl_data *data,
+	struct rte_table_action_ttl_config *cfg)
+{
+	uint32_t checksum;
+	uint16_t ttl, ttl_zero;
+	uint16_t decrement = (uint16_t) data->decrement;
+
+	/* The TTL is the high byte of the 16-bit (TTL, protocol) word, so
+	 * decrementing it by one adds 0x0100 to the header checksum.
+	 */
+	checksum = rte_ntohs(ip->hdr_checksum) + (decrement << 8);
+	checksum = (checksum & 0xFFFF) + (checksum >> 16);
+
+	ttl = ip->time_to_live - decrement;
+
+	ip->hdr_checksum = rte_htons((uint16_t) checksum);
+	ip->time_to_live = (uint8_t) ttl;
+
+	ttl_zero = (ttl & 0xFF) == 0;
+	data->n_packets += ttl_zero;
+
+	return ttl_zero & (cfg->drop != 0);
+}
+
+static __rte_always_inline uint64_t
+pkt_ipv6_work_ttl(struct ipv6_hdr *ip,
+	struct ttl_data *data,
+	struct rte_table_action_ttl_config *cfg)
+{
+	uint16_t ttl, ttl_zero;
+	uint16_t decrement = (uint16_t) data->decrement;
+
+	ttl = ip->hop_limits - decrement;
+
+	ip->hop_limits = (uint8_t) ttl;
+
+	ttl_zero = (ttl & 0xFF) == 0;
+	data->n_packets += ttl_zero;
+
+	return ttl_zero & (cfg->drop != 0);
+}
+
+/**
+ * RTE_TABLE_ACTION_STATS
+ */
+struct stats_data {
+	uint64_t n_packets;
+	uint64_t n_bytes;
+};
+
+static int
+stats_apply(struct stats_data *data,
+	struct rte_table_action_stats_params *p)
+{
+	data->n_packets = p->n_packets;
+	data->n_bytes = p->n_bytes;
+
+	return 0;
+}
+
+static __rte_always_inline void
+pkt_work_stats(struct stats_data *data,
+	uint16_t total_length)
+{
+	data->n_packets++;
+	data->n_bytes += total_length;
+}
+
+/**
+ * RTE_TABLE_ACTION_TIME
+ */
+struct time_data {
+	uint64_t time;
+};
+
+static int
+time_apply(struct time_data *data,
+	struct rte_table_action_time_params *p)
+{
+	data->time = p->time;
+	return 0;
+}
+
+static __rte_always_inline void
+pkt_work_time(struct time_data *data,
+	uint64_t time)
+{
+	data->time = time;
+}
+
+/**
+ * Action profile
+ */
+static int
+action_valid(enum rte_table_action_type action)
+{
+	switch (action) {
+	case RTE_TABLE_ACTION_FWD:
+	case RTE_TABLE_ACTION_MTR:
+	case RTE_TABLE_ACTION_ENCAP:
+	case RTE_TABLE_ACTION_NAT:
+	case RTE_TABLE_ACTION_TTL:
+	case RTE_TABLE_ACTION_STATS:
+	case RTE_TABLE_ACTION_TIME:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+#define RTE_TABLE_ACTION_MAX                      64
+
+struct ap_config {
+	uint64_t action_mask;
+	struct rte_table_action_common_config common;
+	struct rte_table_action_mtr_config mtr;
+	struct rte_table_action_encap_config encap;
+	struct rte_table_action_nat_config nat;
+	struct rte_table_action_ttl_config ttl;
+};
+
+static size_t
+action_cfg_size(enum rte_table_action_type action)
+{
+	switch (action) {
+	case RTE_TABLE_ACTION_MTR:
+		return sizeof(struct rte_table_action_mtr_config);
+	case RTE_TABLE_ACTION_ENCAP:
+		return sizeof(struct rte_table_action_encap_config);
+	case RTE_TABLE_ACTION_NAT:
+		return sizeof(struct rte_table_action_nat_config);
+	case RTE_TABLE_ACTION_TTL:
+		return sizeof(struct rte_table_action_ttl_config);
+	default:
+		return 0;
+	}
+}
+
+static void*
+action_cfg_get(struct ap_config *ap_config,
+	enum rte_table_action_type type)
+{
+	switch (type) {
+	case RTE_TABLE_ACTION_MTR:
+		return &ap_config->mtr;
+
+	case RTE_TABLE_ACTION_ENCAP:
+		return &ap_config->encap;
+
+	case RTE_TABLE_ACTION_NAT:
+		return &ap_config->nat;
+
+	case RTE_TABLE_ACTION_TTL:
+		return &ap_config->ttl;
+
+	default:
+		return NULL;
+	}
+}
+
+static void
+action_cfg_set(struct ap_config *ap_config,
+	enum rte_table_action_type type,
+	void *action_cfg)
+{
+	void *dst = action_cfg_get(ap_config, type);
+
+	if (dst)
+		memcpy(dst, action_cfg, action_cfg_size(type));
+
+	ap_config->action_mask |= 1LLU << type;
+}
+
+struct ap_data {
+	size_t offset[RTE_TABLE_ACTION_MAX];
+	size_t total_size;
+};
+
+static size_t
+action_data_size(enum rte_table_action_type action,
+	struct ap_config *ap_config)
+{
+	switch (action) {
+	case RTE_TABLE_ACTION_FWD:
+		return 0;
+
+	case RTE_TABLE_ACTION_MTR:
+		return mtr_data_size(&ap_config->mtr);
+
+	case RTE_TABLE_ACTION_ENCAP:
+		return encap_data_size(&ap_config->encap);
+
+	case RTE_TABLE_ACTION_NAT:
+		return nat_data_size(&ap_config->nat,
+			&ap_config->common);
+
+	case RTE_TABLE_ACTION_TTL:
+		return sizeof(struct ttl_data);
+
+	case RTE_TABLE_ACTION_STATS:
+		return sizeof(struct stats_data);
+
+	case RTE_TABLE_ACTION_TIME:
+		return sizeof(struct time_data);
+
+	default:
+		return 0;
+	}
+}
+
+/* The action data is packed in the order of the action type, with each action
+ * starting at an 8-byte aligned offset within the table entry action data.
+ */
+static void
+action_data_offset_set(struct ap_data *ap_data,
+	struct ap_config *ap_config)
+{
+	uint64_t action_mask = ap_config->action_mask;
+	size_t offset;
+	uint32_t action;
+
+	memset(ap_data->offset, 0, sizeof(ap_data->offset));
+
+	offset = 0;
+	for (action = 0; action < RTE_TABLE_ACTION_MAX; action++)
+		if (action_mask & (1LLU << action)) {
+			ap_data->offset[action] = offset;
+			offset += RTE_ALIGN_CEIL(action_data_size(
+				(enum rte_table_action_type)action,
+				ap_config), sizeof(uint64_t));
+		}
+
+	ap_data->total_size = offset;
+}
+
+struct rte_table_action_profile {
+	struct ap_config cfg;
+	struct ap_data data;
+	int frozen;
+};
+
+struct rte_table_action_profile *
+rte_table_action_profile_create(struct rte_table_action_common_config *common)
+{
+	struct rte_table_action_profile *ap;
+
+	/* Check input arguments */
+	if (common == NULL)
+		return NULL;
+
+	/* Memory allocation */
+	ap = calloc(1, sizeof(struct rte_table_action_profile));
+	if (ap == NULL)
+		return NULL;
+
+	/* Initialization */
+	memcpy(&ap->cfg.common, common, sizeof(*common));
+
+	return ap;
+}
+
+
+int
+rte_table_action_profile_action_register(
+	struct rte_table_action_profile *profile,
+	enum rte_table_action_type type,
+	void *action_config)
+{
+	int status;
+
+	/* Check input arguments */
+	if ((profile == NULL) ||
+		profile->frozen ||
+		(action_valid(type) == 0) ||
+		(profile->cfg.action_mask & (1LLU << type)) ||
+		((action_cfg_size(type) == 0) && action_config) ||
+		(action_cfg_size(type) && (action_config == NULL)))
+		return -EINVAL;
+
+	switch (type) {
+	case RTE_TABLE_ACTION_MTR:
+		status = mtr_cfg_check(action_config);
+		break;
+
+	case RTE_TABLE_ACTION_ENCAP:
+		status = encap_cfg_check(action_config);
+		break;
+
+	case RTE_TABLE_ACTION_NAT:
+		status = nat_cfg_check(action_config);
+		break;
+
+	default:
+		status = 0;
+		break;
+	}
+
+	if (status)
+		return status;
+
+	/* Action enable */
+	action_cfg_set(&profile->cfg, type, action_config);
+
+	return 0;
+}
+
+int
+rte_table_action_profile_freeze(struct rte_table_action_profile *profile)
+{
+	if (profile->frozen)
+		return -EBUSY;
+
+	profile->cfg.action_mask |= 1LLU << RTE_TABLE_ACTION_FWD;
+	action_data_offset_set(&profile->data, &profile->cfg);
+	profile->frozen = 1;
+
+	return 0;
+}
+
+int
+rte_table_action_profile_free(struct rte_table_action_profile *profile)
+{
+	if (profile == NULL)
+		return 0;
+
+	free(profile);
+	return 0;
+}
+
+/**
+ * Action
+ */
+struct rte_table_action {
+	struct ap_config cfg;
+	struct ap_data data;
+	struct dscp_table_data dscp_table;
+	struct meter_profile_data mp[METER_PROFILES_MAX];
+};
+
+struct rte_table_action *
+rte_table_action_create(struct rte_table_action_profile *profile,
+	uint32_t socket_id)
+{
+	struct rte_table_action *action;
+
+	/* Check input arguments */
+	if ((profile == NULL) ||
+		(profile->frozen == 0))
+		return NULL;
+
+	/* Memory allocation */
+	action = rte_zmalloc_socket(NULL,
+		sizeof(struct rte_table_action),
+		RTE_CACHE_LINE_SIZE,
+		socket_id);
+	if (action == NULL)
+		return NULL;
+
+	/* Initialization */
+	memcpy(&action->cfg, &profile->cfg, sizeof(profile->cfg));
+	memcpy(&action->data, &profile->data, sizeof(profile->data));
+
+	return action;
+}
+
+static __rte_always_inline void *
+action_data_get(void *data,
+	struct rte_table_action *action,
+	enum rte_table_action_type type)
+{
+	size_t offset = action->data.offset[type];
+	struct rte_pipeline_table_entry *entry = data;
+	uint8_t *data_bytes = entry->action_data;
+
+	return &data_bytes[offset];
+}
+
+int
+rte_table_action_apply(struct rte_table_action *action,
+	void *data,
+	enum rte_table_action_type type,
+	void *action_params)
+{
+	void *action_data;
+
+	/* Check input arguments */
+	if ((action == NULL) ||
+		(data == NULL) ||
+		(action_valid(type) == 0) ||
+		((action->cfg.action_mask & (1LLU << type)) == 0) ||
+		(action_params == NULL))
+		return -EINVAL;
+
+	/* Data update */
+	action_data = action_data_get(data, action, type);
+
+	switch (type) {
+	case RTE_TABLE_ACTION_FWD:
+		return fwd_apply(data,
+			action_params);
+
+	case RTE_TABLE_ACTION_MTR:
+		return mtr_apply(action_data,
+			action_params,
+			&action->cfg.mtr,
+			action->mp,
+			RTE_DIM(action->mp));
+
+	case RTE_TABLE_ACTION_ENCAP:
+		return encap_apply(action_data,
+			action_params,
+			&action->cfg.encap,
+			&action->cfg.common);
+
+	case RTE_TABLE_ACTION_NAT:
+		return nat_apply(action_data,
+			action_params,
+			&action->cfg.common);
+
+	case RTE_TABLE_ACTION_TTL:
+		return ttl_apply(action_data,
+			action_params);
+
+	case RTE_TABLE_ACTION_STATS:
+		return stats_apply(action_data,
+			action_params);
+
+	case RTE_TABLE_ACTION_TIME:
+		return time_apply(action_data,
+			action_params);
+
+	default:
+		return -EINVAL;
+	}
+}
+
+int
+rte_table_action_dscp_table_update(struct rte_table_action *action,
+	uint64_t dscp_mask,
+	struct rte_table_action_dscp_table *table)
+{
+	uint32_t i;
+
+	/* Check input arguments */
+	if ((action == NULL) ||
+		((action->cfg.action_mask &
+		(1LLU << RTE_TABLE_ACTION_MTR)) == 0) ||
+		(dscp_mask == 0) ||
+		(table == NULL))
+		return -EINVAL;
+
+	for (i = 0; i < RTE_DIM(table->entry); i++) {
+		if ((dscp_mask & (1LLU << i)) == 0)
+			continue;
+
+		if ((table->entry[i].tc_id >= action->cfg.mtr.n_tc) ||
+			((uint32_t)table->entry[i].color >=
+			e_RTE_METER_COLORS))
+			return -EINVAL;
+	}
+
+	for (i = 0; i < RTE_DIM(table->entry); i++) {
+		struct dscp_table_entry_data *data =
+			&action->dscp_table.entry[i];
+		struct rte_table_action_dscp_table_entry *entry =
+			&table->entry[i];
+
+		if ((dscp_mask & (1LLU << i)) == 0)
+			continue;
+
+		data->color = entry->color;
+		data->tc = entry->tc_id;
+	}
+
+	return 0;
+}
+
+int
+rte_table_action_meter_profile_add(struct rte_table_action *action,
+	uint32_t meter_profile_id,
+	struct rte_meter_trtcm_params *profile)
+{
+	struct meter_profile_data *mp_data;
+	int status;
+
+	/* Check input arguments */
+	if ((action == NULL) ||
+		((action->cfg.action_mask &
+		(1LLU << RTE_TABLE_ACTION_MTR)) == 0) ||
+		(profile == NULL))
+		return -EINVAL;
+
+	mp_data = meter_profile_data_find(action->mp,
+		RTE_DIM(action->mp),
+		meter_profile_id);
+	if (mp_data)
+		return -EEXIST;
+
+	mp_data = meter_profile_data_find_unused(action->mp,
+		RTE_DIM(action->mp));
+	if (mp_data == NULL)
+		return -ENOSPC;
+
+	/* Install new profile */
+	status = rte_meter_trtcm_profile_config(&mp_data->profile,
+		profile);
+	if (status)
+		return -EINVAL;
+
+	mp_data->profile_id = meter_profile_id;
+	mp_data->valid = 1;
+
+	return 0;
+}
+
+int
+rte_table_action_meter_profile_delete(struct rte_table_action *action,
+	uint32_t meter_profile_id)
+{
+	struct meter_profile_data *mp_data;
+
+	/* Check input arguments */
+	if ((action == NULL) ||
+		((action->cfg.action_mask &
+		(1LLU << RTE_TABLE_ACTION_MTR)) == 0))
+		return -EINVAL;
+
+	mp_data = meter_profile_data_find(action->mp,
+		RTE_DIM(action->mp),
+		meter_profile_id);
+	if (mp_data == NULL)
+		return -EINVAL;
+
+	/* Uninstall profile */
+	mp_data->valid = 0;
+
+	return 0;
+}
+
+int
+rte_table_action_meter_read(struct rte_table_action *action,
+	void *data,
+	uint32_t tc_mask,
+	struct rte_table_action_mtr_counters *stats,
+	int clear)
+{
+	struct mtr_trtcm_data *mtr_data;
+	uint32_t i;
+
+	/* Check input arguments */
+	if ((action == NULL) ||
+		((action->cfg.action_mask &
+		(1LLU << RTE_TABLE_ACTION_MTR)) == 0) ||
+		(data == NULL) ||
+		(tc_mask & ~RTE_LEN2MASK(action->cfg.mtr.n_tc, uint32_t)))
+		return -EINVAL;
+
+	mtr_data = action_data_get(data, action, RTE_TABLE_ACTION_MTR);
+
+	/* Read */
+	if (stats) {
+		for (i = 0; i < RTE_TABLE_ACTION_TC_MAX; i++) {
+			struct rte_table_action_mtr_counters_tc *dst =
+				&stats->stats[i];
+			struct mtr_trtcm_data *src = &mtr_data[i];
+			uint32_t j;
+
+			if ((tc_mask & (1 << i)) == 0)
+				continue;
+
+			for (j = 0; j < e_RTE_METER_COLORS; j++)
+				dst->n_packets[j] = src->n_packets[j];
+
+			dst->n_packets_drop =
+				src->n_packets[RTE_TABLE_ACTION_POLICER_DROP];
+		}
+
+		stats->tc_mask = tc_mask;
+	}
+
+	/* Clear */
+	if (clear)
+		for (i = 0; i < RTE_TABLE_ACTION_TC_MAX; i++) {
+			struct mtr_trtcm_data *src = &mtr_data[i];
+
+			if ((tc_mask & (1 << i)) == 0)
+				continue;
+
+			memset(src->n_packets, 0, sizeof(src->n_packets));
+		}
+
+	return 0;
+}
+
+int
+rte_table_action_ttl_read(struct rte_table_action *action,
+	void *data,
+	struct rte_table_action_ttl_counters *stats,
+	int clear)
+{
+	struct ttl_data *ttl_data;
+
+	/* Check input arguments */
+	if ((action == NULL) ||
+		((action->cfg.action_mask &
+		(1LLU << RTE_TABLE_ACTION_TTL)) == 0) ||
+		(data == NULL))
+		return -EINVAL;
+
+	ttl_data = action_data_get(data, action, RTE_TABLE_ACTION_TTL);
+
+	/* Read */
+	if (stats)
+		stats->n_packets = ttl_data->n_packets;
+
+	/* Clear */
+	if (clear)
+		ttl_data->n_packets = 0;
+
+	return 0;
+}
+
+int
+rte_table_action_stats_read(struct rte_table_action *action,
+	void *data,
+	struct rte_table_action_stats_counters *stats,
+	int clear)
+{
+	struct stats_data *stats_data;
+
+	/* Check input arguments */
+	if ((action == NULL) ||
+		((action->cfg.action_mask &
+		(1LLU << RTE_TABLE_ACTION_STATS)) == 0) ||
+		(data == NULL))
+		return -EINVAL;
+
+	stats_data = action_data_get(data, action,
+		RTE_TABLE_ACTION_STATS);
+
+	/* Read */
+	if (stats) {
+		stats->n_packets = stats_data->n_packets;
+		stats->n_bytes = stats_data->n_bytes;
+	}
+
+	/* Clear */
+	if (clear) {
+		stats_data->n_packets = 0;
+		stats_data->n_bytes = 0;
+	}
+
+	return 0;
+}
+
+int
+rte_table_action_time_read(struct rte_table_action *action,
+	void *data,
+	uint64_t *timestamp)
+{
+	struct time_data *time_data;
+
+	/* Check input arguments */
+	if ((action == NULL) ||
+		((action->cfg.action_mask &
+		(1LLU << RTE_TABLE_ACTION_TIME)) == 0) ||
+		(data == NULL) ||
+		(timestamp == NULL))
+		return -EINVAL;
+
+	time_data = action_data_get(data, action, RTE_TABLE_ACTION_TIME);
+
+	/* Read */
+	*timestamp = time_data->time;
+
+	return 0;
+}
+
+/* Single pass over the packet: every action enabled by the profile is run on
+ * the packet before moving to the next one, so the IP header and the table
+ * entry are only brought into the cache once. The action mask tests are
+ * invariant for a given table, so the branches are perfectly predicted.
+ */
+static __rte_always_inline uint64_t
+pkt_work(struct rte_mbuf *mbuf,
+	struct rte_pipeline_table_entry *table_entry,
+	uint64_t time,
+	struct rte_table_action *action,
+	struct ap_config *cfg,
+	uint64_t action_mask,
+	int ip_version)
+{
+	uint64_t drop_mask = 0;
+
+	uint32_t ip_offset = action->cfg.common.ip_offset;
+	void *ip = RTE_MBUF_METADATA_UINT8_PTR(mbuf, ip_offset);
+
+	uint32_t dscp;
+	uint16_t total_length;
+
+	if (ip_version) {
+		struct ipv4_hdr *hdr = ip;
+
+		dscp = hdr->type_of_service >> 2;
+		total_length = rte_ntohs(hdr->total_length);
+	} else {
+		struct ipv6_hdr *hdr = ip;
+
+		dscp = (rte_ntohl(hdr->vtc_flow) >> 22) & 0x3F;
+		total_length =
+			rte_ntohs(hdr->payload_len) + sizeof(struct ipv6_hdr);
+	}
+
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_MTR)) {
+		void *data =
+			action_data_get(table_entry, action, RTE_TABLE_ACTION_MTR);
+
+		drop_mask |= pkt_work_mtr(data,
+			&action->dscp_table,
+			action->mp,
+			time,
+			dscp,
+			total_length);
+	}
+
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_TTL)) {
+		void *data =
+			action_data_get(table_entry, action, RTE_TABLE_ACTION_TTL);
+
+		if (ip_version)
+			drop_mask |= pkt_ipv4_work_ttl(ip, data, &cfg->ttl);
+		else
+			drop_mask |= pkt_ipv6_work_ttl(ip, data, &cfg->ttl);
+	}
+
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_NAT)) {
+		void *data =
+			action_data_get(table_entry, action, RTE_TABLE_ACTION_NAT);
+
+		if (ip_version)
+			pkt_ipv4_work_nat(ip, data, &cfg->nat);
+		else
+			pkt_ipv6_work_nat(ip, data, &cfg->nat);
+	}
+
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_ENCAP)) {
+		void *data = action_data_get(table_entry, action,
+			RTE_TABLE_ACTION_ENCAP);
+
+		drop_mask |= pkt_work_encap(mbuf,
+			data,
+			&cfg->encap,
+			ip,
+			total_length,
+			ip_offset);
+	}
+
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_STATS)) {
+		void *data = action_data_get(table_entry, action,
+			RTE_TABLE_ACTION_STATS);
+
+		pkt_work_stats(data, total_length);
+	}
+
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_TIME)) {
+		void *data =
+			action_data_get(table_entry, action, RTE_TABLE_ACTION_TIME);
+
+		pkt_work_time(data, time);
+	}
+
+	return drop_mask;
+}
+
+static __rte_always_inline void
+pkt4_prefetch(struct rte_mbuf **mbufs,
+	struct rte_pipeline_table_entry **table_entries,
+	struct rte_table_action *action)
+{
+	uint32_t ip_offset = action->cfg.common.ip_offset;
+
+	rte_prefetch0(table_entries[0]->action_data);
+	rte_prefetch0(table_entries[1]->action_data);
+	rte_prefetch0(table_entries[2]->action_data);
+	rte_prefetch0(table_entries[3]->action_data);
+
+	rte_prefetch0(RTE_MBUF_METADATA_UINT8_PTR(mbufs[0], ip_offset));
+	rte_prefetch0(RTE_MBUF_METADATA_UINT8_PTR(mbufs[1], ip_offset));
+	rte_prefetch0(RTE_MBUF_METADATA_UINT8_PTR(mbufs[2], ip_offset));
+	rte_prefetch0(RTE_MBUF_METADATA_UINT8_PTR(mbufs[3], ip_offset));
+}
+
+static __rte_always_inline uint64_t
+pkt4_work(struct rte_mbuf **mbufs,
+	struct rte_pipeline_table_entry **table_entries,
+	uint64_t time,
+	struct rte_table_action *action,
+	struct ap_config *cfg,
+	uint64_t action_mask,
+	int ip_version)
+{
+	uint64_t drop_mask0, drop_mask1, drop_mask2, drop_mask3;
+
+	drop_mask0 = pkt_work(mbufs[0], table_entries[0], time, action, cfg,
+		action_mask, ip_version);
+	drop_mask1 = pkt_work(mbufs[1], table_entries[1], time, action, cfg,
+		action_mask, ip_version);
+	drop_mask2 = pkt_work(mbufs[2], table_entries[2], time, action, cfg,
+		action_mask, ip_version);
+	drop_mask3 = pkt_work(mbufs[3], table_entries[3], time, action, cfg,
+		action_mask, ip_version);
+
+	return drop_mask0 |
+		(drop_mask1 << 1) |
+		(drop_mask2 << 2) |
+		(drop_mask3 << 3);
+}
+
+static __rte_always_inline int
+ah(struct rte_pipeline *p,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	struct rte_pipeline_table_entry **entries,
+	struct rte_table_action *action,
+	struct ap_config *cfg,
+	uint64_t action_mask,
+	int ip_version)
+{
+	uint64_t pkts_drop_mask = 0;
+	uint64_t time = 0;
+
+	if (action_mask & ((1LLU << RTE_TABLE_ACTION_MTR) |
+		(1LLU << RTE_TABLE_ACTION_TIME)))
+		time = rte_rdtsc();
+
+	if ((pkts_mask & (pkts_mask + 1)) == 0) {
+		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
+		uint32_t i;
+
+		if (n_pkts >= 4)
+			pkt4_prefetch(pkts, entries, action);
+
+		for (i = 0; i < (n_pkts & (~0x3LLU)); i += 4) {
+			uint64_t drop_mask;
+
+			/* Prefetch the next group while working on this one */
+			if (i + 8 <= n_pkts)
+				pkt4_prefetch(&pkts[i + 4], &entries[i + 4],
+					action);
+
+			drop_mask = pkt4_work(&pkts[i],
+				&entries[i],
+				time,
+				action,
+				cfg,
+				action_mask,
+				ip_version);
+
+			pkts_drop_mask |= drop_mask << i;
+		}
+
+		for ( ; i < n_pkts; i++) {
+			uint64_t drop_mask;
+
+			drop_mask = pkt_work(pkts[i],
+				entries[i],
+				time,
+				action,
+				cfg,
+				action_mask,
+				ip_version);
+
+			pkts_drop_mask |= drop_mask << i;
+		}
+	} else
+		for ( ; pkts_mask; ) {
+			uint32_t pos = __builtin_ctzll(pkts_mask);
+			uint64_t pkt_mask = 1LLU << pos;
+			uint64_t drop_mask;
+
+			drop_mask = pkt_work(pkts[pos],
+				entries[pos],
+				time,
+				action,
+				cfg,
+				action_mask,
+				ip_version);
+
+			pkts_mask &= ~pkt_mask;
+			pkts_drop_mask |= drop_mask << pos;
+		}
+
+	if (pkts_drop_mask)
+		rte_pipeline_ah_packet_drop(p, pkts_drop_mask);
+
+	return 0;
+}
+
+static int
+ah_default(struct rte_pipeline *p,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	struct rte_pipeline_table_entry **entries,
+	void *arg)
+{
+	struct rte_table_action *action = arg;
+
+	return ah(p,
+		pkts,
+		pkts_mask,
+		entries,
+		action,
+		&action->cfg,
+		action->cfg.action_mask,
+		action->cfg.common.ip_version);
+}
+
+/* Action handlers specialized for the most common action profiles, with the
+ * action set and the IP version known at build time, so that the per packet
+ * work is reduced to the enabled actions only.
+ */
+#define AH_SPECIALIZED(f_ah, action_mask, ip_version)			\
+static int								\
+f_ah(struct rte_pipeline *p,						\
+	struct rte_mbuf **pkts,						\
+	uint64_t pkts_mask,						\
+	struct rte_pipeline_table_entry **entries,			\
+	void *arg)							\
+{									\
+	struct rte_table_action *action = arg;				\
+									\
+	return ah(p,							\
+		pkts,							\
+		pkts_mask,						\
+		entries,						\
+		action,							\
+		&action->cfg,						\
+		action_mask,						\
+		ip_version);						\
+}
+
+#define AH_MASK_MTR                                                \
+	((1LLU << RTE_TABLE_ACTION_FWD) | (1LLU << RTE_TABLE_ACTION_MTR))
+
+#define AH_MASK_ENCAP                                              \
+	((1LLU << RTE_TABLE_ACTION_FWD) | (1LLU << RTE_TABLE_ACTION_ENCAP))
+
+#define AH_MASK_MTR_ENCAP                                          \
+	(AH_MASK_MTR | AH_MASK_ENCAP)
+
+AH_SPECIALIZED(ah_mtr_ipv4, AH_MASK_MTR, 1)
+AH_SPECIALIZED(ah_mtr_ipv6, AH_MASK_MTR, 0)
+AH_SPECIALIZED(ah_encap_ipv4, AH_MASK_ENCAP, 1)
+AH_SPECIALIZED(ah_encap_ipv6, AH_MASK_ENCAP, 0)
+AH_SPECIALIZED(ah_mtr_encap_ipv4, AH_MASK_MTR_ENCAP, 1)
+AH_SPECIALIZED(ah_mtr_encap_ipv6, AH_MASK_MTR_ENCAP, 0)
+
+static const struct {
+	uint64_t action_mask;
+	rte_pipeline_table_action_handler_hit f_ah[2];
+} ah_specialized[] = {
+	{AH_MASK_MTR, {ah_mtr_ipv6, ah_mtr_ipv4} },
+	{AH_MASK_ENCAP, {ah_encap_ipv6, ah_encap_ipv4} },
+	{AH_MASK_MTR_ENCAP, {ah_mtr_encap_ipv6, ah_mtr_encap_ipv4} },
+};
+
+static rte_pipeline_table_action_handler_hit
+ah_selector(struct rte_table_action *action)
+{
+	uint64_t action_mask = action->cfg.action_mask;
+	uint32_t i;
+
+	if (action_mask == (1LLU << RTE_TABLE_ACTION_FWD))
+		return NULL;
+
+	for (i = 0; i < RTE_DIM(ah_specialized); i++)
+		if (action_mask == ah_specialized[i].action_mask)
+			return ah_specialized[i].f_ah[
+				action->cfg.common.ip_version ? 1 : 0];
+
+	return ah_default;
+}
+
+int
+rte_table_action_table_params_get(struct rte_table_action *action,
+	struct rte_pipeline_table_params *params)
+{
+	rte_pipeline_table_action_handler_hit f_action_hit;
+
+	/* Check input arguments */
+	if ((action == NULL) ||
+		(params == NULL))
+		return -EINVAL;
+
+	f_action_hit = ah_selector(action);
+
+	/* Fill in params */
+	params->f_action_hit = f_action_hit;
+	params->f_action_miss = NULL;
+	params->arg_ah = (f_action_hit) ? action : NULL;
+	params->action_data_size = action->data.total_size;
+
+	return 0;
+}
+
+int
+rte_table_action_free(struct rte_table_action *action)
+{
+	if (action == NULL)
+		return 0;
+
+	rte_free(action);
+
+	return 0;
+}
@@ -175,6 +175,120 @@ unsigned int
 rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 		unsigned max_mbufs);
 
+struct rte_reorder_mp_buffer;
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Create a new multi-producer reorder buffer instance
+ *
+ * Unlike the buffer created by rte_reorder_create(), this buffer can be
+ * filled by several threads at once, for example by the workers processing
+ * the packets, which removes the need for a thread collecting the packets
+ * before reordering them. Any thread can drain it, one at a time.
+ *
+ * @param name
+ *   The name to be given to the reorder buffer instance.
+ * @param socket_id
+ *   The NUMA node on which the memory for the reorder buffer
+ *   instance is to be reserved.
+ * @param size
+ *   Max number of elements that can be stored in the reorder buffer,
+ *   must be a power of 2.
+ * @param timeout
+ *   Number of timer cycles after which a missing mbuf is skipped when
+ *   later mbufs are waiting to be drained, or 0 to wait forever.
+ * @return
+ *   The initialized reorder buffer instance, or NULL on error
+ *   On error case, rte_errno will be set appropriately:
+ *    - ENOMEM - no appropriate memory area found in which to create memzone
+ *    - EINVAL - invalid parameters
+ */
+struct rte_reorder_mp_buffer *
+rte_reorder_mp_create(const char *name, unsigned int socket_id,
+		unsigned int size, uint64_t timeout);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Reset the given multi-producer reorder buffer, freeing the mbufs it
+ * holds. It must not be called while other threads use the buffer.
+ *
+ * @param b
+ *   Reorder buffer instance which has to be reset
+ * @param seqn
+ *   Sequence number of the first mbuf to be drained after the reset.
+ */
+void
+rte_reorder_mp_reset(struct rte_reorder_mp_buffer *b, uint32_t seqn);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Free multi-producer reorder buffer instance, and the mbufs it holds.
+ *
+ * @param b
+ *   reorder buffer instance
+ */
+void
+rte_reorder_mp_free(struct rte_reorder_mp_buffer *b);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Insert given mbuf in a multi-producer reorder buffer in its correct
+ * position. This function is thread safe.
+ *
+ * The sequence number of the first mbuf expected is 0, or the one given to
+ * rte_reorder_mp_reset(). The buffer only accepts mbufs whose sequence
+ * number is within size of the next one to be drained.
+ *
+ * @param b
+ *   Reorder buffer where the mbuf has to be inserted.
+ * @param mbuf
+ *   mbuf of packet that needs to be inserted in reorder buffer.
+ * @return
+ *   0 on success
+ *   -1 on error
+ *   On error case, rte_errno will be set appropriately:
+ *    - ENOSPC - Too early mbuf, which can be inserted once the mbufs before
+ *      it have been drained.
+ *    - ERANGE - Late mbuf, whose position was already drained or skipped, or
+ *      mbuf whose sequence number is already in the buffer.
+ */
+int
+rte_reorder_mp_insert(struct rte_reorder_mp_buffer *b, struct rte_mbuf *mbuf);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Fetch reordered buffers from a multi-producer reorder buffer
+ *
+ * Returns the run of in-order mbufs at the head of the buffer. If the next
+ * mbuf has been missing for longer than the timeout of the buffer, and later
+ * mbufs have been inserted or rejected as early, the missing ones are skipped
+ * and will be rejected as late if they are inserted afterwards.
+ *
+ * If another thread is draining the buffer, no mbuf is returned.
+ *
+ * @param b
+ *   Reorder buffer instance from which packets are to be drained
+ * @param mbufs
+ *   array of mbufs where reordered packets will be inserted from reorder buffer
+ * @param max_mbufs
+ *   the number of elements in the mbufs array.
+ * @return
+ *   number of mbuf pointers written to mbufs. 0 <= N <= max_mbufs.
+ */
+unsigned int
+rte_reorder_mp_drain(struct rte_reorder_mp_buffer *b, struct rte_mbuf **mbufs,
+		unsigned int max_mbufs);
+
 #ifdef __cplusplus
 }
 #endif
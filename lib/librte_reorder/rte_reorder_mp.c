@@ -0,0 +1,298 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <rte_log.h>
+#include <rte_mbuf.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_atomic.h>
+#include <rte_cycles.h>
+#include <rte_spinlock.h>
+
+#include "rte_reorder.h"
+
+#define RTE_REORDER_NAMESIZE 32
+
+/* Macros for printing using RTE_LOG */
+#define RTE_LOGTYPE_REORDER	RTE_LOGTYPE_USER1
+
+/* States of a slot, stored in the low bits of its tag */
+#define REORDER_MP_EMPTY	0
+#define REORDER_MP_CLAIMED	1
+#define REORDER_MP_READY	2
+#define REORDER_MP_STATE_MASK	3
+
+/* tag of a slot expecting the mbuf with sequence number seqn */
+#define REORDER_MP_TAG(seqn, state) (((uint64_t)(seqn) << 32) | (state))
+
+/*
+ * A slot of the buffer. Its tag holds the sequence number of the only mbuf
+ * it accepts in the current window, so an insert claims it with a single
+ * compare and set, without reading the head of the buffer.
+ */
+struct reorder_mp_slot {
+	volatile uint64_t tag;
+	struct rte_mbuf *mbuf;
+};
+
+/* The multi-producer reorder buffer data structure itself */
+struct rte_reorder_mp_buffer {
+	char name[RTE_REORDER_NAMESIZE];
+	unsigned int size;  /**< Number of entries that can be stored */
+	unsigned int mask;  /**< [size - 1]: used for wrap-around */
+	uint64_t timeout;   /**< cycles before skipping a missing mbuf */
+
+	/* drain state, only used by the thread holding the drain lock */
+	rte_spinlock_t drain_lock __rte_cache_aligned;
+	uint32_t head;      /**< seq. number of the next mbuf to drain */
+	uint32_t gap_seqn;  /**< seq. number of the missing mbuf being timed */
+	uint64_t gap_start; /**< time it was found missing, 0 if none */
+
+	/** highest seq. number of the early mbufs waiting for room */
+	volatile uint32_t early_seqn __rte_cache_aligned;
+
+	struct reorder_mp_slot slots[] __rte_cache_aligned;
+};
+
+static void
+reorder_mp_free_mbufs(struct rte_reorder_mp_buffer *b)
+{
+	unsigned int i;
+
+	for (i = 0; i < b->size; i++)
+		if ((b->slots[i].tag & REORDER_MP_STATE_MASK) ==
+				REORDER_MP_READY)
+			rte_pktmbuf_free(b->slots[i].mbuf);
+}
+
+struct rte_reorder_mp_buffer *
+rte_reorder_mp_create(const char *name, unsigned int socket_id,
+		unsigned int size, uint64_t timeout)
+{
+	struct rte_reorder_mp_buffer *b;
+
+	/* Check user arguments. */
+	if (!rte_is_power_of_2(size) || size > (1U << 31)) {
+		RTE_LOG(ERR, REORDER, "Invalid reorder buffer size"
+				" - Not a power of 2\n");
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	if (name == NULL) {
+		RTE_LOG(ERR, REORDER, "Invalid reorder buffer name ptr:"
+					" NULL\n");
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	b = rte_zmalloc_socket("REORDER_MP_BUFFER", sizeof(*b) +
+			size * sizeof(b->slots[0]), RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (b == NULL) {
+		RTE_LOG(ERR, REORDER, "Memzone allocation failed\n");
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	snprintf(b->name, sizeof(b->name), "%s", name);
+	b->size = size;
+	b->mask = size - 1;
+	b->timeout = timeout;
+	rte_spinlock_init(&b->drain_lock);
+	rte_reorder_mp_reset(b, 0);
+
+	return b;
+}
+
+void
+rte_reorder_mp_reset(struct rte_reorder_mp_buffer *b, uint32_t seqn)
+{
+	unsigned int i;
+
+	reorder_mp_free_mbufs(b);
+
+	for (i = 0; i < b->size; i++) {
+		b->slots[(seqn + i) & b->mask].tag =
+				REORDER_MP_TAG(seqn + i, REORDER_MP_EMPTY);
+		b->slots[i].mbuf = NULL;
+	}
+	b->head = seqn;
+	b->gap_start = 0;
+	b->early_seqn = seqn;
+	rte_smp_wmb();
+}
+
+void
+rte_reorder_mp_free(struct rte_reorder_mp_buffer *b)
+{
+	/* Check user arguments. */
+	if (b == NULL)
+		return;
+
+	reorder_mp_free_mbufs(b);
+	rte_free(b);
+}
+
+int
+rte_reorder_mp_insert(struct rte_reorder_mp_buffer *b, struct rte_mbuf *mbuf)
+{
+	struct reorder_mp_slot *slot = &b->slots[mbuf->seqn & b->mask];
+	const uint64_t empty = REORDER_MP_TAG(mbuf->seqn, REORDER_MP_EMPTY);
+	uint64_t tag;
+	uint32_t expected;
+
+	do {
+		if (likely(rte_atomic64_cmpset(&slot->tag, empty,
+				REORDER_MP_TAG(mbuf->seqn,
+					REORDER_MP_CLAIMED)))) {
+			slot->mbuf = mbuf;
+			rte_smp_wmb();
+			slot->tag = REORDER_MP_TAG(mbuf->seqn,
+					REORDER_MP_READY);
+			return 0;
+		}
+		/* retry if the slot was drained since the compare */
+		tag = slot->tag;
+	} while (tag == empty);
+
+	/*
+	 * The slot holds another window: the mbuf is early if that window is
+	 * older than the mbuf, and late if it is newer or holds the same
+	 * sequence number. The subtraction takes care of the sequence number
+	 * wrapping.
+	 */
+	expected = tag >> 32;
+	if ((int32_t)(mbuf->seqn - expected) <= 0) {
+		rte_errno = ERANGE;
+		return -1;
+	}
+
+	/* let the drain know how far the window has to move */
+	do {
+		expected = b->early_seqn;
+		if ((int32_t)(mbuf->seqn - expected) <= 0)
+			break;
+	} while (!rte_atomic32_cmpset(&b->early_seqn, expected, mbuf->seqn));
+
+	rte_errno = ENOSPC;
+	return -1;
+}
+
+/*
+ * Called while the mbuf at head is missing. Once it has been missing for
+ * longer than the timeout, skips it and the missing mbufs following it, up
+ * to the first one inserted, or far enough for the early mbufs waiting for
+ * room if none was. Returns the number of positions skipped.
+ */
+static unsigned int
+reorder_mp_skip_gap(struct rte_reorder_mp_buffer *b, uint32_t head)
+{
+	uint64_t now = rte_get_timer_cycles();
+	unsigned int i, n;
+	int32_t early;
+
+	if (b->gap_start == 0 || b->gap_seqn != head) {
+		b->gap_seqn = head;
+		b->gap_start = now;
+		return 0;
+	}
+	if (now - b->gap_start < b->timeout)
+		return 0;
+
+	for (n = 1; n < b->size; n++)
+		if (b->slots[(head + n) & b->mask].tag !=
+				REORDER_MP_TAG(head + n, REORDER_MP_EMPTY))
+			break;
+	if (n == b->size) {
+		early = b->early_seqn - head;
+		if (early < (int32_t)b->size) {
+			/* nothing is waiting behind the gap, time it again */
+			b->gap_start = now;
+			return 0;
+		}
+		n = RTE_MIN((unsigned int)early - b->size + 1, b->size);
+	}
+
+	/* move the slots to the next window, unless their mbuf just came */
+	for (i = 0; i < n; i++)
+		if (!rte_atomic64_cmpset(&b->slots[(head + i) & b->mask].tag,
+				REORDER_MP_TAG(head + i, REORDER_MP_EMPTY),
+				REORDER_MP_TAG(head + i + b->size,
+					REORDER_MP_EMPTY)))
+			break;
+
+	b->gap_start = 0;
+	return i;
+}
+
+unsigned int
+rte_reorder_mp_drain(struct rte_reorder_mp_buffer *b, struct rte_mbuf **mbufs,
+		unsigned int max_mbufs)
+{
+	struct reorder_mp_slot *slot;
+	unsigned int drain_cnt = 0, skipped;
+	uint32_t head;
+	uint64_t tag;
+
+	if (!rte_spinlock_trylock(&b->drain_lock))
+		return 0;
+
+	head = b->head;
+	while (drain_cnt < max_mbufs) {
+		slot = &b->slots[head & b->mask];
+		tag = slot->tag;
+		if (tag == REORDER_MP_TAG(head, REORDER_MP_READY)) {
+			/* read the mbuf after its tag, and before freeing it */
+			rte_smp_rmb();
+			mbufs[drain_cnt++] = slot->mbuf;
+			rte_smp_rmb();
+			slot->tag = REORDER_MP_TAG(head + b->size,
+					REORDER_MP_EMPTY);
+			head++;
+		} else if (tag == REORDER_MP_TAG(head, REORDER_MP_EMPTY) &&
+				b->timeout != 0) {
+			skipped = reorder_mp_skip_gap(b, head);
+			if (skipped == 0)
+				break;
+			head += skipped;
+		} else
+			break;
+	}
+	b->head = head;
+
+	rte_spinlock_unlock(&b->drain_lock);
+
+	return drain_cnt;
+}
@@ -39,6 +39,8 @@
 #include <rte_memory.h>
 #include <rte_malloc.h>
 #include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_spinlock.h>
 #include <rte_prefetch.h>
 #include <rte_branch_prediction.h>
 #include <rte_mbuf.h>
@@ -85,8 +87,8 @@ struct rte_sched_subport {
 
 	/* Traffic classes (TCs) */
 	uint64_t tc_time; /* time of next update */
-	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	uint32_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_MAX];
+	uint32_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	uint32_t tc_period;
 
 	/* TC oversubscription */
@@ -110,7 +112,7 @@ struct rte_sched_pipe_profile {
 
 	/* Pipe traffic classes */
 	uint32_t tc_period;
-	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	uint8_t tc_ov_weight;
 
 	/* Pipe queues */
@@ -127,15 +129,17 @@ struct rte_sched_pipe {
 
 	/* Traffic classes (TCs) */
 	uint64_t tc_time; /* time of next update */
-	uint32_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-
-	/* Weighted Round Robin (WRR) */
-	uint8_t wrr_tokens[RTE_SCHED_QUEUES_PER_PIPE];
 
 	/* TC oversubscription */
 	uint32_t tc_ov_credits;
 	uint8_t tc_ov_period_id;
 	uint8_t reserved[3];
+
+	/* Weighted Round Robin (WRR) */
+	uint8_t wrr_tokens[RTE_SCHED_QUEUES_PER_PIPE];
+
+	/* TC credits, last: the default layout TCs fit in the first cache line */
+	uint32_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 } __rte_cache_aligned;
 
 struct rte_sched_queue {
@@ -165,10 +169,10 @@ enum grinder_state {
  * by scheduler enqueue.
  */
 struct rte_sched_port_hierarchy {
-	uint16_t queue:2;                /**< Queue ID (0 .. 3) */
-	uint16_t traffic_class:2;        /**< Traffic class ID (0 .. 3)*/
+	uint16_t queue:4;                /**< Queue ID (0 .. 15) */
+	uint16_t traffic_class:4;        /**< Traffic class ID (0 .. 12)*/
 	uint32_t color:2;                /**< Color */
-	uint16_t unused:10;
+	uint16_t unused:6;
 	uint16_t subport;                /**< Subport ID */
 	uint32_t pipe;		         /**< Pipe ID */
 };
@@ -189,27 +193,47 @@ struct rte_sched_grinder {
 	struct rte_sched_pipe_profile *pipe_params;
 
 	/* TC cache */
-	uint8_t tccache_qmask[4];
-	uint32_t tccache_qindex[4];
+	uint16_t tccache_qmask[RTE_SCHED_TRAFFIC_CLASSES_MAX];
+	uint32_t tccache_qindex[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	uint32_t tccache_w;
 	uint32_t tccache_r;
 
 	/* Current TC */
 	uint32_t tc_index;
-	struct rte_sched_queue *queue[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	struct rte_mbuf **qbase[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	uint32_t qindex[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_queues;
+	struct rte_sched_queue *queue[RTE_SCHED_QUEUES_PER_PIPE];
+	struct rte_mbuf **qbase[RTE_SCHED_QUEUES_PER_PIPE];
+	uint32_t qindex[RTE_SCHED_QUEUES_PER_PIPE];
 	uint16_t qsize;
 	uint32_t qmask;
 	uint32_t qpos;
 	struct rte_mbuf *pkt;
 
 	/* WRR */
-	uint16_t wrr_tokens[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
-	uint16_t wrr_mask[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
-	uint8_t wrr_cost[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
+	uint16_t wrr_tokens[RTE_SCHED_QUEUES_PER_PIPE];
+	uint16_t wrr_mask[RTE_SCHED_QUEUES_PER_PIPE];
+	uint8_t wrr_cost[RTE_SCHED_QUEUES_PER_PIPE];
 };
 
+struct rte_sched_port_group {
+	/* Output port credits consumed by the group ports, written by all */
+	rte_atomic64_t time_out;
+
+	/* Output port time measured in bytes, advanced by one port at a time */
+	rte_atomic64_t time_cpu_bytes __rte_cache_aligned;
+	rte_spinlock_t lock;
+	uint64_t time_cpu_cycles;
+	uint64_t cycles_per_byte;     /* Scaled by RTE_SCHED_TIME_SHIFT */
+
+	/* User parameters */
+	uint32_t rate;
+	uint32_t n_ports_max;
+	uint32_t credits_per_dequeue;
+	uint32_t credits_max;
+
+	uint32_t n_ports;
+} __rte_cache_aligned;
+
 struct rte_sched_port {
 	/* User parameters */
 	uint32_t n_subports_per_port;
@@ -217,19 +241,36 @@ struct rte_sched_port {
 	uint32_t rate;
 	uint32_t mtu;
 	uint32_t frame_overhead;
-	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	uint32_t n_pipe_profiles;
-	uint32_t pipe_tc3_rate_max;
+	uint32_t pipe_tc_be_rate_max;
+
+	/* Traffic class layout. The queues of each pipe are grouped by TC,
+	 * with the TCs in decreasing priority order. The last TC is the best
+	 * effort one.
+	 */
+	uint32_t n_traffic_classes;
+	uint32_t tc_be;
+	uint8_t tc_n_queues[RTE_SCHED_TRAFFIC_CLASSES_MAX];
+	uint8_t tc_queue_base[RTE_SCHED_TRAFFIC_CLASSES_MAX]; /* TC 1st queue */
+	uint16_t tc_queue_mask[RTE_SCHED_TRAFFIC_CLASSES_MAX]; /* TC queues */
+	uint8_t queue_tc[RTE_SCHED_QUEUES_PER_PIPE]; /* Queue TC */
+	uint16_t queue_qsize[RTE_SCHED_QUEUES_PER_PIPE]; /* Queue size */
 #ifdef RTE_SCHED_RED
-	struct rte_red_config red_config[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE][e_RTE_METER_COLORS];
+	struct rte_red_config red_config[RTE_SCHED_TRAFFIC_CLASSES_MAX][e_RTE_METER_COLORS];
 #endif
 
 	/* Timing */
 	uint64_t time_cpu_cycles;     /* Current CPU time measured in CPU cyles */
 	uint64_t time_cpu_bytes;      /* Current CPU time measured in bytes */
 	uint64_t time;                /* Current NIC TX time measured in bytes */
+	uint64_t time_limit;          /* NIC TX time limit for current dequeue */
+	uint32_t cycles_per_byte;     /* CPU cycles per byte, scaled */
 	struct rte_reciprocal inv_cycles_per_byte; /* CPU cycles per byte */
 
+	/* Port group, NULL when the port owns the output port */
+	struct rte_sched_port_group *group;
+
 	/* Scheduling loop detection */
 	uint32_t pipe_loop;
 	uint32_t pipe_exhaustion;
@@ -299,15 +340,66 @@ rte_sched_port_qbase(struct rte_sched_port *port, uint32_t qindex)
 static inline uint16_t
 rte_sched_port_qsize(struct rte_sched_port *port, uint32_t qindex)
 {
-	uint32_t tc = (qindex >> 2) & 0x3;
+	return port->queue_qsize[qindex & 0xF];
+}
+
+static inline uint32_t
+rte_sched_port_tc(struct rte_sched_port *port, uint32_t qindex)
+{
+	return port->queue_tc[qindex & 0xF];
+}
+
+/*
+ * Traffic class layout from port parameters. Returns the number of traffic
+ * classes upon success, error code otherwise.
+ */
+static int
+rte_sched_port_tc_layout(struct rte_sched_port_params *params,
+	uint8_t *tc_n_queues)
+{
+	uint32_t n_traffic_classes, n_queues, i;
+
+	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_MAX; i++)
+		if (params->tc_n_queues[i] != 0)
+			break;
+
+	/* Default layout */
+	if (i == RTE_SCHED_TRAFFIC_CLASSES_MAX) {
+		memset(tc_n_queues, 0, RTE_SCHED_TRAFFIC_CLASSES_MAX);
+		for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
+			tc_n_queues[i] = RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS;
 
-	return port->qsize[tc];
+		return RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE;
+	}
+
+	/* Leading non-zero entries only, with at most 16 queues in total */
+	n_traffic_classes = 0;
+	n_queues = 0;
+	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_MAX; i++) {
+		if (params->tc_n_queues[i] == 0)
+			continue;
+
+		if (n_traffic_classes != i)
+			return -1;
+
+		n_traffic_classes++;
+		n_queues += params->tc_n_queues[i];
+	}
+
+	if (n_queues > RTE_SCHED_QUEUES_PER_PIPE)
+		return -1;
+
+	memcpy(tc_n_queues, params->tc_n_queues, RTE_SCHED_TRAFFIC_CLASSES_MAX);
+
+	return n_traffic_classes;
 }
 
 static int
 rte_sched_port_check_params(struct rte_sched_port_params *params)
 {
-	uint32_t i, j;
+	uint8_t tc_n_queues[RTE_SCHED_TRAFFIC_CLASSES_MAX];
+	uint32_t n_traffic_classes, n_queues, i, j;
+	int status;
 
 	if (params == NULL)
 		return -1;
@@ -335,10 +427,19 @@ rte_sched_port_check_params(struct rte_sched_port_params *params)
 	    !rte_is_power_of_2(params->n_pipes_per_subport))
 		return -7;
 
+	/* tc_n_queues: valid traffic class layout */
+	status = rte_sched_port_tc_layout(params, tc_n_queues);
+	if (status < 0)
+		return -16;
+
+	n_traffic_classes = status;
+	for (i = 0, n_queues = 0; i < n_traffic_classes; i++)
+		n_queues += tc_n_queues[i];
+
 	/* qsize: non-zero, power of 2,
 	 * no bigger than 32K (due to 16-bit read/write pointers)
 	 */
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+	for (i = 0; i < n_traffic_classes; i++) {
 		uint16_t qsize = params->qsize[i];
 
 		if (qsize == 0 || !rte_is_power_of_2(qsize))
@@ -363,7 +464,7 @@ rte_sched_port_check_params(struct rte_sched_port_params *params)
 			return -11;
 
 		/* TC rate: non-zero, less than pipe rate */
-		for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j++) {
+		for (j = 0; j < n_traffic_classes; j++) {
 			if (p->tc_rate[j] == 0 || p->tc_rate[j] > p->tb_rate)
 				return -12;
 		}
@@ -373,13 +474,13 @@ rte_sched_port_check_params(struct rte_sched_port_params *params)
 			return -13;
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-		/* TC3 oversubscription weight: non-zero */
+		/* Best effort TC oversubscription weight: non-zero */
 		if (p->tc_ov_weight == 0)
 			return -14;
 #endif
 
 		/* Queue WRR weights: non-zero */
-		for (j = 0; j < RTE_SCHED_QUEUES_PER_PIPE; j++) {
+		for (j = 0; j < n_queues; j++) {
 			if (p->wrr_weights[j] == 0)
 				return -15;
 		}
@@ -405,12 +506,16 @@ rte_sched_port_get_array_base(struct rte_sched_port_params *params, enum rte_sch
 		= RTE_SCHED_PIPE_PROFILES_PER_PORT * sizeof(struct rte_sched_pipe_profile);
 	uint32_t size_bmp_array = rte_bitmap_get_memory_footprint(n_queues_per_port);
 	uint32_t size_per_pipe_queue_array, size_queue_array;
+	uint8_t tc_n_queues[RTE_SCHED_TRAFFIC_CLASSES_MAX];
+	uint32_t n_traffic_classes;
 
 	uint32_t base, i;
 
+	n_traffic_classes = rte_sched_port_tc_layout(params, tc_n_queues);
+
 	size_per_pipe_queue_array = 0;
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
-		size_per_pipe_queue_array += RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS
+	for (i = 0; i < n_traffic_classes; i++) {
+		size_per_pipe_queue_array += tc_n_queues[i]
 			* params->qsize[i] * sizeof(struct rte_mbuf *);
 	}
 	size_queue_array = n_pipes_per_port * size_per_pipe_queue_array;
@@ -469,45 +574,80 @@ rte_sched_port_get_memory_footprint(struct rte_sched_port_params *params)
 }
 
 static void
-rte_sched_port_config_qsize(struct rte_sched_port *port)
+rte_sched_port_config_tc_layout(struct rte_sched_port *port,
+	struct rte_sched_port_params *params)
 {
-	/* TC 0 */
-	port->qsize_add[0] = 0;
-	port->qsize_add[1] = port->qsize_add[0] + port->qsize[0];
-	port->qsize_add[2] = port->qsize_add[1] + port->qsize[0];
-	port->qsize_add[3] = port->qsize_add[2] + port->qsize[0];
+	uint32_t tc, q, qbase;
+
+	port->n_traffic_classes = rte_sched_port_tc_layout(params,
+		port->tc_n_queues);
+	port->tc_be = port->n_traffic_classes - 1;
+
+	/* The queues not used by the layout (if any) have zero size */
+	for (tc = 0, qbase = 0; tc < port->n_traffic_classes; tc++) {
+		uint32_t n_queues = port->tc_n_queues[tc];
+
+		port->tc_queue_base[tc] = qbase;
+		port->tc_queue_mask[tc] = ((1 << n_queues) - 1) << qbase;
+		for (q = qbase; q < qbase + n_queues; q++) {
+			port->queue_tc[q] = tc;
+			port->queue_qsize[q] = port->qsize[tc];
+		}
+
+		qbase += n_queues;
+	}
+
+	/* Packets sent to these queues are dropped, account them to BE TC */
+	for (q = qbase; q < RTE_SCHED_QUEUES_PER_PIPE; q++)
+		port->queue_tc[q] = port->tc_be;
+}
 
-	/* TC 1 */
-	port->qsize_add[4] = port->qsize_add[3] + port->qsize[0];
-	port->qsize_add[5] = port->qsize_add[4] + port->qsize[1];
-	port->qsize_add[6] = port->qsize_add[5] + port->qsize[1];
-	port->qsize_add[7] = port->qsize_add[6] + port->qsize[1];
+static void
+rte_sched_port_config_qsize(struct rte_sched_port *port)
+{
+	uint32_t q;
 
-	/* TC 2 */
-	port->qsize_add[8] = port->qsize_add[7] + port->qsize[1];
-	port->qsize_add[9] = port->qsize_add[8] + port->qsize[2];
-	port->qsize_add[10] = port->qsize_add[9] + port->qsize[2];
-	port->qsize_add[11] = port->qsize_add[10] + port->qsize[2];
+	port->qsize_sum = 0;
+	for (q = 0; q < RTE_SCHED_QUEUES_PER_PIPE; q++) {
+		port->qsize_add[q] = port->qsize_sum;
+		port->qsize_sum += port->queue_qsize[q];
+	}
+}
 
-	/* TC 3 */
-	port->qsize_add[12] = port->qsize_add[11] + port->qsize[2];
-	port->qsize_add[13] = port->qsize_add[12] + port->qsize[3];
-	port->qsize_add[14] = port->qsize_add[13] + port->qsize[3];
-	port->qsize_add[15] = port->qsize_add[14] + port->qsize[3];
+static void
+rte_sched_log_u32_array(char *buf, size_t size, const uint32_t *a,
+	uint32_t n)
+{
+	uint32_t i;
+	int len;
 
-	port->qsize_sum = port->qsize_add[15] + port->qsize[3];
+	for (i = 0, len = 0; i < n && (size_t) len < size; i++)
+		len += snprintf(&buf[len], size - len, "%s%u",
+			i ? ", " : "", a[i]);
 }
 
 static void
 rte_sched_port_log_pipe_profile(struct rte_sched_port *port, uint32_t i)
 {
 	struct rte_sched_pipe_profile *p = port->pipe_profiles + i;
+	uint32_t wrr_cost[RTE_SCHED_QUEUES_PER_PIPE];
+	char tc_credits[RTE_SCHED_TRAFFIC_CLASSES_MAX * 12];
+	char wrr[RTE_SCHED_QUEUES_PER_PIPE * 5];
+	uint32_t q;
+
+	for (q = 0; q < RTE_SCHED_QUEUES_PER_PIPE; q++)
+		wrr_cost[q] = p->wrr_cost[q];
+
+	rte_sched_log_u32_array(tc_credits, sizeof(tc_credits),
+		p->tc_credits_per_period, port->n_traffic_classes);
+	rte_sched_log_u32_array(wrr, sizeof(wrr), wrr_cost,
+		RTE_SCHED_QUEUES_PER_PIPE);
 
 	RTE_LOG(DEBUG, SCHED, "Low level config for pipe profile %u:\n"
 		"    Token bucket: period = %u, credits per period = %u, size = %u\n"
-		"    Traffic classes: period = %u, credits per period = [%u, %u, %u, %u]\n"
-		"    Traffic class 3 oversubscription: weight = %hhu\n"
-		"    WRR cost: [%hhu, %hhu, %hhu, %hhu], [%hhu, %hhu, %hhu, %hhu], [%hhu, %hhu, %hhu, %hhu], [%hhu, %hhu, %hhu, %hhu]\n",
+		"    Traffic classes: period = %u, credits per period = [%s]\n"
+		"    Traffic class %u (best effort) oversubscription: weight = %hhu\n"
+		"    WRR cost: [%s]\n",
 		i,
 
 		/* Token bucket */
@@ -517,19 +657,14 @@ rte_sched_port_log_pipe_profile(struct rte_sched_port *port, uint32_t i)
 
 		/* Traffic classes */
 		p->tc_period,
-		p->tc_credits_per_period[0],
-		p->tc_credits_per_period[1],
-		p->tc_credits_per_period[2],
-		p->tc_credits_per_period[3],
+		tc_credits,
 
-		/* Traffic class 3 oversubscription */
+		/* Best effort traffic class oversubscription */
+		port->tc_be,
 		p->tc_ov_weight,
 
 		/* WRR */
-		p->wrr_cost[ 0], p->wrr_cost[ 1], p->wrr_cost[ 2], p->wrr_cost[ 3],
-		p->wrr_cost[ 4], p->wrr_cost[ 5], p->wrr_cost[ 6], p->wrr_cost[ 7],
-		p->wrr_cost[ 8], p->wrr_cost[ 9], p->wrr_cost[10], p->wrr_cost[11],
-		p->wrr_cost[12], p->wrr_cost[13], p->wrr_cost[14], p->wrr_cost[15]);
+		wrr);
 }
 
 static inline uint64_t
@@ -569,7 +704,7 @@ rte_sched_port_config_pipe_profile_table(struct rte_sched_port *port, struct rte
 		dst->tc_period = rte_sched_time_ms_to_bytes(src->tc_period,
 							    params->rate);
 
-		for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j++)
+		for (j = 0; j < port->n_traffic_classes; j++)
 			dst->tc_credits_per_period[j]
 				= rte_sched_time_ms_to_bytes(src->tc_period,
 							     src->tc_rate[j]);
@@ -579,43 +714,31 @@ rte_sched_port_config_pipe_profile_table(struct rte_sched_port *port, struct rte
 #endif
 
 		/* WRR */
-		for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j++) {
-			uint32_t wrr_cost[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
-			uint32_t lcd, lcd1, lcd2;
-			uint32_t qindex;
-
-			qindex = j * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS;
-
-			wrr_cost[0] = src->wrr_weights[qindex];
-			wrr_cost[1] = src->wrr_weights[qindex + 1];
-			wrr_cost[2] = src->wrr_weights[qindex + 2];
-			wrr_cost[3] = src->wrr_weights[qindex + 3];
-
-			lcd1 = rte_get_lcd(wrr_cost[0], wrr_cost[1]);
-			lcd2 = rte_get_lcd(wrr_cost[2], wrr_cost[3]);
-			lcd = rte_get_lcd(lcd1, lcd2);
-
-			wrr_cost[0] = lcd / wrr_cost[0];
-			wrr_cost[1] = lcd / wrr_cost[1];
-			wrr_cost[2] = lcd / wrr_cost[2];
-			wrr_cost[3] = lcd / wrr_cost[3];
-
-			dst->wrr_cost[qindex] = (uint8_t) wrr_cost[0];
-			dst->wrr_cost[qindex + 1] = (uint8_t) wrr_cost[1];
-			dst->wrr_cost[qindex + 2] = (uint8_t) wrr_cost[2];
-			dst->wrr_cost[qindex + 3] = (uint8_t) wrr_cost[3];
+		for (j = 0; j < port->n_traffic_classes; j++) {
+			uint32_t qindex = port->tc_queue_base[j];
+			uint32_t n_queues = port->tc_n_queues[j];
+			uint32_t lcd, k;
+
+			lcd = src->wrr_weights[qindex];
+			for (k = 1; k < n_queues; k++)
+				lcd = rte_get_lcd(lcd,
+					src->wrr_weights[qindex + k]);
+
+			for (k = 0; k < n_queues; k++)
+				dst->wrr_cost[qindex + k] = (uint8_t)
+					(lcd / src->wrr_weights[qindex + k]);
 		}
 
 		rte_sched_port_log_pipe_profile(port, i);
 	}
 
-	port->pipe_tc3_rate_max = 0;
+	port->pipe_tc_be_rate_max = 0;
 	for (i = 0; i < port->n_pipe_profiles; i++) {
 		struct rte_sched_pipe_params *src = params->pipe_profiles + i;
-		uint32_t pipe_tc3_rate = src->tc_rate[3];
+		uint32_t pipe_tc_be_rate = src->tc_rate[port->tc_be];
 
-		if (port->pipe_tc3_rate_max < pipe_tc3_rate)
-			port->pipe_tc3_rate_max = pipe_tc3_rate;
+		if (port->pipe_tc_be_rate_max < pipe_tc_be_rate)
+			port->pipe_tc_be_rate_max = pipe_tc_be_rate;
 	}
 }
 
@@ -648,8 +771,11 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	memcpy(port->qsize, params->qsize, sizeof(params->qsize));
 	port->n_pipe_profiles = params->n_pipe_profiles;
 
+	/* Traffic class layout */
+	rte_sched_port_config_tc_layout(port, params);
+
 #ifdef RTE_SCHED_RED
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+	for (i = 0; i < port->n_traffic_classes; i++) {
 		uint32_t j;
 
 		for (j = 0; j < e_RTE_METER_COLORS; j++) {
@@ -674,9 +800,11 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	port->time_cpu_cycles = rte_get_tsc_cycles();
 	port->time_cpu_bytes = 0;
 	port->time = 0;
+	port->time_limit = UINT64_MAX;
 
 	cycles_per_byte = (rte_get_tsc_hz() << RTE_SCHED_TIME_SHIFT)
 		/ params->rate;
+	port->cycles_per_byte = cycles_per_byte;
 	port->inv_cycles_per_byte = rte_reciprocal_value(cycles_per_byte);
 
 	/* Scheduling loop detection */
@@ -750,9 +878,14 @@ rte_sched_port_free(struct rte_sched_port *port)
 		struct rte_mbuf **mbufs = rte_sched_port_qbase(port, qindex);
 		uint16_t qsize = rte_sched_port_qsize(port, qindex);
 		struct rte_sched_queue *queue = port->queue + qindex;
-		uint16_t qr = queue->qr & (qsize - 1);
-		uint16_t qw = queue->qw & (qsize - 1);
+		uint16_t qr, qw;
+
+		/* Queue not used by the traffic class layout */
+		if (qsize == 0)
+			continue;
 
+		qr = queue->qr & (qsize - 1);
+		qw = queue->qw & (qsize - 1);
 		for (; qr != qw; qr = (qr + 1) & (qsize - 1))
 			rte_pktmbuf_free(mbufs[qr]);
 	}
@@ -761,15 +894,85 @@ rte_sched_port_free(struct rte_sched_port *port)
 	rte_free(port);
 }
 
+struct rte_sched_port_group *
+rte_sched_port_group_create(struct rte_sched_port_group_params *params)
+{
+	struct rte_sched_port_group *group;
+
+	/* Check user parameters */
+	if (params == NULL ||
+	    params->rate == 0 ||
+	    params->n_ports == 0 ||
+	    params->credits_per_dequeue == 0 ||
+	    params->credits_max < params->credits_per_dequeue) {
+		RTE_LOG(ERR, SCHED, "%s: Invalid port group parameters\n",
+			__func__);
+		return NULL;
+	}
+
+	group = rte_zmalloc_socket(params->name, sizeof(*group),
+		RTE_CACHE_LINE_SIZE, params->socket);
+	if (group == NULL) {
+		RTE_LOG(ERR, SCHED, "%s: Port group memory allocation failed\n",
+			__func__);
+		return NULL;
+	}
+
+	group->rate = params->rate;
+	group->n_ports_max = params->n_ports;
+	group->credits_per_dequeue = params->credits_per_dequeue;
+	group->credits_max = params->credits_max;
+
+	/* Timing: start with a full pool of credits */
+	rte_spinlock_init(&group->lock);
+	group->time_cpu_cycles = rte_get_tsc_cycles();
+	group->cycles_per_byte = (rte_get_tsc_hz() << RTE_SCHED_TIME_SHIFT)
+		/ params->rate;
+	rte_atomic64_set(&group->time_cpu_bytes, params->credits_max);
+	rte_atomic64_set(&group->time_out, 0);
+
+	return group;
+}
+
+void
+rte_sched_port_group_free(struct rte_sched_port_group *group)
+{
+	rte_free(group);
+}
+
+int
+rte_sched_port_group_add(struct rte_sched_port_group *group,
+	struct rte_sched_port *port)
+{
+	/* Check user parameters */
+	if (group == NULL || port == NULL)
+		return -1;
+
+	if (port->rate != group->rate)
+		return -2;
+
+	if (port->group != NULL || group->n_ports == group->n_ports_max)
+		return -3;
+
+	port->group = group;
+	group->n_ports++;
+
+	return 0;
+}
+
 static void
 rte_sched_port_log_subport_config(struct rte_sched_port *port, uint32_t i)
 {
 	struct rte_sched_subport *s = port->subport + i;
+	char tc_credits[RTE_SCHED_TRAFFIC_CLASSES_MAX * 12];
+
+	rte_sched_log_u32_array(tc_credits, sizeof(tc_credits),
+		s->tc_credits_per_period, port->n_traffic_classes);
 
 	RTE_LOG(DEBUG, SCHED, "Low level config for subport %u:\n"
 		"    Token bucket: period = %u, credits per period = %u, size = %u\n"
-		"    Traffic classes: period = %u, credits per period = [%u, %u, %u, %u]\n"
-		"    Traffic class 3 oversubscription: wm min = %u, wm max = %u\n",
+		"    Traffic classes: period = %u, credits per period = [%s]\n"
+		"    Traffic class %u (best effort) oversubscription: wm min = %u, wm max = %u\n",
 		i,
 
 		/* Token bucket */
@@ -779,12 +982,10 @@ rte_sched_port_log_subport_config(struct rte_sched_port *port, uint32_t i)
 
 		/* Traffic classes */
 		s->tc_period,
-		s->tc_credits_per_period[0],
-		s->tc_credits_per_period[1],
-		s->tc_credits_per_period[2],
-		s->tc_credits_per_period[3],
+		tc_credits,
 
-		/* Traffic class 3 oversubscription */
+		/* Best effort traffic class oversubscription */
+		port->tc_be,
 		s->tc_ov_wm_min,
 		s->tc_ov_wm_max);
 }
@@ -809,7 +1010,7 @@ rte_sched_subport_config(struct rte_sched_port *port,
 	if (params->tb_size == 0)
 		return -3;
 
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+	for (i = 0; i < port->n_traffic_classes; i++) {
 		if (params->tc_rate[i] == 0 ||
 		    params->tc_rate[i] > params->tb_rate)
 			return -4;
@@ -837,20 +1038,20 @@ rte_sched_subport_config(struct rte_sched_port *port,
 
 	/* Traffic Classes (TCs) */
 	s->tc_period = rte_sched_time_ms_to_bytes(params->tc_period, port->rate);
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+	for (i = 0; i < port->n_traffic_classes; i++) {
 		s->tc_credits_per_period[i]
 			= rte_sched_time_ms_to_bytes(params->tc_period,
 						     params->tc_rate[i]);
 	}
 	s->tc_time = port->time + s->tc_period;
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
+	for (i = 0; i < port->n_traffic_classes; i++)
 		s->tc_credits[i] = s->tc_credits_per_period[i];
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
 	/* TC oversubscription */
 	s->tc_ov_wm_min = port->mtu;
 	s->tc_ov_wm_max = rte_sched_time_ms_to_bytes(params->tc_period,
-						     port->pipe_tc3_rate_max);
+						     port->pipe_tc_be_rate_max);
 	s->tc_ov_wm = s->tc_ov_wm_max;
 	s->tc_ov_period_id = 0;
 	s->tc_ov = 0;
@@ -897,21 +1098,24 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 		params = port->pipe_profiles + p->profile;
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-		double subport_tc3_rate = (double) s->tc_credits_per_period[3]
+		double subport_tc_be_rate =
+			(double) s->tc_credits_per_period[port->tc_be]
 			/ (double) s->tc_period;
-		double pipe_tc3_rate = (double) params->tc_credits_per_period[3]
+		double pipe_tc_be_rate =
+			(double) params->tc_credits_per_period[port->tc_be]
 			/ (double) params->tc_period;
-		uint32_t tc3_ov = s->tc_ov;
+		uint32_t tc_be_ov = s->tc_ov;
 
 		/* Unplug pipe from its subport */
 		s->tc_ov_n -= params->tc_ov_weight;
-		s->tc_ov_rate -= pipe_tc3_rate;
-		s->tc_ov = s->tc_ov_rate > subport_tc3_rate;
+		s->tc_ov_rate -= pipe_tc_be_rate;
+		s->tc_ov = s->tc_ov_rate > subport_tc_be_rate;
 
-		if (s->tc_ov != tc3_ov) {
+		if (s->tc_ov != tc_be_ov) {
 			RTE_LOG(DEBUG, SCHED,
-				"Subport %u TC3 oversubscription is OFF (%.4lf >= %.4lf)\n",
-				subport_id, subport_tc3_rate, s->tc_ov_rate);
+				"Subport %u TC%u oversubscription is OFF (%.4lf >= %.4lf)\n",
+				subport_id, port->tc_be, subport_tc_be_rate,
+				s->tc_ov_rate);
 		}
 #endif
 
@@ -932,26 +1136,29 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 
 	/* Traffic Classes (TCs) */
 	p->tc_time = port->time + params->tc_period;
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
+	for (i = 0; i < port->n_traffic_classes; i++)
 		p->tc_credits[i] = params->tc_credits_per_period[i];
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
 	{
-		/* Subport TC3 oversubscription */
-		double subport_tc3_rate = (double) s->tc_credits_per_period[3]
+		/* Subport best effort TC oversubscription */
+		double subport_tc_be_rate =
+			(double) s->tc_credits_per_period[port->tc_be]
 			/ (double) s->tc_period;
-		double pipe_tc3_rate = (double) params->tc_credits_per_period[3]
+		double pipe_tc_be_rate =
+			(double) params->tc_credits_per_period[port->tc_be]
 			/ (double) params->tc_period;
-		uint32_t tc3_ov = s->tc_ov;
+		uint32_t tc_be_ov = s->tc_ov;
 
 		s->tc_ov_n += params->tc_ov_weight;
-		s->tc_ov_rate += pipe_tc3_rate;
-		s->tc_ov = s->tc_ov_rate > subport_tc3_rate;
+		s->tc_ov_rate += pipe_tc_be_rate;
+		s->tc_ov = s->tc_ov_rate > subport_tc_be_rate;
 
-		if (s->tc_ov != tc3_ov) {
+		if (s->tc_ov != tc_be_ov) {
 			RTE_LOG(DEBUG, SCHED,
-				"Subport %u TC3 oversubscription is ON (%.4lf < %.4lf)\n",
-				subport_id, subport_tc3_rate, s->tc_ov_rate);
+				"Subport %u TC%u oversubscription is ON (%.4lf < %.4lf)\n",
+				subport_id, port->tc_be, subport_tc_be_rate,
+				s->tc_ov_rate);
 		}
 		p->tc_ov_period_id = s->tc_ov_period_id;
 		p->tc_ov_credits = s->tc_ov_wm;
@@ -1060,9 +1267,21 @@ rte_sched_port_qindex(struct rte_sched_port *port, uint32_t subport, uint32_t pi
 {
 	uint32_t result;
 
+#ifdef RTE_SCHED_DEBUG
+	if (traffic_class >= port->n_traffic_classes ||
+	    queue >= port->tc_n_queues[traffic_class])
+		rte_panic("Invalid traffic class %u queue %u\n",
+			traffic_class, queue);
+#endif
+
+	/* Out of range traffic classes are best effort, out of range queues
+	 * wrap around to another queue of the same pipe.
+	 */
+	traffic_class = RTE_MIN(traffic_class, port->tc_be);
+
 	result = subport * port->n_pipes_per_subport + pipe;
-	result = result * RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE + traffic_class;
-	result = result * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS + queue;
+	result = result * RTE_SCHED_QUEUES_PER_PIPE +
+		((port->tc_queue_base[traffic_class] + queue) & 0xF);
 
 	return result;
 }
@@ -1085,7 +1304,7 @@ static inline void
 rte_sched_port_update_subport_stats(struct rte_sched_port *port, uint32_t qindex, struct rte_mbuf *pkt)
 {
 	struct rte_sched_subport *s = port->subport + (qindex / rte_sched_port_queues_per_subport(port));
-	uint32_t tc_index = (qindex >> 2) & 0x3;
+	uint32_t tc_index = rte_sched_port_tc(port, qindex);
 	uint32_t pkt_len = pkt->pkt_len;
 
 	s->stats.n_pkts_tc[tc_index] += 1;
@@ -1105,7 +1324,7 @@ rte_sched_port_update_subport_stats_on_drop(struct rte_sched_port *port,
 #endif
 {
 	struct rte_sched_subport *s = port->subport + (qindex / rte_sched_port_queues_per_subport(port));
-	uint32_t tc_index = (qindex >> 2) & 0x3;
+	uint32_t tc_index = rte_sched_port_tc(port, qindex);
 	uint32_t pkt_len = pkt->pkt_len;
 
 	s->stats.n_pkts_tc_dropped[tc_index] += 1;
@@ -1160,7 +1379,7 @@ rte_sched_port_red_drop(struct rte_sched_port *port, struct rte_mbuf *pkt, uint3
 	uint32_t tc_index;
 	enum rte_meter_color color;
 
-	tc_index = (qindex >> 2) & 0x3;
+	tc_index = rte_sched_port_tc(port, qindex);
 	color = rte_sched_port_pkt_read_color(pkt);
 	red_cfg = &port->red_config[tc_index][color];
 
@@ -1480,6 +1699,7 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	struct rte_sched_pipe_profile *params = grinder->pipe_params;
 	uint64_t n_periods;
+	uint32_t i;
 
 	/* Subport TB */
 	n_periods = (port->time - subport->tb_time) / subport->tb_period;
@@ -1495,19 +1715,15 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 
 	/* Subport TCs */
 	if (unlikely(port->time >= subport->tc_time)) {
-		subport->tc_credits[0] = subport->tc_credits_per_period[0];
-		subport->tc_credits[1] = subport->tc_credits_per_period[1];
-		subport->tc_credits[2] = subport->tc_credits_per_period[2];
-		subport->tc_credits[3] = subport->tc_credits_per_period[3];
+		for (i = 0; i < port->n_traffic_classes; i++)
+			subport->tc_credits[i] = subport->tc_credits_per_period[i];
 		subport->tc_time = port->time + subport->tc_period;
 	}
 
 	/* Pipe TCs */
 	if (unlikely(port->time >= pipe->tc_time)) {
-		pipe->tc_credits[0] = params->tc_credits_per_period[0];
-		pipe->tc_credits[1] = params->tc_credits_per_period[1];
-		pipe->tc_credits[2] = params->tc_credits_per_period[2];
-		pipe->tc_credits[3] = params->tc_credits_per_period[3];
+		for (i = 0; i < port->n_traffic_classes; i++)
+			pipe->tc_credits[i] = params->tc_credits_per_period[i];
 		pipe->tc_time = port->time + params->tc_period;
 	}
 }
@@ -1519,22 +1735,27 @@ grinder_tc_ov_credits_update(struct rte_sched_port *port, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_subport *subport = grinder->subport;
-	uint32_t tc_ov_consumption[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	uint32_t tc_ov_consumption_max;
+	uint32_t tc_ov_consumption[RTE_SCHED_TRAFFIC_CLASSES_MAX];
+	uint32_t tc_ov_consumption_max, tc_ov_consumption_sp;
 	uint32_t tc_ov_wm = subport->tc_ov_wm;
+	uint32_t tc_be = port->tc_be;
+	uint32_t i;
 
 	if (subport->tc_ov == 0)
 		return subport->tc_ov_wm_max;
 
-	tc_ov_consumption[0] = subport->tc_credits_per_period[0] - subport->tc_credits[0];
-	tc_ov_consumption[1] = subport->tc_credits_per_period[1] - subport->tc_credits[1];
-	tc_ov_consumption[2] = subport->tc_credits_per_period[2] - subport->tc_credits[2];
-	tc_ov_consumption[3] = subport->tc_credits_per_period[3] - subport->tc_credits[3];
+	tc_ov_consumption_sp = 0;
+	for (i = 0; i <= tc_be; i++) {
+		tc_ov_consumption[i] = subport->tc_credits_per_period[i] -
+			subport->tc_credits[i];
+		if (i < tc_be)
+			tc_ov_consumption_sp += tc_ov_consumption[i];
+	}
 
-	tc_ov_consumption_max = subport->tc_credits_per_period[3] -
-		(tc_ov_consumption[0] + tc_ov_consumption[1] + tc_ov_consumption[2]);
+	tc_ov_consumption_max = subport->tc_credits_per_period[tc_be] -
+		tc_ov_consumption_sp;
 
-	if (tc_ov_consumption[3] > (tc_ov_consumption_max - port->mtu)) {
+	if (tc_ov_consumption[tc_be] > (tc_ov_consumption_max - port->mtu)) {
 		tc_ov_wm  -= tc_ov_wm >> 7;
 		if (tc_ov_wm < subport->tc_ov_wm_min)
 			tc_ov_wm = subport->tc_ov_wm_min;
@@ -1557,6 +1778,7 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	struct rte_sched_pipe_profile *params = grinder->pipe_params;
 	uint64_t n_periods;
+	uint32_t i;
 
 	/* Subport TB */
 	n_periods = (port->time - subport->tb_time) / subport->tb_period;
@@ -1574,10 +1796,8 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 	if (unlikely(port->time >= subport->tc_time)) {
 		subport->tc_ov_wm = grinder_tc_ov_credits_update(port, pos);
 
-		subport->tc_credits[0] = subport->tc_credits_per_period[0];
-		subport->tc_credits[1] = subport->tc_credits_per_period[1];
-		subport->tc_credits[2] = subport->tc_credits_per_period[2];
-		subport->tc_credits[3] = subport->tc_credits_per_period[3];
+		for (i = 0; i < port->n_traffic_classes; i++)
+			subport->tc_credits[i] = subport->tc_credits_per_period[i];
 
 		subport->tc_time = port->time + subport->tc_period;
 		subport->tc_ov_period_id++;
@@ -1585,10 +1805,8 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 
 	/* Pipe TCs */
 	if (unlikely(port->time >= pipe->tc_time)) {
-		pipe->tc_credits[0] = params->tc_credits_per_period[0];
-		pipe->tc_credits[1] = params->tc_credits_per_period[1];
-		pipe->tc_credits[2] = params->tc_credits_per_period[2];
-		pipe->tc_credits[3] = params->tc_credits_per_period[3];
+		for (i = 0; i < port->n_traffic_classes; i++)
+			pipe->tc_credits[i] = params->tc_credits_per_period[i];
 		pipe->tc_time = port->time + params->tc_period;
 	}
 
@@ -1653,9 +1871,9 @@ grinder_credits_check(struct rte_sched_port *port, uint32_t pos)
 	uint32_t subport_tc_credits = subport->tc_credits[tc_index];
 	uint32_t pipe_tb_credits = pipe->tb_credits;
 	uint32_t pipe_tc_credits = pipe->tc_credits[tc_index];
-	uint32_t pipe_tc_ov_mask1[] = {UINT32_MAX, UINT32_MAX, UINT32_MAX, pipe->tc_ov_credits};
-	uint32_t pipe_tc_ov_mask2[] = {0, 0, 0, UINT32_MAX};
-	uint32_t pipe_tc_ov_credits = pipe_tc_ov_mask1[tc_index];
+	uint32_t is_tc_be = (tc_index == port->tc_be);
+	uint32_t pipe_tc_ov_mask2 = is_tc_be * UINT32_MAX;
+	uint32_t pipe_tc_ov_credits = is_tc_be ? pipe->tc_ov_credits : UINT32_MAX;
 	int enough_credits;
 
 	/* Check pipe and subport credits */
@@ -1673,7 +1891,7 @@ grinder_credits_check(struct rte_sched_port *port, uint32_t pos)
 	subport->tc_credits[tc_index] -= pkt_len;
 	pipe->tb_credits -= pkt_len;
 	pipe->tc_credits[tc_index] -= pkt_len;
-	pipe->tc_ov_credits -= pipe_tc_ov_mask2[tc_index] & pkt_len;
+	pipe->tc_ov_credits -= pipe_tc_ov_mask2 & pkt_len;
 
 	return 1;
 }
@@ -1806,31 +2024,25 @@ static inline void
 grinder_tccache_populate(struct rte_sched_port *port, uint32_t pos, uint32_t qindex, uint16_t qmask)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
-	uint8_t b[4];
 
 	grinder->tccache_w = 0;
 	grinder->tccache_r = 0;
 
-	b[0] = (uint8_t) (qmask & 0xF);
-	b[1] = (uint8_t) ((qmask >> 4) & 0xF);
-	b[2] = (uint8_t) ((qmask >> 8) & 0xF);
-	b[3] = (uint8_t) ((qmask >> 12) & 0xF);
-
-	grinder->tccache_qmask[grinder->tccache_w] = b[0];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex;
-	grinder->tccache_w += (b[0] != 0);
-
-	grinder->tccache_qmask[grinder->tccache_w] = b[1];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex + 4;
-	grinder->tccache_w += (b[1] != 0);
+	/* Active TCs in priority order, as the pipe queues are grouped by TC
+	 * in decreasing priority order. The queue mask of each TC is stored
+	 * relative to the first queue of the TC.
+	 */
+	while (qmask) {
+		uint32_t tc = port->queue_tc[__builtin_ctz(qmask)];
+		uint32_t qbase = port->tc_queue_base[tc];
+		uint16_t tc_qmask = qmask & port->tc_queue_mask[tc];
 
-	grinder->tccache_qmask[grinder->tccache_w] = b[2];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex + 8;
-	grinder->tccache_w += (b[2] != 0);
+		grinder->tccache_qmask[grinder->tccache_w] = tc_qmask >> qbase;
+		grinder->tccache_qindex[grinder->tccache_w] = qindex + qbase;
+		grinder->tccache_w++;
 
-	grinder->tccache_qmask[grinder->tccache_w] = b[3];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex + 12;
-	grinder->tccache_w += (b[3] != 0);
+		qmask &= ~tc_qmask;
+	}
 }
 
 static inline int
@@ -1838,7 +2050,7 @@ grinder_next_tc(struct rte_sched_port *port, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_mbuf **qbase;
-	uint32_t qindex;
+	uint32_t qindex, tc_index, n_queues, i;
 	uint16_t qsize;
 
 	if (grinder->tccache_r == grinder->tccache_w)
@@ -1847,25 +2059,19 @@ grinder_next_tc(struct rte_sched_port *port, uint32_t pos)
 	qindex = grinder->tccache_qindex[grinder->tccache_r];
 	qbase = rte_sched_port_qbase(port, qindex);
 	qsize = rte_sched_port_qsize(port, qindex);
+	tc_index = rte_sched_port_tc(port, qindex);
+	n_queues = port->tc_n_queues[tc_index];
 
-	grinder->tc_index = (qindex >> 2) & 0x3;
+	grinder->tc_index = tc_index;
+	grinder->n_queues = n_queues;
 	grinder->qmask = grinder->tccache_qmask[grinder->tccache_r];
 	grinder->qsize = qsize;
 
-	grinder->qindex[0] = qindex;
-	grinder->qindex[1] = qindex + 1;
-	grinder->qindex[2] = qindex + 2;
-	grinder->qindex[3] = qindex + 3;
-
-	grinder->queue[0] = port->queue + qindex;
-	grinder->queue[1] = port->queue + qindex + 1;
-	grinder->queue[2] = port->queue + qindex + 2;
-	grinder->queue[3] = port->queue + qindex + 3;
-
-	grinder->qbase[0] = qbase;
-	grinder->qbase[1] = qbase + qsize;
-	grinder->qbase[2] = qbase + 2 * qsize;
-	grinder->qbase[3] = qbase + 3 * qsize;
+	for (i = 0; i < n_queues; i++) {
+		grinder->qindex[i] = qindex + i;
+		grinder->queue[i] = port->queue + qindex + i;
+		grinder->qbase[i] = qbase + i * qsize;
+	}
 
 	grinder->tccache_r++;
 	return 1;
@@ -1935,26 +2141,18 @@ grinder_wrr_load(struct rte_sched_port *port, uint32_t pos)
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	struct rte_sched_pipe_profile *pipe_params = grinder->pipe_params;
-	uint32_t tc_index = grinder->tc_index;
+	uint32_t n_queues = grinder->n_queues;
 	uint32_t qmask = grinder->qmask;
-	uint32_t qindex;
-
-	qindex = tc_index * 4;
-
-	grinder->wrr_tokens[0] = ((uint16_t) pipe->wrr_tokens[qindex]) << RTE_SCHED_WRR_SHIFT;
-	grinder->wrr_tokens[1] = ((uint16_t) pipe->wrr_tokens[qindex + 1]) << RTE_SCHED_WRR_SHIFT;
-	grinder->wrr_tokens[2] = ((uint16_t) pipe->wrr_tokens[qindex + 2]) << RTE_SCHED_WRR_SHIFT;
-	grinder->wrr_tokens[3] = ((uint16_t) pipe->wrr_tokens[qindex + 3]) << RTE_SCHED_WRR_SHIFT;
+	uint32_t qindex, i;
 
-	grinder->wrr_mask[0] = (qmask & 0x1) * 0xFFFF;
-	grinder->wrr_mask[1] = ((qmask >> 1) & 0x1) * 0xFFFF;
-	grinder->wrr_mask[2] = ((qmask >> 2) & 0x1) * 0xFFFF;
-	grinder->wrr_mask[3] = ((qmask >> 3) & 0x1) * 0xFFFF;
+	qindex = grinder->qindex[0] & (RTE_SCHED_QUEUES_PER_PIPE - 1);
 
-	grinder->wrr_cost[0] = pipe_params->wrr_cost[qindex];
-	grinder->wrr_cost[1] = pipe_params->wrr_cost[qindex + 1];
-	grinder->wrr_cost[2] = pipe_params->wrr_cost[qindex + 2];
-	grinder->wrr_cost[3] = pipe_params->wrr_cost[qindex + 3];
+	for (i = 0; i < n_queues; i++) {
+		grinder->wrr_tokens[i] = ((uint16_t) pipe->wrr_tokens[qindex + i])
+			<< RTE_SCHED_WRR_SHIFT;
+		grinder->wrr_mask[i] = ((qmask >> i) & 0x1) * 0xFFFF;
+		grinder->wrr_cost[i] = pipe_params->wrr_cost[qindex + i];
+	}
 }
 
 static inline void
@@ -1962,39 +2160,44 @@ grinder_wrr_store(struct rte_sched_port *port, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_pipe *pipe = grinder->pipe;
-	uint32_t tc_index = grinder->tc_index;
-	uint32_t qindex;
+	uint32_t n_queues = grinder->n_queues;
+	uint32_t qindex, i;
 
-	qindex = tc_index * 4;
+	qindex = grinder->qindex[0] & (RTE_SCHED_QUEUES_PER_PIPE - 1);
 
-	pipe->wrr_tokens[qindex] = (grinder->wrr_tokens[0] & grinder->wrr_mask[0])
-		>> RTE_SCHED_WRR_SHIFT;
-	pipe->wrr_tokens[qindex + 1] = (grinder->wrr_tokens[1] & grinder->wrr_mask[1])
-		>> RTE_SCHED_WRR_SHIFT;
-	pipe->wrr_tokens[qindex + 2] = (grinder->wrr_tokens[2] & grinder->wrr_mask[2])
-		>> RTE_SCHED_WRR_SHIFT;
-	pipe->wrr_tokens[qindex + 3] = (grinder->wrr_tokens[3] & grinder->wrr_mask[3])
-		>> RTE_SCHED_WRR_SHIFT;
+	for (i = 0; i < n_queues; i++)
+		pipe->wrr_tokens[qindex + i] =
+			(grinder->wrr_tokens[i] & grinder->wrr_mask[i])
+			>> RTE_SCHED_WRR_SHIFT;
 }
 
 static inline void
 grinder_wrr(struct rte_sched_port *port, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
+	uint32_t n_queues = grinder->n_queues;
 	uint16_t wrr_tokens_min;
+	uint32_t i;
+
+	/* Strict priority TC: single queue, nothing to arbitrate */
+	if (n_queues == 1) {
+		grinder->qpos = 0;
+		grinder->wrr_tokens[0] = 0;
+		return;
+	}
 
-	grinder->wrr_tokens[0] |= ~grinder->wrr_mask[0];
-	grinder->wrr_tokens[1] |= ~grinder->wrr_mask[1];
-	grinder->wrr_tokens[2] |= ~grinder->wrr_mask[2];
-	grinder->wrr_tokens[3] |= ~grinder->wrr_mask[3];
+	for (i = 0; i < n_queues; i++)
+		grinder->wrr_tokens[i] |= ~grinder->wrr_mask[i];
 
-	grinder->qpos = rte_min_pos_4_u16(grinder->wrr_tokens);
+	if (likely(n_queues == 4))
+		grinder->qpos = rte_min_pos_4_u16(grinder->wrr_tokens);
+	else
+		grinder->qpos = rte_min_pos_n_u16(grinder->wrr_tokens,
+			n_queues);
 	wrr_tokens_min = grinder->wrr_tokens[grinder->qpos];
 
-	grinder->wrr_tokens[0] -= wrr_tokens_min;
-	grinder->wrr_tokens[1] -= wrr_tokens_min;
-	grinder->wrr_tokens[2] -= wrr_tokens_min;
-	grinder->wrr_tokens[3] -= wrr_tokens_min;
+	for (i = 0; i < n_queues; i++)
+		grinder->wrr_tokens[i] -= wrr_tokens_min;
 }
 
 
@@ -2006,6 +2209,7 @@ grinder_prefetch_pipe(struct rte_sched_port *port, uint32_t pos)
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 
 	rte_prefetch0(grinder->pipe);
+	rte_prefetch0((uint8_t *) grinder->pipe + RTE_CACHE_LINE_SIZE);
 	rte_prefetch0(grinder->queue[0]);
 }
 
@@ -2013,22 +2217,23 @@ static inline void
 grinder_prefetch_tc_queue_arrays(struct rte_sched_port *port, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
-	uint16_t qsize, qr[4];
+	uint32_t n_queues = grinder->n_queues;
+	uint32_t n_queues_first = (n_queues + 1) >> 1;
+	uint16_t qsize, qr[RTE_SCHED_QUEUES_PER_PIPE];
+	uint32_t i;
 
 	qsize = grinder->qsize;
-	qr[0] = grinder->queue[0]->qr & (qsize - 1);
-	qr[1] = grinder->queue[1]->qr & (qsize - 1);
-	qr[2] = grinder->queue[2]->qr & (qsize - 1);
-	qr[3] = grinder->queue[3]->qr & (qsize - 1);
+	for (i = 0; i < n_queues; i++)
+		qr[i] = grinder->queue[i]->qr & (qsize - 1);
 
-	rte_prefetch0(grinder->qbase[0] + qr[0]);
-	rte_prefetch0(grinder->qbase[1] + qr[1]);
+	for (i = 0; i < n_queues_first; i++)
+		rte_prefetch0(grinder->qbase[i] + qr[i]);
 
 	grinder_wrr_load(port, pos);
 	grinder_wrr(port, pos);
 
-	rte_prefetch0(grinder->qbase[2] + qr[2]);
-	rte_prefetch0(grinder->qbase[3] + qr[3]);
+	for (; i < n_queues; i++)
+		rte_prefetch0(grinder->qbase[i] + qr[i]);
 }
 
 static inline void
@@ -2147,11 +2352,19 @@ rte_sched_port_time_resync(struct rte_sched_port *port)
 	uint64_t bytes_diff;
 
 	/* Compute elapsed time in bytes */
-	bytes_diff = rte_reciprocal_divide(cycles_diff << RTE_SCHED_TIME_SHIFT,
-					   port->inv_cycles_per_byte);
-
-	/* Advance port time */
-	port->time_cpu_cycles = cycles;
+	if (likely(cycles_diff <= (UINT32_MAX >> RTE_SCHED_TIME_SHIFT)))
+		bytes_diff = rte_reciprocal_divide(
+			cycles_diff << RTE_SCHED_TIME_SHIFT,
+			port->inv_cycles_per_byte);
+	else
+		bytes_diff = (cycles_diff << RTE_SCHED_TIME_SHIFT) /
+			port->cycles_per_byte;
+
+	/* Advance port time. Only consume the cycles accounted for, so the
+	 * fraction of byte left is not lost when the port is polled often.
+	 */
+	port->time_cpu_cycles += (bytes_diff * port->cycles_per_byte)
+		>> RTE_SCHED_TIME_SHIFT;
 	port->time_cpu_bytes += bytes_diff;
 	if (port->time < port->time_cpu_bytes)
 		port->time = port->time_cpu_bytes;
@@ -2160,6 +2373,71 @@ rte_sched_port_time_resync(struct rte_sched_port *port)
 	port->pipe_loop = RTE_SCHED_PIPE_INVALID;
 }
 
+/*
+ * Advance the output port time of the group. Only one port of the group at a
+ * time does it, the other ones use the current value.
+ */
+static inline uint64_t
+rte_sched_port_group_time_resync(struct rte_sched_port_group *group)
+{
+	if (rte_spinlock_trylock(&group->lock)) {
+		uint64_t cycles = rte_get_tsc_cycles();
+		uint64_t cycles_diff = cycles - group->time_cpu_cycles;
+		uint64_t bytes_diff;
+
+		bytes_diff = (cycles_diff << RTE_SCHED_TIME_SHIFT) /
+			group->cycles_per_byte;
+
+		/* Only consume the cycles accounted for, so no time is lost */
+		group->time_cpu_cycles += (bytes_diff * group->cycles_per_byte)
+			>> RTE_SCHED_TIME_SHIFT;
+		rte_atomic64_add(&group->time_cpu_bytes, bytes_diff);
+
+		rte_spinlock_unlock(&group->lock);
+	}
+
+	return rte_atomic64_read(&group->time_cpu_bytes);
+}
+
+/* Take up to credits_per_dequeue credits from the group pool */
+static inline uint64_t
+rte_sched_port_group_credits_get(struct rte_sched_port_group *group)
+{
+	uint64_t time = rte_sched_port_group_time_resync(group);
+	uint64_t time_min = time - group->credits_max;
+	uint64_t time_out, time_out_new, credits;
+
+	do {
+		time_out = (uint64_t) rte_atomic64_read(&group->time_out);
+
+		/* Credits left unused for longer than the pool size are lost */
+		if ((int64_t) (time_out - time_min) < 0)
+			time_out_new = time_min;
+		else
+			time_out_new = time_out;
+
+		if ((int64_t) (time - time_out_new) <= 0)
+			return 0;
+
+		credits = RTE_MIN(time - time_out_new,
+			(uint64_t) group->credits_per_dequeue);
+		time_out_new += credits;
+	} while (rte_atomic64_cmpset((volatile uint64_t *) &group->time_out.cnt,
+		time_out, time_out_new) == 0);
+
+	return credits;
+}
+
+/* Give back the credits not used (or take the ones used in excess) */
+static inline void
+rte_sched_port_group_credits_put(struct rte_sched_port_group *group,
+	uint64_t credits, uint64_t credits_used)
+{
+	if (credits_used != credits)
+		rte_atomic64_add(&group->time_out,
+			(int64_t) (credits_used - credits));
+}
+
 static inline int
 rte_sched_port_exceptions(struct rte_sched_port *port, int second_pass)
 {
@@ -2167,7 +2445,8 @@ rte_sched_port_exceptions(struct rte_sched_port *port, int second_pass)
 
 	/* Check if any exception flag is set */
 	exceptions = (second_pass && port->busy_grinders == 0) ||
-		(port->pipe_exhaustion == 1);
+		(port->pipe_exhaustion == 1) ||
+		(port->time >= port->time_limit);
 
 	/* Clear exception flags */
 	port->pipe_exhaustion = 0;
@@ -2178,6 +2457,8 @@ rte_sched_port_exceptions(struct rte_sched_port *port, int second_pass)
 int
 rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts)
 {
+	struct rte_sched_port_group *group = port->group;
+	uint64_t credits = 0, time_start = 0;
 	uint32_t i, count;
 
 	port->pkts_out = pkts;
@@ -2185,6 +2466,16 @@ rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
 
 	rte_sched_port_time_resync(port);
 
+	/* Port group: the output port credits limit the NIC TX time */
+	if (group != NULL) {
+		credits = rte_sched_port_group_credits_get(group);
+		if (credits == 0)
+			return 0;
+
+		time_start = port->time;
+		port->time_limit = port->time + credits;
+	}
+
 	/* Take each queue in the grinder one step further */
 	for (i = 0, count = 0; ; i++)  {
 		count += grinder_handle(port, i & (RTE_SCHED_PORT_N_GRINDERS - 1));
@@ -2194,5 +2485,9 @@ rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
 		}
 	}
 
+	if (group != NULL)
+		rte_sched_port_group_credits_put(group, credits,
+			port->time - time_start);
+
 	return count;
 }
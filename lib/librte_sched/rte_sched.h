@@ -76,6 +76,10 @@ extern "C" {
  *           - Lower priority traffic classes able to reuse pipe
  *	    bandwidth currently unused by higher priority traffic
  *	    classes of the same pipe;
+ *           - The number of traffic classes and the number of queues
+ *	    of each traffic class are configurable per port, with
+ *	    the lowest priority traffic class being the best effort
+ *	    one;
  *     5. Queue:
  *           - Typical usage: queue hosting packets from one or
  *	    multiple connections of same traffic class belonging to
@@ -94,19 +98,24 @@ extern "C" {
 #include "rte_red.h"
 #endif
 
-/** Number of traffic classes per pipe (as well as subport).
+/** Number of queues per pipe. Cannot be changed. */
+#define RTE_SCHED_QUEUES_PER_PIPE             16
+
+/** Maximum number of traffic classes per pipe (as well as subport).
  * Cannot be changed.
  */
+#define RTE_SCHED_TRAFFIC_CLASSES_MAX         13
+
+/** Number of traffic classes per pipe of the default traffic class
+ * layout. Cannot be changed.
+ */
 #define RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE    4
 
-/** Number of queues per pipe traffic class. Cannot be changed. */
+/** Number of queues per pipe traffic class of the default traffic class
+ * layout. Cannot be changed.
+ */
 #define RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS    4
 
-/** Number of queues per pipe. */
-#define RTE_SCHED_QUEUES_PER_PIPE             \
-	(RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE *     \
-	RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS)
-
 /** Maximum number of pipe profiles that can be defined per port.
  * Compile-time configurable.
  */
@@ -143,7 +152,7 @@ struct rte_sched_subport_params {
 	uint32_t tb_size;                /**< Size (measured in credits) */
 
 	/* Subport traffic classes */
-	uint32_t tc_rate[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_rate[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	/**< Traffic class rates (measured in bytes per second) */
 	uint32_t tc_period;
 	/**< Enforcement period for rates (measured in milliseconds) */
@@ -152,19 +161,19 @@ struct rte_sched_subport_params {
 /** Subport statistics */
 struct rte_sched_subport_stats {
 	/* Packets */
-	uint32_t n_pkts_tc[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_pkts_tc[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	/**< Number of packets successfully written */
-	uint32_t n_pkts_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_pkts_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	/**< Number of packets dropped */
 
 	/* Bytes */
-	uint32_t n_bytes_tc[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_bytes_tc[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	/**< Number of bytes successfully written for each traffic class */
-	uint32_t n_bytes_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_bytes_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	/**< Number of bytes dropped for each traffic class */
 
 #ifdef RTE_SCHED_RED
-	uint32_t n_pkts_red_dropped[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_pkts_red_dropped[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	/**< Number of packets dropped by red */
 #endif
 };
@@ -184,16 +193,20 @@ struct rte_sched_pipe_params {
 	uint32_t tb_size;                /**< Size (measured in credits) */
 
 	/* Pipe traffic classes */
-	uint32_t tc_rate[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_rate[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	/**< Traffic class rates (measured in bytes per second) */
 	uint32_t tc_period;
 	/**< Enforcement period (measured in milliseconds) */
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-	uint8_t tc_ov_weight;		 /**< Weight Traffic class 3 oversubscription */
+	uint8_t tc_ov_weight;
+	/**< Weight of the best effort traffic class oversubscription */
 #endif
 
 	/* Pipe queues */
-	uint8_t  wrr_weights[RTE_SCHED_QUEUES_PER_PIPE]; /**< WRR weights */
+	uint8_t  wrr_weights[RTE_SCHED_QUEUES_PER_PIPE];
+	/**< WRR weights, indexed by the queue ID within pipe, with the queues
+	 * of each traffic class following the ones of the higher priority
+	 * traffic classes. */
 };
 
 /** Queue statistics */
@@ -223,7 +236,16 @@ struct rte_sched_port_params {
 					  * (measured in bytes) */
 	uint32_t n_subports_per_port;    /**< Number of subports */
 	uint32_t n_pipes_per_subport;    /**< Number of pipes per subport */
-	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint8_t tc_n_queues[RTE_SCHED_TRAFFIC_CLASSES_MAX];
+	/**< Traffic class layout: number of queues for each pipe traffic
+	 * class, in decreasing priority order. The number of traffic classes
+	 * is the number of leading non-zero entries, with the last one being
+	 * the best effort traffic class, and the total number of queues is
+	 * limited to RTE_SCHED_QUEUES_PER_PIPE. When all the entries are
+	 * zero, the default layout of RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE
+	 * traffic classes with RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS queues each
+	 * is used. */
+	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	/**< Packet queue size for each traffic class.
 	 * All queues within the same pipe traffic class have the same
 	 * size. Queues from different pipes serving the same traffic
@@ -233,10 +255,36 @@ struct rte_sched_port_params {
 	 * Every pipe is configured using one of the profiles from this table. */
 	uint32_t n_pipe_profiles;        /**< Profiles in the pipe profile table */
 #ifdef RTE_SCHED_RED
-	struct rte_red_params red_params[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE][e_RTE_METER_COLORS]; /**< RED parameters */
+	struct rte_red_params red_params[RTE_SCHED_TRAFFIC_CLASSES_MAX][e_RTE_METER_COLORS]; /**< RED parameters */
 #endif
 };
 
+/*
+ * Port group parameters. A port group allows the subports of one output
+ * port to be split across several port scheduler instances (workers), each
+ * one run by its own lcore with its own set of grinders. The workers share
+ * the output port rate through a pool of credits (bytes): each worker
+ * dequeue takes credits from the pool and gives back the ones it did not
+ * use, so the busy workers can use the bandwidth left unused by the idle
+ * ones. The packets dequeued by the workers are merged back into the output
+ * port by the application.
+ */
+struct rte_sched_port_group_params {
+	const char *name;                /**< String to be associated */
+	int socket;                      /**< CPU socket ID */
+	uint32_t rate;                   /**< Output port rate
+					  * (measured in bytes per second),
+					  * same as the rate of each worker */
+	uint32_t n_ports;                /**< Max number of workers */
+	uint32_t credits_per_dequeue;    /**< Max credits taken from the pool
+					  * by one worker dequeue (measured in
+					  * bytes), typically the dequeue
+					  * burst size times the MTU */
+	uint32_t credits_max;            /**< Pool size (measured in bytes),
+					  * i.e. the max output port burst.
+					  * No less than credits_per_dequeue */
+};
+
 /*
  * Configuration
  *
@@ -299,6 +347,54 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 	uint32_t pipe_id,
 	int32_t pipe_profile);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Hierarchical scheduler port group create
+ *
+ * @param params
+ *   Port group parameters
+ * @return
+ *   Handle to port group upon success or NULL otherwise.
+ */
+struct rte_sched_port_group *
+rte_sched_port_group_create(struct rte_sched_port_group_params *params);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Hierarchical scheduler port group free. To be called after all the ports
+ * of the group are freed.
+ *
+ * @param group
+ *   Handle to port group
+ */
+void
+rte_sched_port_group_free(struct rte_sched_port_group *group);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Add a port scheduler instance (worker) to a port group. From now on, the
+ * port dequeue operation is limited by the credits of the group. Each worker
+ * is configured with its own share of the output port subports and has to
+ * be run by a single lcore at a time, while different workers of the same
+ * group can run on different lcores.
+ *
+ * @param group
+ *   Handle to port group
+ * @param port
+ *   Handle to port scheduler instance, with the same rate as the group
+ * @return
+ *   0 upon success, error code otherwise
+ */
+int
+rte_sched_port_group_add(struct rte_sched_port_group *group,
+	struct rte_sched_port *port);
+
 /**
  * Hierarchical scheduler memory footprint size per port
  *
@@ -326,8 +422,8 @@ rte_sched_port_get_memory_footprint(struct rte_sched_port_params *params);
  *   Pointer to pre-allocated subport statistics structure where the statistics
  *   counters should be stored
  * @param tc_ov
- *   Pointer to pre-allocated 4-entry array where the oversubscription status for
- *   each of the 4 subport traffic classes should be stored.
+ *   Pointer to pre-allocated variable where the oversubscription status of
+ *   the subport best effort traffic class should be stored.
  * @return
  *   0 upon success, error code otherwise
  */
@@ -370,9 +466,13 @@ rte_sched_queue_read_stats(struct rte_sched_port *port,
  * @param pipe
  *   Pipe ID within subport
  * @param traffic_class
- *   Traffic class ID within pipe (0 .. 3)
+ *   Traffic class ID within pipe (0 .. 12), valid for the port traffic
+ *   class layout. The enqueue operation treats out of range values as
+ *   the best effort traffic class.
  * @param queue
- *   Queue ID within pipe traffic class (0 .. 3)
+ *   Queue ID within pipe traffic class (0 .. 15), valid for the port
+ *   traffic class layout. The enqueue operation wraps out of range values
+ *   around to another queue of the same pipe.
  * @param color
  *   Packet color set
  */
@@ -394,9 +494,9 @@ rte_sched_port_pkt_write(struct rte_mbuf *pkt,
  * @param pipe
  *   Pipe ID within subport
  * @param traffic_class
- *   Traffic class ID within pipe (0 .. 3)
+ *   Traffic class ID within pipe (0 .. 12)
  * @param queue
- *   Queue ID within pipe traffic class (0 .. 3)
+ *   Queue ID within pipe traffic class (0 .. 15)
  *
  */
 void
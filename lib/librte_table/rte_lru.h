@@ -98,7 +98,7 @@ do {									\
 	x2 = (x << (48 - pos)) & (0xFFFFLLU << 48);			\
 	x = x0 | x1 | x2;						\
 									\
-	if (pos != 64)							\
+	if (pos < 48)							\
 		bucket->lru_list = x;					\
 } while (0)
 
@@ -75,8 +75,7 @@ do {									\
 	bucket->lru_list = vget_lane_u64(vreinterpret_u64_u16(		\
 				vsub_u16(vreinterpret_u16_u64(lru),	\
 					vreinterpret_u16_u64(vdec))),	\
-				0);					\
-	bucket->lru_list |= orvals[mru_val];				\
+				0) | orvals[mru_val];			\
 } while (0)
 
 #endif
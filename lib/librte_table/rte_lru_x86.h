@@ -83,8 +83,10 @@ do {									\
 	unsigned int pos = _mm_extract_epi16(d, 1);			\
 	/* move the recently used location to top of list */		\
 	__m128i k = _mm_shuffle_epi8(b, *((__m128i *) &masks[2 * pos]));\
-	/* Finally, update the original list with the reordered data */	\
-	bucket->lru_list = _mm_extract_epi64(k, 0);			\
+	/* Finally, update the original list with the reordered data, */\
+	/* unless it is already on top (no write to a shared line) */	\
+	if (pos != 3)							\
+		bucket->lru_list = _mm_extract_epi64(k, 0);		\
 	/* Phwew! */							\
 } while (0)
 
@@ -282,6 +282,33 @@ typedef int (*rte_table_op_stats_read)(
 	struct rte_table_stats *stats,
 	int clear);
 
+/**
+ * Lookup table reader enter
+ *
+ * Start a read-side section on the table for the calling thread. Until the
+ * matching reader exit, the entries returned by the lookup operations of
+ * this thread are not freed or reused by a concurrent entry delete or add,
+ * so the entry data can be accessed after the lookup, e.g. by the table
+ * actions. Sections can be nested. Only for the table types that support
+ * entry add and delete while the table is looked up.
+ *
+ * @param table
+ *   Handle to lookup table instance
+ */
+typedef void (*rte_table_op_reader_enter)(void *table);
+
+/**
+ * Lookup table reader exit
+ *
+ * End the read-side section started by the matching reader enter. The
+ * entries returned by the lookup operations run within the section must
+ * not be accessed after this call.
+ *
+ * @param table
+ *   Handle to lookup table instance
+ */
+typedef void (*rte_table_op_reader_exit)(void *table);
+
 /** Lookup table interface defining the lookup table operation */
 struct rte_table_ops {
 	rte_table_op_create f_create;                 /**< Create */
@@ -292,6 +319,8 @@ struct rte_table_ops {
 	rte_table_op_entry_delete_bulk f_delete_bulk; /**< Delete entry bulk */
 	rte_table_op_lookup f_lookup;                 /**< Lookup */
 	rte_table_op_stats_read f_stats;              /**< Stats */
+	rte_table_op_reader_enter f_reader_enter;     /**< Reader enter */
+	rte_table_op_reader_exit f_reader_exit;       /**< Reader exit */
 };
 
 #ifdef __cplusplus
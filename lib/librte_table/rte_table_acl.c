@@ -41,6 +41,7 @@
 #include <rte_log.h>
 
 #include "rte_table_acl.h"
+#include "table_sync.h"
 #include <rte_ether.h>
 
 #ifdef RTE_TABLE_STATS_COLLECT
@@ -59,6 +60,7 @@
 
 struct rte_table_acl {
 	struct rte_table_stats stats;
+	struct table_sync sync;
 
 	/* Low-level ACL table */
 	char name[2][RTE_ACL_NAMESIZE];
@@ -158,6 +160,7 @@ rte_table_acl_create(
 		p->n_rule_fields * sizeof(struct rte_acl_field_def));
 
 	acl->ctx = NULL;
+	table_sync_init(&acl->sync);
 
 	acl->n_rules = p->n_rules;
 	acl->entry_size = entry_size;
@@ -187,6 +190,23 @@ rte_table_acl_free(void *table)
 
 RTE_ACL_RULE_DEF(rte_pipeline_acl_rule, RTE_ACL_MAX_FIELDS);
 
+/*
+ * Publish the newly built low level ACL table. The previous one is freed once
+ * all the lookups that might still be using it are complete.
+ */
+static void
+rte_table_acl_commit(struct rte_table_acl *acl, struct rte_acl_ctx *ctx)
+{
+	struct rte_acl_ctx *ctx_old = acl->ctx;
+
+	rte_smp_wmb();
+	acl->ctx = ctx;
+	table_sync_wait_readers(&acl->sync);
+
+	if (ctx_old != NULL)
+		rte_acl_free(ctx_old);
+}
+
 static int
 rte_table_acl_build(struct rte_table_acl *acl, struct rte_acl_ctx **acl_ctx)
 {
@@ -349,12 +369,10 @@ rte_table_acl_entry_add(
 	}
 
 	/* Commit changes */
-	if (acl->ctx != NULL)
-		rte_acl_free(acl->ctx);
-	acl->ctx = ctx;
 	*key_found = 0;
 	*entry_ptr = &acl->memory[free_pos * acl->entry_size];
 	memcpy(*entry_ptr, entry, acl->entry_size);
+	rte_table_acl_commit(acl, ctx);
 
 	return 0;
 }
@@ -429,10 +447,7 @@ rte_table_acl_entry_delete(
 	}
 
 	/* Commit changes */
-	if (acl->ctx != NULL)
-		rte_acl_free(acl->ctx);
-
-	acl->ctx = ctx;
+	rte_table_acl_commit(acl, ctx);
 	*key_found = 1;
 	if (entry != NULL)
 		memcpy(entry, &acl->memory[pos * acl->entry_size],
@@ -612,10 +627,6 @@ rte_table_acl_entry_add_bulk(
 	}
 
 	/* Commit changes */
-	if (acl->ctx != NULL)
-		rte_acl_free(acl->ctx);
-	acl->ctx = ctx;
-
 	for (i = 0; i < n_keys; i++) {
 		if (rule_pos[i] == 0)
 			continue;
@@ -625,6 +636,8 @@ rte_table_acl_entry_add_bulk(
 		memcpy(entries_ptr[i], entries[i], acl->entry_size);
 	}
 
+	rte_table_acl_commit(acl, ctx);
+
 	return 0;
 }
 
@@ -731,10 +744,8 @@ rte_table_acl_entry_delete_bulk(
 	}
 
 	/* Commit changes */
-	if (acl->ctx != NULL)
-		rte_acl_free(acl->ctx);
+	rte_table_acl_commit(acl, ctx);
 
-	acl->ctx = ctx;
 	for (i = 0; i < n_keys; i++) {
 		if (rule_pos[i] == 0)
 			continue;
@@ -759,6 +770,7 @@ rte_table_acl_lookup(
 	struct rte_table_acl *acl = (struct rte_table_acl *) table;
 	const uint8_t *pkts_data[RTE_PORT_IN_BURST_SIZE_MAX];
 	uint32_t results[RTE_PORT_IN_BURST_SIZE_MAX];
+	struct rte_acl_ctx *ctx;
 	uint64_t pkts_out_mask;
 	uint32_t n_pkts, i, j;
 
@@ -778,10 +790,13 @@ rte_table_acl_lookup(
 	n_pkts = j;
 
 	/* Low-level ACL table lookup */
-	if (acl->ctx != NULL)
-		rte_acl_classify(acl->ctx, pkts_data, results, n_pkts, 1);
+	table_sync_reader_enter(&acl->sync);
+	ctx = acl->ctx;
+	if (ctx != NULL)
+		rte_acl_classify(ctx, pkts_data, results, n_pkts, 1);
 	else
 		n_pkts = 0;
+	table_sync_reader_exit(&acl->sync);
 
 	/* Output conversion */
 	pkts_out_mask = 0;
@@ -821,6 +836,22 @@ rte_table_acl_stats_read(void *table, struct rte_table_stats *stats, int clear)
 	return 0;
 }
 
+static void
+rte_table_acl_reader_enter(void *table)
+{
+	struct rte_table_acl *acl = table;
+
+	table_sync_reader_enter(&acl->sync);
+}
+
+static void
+rte_table_acl_reader_exit(void *table)
+{
+	struct rte_table_acl *acl = table;
+
+	table_sync_reader_exit(&acl->sync);
+}
+
 struct rte_table_ops rte_table_acl_ops = {
 	.f_create = rte_table_acl_create,
 	.f_free = rte_table_acl_free,
@@ -830,4 +861,6 @@ struct rte_table_ops rte_table_acl_ops = {
 	.f_delete_bulk = rte_table_acl_entry_delete_bulk,
 	.f_lookup = rte_table_acl_lookup,
 	.f_stats = rte_table_acl_stats_read,
+	.f_reader_enter = rte_table_acl_reader_enter,
+	.f_reader_exit = rte_table_acl_reader_exit,
 };
@@ -350,4 +350,6 @@ struct rte_table_ops rte_table_hash_cuckoo_ops = {
 	.f_delete_bulk = NULL,
 	.f_lookup = rte_table_hash_cuckoo_lookup,
 	.f_stats = rte_table_hash_cuckoo_stats_read,
+	.f_reader_enter = NULL,
+	.f_reader_exit = NULL,
 };
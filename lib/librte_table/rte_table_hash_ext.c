@@ -41,6 +41,7 @@
 #include <rte_log.h>
 
 #include "rte_table_hash.h"
+#include "table_sync.h"
 
 #define KEYS_PER_BUCKET	4
 
@@ -97,6 +98,7 @@ struct grinder {
 
 struct rte_table_hash {
 	struct rte_table_stats stats;
+	struct table_sync sync;
 
 	/* Input parameters */
 	uint32_t key_size;
@@ -115,9 +117,6 @@ struct rte_table_hash {
 	uint32_t key_stack_tos;
 	uint32_t bkt_ext_stack_tos;
 
-	/* Grinder */
-	struct grinder grinders[RTE_PORT_IN_BURST_SIZE_MAX];
-
 	/* Tables */
 	uint64_t *key_mask;
 	struct bucket *buckets;
@@ -270,6 +269,7 @@ rte_table_hash_ext_create(void *params, int socket_id, uint32_t entry_size)
 	t->n_buckets_ext = n_buckets_ext;
 	t->f_hash = p->f_hash;
 	t->seed = p->seed;
+	table_sync_init(&t->sync);
 	t->key_offset = p->key_offset;
 
 	/* Internal */
@@ -383,10 +383,11 @@ rte_table_hash_ext_entry_add(void *table, void *key, void *entry,
 				data = &t->data_mem[bkt_key_index <<
 					t->data_size_shl];
 
-				bkt->sig[i] = (uint16_t) sig;
-				bkt->key_pos[i] = bkt_key_index;
 				keycpy(bkt_key, key, t->key_mask, t->key_size);
 				memcpy(data, entry, t->entry_size);
+				bkt->key_pos[i] = bkt_key_index;
+				rte_smp_wmb();
+				bkt->sig[i] = (uint16_t) sig;
 
 				*key_found = 0;
 				*entry_ptr = (void *) data;
@@ -403,10 +404,6 @@ rte_table_hash_ext_entry_add(void *table, void *key, void *entry,
 		bkt_index = t->bkt_ext_stack[--t->bkt_ext_stack_tos];
 		bkt = &t->buckets_ext[bkt_index];
 
-		/* Chain the new bucket ext */
-		BUCKET_NEXT_SET(bkt_prev, bkt);
-		BUCKET_NEXT_SET_NULL(bkt);
-
 		/* Allocate new key */
 		bkt_key_index = t->key_stack[--t->key_stack_tos];
 		bkt_key = &t->key_mem[bkt_key_index << t->key_size_shl];
@@ -414,10 +411,15 @@ rte_table_hash_ext_entry_add(void *table, void *key, void *entry,
 		data = &t->data_mem[bkt_key_index << t->data_size_shl];
 
 		/* Install new key into bucket */
-		bkt->sig[0] = (uint16_t) sig;
-		bkt->key_pos[0] = bkt_key_index;
 		keycpy(bkt_key, key, t->key_mask, t->key_size);
 		memcpy(data, entry, t->entry_size);
+		BUCKET_NEXT_SET_NULL(bkt);
+		bkt->key_pos[0] = bkt_key_index;
+		bkt->sig[0] = (uint16_t) sig;
+
+		/* Chain the new bucket ext */
+		rte_smp_wmb();
+		BUCKET_NEXT_SET(bkt_prev, bkt);
 
 		*key_found = 0;
 		*entry_ptr = (void *) data;
@@ -435,6 +437,7 @@ void *entry)
 	struct bucket *bkt0, *bkt, *bkt_prev;
 	uint64_t sig;
 	uint32_t bkt_index, i;
+	int bkt_unused;
 
 	sig = t->f_hash(key, t->key_mask, t->key_size, t->seed);
 	bkt_index = sig & t->bucket_mask;
@@ -461,17 +464,26 @@ void *entry)
 				if (entry)
 					memcpy(entry, data, t->entry_size);
 
-				/* Free key */
-				t->key_stack[t->key_stack_tos++] =
-					bkt_key_index;
-
 				/*Check if bucket is unused */
-				if ((bkt_prev != NULL) &&
+				bkt_unused = (bkt_prev != NULL) &&
 				    (bkt->sig[0] == 0) && (bkt->sig[1] == 0) &&
-				    (bkt->sig[2] == 0) && (bkt->sig[3] == 0)) {
-					/* Unchain bucket */
+				    (bkt->sig[2] == 0) && (bkt->sig[3] == 0);
+
+				/*
+				 * Unchain bucket. Lookups walking through it
+				 * still find the rest of the chain.
+				 */
+				if (bkt_unused)
 					BUCKET_NEXT_COPY(bkt_prev, bkt);
 
+				/* Wait for the lookups using key or bucket */
+				table_sync_wait_readers(&t->sync);
+
+				/* Free key */
+				t->key_stack[t->key_stack_tos++] =
+					bkt_key_index;
+
+				if (bkt_unused) {
 					/* Clear bucket */
 					memset(bkt, 0, sizeof(struct bucket));
 
@@ -500,8 +512,6 @@ static int rte_table_hash_ext_lookup_unoptimized(
 	struct rte_table_hash *t = (struct rte_table_hash *) table;
 	uint64_t pkts_mask_out = 0;
 
-	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
-
 	for ( ; pkts_mask; ) {
 		struct bucket *bkt0, *bkt;
 		struct rte_mbuf *pkt;
@@ -525,8 +535,12 @@ static int rte_table_hash_ext_lookup_unoptimized(
 		for (bkt = bkt0; bkt != NULL; bkt = BUCKET_NEXT(bkt))
 			for (i = 0; i < KEYS_PER_BUCKET; i++) {
 				uint64_t bkt_sig = (uint64_t) bkt->sig[i];
-				uint32_t bkt_key_index = bkt->key_pos[i];
-				uint8_t *bkt_key = &t->key_mem[bkt_key_index <<
+				uint32_t bkt_key_index;
+				uint8_t *bkt_key;
+
+				rte_smp_rmb();
+				bkt_key_index = bkt->key_pos[i];
+				bkt_key = &t->key_mem[bkt_key_index <<
 					t->key_size_shl];
 
 				if ((sig == bkt_sig) && (keycmp(bkt_key, key,
@@ -598,6 +612,7 @@ static int rte_table_hash_ext_lookup_unoptimized(
 	bucket_sig[1] = bucket->sig[1];					\
 	bucket_sig[2] = bucket->sig[2];					\
 	bucket_sig[3] = bucket->sig[3];					\
+	rte_smp_rmb();							\
 									\
 	bucket_sig[0] ^= mbuf_sig;					\
 	bucket_sig[1] ^= mbuf_sig;					\
@@ -877,31 +892,24 @@ static int rte_table_hash_ext_lookup_unoptimized(
 *    pXY = packet Y of stage X, X = 0 .. 3, Y = 0 .. 1
 *
 ***/
-static int rte_table_hash_ext_lookup(
-	void *table,
+static inline int
+lookup_ext(
+	struct rte_table_hash *t,
 	struct rte_mbuf **pkts,
 	uint64_t pkts_mask,
 	uint64_t *lookup_hit_mask,
 	void **entries)
 {
-	struct rte_table_hash *t = (struct rte_table_hash *) table;
-	struct grinder *g = t->grinders;
+	struct grinder g[RTE_PORT_IN_BURST_SIZE_MAX];
 	uint64_t pkt00_index, pkt01_index, pkt10_index, pkt11_index;
 	uint64_t pkt20_index, pkt21_index, pkt30_index, pkt31_index;
 	uint64_t pkts_mask_out = 0, pkts_mask_match_many = 0;
 	int status = 0;
 
-	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
-	RTE_TABLE_HASH_EXT_STATS_PKTS_IN_ADD(t, n_pkts_in);
-
 	/* Cannot run the pipeline with less than 7 packets */
-	if (__builtin_popcountll(pkts_mask) < 7) {
-		status = rte_table_hash_ext_lookup_unoptimized(table, pkts,
+	if (__builtin_popcountll(pkts_mask) < 7)
+		return rte_table_hash_ext_lookup_unoptimized(t, pkts,
 			pkts_mask, lookup_hit_mask, entries);
-		RTE_TABLE_HASH_EXT_STATS_PKTS_LOOKUP_MISS(t, n_pkts_in -
-				__builtin_popcountll(*lookup_hit_mask));
-		return status;
-	}
 
 	/* Pipeline stage 0 */
 	lookup2_stage0(t, g, pkts, pkts_mask, pkt00_index, pkt01_index);
@@ -1004,13 +1012,35 @@ static int rte_table_hash_ext_lookup(
 	if (pkts_mask_match_many) {
 		uint64_t pkts_mask_out_slow = 0;
 
-		status = rte_table_hash_ext_lookup_unoptimized(table, pkts,
+		status = rte_table_hash_ext_lookup_unoptimized(t, pkts,
 			pkts_mask_match_many, &pkts_mask_out_slow, entries);
 		pkts_mask_out |= pkts_mask_out_slow;
 	}
 
 	*lookup_hit_mask = pkts_mask_out;
-	RTE_TABLE_HASH_EXT_STATS_PKTS_LOOKUP_MISS(t, n_pkts_in - __builtin_popcountll(pkts_mask_out));
+	return status;
+}
+
+static int rte_table_hash_ext_lookup(
+	void *table,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	uint64_t *lookup_hit_mask,
+	void **entries)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+	int status;
+
+	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
+	RTE_TABLE_HASH_EXT_STATS_PKTS_IN_ADD(t, n_pkts_in);
+
+	table_sync_reader_enter(&t->sync);
+	status = lookup_ext(t, pkts, pkts_mask, lookup_hit_mask,
+		entries);
+	table_sync_reader_exit(&t->sync);
+
+	RTE_TABLE_HASH_EXT_STATS_PKTS_LOOKUP_MISS(t, n_pkts_in -
+		__builtin_popcountll(*lookup_hit_mask));
 	return status;
 }
 
@@ -1028,6 +1058,22 @@ rte_table_hash_ext_stats_read(void *table, struct rte_table_stats *stats, int cl
 	return 0;
 }
 
+static void
+rte_table_hash_ext_reader_enter(void *table)
+{
+	struct rte_table_hash *t = table;
+
+	table_sync_reader_enter(&t->sync);
+}
+
+static void
+rte_table_hash_ext_reader_exit(void *table)
+{
+	struct rte_table_hash *t = table;
+
+	table_sync_reader_exit(&t->sync);
+}
+
 struct rte_table_ops rte_table_hash_ext_ops	 = {
 	.f_create = rte_table_hash_ext_create,
 	.f_free = rte_table_hash_ext_free,
@@ -1037,4 +1083,6 @@ struct rte_table_ops rte_table_hash_ext_ops	 = {
 	.f_delete_bulk = NULL,
 	.f_lookup = rte_table_hash_ext_lookup,
 	.f_stats = rte_table_hash_ext_stats_read,
+	.f_reader_enter = rte_table_hash_ext_reader_enter,
+	.f_reader_exit = rte_table_hash_ext_reader_exit,
 };
@@ -41,6 +41,7 @@
 
 #include "rte_table_hash.h"
 #include "rte_lru.h"
+#include "table_sync.h"
 
 #define KEY_SIZE						32
 
@@ -78,6 +79,7 @@ struct rte_bucket_4_32 {
 
 struct rte_table_hash {
 	struct rte_table_stats stats;
+	struct table_sync sync;
 
 	/* Input parameters */
 	uint32_t n_buckets;
@@ -120,6 +122,12 @@ keycpy(void *dst, void *src, void *src_mask)
 	dst64[3] = src64[3] & src_mask64[3];
 }
 
+static inline struct rte_bucket_4_32 *
+bucket_next_get(struct rte_bucket_4_32 *bucket)
+{
+	return bucket->next_valid ? bucket->next : NULL;
+}
+
 static int
 check_params_create(struct rte_table_hash_params *params)
 {
@@ -227,6 +235,7 @@ rte_table_hash_create_key32_lru(void *params,
 	f->key_offset = p->key_offset;
 	f->f_hash = p->f_hash;
 	f->seed = p->seed;
+	table_sync_init(&f->sync);
 
 	if (p->key_mask != NULL) {
 		f->key_mask[0] = ((uint64_t *)p->key_mask)[0];
@@ -310,9 +319,10 @@ rte_table_hash_entry_add_key32_lru(
 		if (bucket_signature == 0) {
 			uint8_t *bucket_data = &bucket->data[i * f->entry_size];
 
-			bucket->signature[i] = signature;
 			keycpy(bucket_key, key, f->key_mask);
 			memcpy(bucket_data, entry, f->entry_size);
+			rte_smp_wmb();
+			bucket->signature[i] = signature;
 			lru_update(bucket, i);
 			*key_found = 0;
 			*entry_ptr = (void *) bucket_data;
@@ -321,11 +331,14 @@ rte_table_hash_entry_add_key32_lru(
 		}
 	}
 
-	/* Bucket full: replace LRU entry */
+	/* Bucket full: replace LRU entry once no lookup is using it */
 	pos = lru_pos(bucket);
-	bucket->signature[pos] = signature;
+	bucket->signature[pos] = 0;
+	table_sync_wait_readers(&f->sync);
 	keycpy(&bucket->key[pos], key, f->key_mask);
 	memcpy(&bucket->data[pos * f->entry_size], entry, f->entry_size);
+	rte_smp_wmb();
+	bucket->signature[pos] = signature;
 	lru_update(bucket, pos);
 	*key_found = 0;
 	*entry_ptr = (void *) &bucket->data[pos * f->entry_size];
@@ -361,6 +374,7 @@ rte_table_hash_entry_delete_key32_lru(
 			uint8_t *bucket_data = &bucket->data[i * f->entry_size];
 
 			bucket->signature[i] = 0;
+			table_sync_wait_readers(&f->sync);
 			*key_found = 1;
 			if (entry)
 				memcpy(entry, bucket_data, f->entry_size);
@@ -443,6 +457,7 @@ rte_table_hash_create_key32_ext(void *params,
 	f->key_offset = p->key_offset;
 	f->f_hash = p->f_hash;
 	f->seed = p->seed;
+	table_sync_init(&f->sync);
 
 	f->n_buckets_ext = n_buckets_ext;
 	f->stack_pos = n_buckets_ext;
@@ -502,7 +517,7 @@ rte_table_hash_entry_add_key32_ext(
 	signature |= RTE_BUCKET_ENTRY_VALID;
 
 	/* Key is present in the bucket */
-	for (bucket = bucket0; bucket != NULL; bucket = bucket->next) {
+	for (bucket = bucket0; bucket != NULL; bucket = bucket_next_get(bucket)) {
 		for (i = 0; i < 4; i++) {
 			uint64_t bucket_signature = bucket->signature[i];
 			uint8_t *bucket_key = (uint8_t *) &bucket->key[i];
@@ -523,7 +538,7 @@ rte_table_hash_entry_add_key32_ext(
 
 	/* Key is not present in the bucket */
 	for (bucket_prev = NULL, bucket = bucket0; bucket != NULL;
-		bucket_prev = bucket, bucket = bucket->next)
+		bucket_prev = bucket, bucket = bucket_next_get(bucket))
 		for (i = 0; i < 4; i++) {
 			uint64_t bucket_signature = bucket->signature[i];
 			uint8_t *bucket_key = (uint8_t *) &bucket->key[i];
@@ -532,9 +547,10 @@ rte_table_hash_entry_add_key32_ext(
 				uint8_t *bucket_data = &bucket->data[i *
 					f->entry_size];
 
-				bucket->signature[i] = signature;
 				keycpy(bucket_key, key, f->key_mask);
 				memcpy(bucket_data, entry, f->entry_size);
+				rte_smp_wmb();
+				bucket->signature[i] = signature;
 				*key_found = 0;
 				*entry_ptr = (void *) bucket_data;
 
@@ -549,12 +565,19 @@ rte_table_hash_entry_add_key32_ext(
 		bucket = (struct rte_bucket_4_32 *)
 			&f->memory[(f->n_buckets + bucket_index) *
 			f->bucket_size];
-		bucket_prev->next = bucket;
-		bucket_prev->next_valid = 1;
 
-		bucket->signature[0] = signature;
+		/*
+		 * The new bucket is fully set up before being linked, the link
+		 * pointer is set before the link valid flag.
+		 */
 		keycpy(&bucket->key[0], key, f->key_mask);
 		memcpy(&bucket->data[0], entry, f->entry_size);
+		bucket->signature[0] = signature;
+		bucket->next_valid = 0;
+		rte_smp_wmb();
+		bucket_prev->next = bucket;
+		rte_smp_wmb();
+		bucket_prev->next_valid = 1;
 		*key_found = 0;
 		*entry_ptr = (void *) &bucket->data[0];
 		return 0;
@@ -583,7 +606,7 @@ rte_table_hash_entry_delete_key32_ext(
 
 	/* Key is present in the bucket */
 	for (bucket_prev = NULL, bucket = bucket0; bucket != NULL;
-		bucket_prev = bucket, bucket = bucket->next)
+		bucket_prev = bucket, bucket = bucket_next_get(bucket))
 		for (i = 0; i < 4; i++) {
 			uint64_t bucket_signature = bucket->signature[i];
 			uint8_t *bucket_key = (uint8_t *) &bucket->key[i];
@@ -598,21 +621,29 @@ rte_table_hash_entry_delete_key32_ext(
 				if (entry)
 					memcpy(entry, bucket_data, f->entry_size);
 
+				/*
+				 * Unlink empty bucket. Lookups may still be
+				 * walking through it, so its next pointer is
+				 * kept until they are done with it and no link
+				 * pointer is ever cleared.
+				 */
 				if ((bucket->signature[0] == 0) &&
 					(bucket->signature[1] == 0) &&
 					(bucket->signature[2] == 0) &&
 					(bucket->signature[3] == 0) &&
 					(bucket_prev != NULL)) {
-					bucket_prev->next = bucket->next;
+					if (bucket->next_valid)
+						bucket_prev->next = bucket->next;
+					rte_smp_wmb();
 					bucket_prev->next_valid =
 						bucket->next_valid;
-
-					memset(bucket, 0,
-						sizeof(struct rte_bucket_4_32));
+					table_sync_wait_readers(&f->sync);
+					bucket->next_valid = 0;
 					bucket_index = (((uint8_t *)bucket -
 						(uint8_t *)f->memory)/f->bucket_size) - f->n_buckets;
 					f->stack[f->stack_pos++] = bucket_index;
-				}
+				} else
+					table_sync_wait_readers(&f->sync);
 
 				return 0;
 			}
@@ -636,6 +667,7 @@ rte_table_hash_entry_delete_key32_ext(
 	signature[1] = ((~bucket->signature[1]) & 1);		\
 	signature[2] = ((~bucket->signature[2]) & 1);		\
 	signature[3] = ((~bucket->signature[3]) & 1);		\
+	rte_smp_rmb();						\
 								\
 	xor[0][0] = k[0] ^ bucket->key[0][0];			\
 	xor[0][1] = k[1] ^ bucket->key[0][1];			\
@@ -744,6 +776,7 @@ rte_table_hash_entry_delete_key32_ext(
 								\
 	bucket_mask = (~pkt_mask) & (bucket2->next_valid << pkt2_index);\
 	buckets_mask |= bucket_mask;				\
+	rte_smp_rmb();						\
 	bucket_next = bucket2->next;				\
 	buckets[pkt2_index] = bucket_next;			\
 	keys[pkt2_index] = key;					\
@@ -772,6 +805,7 @@ rte_table_hash_entry_delete_key32_ext(
 								\
 	bucket_mask = (~pkt_mask) & (bucket->next_valid << pkt_index);\
 	buckets_mask |= bucket_mask;				\
+	rte_smp_rmb();						\
 	bucket_next = bucket->next;				\
 	rte_prefetch0(bucket_next);				\
 	rte_prefetch0((void *)(((uintptr_t) bucket_next) + RTE_CACHE_LINE_SIZE));\
@@ -910,6 +944,7 @@ rte_table_hash_entry_delete_key32_ext(
 	bucket20_mask = (~pkt20_mask) & (bucket20->next_valid << pkt20_index);\
 	bucket21_mask = (~pkt21_mask) & (bucket21->next_valid << pkt21_index);\
 	buckets_mask |= bucket20_mask | bucket21_mask;		\
+	rte_smp_rmb();						\
 	bucket20_next = bucket20->next;				\
 	bucket21_next = bucket21->next;				\
 	buckets[pkt20_index] = bucket20_next;			\
@@ -918,24 +953,20 @@ rte_table_hash_entry_delete_key32_ext(
 	keys[pkt21_index] = key21;				\
 }
 
-static int
-rte_table_hash_lookup_key32_lru(
-	void *table,
+static inline void
+lookup_key32_lru(
+	struct rte_table_hash *f,
 	struct rte_mbuf **pkts,
 	uint64_t pkts_mask,
 	uint64_t *lookup_hit_mask,
 	void **entries)
 {
-	struct rte_table_hash *f = (struct rte_table_hash *) table;
 	struct rte_bucket_4_32 *bucket10, *bucket11, *bucket20, *bucket21;
 	struct rte_mbuf *mbuf00, *mbuf01, *mbuf10, *mbuf11, *mbuf20, *mbuf21;
 	uint32_t pkt00_index, pkt01_index, pkt10_index;
 	uint32_t pkt11_index, pkt20_index, pkt21_index;
 	uint64_t pkts_mask_out = 0;
 
-	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
-	RTE_TABLE_HASH_KEY32_STATS_PKTS_IN_ADD(f, n_pkts_in);
-
 	/* Cannot run the pipeline with less than 5 packets */
 	if (__builtin_popcountll(pkts_mask) < 5) {
 		for ( ; pkts_mask; ) {
@@ -950,8 +981,7 @@ rte_table_hash_lookup_key32_lru(
 		}
 
 		*lookup_hit_mask = pkts_mask_out;
-		RTE_TABLE_HASH_KEY32_STATS_PKTS_LOOKUP_MISS(f, n_pkts_in - __builtin_popcountll(pkts_mask_out));
-		return 0;
+		return;
 	}
 
 	/*
@@ -1041,12 +1071,10 @@ rte_table_hash_lookup_key32_lru(
 		mbuf20, mbuf21, bucket20, bucket21, pkts_mask_out, entries, f);
 
 	*lookup_hit_mask = pkts_mask_out;
-	RTE_TABLE_HASH_KEY32_STATS_PKTS_LOOKUP_MISS(f, n_pkts_in - __builtin_popcountll(pkts_mask_out));
-	return 0;
-} /* rte_table_hash_lookup_key32_lru() */
+} /* lookup_key32_lru() */
 
 static int
-rte_table_hash_lookup_key32_ext(
+rte_table_hash_lookup_key32_lru(
 	void *table,
 	struct rte_mbuf **pkts,
 	uint64_t pkts_mask,
@@ -1054,6 +1082,27 @@ rte_table_hash_lookup_key32_ext(
 	void **entries)
 {
 	struct rte_table_hash *f = (struct rte_table_hash *) table;
+
+	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
+	RTE_TABLE_HASH_KEY32_STATS_PKTS_IN_ADD(f, n_pkts_in);
+
+	table_sync_reader_enter(&f->sync);
+	lookup_key32_lru(f, pkts, pkts_mask, lookup_hit_mask, entries);
+	table_sync_reader_exit(&f->sync);
+
+	RTE_TABLE_HASH_KEY32_STATS_PKTS_LOOKUP_MISS(f, n_pkts_in -
+		__builtin_popcountll(*lookup_hit_mask));
+	return 0;
+}
+
+static inline void
+lookup_key32_ext(
+	struct rte_table_hash *f,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	uint64_t *lookup_hit_mask,
+	void **entries)
+{
 	struct rte_bucket_4_32 *bucket10, *bucket11, *bucket20, *bucket21;
 	struct rte_mbuf *mbuf00, *mbuf01, *mbuf10, *mbuf11, *mbuf20, *mbuf21;
 	uint32_t pkt00_index, pkt01_index, pkt10_index;
@@ -1062,9 +1111,6 @@ rte_table_hash_lookup_key32_ext(
 	struct rte_bucket_4_32 *buckets[RTE_PORT_IN_BURST_SIZE_MAX];
 	uint64_t *keys[RTE_PORT_IN_BURST_SIZE_MAX];
 
-	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
-	RTE_TABLE_HASH_KEY32_STATS_PKTS_IN_ADD(f, n_pkts_in);
-
 	/* Cannot run the pipeline with less than 5 packets */
 	if (__builtin_popcountll(pkts_mask) < 5) {
 		for ( ; pkts_mask; ) {
@@ -1191,9 +1237,29 @@ rte_table_hash_lookup_key32_ext(
 	}
 
 	*lookup_hit_mask = pkts_mask_out;
-	RTE_TABLE_HASH_KEY32_STATS_PKTS_LOOKUP_MISS(f, n_pkts_in - __builtin_popcountll(pkts_mask_out));
+} /* lookup_key32_ext() */
+
+static int
+rte_table_hash_lookup_key32_ext(
+	void *table,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	uint64_t *lookup_hit_mask,
+	void **entries)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+
+	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
+	RTE_TABLE_HASH_KEY32_STATS_PKTS_IN_ADD(f, n_pkts_in);
+
+	table_sync_reader_enter(&f->sync);
+	lookup_key32_ext(f, pkts, pkts_mask, lookup_hit_mask, entries);
+	table_sync_reader_exit(&f->sync);
+
+	RTE_TABLE_HASH_KEY32_STATS_PKTS_LOOKUP_MISS(f, n_pkts_in -
+		__builtin_popcountll(*lookup_hit_mask));
 	return 0;
-} /* rte_table_hash_lookup_key32_ext() */
+}
 
 static int
 rte_table_hash_key32_stats_read(void *table, struct rte_table_stats *stats, int clear)
@@ -1209,6 +1275,22 @@ rte_table_hash_key32_stats_read(void *table, struct rte_table_stats *stats, int
 	return 0;
 }
 
+static void
+rte_table_hash_key32_reader_enter(void *table)
+{
+	struct rte_table_hash *t = table;
+
+	table_sync_reader_enter(&t->sync);
+}
+
+static void
+rte_table_hash_key32_reader_exit(void *table)
+{
+	struct rte_table_hash *t = table;
+
+	table_sync_reader_exit(&t->sync);
+}
+
 struct rte_table_ops rte_table_hash_key32_lru_ops = {
 	.f_create = rte_table_hash_create_key32_lru,
 	.f_free = rte_table_hash_free_key32_lru,
@@ -1218,6 +1300,8 @@ struct rte_table_ops rte_table_hash_key32_lru_ops = {
 	.f_delete_bulk = NULL,
 	.f_lookup = rte_table_hash_lookup_key32_lru,
 	.f_stats = rte_table_hash_key32_stats_read,
+	.f_reader_enter = rte_table_hash_key32_reader_enter,
+	.f_reader_exit = rte_table_hash_key32_reader_exit,
 };
 
 struct rte_table_ops rte_table_hash_key32_ext_ops = {
@@ -1229,4 +1313,6 @@ struct rte_table_ops rte_table_hash_key32_ext_ops = {
 	.f_delete_bulk = NULL,
 	.f_lookup = rte_table_hash_lookup_key32_ext,
 	.f_stats = rte_table_hash_key32_stats_read,
+	.f_reader_enter = rte_table_hash_key32_reader_enter,
+	.f_reader_exit = rte_table_hash_key32_reader_exit,
 };
@@ -41,6 +41,7 @@
 
 #include "rte_table_hash.h"
 #include "rte_lru.h"
+#include "table_sync.h"
 
 #define KEY_SIZE						8
 
@@ -75,6 +76,7 @@ struct rte_bucket_4_8 {
 
 struct rte_table_hash {
 	struct rte_table_stats stats;
+	struct table_sync sync;
 
 	/* Input parameters */
 	uint32_t n_buckets;
@@ -111,6 +113,12 @@ keycpy(void *dst, void *src, void *src_mask)
 	dst64[0] = src64[0] & src_mask64[0];
 }
 
+static inline struct rte_bucket_4_8 *
+bucket_next_get(struct rte_bucket_4_8 *bucket)
+{
+	return bucket->next_valid ? bucket->next : NULL;
+}
+
 static int
 check_params_create(struct rte_table_hash_params *params)
 {
@@ -217,6 +225,7 @@ rte_table_hash_create_key8_lru(void *params, int socket_id, uint32_t entry_size)
 	f->key_offset = p->key_offset;
 	f->f_hash = p->f_hash;
 	f->seed = p->seed;
+	table_sync_init(&f->sync);
 
 	if (p->key_mask != NULL)
 		f->key_mask = ((uint64_t *)p->key_mask)[0];
@@ -291,9 +300,10 @@ rte_table_hash_entry_add_key8_lru(
 		if ((bucket_signature & mask) == 0) {
 			uint8_t *bucket_data = &bucket->data[i * f->entry_size];
 
-			bucket->signature |= mask;
 			keycpy(&bucket->key[i], key, &f->key_mask);
 			memcpy(bucket_data, entry, f->entry_size);
+			rte_smp_wmb();
+			bucket->signature |= mask;
 			lru_update(bucket, i);
 			*key_found = 0;
 			*entry_ptr = (void *) bucket_data;
@@ -302,10 +312,14 @@ rte_table_hash_entry_add_key8_lru(
 		}
 	}
 
-	/* Bucket full: replace LRU entry */
+	/* Bucket full: replace LRU entry once no lookup is using it */
 	pos = lru_pos(bucket);
+	bucket->signature &= ~(1LLU << pos);
+	table_sync_wait_readers(&f->sync);
 	keycpy(&bucket->key[pos], key, &f->key_mask);
 	memcpy(&bucket->data[pos * f->entry_size], entry, f->entry_size);
+	rte_smp_wmb();
+	bucket->signature |= 1LLU << pos;
 	lru_update(bucket, pos);
 	*key_found = 0;
 	*entry_ptr = (void *) &bucket->data[pos * f->entry_size];
@@ -340,6 +354,7 @@ rte_table_hash_entry_delete_key8_lru(
 			uint8_t *bucket_data = &bucket->data[i * f->entry_size];
 
 			bucket->signature &= ~mask;
+			table_sync_wait_readers(&f->sync);
 			*key_found = 1;
 			if (entry)
 				memcpy(entry, bucket_data, f->entry_size);
@@ -421,6 +436,7 @@ rte_table_hash_create_key8_ext(void *params, int socket_id, uint32_t entry_size)
 	f->key_offset = p->key_offset;
 	f->f_hash = p->f_hash;
 	f->seed = p->seed;
+	table_sync_init(&f->sync);
 
 	f->n_buckets_ext = n_buckets_ext;
 	f->stack_pos = n_buckets_ext;
@@ -472,7 +488,7 @@ rte_table_hash_entry_add_key8_ext(
 		&f->memory[bucket_index * f->bucket_size];
 
 	/* Key is present in the bucket */
-	for (bucket = bucket0; bucket != NULL; bucket = bucket->next) {
+	for (bucket = bucket0; bucket != NULL; bucket = bucket_next_get(bucket)) {
 		uint64_t mask;
 
 		for (i = 0, mask = 1LLU; i < 4; i++, mask <<= 1) {
@@ -494,7 +510,7 @@ rte_table_hash_entry_add_key8_ext(
 
 	/* Key is not present in the bucket */
 	for (bucket_prev = NULL, bucket = bucket0;
-		bucket != NULL; bucket_prev = bucket, bucket = bucket->next) {
+		bucket != NULL; bucket_prev = bucket, bucket = bucket_next_get(bucket)) {
 		uint64_t mask;
 
 		for (i = 0, mask = 1LLU; i < 4; i++, mask <<= 1) {
@@ -504,9 +520,10 @@ rte_table_hash_entry_add_key8_ext(
 				uint8_t *bucket_data = &bucket->data[i *
 					f->entry_size];
 
-				bucket->signature |= mask;
 				keycpy(&bucket->key[i], key, &f->key_mask);
 				memcpy(bucket_data, entry, f->entry_size);
+				rte_smp_wmb();
+				bucket->signature |= mask;
 				*key_found = 0;
 				*entry_ptr = (void *) bucket_data;
 
@@ -521,12 +538,19 @@ rte_table_hash_entry_add_key8_ext(
 
 		bucket = (struct rte_bucket_4_8 *) &f->memory[(f->n_buckets +
 			bucket_index) * f->bucket_size];
-		bucket_prev->next = bucket;
-		bucket_prev->next_valid = 1;
 
-		bucket->signature = 1;
+		/*
+		 * The new bucket is fully set up before being linked, the link
+		 * pointer is set before the link valid flag.
+		 */
 		keycpy(&bucket->key[0], key, &f->key_mask);
 		memcpy(&bucket->data[0], entry, f->entry_size);
+		bucket->signature = 1;
+		bucket->next_valid = 0;
+		rte_smp_wmb();
+		bucket_prev->next = bucket;
+		rte_smp_wmb();
+		bucket_prev->next_valid = 1;
 		*key_found = 0;
 		*entry_ptr = (void *) &bucket->data[0];
 		return 0;
@@ -554,7 +578,7 @@ rte_table_hash_entry_delete_key8_ext(
 
 	/* Key is present in the bucket */
 	for (bucket_prev = NULL, bucket = bucket0; bucket != NULL;
-		bucket_prev = bucket, bucket = bucket->next) {
+		bucket_prev = bucket, bucket = bucket_next_get(bucket)) {
 		uint64_t mask;
 
 		for (i = 0, mask = 1LLU; i < 4; i++, mask <<= 1) {
@@ -572,18 +596,27 @@ rte_table_hash_entry_delete_key8_ext(
 					memcpy(entry, bucket_data,
 						f->entry_size);
 
+				/*
+				 * Unlink empty bucket. Lookups may still be
+				 * walking through it, so its next pointer is
+				 * kept until they are done with it and no link
+				 * pointer is ever cleared.
+				 */
 				if ((bucket->signature == 0) &&
 				    (bucket_prev != NULL)) {
-					bucket_prev->next = bucket->next;
+					if (bucket->next_valid)
+						bucket_prev->next = bucket->next;
+					rte_smp_wmb();
 					bucket_prev->next_valid =
 						bucket->next_valid;
+					table_sync_wait_readers(&f->sync);
+					bucket->next_valid = 0;
 
-					memset(bucket, 0,
-						sizeof(struct rte_bucket_4_8));
 					bucket_index = (((uint8_t *)bucket -
 						(uint8_t *)f->memory)/f->bucket_size) - f->n_buckets;
 					f->stack[f->stack_pos++] = bucket_index;
-				}
+				} else
+					table_sync_wait_readers(&f->sync);
 
 				return 0;
 			}
@@ -600,6 +633,7 @@ rte_table_hash_entry_delete_key8_ext(
 	uint64_t xor[4], signature, k;				\
 								\
 	signature = ~bucket->signature;				\
+	rte_smp_rmb();						\
 								\
 	k = key_in[0] & f->key_mask;				\
 	xor[0] = (k ^ bucket->key[0]) | (signature & 1);		\
@@ -686,6 +720,7 @@ rte_table_hash_entry_delete_key8_ext(
 								\
 	bucket_mask = (~pkt_mask) & (bucket2->next_valid << pkt2_index);\
 	buckets_mask |= bucket_mask;				\
+	rte_smp_rmb();						\
 	bucket_next = bucket2->next;				\
 	buckets[pkt2_index] = bucket_next;			\
 	keys[pkt2_index] = key;					\
@@ -713,6 +748,7 @@ rte_table_hash_entry_delete_key8_ext(
 								\
 	bucket_mask = (~pkt_mask) & (bucket->next_valid << pkt_index);\
 	buckets_mask |= bucket_mask;				\
+	rte_smp_rmb();						\
 	bucket_next = bucket->next;				\
 	rte_prefetch0(bucket_next);				\
 	buckets[pkt_index] = bucket_next;			\
@@ -846,6 +882,7 @@ rte_table_hash_entry_delete_key8_ext(
 	bucket20_mask = (~pkt20_mask) & (bucket20->next_valid << pkt20_index);\
 	bucket21_mask = (~pkt21_mask) & (bucket21->next_valid << pkt21_index);\
 	buckets_mask |= bucket20_mask | bucket21_mask;		\
+	rte_smp_rmb();						\
 	bucket20_next = bucket20->next;				\
 	bucket21_next = bucket21->next;				\
 	buckets[pkt20_index] = bucket20_next;			\
@@ -854,24 +891,20 @@ rte_table_hash_entry_delete_key8_ext(
 	keys[pkt21_index] = key21;				\
 }
 
-static int
-rte_table_hash_lookup_key8_lru(
-	void *table,
+static inline void
+lookup_key8_lru(
+	struct rte_table_hash *f,
 	struct rte_mbuf **pkts,
 	uint64_t pkts_mask,
 	uint64_t *lookup_hit_mask,
 	void **entries)
 {
-	struct rte_table_hash *f = (struct rte_table_hash *) table;
 	struct rte_bucket_4_8 *bucket10, *bucket11, *bucket20, *bucket21;
 	struct rte_mbuf *mbuf00, *mbuf01, *mbuf10, *mbuf11, *mbuf20, *mbuf21;
 	uint32_t pkt00_index, pkt01_index, pkt10_index;
 	uint32_t pkt11_index, pkt20_index, pkt21_index;
 	uint64_t pkts_mask_out = 0;
 
-	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
-	RTE_TABLE_HASH_KEY8_STATS_PKTS_IN_ADD(f, n_pkts_in);
-
 	/* Cannot run the pipeline with less than 5 packets */
 	if (__builtin_popcountll(pkts_mask) < 5) {
 		for ( ; pkts_mask; ) {
@@ -886,8 +919,7 @@ rte_table_hash_lookup_key8_lru(
 		}
 
 		*lookup_hit_mask = pkts_mask_out;
-		RTE_TABLE_HASH_KEY8_STATS_PKTS_LOOKUP_MISS(f, n_pkts_in - __builtin_popcountll(pkts_mask_out));
-		return 0;
+		return;
 	}
 
 	/*
@@ -976,12 +1008,10 @@ rte_table_hash_lookup_key8_lru(
 		bucket20, bucket21, pkts_mask_out, entries, f);
 
 	*lookup_hit_mask = pkts_mask_out;
-	RTE_TABLE_HASH_KEY8_STATS_PKTS_LOOKUP_MISS(f, n_pkts_in - __builtin_popcountll(pkts_mask_out));
-	return 0;
 } /* lookup LRU */
 
 static int
-rte_table_hash_lookup_key8_ext(
+rte_table_hash_lookup_key8_lru(
 	void *table,
 	struct rte_mbuf **pkts,
 	uint64_t pkts_mask,
@@ -989,6 +1019,27 @@ rte_table_hash_lookup_key8_ext(
 	void **entries)
 {
 	struct rte_table_hash *f = (struct rte_table_hash *) table;
+
+	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
+	RTE_TABLE_HASH_KEY8_STATS_PKTS_IN_ADD(f, n_pkts_in);
+
+	table_sync_reader_enter(&f->sync);
+	lookup_key8_lru(f, pkts, pkts_mask, lookup_hit_mask, entries);
+	table_sync_reader_exit(&f->sync);
+
+	RTE_TABLE_HASH_KEY8_STATS_PKTS_LOOKUP_MISS(f, n_pkts_in -
+		__builtin_popcountll(*lookup_hit_mask));
+	return 0;
+}
+
+static inline void
+lookup_key8_ext(
+	struct rte_table_hash *f,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	uint64_t *lookup_hit_mask,
+	void **entries)
+{
 	struct rte_bucket_4_8 *bucket10, *bucket11, *bucket20, *bucket21;
 	struct rte_mbuf *mbuf00, *mbuf01, *mbuf10, *mbuf11, *mbuf20, *mbuf21;
 	uint32_t pkt00_index, pkt01_index, pkt10_index;
@@ -997,9 +1048,6 @@ rte_table_hash_lookup_key8_ext(
 	struct rte_bucket_4_8 *buckets[RTE_PORT_IN_BURST_SIZE_MAX];
 	uint64_t *keys[RTE_PORT_IN_BURST_SIZE_MAX];
 
-	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
-	RTE_TABLE_HASH_KEY8_STATS_PKTS_IN_ADD(f, n_pkts_in);
-
 	/* Cannot run the pipeline with less than 5 packets */
 	if (__builtin_popcountll(pkts_mask) < 5) {
 		for ( ; pkts_mask; ) {
@@ -1126,10 +1174,30 @@ rte_table_hash_lookup_key8_ext(
 	}
 
 	*lookup_hit_mask = pkts_mask_out;
-	RTE_TABLE_HASH_KEY8_STATS_PKTS_LOOKUP_MISS(f, n_pkts_in - __builtin_popcountll(pkts_mask_out));
-	return 0;
 } /* lookup EXT */
 
+static int
+rte_table_hash_lookup_key8_ext(
+	void *table,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	uint64_t *lookup_hit_mask,
+	void **entries)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+
+	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
+	RTE_TABLE_HASH_KEY8_STATS_PKTS_IN_ADD(f, n_pkts_in);
+
+	table_sync_reader_enter(&f->sync);
+	lookup_key8_ext(f, pkts, pkts_mask, lookup_hit_mask, entries);
+	table_sync_reader_exit(&f->sync);
+
+	RTE_TABLE_HASH_KEY8_STATS_PKTS_LOOKUP_MISS(f, n_pkts_in -
+		__builtin_popcountll(*lookup_hit_mask));
+	return 0;
+}
+
 static int
 rte_table_hash_key8_stats_read(void *table, struct rte_table_stats *stats, int clear)
 {
@@ -1144,6 +1212,22 @@ rte_table_hash_key8_stats_read(void *table, struct rte_table_stats *stats, int c
 	return 0;
 }
 
+static void
+rte_table_hash_key8_reader_enter(void *table)
+{
+	struct rte_table_hash *t = table;
+
+	table_sync_reader_enter(&t->sync);
+}
+
+static void
+rte_table_hash_key8_reader_exit(void *table)
+{
+	struct rte_table_hash *t = table;
+
+	table_sync_reader_exit(&t->sync);
+}
+
 struct rte_table_ops rte_table_hash_key8_lru_ops = {
 	.f_create = rte_table_hash_create_key8_lru,
 	.f_free = rte_table_hash_free_key8_lru,
@@ -1153,6 +1237,8 @@ struct rte_table_ops rte_table_hash_key8_lru_ops = {
 	.f_delete_bulk = NULL,
 	.f_lookup = rte_table_hash_lookup_key8_lru,
 	.f_stats = rte_table_hash_key8_stats_read,
+	.f_reader_enter = rte_table_hash_key8_reader_enter,
+	.f_reader_exit = rte_table_hash_key8_reader_exit,
 };
 
 struct rte_table_ops rte_table_hash_key8_ext_ops = {
@@ -1164,4 +1250,6 @@ struct rte_table_ops rte_table_hash_key8_ext_ops = {
 	.f_delete_bulk = NULL,
 	.f_lookup = rte_table_hash_lookup_key8_ext,
 	.f_stats = rte_table_hash_key8_stats_read,
+	.f_reader_enter = rte_table_hash_key8_reader_enter,
+	.f_reader_exit = rte_table_hash_key8_reader_exit,
 };
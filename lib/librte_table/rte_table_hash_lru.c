@@ -42,6 +42,7 @@
 
 #include "rte_table_hash.h"
 #include "rte_lru.h"
+#include "table_sync.h"
 
 #define KEYS_PER_BUCKET	4
 
@@ -78,6 +79,7 @@ struct grinder {
 
 struct rte_table_hash {
 	struct rte_table_stats stats;
+	struct table_sync sync;
 
 	/* Input parameters */
 	uint32_t key_size;
@@ -94,9 +96,6 @@ struct rte_table_hash {
 	uint32_t data_size_shl;
 	uint32_t key_stack_tos;
 
-	/* Grinder */
-	struct grinder grinders[RTE_PORT_IN_BURST_SIZE_MAX];
-
 	/* Tables */
 	uint64_t *key_mask;
 	struct bucket *buckets;
@@ -247,6 +246,7 @@ rte_table_hash_lru_create(void *params, int socket_id, uint32_t entry_size)
 	t->n_buckets = n_buckets;
 	t->f_hash = p->f_hash;
 	t->seed = p->seed;
+	table_sync_init(&t->sync);
 	t->key_offset = p->key_offset;
 
 	/* Internal */
@@ -354,10 +354,11 @@ rte_table_hash_lru_entry_add(void *table, void *key, void *entry,
 			bkt_key = &t->key_mem[bkt_key_index << t->key_size_shl];
 			data = &t->data_mem[bkt_key_index << t->data_size_shl];
 
-			bkt->sig[i] = (uint16_t) sig;
-			bkt->key_pos[i] = bkt_key_index;
 			keycpy(bkt_key, key, t->key_mask, t->key_size);
 			memcpy(data, entry, t->entry_size);
+			bkt->key_pos[i] = bkt_key_index;
+			rte_smp_wmb();
+			bkt->sig[i] = (uint16_t) sig;
 			lru_update(bkt, i);
 
 			*key_found = 0;
@@ -366,7 +367,7 @@ rte_table_hash_lru_entry_add(void *table, void *key, void *entry,
 		}
 	}
 
-	/* Bucket full */
+	/* Bucket full: replace LRU entry once no lookup is using it */
 	{
 		uint64_t pos = lru_pos(bkt);
 		uint32_t bkt_key_index = bkt->key_pos[pos];
@@ -374,9 +375,12 @@ rte_table_hash_lru_entry_add(void *table, void *key, void *entry,
 			t->key_size_shl];
 		uint8_t *data = &t->data_mem[bkt_key_index << t->data_size_shl];
 
-		bkt->sig[pos] = (uint16_t) sig;
+		bkt->sig[pos] = 0;
+		table_sync_wait_readers(&t->sync);
 		keycpy(bkt_key, key, t->key_mask, t->key_size);
 		memcpy(data, entry, t->entry_size);
+		rte_smp_wmb();
+		bkt->sig[pos] = (uint16_t) sig;
 		lru_update(bkt, pos);
 
 		*key_found = 0;
@@ -412,6 +416,7 @@ rte_table_hash_lru_entry_delete(void *table, void *key, int *key_found,
 				t->data_size_shl];
 
 			bkt->sig[i] = 0;
+			table_sync_wait_readers(&t->sync);
 			t->key_stack[t->key_stack_tos++] = bkt_key_index;
 			*key_found = 1;
 			if (entry)
@@ -435,9 +440,6 @@ static int rte_table_hash_lru_lookup_unoptimized(
 	struct rte_table_hash *t = (struct rte_table_hash *) table;
 	uint64_t pkts_mask_out = 0;
 
-	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
-	RTE_TABLE_HASH_LRU_STATS_PKTS_IN_ADD(t, n_pkts_in);
-
 	for ( ; pkts_mask; ) {
 		struct bucket *bkt;
 		struct rte_mbuf *pkt;
@@ -460,9 +462,12 @@ static int rte_table_hash_lru_lookup_unoptimized(
 		/* Key is present in the bucket */
 		for (i = 0; i < KEYS_PER_BUCKET; i++) {
 			uint64_t bkt_sig = (uint64_t) bkt->sig[i];
-			uint32_t bkt_key_index = bkt->key_pos[i];
-			uint8_t *bkt_key = &t->key_mem[bkt_key_index <<
-				t->key_size_shl];
+			uint32_t bkt_key_index;
+			uint8_t *bkt_key;
+
+			rte_smp_rmb();
+			bkt_key_index = bkt->key_pos[i];
+			bkt_key = &t->key_mem[bkt_key_index << t->key_size_shl];
 
 			if ((sig == bkt_sig) && (keycmp(bkt_key, key, t->key_mask,
 				t->key_size) == 0)) {
@@ -478,7 +483,6 @@ static int rte_table_hash_lru_lookup_unoptimized(
 	}
 
 	*lookup_hit_mask = pkts_mask_out;
-	RTE_TABLE_HASH_LRU_STATS_PKTS_LOOKUP_MISS(t, n_pkts_in - __builtin_popcountll(pkts_mask_out));
 	return 0;
 }
 
@@ -535,6 +539,7 @@ static int rte_table_hash_lru_lookup_unoptimized(
 	bucket_sig[1] = bucket->sig[1];				\
 	bucket_sig[2] = bucket->sig[2];				\
 	bucket_sig[3] = bucket->sig[3];				\
+	rte_smp_rmb();						\
 								\
 	bucket_sig[0] ^= mbuf_sig;				\
 	bucket_sig[1] ^= mbuf_sig;				\
@@ -829,26 +834,23 @@ static int rte_table_hash_lru_lookup_unoptimized(
 *	  pXY = packet Y of stage X, X = 0 .. 3, Y = 0 .. 1
 *
 ***/
-static int rte_table_hash_lru_lookup(
-	void *table,
+static inline int
+lookup_lru(
+	struct rte_table_hash *t,
 	struct rte_mbuf **pkts,
 	uint64_t pkts_mask,
 	uint64_t *lookup_hit_mask,
 	void **entries)
 {
-	struct rte_table_hash *t = (struct rte_table_hash *) table;
-	struct grinder *g = t->grinders;
+	struct grinder g[RTE_PORT_IN_BURST_SIZE_MAX];
 	uint64_t pkt00_index, pkt01_index, pkt10_index, pkt11_index;
 	uint64_t pkt20_index, pkt21_index, pkt30_index, pkt31_index;
 	uint64_t pkts_mask_out = 0, pkts_mask_match_many = 0;
 	int status = 0;
 
-	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
-	RTE_TABLE_HASH_LRU_STATS_PKTS_IN_ADD(t, n_pkts_in);
-
 	/* Cannot run the pipeline with less than 7 packets */
 	if (__builtin_popcountll(pkts_mask) < 7)
-		return rte_table_hash_lru_lookup_unoptimized(table, pkts,
+		return rte_table_hash_lru_lookup_unoptimized(t, pkts,
 			pkts_mask, lookup_hit_mask, entries);
 
 	/* Pipeline stage 0 */
@@ -952,13 +954,35 @@ static int rte_table_hash_lru_lookup(
 	if (pkts_mask_match_many) {
 		uint64_t pkts_mask_out_slow = 0;
 
-		status = rte_table_hash_lru_lookup_unoptimized(table, pkts,
+		status = rte_table_hash_lru_lookup_unoptimized(t, pkts,
 			pkts_mask_match_many, &pkts_mask_out_slow, entries);
 		pkts_mask_out |= pkts_mask_out_slow;
 	}
 
 	*lookup_hit_mask = pkts_mask_out;
-	RTE_TABLE_HASH_LRU_STATS_PKTS_LOOKUP_MISS(t, n_pkts_in - __builtin_popcountll(pkts_mask_out));
+	return status;
+}
+
+static int rte_table_hash_lru_lookup(
+	void *table,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	uint64_t *lookup_hit_mask,
+	void **entries)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+	int status;
+
+	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
+	RTE_TABLE_HASH_LRU_STATS_PKTS_IN_ADD(t, n_pkts_in);
+
+	table_sync_reader_enter(&t->sync);
+	status = lookup_lru(t, pkts, pkts_mask, lookup_hit_mask,
+		entries);
+	table_sync_reader_exit(&t->sync);
+
+	RTE_TABLE_HASH_LRU_STATS_PKTS_LOOKUP_MISS(t, n_pkts_in -
+		__builtin_popcountll(*lookup_hit_mask));
 	return status;
 }
 
@@ -976,6 +1000,22 @@ rte_table_hash_lru_stats_read(void *table, struct rte_table_stats *stats, int cl
 	return 0;
 }
 
+static void
+rte_table_hash_lru_reader_enter(void *table)
+{
+	struct rte_table_hash *t = table;
+
+	table_sync_reader_enter(&t->sync);
+}
+
+static void
+rte_table_hash_lru_reader_exit(void *table)
+{
+	struct rte_table_hash *t = table;
+
+	table_sync_reader_exit(&t->sync);
+}
+
 struct rte_table_ops rte_table_hash_lru_ops = {
 	.f_create = rte_table_hash_lru_create,
 	.f_free = rte_table_hash_lru_free,
@@ -985,4 +1025,6 @@ struct rte_table_ops rte_table_hash_lru_ops = {
 	.f_delete_bulk = NULL,
 	.f_lookup = rte_table_hash_lru_lookup,
 	.f_stats = rte_table_hash_lru_stats_read,
+	.f_reader_enter = rte_table_hash_lru_reader_enter,
+	.f_reader_exit = rte_table_hash_lru_reader_exit,
 };
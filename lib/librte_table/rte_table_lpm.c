@@ -43,6 +43,7 @@
 #include <rte_lpm.h>
 
 #include "rte_table_lpm.h"
+#include "table_sync.h"
 
 #ifndef RTE_TABLE_LPM_MAX_NEXT_HOPS
 #define RTE_TABLE_LPM_MAX_NEXT_HOPS                        65536
@@ -64,6 +65,7 @@
 
 struct rte_table_lpm {
 	struct rte_table_stats stats;
+	struct table_sync sync;
 
 	/* Input parameters */
 	uint32_t entry_size;
@@ -147,6 +149,7 @@ rte_table_lpm_create(void *params, int socket_id, uint32_t entry_size)
 	lpm->entry_unique_size = p->entry_unique_size;
 	lpm->n_rules = p->n_rules;
 	lpm->offset = p->offset;
+	table_sync_init(&lpm->sync);
 
 	return lpm;
 }
@@ -256,11 +259,18 @@ rte_table_lpm_entry_add(
 	}
 
 	/* Add rule to low level LPM table */
-	if (rte_lpm_add(lpm->lpm, ip_prefix->ip, ip_prefix->depth, nht_pos) < 0) {
+	rte_smp_wmb();
+	status = rte_lpm_add(lpm->lpm, ip_prefix->ip, ip_prefix->depth,
+		nht_pos);
+	if (status < 0) {
 		RTE_LOG(ERR, TABLE, "%s: LPM rule add failed\n", __func__);
 		return -1;
 	}
 
+	/* The replaced NHT entry may be reused once no lookup is using it */
+	if (nht_pos0_valid)
+		table_sync_wait_readers(&lpm->sync);
+
 	/* Commit NHT changes */
 	lpm->nht_users[nht_pos]++;
 	lpm->nht_users[nht_pos0] -= nht_pos0_valid;
@@ -317,6 +327,12 @@ rte_table_lpm_entry_delete(
 		return -1;
 	}
 
+	/*
+	 * The NHT entry and the tbl8 groups freed by the delete may be reused
+	 * once no lookup is using them.
+	 */
+	table_sync_wait_readers(&lpm->sync);
+
 	/* Commit NHT changes */
 	lpm->nht_users[nht_pos]--;
 
@@ -343,6 +359,7 @@ rte_table_lpm_lookup(
 	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
 	RTE_TABLE_LPM_STATS_PKTS_IN_ADD(lpm, n_pkts_in);
 
+	table_sync_reader_enter(&lpm->sync);
 	pkts_out_mask = 0;
 	for (i = 0; i < (uint32_t)(RTE_PORT_IN_BURST_SIZE_MAX -
 		__builtin_clzll(pkts_mask)); i++) {
@@ -363,6 +380,7 @@ rte_table_lpm_lookup(
 			}
 		}
 	}
+	table_sync_reader_exit(&lpm->sync);
 
 	*lookup_hit_mask = pkts_out_mask;
 	RTE_TABLE_LPM_STATS_PKTS_LOOKUP_MISS(lpm, n_pkts_in - __builtin_popcountll(pkts_out_mask));
@@ -383,6 +401,22 @@ rte_table_lpm_stats_read(void *table, struct rte_table_stats *stats, int clear)
 	return 0;
 }
 
+static void
+rte_table_lpm_reader_enter(void *table)
+{
+	struct rte_table_lpm *t = table;
+
+	table_sync_reader_enter(&t->sync);
+}
+
+static void
+rte_table_lpm_reader_exit(void *table)
+{
+	struct rte_table_lpm *t = table;
+
+	table_sync_reader_exit(&t->sync);
+}
+
 struct rte_table_ops rte_table_lpm_ops = {
 	.f_create = rte_table_lpm_create,
 	.f_free = rte_table_lpm_free,
@@ -392,4 +426,6 @@ struct rte_table_ops rte_table_lpm_ops = {
 	.f_delete_bulk = NULL,
 	.f_lookup = rte_table_lpm_lookup,
 	.f_stats = rte_table_lpm_stats_read,
+	.f_reader_enter = rte_table_lpm_reader_enter,
+	.f_reader_exit = rte_table_lpm_reader_exit,
 };
@@ -43,6 +43,7 @@
 #include <rte_lpm6.h>
 
 #include "rte_table_lpm_ipv6.h"
+#include "table_sync.h"
 
 #define RTE_TABLE_LPM_MAX_NEXT_HOPS                        256
 
@@ -62,6 +63,7 @@
 
 struct rte_table_lpm_ipv6 {
 	struct rte_table_stats stats;
+	struct table_sync sync;
 
 	/* Input parameters */
 	uint32_t entry_size;
@@ -72,6 +74,15 @@ struct rte_table_lpm_ipv6 {
 	/* Handle to low-level LPM table */
 	struct rte_lpm6 *lpm;
 
+	/*
+	 * Copy of the low-level LPM table that is not used by the lookups,
+	 * only with concurrent update. As rte_lpm6_delete() rebuilds the whole
+	 * table in place, the rules are changed in this copy, which is then
+	 * swapped with the other one.
+	 */
+	struct rte_lpm6 *lpm_standby;
+	char name_standby[RTE_LPM6_NAMESIZE];
+
 	/* Next Hop Table (NHT) */
 	uint32_t nht_users[RTE_TABLE_LPM_MAX_NEXT_HOPS];
 	uint8_t nht[0] __rte_cache_aligned;
@@ -140,11 +151,33 @@ rte_table_lpm_ipv6_create(void *params, int socket_id, uint32_t entry_size)
 		return NULL;
 	}
 
+	if (p->concurrent_update) {
+		if (snprintf(lpm->name_standby, sizeof(lpm->name_standby),
+			"%s_b", p->name) >= (int) sizeof(lpm->name_standby)) {
+			rte_lpm6_free(lpm->lpm);
+			rte_free(lpm);
+			RTE_LOG(ERR, TABLE, "%s: Table name too long\n",
+				__func__);
+			return NULL;
+		}
+
+		lpm->lpm_standby = rte_lpm6_create(lpm->name_standby,
+			socket_id, &lpm6_config);
+		if (lpm->lpm_standby == NULL) {
+			rte_lpm6_free(lpm->lpm);
+			rte_free(lpm);
+			RTE_LOG(ERR, TABLE,
+				"Unable to create low-level LPM IPv6 table\n");
+			return NULL;
+		}
+	}
+
 	/* Memory initialization */
 	lpm->entry_size = entry_size;
 	lpm->entry_unique_size = p->entry_unique_size;
 	lpm->n_rules = p->n_rules;
 	lpm->offset = p->offset;
+	table_sync_init(&lpm->sync);
 
 	return lpm;
 }
@@ -162,11 +195,104 @@ rte_table_lpm_ipv6_free(void *table)
 
 	/* Free previously allocated resources */
 	rte_lpm6_free(lpm->lpm);
+	if (lpm->lpm_standby != NULL)
+		rte_lpm6_free(lpm->lpm_standby);
 	rte_free(lpm);
 
 	return 0;
 }
 
+static int
+lpm6_rule_set(struct rte_lpm6 *lpm6,
+	struct rte_table_lpm_ipv6_key *ip_prefix,
+	uint32_t nht_pos,
+	int add)
+{
+	if (add)
+		return rte_lpm6_add(lpm6, ip_prefix->ip, ip_prefix->depth,
+			nht_pos);
+
+	return rte_lpm6_delete(lpm6, ip_prefix->ip, ip_prefix->depth);
+}
+
+/*
+ * Put the rule back in the state it had before a failed update: present
+ * with next hop *nht_pos_prev* or absent. A failed rte_lpm6_add() already
+ * deleted the rule, so the rule may be absent either way.
+ */
+static int
+lpm6_rule_restore(struct rte_lpm6 *lpm6,
+	struct rte_table_lpm_ipv6_key *ip_prefix,
+	int valid_prev,
+	uint32_t nht_pos_prev)
+{
+	int status;
+
+	if (valid_prev)
+		return rte_lpm6_add(lpm6, ip_prefix->ip, ip_prefix->depth,
+			nht_pos_prev);
+
+	status = rte_lpm6_delete(lpm6, ip_prefix->ip, ip_prefix->depth);
+	return (status == -ENOENT) ? 0 : status;
+}
+
+/*
+ * Without concurrent update, change the low-level table in place. Otherwise,
+ * apply the rule change to the standby low-level table and swap it with the
+ * one used by the lookups. The same change is then applied to the latter,
+ * once no lookup is using it, so that both tables have the same rules again.
+ * If this fails, both tables are put back in their state before the update,
+ * swapping them again so that the one used by the lookups is never changed
+ * in place. *valid_prev* and *nht_pos_prev* give this state for the rule.
+ */
+static int
+lpm6_update(struct rte_table_lpm_ipv6 *lpm,
+	struct rte_table_lpm_ipv6_key *ip_prefix,
+	uint32_t nht_pos,
+	int add,
+	int valid_prev,
+	uint32_t nht_pos_prev)
+{
+	struct rte_lpm6 *lpm6 = lpm->lpm;
+	struct rte_lpm6 *lpm6_standby = lpm->lpm_standby;
+	int status;
+
+	if (lpm6_standby == NULL)
+		return lpm6_rule_set(lpm6, ip_prefix, nht_pos, add);
+
+	status = lpm6_rule_set(lpm6_standby, ip_prefix, nht_pos, add);
+	if (status < 0)
+		return status;
+
+	rte_smp_wmb();
+	lpm->lpm = lpm6_standby;
+	table_sync_wait_readers(&lpm->sync);
+	lpm->lpm_standby = lpm6;
+
+	status = lpm6_rule_set(lpm6, ip_prefix, nht_pos, add);
+	if (status >= 0)
+		return status;
+
+	if (lpm6_rule_restore(lpm6, ip_prefix, valid_prev,
+		nht_pos_prev) < 0) {
+		RTE_LOG(ERR, TABLE, "%s: LPM IPv6 rule restore failed\n",
+			__func__);
+		return status;
+	}
+
+	rte_smp_wmb();
+	lpm->lpm = lpm6;
+	table_sync_wait_readers(&lpm->sync);
+	lpm->lpm_standby = lpm6_standby;
+
+	if (lpm6_rule_restore(lpm6_standby, ip_prefix, valid_prev,
+		nht_pos_prev) < 0)
+		RTE_LOG(ERR, TABLE, "%s: LPM IPv6 rule restore failed\n",
+			__func__);
+
+	return status;
+}
+
 static int
 nht_find_free(struct rte_table_lpm_ipv6 *lpm, uint32_t *pos)
 {
@@ -211,8 +337,9 @@ rte_table_lpm_ipv6_entry_add(
 	struct rte_table_lpm_ipv6 *lpm = table;
 	struct rte_table_lpm_ipv6_key *ip_prefix =
 		key;
-	uint32_t nht_pos, nht_pos0, nht_pos0_valid;
+	uint32_t nht_pos, nht_pos0_valid;
 	int status;
+	uint32_t nht_pos0 = 0;
 
 	/* Check input parameters */
 	if (lpm == NULL) {
@@ -254,8 +381,9 @@ rte_table_lpm_ipv6_entry_add(
 	}
 
 	/* Add rule to low level LPM table */
-	if (rte_lpm6_add(lpm->lpm, ip_prefix->ip, ip_prefix->depth,
-		nht_pos) < 0) {
+	status = lpm6_update(lpm, ip_prefix, nht_pos, 1, nht_pos0_valid,
+		nht_pos0);
+	if (status < 0) {
 		RTE_LOG(ERR, TABLE, "%s: LPM IPv6 rule add failed\n", __func__);
 		return -1;
 	}
@@ -312,7 +440,7 @@ rte_table_lpm_ipv6_entry_delete(
 	}
 
 	/* Delete rule from the low-level LPM table */
-	status = rte_lpm6_delete(lpm->lpm, ip_prefix->ip, ip_prefix->depth);
+	status = lpm6_update(lpm, ip_prefix, 0, 0, 1, nht_pos);
 	if (status) {
 		RTE_LOG(ERR, TABLE, "%s: LPM IPv6 rule delete failed\n",
 			__func__);
@@ -339,12 +467,15 @@ rte_table_lpm_ipv6_lookup(
 	void **entries)
 {
 	struct rte_table_lpm_ipv6 *lpm = (struct rte_table_lpm_ipv6 *) table;
+	struct rte_lpm6 *lpm6;
 	uint64_t pkts_out_mask = 0;
 	uint32_t i;
 
 	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
 	RTE_TABLE_LPM_IPV6_STATS_PKTS_IN_ADD(lpm, n_pkts_in);
 
+	table_sync_reader_enter(&lpm->sync);
+	lpm6 = lpm->lpm;
 	pkts_out_mask = 0;
 	for (i = 0; i < (uint32_t)(RTE_PORT_IN_BURST_SIZE_MAX -
 		__builtin_clzll(pkts_mask)); i++) {
@@ -357,7 +488,7 @@ rte_table_lpm_ipv6_lookup(
 			int status;
 			uint32_t nht_pos;
 
-			status = rte_lpm6_lookup(lpm->lpm, ip, &nht_pos);
+			status = rte_lpm6_lookup(lpm6, ip, &nht_pos);
 			if (status == 0) {
 				pkts_out_mask |= pkt_mask;
 				entries[i] = (void *) &lpm->nht[nht_pos *
@@ -365,6 +496,7 @@ rte_table_lpm_ipv6_lookup(
 			}
 		}
 	}
+	table_sync_reader_exit(&lpm->sync);
 
 	*lookup_hit_mask = pkts_out_mask;
 	RTE_TABLE_LPM_IPV6_STATS_PKTS_LOOKUP_MISS(lpm, n_pkts_in - __builtin_popcountll(pkts_out_mask));
@@ -385,6 +517,22 @@ rte_table_lpm_ipv6_stats_read(void *table, struct rte_table_stats *stats, int cl
 	return 0;
 }
 
+static void
+rte_table_lpm_ipv6_reader_enter(void *table)
+{
+	struct rte_table_lpm_ipv6 *t = table;
+
+	table_sync_reader_enter(&t->sync);
+}
+
+static void
+rte_table_lpm_ipv6_reader_exit(void *table)
+{
+	struct rte_table_lpm_ipv6 *t = table;
+
+	table_sync_reader_exit(&t->sync);
+}
+
 struct rte_table_ops rte_table_lpm_ipv6_ops = {
 	.f_create = rte_table_lpm_ipv6_create,
 	.f_free = rte_table_lpm_ipv6_free,
@@ -394,4 +542,6 @@ struct rte_table_ops rte_table_lpm_ipv6_ops = {
 	.f_delete_bulk = NULL,
 	.f_lookup = rte_table_lpm_ipv6_lookup,
 	.f_stats = rte_table_lpm_ipv6_stats_read,
+	.f_reader_enter = rte_table_lpm_ipv6_reader_enter,
+	.f_reader_exit = rte_table_lpm_ipv6_reader_exit,
 };
@@ -94,6 +94,12 @@ struct rte_table_lpm_ipv6_params {
 	/** Byte offset within input packet meta-data where lookup key (i.e.
 	the destination IP address) is located. */
 	uint32_t offset;
+
+	/** When non-zero, entries can be added and deleted while the table is
+	looked up by other threads. This keeps a second copy of the low-level
+	LPM table, which doubles the table memory, and the table name must be
+	short enough to take a two character suffix. */
+	int concurrent_update;
 };
 
 /** LPM table rule (i.e. route), specified as IP prefix. While the key used by
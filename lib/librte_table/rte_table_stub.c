@@ -118,4 +118,6 @@ struct rte_table_ops rte_table_stub_ops = {
 	.f_delete_bulk = NULL,
 	.f_lookup = rte_table_stub_lookup,
 	.f_stats = rte_table_stub_stats_read,
+	.f_reader_enter = NULL,
+	.f_reader_exit = NULL,
 };
@@ -0,0 +1,751 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include <rte_common.h>
+#include <rte_mbuf.h>
+#include <rte_memory.h>
+#include <rte_malloc.h>
+#include <rte_log.h>
+#include <rte_hash.h>
+
+#include "rte_table_wildcard.h"
+#include "table_sync.h"
+
+#ifdef RTE_TABLE_STATS_COLLECT
+
+#define RTE_TABLE_WILDCARD_STATS_PKTS_IN_ADD(table, val) \
+	(table->stats.n_pkts_in += val)
+#define RTE_TABLE_WILDCARD_STATS_PKTS_LOOKUP_MISS(table, val) \
+	(table->stats.n_pkts_lookup_miss += val)
+
+#else
+
+#define RTE_TABLE_WILDCARD_STATS_PKTS_IN_ADD(table, val)
+#define RTE_TABLE_WILDCARD_STATS_PKTS_LOOKUP_MISS(table, val)
+
+#endif
+
+#define WILDCARD_KEY_WORDS_MAX (RTE_TABLE_WILDCARD_KEY_SIZE_MAX / 8)
+
+/* Smallest hash table accepted by rte_hash (one bucket) */
+#define WILDCARD_HASH_ENTRIES_MIN 8
+
+#define WILDCARD_PRIORITY_NONE INT32_MAX
+
+struct wildcard_rule {
+	int32_t priority;
+	uint32_t tuple_id;
+	uint8_t data[0];
+};
+
+struct wildcard_tuple {
+	uint64_t mask[WILDCARD_KEY_WORDS_MAX];
+
+	/* Exact match table for the masked keys, rule pointer as key data */
+	struct rte_hash *h;
+
+	/* Highest priority of the tuple rules. Not updated on rule delete, so
+	 * it is only a bound, but a correct one, for the lookup early exit.
+	 */
+	int32_t priority;
+};
+
+/*
+ * Lookup structure. The table has two copies of it: the writer changes the
+ * one the lookups are not using, swaps the two and, once no lookup is using
+ * the other one any more, applies the same change to it.
+ */
+struct wildcard_view {
+	/* Tuples with at least one rule, sorted by decreasing priority */
+	uint32_t tuple_active[RTE_TABLE_WILDCARD_MASKS_MAX];
+	uint32_t n_tuples_active;
+
+	struct wildcard_tuple tuple[RTE_TABLE_WILDCARD_MASKS_MAX];
+};
+
+struct rte_table_wildcard {
+	struct rte_table_stats stats;
+	struct table_sync sync;
+
+	/* Input parameters */
+	uint32_t key_size;
+	uint32_t key_offset;
+	uint32_t entry_size;
+	uint32_t n_rules;
+	uint32_t n_masks;
+
+	/* Internal */
+	uint32_t key_n_words;
+	uint32_t rule_size;
+
+	/* Lookup structure used by the lookups and the one being changed */
+	struct wildcard_view *view;
+	struct wildcard_view *view_standby;
+
+	/* Number of rules of each tuple */
+	uint32_t tuple_n_rules[RTE_TABLE_WILDCARD_MASKS_MAX];
+
+	/* Stack of free rules */
+	uint32_t *rule_free;
+	uint32_t n_rules_free;
+
+	struct wildcard_view views[2];
+	uint8_t *rules;
+
+	uint8_t memory[0] __rte_cache_aligned;
+};
+
+static inline struct wildcard_rule *
+rule_get(struct rte_table_wildcard *t, uint32_t rule_id)
+{
+	return (struct wildcard_rule *) &t->rules[rule_id * t->rule_size];
+}
+
+static inline uint32_t
+rule_id_get(struct rte_table_wildcard *t, struct wildcard_rule *rule)
+{
+	return ((uint8_t *) rule - t->rules) / t->rule_size;
+}
+
+static int
+check_params_create(struct rte_table_wildcard_params *params)
+{
+	if (params == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: Incorrect value for params\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (params->name == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: Incorrect value for name\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if ((params->key_size == 0) ||
+		(params->key_size % sizeof(uint64_t)) ||
+		(params->key_size > RTE_TABLE_WILDCARD_KEY_SIZE_MAX)) {
+		RTE_LOG(ERR, TABLE, "%s: Incorrect value for key_size\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (params->n_rules == 0) {
+		RTE_LOG(ERR, TABLE, "%s: Incorrect value for n_rules\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if ((params->n_masks == 0) ||
+		(params->n_masks > RTE_TABLE_WILDCARD_MASKS_MAX)) {
+		RTE_LOG(ERR, TABLE, "%s: Incorrect value for n_masks\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int
+rte_table_wildcard_free(void *table);
+
+static void *
+rte_table_wildcard_create(void *params, int socket_id, uint32_t entry_size)
+{
+	struct rte_table_wildcard_params *p = params;
+	struct rte_table_wildcard *t;
+	uint32_t rule_size, rule_free_size, rules_size, total_size, i;
+
+	/* Check input parameters */
+	if (check_params_create(p) != 0)
+		return NULL;
+
+	/* Memory allocation */
+	rule_size = RTE_ALIGN_CEIL(sizeof(struct wildcard_rule) + entry_size,
+		sizeof(uint64_t));
+	rule_free_size = RTE_CACHE_LINE_ROUNDUP(p->n_rules * sizeof(uint32_t));
+	rules_size = RTE_CACHE_LINE_ROUNDUP(p->n_rules * rule_size);
+	total_size = sizeof(struct rte_table_wildcard) + rule_free_size +
+		rules_size;
+
+	t = rte_zmalloc_socket(p->name, total_size, RTE_CACHE_LINE_SIZE,
+		socket_id);
+	if (t == NULL) {
+		RTE_LOG(ERR, TABLE,
+			"%s: Cannot allocate %u bytes for wildcard table %s\n",
+			__func__, total_size, p->name);
+		return NULL;
+	}
+
+	/* Memory initialization */
+	t->key_size = p->key_size;
+	t->key_offset = p->key_offset;
+	t->entry_size = entry_size;
+	t->n_rules = p->n_rules;
+	t->n_masks = p->n_masks;
+
+	t->key_n_words = p->key_size / sizeof(uint64_t);
+	t->rule_size = rule_size;
+
+	t->rule_free = (uint32_t *) t->memory;
+	t->rules = &t->memory[rule_free_size];
+
+	for (i = 0; i < p->n_rules; i++)
+		t->rule_free[i] = p->n_rules - 1 - i;
+	t->n_rules_free = p->n_rules;
+
+	t->view = &t->views[0];
+	t->view_standby = &t->views[1];
+
+	/* The per-tuple hash tables are created upfront, so that adding a rule
+	 * with a new mask does not allocate memory.
+	 */
+	for (i = 0; i < 2 * p->n_masks; i++) {
+		struct wildcard_tuple *tuple =
+			&t->views[i / p->n_masks].tuple[i % p->n_masks];
+		char name[RTE_HASH_NAMESIZE];
+		struct rte_hash_parameters hash_params = {
+			.name = name,
+			.entries = RTE_MAX(p->n_rules,
+				(uint32_t) WILDCARD_HASH_ENTRIES_MIN),
+			.key_len = p->key_size,
+			.hash_func = NULL,
+			.hash_func_init_val = 0,
+			.socket_id = socket_id,
+		};
+
+		snprintf(name, sizeof(name), "WC_%p_%u", (void *) t, i);
+
+		tuple->h = rte_hash_create(&hash_params);
+		if (tuple->h == NULL) {
+			RTE_LOG(ERR, TABLE,
+				"%s: Cannot create hash table for mask %u of "
+				"wildcard table %s\n", __func__,
+				i % p->n_masks, p->name);
+			rte_table_wildcard_free(t);
+			return NULL;
+		}
+
+		tuple->priority = WILDCARD_PRIORITY_NONE;
+	}
+
+	table_sync_init(&t->sync);
+
+	RTE_LOG(INFO, TABLE,
+		"%s: Wildcard table %s memory footprint is %u bytes "
+		"(plus %u hash tables)\n",
+		__func__, p->name, total_size, 2 * p->n_masks);
+	return t;
+}
+
+static int
+rte_table_wildcard_free(void *table)
+{
+	struct rte_table_wildcard *t = table;
+	uint32_t i;
+
+	/* Check input parameters */
+	if (t == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: table parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	/* Free previously allocated resources */
+	for (i = 0; i < t->n_masks; i++) {
+		rte_hash_free(t->views[0].tuple[i].h);
+		rte_hash_free(t->views[1].tuple[i].h);
+	}
+
+	rte_free(t);
+
+	return 0;
+}
+
+static void
+key_mask_apply(struct rte_table_wildcard *t,
+	uint64_t *dst,
+	const uint8_t *key,
+	const uint64_t *mask)
+{
+	uint32_t i;
+
+	memcpy(dst, key, t->key_size);
+	for (i = 0; i < t->key_n_words; i++)
+		dst[i] &= mask[i];
+}
+
+/* Returns the active tuple with the given mask or NULL when not found */
+static struct wildcard_tuple *
+tuple_find(struct rte_table_wildcard *t, struct wildcard_view *v,
+	uint64_t *mask)
+{
+	uint32_t i;
+
+	for (i = 0; i < v->n_tuples_active; i++) {
+		struct wildcard_tuple *tuple = &v->tuple[v->tuple_active[i]];
+
+		if (memcmp(tuple->mask, mask, t->key_size) == 0)
+			return tuple;
+	}
+
+	return NULL;
+}
+
+/* Returns an inactive tuple or NULL when all of them are in use */
+static struct wildcard_tuple *
+tuple_alloc(struct rte_table_wildcard *t, struct wildcard_view *v)
+{
+	uint32_t i;
+
+	for (i = 0; i < t->n_masks; i++)
+		if (t->tuple_n_rules[i] == 0)
+			return &v->tuple[i];
+
+	return NULL;
+}
+
+/*
+ * Move the tuple to its place in the active tuple list after its priority
+ * got higher, inserting it when not active yet. Called by the writer only,
+ * on the standby view.
+ */
+static void
+tuple_activate(struct wildcard_view *v, uint32_t tuple_id)
+{
+	int32_t priority = v->tuple[tuple_id].priority;
+	uint32_t pos, i;
+
+	for (pos = 0; pos < v->n_tuples_active; pos++)
+		if (v->tuple_active[pos] == tuple_id)
+			break;
+
+	if (pos == v->n_tuples_active)
+		v->n_tuples_active++;
+
+	for (i = pos; i > 0; i--) {
+		uint32_t prev_id = v->tuple_active[i - 1];
+
+		if (v->tuple[prev_id].priority <= priority)
+			break;
+
+		v->tuple_active[i] = prev_id;
+	}
+
+	v->tuple_active[i] = tuple_id;
+}
+
+static void
+tuple_deactivate(struct wildcard_view *v, uint32_t tuple_id)
+{
+	uint32_t pos;
+
+	for (pos = 0; pos < v->n_tuples_active; pos++)
+		if (v->tuple_active[pos] == tuple_id)
+			break;
+
+	for ( ; pos + 1 < v->n_tuples_active; pos++)
+		v->tuple_active[pos] = v->tuple_active[pos + 1];
+
+	v->n_tuples_active--;
+	v->tuple[tuple_id].priority = WILDCARD_PRIORITY_NONE;
+}
+
+/*
+ * Publish the standby view to the lookups. Once no lookup is using the
+ * previous view, it becomes the standby view and gets the tuple list of the
+ * new one. The caller then applies the same hash table change to it.
+ */
+static struct wildcard_view *
+view_swap(struct rte_table_wildcard *t)
+{
+	struct wildcard_view *v = t->view_standby;
+	struct wildcard_view *v_old = t->view;
+	uint32_t i;
+
+	rte_smp_wmb();
+	t->view = v;
+	table_sync_wait_readers(&t->sync);
+	t->view_standby = v_old;
+
+	memcpy(v_old->tuple_active, v->tuple_active,
+		sizeof(v->tuple_active));
+	v_old->n_tuples_active = v->n_tuples_active;
+	for (i = 0; i < t->n_masks; i++) {
+		memcpy(v_old->tuple[i].mask, v->tuple[i].mask,
+			sizeof(v->tuple[i].mask));
+		v_old->tuple[i].priority = v->tuple[i].priority;
+	}
+
+	return v_old;
+}
+
+static int
+rte_table_wildcard_entry_add(
+	void *table,
+	void *key,
+	void *entry,
+	int *key_found,
+	void **entry_ptr)
+{
+	struct rte_table_wildcard *t = table;
+	struct rte_table_wildcard_rule_add_params *rule = key;
+	struct wildcard_view *v;
+	struct wildcard_tuple *tuple;
+	struct wildcard_rule *r;
+	uint64_t mask[WILDCARD_KEY_WORDS_MAX];
+	uint64_t k[WILDCARD_KEY_WORDS_MAX];
+	uint32_t tuple_id, rule_id;
+	void *data;
+	int status;
+
+	/* Check input parameters */
+	if (table == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: table parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+	if (key == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: key parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+	if (entry == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: entry parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+	if (key_found == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: key_found parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+	if (entry_ptr == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: entry_ptr parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+	if (rule->priority == WILDCARD_PRIORITY_NONE) {
+		RTE_LOG(ERR, TABLE, "%s: Priority value is invalid\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	memcpy(mask, rule->mask, t->key_size);
+	key_mask_apply(t, k, rule->key, mask);
+
+	/* Existing rule: update in place */
+	v = t->view_standby;
+	tuple = tuple_find(t, v, mask);
+	if ((tuple != NULL) &&
+		(rte_hash_lookup_data(tuple->h, k, &data) >= 0)) {
+		r = data;
+		tuple_id = r->tuple_id;
+
+		memcpy(r->data, entry, t->entry_size);
+		r->priority = rule->priority;
+		if (rule->priority < tuple->priority) {
+			tuple->priority = rule->priority;
+			tuple_activate(v, tuple_id);
+			view_swap(t);
+		}
+
+		*key_found = 1;
+		*entry_ptr = r->data;
+		return 0;
+	}
+
+	/* New rule */
+	if (tuple == NULL) {
+		tuple = tuple_alloc(t, v);
+		if (tuple == NULL) {
+			RTE_LOG(ERR, TABLE, "%s: Too many distinct masks\n",
+				__func__);
+			return -ENOSPC;
+		}
+
+		memcpy(tuple->mask, mask, t->key_size);
+	}
+	tuple_id = tuple - v->tuple;
+
+	if (t->n_rules_free == 0)
+		return -ENOSPC;
+
+	rule_id = t->rule_free[t->n_rules_free - 1];
+	r = rule_get(t, rule_id);
+	r->priority = rule->priority;
+	r->tuple_id = tuple_id;
+	memcpy(r->data, entry, t->entry_size);
+
+	status = rte_hash_add_key_data(tuple->h, k, r);
+	if (status < 0)
+		return status;
+
+	t->n_rules_free--;
+	t->tuple_n_rules[tuple_id]++;
+	if (rule->priority < tuple->priority) {
+		tuple->priority = rule->priority;
+		tuple_activate(v, tuple_id);
+	}
+
+	v = view_swap(t);
+	status = rte_hash_add_key_data(v->tuple[tuple_id].h, k, r);
+	if (status < 0) {
+		/*
+		 * The rule is only in the view used by the lookups: publish
+		 * the other view again and remove the rule from the first one
+		 * once no lookup is using it.
+		 */
+		RTE_LOG(ERR, TABLE, "%s: Standby view update failed (%d)\n",
+			__func__, status);
+
+		t->tuple_n_rules[tuple_id]--;
+		if (t->tuple_n_rules[tuple_id] == 0)
+			tuple_deactivate(v, tuple_id);
+
+		v = view_swap(t);
+		rte_hash_del_key(v->tuple[tuple_id].h, k);
+		t->n_rules_free++;
+		return status;
+	}
+
+	*key_found = 0;
+	*entry_ptr = r->data;
+	return 0;
+}
+
+static int
+rte_table_wildcard_entry_delete(
+	void *table,
+	void *key,
+	int *key_found,
+	void *entry)
+{
+	struct rte_table_wildcard *t = table;
+	struct rte_table_wildcard_rule_delete_params *rule = key;
+	struct wildcard_view *v;
+	struct wildcard_tuple *tuple;
+	struct wildcard_rule *r;
+	uint64_t mask[WILDCARD_KEY_WORDS_MAX];
+	uint64_t k[WILDCARD_KEY_WORDS_MAX];
+	void *data;
+
+	/* Check input parameters */
+	if (table == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: table parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+	if (key == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: key parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+	if (key_found == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: key_found parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	memcpy(mask, rule->mask, t->key_size);
+	key_mask_apply(t, k, rule->key, mask);
+
+	/* Return if rule not found */
+	v = t->view_standby;
+	tuple = tuple_find(t, v, mask);
+	if ((tuple == NULL) ||
+		(rte_hash_lookup_data(tuple->h, k, &data) < 0)) {
+		*key_found = 0;
+		return 0;
+	}
+	r = data;
+
+	rte_hash_del_key(tuple->h, k);
+	t->tuple_n_rules[r->tuple_id]--;
+	if (t->tuple_n_rules[r->tuple_id] == 0)
+		tuple_deactivate(v, r->tuple_id);
+
+	v = view_swap(t);
+	rte_hash_del_key(v->tuple[r->tuple_id].h, k);
+
+	*key_found = 1;
+	if (entry != NULL)
+		memcpy(entry, r->data, t->entry_size);
+
+	t->rule_free[t->n_rules_free++] = rule_id_get(t, r);
+
+	return 0;
+}
+
+static inline uint64_t
+lookup_wildcard(
+	struct rte_table_wildcard *t,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	void **entries)
+{
+	uint64_t keys[RTE_PORT_IN_BURST_SIZE_MAX][WILDCARD_KEY_WORDS_MAX];
+	const void *key_ptrs[RTE_PORT_IN_BURST_SIZE_MAX];
+	void *data[RTE_PORT_IN_BURST_SIZE_MAX];
+	int32_t priority[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint32_t pkt_index[RTE_PORT_IN_BURST_SIZE_MAX];
+	struct wildcard_view *v = t->view;
+	uint64_t hit_mask = 0, done_mask = 0;
+	uint32_t n_words = t->key_n_words;
+	uint32_t i;
+
+	for (i = 0; i < v->n_tuples_active; i++) {
+		struct wildcard_tuple *tuple = &v->tuple[v->tuple_active[i]];
+		uint64_t pending_mask, tuple_hit_mask;
+		uint32_t n_keys = 0;
+
+		/* Keys of the packets that can still get a better match */
+		for (pending_mask = pkts_mask & ~done_mask; pending_mask; ) {
+			uint32_t pkt_index_crt = __builtin_ctzll(pending_mask);
+			uint64_t pkt_mask = 1LLU << pkt_index_crt;
+			uint64_t *pkt_key;
+			uint32_t w;
+
+			pending_mask &= ~pkt_mask;
+
+			if ((hit_mask & pkt_mask) &&
+				(priority[pkt_index_crt] <= tuple->priority)) {
+				done_mask |= pkt_mask;
+				continue;
+			}
+
+			pkt_key = RTE_MBUF_METADATA_UINT64_PTR(
+				pkts[pkt_index_crt], t->key_offset);
+			for (w = 0; w < n_words; w++)
+				keys[n_keys][w] = pkt_key[w] & tuple->mask[w];
+
+			key_ptrs[n_keys] = keys[n_keys];
+			pkt_index[n_keys] = pkt_index_crt;
+			n_keys++;
+		}
+
+		/* Tuples are sorted by priority, so we are done */
+		if (n_keys == 0)
+			break;
+
+		tuple_hit_mask = 0;
+		rte_hash_lookup_bulk_data(tuple->h, key_ptrs, n_keys,
+			&tuple_hit_mask, data);
+
+		for ( ; tuple_hit_mask; ) {
+			uint32_t key_index = __builtin_ctzll(tuple_hit_mask);
+			struct wildcard_rule *r = data[key_index];
+			uint32_t pkt_index_crt = pkt_index[key_index];
+			uint64_t pkt_mask = 1LLU << pkt_index_crt;
+
+			tuple_hit_mask &= ~(1LLU << key_index);
+
+			if ((hit_mask & pkt_mask) &&
+				(priority[pkt_index_crt] <= r->priority))
+				continue;
+
+			hit_mask |= pkt_mask;
+			priority[pkt_index_crt] = r->priority;
+			entries[pkt_index_crt] = r->data;
+		}
+	}
+
+	return hit_mask;
+}
+
+static int
+rte_table_wildcard_lookup(
+	void *table,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	uint64_t *lookup_hit_mask,
+	void **entries)
+{
+	struct rte_table_wildcard *t = table;
+	uint64_t pkts_out_mask;
+
+	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
+
+	RTE_TABLE_WILDCARD_STATS_PKTS_IN_ADD(t, n_pkts_in);
+
+	table_sync_reader_enter(&t->sync);
+	pkts_out_mask = lookup_wildcard(t, pkts, pkts_mask, entries);
+	table_sync_reader_exit(&t->sync);
+
+	*lookup_hit_mask = pkts_out_mask;
+	RTE_TABLE_WILDCARD_STATS_PKTS_LOOKUP_MISS(t,
+		n_pkts_in - __builtin_popcountll(pkts_out_mask));
+
+	return 0;
+}
+
+static int
+rte_table_wildcard_stats_read(void *table, struct rte_table_stats *stats,
+	int clear)
+{
+	struct rte_table_wildcard *t = table;
+
+	if (stats != NULL)
+		memcpy(stats, &t->stats, sizeof(t->stats));
+
+	if (clear)
+		memset(&t->stats, 0, sizeof(t->stats));
+
+	return 0;
+}
+
+static void
+rte_table_wildcard_reader_enter(void *table)
+{
+	struct rte_table_wildcard *t = table;
+
+	table_sync_reader_enter(&t->sync);
+}
+
+static void
+rte_table_wildcard_reader_exit(void *table)
+{
+	struct rte_table_wildcard *t = table;
+
+	table_sync_reader_exit(&t->sync);
+}
+
+struct rte_table_ops rte_table_wildcard_ops = {
+	.f_create = rte_table_wildcard_create,
+	.f_free = rte_table_wildcard_free,
+	.f_add = rte_table_wildcard_entry_add,
+	.f_delete = rte_table_wildcard_entry_delete,
+	.f_add_bulk = NULL,
+	.f_delete_bulk = NULL,
+	.f_lookup = rte_table_wildcard_lookup,
+	.f_stats = rte_table_wildcard_stats_read,
+	.f_reader_enter = rte_table_wildcard_reader_enter,
+	.f_reader_exit = rte_table_wildcard_reader_exit,
+};
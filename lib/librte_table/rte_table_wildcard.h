@@ -0,0 +1,126 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __INCLUDE_RTE_TABLE_WILDCARD_H__
+#define __INCLUDE_RTE_TABLE_WILDCARD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * RTE Table Wildcard
+ *
+ * This table associates data to ternary (value/mask) lookup keys, with the
+ * highest priority matching rule being selected for each packet. It uses
+ * tuple space search: the rules sharing the same mask are stored in the same
+ * exact match hash table (tuple), with the lookup probing the tuples in
+ * priority order and stopping as soon as no remaining tuple can hold a
+ * better match.
+ *
+ * Rule add and delete are O(1), as opposed to the ACL table that rebuilds its
+ * run-time context on every update, while the lookup cost grows with the
+ * number of distinct masks. The table is therefore a good fit for rule sets
+ * with high churn and few distinct masks (e.g. OpenFlow).
+ *
+ * Use-cases: OpenFlow flow tables, etc.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ ***/
+
+#include <stdint.h>
+
+#include "rte_table.h"
+
+/** Maximum key size (in bytes) */
+#define RTE_TABLE_WILDCARD_KEY_SIZE_MAX                  64
+
+/** Maximum number of distinct masks (tuples) */
+#define RTE_TABLE_WILDCARD_MASKS_MAX                     32
+
+/** Wildcard table parameters */
+struct rte_table_wildcard_params {
+	/** Name */
+	const char *name;
+
+	/** Key size (number of bytes). Needs to be a non-zero multiple of 8
+	 * not bigger than RTE_TABLE_WILDCARD_KEY_SIZE_MAX.
+	 */
+	uint32_t key_size;
+
+	/** Byte offset within packet meta-data where lookup key is located */
+	uint32_t key_offset;
+
+	/** Maximum number of rules in the table */
+	uint32_t n_rules;
+
+	/** Maximum number of distinct rule masks in the table. Needs to be
+	 * non-zero and not bigger than RTE_TABLE_WILDCARD_MASKS_MAX.
+	 */
+	uint32_t n_masks;
+};
+
+/** Wildcard rule specification for entry add operation */
+struct rte_table_wildcard_rule_add_params {
+	/** Rule priority, with 0 as the highest priority. When several rules
+	 * with the same priority match a packet, any of them can be selected.
+	 */
+	int32_t priority;
+
+	/** Rule key value. Only the key bits set in the mask are relevant. */
+	uint8_t key[RTE_TABLE_WILDCARD_KEY_SIZE_MAX];
+
+	/** Rule key mask */
+	uint8_t mask[RTE_TABLE_WILDCARD_KEY_SIZE_MAX];
+};
+
+/** Wildcard rule specification for entry delete operation */
+struct rte_table_wildcard_rule_delete_params {
+	/** Rule key value. Only the key bits set in the mask are relevant. */
+	uint8_t key[RTE_TABLE_WILDCARD_KEY_SIZE_MAX];
+
+	/** Rule key mask */
+	uint8_t mask[RTE_TABLE_WILDCARD_KEY_SIZE_MAX];
+};
+
+/** Wildcard table operations */
+extern struct rte_table_ops rte_table_wildcard_ops;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
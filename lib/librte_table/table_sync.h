@@ -0,0 +1,173 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __INCLUDE_TABLE_SYNC_H__
+#define __INCLUDE_TABLE_SYNC_H__
+
+/**
+ * @file
+ * Table update synchronization (internal)
+ *
+ * The table entry add/delete operations are executed by a single writer
+ * thread, while the lookup operation can be executed at the same time by
+ * any number of reader threads. The readers never wait for the writer and
+ * never redo a lookup.
+ *
+ * The writer only changes the lookup structure in ways that are safe for a
+ * concurrent lookup: a new entry is fully written before the store that
+ * makes it visible, a whole new structure is published with a single
+ * pointer store, and nothing a reader might still be using is freed or
+ * reused before a grace period has elapsed.
+ *
+ * Each lcore has its own counter, in its own cache line, which is odd while
+ * the lcore is in a read-side section. The grace period ends once every
+ * lcore that was in a read-side section when it started has left it. Threads
+ * that are not EAL lcores share a single counter of readers, so the writer
+ * may have to wait for all of them to be out of the table at the same time.
+ *
+ * The lookup is a read-side section on its own. As the entry data is read by
+ * the table users after the lookup, the users can extend the section to
+ * cover the processing of the entries returned by the lookup (e.g. the table
+ * actions) through the table f_reader_enter and f_reader_exit operations.
+ * The sections nest, so the lookup run within such an extended section does
+ * not end it. An in-place update of the data of an existing entry is still
+ * not atomic with respect to the readers.
+ */
+
+#include <stdint.h>
+
+#include <rte_atomic.h>
+#include <rte_branch_prediction.h>
+#include <rte_lcore.h>
+#include <rte_pause.h>
+
+struct table_sync_lcore {
+	rte_atomic32_t cnt;
+	uint32_t depth; /* Read-side section nesting level */
+} __rte_cache_aligned;
+
+struct table_sync {
+	struct table_sync_lcore lcore[RTE_MAX_LCORE];
+	rte_atomic32_t n_readers_other;
+};
+
+static inline void
+table_sync_init(struct table_sync *s)
+{
+	uint32_t i;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		rte_atomic32_init(&s->lcore[i].cnt);
+		s->lcore[i].depth = 0;
+	}
+	rte_atomic32_init(&s->n_readers_other);
+}
+
+/*
+ * Reader: start of a read-side section. The counter update has to be visible
+ * before the lookup loads. On x86 the locked increment is a full barrier on
+ * its own and is cheaper than the mfence of rte_smp_mb(), as the counter
+ * cache line is owned by this lcore.
+ */
+static inline void
+table_sync_reader_enter(struct table_sync *s)
+{
+	unsigned int lcore_id = rte_lcore_id();
+
+	if (likely(lcore_id < RTE_MAX_LCORE)) {
+		struct table_sync_lcore *l = &s->lcore[lcore_id];
+
+		if (l->depth++ != 0)
+			return;
+
+		rte_atomic32_inc(&l->cnt);
+	} else
+		rte_atomic32_inc(&s->n_readers_other);
+
+#ifndef RTE_ARCH_X86
+	rte_smp_mb();
+#endif
+}
+
+/* Reader: end of a read-side section */
+static inline void
+table_sync_reader_exit(struct table_sync *s)
+{
+	unsigned int lcore_id = rte_lcore_id();
+
+	if (likely(lcore_id < RTE_MAX_LCORE)) {
+		struct table_sync_lcore *l = &s->lcore[lcore_id];
+
+		if (--l->depth != 0)
+			return;
+
+		/*
+		 * The table and entry accesses, including the stores of the
+		 * actions to the entry data, are complete before the counter
+		 * update.
+		 */
+		rte_smp_rmb();
+		rte_smp_wmb();
+		rte_atomic32_set(&l->cnt, rte_atomic32_read(&l->cnt) + 1);
+	} else
+		rte_atomic32_dec(&s->n_readers_other);
+}
+
+/*
+ * Writer: wait until all the lookups that started before this call are
+ * complete. The change to be waited for must be visible before the call.
+ */
+static inline void
+table_sync_wait_readers(struct table_sync *s)
+{
+	uint32_t i;
+
+	rte_smp_mb();
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		int32_t cnt = rte_atomic32_read(&s->lcore[i].cnt);
+
+		if ((cnt & 1) == 0)
+			continue;
+
+		while (rte_atomic32_read(&s->lcore[i].cnt) == cnt)
+			rte_pause();
+	}
+
+	while (rte_atomic32_read(&s->n_readers_other) != 0)
+		rte_pause();
+
+	rte_smp_mb();
+}
+
+#endif
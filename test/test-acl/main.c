@@ -66,6 +66,7 @@
 #define	OPT_BLD_CATEGORIES	"bldcat"
 #define	OPT_RUN_CATEGORIES	"runcat"
 #define	OPT_MAX_SIZE		"maxsize"
+#define	OPT_BLD_THREADS		"bldthreads"
 #define	OPT_ITER_NUM		"iter"
 #define	OPT_VERBOSE		"verbose"
 #define	OPT_IPV6		"ipv6"
@@ -109,6 +110,10 @@ static const struct acl_alg acl_alg[] = {
 		.name = "altivec",
 		.alg = RTE_ACL_CLASSIFY_ALTIVEC,
 	},
+	{
+		.name = "avx512",
+		.alg = RTE_ACL_CLASSIFY_AVX512,
+	},
 };
 
 static struct {
@@ -118,6 +123,7 @@ static struct {
 	size_t              max_size;
 	uint32_t            bld_categories;
 	uint32_t            run_categories;
+	uint32_t            bld_threads;
 	uint32_t            nb_rules;
 	uint32_t            nb_traces;
 	uint32_t            trace_step;
@@ -132,6 +138,7 @@ static struct {
 } config = {
 	.bld_categories = 3,
 	.run_categories = 1,
+	.bld_threads = 1,
 	.nb_rules = RULE_NUM,
 	.nb_traces = TRACE_DEFAULT_NUM,
 	.trace_step = TRACE_STEP_DEF,
@@ -785,6 +792,8 @@ static void
 acx_init(void)
 {
 	int ret;
+	uint32_t n;
+	uint64_t tm, tm1;
 	FILE *f;
 	struct rte_acl_config cfg;
 
@@ -829,12 +838,33 @@ acx_init(void)
 
 	fclose(f);
 
-	/* perform build. */
-	ret = rte_acl_build(config.acx, &cfg);
+	/*
+	 * perform build, if more than one build thread is requested,
+	 * report how build time scales with the number of threads.
+	 */
+	tm1 = 0;
+	for (n = 1; ; n = RTE_MIN(n * 2, config.bld_threads)) {
 
-	dump_verbose(DUMP_NONE, stdout,
-		"rte_acl_build(%u) finished with %d\n",
-		config.bld_categories, ret);
+		ret = rte_acl_set_ctx_build_threads(config.acx, n);
+		if (ret != 0)
+			rte_exit(ret, "failed to setup %u build threads "
+				"for ACL context\n", n);
+
+		tm = rte_rdtsc();
+		ret = rte_acl_build(config.acx, &cfg);
+		tm = rte_rdtsc() - tm;
+		tm1 = (n == 1) ? tm : tm1;
+
+		dump_verbose(DUMP_NONE, stdout,
+			"rte_acl_build(%u) with %u thread(s) finished with %d, "
+			"%" PRIu64 " cycles (%.3Lf sec), speedup: %.2Lf\n",
+			config.bld_categories, n, ret, tm,
+			(long double)tm / rte_get_tsc_hz(),
+			(long double)tm1 / tm);
+
+		if (ret != 0 || n == config.bld_threads)
+			break;
+	}
 
 	rte_acl_dump(config.acx);
 
@@ -974,16 +1004,20 @@ print_usage(const char *prgname)
 		"[--" OPT_RUN_CATEGORIES
 			"=<number of categories to run with> "
 			"should be either 1 or multiple of %zu, "
-			"but not greater then %u]\n"
+			"but not greater than %u]\n"
 		"[--" OPT_MAX_SIZE
 			"=<size limit (in bytes) for runtime ACL strucutures> "
 			"leave 0 for default behaviour]\n"
+		"[--" OPT_BLD_THREADS
+			"=<number of threads to build with, "
+			"not greater than %u>]\n"
 		"[--" OPT_ITER_NUM "=<number of iterations to perform>]\n"
 		"[--" OPT_VERBOSE "=<verbose level>]\n"
 		"[--" OPT_SEARCH_ALG "=%s]\n"
 		"[--" OPT_IPV6 "=<IPv6 rules and trace files>]\n",
 		prgname, RTE_ACL_RESULTS_MULTIPLIER,
 		(uint32_t)RTE_ACL_MAX_CATEGORIES,
+		(uint32_t)RTE_ACL_MAX_BUILD_THREADS,
 		buf);
 }
 
@@ -999,6 +1033,7 @@ dump_config(FILE *f)
 	fprintf(f, "%s:%u\n", OPT_BLD_CATEGORIES, config.bld_categories);
 	fprintf(f, "%s:%u\n", OPT_RUN_CATEGORIES, config.run_categories);
 	fprintf(f, "%s:%zu\n", OPT_MAX_SIZE, config.max_size);
+	fprintf(f, "%s:%u\n", OPT_BLD_THREADS, config.bld_threads);
 	fprintf(f, "%s:%u\n", OPT_ITER_NUM, config.iter_num);
 	fprintf(f, "%s:%u\n", OPT_VERBOSE, config.verbose);
 	fprintf(f, "%s:%u(%s)\n", OPT_SEARCH_ALG, config.alg.alg,
@@ -1026,6 +1061,7 @@ get_input_opts(int argc, char **argv)
 		{OPT_TRACE_NUM, 1, 0, 0},
 		{OPT_RULE_NUM, 1, 0, 0},
 		{OPT_MAX_SIZE, 1, 0, 0},
+		{OPT_BLD_THREADS, 1, 0, 0},
 		{OPT_TRACE_STEP, 1, 0, 0},
 		{OPT_BLD_CATEGORIES, 1, 0, 0},
 		{OPT_RUN_CATEGORIES, 1, 0, 0},
@@ -1055,6 +1091,11 @@ get_input_opts(int argc, char **argv)
 		} else if (strcmp(lgopts[opt_idx].name, OPT_MAX_SIZE) == 0) {
 			config.max_size = get_ulong_opt(optarg,
 				lgopts[opt_idx].name, 0, SIZE_MAX);
+		} else if (strcmp(lgopts[opt_idx].name,
+				OPT_BLD_THREADS) == 0) {
+			config.bld_threads = get_ulong_opt(optarg,
+				lgopts[opt_idx].name, 1,
+				RTE_ACL_MAX_BUILD_THREADS);
 		} else if (strcmp(lgopts[opt_idx].name, OPT_TRACE_NUM) == 0) {
 			config.nb_traces = get_ulong_opt(optarg,
 				lgopts[opt_idx].name, 1, UINT32_MAX);
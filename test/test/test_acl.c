@@ -41,7 +41,10 @@
 #include <rte_byteorder.h>
 #include <rte_ip.h>
 #include <rte_acl.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
 #include <rte_common.h>
+#include <rte_cpuflags.h>
 
 #include "test_acl.h"
 
@@ -475,6 +478,580 @@ test_classify(void)
 	return ret;
 }
 
+static int
+test_delta_add(struct rte_acl_ctx *acx,
+	const struct rte_acl_ipv4vlan_rule *rules, uint32_t num)
+{
+	int ret;
+	uint32_t i;
+	struct acl_ipv4vlan_rule rv;
+
+	for (i = 0, ret = 0; i != num && ret == 0; i++) {
+		acl_ipv4vlan_convert_rule(rules + i, &rv);
+		ret = rte_acl_delta_add_rules(acx,
+			(struct rte_acl_rule *)&rv, 1);
+	}
+
+	return ret;
+}
+
+/*
+ * Compare results of the context with incremental updates
+ * against the context built from scratch.
+ */
+static int
+test_delta_cmp(struct rte_acl_ctx *acx, struct rte_acl_ctx *ref)
+{
+	int ret;
+	uint32_t i;
+	uint32_t results[RTE_DIM(acl_test_data) * RTE_ACL_MAX_CATEGORIES];
+	uint32_t expected[RTE_DIM(acl_test_data) * RTE_ACL_MAX_CATEGORIES];
+	const uint8_t *data[RTE_DIM(acl_test_data)];
+
+	bswap_test_data(acl_test_data, RTE_DIM(acl_test_data), 1);
+
+	for (i = 0; i != RTE_DIM(acl_test_data); i++)
+		data[i] = (uint8_t *)&acl_test_data[i];
+
+	ret = rte_acl_classify(acx, data, results, RTE_DIM(acl_test_data),
+		RTE_ACL_MAX_CATEGORIES);
+	if (ret == 0)
+		ret = rte_acl_classify(ref, data, expected,
+			RTE_DIM(acl_test_data), RTE_ACL_MAX_CATEGORIES);
+
+	bswap_test_data(acl_test_data, RTE_DIM(acl_test_data), 0);
+
+	if (ret != 0) {
+		printf("Line %i: classify failed!\n", __LINE__);
+		return ret;
+	}
+
+	for (i = 0; i != RTE_DIM(results); i++) {
+		if (results[i] != expected[i]) {
+			printf("Line %i: Error in results at %u "
+				"(expected %"PRIu32" got %"PRIu32")!\n",
+				__LINE__, i, expected[i], results[i]);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Test incremental rule add/delete.
+ */
+static int
+test_delta(void)
+{
+	struct rte_acl_param param;
+	struct rte_acl_ctx *acx, *ref;
+	uint32_t i, n, userdata[RTE_DIM(acl_test_rules)];
+	int ret;
+
+	memcpy(&param, &acl_param, sizeof(param));
+	acx = rte_acl_create(&param);
+	param.name = "acl_ctx_ref";
+	ref = rte_acl_create(&param);
+	if (acx == NULL || ref == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		ret = -1;
+		goto err;
+	}
+
+	/* build first half of rules, the rest goes through the delta. */
+	n = RTE_DIM(acl_test_rules) / 2;
+	ret = test_classify_buid(acx, acl_test_rules, n);
+	if (ret == 0)
+		ret = rte_acl_delta_setup(acx, 32);
+	if (ret != 0) {
+		printf("Line %i: Error setting up delta!\n", __LINE__);
+		goto err;
+	}
+
+	ret = rte_acl_delta_setup(acx, 32);
+	if (ret != -EEXIST) {
+		printf("Line %i: Second delta setup should fail!\n", __LINE__);
+		ret = -1;
+		goto err;
+	}
+
+	/* add the rest incrementally, results should match full rule set. */
+	ret = test_delta_add(acx, acl_test_rules + n,
+		RTE_DIM(acl_test_rules) - n);
+	if (ret != 0) {
+		printf("Line %i: Adding delta rules failed!\n", __LINE__);
+		goto err;
+	}
+
+	ret = test_classify_run(acx);
+	if (ret != 0) {
+		printf("Line %i: %s failed!\n", __LINE__, __func__);
+		goto err;
+	}
+
+	/* duplicate userdata is not allowed. */
+	ret = test_delta_add(acx, acl_test_rules, 1);
+	if (ret != -EEXIST) {
+		printf("Line %i: Adding duplicate rule should fail!\n",
+			__LINE__);
+		ret = -1;
+		goto err;
+	}
+
+	/* delete every third rule, compare with the reference context. */
+	ret = 0;
+	for (i = 0, n = 0; i != RTE_DIM(acl_test_rules); i++) {
+		if (i % 3 == 0)
+			userdata[n++] = acl_test_rules[i].data.userdata;
+		else
+			ret |= rte_acl_ipv4vlan_add_rules(ref,
+				acl_test_rules + i, 1);
+	}
+
+	ret |= rte_acl_ipv4vlan_build(ref, ipv4_7tuple_layout,
+		RTE_ACL_MAX_CATEGORIES);
+	if (ret != 0) {
+		printf("Line %i: Building reference context failed!\n",
+			__LINE__);
+		goto err;
+	}
+
+	for (i = 0; i != n; i++) {
+		ret = rte_acl_delta_del_rules(acx, userdata + i, 1);
+		if (ret != 0) {
+			printf("Line %i: Deleting rule %u failed!\n",
+				__LINE__, userdata[i]);
+			goto err;
+		}
+	}
+
+	ret = rte_acl_delta_del_rules(acx, userdata, 1);
+	if (ret != -ENOENT) {
+		printf("Line %i: Deleting non-existing rule should fail!\n",
+			__LINE__);
+		ret = -1;
+		goto err;
+	}
+
+	ret = test_delta_cmp(acx, ref);
+	if (ret != 0)
+		goto err;
+
+	/* results shouldn't change after merge. */
+	ret = rte_acl_delta_merge(acx);
+	if (ret != 0) {
+		printf("Line %i: Delta merge failed!\n", __LINE__);
+		goto err;
+	}
+
+	rte_acl_dump(acx);
+
+	ret = test_delta_cmp(acx, ref);
+	if (ret != 0)
+		goto err;
+
+	/* add deleted rules back. */
+	for (i = 0; i != RTE_DIM(acl_test_rules) && ret == 0; i += 3)
+		ret = test_delta_add(acx, acl_test_rules + i, 1);
+	if (ret != 0) {
+		printf("Line %i: Adding delta rules failed!\n", __LINE__);
+		goto err;
+	}
+
+	ret = test_classify_run(acx);
+
+err:
+	rte_acl_free(acx);
+	rte_acl_free(ref);
+	return ret;
+}
+
+/*
+ * Test that a failed delta build leaves the context unchanged.
+ */
+static int
+test_delta_add_fail(void)
+{
+	struct rte_acl_param param;
+	struct rte_acl_config cfg;
+	struct rte_acl_ctx *acx, *ref;
+	struct acl_ipv4vlan_rule rv[RTE_DIM(acl_test_rules) - 2];
+	uint32_t i, userdata;
+	int ret;
+
+	memcpy(&param, &acl_param, sizeof(param));
+	acx = rte_acl_create(&param);
+	param.name = "acl_ctx_ref";
+	ref = rte_acl_create(&param);
+	if (acx == NULL || ref == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		ret = -1;
+		goto err;
+	}
+
+	/*
+	 * build main tries with the first two rules only, using the smallest
+	 * max_size that fits them, the delta inherits that limit.
+	 */
+	ret = rte_acl_ipv4vlan_add_rules(acx, acl_test_rules, 2);
+	if (ret == 0)
+		ret = test_classify_buid(ref, acl_test_rules, 2);
+	if (ret != 0) {
+		printf("Line %i: Adding rules failed!\n", __LINE__);
+		goto err;
+	}
+
+	memset(&cfg, 0, sizeof(cfg));
+	acl_ipv4vlan_config(&cfg, ipv4_7tuple_layout,
+		RTE_ACL_MAX_CATEGORIES);
+	for (cfg.max_size = RTE_CACHE_LINE_SIZE; ; cfg.max_size *= 2) {
+		ret = rte_acl_build(acx, &cfg);
+		if (ret != -ERANGE)
+			break;
+	}
+
+	if (ret == 0)
+		ret = rte_acl_delta_setup(acx, RTE_DIM(rv));
+	if (ret != 0) {
+		printf("Line %i: Error setting up delta!\n", __LINE__);
+		goto err;
+	}
+
+	/* the rest of the rules doesn't fit into max_size. */
+	for (i = 0; i != RTE_DIM(rv); i++)
+		acl_ipv4vlan_convert_rule(acl_test_rules + i + 2, rv + i);
+
+	ret = rte_acl_delta_add_rules(acx, (struct rte_acl_rule *)rv,
+		RTE_DIM(rv));
+	if (ret == 0) {
+		printf("Line %i: Delta build should fail!\n", __LINE__);
+		ret = -1;
+		goto err;
+	}
+
+	ret = test_delta_cmp(acx, ref);
+	if (ret != 0)
+		goto err;
+
+	userdata = rv[0].data.userdata;
+	ret = rte_acl_delta_del_rules(acx, &userdata, 1);
+	if (ret != -ENOENT) {
+		printf("Line %i: Rules of the failed add should be gone!\n",
+			__LINE__);
+		ret = -1;
+		goto err;
+	}
+
+	/* the delta should still work after the failure. */
+	userdata = acl_test_rules[1].data.userdata;
+	ret = rte_acl_delta_del_rules(acx, &userdata, 1);
+	if (ret == 0) {
+		rte_acl_reset_rules(ref);
+		ret = test_classify_buid(ref, acl_test_rules, 1);
+	}
+	if (ret != 0) {
+		printf("Line %i: Deleting rule %u failed!\n", __LINE__,
+			userdata);
+		goto err;
+	}
+
+	ret = test_delta_cmp(acx, ref);
+
+err:
+	rte_acl_free(acx);
+	rte_acl_free(ref);
+	return ret;
+}
+
+#define	TEST_BUILD_THREADS	4
+#define	TEST_BUILD_RULES	0x800
+#define	TEST_BUILD_TRACES	0x1000
+
+/*
+ * Generate a random rule and a trace that is likely to match it.
+ */
+static void
+test_build_gen_rule(struct rte_acl_ipv4vlan_rule *rule,
+	struct ipv4_7tuple *trace, uint32_t id)
+{
+	uint32_t mask;
+	uint64_t rnd;
+
+	memset(rule, 0, sizeof(*rule));
+	rule->data.userdata = id + 1;
+	rule->data.category_mask = ACL_ALLOW_MASK | ACL_DENY_MASK;
+	rule->data.priority = rte_rand() % RTE_ACL_MAX_PRIORITY;
+
+	rnd = rte_rand();
+	rule->proto = (rnd & 1) ? IPPROTO_TCP : IPPROTO_UDP;
+	rule->proto_mask = (rnd & 2) ? UINT8_MAX : 0;
+	rule->src_addr = rnd >> 32;
+	rule->src_mask_len = (rnd >> 8) % 33;
+	rule->dst_addr = rte_rand();
+	rule->dst_mask_len = (rnd >> 16) % 33;
+
+	rnd = rte_rand();
+	rule->src_port_low = rnd;
+	rule->src_port_high = rule->src_port_low +
+		(uint16_t)(rnd >> 16) % (UINT16_MAX - rule->src_port_low + 1);
+	rule->dst_port_low = rnd >> 32;
+	rule->dst_port_high = rule->dst_port_low +
+		(uint16_t)(rnd >> 48) % (UINT16_MAX - rule->dst_port_low + 1);
+
+	rnd = rte_rand();
+	memset(trace, 0, sizeof(*trace));
+	trace->proto = rule->proto;
+	mask = RTE_ACL_MASKLEN_TO_BITMASK(rule->src_mask_len, sizeof(mask));
+	trace->ip_src = rte_cpu_to_be_32((rule->src_addr & mask) |
+		((uint32_t)rnd & ~mask));
+	mask = RTE_ACL_MASKLEN_TO_BITMASK(rule->dst_mask_len, sizeof(mask));
+	trace->ip_dst = rte_cpu_to_be_32((rule->dst_addr & mask) |
+		((uint32_t)(rnd >> 32) & ~mask));
+	trace->port_src = rte_cpu_to_be_16(rule->src_port_low);
+	trace->port_dst = rte_cpu_to_be_16(rule->dst_port_high);
+}
+
+/*
+ * Test that multi-threaded build produces the same results
+ * as the single-threaded one.
+ */
+static int
+test_build_threads(void)
+{
+	struct rte_acl_param param;
+	struct rte_acl_ctx *acx, *ref;
+	struct rte_acl_ipv4vlan_rule *rules;
+	struct ipv4_7tuple *traces;
+	const uint8_t **data;
+	uint32_t *results, *expected;
+	uint32_t i, n;
+	int ret;
+
+	n = TEST_BUILD_TRACES * RTE_ACL_MAX_CATEGORIES;
+	rules = rte_zmalloc(NULL, TEST_BUILD_RULES * sizeof(rules[0]), 0);
+	traces = rte_zmalloc(NULL, TEST_BUILD_TRACES * sizeof(traces[0]), 0);
+	data = rte_zmalloc(NULL, TEST_BUILD_TRACES * sizeof(data[0]), 0);
+	results = rte_zmalloc(NULL, n * sizeof(results[0]), 0);
+	expected = rte_zmalloc(NULL, n * sizeof(expected[0]), 0);
+
+	memcpy(&param, &acl_param, sizeof(param));
+	acx = rte_acl_create(&param);
+	param.name = "acl_ctx_ref";
+	ref = rte_acl_create(&param);
+
+	if (rules == NULL || traces == NULL || data == NULL ||
+			results == NULL || expected == NULL ||
+			acx == NULL || ref == NULL) {
+		printf("Line %i: Error allocating test data!\n", __LINE__);
+		ret = -1;
+		goto err;
+	}
+
+	ret = rte_acl_set_ctx_build_threads(acx, 0);
+	if (ret != -EINVAL) {
+		printf("Line %i: Setting 0 build threads should fail!\n",
+			__LINE__);
+		ret = -1;
+		goto err;
+	}
+
+	ret = rte_acl_set_ctx_build_threads(acx,
+		RTE_ACL_MAX_BUILD_THREADS + 1);
+	if (ret != -EINVAL) {
+		printf("Line %i: Setting %u build threads should fail!\n",
+			__LINE__, RTE_ACL_MAX_BUILD_THREADS + 1);
+		ret = -1;
+		goto err;
+	}
+
+	ret = rte_acl_set_ctx_build_threads(acx, TEST_BUILD_THREADS);
+	if (ret != 0) {
+		printf("Line %i: Setting build threads failed!\n", __LINE__);
+		goto err;
+	}
+
+	for (i = 0; i != TEST_BUILD_RULES; i++)
+		test_build_gen_rule(rules + i,
+			traces + i % TEST_BUILD_TRACES, i);
+
+	for (i = 0; i != TEST_BUILD_TRACES; i++)
+		data[i] = (const uint8_t *)(traces + i);
+
+	ret = test_classify_buid(acx, rules, TEST_BUILD_RULES);
+	if (ret == 0)
+		ret = test_classify_buid(ref, rules, TEST_BUILD_RULES);
+	if (ret != 0) {
+		printf("Line %i: Building ACL contexts failed!\n", __LINE__);
+		goto err;
+	}
+
+	rte_acl_dump(acx);
+
+	ret = rte_acl_classify(acx, data, results, TEST_BUILD_TRACES,
+		RTE_ACL_MAX_CATEGORIES);
+	if (ret == 0)
+		ret = rte_acl_classify(ref, data, expected, TEST_BUILD_TRACES,
+			RTE_ACL_MAX_CATEGORIES);
+	if (ret != 0) {
+		printf("Line %i: classify failed!\n", __LINE__);
+		goto err;
+	}
+
+	for (i = 0; i != n; i++) {
+		if (results[i] != expected[i]) {
+			printf("Line %i: Error in results at %u "
+				"(expected %"PRIu32" got %"PRIu32")!\n",
+				__LINE__, i, expected[i], results[i]);
+			ret = -1;
+			goto err;
+		}
+	}
+
+err:
+	rte_acl_free(acx);
+	rte_acl_free(ref);
+	rte_free(rules);
+	rte_free(traces);
+	rte_free(data);
+	rte_free(results);
+	rte_free(expected);
+	return ret;
+}
+
+#define	TEST_ALG_RULES	0x800
+#define	TEST_ALG_TRACES	0x1000
+
+static int
+test_avx512_supported(void)
+{
+#ifdef RTE_ARCH_X86
+	return rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) > 0 &&
+		rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512BW) > 0;
+#else
+	return 0;
+#endif
+}
+
+/*
+ * Test that the AVX512 classify method returns the same results as the
+ * scalar one on the same traces, for burst sizes around the 16 and 32 flows
+ * it processes at once, and for one and for all the categories.
+ */
+static int
+test_classify_avx512(void)
+{
+	static const uint32_t nums[] = {
+		1, 8, 15, 16, 17, 31, 32, 33, 48, 64, 100, TEST_ALG_TRACES,
+	};
+	static const uint32_t categories[] = {1, RTE_ACL_MAX_CATEGORIES};
+	struct rte_acl_ctx *acx;
+	struct rte_acl_ipv4vlan_rule *rules;
+	struct ipv4_7tuple *traces;
+	const uint8_t **data;
+	uint32_t *results, *expected;
+	uint32_t i, j, k, n;
+	int ret;
+
+	if (!test_avx512_supported()) {
+		printf("AVX512 not supported, skipping %s\n", __func__);
+		return 0;
+	}
+
+	n = TEST_ALG_TRACES * RTE_ACL_MAX_CATEGORIES;
+	rules = rte_zmalloc(NULL, TEST_ALG_RULES * sizeof(rules[0]), 0);
+	traces = rte_zmalloc(NULL, TEST_ALG_TRACES * sizeof(traces[0]), 0);
+	data = rte_zmalloc(NULL, TEST_ALG_TRACES * sizeof(data[0]), 0);
+	results = rte_zmalloc(NULL, n * sizeof(results[0]), 0);
+	expected = rte_zmalloc(NULL, n * sizeof(expected[0]), 0);
+	acx = rte_acl_create(&acl_param);
+
+	if (rules == NULL || traces == NULL || data == NULL ||
+			results == NULL || expected == NULL || acx == NULL) {
+		printf("Line %i: Error allocating test data!\n", __LINE__);
+		ret = -1;
+		goto err;
+	}
+
+	/* half of the traces match a rule, the other half are random */
+	for (i = 0; i != TEST_ALG_RULES; i++)
+		test_build_gen_rule(rules + i, traces + i, i);
+
+	for (i = TEST_ALG_RULES; i != TEST_ALG_TRACES; i++) {
+		uint64_t rnd = rte_rand();
+
+		traces[i].proto = (rnd & 1) ? IPPROTO_TCP : IPPROTO_UDP;
+		traces[i].ip_src = rnd >> 32;
+		traces[i].ip_dst = rte_rand();
+		traces[i].port_src = rnd >> 8;
+		traces[i].port_dst = rnd >> 16;
+	}
+
+	for (i = 0; i != TEST_ALG_TRACES; i++)
+		data[i] = (const uint8_t *)(traces + i);
+
+	ret = test_classify_buid(acx, rules, TEST_ALG_RULES);
+	if (ret != 0) {
+		printf("Line %i: Building ACL context failed!\n", __LINE__);
+		goto err;
+	}
+
+	for (i = 0; i != RTE_DIM(categories); i++) {
+		for (j = 0; j != RTE_DIM(nums); j++) {
+			n = nums[j] * categories[i];
+			memset(results, 0, n * sizeof(results[0]));
+			memset(expected, 0, n * sizeof(expected[0]));
+
+			ret = rte_acl_classify_alg(acx, data, expected,
+				nums[j], categories[i],
+				RTE_ACL_CLASSIFY_SCALAR);
+			if (ret != 0) {
+				printf("Line %i: scalar classify failed!\n",
+					__LINE__);
+				goto err;
+			}
+
+			ret = rte_acl_classify_alg(acx, data, results,
+				nums[j], categories[i],
+				RTE_ACL_CLASSIFY_AVX512);
+			if (ret == -ENOTSUP) {
+				printf("AVX512 classify not built, "
+					"skipping %s\n", __func__);
+				ret = 0;
+				goto err;
+			}
+			if (ret != 0) {
+				printf("Line %i: AVX512 classify failed!\n",
+					__LINE__);
+				goto err;
+			}
+
+			for (k = 0; k != n; k++) {
+				if (results[k] != expected[k]) {
+					printf("Line %i: Error in results at "
+						"%u, num %u, categories %u "
+						"(expected %"PRIu32
+						" got %"PRIu32")!\n",
+						__LINE__, k, nums[j],
+						categories[i], expected[k],
+						results[k]);
+					ret = -1;
+					goto err;
+				}
+			}
+		}
+	}
+
+err:
+	rte_acl_free(acx);
+	rte_free(rules);
+	rte_free(traces);
+	rte_free(data);
+	rte_free(results);
+	rte_free(expected);
+	return ret;
+}
+
 static int
 test_build_ports_range(void)
 {
@@ -1641,6 +2218,14 @@ test_acl(void)
 		return -1;
 	if (test_classify() < 0)
 		return -1;
+	if (test_delta() < 0)
+		return -1;
+	if (test_delta_add_fail() < 0)
+		return -1;
+	if (test_build_threads() < 0)
+		return -1;
+	if (test_classify_avx512() < 0)
+		return -1;
 	if (test_build_ports_range() < 0)
 		return -1;
 	if (test_convert() < 0)
@@ -47,6 +47,12 @@
 #include <rte_cryptodev_scheduler_operations.h>
 #endif
 
+#ifdef RTE_LIBRTE_PMD_OPENSSL
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <rte_pmd_openssl.h>
+#endif
+
 #include "test.h"
 #include "test_cryptodev.h"
 
@@ -6003,6 +6009,342 @@ test_AES_GCM_authenticated_decryption_sessionless_test_case_1(void)
 			&gcm_test_case_5);
 }
 
+#ifdef RTE_LIBRTE_PMD_OPENSSL
+static int
+test_openssl_sessionless_cache(void)
+{
+	struct crypto_testsuite_params *ts_params = &testsuite_params;
+	struct crypto_unittest_params *ut_params = &unittest_params;
+	struct rte_pmd_openssl_sessless_stats stats;
+	unsigned int i;
+
+	/* the cache is compiled out */
+	if (RTE_LIBRTE_PMD_OPENSSL_SESSLESS_CACHE_SIZE == 0)
+		return -ENOTSUP;
+
+	rte_cryptodev_stats_reset(ts_params->valid_devs[0]);
+
+	/* the first op builds the session, the next ones reuse it */
+	for (i = 0; i < 3; i++) {
+		TEST_ASSERT_SUCCESS(test_authenticated_encryption_sessionless(
+				&gcm_test_case_5),
+				"Session-less encryption %u failed", i);
+
+		rte_crypto_op_free(ut_params->op);
+		ut_params->op = NULL;
+		rte_pktmbuf_free(ut_params->ibuf);
+		ut_params->ibuf = NULL;
+	}
+
+	/* the same key for the other direction is another session */
+	TEST_ASSERT_SUCCESS(test_authenticated_decryption_sessionless(
+			&gcm_test_case_5), "Session-less decryption failed");
+
+	TEST_ASSERT_SUCCESS(rte_pmd_openssl_sessless_stats_get(
+			ts_params->valid_devs[0], &stats),
+			"Failed to get session-less cache stats");
+	TEST_ASSERT_EQUAL(stats.misses, 2, "Unexpected number of misses: %"
+			PRIu64, stats.misses);
+	TEST_ASSERT_EQUAL(stats.hits, 2, "Unexpected number of hits: %"
+			PRIu64, stats.hits);
+	TEST_ASSERT_EQUAL(stats.bypassed, 0, "Unexpected bypasses: %"
+			PRIu64, stats.bypassed);
+
+	rte_cryptodev_stats_reset(ts_params->valid_devs[0]);
+	TEST_ASSERT_SUCCESS(rte_pmd_openssl_sessless_stats_get(
+			ts_params->valid_devs[0], &stats),
+			"Failed to get session-less cache stats");
+	TEST_ASSERT_EQUAL(stats.hits + stats.misses, 0,
+			"Session-less cache stats not reset");
+
+	return TEST_SUCCESS;
+}
+
+#define OPENSSL_HMAC_BURST_SIZE 12
+
+/*
+ * Authenticate a burst mixing HMAC-SHA1 and HMAC-SHA256 sessions, which the
+ * multi-buffer engine hashes several operations at a time when available.
+ */
+static int
+test_openssl_hmac_burst(enum rte_crypto_auth_operation auth_op)
+{
+	struct crypto_testsuite_params *ts_params = &testsuite_params;
+	const struct blockcipher_test_data *tdata[] = {
+		&hmac_sha1_test_vector,
+		&hmac_sha256_test_vector,
+	};
+	struct rte_crypto_op *ops[OPENSSL_HMAC_BURST_SIZE];
+	struct rte_crypto_op *deq_ops[OPENSSL_HMAC_BURST_SIZE];
+	struct rte_cryptodev_sym_session *sess[RTE_DIM(tdata)];
+	uint8_t keys[RTE_DIM(tdata)][64];
+	struct rte_crypto_sym_xform xform;
+	const struct blockcipher_test_data *t;
+	enum rte_crypto_op_status status;
+	uint8_t dev_id = ts_params->valid_devs[0];
+	unsigned int i, nb_deq;
+	struct rte_mbuf *m;
+	uint8_t *digest;
+
+	for (i = 0; i < RTE_DIM(tdata); i++) {
+		memcpy(keys[i], tdata[i]->auth_key.data,
+				tdata[i]->auth_key.len);
+
+		memset(&xform, 0, sizeof(xform));
+		xform.type = RTE_CRYPTO_SYM_XFORM_AUTH;
+		xform.auth.op = auth_op;
+		xform.auth.algo = tdata[i]->auth_algo;
+		xform.auth.key.data = keys[i];
+		xform.auth.key.length = tdata[i]->auth_key.len;
+		xform.auth.digest_length = tdata[i]->digest.len;
+
+		sess[i] = rte_cryptodev_sym_session_create(
+				ts_params->session_mpool);
+		TEST_ASSERT_NOT_NULL(sess[i], "Session creation failed");
+		TEST_ASSERT_SUCCESS(rte_cryptodev_sym_session_init(dev_id,
+				sess[i], &xform, ts_params->session_mpool),
+				"Session init failed");
+	}
+
+	/* first half of the burst is HMAC-SHA1, second half HMAC-SHA256 */
+	for (i = 0; i < OPENSSL_HMAC_BURST_SIZE; i++) {
+		t = tdata[i * RTE_DIM(tdata) / OPENSSL_HMAC_BURST_SIZE];
+
+		ops[i] = rte_crypto_op_alloc(ts_params->op_mpool,
+				RTE_CRYPTO_OP_TYPE_SYMMETRIC);
+		TEST_ASSERT_NOT_NULL(ops[i], "Failed to allocate operation");
+		m = rte_pktmbuf_alloc(ts_params->mbuf_pool);
+		TEST_ASSERT_NOT_NULL(m, "Failed to allocate mbuf");
+
+		memcpy(rte_pktmbuf_append(m, t->ciphertext.len),
+				t->ciphertext.data, t->ciphertext.len);
+		digest = (uint8_t *)rte_pktmbuf_append(m, t->digest.len);
+		TEST_ASSERT_NOT_NULL(digest, "No room for the digest");
+		if (auth_op == RTE_CRYPTO_AUTH_OP_VERIFY) {
+			memcpy(digest, t->digest.data, t->digest.len);
+			/* one corrupted digest in each half */
+			if (i % (OPENSSL_HMAC_BURST_SIZE / 2) == 3)
+				digest[0] ^= 0x1;
+		} else
+			memset(digest, 0, t->digest.len);
+
+		ops[i]->sym->m_src = m;
+		ops[i]->sym->auth.data.offset = 0;
+		ops[i]->sym->auth.data.length = t->ciphertext.len;
+		ops[i]->sym->auth.digest.data = digest;
+		rte_crypto_op_attach_sym_session(ops[i],
+			sess[i * RTE_DIM(tdata) / OPENSSL_HMAC_BURST_SIZE]);
+	}
+
+	TEST_ASSERT_EQUAL(rte_cryptodev_enqueue_burst(dev_id, 0, ops,
+			OPENSSL_HMAC_BURST_SIZE), OPENSSL_HMAC_BURST_SIZE,
+			"Failed to enqueue the burst");
+
+	for (nb_deq = 0; nb_deq < OPENSSL_HMAC_BURST_SIZE; )
+		nb_deq += rte_cryptodev_dequeue_burst(dev_id, 0,
+				&deq_ops[nb_deq],
+				OPENSSL_HMAC_BURST_SIZE - nb_deq);
+
+	for (i = 0; i < OPENSSL_HMAC_BURST_SIZE; i++) {
+		t = tdata[i * RTE_DIM(tdata) / OPENSSL_HMAC_BURST_SIZE];
+
+		TEST_ASSERT_EQUAL(deq_ops[i], ops[i],
+				"Operation %u dequeued out of order", i);
+
+		status = RTE_CRYPTO_OP_STATUS_SUCCESS;
+		if (auth_op == RTE_CRYPTO_AUTH_OP_VERIFY &&
+				i % (OPENSSL_HMAC_BURST_SIZE / 2) == 3)
+			status = RTE_CRYPTO_OP_STATUS_AUTH_FAILED;
+		TEST_ASSERT_EQUAL(ops[i]->status, status,
+				"Operation %u: unexpected status %d", i,
+				ops[i]->status);
+
+		if (auth_op == RTE_CRYPTO_AUTH_OP_GENERATE)
+			TEST_ASSERT_BUFFERS_ARE_EQUAL(
+				ops[i]->sym->auth.digest.data,
+				t->digest.data, t->digest.len,
+				"Operation %u: digest mismatch", i);
+
+		rte_pktmbuf_free(ops[i]->sym->m_src);
+		rte_crypto_op_free(ops[i]);
+	}
+
+	for (i = 0; i < RTE_DIM(tdata); i++) {
+		rte_cryptodev_sym_session_clear(dev_id, sess[i]);
+		rte_cryptodev_sym_session_free(sess[i]);
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_openssl_hmac_burst_generate(void)
+{
+	return test_openssl_hmac_burst(RTE_CRYPTO_AUTH_OP_GENERATE);
+}
+
+static int
+test_openssl_hmac_burst_verify(void)
+{
+	return test_openssl_hmac_burst(RTE_CRYPTO_AUTH_OP_VERIFY);
+}
+
+#define OPENSSL_HMAC_MIXED_RUN		16
+#define OPENSSL_HMAC_MIXED_BURST_SIZE	(4 * OPENSSL_HMAC_MIXED_RUN)
+#define OPENSSL_HMAC_MIXED_KEY_MAX	131
+#define OPENSSL_HMAC_MIXED_DATA_MAX	1000
+
+/*
+ * Authenticate a burst of operations of different lengths, under keys
+ * shorter and longer than a block, and check every digest against the
+ * one computed by OpenSSL.
+ */
+static int
+test_openssl_hmac_burst_mixed(enum rte_crypto_auth_operation auth_op)
+{
+	struct crypto_testsuite_params *ts_params = &testsuite_params;
+	static const enum rte_crypto_auth_algorithm algos[] = {
+		RTE_CRYPTO_AUTH_SHA1_HMAC,
+		RTE_CRYPTO_AUTH_SHA256_HMAC,
+	};
+	/* around the padding boundaries of the first blocks */
+	static const uint32_t data_lens[OPENSSL_HMAC_MIXED_RUN] = {
+		0, 1, 55, 56, 57, 63, 64, 65,
+		119, 120, 127, 128, 200, 512, 513,
+		OPENSSL_HMAC_MIXED_DATA_MAX,
+	};
+	static const uint32_t key_lens[] = {
+		20, 64, 65, 100, OPENSSL_HMAC_MIXED_KEY_MAX,
+	};
+	struct rte_cryptodev_sym_session *sess[RTE_DIM(algos)]
+			[RTE_DIM(key_lens)];
+	struct rte_crypto_op *ops[OPENSSL_HMAC_MIXED_BURST_SIZE];
+	struct rte_crypto_op *deq_ops[OPENSSL_HMAC_MIXED_BURST_SIZE];
+	uint8_t refs[OPENSSL_HMAC_MIXED_BURST_SIZE][EVP_MAX_MD_SIZE];
+	unsigned int ref_lens[OPENSSL_HMAC_MIXED_BURST_SIZE];
+	uint8_t key[OPENSSL_HMAC_MIXED_KEY_MAX];
+	uint8_t data[OPENSSL_HMAC_MIXED_DATA_MAX];
+	struct rte_crypto_sym_xform xform;
+	uint8_t dev_id = ts_params->valid_devs[0];
+	unsigned int a, k, i, nb_deq;
+	uint32_t len;
+	struct rte_mbuf *m;
+	uint8_t *digest;
+
+	for (i = 0; i < sizeof(key); i++)
+		key[i] = i * 13 + 7;
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = i * 31 + 3;
+
+	/* the keys differ by their length only */
+	for (a = 0; a < RTE_DIM(algos); a++) {
+		for (k = 0; k < RTE_DIM(key_lens); k++) {
+			memset(&xform, 0, sizeof(xform));
+			xform.type = RTE_CRYPTO_SYM_XFORM_AUTH;
+			xform.auth.op = auth_op;
+			xform.auth.algo = algos[a];
+			xform.auth.key.data = key;
+			xform.auth.key.length = key_lens[k];
+			xform.auth.digest_length =
+				algos[a] == RTE_CRYPTO_AUTH_SHA1_HMAC ?
+				DIGEST_BYTE_LENGTH_SHA1 :
+				DIGEST_BYTE_LENGTH_SHA256;
+
+			sess[a][k] = rte_cryptodev_sym_session_create(
+					ts_params->session_mpool);
+			TEST_ASSERT_NOT_NULL(sess[a][k],
+					"Session creation failed");
+			TEST_ASSERT_SUCCESS(rte_cryptodev_sym_session_init(
+					dev_id, sess[a][k], &xform,
+					ts_params->session_mpool),
+					"Session init failed");
+		}
+	}
+
+	/*
+	 * Runs of operations of the same hash function, so that they share
+	 * the lanes, with the lengths and the keys shuffled within each run.
+	 */
+	for (i = 0; i < OPENSSL_HMAC_MIXED_BURST_SIZE; i++) {
+		a = (i / OPENSSL_HMAC_MIXED_RUN) % RTE_DIM(algos);
+		k = i % RTE_DIM(key_lens);
+		len = data_lens[(i * 7) % OPENSSL_HMAC_MIXED_RUN];
+
+		TEST_ASSERT_NOT_NULL(HMAC(
+				algos[a] == RTE_CRYPTO_AUTH_SHA1_HMAC ?
+				EVP_sha1() : EVP_sha256(),
+				key, key_lens[k], data, len, refs[i],
+				&ref_lens[i]), "OpenSSL HMAC failed");
+
+		ops[i] = rte_crypto_op_alloc(ts_params->op_mpool,
+				RTE_CRYPTO_OP_TYPE_SYMMETRIC);
+		TEST_ASSERT_NOT_NULL(ops[i], "Failed to allocate operation");
+		m = rte_pktmbuf_alloc(ts_params->mbuf_pool);
+		TEST_ASSERT_NOT_NULL(m, "Failed to allocate mbuf");
+
+		memcpy(rte_pktmbuf_append(m, len), data, len);
+		digest = (uint8_t *)rte_pktmbuf_append(m, ref_lens[i]);
+		TEST_ASSERT_NOT_NULL(digest, "No room for the digest");
+		if (auth_op == RTE_CRYPTO_AUTH_OP_VERIFY)
+			memcpy(digest, refs[i], ref_lens[i]);
+		else
+			memset(digest, 0, ref_lens[i]);
+
+		ops[i]->sym->m_src = m;
+		ops[i]->sym->auth.data.offset = 0;
+		ops[i]->sym->auth.data.length = len;
+		ops[i]->sym->auth.digest.data = digest;
+		rte_crypto_op_attach_sym_session(ops[i], sess[a][k]);
+	}
+
+	TEST_ASSERT_EQUAL(rte_cryptodev_enqueue_burst(dev_id, 0, ops,
+			OPENSSL_HMAC_MIXED_BURST_SIZE),
+			OPENSSL_HMAC_MIXED_BURST_SIZE,
+			"Failed to enqueue the burst");
+
+	for (nb_deq = 0; nb_deq < OPENSSL_HMAC_MIXED_BURST_SIZE; )
+		nb_deq += rte_cryptodev_dequeue_burst(dev_id, 0,
+				&deq_ops[nb_deq],
+				OPENSSL_HMAC_MIXED_BURST_SIZE - nb_deq);
+
+	for (i = 0; i < OPENSSL_HMAC_MIXED_BURST_SIZE; i++) {
+		TEST_ASSERT_EQUAL(deq_ops[i], ops[i],
+				"Operation %u dequeued out of order", i);
+		TEST_ASSERT_EQUAL(ops[i]->status,
+				RTE_CRYPTO_OP_STATUS_SUCCESS,
+				"Operation %u: unexpected status %d", i,
+				ops[i]->status);
+		TEST_ASSERT_BUFFERS_ARE_EQUAL(ops[i]->sym->auth.digest.data,
+				refs[i], ref_lens[i],
+				"Operation %u: digest mismatch", i);
+
+		rte_pktmbuf_free(ops[i]->sym->m_src);
+		rte_crypto_op_free(ops[i]);
+	}
+
+	for (a = 0; a < RTE_DIM(algos); a++) {
+		for (k = 0; k < RTE_DIM(key_lens); k++) {
+			rte_cryptodev_sym_session_clear(dev_id, sess[a][k]);
+			rte_cryptodev_sym_session_free(sess[a][k]);
+		}
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_openssl_hmac_burst_mixed_generate(void)
+{
+	return test_openssl_hmac_burst_mixed(RTE_CRYPTO_AUTH_OP_GENERATE);
+}
+
+static int
+test_openssl_hmac_burst_mixed_verify(void)
+{
+	return test_openssl_hmac_burst_mixed(RTE_CRYPTO_AUTH_OP_VERIFY);
+}
+#endif
+
 static int
 test_AES_CCM_authenticated_encryption_test_case_128_1(void)
 {
@@ -6390,8 +6732,10 @@ test_multi_session(void)
 			aes_cbc_iv),
 			"Failed to perform decrypt on request number %u.", i);
 		/* free crypto operation structure */
-		if (ut_params->op)
+		if (ut_params->op) {
 			rte_crypto_op_free(ut_params->op);
+			ut_params->op = NULL;
+		}
 
 		/*
 		 * free mbuf - both obuf and ibuf are usually the same,
@@ -8937,6 +9281,26 @@ static struct unit_test_suite cryptodev_openssl_testsuite  = {
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			test_AES_CCM_authenticated_decryption_test_case_256_3),
 
+		/** Session-less tests */
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			test_AES_GCM_authenticated_encryption_sessionless_test_case_1),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			test_AES_GCM_authenticated_decryption_sessionless_test_case_1),
+#ifdef RTE_LIBRTE_PMD_OPENSSL
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			test_openssl_sessionless_cache),
+
+		/** Multi-buffer HMAC tests */
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			test_openssl_hmac_burst_generate),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			test_openssl_hmac_burst_verify),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			test_openssl_hmac_burst_mixed_generate),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			test_openssl_hmac_burst_mixed_verify),
+#endif
+
 		/** Scatter-Gather */
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			test_AES_GCM_auth_encrypt_SGL_out_of_place_400B_1seg),
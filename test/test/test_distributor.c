@@ -534,6 +534,191 @@ test_flush_with_worker_shutdown(struct worker_params *wp,
 	return 0;
 }
 
+#define AFFINITY_BURST 64
+#define AFFINITY_FLOWS 16
+
+static volatile uint32_t affinity_next_seqn[AFFINITY_FLOWS];
+static volatile unsigned int affinity_order_errors;
+static volatile unsigned int affinity_max_burst;
+
+/* worker function checking that the packets of each flow come in order */
+static int
+handle_work_affinity(void *arg)
+{
+	struct rte_mbuf *buf[AFFINITY_BURST] __rte_cache_aligned;
+	struct worker_params *wp = arg;
+	struct rte_distributor *d = wp->dist;
+	unsigned int id = __sync_fetch_and_add(&worker_idx, 1);
+	unsigned int flow;
+	int i, num = 0;
+
+	while (!quit) {
+		num = rte_distributor_get_pkt_burst(d, id, buf,
+				AFFINITY_BURST, buf, num);
+		if (num < 0)
+			return -1;
+		if ((unsigned int)num > affinity_max_burst)
+			affinity_max_burst = num;
+		for (i = 0; i < num; i++) {
+			flow = buf[i]->hash.usr % AFFINITY_FLOWS;
+			if (buf[i]->seqn != affinity_next_seqn[flow])
+				affinity_order_errors++;
+			affinity_next_seqn[flow] = buf[i]->seqn + 1;
+		}
+		worker_stats[id].handled_packets += num;
+	}
+	rte_distributor_return_pkt(d, id, buf, num);
+	return 0;
+}
+
+/* collects returned packets until count of them came back */
+static unsigned int
+affinity_wait_returns(struct rte_distributor *d, struct rte_mbuf **bufs,
+		unsigned int count)
+{
+	unsigned int num_returned = 0;
+	unsigned int retries = 0;
+	int num;
+
+	do {
+		rte_distributor_flush(d);
+		num = rte_distributor_returned_pkts(d, &bufs[num_returned],
+				count - num_returned);
+		if (num == 0)
+			usleep(1000);
+		num_returned += num;
+	} while (num_returned < count && ++retries < 1000);
+
+	return num_returned;
+}
+
+/* test of the affinity mode:
+ * - send a burst of packets of a single flow and check they go to one
+ *   worker, in one burst larger than the cache line bursts
+ * - send BIG_BATCH packets of several flows, checking in the workers that
+ *   the packets of each flow come in order, and that all come back
+ */
+static int
+sanity_test_affinity(struct worker_params *wp, struct rte_mempool *p)
+{
+	struct rte_distributor *d = wp->dist;
+	struct rte_mbuf *bufs[BIG_BATCH], *returns[BIG_BATCH];
+	unsigned int i, j, count;
+
+	printf("=== Affinity distributor sanity tests ===\n");
+	clear_packet_count();
+	for (i = 0; i < AFFINITY_FLOWS; i++)
+		affinity_next_seqn[i] = 0;
+	affinity_order_errors = 0;
+	affinity_max_burst = 0;
+
+	if (rte_mempool_get_bulk(p, (void *)bufs, BIG_BATCH) != 0) {
+		printf("line %d: Error getting mbufs from pool\n", __LINE__);
+		return -1;
+	}
+
+	for (i = 0; i < AFFINITY_BURST; i++) {
+		bufs[i]->hash.usr = 0;
+		bufs[i]->seqn = i;
+	}
+	rte_distributor_process(d, bufs, AFFINITY_BURST);
+	count = affinity_wait_returns(d, returns, AFFINITY_BURST);
+	if (count != AFFINITY_BURST ||
+			total_packet_count() != AFFINITY_BURST) {
+		printf("Line %d: Error, not all packets flushed. "
+				"Expected %u, got %u\n",
+				__LINE__, AFFINITY_BURST, total_packet_count());
+		goto err;
+	}
+	for (i = 0; i < rte_lcore_count() - 1; i++)
+		if (worker_stats[i].handled_packets != 0 &&
+				worker_stats[i].handled_packets !=
+				AFFINITY_BURST) {
+			printf("Line %d: Error, flow split over workers\n",
+					__LINE__);
+			goto err;
+		}
+	if (affinity_max_burst != AFFINITY_BURST) {
+		printf("Line %d: Error, largest burst was %u, expected %u\n",
+				__LINE__, affinity_max_burst, AFFINITY_BURST);
+		goto err;
+	}
+	printf("Sanity test with a single flow done\n");
+
+	clear_packet_count();
+	for (i = 0; i < AFFINITY_FLOWS; i++)
+		affinity_next_seqn[i] = 0;
+	for (i = 0; i < BIG_BATCH; i++) {
+		bufs[i]->hash.usr = i % AFFINITY_FLOWS;
+		bufs[i]->seqn = i / AFFINITY_FLOWS;
+	}
+	count = 0;
+	for (i = 0; i < BIG_BATCH; i += BURST) {
+		rte_distributor_process(d, &bufs[i], BURST);
+		count += rte_distributor_returned_pkts(d, &returns[count],
+				BIG_BATCH - count);
+	}
+	count += affinity_wait_returns(d, &returns[count], BIG_BATCH - count);
+	if (count != BIG_BATCH) {
+		printf("line %d: Missing packets, expected %d, got %u\n",
+				__LINE__, BIG_BATCH, count);
+		goto err;
+	}
+	for (i = 0; i < BIG_BATCH; i++) {
+		for (j = 0; j < BIG_BATCH; j++)
+			if (returns[j] == bufs[i])
+				break;
+		if (j == BIG_BATCH) {
+			printf("Error: could not find source packet #%u\n", i);
+			goto err;
+		}
+	}
+	if (affinity_order_errors != 0) {
+		printf("Line %d: Error, %u packets out of order\n",
+				__LINE__, affinity_order_errors);
+		goto err;
+	}
+	for (i = 0; i < rte_lcore_count() - 1; i++)
+		printf("Worker %u handled %u packets\n", i,
+				worker_stats[i].handled_packets);
+	printf("Sanity test of flow order done\n");
+
+	rte_mempool_put_bulk(p, (void *)bufs, BIG_BATCH);
+	printf("\n");
+	return 0;
+
+err:
+	rte_mempool_put_bulk(p, (void *)bufs, BIG_BATCH);
+	return -1;
+}
+
+static int
+test_error_distributor_weight(struct rte_distributor *da,
+		struct rte_distributor *db)
+{
+	const unsigned int num_workers = rte_lcore_count() - 1;
+
+	if (rte_distributor_set_worker_weight(da, 0, 0) != -EINVAL ||
+			rte_distributor_set_worker_weight(da, 0,
+				RTE_DIST_WEIGHT_MAX + 1) != -EINVAL ||
+			rte_distributor_set_worker_weight(da, num_workers,
+				1) != -EINVAL) {
+		printf("ERROR: No error on set_worker_weight() with bad param\n");
+		return -1;
+	}
+	if (rte_distributor_set_worker_weight(db, 0, 1) != -ENOTSUP) {
+		printf("ERROR: No error on set_worker_weight() in burst mode\n");
+		return -1;
+	}
+	if (rte_distributor_set_worker_weight(da, 0,
+			RTE_DIST_WEIGHT_MAX) != 0 ||
+			rte_distributor_set_worker_weight(da, 0, 1) != 0) {
+		printf("ERROR: set_worker_weight() failed\n");
+		return -1;
+	}
+	return 0;
+}
+
 static
 int test_error_distributor_create_name(void)
 {
@@ -617,6 +802,7 @@ test_distributor(void)
 {
 	static struct rte_distributor *ds;
 	static struct rte_distributor *db;
+	static struct rte_distributor *da;
 	static struct rte_distributor *dist[2];
 	static struct rte_mempool *p;
 	int i;
@@ -653,6 +839,20 @@ test_distributor(void)
 		rte_distributor_clear_returns(ds);
 	}
 
+	if (da == NULL) {
+		da = rte_distributor_create("Test_dist_affinity",
+				rte_socket_id(),
+				rte_lcore_count() - 1,
+				RTE_DIST_ALG_AFFINITY);
+		if (da == NULL) {
+			printf("Error creating affinity distributor\n");
+			return -1;
+		}
+	} else {
+		rte_distributor_flush(da);
+		rte_distributor_clear_returns(da);
+	}
+
 	const unsigned nb_bufs = (511 * rte_lcore_count()) < BIG_BATCH ?
 			(BIG_BATCH * 2) - 1 : (511 * rte_lcore_count());
 	if (p == NULL) {
@@ -710,8 +910,21 @@ test_distributor(void)
 
 	}
 
+	worker_params.dist = da;
+	sprintf(worker_params.name, "affinity");
+	rte_eal_mp_remote_launch(handle_work_affinity, &worker_params,
+			SKIP_MASTER);
+	if (sanity_test_affinity(&worker_params, p) < 0)
+		goto err;
+	quit = 1;
+	rte_distributor_flush(da);
+	rte_eal_mp_wait_lcore();
+	quit = 0;
+	worker_idx = 0;
+
 	if (test_error_distributor_create_numworkers() == -1 ||
-			test_error_distributor_create_name() == -1) {
+			test_error_distributor_create_name() == -1 ||
+			test_error_distributor_weight(da, db) == -1) {
 		printf("rte_distributor_create parameter check tests failed");
 		return -1;
 	}
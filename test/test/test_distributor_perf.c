@@ -157,6 +157,29 @@ handle_work(void *arg)
 	return 0;
 }
 
+/*
+ * Worker function for the affinity mode, taking bursts of up to BURST
+ * packets at a time.
+ */
+static int
+handle_work_burst(void *arg)
+{
+	struct rte_distributor *d = arg;
+	unsigned int id = __sync_fetch_and_add(&worker_idx, 1);
+	struct rte_mbuf *buf[BURST] __rte_cache_aligned;
+	int num = 0;
+
+	num = rte_distributor_get_pkt_burst(d, id, buf, BURST, buf, num);
+	while (!quit) {
+		worker_stats[id].handled_packets += num;
+		num = rte_distributor_get_pkt_burst(d, id, buf, BURST,
+				buf, num);
+	}
+	worker_stats[id].handled_packets += num;
+	rte_distributor_return_pkt(d, id, buf, num);
+	return 0;
+}
+
 /*
  * This basic performance test just repeatedly sends in 32 packets at a time
  * to the distributor and verifies at the end that we got them all in the worker
@@ -233,6 +256,7 @@ test_distributor_perf(void)
 {
 	static struct rte_distributor *ds;
 	static struct rte_distributor *db;
+	static struct rte_distributor *da;
 	static struct rte_mempool *p;
 
 	if (rte_lcore_count() < 2) {
@@ -267,6 +291,18 @@ test_distributor_perf(void)
 		rte_distributor_clear_returns(db);
 	}
 
+	if (da == NULL) {
+		da = rte_distributor_create("Test_affinity", rte_socket_id(),
+				rte_lcore_count() - 1,
+				RTE_DIST_ALG_AFFINITY);
+		if (da == NULL) {
+			printf("Error creating affinity distributor\n");
+			return -1;
+		}
+	} else {
+		rte_distributor_clear_returns(da);
+	}
+
 	const unsigned nb_bufs = (511 * rte_lcore_count()) < BIG_BATCH ?
 			(BIG_BATCH * 2) - 1 : (511 * rte_lcore_count());
 	if (p == NULL) {
@@ -290,6 +326,19 @@ test_distributor_perf(void)
 		return -1;
 	quit_workers(db, p);
 
+	printf("=== Performance test of distributor (affinity mode) ===\n");
+	rte_eal_mp_remote_launch(handle_work, da, SKIP_MASTER);
+	if (perf_test(da, p) < 0)
+		return -1;
+	quit_workers(da, p);
+
+	printf("=== Performance test of distributor (affinity mode, "
+			"worker bursts) ===\n");
+	rte_eal_mp_remote_launch(handle_work_burst, da, SKIP_MASTER);
+	if (perf_test(da, p) < 0)
+		return -1;
+	quit_workers(da, p);
+
 	return 0;
 }
 
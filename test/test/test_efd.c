@@ -31,6 +31,9 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <limits.h>
+#include <unistd.h>
+
 #include <rte_memcpy.h>
 #include <rte_malloc.h>
 #include <rte_efd.h>
@@ -476,6 +479,234 @@ static int test_efd_creation_with_bad_parameters(void)
 	return 0;
 }
 
+#define BUILD_NUM_KEYS (TABLE_SIZE / 8)
+#define BUILD_NUM_THREADS 4
+
+/*
+ * Fill a contiguous array of random 8-byte keys and their values.
+ * Keys are made unique by storing the index in the upper half.
+ */
+static void build_gen_keys(uint64_t *key_array, efd_value_t *val_array,
+		uint32_t num)
+{
+	uint32_t i;
+
+	for (i = 0; i < num; i++) {
+		key_array[i] = ((uint64_t)i << 32) | (uint32_t)rte_rand();
+		val_array[i] = rte_rand() & VALUE_BITMASK;
+	}
+}
+
+/*
+ * Bulk insert a large number of keys, both into an empty table and
+ * into a table that already holds keys added one by one, and check
+ * that every key can be looked up afterwards.
+ */
+static int test_efd_build(void)
+{
+	struct rte_efd_table *handle;
+	uint64_t *key_array;
+	efd_value_t *val_array;
+	uint32_t i, num_half;
+	int ret = -1;
+
+	printf("Entering %s\n", __func__);
+
+	key_array = rte_malloc(NULL, BUILD_NUM_KEYS * sizeof(key_array[0]), 0);
+	val_array = rte_malloc(NULL, BUILD_NUM_KEYS * sizeof(val_array[0]), 0);
+	if (key_array == NULL || val_array == NULL) {
+		printf("Error allocating key/value arrays\n");
+		goto exit;
+	}
+	build_gen_keys(key_array, val_array, BUILD_NUM_KEYS);
+
+	handle = rte_efd_create("test_efd_build", TABLE_SIZE,
+			sizeof(key_array[0]), efd_get_all_sockets_bitmask(),
+			test_socket_id);
+	if (handle == NULL) {
+		printf("Error creating the EFD table\n");
+		goto exit;
+	}
+
+	/* invalid parameters */
+	if (rte_efd_build(NULL, test_socket_id, BUILD_NUM_KEYS, key_array,
+				val_array, 1) != -EINVAL ||
+			rte_efd_build(handle, test_socket_id, BUILD_NUM_KEYS,
+				NULL, val_array, 1) != -EINVAL ||
+			rte_efd_build(handle, test_socket_id, BUILD_NUM_KEYS,
+				key_array, val_array, 0) != -EINVAL ||
+			rte_efd_build(handle, RTE_MAX_NUMA_NODES,
+				BUILD_NUM_KEYS, key_array, val_array,
+				1) != -EINVAL) {
+		printf("rte_efd_build accepted invalid parameters\n");
+		goto exit_free;
+	}
+
+	/* first half: a few keys individually, the rest in bulk */
+	num_half = BUILD_NUM_KEYS / 2;
+	for (i = 0; i < 64; i++) {
+		if (rte_efd_update(handle, test_socket_id, &key_array[i],
+				val_array[i] ^ 1) != 0) {
+			printf("Error inserting key %u\n", i);
+			goto exit_free;
+		}
+	}
+	if (rte_efd_build(handle, test_socket_id, num_half, key_array,
+			val_array, 1) != 0) {
+		printf("Error bulk inserting %u keys\n", num_half);
+		goto exit_free;
+	}
+
+	/* second half with several threads, on top of the first one */
+	if (rte_efd_build(handle, test_socket_id, BUILD_NUM_KEYS - num_half,
+			&key_array[num_half], &val_array[num_half],
+			BUILD_NUM_THREADS) != 0) {
+		printf("Error bulk inserting %u keys with %u threads\n",
+			BUILD_NUM_KEYS - num_half, BUILD_NUM_THREADS);
+		goto exit_free;
+	}
+
+	for (i = 0; i < BUILD_NUM_KEYS; i++) {
+		if (rte_efd_lookup(handle, test_socket_id, &key_array[i]) !=
+				val_array[i]) {
+			printf("Bulk inserted key %u not found\n", i);
+			goto exit_free;
+		}
+	}
+
+	/* bulk built tables still support single-key updates */
+	val_array[0] = (val_array[0] + 1) & VALUE_BITMASK;
+	if (rte_efd_update(handle, test_socket_id, &key_array[0],
+			val_array[0]) != 0 ||
+			rte_efd_lookup(handle, test_socket_id,
+				&key_array[0]) != val_array[0]) {
+		printf("Error updating a bulk inserted key\n");
+		goto exit_free;
+	}
+
+	ret = 0;
+exit_free:
+	rte_efd_free(handle);
+exit:
+	rte_free(key_array);
+	rte_free(val_array);
+	return ret;
+}
+
+/*
+ * Save a table to memory and to a file, restore both copies and
+ * check that they return the same values as the original table.
+ */
+static int test_efd_snapshot(void)
+{
+	struct rte_efd_table *handle, *mem_copy = NULL, *file_copy = NULL;
+	uint64_t *key_array;
+	efd_value_t *val_array;
+	char path[PATH_MAX];
+	size_t size;
+	void *buf = NULL;
+	uint32_t i;
+	int ret = -1;
+
+	printf("Entering %s\n", __func__);
+
+	key_array = rte_malloc(NULL, BUILD_NUM_KEYS * sizeof(key_array[0]), 0);
+	val_array = rte_malloc(NULL, BUILD_NUM_KEYS * sizeof(val_array[0]), 0);
+	if (key_array == NULL || val_array == NULL) {
+		printf("Error allocating key/value arrays\n");
+		goto exit;
+	}
+	build_gen_keys(key_array, val_array, BUILD_NUM_KEYS);
+
+	handle = rte_efd_create("test_efd_snapshot", TABLE_SIZE,
+			sizeof(key_array[0]), efd_get_all_sockets_bitmask(),
+			test_socket_id);
+	if (handle == NULL) {
+		printf("Error creating the EFD table\n");
+		goto exit;
+	}
+	if (rte_efd_build(handle, test_socket_id, BUILD_NUM_KEYS, key_array,
+			val_array, BUILD_NUM_THREADS) != 0) {
+		printf("Error bulk inserting keys\n");
+		goto exit_free;
+	}
+
+	size = rte_efd_snapshot_size(handle);
+	buf = rte_malloc(NULL, size, 0);
+	if (buf == NULL) {
+		printf("Error allocating %zu bytes for the snapshot\n", size);
+		goto exit_free;
+	}
+	if (rte_efd_snapshot(handle, test_socket_id, buf, size - 1) !=
+			-ENOSPC) {
+		printf("Snapshot into a short buffer did not fail\n");
+		goto exit_free;
+	}
+	if (rte_efd_snapshot(handle, test_socket_id, buf, size) != 0) {
+		printf("Error taking the snapshot\n");
+		goto exit_free;
+	}
+
+	/* a truncated snapshot must be rejected */
+	if (rte_efd_restore("test_efd_snapshot_bad", buf, size - 1,
+			efd_get_all_sockets_bitmask()) != NULL) {
+		printf("Truncated snapshot was restored\n");
+		goto exit_free;
+	}
+
+	mem_copy = rte_efd_restore("test_efd_snapshot_mem", buf, size,
+			efd_get_all_sockets_bitmask());
+	if (mem_copy == NULL) {
+		printf("Error restoring the snapshot from memory\n");
+		goto exit_free;
+	}
+
+	snprintf(path, sizeof(path), "/tmp/test_efd_snapshot.%d",
+			(int)getpid());
+	if (rte_efd_snapshot_save(handle, test_socket_id, path) != 0) {
+		printf("Error saving the snapshot to %s\n", path);
+		goto exit_free;
+	}
+	file_copy = rte_efd_restore_file("test_efd_snapshot_file", path,
+			efd_get_all_sockets_bitmask());
+	unlink(path);
+	if (file_copy == NULL) {
+		printf("Error restoring the snapshot from %s\n", path);
+		goto exit_free;
+	}
+
+	for (i = 0; i < BUILD_NUM_KEYS; i++) {
+		if (rte_efd_lookup(mem_copy, test_socket_id,
+					&key_array[i]) != val_array[i] ||
+				rte_efd_lookup(file_copy, test_socket_id,
+					&key_array[i]) != val_array[i]) {
+			printf("Restored table returned a wrong value "
+				"for key %u\n", i);
+			goto exit_free;
+		}
+	}
+
+	/* restored tables are lookup-only */
+	if (rte_efd_update(mem_copy, test_socket_id, &key_array[0],
+			val_array[0]) != RTE_EFD_UPDATE_FAILED ||
+			rte_efd_build(mem_copy, test_socket_id, 1,
+				key_array, val_array, 1) != -ENOTSUP) {
+		printf("Restored table accepted an update\n");
+		goto exit_free;
+	}
+
+	ret = 0;
+exit_free:
+	rte_efd_free(file_copy);
+	rte_efd_free(mem_copy);
+	rte_efd_free(handle);
+exit:
+	rte_free(buf);
+	rte_free(key_array);
+	rte_free(val_array);
+	return ret;
+}
+
 static int
 test_efd(void)
 {
@@ -493,6 +724,10 @@ test_efd(void)
 		return -1;
 	if (test_average_table_utilization() < 0)
 		return -1;
+	if (test_efd_build() < 0)
+		return -1;
+	if (test_efd_snapshot() < 0)
+		return -1;
 
 	return 0;
 }
@@ -0,0 +1,663 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_cryptodev.h>
+#include <rte_eventdev.h>
+#include <rte_bus_vdev.h>
+#include <rte_service.h>
+
+#include <rte_event_crypto_adapter.h>
+
+#include "test.h"
+
+#define TEST_INST_ID		0
+#define TEST_REQ_QUEUE		0
+#define TEST_RESP_QUEUE		1
+#define TEST_WORKER_PORT	0
+#define TEST_ADAPTER_PORT	1
+#define TEST_NB_QPS		2
+#define TEST_NB_FLOWS		16
+#define NUM_OPS			256
+#define NUM_MBUFS		1024
+#define MBUF_DATA_SIZE		(128 + RTE_PKTMBUF_HEADROOM)
+#define DEQUEUE_TIMEOUT_S	5
+#define BURST_SIZE		32
+
+/* metadata is right after the symmetric operation */
+#define METADATA_OFFSET	(sizeof(struct rte_crypto_op) + \
+				sizeof(struct rte_crypto_sym_op))
+
+static int evdev;
+static int cdev;
+static uint32_t evdev_service_id;
+static uint32_t adapter_service_id;
+static struct rte_mempool *op_pool;
+static struct rte_mempool *mbuf_pool;
+static struct rte_mempool *sess_pool;
+static struct rte_cryptodev_sym_session *sess;
+
+static int
+conf_cb(uint8_t id, uint8_t dev_id,
+	struct rte_event_crypto_adapter_conf *conf, void *arg)
+{
+	RTE_SET_USED(id);
+	RTE_SET_USED(dev_id);
+	RTE_SET_USED(arg);
+
+	conf->event_port_id = TEST_ADAPTER_PORT;
+	conf->max_nb = 128;
+	return 0;
+}
+
+static int
+adapter_create(enum rte_event_crypto_adapter_mode mode)
+{
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_create_ext(TEST_INST_ID,
+		evdev, conf_cb, mode, NULL), "Failed to create adapter");
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_queue_pair_add(
+		TEST_INST_ID, cdev, -1), "Failed to add queue pairs");
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_service_id_get(
+		TEST_INST_ID, &adapter_service_id),
+		"Failed to get adapter service id");
+	rte_service_set_runstate_mapped_check(adapter_service_id, 0);
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_start(TEST_INST_ID),
+		"Failed to start adapter");
+
+	return TEST_SUCCESS;
+}
+
+static int
+adapter_create_forward(void)
+{
+	return adapter_create(RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD);
+}
+
+static int
+adapter_create_new(void)
+{
+	return adapter_create(RTE_EVENT_CRYPTO_ADAPTER_OP_NEW);
+}
+
+static void
+adapter_free(void)
+{
+	rte_event_crypto_adapter_stop(TEST_INST_ID);
+	rte_event_crypto_adapter_queue_pair_del(TEST_INST_ID, cdev, -1);
+	rte_event_crypto_adapter_free(TEST_INST_ID);
+}
+
+/*
+ * Allocate a crypto operation on the session, with a one segment mbuf
+ * holding its sequence number, and the response event metadata.
+ */
+static struct rte_crypto_op *
+op_alloc(uint32_t seq, uint16_t qp_id, uint32_t flow_id)
+{
+	union rte_event_crypto_metadata *m;
+	struct rte_crypto_op *op;
+	struct rte_mbuf *mbuf;
+
+	op = rte_crypto_op_alloc(op_pool, RTE_CRYPTO_OP_TYPE_SYMMETRIC);
+	mbuf = rte_pktmbuf_alloc(mbuf_pool);
+	if (op == NULL || mbuf == NULL) {
+		rte_crypto_op_free(op);
+		rte_pktmbuf_free(mbuf);
+		return NULL;
+	}
+
+	rte_pktmbuf_append(mbuf, 64);
+	mbuf->udata64 = seq;
+	rte_crypto_op_attach_sym_session(op, sess);
+	op->sym->m_src = mbuf;
+	op->sym->cipher.data.offset = 0;
+	op->sym->cipher.data.length = 64;
+
+	op->private_data_offset = METADATA_OFFSET;
+	m = (union rte_event_crypto_metadata *)((uint8_t *)op +
+		METADATA_OFFSET);
+	memset(m, 0, sizeof(*m));
+	m->response_info.queue_id = TEST_RESP_QUEUE;
+	m->response_info.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	m->response_info.priority = RTE_EVENT_DEV_PRIORITY_NORMAL;
+	m->response_info.flow_id = flow_id;
+	m->request_info.cdev_id = cdev;
+	m->request_info.queue_pair_id = qp_id;
+
+	return op;
+}
+
+static void
+op_free(struct rte_crypto_op *op)
+{
+	rte_pktmbuf_free(op->sym->m_src);
+	rte_crypto_op_free(op);
+}
+
+static void
+services_run(void)
+{
+	rte_service_run_iter_on_app_lcore(evdev_service_id, 1);
+	rte_service_run_iter_on_app_lcore(adapter_service_id, 1);
+	rte_service_run_iter_on_app_lcore(evdev_service_id, 1);
+}
+
+/*
+ * Run the services and dequeue completion events until *nb* are received
+ * or the timeout is reached, check them and free their operations.
+ * *last_seq* holds the sequence number of the last operation received per
+ * flow, to check completions are in order within a flow. Return the number
+ * of events, or -1 on error.
+ */
+static int
+completions_get(uint32_t nb, int64_t *last_seq)
+{
+	struct rte_event ev[BURST_SIZE];
+	struct rte_crypto_op *op;
+	uint64_t deadline;
+	uint32_t received = 0, flow;
+	uint16_t n, i;
+	int ret = 0;
+
+	deadline = rte_get_timer_cycles() +
+		DEQUEUE_TIMEOUT_S * rte_get_timer_hz();
+	while (received < nb && rte_get_timer_cycles() < deadline) {
+		services_run();
+		n = rte_event_dequeue_burst(evdev, TEST_WORKER_PORT, ev,
+			BURST_SIZE, 0);
+		for (i = 0; i < n; i++) {
+			op = ev[i].event_ptr;
+			flow = ev[i].flow_id;
+			if (ev[i].event_type != RTE_EVENT_TYPE_CRYPTODEV ||
+					ev[i].queue_id != TEST_RESP_QUEUE ||
+					op->status !=
+					RTE_CRYPTO_OP_STATUS_SUCCESS ||
+					flow >= TEST_NB_FLOWS) {
+				printf("Invalid completion event\n");
+				ret = -1;
+			} else if ((int64_t)op->sym->m_src->udata64 <=
+					last_seq[flow]) {
+				printf("Completion out of order in flow %u\n",
+					flow);
+				ret = -1;
+			} else {
+				last_seq[flow] = op->sym->m_src->udata64;
+			}
+			op_free(op);
+		}
+		received += n;
+	}
+
+	return ret ? ret : (int)received;
+}
+
+/* no completion event is received within *ms* milliseconds */
+static int
+completions_none(uint32_t ms)
+{
+	struct rte_event ev;
+	uint64_t deadline;
+
+	deadline = rte_get_timer_cycles() + rte_get_timer_hz() * ms / 1000;
+	while (rte_get_timer_cycles() < deadline) {
+		services_run();
+		if (rte_event_dequeue_burst(evdev, TEST_WORKER_PORT, &ev, 1,
+				0) != 0) {
+			op_free(ev.event_ptr);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static void
+last_seq_init(int64_t *last_seq)
+{
+	uint32_t i;
+
+	for (i = 0; i < TEST_NB_FLOWS; i++)
+		last_seq[i] = -1;
+}
+
+/*
+ * Crypto operation events are forwarded to the adapter, and complete with
+ * the flow identifier of the forwarded event, in order within a flow.
+ */
+static int
+test_op_forward(void)
+{
+	struct rte_event_crypto_adapter_stats stats;
+	int64_t last_seq[TEST_NB_FLOWS];
+	struct rte_event ev;
+	uint32_t i;
+
+	last_seq_init(last_seq);
+	memset(&ev, 0, sizeof(ev));
+	ev.op = RTE_EVENT_OP_NEW;
+	ev.queue_id = TEST_REQ_QUEUE;
+	ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	ev.event_type = RTE_EVENT_TYPE_CPU;
+
+	for (i = 0; i < NUM_OPS; i++) {
+		/* a flow is submitted to a single queue pair */
+		ev.flow_id = i % TEST_NB_FLOWS;
+		/* the flow ID of the metadata is overridden */
+		ev.event_ptr = op_alloc(i, ev.flow_id % TEST_NB_QPS,
+					TEST_NB_FLOWS + 1);
+		TEST_ASSERT_NOT_NULL(ev.event_ptr, "Failed to allocate op");
+		TEST_ASSERT(rte_event_enqueue_burst(evdev, TEST_WORKER_PORT,
+			&ev, 1) == 1, "Failed to enqueue event");
+	}
+
+	TEST_ASSERT(completions_get(NUM_OPS, last_seq) == NUM_OPS,
+		"Failed to receive completions");
+
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_stats_get(TEST_INST_ID,
+		&stats), "Failed to get stats");
+	TEST_ASSERT(stats.event_deq_count == NUM_OPS &&
+		stats.crypto_enq_count == NUM_OPS &&
+		stats.crypto_deq_count == NUM_OPS &&
+		stats.event_enq_count == NUM_OPS &&
+		stats.op_drop_count == 0, "Invalid stats");
+
+	return TEST_SUCCESS;
+}
+
+/* Crypto operations without valid metadata are dropped */
+static int
+test_op_forward_invalid(void)
+{
+	struct rte_event_crypto_adapter_stats stats;
+	struct rte_crypto_op *op;
+	struct rte_event ev;
+	unsigned int avail;
+	uint64_t deadline;
+
+	avail = rte_mempool_avail_count(op_pool);
+	memset(&ev, 0, sizeof(ev));
+	ev.op = RTE_EVENT_OP_NEW;
+	ev.queue_id = TEST_REQ_QUEUE;
+	ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+
+	op = op_alloc(0, 0, 0);
+	TEST_ASSERT_NOT_NULL(op, "Failed to allocate op");
+	op->private_data_offset = 0;
+	ev.event_ptr = op;
+	TEST_ASSERT(rte_event_enqueue_burst(evdev, TEST_WORKER_PORT, &ev, 1)
+		== 1, "Failed to enqueue event");
+
+	op = op_alloc(1, TEST_NB_QPS, 0);
+	TEST_ASSERT_NOT_NULL(op, "Failed to allocate op");
+	ev.event_ptr = op;
+	TEST_ASSERT(rte_event_enqueue_burst(evdev, TEST_WORKER_PORT, &ev, 1)
+		== 1, "Failed to enqueue event");
+
+	deadline = rte_get_timer_cycles() + rte_get_timer_hz();
+	do {
+		services_run();
+		TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_stats_get(
+			TEST_INST_ID, &stats), "Failed to get stats");
+	} while (stats.op_drop_count < 2 &&
+		rte_get_timer_cycles() < deadline);
+
+	TEST_ASSERT(stats.op_drop_count == 2 && stats.crypto_enq_count == 0,
+		"Invalid ops not dropped");
+	TEST_ASSERT(rte_mempool_avail_count(op_pool) == avail,
+		"Dropped ops not freed");
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * The application submits the operations, the adapter enqueues their
+ * completion with the flow identifier of the metadata.
+ */
+static int
+test_op_new(void)
+{
+	struct rte_crypto_op *ops[BURST_SIZE];
+	int64_t last_seq[TEST_NB_FLOWS];
+	uint32_t i, j, flow;
+	uint16_t qp_id;
+
+	last_seq_init(last_seq);
+	for (i = 0; i < NUM_OPS; i += BURST_SIZE) {
+		/* the flows of a queue pair are the ones of its parity */
+		qp_id = (i / BURST_SIZE) % TEST_NB_QPS;
+		for (j = 0; j < BURST_SIZE; j++) {
+			flow = (j * TEST_NB_QPS + qp_id) % TEST_NB_FLOWS;
+			ops[j] = op_alloc(i + j, qp_id, flow);
+			TEST_ASSERT_NOT_NULL(ops[j], "Failed to allocate op");
+		}
+		TEST_ASSERT(rte_cryptodev_enqueue_burst(cdev, qp_id, ops,
+			BURST_SIZE) == BURST_SIZE, "Failed to enqueue ops");
+	}
+
+	TEST_ASSERT(completions_get(NUM_OPS, last_seq) == NUM_OPS,
+		"Failed to receive completions");
+
+	return TEST_SUCCESS;
+}
+
+/* No completion is received from a deleted queue pair */
+static int
+test_queue_pair_del(void)
+{
+	struct rte_crypto_op *op;
+	int64_t last_seq[TEST_NB_FLOWS];
+	uint64_t deadline;
+
+	last_seq_init(last_seq);
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_queue_pair_del(
+		TEST_INST_ID, cdev, 1), "Failed to delete queue pair");
+
+	op = op_alloc(0, 1, 0);
+	TEST_ASSERT_NOT_NULL(op, "Failed to allocate op");
+	TEST_ASSERT(rte_cryptodev_enqueue_burst(cdev, 1, &op, 1) == 1,
+		"Failed to enqueue op");
+	TEST_ASSERT_SUCCESS(completions_none(10),
+		"Completion from deleted queue pair");
+
+	deadline = rte_get_timer_cycles() + rte_get_timer_hz();
+	while (rte_cryptodev_dequeue_burst(cdev, 1, &op, 1) == 0)
+		TEST_ASSERT(rte_get_timer_cycles() < deadline,
+			"Failed to dequeue op");
+	op_free(op);
+
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_queue_pair_add(
+		TEST_INST_ID, cdev, 1), "Failed to add queue pair");
+	op = op_alloc(1, 1, 0);
+	TEST_ASSERT_NOT_NULL(op, "Failed to allocate op");
+	TEST_ASSERT(rte_cryptodev_enqueue_burst(cdev, 1, &op, 1) == 1,
+		"Failed to enqueue op");
+	TEST_ASSERT(completions_get(1, last_seq) == 1,
+		"Failed to receive completion");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_crypto_adapter_create_free(void)
+{
+	struct rte_event_port_conf port_conf = {
+		.dequeue_depth = 8,
+		.enqueue_depth = 8,
+		.new_event_threshold = 1200,
+	};
+	uint8_t port;
+	int err;
+
+	err = rte_event_crypto_adapter_create_ext(TEST_INST_ID, evdev, NULL,
+				RTE_EVENT_CRYPTO_ADAPTER_OP_NEW, NULL);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_crypto_adapter_create_ext(TEST_INST_ID, evdev,
+				conf_cb,
+				RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD + 1, NULL);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_crypto_adapter_create_ext(TEST_INST_ID, evdev,
+				conf_cb, RTE_EVENT_CRYPTO_ADAPTER_OP_NEW, NULL);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_crypto_adapter_create_ext(TEST_INST_ID, evdev,
+				conf_cb, RTE_EVENT_CRYPTO_ADAPTER_OP_NEW, NULL);
+	TEST_ASSERT(err == -EEXIST, "Expected -EEXIST got %d", err);
+
+	err = rte_event_crypto_adapter_event_port_get(TEST_INST_ID, &port);
+	TEST_ASSERT(err == 0 && port == TEST_ADAPTER_PORT,
+		"Failed to get event port");
+
+	err = rte_event_crypto_adapter_queue_pair_add(TEST_INST_ID, cdev,
+				TEST_NB_QPS);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_crypto_adapter_queue_pair_add(TEST_INST_ID,
+				RTE_CRYPTO_MAX_DEVS - 1, 0);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_crypto_adapter_queue_pair_add(TEST_INST_ID, cdev, 0);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_crypto_adapter_free(TEST_INST_ID);
+	TEST_ASSERT(err == -EBUSY, "Expected -EBUSY got %d", err);
+
+	err = rte_event_crypto_adapter_queue_pair_del(TEST_INST_ID, cdev, 0);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_crypto_adapter_free(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_crypto_adapter_free(TEST_INST_ID);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_crypto_adapter_create(TEST_INST_ID, evdev, NULL,
+				RTE_EVENT_CRYPTO_ADAPTER_OP_NEW);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_crypto_adapter_create(TEST_INST_ID, evdev, &port_conf,
+				RTE_EVENT_CRYPTO_ADAPTER_OP_NEW);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_crypto_adapter_free(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Request queue linked to the adapter port, response queue linked to the
+ * worker port. The device is configured once: reconfiguring the sw PMD
+ * drops the credits held by its ports.
+ */
+static int
+evdev_setup(void)
+{
+	const struct rte_event_dev_config config = {
+		.nb_event_queues = 2,
+		.nb_event_ports = 2,
+		.nb_event_queue_flows = 1024,
+		.nb_events_limit = 4096,
+		.nb_event_port_dequeue_depth = 128,
+		.nb_event_port_enqueue_depth = 128,
+	};
+	const struct rte_event_port_conf port_conf = {
+		.new_event_threshold = 4096,
+		.dequeue_depth = 128,
+		.enqueue_depth = 128,
+	};
+	const struct rte_event_queue_conf queue_conf = {
+		.schedule_type = RTE_SCHED_TYPE_ATOMIC,
+		.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+		.nb_atomic_flows = 1024,
+		.nb_atomic_order_sequences = 1024,
+	};
+	const uint8_t req_queue = TEST_REQ_QUEUE;
+	const uint8_t resp_queue = TEST_RESP_QUEUE;
+	int i;
+
+	TEST_ASSERT_SUCCESS(rte_event_dev_configure(evdev, &config),
+		"Failed to configure eventdev");
+	for (i = 0; i < config.nb_event_queues; i++)
+		TEST_ASSERT_SUCCESS(rte_event_queue_setup(evdev, i,
+			&queue_conf), "Failed to setup queue %d", i);
+	for (i = 0; i < config.nb_event_ports; i++)
+		TEST_ASSERT_SUCCESS(rte_event_port_setup(evdev, i, &port_conf),
+			"Failed to setup port %d", i);
+	TEST_ASSERT(rte_event_port_link(evdev, TEST_ADAPTER_PORT, &req_queue,
+		NULL, 1) == 1, "Failed to link adapter port");
+	TEST_ASSERT(rte_event_port_link(evdev, TEST_WORKER_PORT, &resp_queue,
+		NULL, 1) == 1, "Failed to link worker port");
+	TEST_ASSERT_SUCCESS(rte_event_dev_start(evdev),
+		"Failed to start eventdev");
+
+	return TEST_SUCCESS;
+}
+
+/* Null crypto device with null cipher session */
+static int
+cdev_setup(void)
+{
+	struct rte_cryptodev_config conf = {
+		.nb_queue_pairs = TEST_NB_QPS,
+		.socket_id = SOCKET_ID_ANY,
+	};
+	struct rte_cryptodev_qp_conf qp_conf = {
+		.nb_descriptors = 2 * NUM_OPS,
+	};
+	struct rte_crypto_sym_xform xform = {
+		.type = RTE_CRYPTO_SYM_XFORM_CIPHER,
+		.cipher = {
+			.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT,
+			.algo = RTE_CRYPTO_CIPHER_NULL,
+		},
+	};
+	const char *name = "crypto_null";
+	uint16_t qp_id;
+
+	cdev = rte_cryptodev_get_dev_id(name);
+	if (cdev < 0) {
+		TEST_ASSERT_SUCCESS(rte_vdev_init(name, NULL),
+			"Error creating cryptodev");
+		cdev = rte_cryptodev_get_dev_id(name);
+		TEST_ASSERT(cdev >= 0, "Error finding cryptodev");
+	}
+
+	if (sess_pool == NULL) {
+		sess_pool = rte_mempool_create("test_eca_sess_mp", 16,
+			rte_cryptodev_get_private_session_size(cdev), 0, 0,
+			NULL, NULL, NULL, NULL, SOCKET_ID_ANY, 0);
+		TEST_ASSERT_NOT_NULL(sess_pool, "Failed to create sess pool");
+	}
+
+	rte_cryptodev_stop(cdev);
+	TEST_ASSERT_SUCCESS(rte_cryptodev_configure(cdev, &conf),
+		"Failed to configure cryptodev");
+	for (qp_id = 0; qp_id < TEST_NB_QPS; qp_id++)
+		TEST_ASSERT_SUCCESS(rte_cryptodev_queue_pair_setup(cdev, qp_id,
+			&qp_conf, SOCKET_ID_ANY, sess_pool),
+			"Failed to setup queue pair %u", qp_id);
+	TEST_ASSERT_SUCCESS(rte_cryptodev_start(cdev),
+		"Failed to start cryptodev");
+
+	if (sess == NULL) {
+		sess = rte_cryptodev_sym_session_create(sess_pool);
+		TEST_ASSERT_NOT_NULL(sess, "Failed to create session");
+		TEST_ASSERT_SUCCESS(rte_cryptodev_sym_session_init(cdev, sess,
+			&xform, sess_pool), "Failed to init session");
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+testsuite_setup(void)
+{
+	const char *eventdev_name = "event_sw0";
+
+	evdev = rte_event_dev_get_dev_id(eventdev_name);
+	if (evdev < 0) {
+		if (rte_vdev_init(eventdev_name, NULL) < 0) {
+			printf("Error creating eventdev\n");
+			return TEST_FAILED;
+		}
+		evdev = rte_event_dev_get_dev_id(eventdev_name);
+		if (evdev < 0) {
+			printf("Error finding newly created eventdev\n");
+			return TEST_FAILED;
+		}
+	}
+
+	if (rte_event_dev_service_id_get(evdev, &evdev_service_id) < 0) {
+		printf("Failed to get service ID for software event dev\n");
+		return TEST_FAILED;
+	}
+	rte_service_runstate_set(evdev_service_id, 1);
+	rte_service_set_runstate_mapped_check(evdev_service_id, 0);
+
+	if (evdev_setup() != TEST_SUCCESS)
+		return TEST_FAILED;
+
+	if (op_pool == NULL) {
+		op_pool = rte_crypto_op_pool_create("test_eca_op_pool",
+			RTE_CRYPTO_OP_TYPE_SYMMETRIC, 2 * NUM_OPS, 0,
+			sizeof(union rte_event_crypto_metadata),
+			SOCKET_ID_ANY);
+		mbuf_pool = rte_pktmbuf_pool_create("test_eca_mbuf_pool",
+			NUM_MBUFS, 0, 0, MBUF_DATA_SIZE, SOCKET_ID_ANY);
+		if (op_pool == NULL || mbuf_pool == NULL) {
+			printf("Failed to create pools\n");
+			return TEST_FAILED;
+		}
+	}
+
+	return cdev_setup();
+}
+
+static void
+testsuite_teardown(void)
+{
+	rte_event_dev_stop(evdev);
+	rte_event_dev_close(evdev);
+	rte_cryptodev_stop(cdev);
+}
+
+static struct unit_test_suite crypto_adapter_tests = {
+	.suite_name = "event crypto adapter test suite",
+	.setup = testsuite_setup,
+	.teardown = testsuite_teardown,
+	.unit_test_cases = {
+		TEST_CASE_ST(adapter_create_forward, adapter_free,
+			test_op_forward),
+		TEST_CASE_ST(adapter_create_forward, adapter_free,
+			test_op_forward_invalid),
+		TEST_CASE_ST(adapter_create_new, adapter_free, test_op_new),
+		TEST_CASE_ST(adapter_create_new, adapter_free,
+			test_queue_pair_del),
+		/* last, the default port config reconfigures the device */
+		TEST_CASE_ST(NULL, NULL, test_crypto_adapter_create_free),
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_event_crypto_adapter(void)
+{
+	return unit_test_suite_runner(&crypto_adapter_tests);
+}
+
+REGISTER_TEST_COMMAND(event_crypto_adapter_autotest,
+		test_event_crypto_adapter);
@@ -0,0 +1,563 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_ring.h>
+#include <rte_ethdev.h>
+#include <rte_eth_ring.h>
+#include <rte_eventdev.h>
+#include <rte_bus_vdev.h>
+#include <rte_service.h>
+
+#include <rte_event_eth_tx_adapter.h>
+
+#include "test.h"
+
+#define TEST_INST_ID		0
+#define TEST_TX_QUEUE		0
+#define TEST_WORKER_PORT	0
+#define TEST_ADAPTER_PORT	1
+#define TEST_NB_TXQ		2
+/* Tx queue 1 has a small ring, to test retries and drops */
+#define TXQ0_RING_SIZE		1024
+#define TXQ1_RING_SIZE		64
+#define NUM_PKTS		96
+#define NUM_MBUFS		1024
+#define MBUF_DATA_SIZE		(128 + RTE_PKTMBUF_HEADROOM)
+#define TX_TIMEOUT_S		5
+#define BURST_SIZE		32
+
+static int evdev;
+static int eth_port = -1;
+static uint32_t evdev_service_id;
+static uint32_t adapter_service_id;
+static struct rte_mempool *mbuf_pool;
+static struct rte_ring *rx_ring;
+static struct rte_ring *tx_rings[TEST_NB_TXQ];
+
+static int
+conf_cb(uint8_t id, uint8_t dev_id,
+	struct rte_event_eth_tx_adapter_conf *conf, void *arg)
+{
+	RTE_SET_USED(id);
+	RTE_SET_USED(dev_id);
+	RTE_SET_USED(arg);
+
+	conf->event_port_id = TEST_ADAPTER_PORT;
+	conf->max_nb_tx = 128;
+	return 0;
+}
+
+static int
+adapter_create(void)
+{
+	TEST_ASSERT_SUCCESS(rte_event_eth_tx_adapter_create_ext(TEST_INST_ID,
+		evdev, conf_cb, NULL), "Failed to create adapter");
+	TEST_ASSERT_SUCCESS(rte_event_eth_tx_adapter_queue_add(TEST_INST_ID,
+		eth_port, -1), "Failed to add Tx queues");
+	TEST_ASSERT_SUCCESS(rte_event_eth_tx_adapter_service_id_get(
+		TEST_INST_ID, &adapter_service_id),
+		"Failed to get adapter service id");
+	rte_service_set_runstate_mapped_check(adapter_service_id, 0);
+	TEST_ASSERT_SUCCESS(rte_event_eth_tx_adapter_start(TEST_INST_ID),
+		"Failed to start adapter");
+
+	return TEST_SUCCESS;
+}
+
+static void
+rings_drain(void)
+{
+	void *pkt;
+	unsigned int i;
+
+	for (i = 0; i < TEST_NB_TXQ; i++) {
+		while (rte_ring_dequeue(tx_rings[i], &pkt) == 0)
+			rte_pktmbuf_free(pkt);
+	}
+}
+
+static void
+adapter_free(void)
+{
+	rte_event_eth_tx_adapter_stop(TEST_INST_ID);
+	rte_event_eth_tx_adapter_queue_del(TEST_INST_ID, eth_port, -1);
+	rte_event_eth_tx_adapter_free(TEST_INST_ID);
+	rings_drain();
+}
+
+static void
+services_run(void)
+{
+	rte_service_run_iter_on_app_lcore(evdev_service_id, 1);
+	rte_service_run_iter_on_app_lcore(adapter_service_id, 1);
+}
+
+/*
+ * Enqueue *nb* mbuf events for Tx queue *txq* of *port*, or for the Tx
+ * queues of the test port in turn if *txq* is -1. The mbufs hold their
+ * sequence number.
+ */
+static int
+events_enqueue(uint16_t port, int32_t txq, uint32_t nb)
+{
+	struct rte_event ev;
+	struct rte_mbuf *m;
+	uint64_t deadline;
+	uint32_t i;
+
+	deadline = rte_get_timer_cycles() + TX_TIMEOUT_S * rte_get_timer_hz();
+	for (i = 0; i < nb; i++) {
+		m = rte_pktmbuf_alloc(mbuf_pool);
+		if (m == NULL)
+			return -1;
+		rte_pktmbuf_append(m, 64);
+		m->udata64 = i;
+		m->port = port;
+		rte_event_eth_tx_adapter_txq_set(m,
+				txq == -1 ? i % TEST_NB_TXQ : (uint32_t)txq);
+
+		memset(&ev, 0, sizeof(ev));
+		ev.op = RTE_EVENT_OP_NEW;
+		ev.queue_id = TEST_TX_QUEUE;
+		ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+		ev.event_type = RTE_EVENT_TYPE_CPU;
+		ev.flow_id = i % 4;
+		ev.mbuf = m;
+		while (rte_event_enqueue_burst(evdev, TEST_WORKER_PORT,
+				&ev, 1) != 1) {
+			if (rte_get_timer_cycles() > deadline) {
+				rte_pktmbuf_free(m);
+				return -1;
+			}
+			services_run();
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Run the services until *nb* packets have been transmitted in total on
+ * the Tx rings, or the timeout is reached. Return the number of packets
+ * transmitted.
+ */
+static unsigned int
+tx_wait(unsigned int nb)
+{
+	uint64_t deadline;
+	unsigned int count, i;
+
+	deadline = rte_get_timer_cycles() + TX_TIMEOUT_S * rte_get_timer_hz();
+	do {
+		services_run();
+		count = 0;
+		for (i = 0; i < TEST_NB_TXQ; i++)
+			count += rte_ring_count(tx_rings[i]);
+	} while (count < nb && rte_get_timer_cycles() < deadline);
+
+	return count;
+}
+
+/*
+ * Check the packets of Tx ring *txq* have the Tx queue and port set by
+ * events_enqueue(), and are in order, then free them. Return the number
+ * of packets or -1 on error.
+ */
+static int
+ring_check(unsigned int txq)
+{
+	struct rte_mbuf *m;
+	void *pkt;
+	int64_t last = -1;
+	int n = 0, ret = 0;
+
+	while (rte_ring_dequeue(tx_rings[txq], &pkt) == 0) {
+		m = pkt;
+		if (m->port != eth_port ||
+				rte_event_eth_tx_adapter_txq_get(m) != txq ||
+				(int64_t)m->udata64 <= last) {
+			printf("Unexpected packet %" PRIu64 " on Tx queue %u\n",
+				m->udata64, txq);
+			ret = -1;
+		}
+		last = m->udata64;
+		rte_pktmbuf_free(m);
+		n++;
+	}
+
+	return ret ? ret : n;
+}
+
+static int
+test_tx_burst(void)
+{
+	struct rte_event_eth_tx_adapter_stats stats, port_stats;
+
+	TEST_ASSERT_SUCCESS(events_enqueue(eth_port, -1, NUM_PKTS),
+		"Failed to enqueue events");
+	TEST_ASSERT(tx_wait(NUM_PKTS) == NUM_PKTS,
+		"Failed to transmit packets");
+	TEST_ASSERT(ring_check(0) == NUM_PKTS / TEST_NB_TXQ,
+		"Unexpected packets on Tx queue 0");
+	TEST_ASSERT(ring_check(1) == NUM_PKTS / TEST_NB_TXQ,
+		"Unexpected packets on Tx queue 1");
+
+	TEST_ASSERT_SUCCESS(rte_event_eth_tx_adapter_stats_get(TEST_INST_ID,
+		&stats), "Failed to get stats");
+	TEST_ASSERT(stats.tx_packets == NUM_PKTS && stats.tx_dropped == 0,
+		"Unexpected stats tx_packets %" PRIu64 " tx_dropped %" PRIu64,
+		stats.tx_packets, stats.tx_dropped);
+	TEST_ASSERT_SUCCESS(rte_event_eth_tx_adapter_port_stats_get(
+		TEST_INST_ID, eth_port, &port_stats),
+		"Failed to get port stats");
+	TEST_ASSERT(memcmp(&stats, &port_stats, sizeof(stats)) == 0,
+		"Port stats don't match adapter stats");
+
+	TEST_ASSERT_SUCCESS(rte_event_eth_tx_adapter_stats_reset(TEST_INST_ID),
+		"Failed to reset stats");
+	TEST_ASSERT_SUCCESS(rte_event_eth_tx_adapter_stats_get(TEST_INST_ID,
+		&stats), "Failed to get stats");
+	TEST_ASSERT(stats.tx_packets == 0, "Stats not reset");
+
+	return TEST_SUCCESS;
+}
+
+/* A partial burst is transmitted once the event port has been drained */
+static int
+test_tx_partial_burst(void)
+{
+	TEST_ASSERT_SUCCESS(events_enqueue(eth_port, 0, 5),
+		"Failed to enqueue events");
+	TEST_ASSERT(tx_wait(5) == 5, "Failed to flush partial burst");
+	TEST_ASSERT(ring_check(0) == 5, "Unexpected packets on Tx queue 0");
+
+	return TEST_SUCCESS;
+}
+
+/* Packets for a Tx queue not added to the adapter are dropped */
+static int
+test_tx_invalid_queue(void)
+{
+	struct rte_event_eth_tx_adapter_stats stats;
+	unsigned int avail;
+
+	avail = rte_mempool_avail_count(mbuf_pool);
+	TEST_ASSERT_SUCCESS(events_enqueue(eth_port, TEST_NB_TXQ, 4),
+		"Failed to enqueue events");
+	TEST_ASSERT_SUCCESS(events_enqueue(RTE_MAX_ETHPORTS - 1, 0, 4),
+		"Failed to enqueue events");
+	TEST_ASSERT_SUCCESS(rte_event_eth_tx_adapter_queue_del(TEST_INST_ID,
+		eth_port, 1), "Failed to delete Tx queue");
+	TEST_ASSERT_SUCCESS(events_enqueue(eth_port, 1, 4),
+		"Failed to enqueue events");
+	TEST_ASSERT_SUCCESS(events_enqueue(eth_port, 0, 4),
+		"Failed to enqueue events");
+
+	TEST_ASSERT(tx_wait(4) == 4, "Failed to transmit packets");
+	TEST_ASSERT(ring_check(0) == 4, "Unexpected packets on Tx queue 0");
+	TEST_ASSERT(rte_ring_count(tx_rings[1]) == 0,
+		"Unexpected packets on deleted Tx queue");
+
+	TEST_ASSERT_SUCCESS(rte_event_eth_tx_adapter_stats_get(TEST_INST_ID,
+		&stats), "Failed to get stats");
+	TEST_ASSERT(stats.tx_packets == 4 && stats.tx_dropped == 12,
+		"Unexpected stats tx_packets %" PRIu64 " tx_dropped %" PRIu64,
+		stats.tx_packets, stats.tx_dropped);
+	TEST_ASSERT(rte_mempool_avail_count(mbuf_pool) == avail,
+		"Dropped mbufs not freed");
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * The ring of Tx queue 1 is smaller than the number of packets: the
+ * adapter retries the transmission, then drops the packets it can't send.
+ */
+static int
+test_tx_retry_drop(void)
+{
+	struct rte_event_eth_tx_adapter_stats stats;
+	unsigned int room = rte_ring_get_capacity(tx_rings[1]);
+
+	TEST_ASSERT_SUCCESS(events_enqueue(eth_port, 1, NUM_PKTS),
+		"Failed to enqueue events");
+	TEST_ASSERT(tx_wait(room) == room, "Failed to transmit packets");
+	/* the dropped packets have been counted once the port is drained */
+	services_run();
+	services_run();
+
+	TEST_ASSERT_SUCCESS(rte_event_eth_tx_adapter_port_stats_get(
+		TEST_INST_ID, eth_port, &stats), "Failed to get stats");
+	TEST_ASSERT(stats.tx_packets == room &&
+		stats.tx_dropped == NUM_PKTS - room && stats.tx_retry != 0,
+		"Unexpected stats tx_packets %" PRIu64 " tx_dropped %" PRIu64
+		" tx_retry %" PRIu64, stats.tx_packets, stats.tx_dropped,
+		stats.tx_retry);
+	TEST_ASSERT(ring_check(1) == (int)room,
+		"Unexpected packets on Tx queue 1");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_tx_adapter_create_free(void)
+{
+	struct rte_event_port_conf port_conf = {
+		.dequeue_depth = 8,
+		.enqueue_depth = 8,
+		.new_event_threshold = 1200,
+	};
+	uint8_t port;
+	int err;
+
+	err = rte_event_eth_tx_adapter_create_ext(TEST_INST_ID, evdev, NULL,
+				NULL);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_tx_adapter_create_ext(TEST_INST_ID, evdev,
+				conf_cb, NULL);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_create_ext(TEST_INST_ID, evdev,
+				conf_cb, NULL);
+	TEST_ASSERT(err == -EEXIST, "Expected -EEXIST got %d", err);
+
+	err = rte_event_eth_tx_adapter_event_port_get(TEST_INST_ID, &port);
+	TEST_ASSERT(err == 0 && port == TEST_ADAPTER_PORT,
+		"Failed to get event port");
+
+	err = rte_event_eth_tx_adapter_queue_add(TEST_INST_ID, eth_port,
+				TEST_NB_TXQ);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_tx_adapter_queue_add(TEST_INST_ID,
+				RTE_MAX_ETHPORTS - 1, 0);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_tx_adapter_queue_add(TEST_INST_ID, eth_port, 0);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_free(TEST_INST_ID);
+	TEST_ASSERT(err == -EBUSY, "Expected -EBUSY got %d", err);
+
+	err = rte_event_eth_tx_adapter_queue_del(TEST_INST_ID, eth_port, 1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_queue_del(TEST_INST_ID, eth_port, 0);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_queue_del(TEST_INST_ID, eth_port, 0);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_tx_adapter_free(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_free(TEST_INST_ID);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_tx_adapter_create(TEST_INST_ID, evdev, NULL);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_tx_adapter_create(TEST_INST_ID, evdev, &port_conf);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_free(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Tx queue linked to the adapter port, the worker port only enqueues. The
+ * device is configured once: reconfiguring the sw PMD drops the credits
+ * held by its ports.
+ */
+static int
+evdev_setup(void)
+{
+	const struct rte_event_dev_config config = {
+		.nb_event_queues = 1,
+		.nb_event_ports = 2,
+		.nb_event_queue_flows = 1024,
+		.nb_events_limit = 4096,
+		.nb_event_port_dequeue_depth = 128,
+		.nb_event_port_enqueue_depth = 128,
+	};
+	const struct rte_event_port_conf port_conf = {
+		.new_event_threshold = 4096,
+		.dequeue_depth = 128,
+		.enqueue_depth = 128,
+	};
+	const struct rte_event_queue_conf queue_conf = {
+		.schedule_type = RTE_SCHED_TYPE_ATOMIC,
+		.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+		.nb_atomic_flows = 1024,
+		.nb_atomic_order_sequences = 1024,
+	};
+	const uint8_t tx_queue = TEST_TX_QUEUE;
+	int i;
+
+	TEST_ASSERT_SUCCESS(rte_event_dev_configure(evdev, &config),
+		"Failed to configure eventdev");
+	TEST_ASSERT_SUCCESS(rte_event_queue_setup(evdev, TEST_TX_QUEUE,
+		&queue_conf), "Failed to setup queue");
+	for (i = 0; i < config.nb_event_ports; i++)
+		TEST_ASSERT_SUCCESS(rte_event_port_setup(evdev, i, &port_conf),
+			"Failed to setup port %d", i);
+	TEST_ASSERT(rte_event_port_link(evdev, TEST_ADAPTER_PORT, &tx_queue,
+		NULL, 1) == 1, "Failed to link adapter port");
+	TEST_ASSERT_SUCCESS(rte_event_dev_start(evdev),
+		"Failed to start eventdev");
+
+	return TEST_SUCCESS;
+}
+
+/* Ring based ethernet port, with a ring per Tx queue */
+static int
+ethdev_setup(void)
+{
+	const unsigned int ring_size[TEST_NB_TXQ] = {
+		TXQ0_RING_SIZE, TXQ1_RING_SIZE
+	};
+	struct rte_eth_conf conf;
+	char name[RTE_RING_NAMESIZE];
+	unsigned int i;
+
+	if (eth_port >= 0)
+		return TEST_SUCCESS;
+
+	rx_ring = rte_ring_create("test_txa_rx", 64, SOCKET_ID_ANY,
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+	TEST_ASSERT_NOT_NULL(rx_ring, "Failed to create Rx ring");
+	for (i = 0; i < TEST_NB_TXQ; i++) {
+		snprintf(name, sizeof(name), "test_txa_tx%u", i);
+		tx_rings[i] = rte_ring_create(name, ring_size[i],
+				SOCKET_ID_ANY, RING_F_SP_ENQ | RING_F_SC_DEQ);
+		TEST_ASSERT_NOT_NULL(tx_rings[i], "Failed to create Tx ring");
+	}
+
+	eth_port = rte_eth_from_rings("net_ring_txa", &rx_ring, 1, tx_rings,
+			TEST_NB_TXQ, SOCKET_ID_ANY);
+	TEST_ASSERT(eth_port >= 0, "Failed to create ring port");
+
+	memset(&conf, 0, sizeof(conf));
+	TEST_ASSERT_SUCCESS(rte_eth_dev_configure(eth_port, 1, TEST_NB_TXQ,
+		&conf), "Failed to configure port");
+	TEST_ASSERT_SUCCESS(rte_eth_rx_queue_setup(eth_port, 0, 64,
+		SOCKET_ID_ANY, NULL, mbuf_pool), "Failed to setup Rx queue");
+	for (i = 0; i < TEST_NB_TXQ; i++)
+		TEST_ASSERT_SUCCESS(rte_eth_tx_queue_setup(eth_port, i,
+			ring_size[i], SOCKET_ID_ANY, NULL),
+			"Failed to setup Tx queue %u", i);
+	TEST_ASSERT_SUCCESS(rte_eth_dev_start(eth_port),
+		"Failed to start port");
+
+	return TEST_SUCCESS;
+}
+
+static int
+testsuite_setup(void)
+{
+	const char *eventdev_name = "event_sw0";
+
+	evdev = rte_event_dev_get_dev_id(eventdev_name);
+	if (evdev < 0) {
+		if (rte_vdev_init(eventdev_name, NULL) < 0) {
+			printf("Error creating eventdev\n");
+			return TEST_FAILED;
+		}
+		evdev = rte_event_dev_get_dev_id(eventdev_name);
+		if (evdev < 0) {
+			printf("Error finding newly created eventdev\n");
+			return TEST_FAILED;
+		}
+	}
+
+	if (rte_event_dev_service_id_get(evdev, &evdev_service_id) < 0) {
+		printf("Failed to get service ID for software event dev\n");
+		return TEST_FAILED;
+	}
+	rte_service_runstate_set(evdev_service_id, 1);
+	rte_service_set_runstate_mapped_check(evdev_service_id, 0);
+
+	if (evdev_setup() != TEST_SUCCESS)
+		return TEST_FAILED;
+
+	if (mbuf_pool == NULL) {
+		mbuf_pool = rte_pktmbuf_pool_create("test_txa_mbuf_pool",
+			NUM_MBUFS, 0, 0, MBUF_DATA_SIZE, SOCKET_ID_ANY);
+		if (mbuf_pool == NULL) {
+			printf("Failed to create mbuf pool\n");
+			return TEST_FAILED;
+		}
+	}
+
+	return ethdev_setup();
+}
+
+static void
+testsuite_teardown(void)
+{
+	rte_event_dev_stop(evdev);
+	rte_event_dev_close(evdev);
+}
+
+static struct unit_test_suite eth_tx_adapter_tests = {
+	.suite_name = "event eth Tx adapter test suite",
+	.setup = testsuite_setup,
+	.teardown = testsuite_teardown,
+	.unit_test_cases = {
+		TEST_CASE_ST(adapter_create, adapter_free, test_tx_burst),
+		TEST_CASE_ST(adapter_create, adapter_free,
+			test_tx_partial_burst),
+		TEST_CASE_ST(adapter_create, adapter_free,
+			test_tx_invalid_queue),
+		TEST_CASE_ST(adapter_create, adapter_free, test_tx_retry_drop),
+		/* last, the default port config reconfigures the device */
+		TEST_CASE_ST(NULL, NULL, test_tx_adapter_create_free),
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_event_eth_tx_adapter(void)
+{
+	return unit_test_suite_runner(&eth_tx_adapter_tests);
+}
+
+REGISTER_TEST_COMMAND(event_eth_tx_adapter_autotest,
+		test_event_eth_tx_adapter);
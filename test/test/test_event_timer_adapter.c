@@ -0,0 +1,739 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
+#include <rte_eventdev.h>
+#include <rte_bus_vdev.h>
+#include <rte_service.h>
+
+#include <rte_event_timer_adapter.h>
+
+#include "test.h"
+
+#define TEST_INST_ID		0
+#define TEST_QUEUE_ID		0
+#define TEST_WORKER_PORT	0
+#define TEST_ADAPTER_PORT	1
+#define TEST_NB_TIMERS		4096
+#define TEST_TICK_NS		100000		/* 100 us */
+#define TEST_MAX_TMO_NS		1000000000ULL	/* 1 s */
+#define TEST_FLOW_ID		0xabc
+#define TEST_SUB_EVENT_TYPE	5
+#define DEQUEUE_TIMEOUT_S	5
+#define BURST_SIZE		32
+
+#define PERF_NB_TIMERS		(1 << 20)
+
+static int evdev;
+static uint32_t evdev_service_id;
+static uint32_t adapter_service_id;
+static struct rte_event_timer *timers;
+static uint32_t nb_timers_alloc;
+
+static int
+port_conf_cb(uint8_t id, uint8_t dev_id, uint8_t *event_port_id, void *arg)
+{
+	RTE_SET_USED(id);
+	RTE_SET_USED(dev_id);
+	RTE_SET_USED(arg);
+
+	*event_port_id = TEST_ADAPTER_PORT;
+	return 0;
+}
+
+/*
+ * One atomic queue, linked to the worker port, and the adapter port. The
+ * device is configured once: reconfiguring the sw PMD drops the credits
+ * held by its ports.
+ */
+static int
+evdev_setup(void)
+{
+	const struct rte_event_dev_config config = {
+		.nb_event_queues = 1,
+		.nb_event_ports = 2,
+		.nb_event_queue_flows = 1024,
+		.nb_events_limit = 4096,
+		.nb_event_port_dequeue_depth = 128,
+		.nb_event_port_enqueue_depth = 128,
+	};
+	const struct rte_event_port_conf port_conf = {
+		.new_event_threshold = 4096,
+		.dequeue_depth = 128,
+		.enqueue_depth = 128,
+	};
+	const struct rte_event_queue_conf queue_conf = {
+		.schedule_type = RTE_SCHED_TYPE_ATOMIC,
+		.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+		.nb_atomic_flows = 1024,
+		.nb_atomic_order_sequences = 1024,
+	};
+	const uint8_t queue = TEST_QUEUE_ID;
+	int i;
+
+	rte_event_dev_stop(evdev);
+	TEST_ASSERT_SUCCESS(rte_event_dev_configure(evdev, &config),
+		"Failed to configure eventdev");
+	TEST_ASSERT_SUCCESS(rte_event_queue_setup(evdev, TEST_QUEUE_ID,
+		&queue_conf), "Failed to setup queue");
+	for (i = 0; i < config.nb_event_ports; i++)
+		TEST_ASSERT_SUCCESS(rte_event_port_setup(evdev, i, &port_conf),
+			"Failed to setup port %d", i);
+	TEST_ASSERT(rte_event_port_link(evdev, TEST_WORKER_PORT, &queue,
+		NULL, 1) == 1, "Failed to link port");
+	TEST_ASSERT_SUCCESS(rte_event_dev_start(evdev),
+		"Failed to start eventdev");
+
+	return TEST_SUCCESS;
+}
+
+static int
+adapter_create_conf(uint8_t id, uint64_t tick_ns, uint64_t max_tmo_ns,
+	uint64_t nb_timers)
+{
+	const struct rte_event_timer_adapter_conf conf = {
+		.timer_tick_ns = tick_ns,
+		.max_tmo_ns = max_tmo_ns,
+		.nb_timers = nb_timers,
+	};
+	uint32_t service_id;
+
+	TEST_ASSERT_SUCCESS(rte_event_timer_adapter_create_ext(id, evdev,
+		&conf, port_conf_cb, NULL), "Failed to create adapter");
+	TEST_ASSERT_SUCCESS(rte_event_timer_adapter_service_id_get(id,
+		&service_id), "Failed to get adapter service id");
+	rte_service_set_runstate_mapped_check(service_id, 0);
+	TEST_ASSERT_SUCCESS(rte_event_timer_adapter_start(id),
+		"Failed to start adapter");
+	if (id == TEST_INST_ID)
+		adapter_service_id = service_id;
+
+	return TEST_SUCCESS;
+}
+
+static int
+adapter_create(void)
+{
+	memset(timers, 0, nb_timers_alloc * sizeof(*timers));
+	return adapter_create_conf(TEST_INST_ID, TEST_TICK_NS,
+		TEST_MAX_TMO_NS, TEST_NB_TIMERS);
+}
+
+/* cancel the timers left armed by a failed test case */
+static void
+adapter_free(void)
+{
+	struct rte_event_timer *tim;
+	uint32_t i;
+
+	for (i = 0; i < nb_timers_alloc; i++) {
+		tim = &timers[i];
+		if (tim->state == RTE_EVENT_TIMER_ARMED)
+			rte_event_timer_cancel_burst(TEST_INST_ID, &tim, 1);
+	}
+	rte_event_timer_adapter_free(TEST_INST_ID);
+}
+
+static void
+timer_init(struct rte_event_timer *tim, uint64_t timeout_ticks)
+{
+	memset(tim, 0, sizeof(*tim));
+	tim->ev.queue_id = TEST_QUEUE_ID;
+	tim->ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	tim->ev.priority = RTE_EVENT_DEV_PRIORITY_NORMAL;
+	tim->ev.flow_id = TEST_FLOW_ID;
+	tim->ev.sub_event_type = TEST_SUB_EVENT_TYPE;
+	tim->timeout_ticks = timeout_ticks;
+}
+
+static void
+services_run(void)
+{
+	rte_service_run_iter_on_app_lcore(adapter_service_id, 1);
+	rte_service_run_iter_on_app_lcore(evdev_service_id, 1);
+}
+
+/*
+ * Run the services and dequeue timer events until *nb* are received or
+ * the timeout is reached. Check each event and that its timer didn't
+ * expire before its timeout: *armed* holds the cycle count at the time
+ * each timer was armed, indexed like the timers array. Return the number
+ * of events, or -1 on error.
+ */
+static int
+timer_events_get(uint32_t nb, const uint64_t *armed, uint64_t tick_ns,
+	uint8_t *seen)
+{
+	struct rte_event ev[BURST_SIZE];
+	struct rte_event_timer *tim;
+	uint64_t deadline, now, min_cycles;
+	uint32_t received = 0, idx;
+	uint16_t n, i;
+
+	deadline = rte_get_timer_cycles() +
+		DEQUEUE_TIMEOUT_S * rte_get_timer_hz();
+	while (received < nb && rte_get_timer_cycles() < deadline) {
+		services_run();
+		n = rte_event_dequeue_burst(evdev, TEST_WORKER_PORT, ev,
+			BURST_SIZE, 0);
+		now = rte_get_timer_cycles();
+		for (i = 0; i < n; i++) {
+			tim = ev[i].event_ptr;
+			idx = tim - timers;
+			if (ev[i].event_type != RTE_EVENT_TYPE_TIMER ||
+					idx >= nb_timers_alloc ||
+					ev[i].flow_id != TEST_FLOW_ID ||
+					ev[i].sub_event_type !=
+					TEST_SUB_EVENT_TYPE ||
+					tim->state !=
+					RTE_EVENT_TIMER_NOT_ARMED) {
+				printf("Invalid timer event\n");
+				return -1;
+			}
+			if (seen != NULL) {
+				if (seen[idx]++ != 0) {
+					printf("Timer %u expired twice\n",
+						idx);
+					return -1;
+				}
+			}
+			min_cycles = (double)tim->timeout_ticks * tick_ns *
+				rte_get_timer_hz() / 1E9;
+			if (armed != NULL && now - armed[idx] < min_cycles) {
+				printf("Timer %u expired early\n", idx);
+				return -1;
+			}
+		}
+		received += n;
+	}
+
+	return received;
+}
+
+/* no event is received within *ms* milliseconds */
+static int
+timer_events_none(uint32_t ms)
+{
+	struct rte_event ev;
+	uint64_t deadline;
+
+	deadline = rte_get_timer_cycles() + rte_get_timer_hz() * ms / 1000;
+	while (rte_get_timer_cycles() < deadline) {
+		services_run();
+		if (rte_event_dequeue_burst(evdev, TEST_WORKER_PORT, &ev, 1,
+				0) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+static int
+timer_adapter_create_free(void)
+{
+	struct rte_event_timer_adapter_conf conf = {
+		.timer_tick_ns = TEST_TICK_NS,
+		.max_tmo_ns = TEST_MAX_TMO_NS,
+		.nb_timers = TEST_NB_TIMERS,
+	};
+	struct rte_event_port_conf port_conf = {
+		.dequeue_depth = 8,
+		.enqueue_depth = 8,
+		.new_event_threshold = 1200,
+	};
+	int err;
+
+	err = rte_event_timer_adapter_create_ext(TEST_INST_ID, evdev, NULL,
+					port_conf_cb, NULL);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	conf.max_tmo_ns = TEST_TICK_NS - 1;
+	err = rte_event_timer_adapter_create_ext(TEST_INST_ID, evdev, &conf,
+					port_conf_cb, NULL);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+	conf.max_tmo_ns = TEST_MAX_TMO_NS;
+
+	err = rte_event_timer_adapter_create(TEST_INST_ID, evdev, &conf,
+					NULL);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_timer_adapter_create(TEST_INST_ID, evdev, &conf,
+					&port_conf);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_timer_adapter_create_ext(TEST_INST_ID, evdev, &conf,
+					port_conf_cb, NULL);
+	TEST_ASSERT(err == -EEXIST, "Expected -EEXIST got %d", err);
+
+	err = rte_event_timer_adapter_free(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_timer_adapter_free(TEST_INST_ID);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_timer_adapter_free(
+			RTE_EVENT_TIMER_ADAPTER_MAX_INSTANCE);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	return TEST_SUCCESS;
+}
+
+/* timers expire once, not before their timeout */
+static int
+timer_arm_expire(void)
+{
+	struct rte_event_timer *tims[BURST_SIZE];
+	struct rte_event_timer_adapter_stats stats;
+	uint64_t armed[2 * BURST_SIZE];
+	uint8_t seen[2 * BURST_SIZE] = {0};
+	uint32_t i, j;
+
+	for (i = 0; i < 2 * BURST_SIZE; i += BURST_SIZE) {
+		for (j = 0; j < BURST_SIZE; j++) {
+			timer_init(&timers[i + j], 1 + i + j);
+			tims[j] = &timers[i + j];
+			armed[i + j] = rte_get_timer_cycles();
+		}
+		TEST_ASSERT(rte_event_timer_arm_burst(TEST_INST_ID, tims,
+			BURST_SIZE) == BURST_SIZE, "Failed to arm timers");
+	}
+
+	TEST_ASSERT(rte_event_timer_arm_burst(TEST_INST_ID, tims, 1) == 0 &&
+		rte_errno == EALREADY, "Armed timer was armed again");
+
+	TEST_ASSERT(timer_events_get(2 * BURST_SIZE, armed, TEST_TICK_NS,
+		seen) == 2 * BURST_SIZE, "Failed to receive timer events");
+	TEST_ASSERT_SUCCESS(timer_events_none(10), "Unexpected event");
+
+	TEST_ASSERT_SUCCESS(rte_event_timer_adapter_stats_get(TEST_INST_ID,
+		&stats), "Failed to get stats");
+	TEST_ASSERT(stats.evtim_arm_count == 2 * BURST_SIZE &&
+		stats.evtim_exp_count == 2 * BURST_SIZE &&
+		stats.ev_enq_count == 2 * BURST_SIZE &&
+		stats.adapter_tick_count >= 2 * BURST_SIZE,
+		"Invalid stats");
+	TEST_ASSERT_SUCCESS(rte_event_timer_adapter_stats_reset(TEST_INST_ID),
+		"Failed to reset stats");
+	TEST_ASSERT_SUCCESS(rte_event_timer_adapter_stats_get(TEST_INST_ID,
+		&stats), "Failed to get stats");
+	TEST_ASSERT(stats.evtim_exp_count == 0, "Stats not reset");
+
+	/* expired timers can be armed again */
+	for (j = 0; j < BURST_SIZE; j++)
+		armed[j] = rte_get_timer_cycles();
+	TEST_ASSERT(rte_event_timer_arm_tmo_tick_burst(TEST_INST_ID, tims,
+		3, BURST_SIZE) == BURST_SIZE, "Failed to arm timers again");
+	TEST_ASSERT(timer_events_get(BURST_SIZE, armed, TEST_TICK_NS,
+		NULL) == BURST_SIZE, "Failed to receive timer events");
+
+	return TEST_SUCCESS;
+}
+
+static int
+timer_arm_invalid(void)
+{
+	struct rte_event_timer *tim = &timers[0];
+
+	timer_init(tim, 0);
+	TEST_ASSERT(rte_event_timer_arm_burst(TEST_INST_ID, &tim, 1) == 0 &&
+		rte_errno == EINVAL &&
+		tim->state == RTE_EVENT_TIMER_ERROR_TOOEARLY,
+		"Timer with no timeout was armed");
+
+	timer_init(tim, TEST_MAX_TMO_NS / TEST_TICK_NS + 1);
+	TEST_ASSERT(rte_event_timer_arm_burst(TEST_INST_ID, &tim, 1) == 0 &&
+		rte_errno == EINVAL &&
+		tim->state == RTE_EVENT_TIMER_ERROR_TOOLATE,
+		"Timer beyond the max timeout was armed");
+
+	TEST_ASSERT(rte_event_timer_arm_burst(TEST_INST_ID + 1, &tim, 1) ==
+		0 && rte_errno == EINVAL, "Timer armed on invalid adapter");
+
+	TEST_ASSERT(rte_event_timer_cancel_burst(TEST_INST_ID, &tim, 1) ==
+		0 && rte_errno == EINVAL, "Timer not armed was canceled");
+
+	return TEST_SUCCESS;
+}
+
+/* canceled timers don't expire, and can be armed again */
+static int
+timer_cancel(void)
+{
+	struct rte_event_timer *tims[BURST_SIZE];
+	struct rte_event_timer_adapter_stats stats;
+	uint8_t seen[BURST_SIZE] = {0};
+	uint32_t i;
+
+	for (i = 0; i < BURST_SIZE; i++) {
+		timer_init(&timers[i], 10);
+		tims[i] = &timers[i];
+	}
+	TEST_ASSERT(rte_event_timer_arm_burst(TEST_INST_ID, tims,
+		BURST_SIZE) == BURST_SIZE, "Failed to arm timers");
+
+	/* cancel the even timers */
+	for (i = 0; i < BURST_SIZE / 2; i++)
+		tims[i] = &timers[2 * i];
+	TEST_ASSERT(rte_event_timer_cancel_burst(TEST_INST_ID, tims,
+		BURST_SIZE / 2) == BURST_SIZE / 2, "Failed to cancel timers");
+	for (i = 0; i < BURST_SIZE / 2; i++)
+		TEST_ASSERT(timers[2 * i].state == RTE_EVENT_TIMER_CANCELED,
+			"Invalid state of canceled timer");
+	TEST_ASSERT(rte_event_timer_cancel_burst(TEST_INST_ID, tims, 1) ==
+		0 && rte_errno == EALREADY, "Timer canceled twice");
+
+	TEST_ASSERT(timer_events_get(BURST_SIZE / 2, NULL, TEST_TICK_NS,
+		seen) == BURST_SIZE / 2, "Failed to receive timer events");
+	for (i = 0; i < BURST_SIZE; i++)
+		TEST_ASSERT(seen[i] == (i & 1), "Canceled timer expired");
+	TEST_ASSERT_SUCCESS(timer_events_none(5), "Unexpected event");
+
+	TEST_ASSERT(rte_event_timer_arm_burst(TEST_INST_ID, tims,
+		BURST_SIZE / 2) == BURST_SIZE / 2,
+		"Failed to arm canceled timers");
+	TEST_ASSERT(timer_events_get(BURST_SIZE / 2, NULL, TEST_TICK_NS,
+		NULL) == BURST_SIZE / 2, "Failed to receive timer events");
+
+	TEST_ASSERT_SUCCESS(rte_event_timer_adapter_stats_get(TEST_INST_ID,
+		&stats), "Failed to get stats");
+	TEST_ASSERT(stats.evtim_arm_count == 3 * BURST_SIZE / 2 &&
+		stats.evtim_cancel_count == BURST_SIZE / 2 &&
+		stats.evtim_exp_count == BURST_SIZE, "Invalid stats");
+
+	return TEST_SUCCESS;
+}
+
+/* timers which expire while the adapter is stopped are delivered later */
+static int
+timer_stop_start(void)
+{
+	struct rte_event_timer *tim = &timers[0];
+
+	timer_init(tim, 1);
+	TEST_ASSERT(rte_event_timer_arm_burst(TEST_INST_ID, &tim, 1) == 1,
+		"Failed to arm timer");
+	TEST_ASSERT_SUCCESS(rte_event_timer_adapter_stop(TEST_INST_ID),
+		"Failed to stop adapter");
+	TEST_ASSERT_SUCCESS(timer_events_none(5),
+		"Event from stopped adapter");
+	TEST_ASSERT(tim->state == RTE_EVENT_TIMER_ARMED,
+		"Timer expired while the adapter is stopped");
+
+	TEST_ASSERT_SUCCESS(rte_event_timer_adapter_start(TEST_INST_ID),
+		"Failed to start adapter");
+	TEST_ASSERT(timer_events_get(1, NULL, TEST_TICK_NS, NULL) == 1,
+		"Failed to receive timer event");
+
+	return TEST_SUCCESS;
+}
+
+/* the number of armed timers is limited, armed timers prevent free */
+static int
+timer_nb_timers(void)
+{
+	struct rte_event_timer *tims[BURST_SIZE];
+	const uint8_t id = TEST_INST_ID + 1;
+	uint32_t i;
+
+	TEST_ASSERT_SUCCESS(adapter_create_conf(id, TEST_TICK_NS,
+		TEST_MAX_TMO_NS, BURST_SIZE / 2), "Failed to create adapter");
+
+	for (i = 0; i < BURST_SIZE; i++) {
+		timer_init(&timers[i], 1000);
+		tims[i] = &timers[i];
+	}
+	TEST_ASSERT(rte_event_timer_arm_burst(id, tims, BURST_SIZE) ==
+		BURST_SIZE / 2 && rte_errno == ENOSPC,
+		"Armed more timers than the adapter max");
+	TEST_ASSERT(rte_event_timer_adapter_free(id) == -EBUSY,
+		"Adapter with armed timers was freed");
+	TEST_ASSERT(rte_event_timer_cancel_burst(id, tims, BURST_SIZE / 2) ==
+		BURST_SIZE / 2, "Failed to cancel timers");
+	TEST_ASSERT_SUCCESS(rte_event_timer_adapter_free(id),
+		"Failed to free adapter");
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Timers more than a wheel turn apart share a slot: with 1 us ticks and
+ * a 1 s max timeout, the wheel is smaller than the max timeout.
+ */
+static int
+timer_wheel_turns(void)
+{
+	static const uint64_t tmo[] = {10, (1 << 18) + 10, (2 << 18) + 10};
+	struct rte_event_timer *tims[RTE_DIM(tmo)];
+	uint64_t armed[RTE_DIM(tmo)];
+	uint8_t seen[RTE_DIM(tmo)] = {0};
+	uint32_t i;
+
+	adapter_free();
+	TEST_ASSERT_SUCCESS(adapter_create_conf(TEST_INST_ID, 1000,
+		TEST_MAX_TMO_NS, TEST_NB_TIMERS), "Failed to create adapter");
+
+	for (i = 0; i < RTE_DIM(tmo); i++) {
+		timer_init(&timers[i], tmo[i]);
+		tims[i] = &timers[i];
+		armed[i] = rte_get_timer_cycles();
+		TEST_ASSERT(rte_event_timer_arm_burst(TEST_INST_ID, &tims[i],
+			1) == 1, "Failed to arm timer");
+	}
+
+	for (i = 0; i < RTE_DIM(tmo); i++) {
+		TEST_ASSERT(timer_events_get(1, armed, 1000, seen) == 1,
+			"Failed to receive timer event");
+		TEST_ASSERT(seen[i] == 1, "Timer %u expired out of order", i);
+	}
+
+	return TEST_SUCCESS;
+}
+
+/* many timers with random timeouts over the whole wheel */
+static int
+timer_many(void)
+{
+	struct rte_event_timer *tims[BURST_SIZE];
+	uint64_t *armed;
+	uint8_t *seen;
+	uint32_t i, j;
+	int ret = TEST_SUCCESS;
+
+	armed = rte_malloc(NULL, TEST_NB_TIMERS * sizeof(*armed), 0);
+	seen = rte_zmalloc(NULL, TEST_NB_TIMERS, 0);
+	if (armed == NULL || seen == NULL) {
+		rte_free(armed);
+		rte_free(seen);
+		return TEST_FAILED;
+	}
+
+	for (i = 0; i < TEST_NB_TIMERS && ret == TEST_SUCCESS;
+			i += BURST_SIZE) {
+		for (j = 0; j < BURST_SIZE; j++) {
+			/* up to 100 ms */
+			timer_init(&timers[i + j], 1 + rte_rand() % 1000);
+			tims[j] = &timers[i + j];
+			armed[i + j] = rte_get_timer_cycles();
+		}
+		if (rte_event_timer_arm_burst(TEST_INST_ID, tims,
+				BURST_SIZE) != BURST_SIZE)
+			ret = TEST_FAILED;
+		services_run();
+	}
+
+	if (ret == TEST_SUCCESS && timer_events_get(TEST_NB_TIMERS, armed,
+			TEST_TICK_NS, seen) != TEST_NB_TIMERS)
+		ret = TEST_FAILED;
+
+	rte_free(armed);
+	rte_free(seen);
+	return ret;
+}
+
+static int
+testsuite_setup(void)
+{
+	const char *eventdev_name = "event_sw0";
+
+	evdev = rte_event_dev_get_dev_id(eventdev_name);
+	if (evdev < 0) {
+		if (rte_vdev_init(eventdev_name, NULL) < 0) {
+			printf("Error creating eventdev\n");
+			return TEST_FAILED;
+		}
+		evdev = rte_event_dev_get_dev_id(eventdev_name);
+		if (evdev < 0) {
+			printf("Error finding newly created eventdev\n");
+			return TEST_FAILED;
+		}
+	}
+
+	if (rte_event_dev_service_id_get(evdev, &evdev_service_id) < 0) {
+		printf("Failed to get service ID for software event dev\n");
+		return TEST_FAILED;
+	}
+	rte_service_runstate_set(evdev_service_id, 1);
+	rte_service_set_runstate_mapped_check(evdev_service_id, 0);
+
+	if (evdev_setup() != TEST_SUCCESS)
+		return TEST_FAILED;
+
+	if (timers == NULL) {
+		nb_timers_alloc = PERF_NB_TIMERS;
+		timers = rte_zmalloc(NULL, nb_timers_alloc * sizeof(*timers),
+			RTE_CACHE_LINE_SIZE);
+		if (timers == NULL) {
+			printf("Failed to allocate timers\n");
+			return TEST_FAILED;
+		}
+	}
+
+	return TEST_SUCCESS;
+}
+
+static void
+testsuite_teardown(void)
+{
+	rte_event_dev_stop(evdev);
+	rte_event_dev_close(evdev);
+}
+
+static struct unit_test_suite timer_adapter_tests = {
+	.suite_name = "event timer adapter test suite",
+	.setup = testsuite_setup,
+	.teardown = testsuite_teardown,
+	.unit_test_cases = {
+		TEST_CASE_ST(adapter_create, adapter_free, timer_arm_expire),
+		TEST_CASE_ST(adapter_create, adapter_free, timer_arm_invalid),
+		TEST_CASE_ST(adapter_create, adapter_free, timer_cancel),
+		TEST_CASE_ST(adapter_create, adapter_free, timer_stop_start),
+		TEST_CASE_ST(adapter_create, adapter_free, timer_nb_timers),
+		TEST_CASE_ST(adapter_create, adapter_free, timer_wheel_turns),
+		TEST_CASE_ST(adapter_create, adapter_free, timer_many),
+		/* last, the default port config reconfigures the device */
+		TEST_CASE_ST(NULL, NULL, timer_adapter_create_free),
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_event_timer_adapter(void)
+{
+	return unit_test_suite_runner(&timer_adapter_tests);
+}
+
+/*
+ * Cycles per timer of arm and cancel bursts with PERF_NB_TIMERS timers
+ * armed, and rate of timer expiry events delivered through the event
+ * device, for timeouts spread over 10 ms.
+ */
+static int
+test_event_timer_adapter_perf(void)
+{
+	const uint64_t tick_ns = 10000;
+	struct rte_event_timer *tims[BURST_SIZE];
+	struct rte_event ev[BURST_SIZE];
+	uint64_t start, arm_cycles = 0, cancel_cycles = 0, svc_cycles = 0;
+	uint64_t elapsed;
+	uint32_t i, j, received;
+
+	if (testsuite_setup() != TEST_SUCCESS)
+		return -1;
+	memset(timers, 0, nb_timers_alloc * sizeof(*timers));
+	if (adapter_create_conf(TEST_INST_ID, tick_ns, TEST_MAX_TMO_NS,
+			PERF_NB_TIMERS) != TEST_SUCCESS)
+		return -1;
+
+	/* arm and cancel, timeouts up to the max */
+	for (i = 0; i < PERF_NB_TIMERS; i += BURST_SIZE) {
+		for (j = 0; j < BURST_SIZE; j++) {
+			timer_init(&timers[i + j], 1 + rte_rand() %
+				(TEST_MAX_TMO_NS / tick_ns));
+			tims[j] = &timers[i + j];
+		}
+		start = rte_rdtsc();
+		if (rte_event_timer_arm_burst(TEST_INST_ID, tims,
+				BURST_SIZE) != BURST_SIZE)
+			goto fail;
+		arm_cycles += rte_rdtsc() - start;
+	}
+	for (i = 0; i < PERF_NB_TIMERS; i += BURST_SIZE) {
+		for (j = 0; j < BURST_SIZE; j++)
+			tims[j] = &timers[i + j];
+		start = rte_rdtsc();
+		if (rte_event_timer_cancel_burst(TEST_INST_ID, tims,
+				BURST_SIZE) != BURST_SIZE)
+			goto fail;
+		cancel_cycles += rte_rdtsc() - start;
+	}
+
+	printf("%u timers: arm %.1f cycles/timer, cancel %.1f cycles/timer\n",
+		PERF_NB_TIMERS, (double)arm_cycles / PERF_NB_TIMERS,
+		(double)cancel_cycles / PERF_NB_TIMERS);
+
+	/* expiry, timeouts up to 10 ms */
+	for (i = 0; i < PERF_NB_TIMERS; i += BURST_SIZE) {
+		for (j = 0; j < BURST_SIZE; j++) {
+			timer_init(&timers[i + j], 1 + rte_rand() % 1000);
+			tims[j] = &timers[i + j];
+		}
+		if (rte_event_timer_arm_burst(TEST_INST_ID, tims,
+				BURST_SIZE) != BURST_SIZE)
+			goto fail;
+	}
+
+	received = 0;
+	start = rte_get_timer_cycles();
+	while (received < PERF_NB_TIMERS) {
+		uint64_t t = rte_rdtsc();
+
+		rte_service_run_iter_on_app_lcore(adapter_service_id, 1);
+		svc_cycles += rte_rdtsc() - t;
+		rte_service_run_iter_on_app_lcore(evdev_service_id, 1);
+		received += rte_event_dequeue_burst(evdev, TEST_WORKER_PORT,
+			ev, BURST_SIZE, 0);
+		if (rte_get_timer_cycles() - start >
+				DEQUEUE_TIMEOUT_S * rte_get_timer_hz())
+			goto fail;
+	}
+	elapsed = rte_get_timer_cycles() - start;
+
+	printf("%u timers expired in %.1f ms: %.2f Mtimers/s, "
+		"adapter service %.1f cycles/timer\n", PERF_NB_TIMERS,
+		(double)elapsed * 1000 / rte_get_timer_hz(),
+		(double)PERF_NB_TIMERS * rte_get_timer_hz() / elapsed / 1E6,
+		(double)svc_cycles / PERF_NB_TIMERS);
+
+	adapter_free();
+	testsuite_teardown();
+	return 0;
+
+fail:
+	printf("Timer adapter perf test failed\n");
+	for (i = 0; i < PERF_NB_TIMERS; i += BURST_SIZE) {
+		for (j = 0; j < BURST_SIZE; j++)
+			tims[j] = &timers[i + j];
+		rte_event_timer_cancel_burst(TEST_INST_ID, tims, BURST_SIZE);
+	}
+	adapter_free();
+	testsuite_teardown();
+	return -1;
+}
+
+REGISTER_TEST_COMMAND(event_timer_adapter_autotest, test_event_timer_adapter);
+REGISTER_TEST_COMMAND(event_timer_adapter_perf_autotest,
+		test_event_timer_adapter_perf);
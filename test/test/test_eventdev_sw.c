@@ -907,15 +907,15 @@ xstats_tests(struct test *t)
 	ret = rte_event_dev_xstats_names_get(evdev,
 					RTE_EVENT_DEV_XSTATS_PORT, 0,
 					xstats_names, ids, XSTATS_MAX);
-	if (ret != 21) {
-		printf("%d: expected 21 stats, got return %d\n", __LINE__, ret);
+	if (ret != 24) {
+		printf("%d: expected 24 stats, got return %d\n", __LINE__, ret);
 		return -1;
 	}
 	ret = rte_event_dev_xstats_get(evdev,
 					RTE_EVENT_DEV_XSTATS_PORT, 0,
 					ids, values, ret);
-	if (ret != 21) {
-		printf("%d: expected 21 stats, got return %d\n", __LINE__, ret);
+	if (ret != 24) {
+		printf("%d: expected 24 stats, got return %d\n", __LINE__, ret);
 		return -1;
 	}
 
@@ -1029,9 +1029,13 @@ xstats_tests(struct test *t)
 		0 /* cq ring used */,
 		32 /* cq ring free */,
 		0 /* dequeue calls */,
-		/* 10 dequeue burst buckets */
-		0, 0, 0, 0, 0,
+		0 /* dequeues returning 0 */,
+		0 /* flows migrated */,
+		32 /* cq depth */,
+		0 /* dequeue rate */,
+		/* 9 dequeue burst buckets */
 		0, 0, 0, 0, 0,
+		0, 0, 0, 0,
 	};
 	if (ret != RTE_DIM(port_expected)) {
 		printf(
@@ -1066,9 +1070,13 @@ xstats_tests(struct test *t)
 		0 /* cq ring used */,
 		32 /* cq ring free */,
 		0 /* dequeue calls */,
-		/* 10 dequeue burst buckets */
-		0, 0, 0, 0, 0,
+		0 /* dequeues returning 0 */,
+		0 /* flows migrated */,
+		32 /* cq depth */,
+		0 /* dequeue rate */,
+		/* 9 dequeue burst buckets */
 		0, 0, 0, 0, 0,
+		0, 0, 0, 0,
 	};
 	ret = rte_event_dev_xstats_get(evdev,
 					RTE_EVENT_DEV_XSTATS_PORT,
@@ -1562,13 +1570,13 @@ xstats_id_reset_tests(struct test *t)
 		}
 	};
 
-/* 48 is stat offset from start of the devices whole xstats.
+/* 54 is stat offset from start of the devices whole xstats.
  * This WILL break every time we add a statistic to a port
  * or the device, but there is no other way to test
  */
-#define PORT_OFF 48
+#define PORT_OFF 54
 /* num stats for the tested port. CQ size adds more stats to a port */
-#define NUM_PORT_STATS 21
+#define NUM_PORT_STATS 24
 /* the port to test. */
 #define PORT 2
 	num_stats = rte_event_dev_xstats_names_get(evdev,
@@ -1600,6 +1608,9 @@ xstats_id_reset_tests(struct test *t)
 		"port_2_cq_ring_free",
 		"port_2_dequeue_calls",
 		"port_2_dequeues_returning_0",
+		"port_2_flows_migrated",
+		"port_2_cq_depth",
+		"port_2_dequeue_rate",
 		"port_2_dequeues_returning_1-4",
 		"port_2_dequeues_returning_5-8",
 		"port_2_dequeues_returning_9-12",
@@ -1621,9 +1632,13 @@ xstats_id_reset_tests(struct test *t)
 		4096, /* rx ring free */
 		NPKTS,  /* cq ring used */
 		25, /* cq ring free */
+		0, /* dequeue calls */
 		0, /* dequeue zero calls */
-		0, 0, 0, 0, 0, /* 10 dequeue buckets */
-		0, 0, 0, 0, 0,
+		0, /* flows migrated */
+		32, /* cq depth */
+		0, /* dequeue rate */
+		0, 0, 0, 0, 0, /* 9 dequeue buckets */
+		0, 0, 0, 0,
 	};
 	uint64_t port_expected_zero[] = {
 		0, /* rx */
@@ -1636,9 +1651,13 @@ xstats_id_reset_tests(struct test *t)
 		4096, /* rx ring free */
 		NPKTS,  /* cq ring used */
 		25, /* cq ring free */
+		0, /* dequeue calls */
 		0, /* dequeue zero calls */
-		0, 0, 0, 0, 0, /* 10 dequeue buckets */
-		0, 0, 0, 0, 0,
+		0, /* flows migrated */
+		32, /* cq depth */
+		0, /* dequeue rate */
+		0, 0, 0, 0, 0, /* 9 dequeue buckets */
+		0, 0, 0, 0,
 	};
 	if (RTE_DIM(port_expected) != NUM_PORT_STATS ||
 			RTE_DIM(port_names) != NUM_PORT_STATS) {
@@ -1690,7 +1709,7 @@ xstats_id_reset_tests(struct test *t)
 /* queue offset from start of the devices whole xstats.
  * This will break every time we add a statistic to a device/port/queue
  */
-#define QUEUE_OFF 90
+#define QUEUE_OFF 102
 	const uint32_t queue = 0;
 	num_stats = rte_event_dev_xstats_names_get(evdev,
 					RTE_EVENT_DEV_XSTATS_QUEUE, queue,
@@ -2191,6 +2210,219 @@ load_balancing_history(struct test *t)
 	return 0;
 }
 
+static int
+enqueue_flows(struct test *t, uint8_t port, const uint32_t flows[],
+		uint32_t num)
+{
+	uint32_t i;
+
+	for (i = 0; i < num; i++) {
+		struct rte_mbuf *arp = rte_gen_arp(0, t->mbuf_pool);
+		struct rte_event ev = {
+				.flow_id = flows[i],
+				.op = RTE_EVENT_OP_NEW,
+				.queue_id = t->qid[0],
+				.event_type = RTE_EVENT_TYPE_CPU,
+				.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+				.mbuf = arp
+		};
+
+		if (!arp) {
+			printf("%d: gen of pkt failed\n", __LINE__);
+			return -1;
+		}
+		arp->hash.rss = flows[i];
+		if (rte_event_enqueue_burst(evdev, port, &ev, 1) != 1) {
+			printf("%d: Failed to enqueue\n", __LINE__);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int
+load_balancing_migration(struct test *t)
+{
+	struct test_event_dev_stats stats = {0};
+	const int rx_enq = 0;
+	uint64_t migrated;
+	uint32_t i;
+	int err;
+
+	/* Create instance with 1 atomic QID going to 2 ports + 1 prod port */
+	if (init(t, 1, 3) < 0 ||
+			create_ports(t, 3) < 0 ||
+			create_atomic_qids(t, 1) < 0)
+		return -1;
+
+	for (i = 1; i <= 2; i++) {
+		if (rte_event_port_link(evdev, t->port[i], &t->qid[0],
+				NULL, 1) != 1) {
+			printf("%d: error mapping port %u qid\n", __LINE__, i);
+			return -1;
+		}
+	}
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		return -1;
+	}
+
+	/*
+	 * Flow 0 is pinned to CQ 1 and flow 1 to CQ 2. Once the flow 0 packet
+	 * is released the flow is idle, and its next packet must go to the
+	 * least loaded CQ: fill CQ 1 with a new flow 2 so flow 0 migrates to
+	 * CQ 2, which is then reported in the port 2 flows_migrated xstat.
+	 */
+	static const uint32_t flows1[] = {0, 1, 1};
+	static const uint32_t flows2[] = {2, 2, 2, 0};
+
+	if (enqueue_flows(t, t->port[rx_enq], flows1, RTE_DIM(flows1)) < 0)
+		return -1;
+	rte_service_run_iter_on_app_lcore(t->service_id, 1);
+
+	struct rte_event ev;
+	if (!rte_event_dequeue_burst(evdev, t->port[1], &ev, 1, 0)) {
+		printf("%d: failed to dequeue\n", __LINE__);
+		return -1;
+	}
+	if (ev.mbuf->hash.rss != flows1[0]) {
+		printf("%d: unexpected flow received\n", __LINE__);
+		return -1;
+	}
+	rte_pktmbuf_free(ev.mbuf);
+	rte_event_enqueue_burst(evdev, t->port[1], &release_ev, 1);
+	rte_service_run_iter_on_app_lcore(t->service_id, 1);
+
+	if (enqueue_flows(t, t->port[rx_enq], flows2, RTE_DIM(flows2)) < 0)
+		return -1;
+	rte_service_run_iter_on_app_lcore(t->service_id, 1);
+
+	err = test_event_dev_stats_get(evdev, &stats);
+	if (err) {
+		printf("%d: failed to get stats\n", __LINE__);
+		return -1;
+	}
+	if (stats.port_inflight[1] != 3 || stats.port_inflight[2] != 3) {
+		printf("%d:%s: inflights not correct, ports 1, 2: %u, %u\n",
+				__LINE__, __func__,
+				(unsigned int)stats.port_inflight[1],
+				(unsigned int)stats.port_inflight[2]);
+		return -1;
+	}
+
+	migrated = rte_event_dev_xstats_by_name_get(evdev,
+			"port_2_flows_migrated", NULL);
+	if (migrated != 1) {
+		printf("%d: expected 1 flow migrated to port 2, got %"PRIu64
+				"\n", __LINE__, migrated);
+		return -1;
+	}
+	migrated = rte_event_dev_xstats_by_name_get(evdev,
+			"port_1_flows_migrated", NULL);
+	if (migrated != 0) {
+		printf("%d: expected no flow migrated to port 1, got %"PRIu64
+				"\n", __LINE__, migrated);
+		return -1;
+	}
+
+	for (i = 1; i <= 2; i++) {
+		while (rte_event_dequeue_burst(evdev, i, &ev, 1, 0)) {
+			rte_pktmbuf_free(ev.mbuf);
+			rte_event_enqueue_burst(evdev, i, &release_ev, 1);
+		}
+	}
+	rte_service_run_iter_on_app_lcore(t->service_id, 1);
+
+	cleanup(t);
+	return 0;
+}
+
+static int
+large_atomic_flows(struct test *t)
+{
+	struct test_event_dev_stats stats = {0};
+	const uint32_t nb_flows = 1 << 16;
+	const struct rte_event_dev_config config = {
+			.nb_event_queues = 1,
+			.nb_event_ports = 3,
+			.nb_event_queue_flows = nb_flows,
+			.nb_events_limit = 4096,
+			.nb_event_port_dequeue_depth = 128,
+			.nb_event_port_enqueue_depth = 128,
+	};
+	const struct rte_event_queue_conf conf = {
+			.schedule_type = RTE_SCHED_TYPE_ATOMIC,
+			.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+			.nb_atomic_flows = nb_flows,
+			.nb_atomic_order_sequences = 1024,
+	};
+	uint32_t i;
+	int err;
+
+	/*
+	 * Flows 16 and 16384 hash to the same FID in a table of 16384 flows,
+	 * which would pin both to one CQ. With 65536 flows they are separate
+	 * flows, and are load balanced to the two CQs.
+	 */
+	static const uint32_t flows[] = {16, 16384};
+
+	if (init(t, 1, 3) < 0)
+		return -1;
+	if (rte_event_dev_configure(evdev, &config) < 0) {
+		printf("%d: Error configuring device\n", __LINE__);
+		return -1;
+	}
+	if (create_ports(t, 3) < 0)
+		return -1;
+	if (rte_event_queue_setup(evdev, 0, &conf) < 0) {
+		printf("%d: error creating qid\n", __LINE__);
+		return -1;
+	}
+	t->qid[0] = 0;
+	t->nb_qids = 1;
+
+	for (i = 1; i <= 2; i++) {
+		if (rte_event_port_link(evdev, t->port[i], &t->qid[0],
+				NULL, 1) != 1) {
+			printf("%d: error mapping port %u qid\n", __LINE__, i);
+			return -1;
+		}
+	}
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		return -1;
+	}
+
+	if (enqueue_flows(t, t->port[0], flows, RTE_DIM(flows)) < 0)
+		return -1;
+	rte_service_run_iter_on_app_lcore(t->service_id, 1);
+
+	err = test_event_dev_stats_get(evdev, &stats);
+	if (err) {
+		printf("%d: failed to get stats\n", __LINE__);
+		return -1;
+	}
+	if (stats.port_inflight[1] != 1 || stats.port_inflight[2] != 1) {
+		printf("%d:%s: inflights not correct, ports 1, 2: %u, %u\n",
+				__LINE__, __func__,
+				(unsigned int)stats.port_inflight[1],
+				(unsigned int)stats.port_inflight[2]);
+		return -1;
+	}
+
+	for (i = 1; i <= 2; i++) {
+		struct rte_event ev;
+		while (rte_event_dequeue_burst(evdev, i, &ev, 1, 0)) {
+			rte_pktmbuf_free(ev.mbuf);
+			rte_event_enqueue_burst(evdev, i, &release_ev, 1);
+		}
+	}
+	rte_service_run_iter_on_app_lcore(t->service_id, 1);
+
+	cleanup(t);
+	return 0;
+}
+
 static int
 invalid_qid(struct test *t)
 {
@@ -2838,6 +3070,145 @@ holb(struct test *t) /* test to check we avoid basic head-of-line blocking */
 	return -1;
 }
 
+static int
+sharded_pipeline(struct test *t)
+{
+	const char *eventdev_name = "event_sw1";
+	const int sw0 = evdev;
+	const uint32_t sw0_service_id = t->service_id;
+	const uint32_t nb_events = 256;
+	const uint32_t nb_flows = 4;
+	uint64_t last_seqn[nb_flows];
+	uint32_t service_id;
+	uint32_t received = 0;
+	uint32_t i, iter;
+	int ret = -1;
+
+	if (rte_vdev_init(eventdev_name, "sched_shards=2") < 0) {
+		printf("%d: Error creating eventdev\n", __LINE__);
+		goto restore;
+	}
+	evdev = rte_event_dev_get_dev_id(eventdev_name);
+	if (evdev < 0) {
+		printf("%d: Error finding eventdev\n", __LINE__);
+		goto uninit;
+	}
+	if (rte_event_dev_service_id_get(evdev, &service_id) < 0) {
+		printf("%d: Error getting service ID\n", __LINE__);
+		goto uninit;
+	}
+	rte_service_runstate_set(service_id, 1);
+	rte_service_set_runstate_mapped_check(service_id, 0);
+
+	/*
+	 * Queue 0 (ordered) and queue 2 (directed) are scheduled by shard 0,
+	 * queue 1 (atomic) by shard 1. Events go through the three queues,
+	 * so the events forwarded from queue 0 to 1 cross the shards after
+	 * being reordered, and the ones from queue 1 to 2 cross back.
+	 */
+	if (init(t, 3, 4) < 0 ||
+			create_ports(t, 4) < 0 ||
+			create_ordered_qids(t, 1) < 0 ||
+			create_atomic_qids(t, 1) < 0 ||
+			create_directed_qids(t, 1, &t->port[3]) < 0) {
+		printf("%d: Error initializing device\n", __LINE__);
+		goto close;
+	}
+	t->service_id = service_id;
+
+	for (i = 1; i <= 2; i++) {
+		if (rte_event_port_link(evdev, t->port[i], t->qid, NULL, 2)
+				!= 2) {
+			printf("%d: error mapping port %u\n", __LINE__, i);
+			goto close;
+		}
+	}
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		goto close;
+	}
+
+	for (i = 0; i < nb_events; i++) {
+		struct rte_event ev = {
+				.op = RTE_EVENT_OP_NEW,
+				.queue_id = t->qid[0],
+				.flow_id = i % nb_flows,
+				.u64 = i,
+		};
+		if (rte_event_enqueue_burst(evdev, t->port[0], &ev, 1) != 1) {
+			printf("%d: Failed to enqueue\n", __LINE__);
+			goto close;
+		}
+	}
+
+	for (i = 0; i < nb_flows; i++)
+		last_seqn[i] = 0;
+
+	for (iter = 0; received < nb_events && iter < 1000; iter++) {
+		struct rte_event ev[32];
+		uint16_t n, j;
+
+		rte_service_run_iter_on_app_lcore(t->service_id, 1);
+
+		/* workers forward to the next queue, port 2 first so events
+		 * of queue 0 complete out of order
+		 */
+		for (i = 2; i >= 1; i--) {
+			n = rte_event_dequeue_burst(evdev, t->port[i], ev,
+					RTE_DIM(ev), 0);
+			for (j = 0; j < n; j++) {
+				ev[j].queue_id++;
+				ev[j].op = RTE_EVENT_OP_FORWARD;
+			}
+			for (j = n; j-- > 0;)
+				if (rte_event_enqueue_burst(evdev, t->port[i],
+						&ev[j], 1) != 1) {
+					printf("%d: Failed to forward\n",
+							__LINE__);
+					goto close;
+				}
+		}
+
+		n = rte_event_dequeue_burst(evdev, t->port[3], ev,
+				RTE_DIM(ev), 0);
+		for (j = 0; j < n; j++) {
+			const uint32_t flow = ev[j].flow_id;
+
+			/* last_seqn is the last sequence number + 1 */
+			if (ev[j].u64 < last_seqn[flow]) {
+				printf("%d: flow %u out of order, %"PRIu64
+					" after %"PRIu64"\n", __LINE__, flow,
+					ev[j].u64, last_seqn[flow] - 1);
+				goto close;
+			}
+			last_seqn[flow] = ev[j].u64 + 1;
+		}
+		received += n;
+	}
+
+	if (received != nb_events) {
+		printf("%d: received %u events, expected %u\n", __LINE__,
+				received, nb_events);
+		rte_event_dev_dump(evdev, stdout);
+		goto close;
+	}
+	if (rte_event_dev_xstats_by_name_get(evdev, "qid_1_rx", NULL) !=
+			nb_events) {
+		printf("%d: events did not all reach queue 1\n", __LINE__);
+		goto close;
+	}
+
+	ret = 0;
+close:
+	cleanup(t);
+uninit:
+	rte_vdev_uninit(eventdev_name);
+restore:
+	evdev = sw0;
+	t->service_id = sw0_service_id;
+	return ret;
+}
+
 static int
 worker_loopback_worker_fn(void *arg)
 {
@@ -3172,6 +3543,18 @@ test_sw_eventdev(void)
 		printf("ERROR - Load Balancing History test FAILED.\n");
 		return ret;
 	}
+	printf("*** Running Load Balancing Migration test...\n");
+	ret = load_balancing_migration(t);
+	if (ret != 0) {
+		printf("ERROR - Load Balancing Migration test FAILED.\n");
+		return ret;
+	}
+	printf("*** Running Large Atomic Flows test...\n");
+	ret = large_atomic_flows(t);
+	if (ret != 0) {
+		printf("ERROR - Large Atomic Flows test FAILED.\n");
+		return ret;
+	}
 	printf("*** Running Inflight Count test...\n");
 	ret = inflight_counts(t);
 	if (ret != 0) {
@@ -3238,6 +3621,12 @@ test_sw_eventdev(void)
 		printf("ERROR - Head-of-line-blocking test FAILED.\n");
 		return ret;
 	}
+	printf("*** Running Sharded Pipeline test...\n");
+	ret = sharded_pipeline(t);
+	if (ret != 0) {
+		printf("ERROR - Sharded Pipeline test FAILED.\n");
+		return ret;
+	}
 	if (rte_lcore_count() >= 3) {
 		printf("*** Running Worker loopback test...\n");
 		ret = worker_loopback(t);
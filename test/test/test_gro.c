@@ -0,0 +1,908 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_mbuf.h>
+#include <rte_ether.h>
+#include <rte_eth_ctrl.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_gro.h>
+
+#include "test.h"
+
+/* enough mbufs to fill the tables of the flow scaling benchmark */
+#define NB_MBUF		65535
+#define MBUF_DATA_SIZE	(RTE_PKTMBUF_HEADROOM + 512)
+#define MBUF_CACHE	32
+
+#define BURST_SIZE	32
+#define SEG_LEN		96	/* multiple of 8 for IP fragments */
+#define TCP_ISN		1000
+#define VXLAN_PORT	4789
+
+#define PERF_ROUNDS	2048
+
+enum gro_test_type {
+	GRO_TEST_TCP4,
+	GRO_TEST_TCP6,
+	GRO_TEST_VXLAN,
+	GRO_TEST_UDP4,
+	GRO_TEST_NUM,
+};
+
+static const struct {
+	const char *name;
+	uint64_t gro_type;
+	uint32_t hdr_len;
+} gro_test_types[GRO_TEST_NUM] = {
+	[GRO_TEST_TCP4] = {"TCP/IPv4", RTE_GRO_TCP_IPV4,
+		sizeof(struct ether_hdr) + sizeof(struct ipv4_hdr) +
+		sizeof(struct tcp_hdr)},
+	[GRO_TEST_TCP6] = {"TCP/IPv6", RTE_GRO_TCP_IPV6,
+		sizeof(struct ether_hdr) + sizeof(struct ipv6_hdr) +
+		sizeof(struct tcp_hdr)},
+	[GRO_TEST_VXLAN] = {"VXLAN TCP/IPv4", RTE_GRO_IPV4_VXLAN_TCP_IPV4,
+		2 * sizeof(struct ether_hdr) + 2 * sizeof(struct ipv4_hdr) +
+		ETHER_VXLAN_HLEN + sizeof(struct tcp_hdr)},
+	[GRO_TEST_UDP4] = {"UDP/IPv4 fragments", RTE_GRO_UDP_IPV4,
+		sizeof(struct ether_hdr) + sizeof(struct ipv4_hdr)},
+};
+
+#define GRO_TEST_ALL_TYPES (RTE_GRO_TCP_IPV4 | RTE_GRO_TCP_IPV6 | \
+		RTE_GRO_IPV4_VXLAN_TCP_IPV4 | RTE_GRO_UDP_IPV4)
+
+static struct rte_mempool *pkt_pool;
+
+static uint8_t
+payload_byte(uint32_t flow, uint32_t ofs)
+{
+	return (uint8_t)(flow * 31 + ofs);
+}
+
+/* append *len* zeroed bytes to *m*, NULL if the mbuf is full. */
+static void *
+pkt_put(struct rte_mbuf *m, uint16_t len)
+{
+	void *p = rte_pktmbuf_append(m, len);
+
+	if (p != NULL)
+		memset(p, 0, len);
+	return p;
+}
+
+static int
+eth_put(struct rte_mbuf *m, uint16_t ether_type)
+{
+	struct ether_hdr *eth = pkt_put(m, sizeof(*eth));
+
+	if (eth == NULL)
+		return -1;
+	eth->s_addr.addr_bytes[5] = 1;
+	eth->d_addr.addr_bytes[5] = 2;
+	eth->ether_type = rte_cpu_to_be_16(ether_type);
+	return 0;
+}
+
+static int
+ipv4_put(struct rte_mbuf *m, uint32_t flow, uint16_t ip_id, uint8_t proto,
+	uint16_t total_len, uint16_t fo)
+{
+	struct ipv4_hdr *ip = pkt_put(m, sizeof(*ip));
+
+	if (ip == NULL)
+		return -1;
+	ip->version_ihl = 0x45;
+	ip->time_to_live = 64;
+	ip->next_proto_id = proto;
+	ip->total_length = rte_cpu_to_be_16(total_len);
+	ip->packet_id = rte_cpu_to_be_16(ip_id);
+	ip->fragment_offset = rte_cpu_to_be_16(fo);
+	ip->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 0) + flow);
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(10, 0, 1, 1));
+	return 0;
+}
+
+static int
+ipv6_put(struct rte_mbuf *m, uint32_t flow, uint16_t payload_len)
+{
+	struct ipv6_hdr *ip6 = pkt_put(m, sizeof(*ip6));
+
+	if (ip6 == NULL)
+		return -1;
+	ip6->vtc_flow = rte_cpu_to_be_32(6 << 28);
+	ip6->payload_len = rte_cpu_to_be_16(payload_len);
+	ip6->proto = IPPROTO_TCP;
+	ip6->hop_limits = 64;
+	ip6->src_addr[13] = flow >> 16;
+	ip6->src_addr[14] = flow >> 8;
+	ip6->src_addr[15] = flow;
+	ip6->dst_addr[15] = 1;
+	return 0;
+}
+
+/* outer UDP and VXLAN headers. */
+static int
+vxlan_put(struct rte_mbuf *m, uint32_t flow, uint16_t dgram_len)
+{
+	struct udp_hdr *udp;
+	struct vxlan_hdr *vxlan;
+
+	udp = pkt_put(m, sizeof(*udp));
+	if (udp == NULL)
+		return -1;
+	udp->src_port = rte_cpu_to_be_16(5000 + flow);
+	udp->dst_port = rte_cpu_to_be_16(VXLAN_PORT);
+	udp->dgram_len = rte_cpu_to_be_16(dgram_len);
+
+	vxlan = pkt_put(m, sizeof(*vxlan));
+	if (vxlan == NULL)
+		return -1;
+	vxlan->vx_flags = rte_cpu_to_be_32(0x08000000);
+	vxlan->vx_vni = rte_cpu_to_be_32(100 << 8);
+	return 0;
+}
+
+static int
+tcp_put(struct rte_mbuf *m, uint32_t flow, uint32_t ofs, uint8_t flags)
+{
+	struct tcp_hdr *tcp = pkt_put(m, sizeof(*tcp));
+
+	if (tcp == NULL)
+		return -1;
+	tcp->src_port = rte_cpu_to_be_16(1000 + flow);
+	tcp->dst_port = rte_cpu_to_be_16(80);
+	tcp->sent_seq = rte_cpu_to_be_32(TCP_ISN + ofs);
+	tcp->recv_ack = rte_cpu_to_be_32(1);
+	tcp->data_off = (sizeof(*tcp) / 4) << 4;
+	tcp->tcp_flags = flags;
+	return 0;
+}
+
+static int
+payload_put(struct rte_mbuf *m, uint32_t flow, uint32_t ofs, uint16_t len)
+{
+	uint8_t *p = pkt_put(m, len);
+	uint32_t i;
+
+	if (p == NULL)
+		return -1;
+	for (i = 0; i != len; i++)
+		p[i] = payload_byte(flow, ofs + i);
+	return 0;
+}
+
+/*
+ * build a packet of flow *flow* carrying the payload bytes at offset
+ * *ofs* of the flow: TCP stream offset, or IP fragment offset.
+ */
+static struct rte_mbuf *
+pkt_build(enum gro_test_type type, uint32_t flow, uint32_t ofs,
+	uint16_t ip_id, uint8_t last, uint8_t tcp_flags)
+{
+	struct rte_mbuf *m;
+	uint16_t tcp_len = sizeof(struct tcp_hdr) + SEG_LEN;
+	uint16_t fo;
+	int ret;
+
+	m = rte_pktmbuf_alloc(pkt_pool);
+	if (m == NULL)
+		return NULL;
+
+	switch (type) {
+	case GRO_TEST_TCP4:
+		ret = eth_put(m, ETHER_TYPE_IPv4);
+		ret |= ipv4_put(m, flow, ip_id, IPPROTO_TCP,
+			sizeof(struct ipv4_hdr) + tcp_len, 0);
+		ret |= tcp_put(m, flow, ofs, tcp_flags);
+		m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			RTE_PTYPE_L4_TCP;
+		m->l2_len = sizeof(struct ether_hdr);
+		m->l3_len = sizeof(struct ipv4_hdr);
+		m->l4_len = sizeof(struct tcp_hdr);
+		break;
+	case GRO_TEST_TCP6:
+		ret = eth_put(m, ETHER_TYPE_IPv6);
+		ret |= ipv6_put(m, flow, tcp_len);
+		ret |= tcp_put(m, flow, ofs, tcp_flags);
+		m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6 |
+			RTE_PTYPE_L4_TCP;
+		m->l2_len = sizeof(struct ether_hdr);
+		m->l3_len = sizeof(struct ipv6_hdr);
+		m->l4_len = sizeof(struct tcp_hdr);
+		break;
+	case GRO_TEST_VXLAN:
+		ret = eth_put(m, ETHER_TYPE_IPv4);
+		ret |= ipv4_put(m, 0, ip_id, IPPROTO_UDP,
+			sizeof(struct ipv4_hdr) + ETHER_VXLAN_HLEN +
+			sizeof(struct ether_hdr) + sizeof(struct ipv4_hdr) +
+			tcp_len, 0);
+		ret |= vxlan_put(m, flow, ETHER_VXLAN_HLEN +
+			sizeof(struct ether_hdr) + sizeof(struct ipv4_hdr) +
+			tcp_len);
+		ret |= eth_put(m, ETHER_TYPE_IPv4);
+		ret |= ipv4_put(m, flow, ip_id, IPPROTO_TCP,
+			sizeof(struct ipv4_hdr) + tcp_len, 0);
+		ret |= tcp_put(m, flow, ofs, tcp_flags);
+		m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			RTE_PTYPE_L4_UDP | RTE_PTYPE_TUNNEL_VXLAN |
+			RTE_PTYPE_INNER_L2_ETHER | RTE_PTYPE_INNER_L3_IPV4 |
+			RTE_PTYPE_INNER_L4_TCP;
+		m->outer_l2_len = sizeof(struct ether_hdr);
+		m->outer_l3_len = sizeof(struct ipv4_hdr);
+		m->l2_len = ETHER_VXLAN_HLEN + sizeof(struct ether_hdr);
+		m->l3_len = sizeof(struct ipv4_hdr);
+		m->l4_len = sizeof(struct tcp_hdr);
+		break;
+	case GRO_TEST_UDP4:
+	default:
+		fo = ofs / IPV4_HDR_OFFSET_UNITS;
+		if (!last)
+			fo |= IPV4_HDR_MF_FLAG;
+		ret = eth_put(m, ETHER_TYPE_IPv4);
+		ret |= ipv4_put(m, flow, ip_id, IPPROTO_UDP,
+			sizeof(struct ipv4_hdr) + SEG_LEN, fo);
+		m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			RTE_PTYPE_L4_FRAG;
+		m->l2_len = sizeof(struct ether_hdr);
+		m->l3_len = sizeof(struct ipv4_hdr);
+		break;
+	}
+
+	ret |= payload_put(m, flow, ofs, SEG_LEN);
+	if (ret != 0) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	return m;
+}
+
+/*
+ * check the length fields and the payload of a (merged) packet.
+ * Return the payload length, or -1 on error.
+ */
+static int
+pkt_check(enum gro_test_type type, struct rte_mbuf *m)
+{
+	uint32_t hdr_len = gro_test_types[type].hdr_len;
+	uint8_t buf[UINT16_MAX];
+	const struct ipv4_hdr *ip;
+	const struct ipv6_hdr *ip6;
+	const struct udp_hdr *udp;
+	const struct tcp_hdr *tcp;
+	const uint8_t *p;
+	uint32_t flow, ofs, len, i;
+	char *l3;
+
+	if (m->pkt_len <= hdr_len)
+		return -1;
+	len = m->pkt_len - hdr_len;
+	l3 = rte_pktmbuf_mtod_offset(m, char *, sizeof(struct ether_hdr));
+
+	switch (type) {
+	case GRO_TEST_TCP4:
+		ip = (const struct ipv4_hdr *)l3;
+		tcp = (const struct tcp_hdr *)(ip + 1);
+		if (rte_be_to_cpu_16(ip->total_length) !=
+				m->pkt_len - sizeof(struct ether_hdr))
+			return -1;
+		flow = rte_be_to_cpu_32(ip->src_addr) & 0xffffff;
+		ofs = rte_be_to_cpu_32(tcp->sent_seq) - TCP_ISN;
+		break;
+	case GRO_TEST_TCP6:
+		ip6 = (const struct ipv6_hdr *)l3;
+		tcp = (const struct tcp_hdr *)(ip6 + 1);
+		if (rte_be_to_cpu_16(ip6->payload_len) != m->pkt_len -
+				sizeof(struct ether_hdr) - sizeof(*ip6))
+			return -1;
+		flow = (ip6->src_addr[13] << 16) | (ip6->src_addr[14] << 8) |
+			ip6->src_addr[15];
+		ofs = rte_be_to_cpu_32(tcp->sent_seq) - TCP_ISN;
+		break;
+	case GRO_TEST_VXLAN:
+		ip = (const struct ipv4_hdr *)l3;
+		udp = (const struct udp_hdr *)(ip + 1);
+		if (rte_be_to_cpu_16(ip->total_length) !=
+				m->pkt_len - sizeof(struct ether_hdr) ||
+				rte_be_to_cpu_16(udp->dgram_len) !=
+				m->pkt_len - sizeof(struct ether_hdr) -
+				sizeof(*ip))
+			return -1;
+		ip = (const struct ipv4_hdr *)((const char *)udp +
+			ETHER_VXLAN_HLEN + sizeof(struct ether_hdr));
+		tcp = (const struct tcp_hdr *)(ip + 1);
+		if (rte_be_to_cpu_16(ip->total_length) != len +
+				sizeof(*ip) + sizeof(*tcp))
+			return -1;
+		flow = rte_be_to_cpu_32(ip->src_addr) & 0xffffff;
+		ofs = rte_be_to_cpu_32(tcp->sent_seq) - TCP_ISN;
+		break;
+	case GRO_TEST_UDP4:
+	default:
+		ip = (const struct ipv4_hdr *)l3;
+		if (rte_be_to_cpu_16(ip->total_length) !=
+				m->pkt_len - sizeof(struct ether_hdr))
+			return -1;
+		flow = rte_be_to_cpu_32(ip->src_addr) & 0xffffff;
+		ofs = (rte_be_to_cpu_16(ip->fragment_offset) &
+			IPV4_HDR_OFFSET_MASK) * IPV4_HDR_OFFSET_UNITS;
+		break;
+	}
+
+	p = rte_pktmbuf_read(m, hdr_len, len, buf);
+	if (p == NULL)
+		return -1;
+	for (i = 0; i != len; i++)
+		if (p[i] != payload_byte(flow, ofs + i))
+			return -1;
+
+	return len;
+}
+
+/*
+ * build *nb_flows* flows of *nb_segs* segments, interleaved. The
+ * fragments of the UDP datagrams are sent in reverse order if
+ * *reverse* is set.
+ */
+static int
+burst_build(enum gro_test_type type, struct rte_mbuf **pkts,
+	uint32_t nb_flows, uint32_t nb_segs, int reverse)
+{
+	uint32_t f, s, seg, n = 0;
+
+	for (s = 0; s != nb_segs; s++) {
+		for (f = 0; f != nb_flows; f++) {
+			seg = reverse ? nb_segs - 1 - s : s;
+			pkts[n] = pkt_build(type, f + 1, seg * SEG_LEN,
+				type == GRO_TEST_UDP4 ? f : seg,
+				seg == nb_segs - 1, TCP_ACK_FLAG);
+			if (pkts[n] == NULL) {
+				while (n != 0)
+					rte_pktmbuf_free(pkts[--n]);
+				return -1;
+			}
+			n++;
+		}
+	}
+
+	return 0;
+}
+
+static void
+pkts_free(struct rte_mbuf **pkts, uint32_t n)
+{
+	uint32_t i;
+
+	for (i = 0; i != n; i++)
+		rte_pktmbuf_free(pkts[i]);
+}
+
+static int
+pkts_check(enum gro_test_type type, struct rte_mbuf **pkts, uint32_t n,
+	uint32_t nb_expected, uint32_t len_expected)
+{
+	uint32_t i;
+
+	if (n != nb_expected) {
+		printf("%s: %u packets instead of %u\n",
+			gro_test_types[type].name, n, nb_expected);
+		return -1;
+	}
+
+	for (i = 0; i != n; i++) {
+		if (pkt_check(type, pkts[i]) != (int)len_expected) {
+			printf("%s: packet %u is invalid\n",
+				gro_test_types[type].name, i);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+test_gro_burst(void)
+{
+	struct rte_gro_param param = {
+		.max_flow_num = 4,
+		.max_item_per_flow = BURST_SIZE / 4,
+	};
+	struct rte_mbuf *pkts[BURST_SIZE];
+	enum gro_test_type type;
+	uint16_t n;
+	int reverse, ret;
+
+	for (type = 0; type != GRO_TEST_NUM; type++) {
+		for (reverse = 0; reverse != 2; reverse++) {
+			/* out of order TCP segments aren't merged */
+			if (reverse && type != GRO_TEST_UDP4)
+				continue;
+
+			TEST_ASSERT_SUCCESS(burst_build(type, pkts, 4,
+				BURST_SIZE / 4, reverse),
+				"mbuf allocation failed");
+
+			param.gro_types = gro_test_types[type].gro_type;
+			n = rte_gro_reassemble_burst(pkts, BURST_SIZE,
+				&param);
+			ret = pkts_check(type, pkts, n, 4,
+				BURST_SIZE / 4 * SEG_LEN);
+			pkts_free(pkts, n);
+			TEST_ASSERT_SUCCESS(ret, "%s: invalid GRO",
+				gro_test_types[type].name);
+		}
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gro_no_merge(void)
+{
+	struct rte_gro_param param = {
+		.gro_types = GRO_TEST_ALL_TYPES,
+		.max_flow_num = 4,
+		.max_item_per_flow = BURST_SIZE / 4,
+	};
+	struct rte_mbuf *pkts[4];
+	enum gro_test_type type;
+	uint16_t n;
+	int ret;
+
+	for (type = 0; type != GRO_TEST_NUM; type++) {
+		/* a hole between the packets. */
+		pkts[0] = pkt_build(type, 1, 0, 0, 0, TCP_ACK_FLAG);
+		pkts[1] = pkt_build(type, 1, 2 * SEG_LEN,
+			type == GRO_TEST_UDP4 ? 0 : 1, 1, TCP_ACK_FLAG);
+		TEST_ASSERT(pkts[0] != NULL && pkts[1] != NULL,
+			"mbuf allocation failed");
+
+		n = rte_gro_reassemble_burst(pkts, 2, &param);
+		ret = pkts_check(type, pkts, n, 2, SEG_LEN);
+		pkts_free(pkts, n);
+		TEST_ASSERT_SUCCESS(ret, "%s: packets with a hole merged",
+			gro_test_types[type].name);
+
+		if (type == GRO_TEST_UDP4)
+			continue;
+
+		/* TCP flags other than ACK. */
+		pkts[0] = pkt_build(type, 1, 0, 0, 0, TCP_ACK_FLAG);
+		pkts[1] = pkt_build(type, 1, SEG_LEN, 1, 0,
+			TCP_ACK_FLAG | TCP_PSH_FLAG);
+		TEST_ASSERT(pkts[0] != NULL && pkts[1] != NULL,
+			"mbuf allocation failed");
+
+		n = rte_gro_reassemble_burst(pkts, 2, &param);
+		ret = (n == 2) ? 0 : -1;
+		pkts_free(pkts, n);
+		TEST_ASSERT_SUCCESS(ret, "%s: PSH packet merged",
+			gro_test_types[type].name);
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gro_ctx(void)
+{
+	struct rte_gro_param param = {
+		.gro_types = GRO_TEST_ALL_TYPES,
+		.max_flow_num = 4,
+		.max_item_per_flow = BURST_SIZE / 4,
+		.socket_id = SOCKET_ID_ANY,
+	};
+	struct rte_mbuf *pkts[GRO_TEST_NUM][BURST_SIZE];
+	struct rte_mbuf *out[BURST_SIZE];
+	enum gro_test_type type;
+	void *ctx;
+	uint16_t n;
+	int ret = TEST_FAILED;
+
+	memset(pkts, 0, sizeof(pkts));
+
+	ctx = rte_gro_ctx_create(&param);
+	TEST_ASSERT_NOT_NULL(ctx, "GRO context creation failed");
+
+	/* half of the segments in a first burst, the rest later. */
+	for (type = 0; type != GRO_TEST_NUM; type++) {
+		if (burst_build(type, pkts[type], 2, BURST_SIZE / 2, 0)) {
+			printf("mbuf allocation failed\n");
+			goto exit;
+		}
+		n = rte_gro_reassemble(pkts[type], BURST_SIZE / 2, ctx);
+		if (n != 0) {
+			printf("%s: %u packets not processed\n",
+				gro_test_types[type].name, n);
+			goto exit;
+		}
+		n = rte_gro_reassemble(&pkts[type][BURST_SIZE / 2],
+			BURST_SIZE / 2, ctx);
+		memset(pkts[type], 0, sizeof(pkts[type]));
+		if (n != 0) {
+			printf("%s: %u packets not processed\n",
+				gro_test_types[type].name, n);
+			goto exit;
+		}
+	}
+
+	if (rte_gro_get_pkt_count(ctx) != 2 * GRO_TEST_NUM) {
+		printf("%" PRIu64 " packets in the tables instead of %u\n",
+			rte_gro_get_pkt_count(ctx), 2 * GRO_TEST_NUM);
+		goto exit;
+	}
+
+	for (type = 0; type != GRO_TEST_NUM; type++) {
+		n = rte_gro_timeout_flush(ctx, 0, gro_test_types[type].gro_type,
+			out, RTE_DIM(out));
+		ret = pkts_check(type, out, n, 2, BURST_SIZE / 2 * SEG_LEN);
+		pkts_free(out, n);
+		if (ret != 0)
+			goto exit;
+	}
+
+	ret = (rte_gro_get_pkt_count(ctx) == 0) ? TEST_SUCCESS : TEST_FAILED;
+exit:
+	for (type = 0; type != GRO_TEST_NUM; type++)
+		for (n = 0; n != BURST_SIZE; n++)
+			rte_pktmbuf_free(pkts[type][n]);
+	n = rte_gro_timeout_flush(ctx, 0, GRO_TEST_ALL_TYPES, out,
+		RTE_DIM(out));
+	pkts_free(out, n);
+	rte_gro_ctx_destroy(ctx);
+	return ret;
+}
+
+/*
+ * insert one segment of the flows [first_flow, first_flow + nb_flows)
+ * into a GRO context, one burst at a time.
+ */
+static int
+ctx_insert_flows(void *ctx, enum gro_test_type type, uint32_t first_flow,
+	uint32_t nb_flows, uint32_t seg)
+{
+	struct rte_mbuf *pkts[BURST_SIZE];
+	uint32_t f, n;
+
+	for (f = 0; f < nb_flows; f += n) {
+		for (n = 0; n != BURST_SIZE && f + n < nb_flows; n++) {
+			pkts[n] = pkt_build(type, first_flow + f + n,
+				seg * SEG_LEN,
+				type == GRO_TEST_UDP4 ? 0 : seg,
+				0, TCP_ACK_FLAG);
+			if (pkts[n] == NULL) {
+				pkts_free(pkts, n);
+				return -1;
+			}
+		}
+		if (rte_gro_reassemble(pkts, n, ctx) != 0) {
+			pkts_free(pkts, n);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+#define TIMEOUT_TEST_FLOWS	64
+
+/*
+ * check that a timeout flush only returns the expired packets, from
+ * the oldest one, and that the flows left in the tables can still be
+ * merged.
+ */
+static int
+test_gro_ctx_timeout(void)
+{
+	struct rte_gro_param param = {
+		.max_flow_num = 4 * TIMEOUT_TEST_FLOWS,
+		.max_item_per_flow = 2,
+		.socket_id = SOCKET_ID_ANY,
+	};
+	struct rte_mbuf *out[2 * TIMEOUT_TEST_FLOWS];
+	enum gro_test_type type;
+	uint64_t t_mid;
+	uint32_t i, flow;
+	void *ctx;
+	uint16_t n;
+	int ret;
+
+	for (type = 0; type != GRO_TEST_NUM; type++) {
+		param.gro_types = gro_test_types[type].gro_type;
+		ctx = rte_gro_ctx_create(&param);
+		TEST_ASSERT_NOT_NULL(ctx, "GRO context creation failed");
+
+		ret = ctx_insert_flows(ctx, type, 1, TIMEOUT_TEST_FLOWS, 0);
+		t_mid = rte_rdtsc();
+		rte_delay_us(100);
+		if (ret == 0)
+			ret = ctx_insert_flows(ctx, type,
+				TIMEOUT_TEST_FLOWS + 1, TIMEOUT_TEST_FLOWS, 0);
+
+		/* only the first flows are timeout */
+		n = 0;
+		if (ret == 0)
+			n = rte_gro_timeout_flush(ctx, rte_rdtsc() - t_mid,
+				param.gro_types, out, RTE_DIM(out));
+		if (n != TIMEOUT_TEST_FLOWS)
+			ret = -1;
+		for (i = 0; i != n && ret == 0; i++) {
+			flow = rte_be_to_cpu_32(rte_pktmbuf_mtod_offset(out[i],
+					struct ipv4_hdr *,
+					sizeof(struct ether_hdr))->src_addr);
+			/* flows are flushed in insertion order */
+			if ((type == GRO_TEST_TCP4 ||
+					type == GRO_TEST_UDP4) &&
+					(flow & 0xffffff) != i + 1)
+				ret = -1;
+		}
+		pkts_free(out, n);
+
+		/* the other flows are still merged */
+		if (ret == 0)
+			ret = ctx_insert_flows(ctx, type,
+				TIMEOUT_TEST_FLOWS + 1, TIMEOUT_TEST_FLOWS, 1);
+		if (ret == 0 && rte_gro_get_pkt_count(ctx) !=
+				TIMEOUT_TEST_FLOWS)
+			ret = -1;
+
+		n = rte_gro_timeout_flush(ctx, 0, param.gro_types, out,
+			RTE_DIM(out));
+		if (ret == 0)
+			ret = pkts_check(type, out, n, TIMEOUT_TEST_FLOWS,
+				2 * SEG_LEN);
+		pkts_free(out, n);
+		rte_gro_ctx_destroy(ctx);
+
+		TEST_ASSERT_SUCCESS(ret, "%s: invalid timeout flush",
+			gro_test_types[type].name);
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gro_setup(void)
+{
+	if (pkt_pool == NULL) {
+		pkt_pool = rte_pktmbuf_pool_create("GRO_MBUF_POOL",
+			NB_MBUF, MBUF_CACHE, 0, MBUF_DATA_SIZE,
+			SOCKET_ID_ANY);
+		if (pkt_pool == NULL) {
+			printf("Error creating mempool\n");
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static struct unit_test_suite gro_test_suite  = {
+	.setup = test_gro_setup,
+	.suite_name = "GRO Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_gro_burst),
+		TEST_CASE(test_gro_no_merge),
+		TEST_CASE(test_gro_ctx),
+		TEST_CASE(test_gro_ctx_timeout),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_gro(void)
+{
+	return unit_test_suite_runner(&gro_test_suite);
+}
+
+/*
+ * Merge ratio and cycles per packet of each GRO type, in lightweight
+ * mode and in heavyweight mode with a flush after each burst, for a
+ * varying number of flows per burst.
+ */
+static int
+test_gro_perf_type(enum gro_test_type type, uint32_t nb_flows, int use_ctx)
+{
+	struct rte_gro_param param = {
+		.gro_types = gro_test_types[type].gro_type,
+		.max_flow_num = BURST_SIZE,
+		.max_item_per_flow = BURST_SIZE,
+		.socket_id = SOCKET_ID_ANY,
+	};
+	struct rte_mbuf *pkts[BURST_SIZE];
+	uint64_t start, cycles = 0, nb_out = 0;
+	uint32_t round;
+	void *ctx = NULL;
+	uint16_t n;
+
+	if (use_ctx) {
+		ctx = rte_gro_ctx_create(&param);
+		if (ctx == NULL) {
+			printf("GRO context creation failed\n");
+			return -1;
+		}
+	}
+
+	for (round = 0; round != PERF_ROUNDS; round++) {
+		if (burst_build(type, pkts, nb_flows, BURST_SIZE / nb_flows,
+				0) != 0) {
+			printf("mbuf allocation failed\n");
+			rte_gro_ctx_destroy(ctx);
+			return -1;
+		}
+
+		start = rte_rdtsc();
+		if (use_ctx) {
+			n = rte_gro_reassemble(pkts, BURST_SIZE, ctx);
+			n += rte_gro_timeout_flush(ctx, 0, param.gro_types,
+				&pkts[n], BURST_SIZE - n);
+		} else
+			n = rte_gro_reassemble_burst(pkts, BURST_SIZE, &param);
+		cycles += rte_rdtsc() - start;
+
+		nb_out += n;
+		pkts_free(pkts, n);
+	}
+
+	rte_gro_ctx_destroy(ctx);
+
+	printf("%-20s %-12s %5u flows: merge ratio %5.2f, "
+		"%6.1f cycles/packet\n",
+		gro_test_types[type].name, use_ctx ? "heavyweight" :
+		"lightweight", nb_flows,
+		(double)PERF_ROUNDS * BURST_SIZE / nb_out,
+		(double)cycles / (PERF_ROUNDS * BURST_SIZE));
+	return 0;
+}
+
+#define SCALE_PASSES	4
+
+/*
+ * Heavyweight mode with many concurrent flows: each pass inserts two
+ * segments of every flow, then flushes the tables. Report the cycles
+ * per reassembled packet, per flushed packet, and of a flush which
+ * finds no timeout packet in the full tables.
+ */
+static int
+test_gro_perf_scale(enum gro_test_type type, uint32_t nb_flows)
+{
+	struct rte_gro_param param = {
+		.gro_types = gro_test_types[type].gro_type,
+		.max_flow_num = nb_flows,
+		.max_item_per_flow = 2,
+		.socket_id = SOCKET_ID_ANY,
+	};
+	struct rte_mbuf *pkts[BURST_SIZE];
+	uint64_t start, gro_cycles = 0, flush_cycles = 0, idle_cycles = 0;
+	uint64_t nb_flushed = 0;
+	uint32_t pass, seg, f, n;
+	uint16_t nb_out;
+	void *ctx;
+	int ret = 0;
+
+	ctx = rte_gro_ctx_create(&param);
+	if (ctx == NULL) {
+		printf("GRO context creation failed\n");
+		return -1;
+	}
+
+	for (pass = 0; pass != SCALE_PASSES && ret == 0; pass++) {
+		for (seg = 0; seg != 2 && ret == 0; seg++) {
+			for (f = 0; f < nb_flows; f += n) {
+				for (n = 0; n != BURST_SIZE &&
+						f + n < nb_flows; n++) {
+					pkts[n] = pkt_build(type, f + n + 1,
+						seg * SEG_LEN,
+						type == GRO_TEST_UDP4 ?
+						pass : seg, 0, TCP_ACK_FLAG);
+					if (pkts[n] == NULL)
+						break;
+				}
+
+				start = rte_rdtsc();
+				nb_out = rte_gro_reassemble(pkts, n, ctx);
+				gro_cycles += rte_rdtsc() - start;
+
+				pkts_free(pkts, nb_out);
+				if (n != BURST_SIZE && f + n < nb_flows) {
+					printf("mbuf allocation failed\n");
+					ret = -1;
+					break;
+				}
+			}
+		}
+
+		/* nothing is timeout yet */
+		start = rte_rdtsc();
+		nb_out = rte_gro_timeout_flush(ctx, rte_get_tsc_hz(),
+			param.gro_types, pkts, BURST_SIZE);
+		idle_cycles += rte_rdtsc() - start;
+		pkts_free(pkts, nb_out);
+
+		do {
+			start = rte_rdtsc();
+			nb_out = rte_gro_timeout_flush(ctx, 0,
+				param.gro_types, pkts, BURST_SIZE);
+			flush_cycles += rte_rdtsc() - start;
+			nb_flushed += nb_out;
+			pkts_free(pkts, nb_out);
+		} while (nb_out != 0);
+	}
+
+	rte_gro_ctx_destroy(ctx);
+	if (ret != 0)
+		return ret;
+
+	printf("%-20s %5u flows: %8.1f cycles/packet, "
+		"flush %7.1f cycles/packet, idle flush %9.1f cycles\n",
+		gro_test_types[type].name, nb_flows,
+		(double)gro_cycles / (SCALE_PASSES * 2 * nb_flows),
+		(double)flush_cycles / nb_flushed,
+		(double)idle_cycles / SCALE_PASSES);
+	return 0;
+}
+
+static int
+test_gro_perf(void)
+{
+	static const uint32_t nb_flows[] = {1, 4, 16, BURST_SIZE};
+	static const uint32_t scale_flows[] = {64, 1024, 16384};
+	enum gro_test_type type;
+	uint32_t i;
+	int use_ctx;
+
+	if (test_gro_setup() != 0)
+		return -1;
+
+	for (type = 0; type != GRO_TEST_NUM; type++)
+		for (use_ctx = 0; use_ctx != 2; use_ctx++)
+			for (i = 0; i != RTE_DIM(nb_flows); i++)
+				if (test_gro_perf_type(type, nb_flows[i],
+						use_ctx) != 0)
+					return -1;
+
+	for (type = 0; type != GRO_TEST_NUM; type++)
+		for (i = 0; i != RTE_DIM(scale_flows); i++)
+			if (test_gro_perf_scale(type, scale_flows[i]) != 0)
+				return -1;
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(gro_autotest, test_gro);
+REGISTER_TEST_COMMAND(gro_perf_autotest, test_gro_perf);
@@ -0,0 +1,741 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_mbuf.h>
+#include <rte_ether.h>
+#include <rte_ethdev.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_gre.h>
+#include <rte_gso.h>
+
+#include "test.h"
+
+#define NB_MBUF		1023
+#define MBUF_CACHE	32
+#define PAYLOAD_LEN	8000
+/* input packets are chains of at least PKT_MIN_BUFS mbufs */
+#define PKT_MIN_BUFS	3
+#define PKT_DATA_SIZE	(RTE_PKTMBUF_HEADROOM + 3072)
+#define HDR_DATA_SIZE	(RTE_PKTMBUF_HEADROOM + 128)
+#define MAX_SEGS	128
+#define TCP_ISN		1000
+#define IP_ID		100
+#define VXLAN_PORT	4789
+#define GRE_PROTO_IPV4	0x0800
+#define TCP_PSH_FLAG	0x08
+
+#define PERF_ROUNDS	1024
+
+enum gso_test_type {
+	GSO_TEST_TCP4,
+	GSO_TEST_TCP6,
+	GSO_TEST_UDP4,
+	GSO_TEST_VXLAN,
+	GSO_TEST_GRE,
+	GSO_TEST_NUM,
+};
+
+static const struct {
+	const char *name;
+	uint32_t gso_type;
+	uint64_t ol_flags;
+	/* length of the headers copied into each segment */
+	uint32_t hdr_len;
+} gso_test_types[GSO_TEST_NUM] = {
+	[GSO_TEST_TCP4] = {"TCP/IPv4", DEV_TX_OFFLOAD_TCP_TSO,
+		PKT_TX_IPV4 | PKT_TX_TCP_SEG,
+		sizeof(struct ether_hdr) + sizeof(struct ipv4_hdr) +
+		sizeof(struct tcp_hdr)},
+	[GSO_TEST_TCP6] = {"TCP/IPv6", DEV_TX_OFFLOAD_TCP_TSO,
+		PKT_TX_IPV6 | PKT_TX_TCP_SEG,
+		sizeof(struct ether_hdr) + sizeof(struct ipv6_hdr) +
+		sizeof(struct tcp_hdr)},
+	[GSO_TEST_UDP4] = {"UDP/IPv4", DEV_TX_OFFLOAD_UDP_TSO,
+		PKT_TX_IPV4 | PKT_TX_UDP_SEG,
+		sizeof(struct ether_hdr) + sizeof(struct ipv4_hdr)},
+	[GSO_TEST_VXLAN] = {"VXLAN TCP/IPv4", DEV_TX_OFFLOAD_VXLAN_TNL_TSO,
+		PKT_TX_OUTER_IPV4 | PKT_TX_TUNNEL_VXLAN | PKT_TX_IPV4 |
+		PKT_TX_TCP_SEG,
+		2 * sizeof(struct ether_hdr) + 2 * sizeof(struct ipv4_hdr) +
+		ETHER_VXLAN_HLEN + sizeof(struct tcp_hdr)},
+	[GSO_TEST_GRE] = {"GRE TCP/IPv4", DEV_TX_OFFLOAD_GRE_TNL_TSO,
+		PKT_TX_OUTER_IPV4 | PKT_TX_TUNNEL_GRE | PKT_TX_IPV4 |
+		PKT_TX_TCP_SEG,
+		sizeof(struct ether_hdr) + 2 * sizeof(struct ipv4_hdr) +
+		sizeof(struct gre_hdr) + sizeof(struct tcp_hdr)},
+};
+
+static struct rte_mempool *pkt_pool;
+static struct rte_mempool *direct_pool;
+static struct rte_mempool *indirect_pool;
+
+/* UDP header of the datagrams, carried by their first fragment */
+static const struct udp_hdr udp_test_hdr = {
+	.src_port = RTE_BE16(1000),
+	.dst_port = RTE_BE16(2000),
+	.dgram_len = RTE_BE16(sizeof(struct udp_hdr) + PAYLOAD_LEN),
+};
+
+static uint8_t
+payload_byte(uint32_t ofs)
+{
+	return (uint8_t)(ofs * 7 + 3);
+}
+
+/* length of the data following the copied headers in the input packet */
+static uint32_t
+stream_len(enum gso_test_type type)
+{
+	if (type == GSO_TEST_UDP4)
+		return sizeof(struct udp_hdr) + PAYLOAD_LEN;
+	return PAYLOAD_LEN;
+}
+
+static uint8_t
+stream_byte(enum gso_test_type type, uint32_t ofs)
+{
+	if (type != GSO_TEST_UDP4)
+		return payload_byte(ofs);
+	if (ofs < sizeof(struct udp_hdr))
+		return ((const uint8_t *)&udp_test_hdr)[ofs];
+	return payload_byte(ofs - sizeof(struct udp_hdr));
+}
+
+/* append *len* zeroed bytes to *m*, NULL if the mbuf is full. */
+static void *
+pkt_put(struct rte_mbuf *m, uint16_t len)
+{
+	void *p = rte_pktmbuf_append(m, len);
+
+	if (p != NULL)
+		memset(p, 0, len);
+	return p;
+}
+
+static int
+eth_put(struct rte_mbuf *m, uint16_t ether_type)
+{
+	struct ether_hdr *eth = pkt_put(m, sizeof(*eth));
+
+	if (eth == NULL)
+		return -1;
+	eth->s_addr.addr_bytes[5] = 1;
+	eth->d_addr.addr_bytes[5] = 2;
+	eth->ether_type = rte_cpu_to_be_16(ether_type);
+	return 0;
+}
+
+static int
+ipv4_put(struct rte_mbuf *m, uint8_t proto, uint16_t total_len)
+{
+	struct ipv4_hdr *ip = pkt_put(m, sizeof(*ip));
+
+	if (ip == NULL)
+		return -1;
+	ip->version_ihl = 0x45;
+	ip->time_to_live = 64;
+	ip->next_proto_id = proto;
+	ip->total_length = rte_cpu_to_be_16(total_len);
+	ip->packet_id = rte_cpu_to_be_16(IP_ID);
+	ip->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1));
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(10, 0, 1, 1));
+	return 0;
+}
+
+static int
+ipv6_put(struct rte_mbuf *m, uint16_t payload_len)
+{
+	struct ipv6_hdr *ip6 = pkt_put(m, sizeof(*ip6));
+
+	if (ip6 == NULL)
+		return -1;
+	ip6->vtc_flow = rte_cpu_to_be_32(6 << 28);
+	ip6->payload_len = rte_cpu_to_be_16(payload_len);
+	ip6->proto = IPPROTO_TCP;
+	ip6->hop_limits = 64;
+	ip6->src_addr[15] = 1;
+	ip6->dst_addr[15] = 2;
+	return 0;
+}
+
+static int
+udp_put(struct rte_mbuf *m, const struct udp_hdr *hdr)
+{
+	struct udp_hdr *udp = pkt_put(m, sizeof(*udp));
+
+	if (udp == NULL)
+		return -1;
+	*udp = *hdr;
+	return 0;
+}
+
+static int
+vxlan_put(struct rte_mbuf *m)
+{
+	struct vxlan_hdr *vxlan = pkt_put(m, sizeof(*vxlan));
+
+	if (vxlan == NULL)
+		return -1;
+	vxlan->vx_flags = rte_cpu_to_be_32(0x08000000);
+	vxlan->vx_vni = rte_cpu_to_be_32(100 << 8);
+	return 0;
+}
+
+static int
+gre_put(struct rte_mbuf *m)
+{
+	struct gre_hdr *gre = pkt_put(m, sizeof(*gre));
+
+	if (gre == NULL)
+		return -1;
+	gre->proto = rte_cpu_to_be_16(GRE_PROTO_IPV4);
+	return 0;
+}
+
+static int
+tcp_put(struct rte_mbuf *m)
+{
+	struct tcp_hdr *tcp = pkt_put(m, sizeof(*tcp));
+
+	if (tcp == NULL)
+		return -1;
+	tcp->src_port = rte_cpu_to_be_16(1000);
+	tcp->dst_port = rte_cpu_to_be_16(80);
+	tcp->sent_seq = rte_cpu_to_be_32(TCP_ISN);
+	tcp->recv_ack = rte_cpu_to_be_32(1);
+	tcp->data_off = (sizeof(*tcp) / 4) << 4;
+	tcp->tcp_flags = TCP_ACK_FLAG | TCP_PSH_FLAG;
+	return 0;
+}
+
+/*
+ * build a packet of type *type* with PAYLOAD_LEN bytes of payload,
+ * spread over *nb_bufs* mbufs.
+ */
+static struct rte_mbuf *
+pkt_build(enum gso_test_type type, uint32_t nb_bufs)
+{
+	struct rte_mbuf *m, *seg;
+	struct udp_hdr udp;
+	uint16_t tcp_len = sizeof(struct tcp_hdr) + PAYLOAD_LEN;
+	uint16_t inner_len = sizeof(struct ipv4_hdr) + tcp_len;
+	uint8_t *p;
+	uint32_t i, j, ofs, len;
+	int ret;
+
+	m = rte_pktmbuf_alloc(pkt_pool);
+	if (m == NULL)
+		return NULL;
+
+	switch (type) {
+	case GSO_TEST_TCP4:
+		ret = eth_put(m, ETHER_TYPE_IPv4);
+		ret |= ipv4_put(m, IPPROTO_TCP, inner_len);
+		ret |= tcp_put(m);
+		m->l2_len = sizeof(struct ether_hdr);
+		m->l3_len = sizeof(struct ipv4_hdr);
+		m->l4_len = sizeof(struct tcp_hdr);
+		break;
+	case GSO_TEST_TCP6:
+		ret = eth_put(m, ETHER_TYPE_IPv6);
+		ret |= ipv6_put(m, tcp_len);
+		ret |= tcp_put(m);
+		m->l2_len = sizeof(struct ether_hdr);
+		m->l3_len = sizeof(struct ipv6_hdr);
+		m->l4_len = sizeof(struct tcp_hdr);
+		break;
+	case GSO_TEST_UDP4:
+		ret = eth_put(m, ETHER_TYPE_IPv4);
+		ret |= ipv4_put(m, IPPROTO_UDP, sizeof(struct ipv4_hdr) +
+			sizeof(struct udp_hdr) + PAYLOAD_LEN);
+		ret |= udp_put(m, &udp_test_hdr);
+		m->l2_len = sizeof(struct ether_hdr);
+		m->l3_len = sizeof(struct ipv4_hdr);
+		m->l4_len = sizeof(struct udp_hdr);
+		break;
+	case GSO_TEST_VXLAN:
+		memset(&udp, 0, sizeof(udp));
+		udp.src_port = rte_cpu_to_be_16(5000);
+		udp.dst_port = rte_cpu_to_be_16(VXLAN_PORT);
+		udp.dgram_len = rte_cpu_to_be_16(ETHER_VXLAN_HLEN +
+			sizeof(struct ether_hdr) + inner_len);
+		ret = eth_put(m, ETHER_TYPE_IPv4);
+		ret |= ipv4_put(m, IPPROTO_UDP, sizeof(struct ipv4_hdr) +
+			ETHER_VXLAN_HLEN + sizeof(struct ether_hdr) +
+			inner_len);
+		ret |= udp_put(m, &udp);
+		ret |= vxlan_put(m);
+		ret |= eth_put(m, ETHER_TYPE_IPv4);
+		ret |= ipv4_put(m, IPPROTO_TCP, inner_len);
+		ret |= tcp_put(m);
+		m->outer_l2_len = sizeof(struct ether_hdr);
+		m->outer_l3_len = sizeof(struct ipv4_hdr);
+		m->l2_len = ETHER_VXLAN_HLEN + sizeof(struct ether_hdr);
+		m->l3_len = sizeof(struct ipv4_hdr);
+		m->l4_len = sizeof(struct tcp_hdr);
+		break;
+	case GSO_TEST_GRE:
+	default:
+		ret = eth_put(m, ETHER_TYPE_IPv4);
+		ret |= ipv4_put(m, IPPROTO_GRE, sizeof(struct ipv4_hdr) +
+			sizeof(struct gre_hdr) + inner_len);
+		ret |= gre_put(m);
+		ret |= ipv4_put(m, IPPROTO_TCP, inner_len);
+		ret |= tcp_put(m);
+		m->outer_l2_len = sizeof(struct ether_hdr);
+		m->outer_l3_len = sizeof(struct ipv4_hdr);
+		m->l2_len = sizeof(struct gre_hdr);
+		m->l3_len = sizeof(struct ipv4_hdr);
+		m->l4_len = sizeof(struct tcp_hdr);
+		break;
+	}
+	if (ret != 0) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	m->ol_flags = gso_test_types[type].ol_flags;
+
+	/* the payload, split evenly over the mbufs */
+	seg = m;
+	for (i = 0, ofs = 0; i != nb_bufs; i++) {
+		len = (i == nb_bufs - 1) ? PAYLOAD_LEN - ofs :
+			PAYLOAD_LEN / nb_bufs;
+		if (i != 0) {
+			seg = rte_pktmbuf_alloc(pkt_pool);
+			if (seg == NULL || rte_pktmbuf_chain(m, seg) != 0) {
+				rte_pktmbuf_free(seg);
+				rte_pktmbuf_free(m);
+				return NULL;
+			}
+		}
+		p = (uint8_t *)rte_pktmbuf_append(m, len);
+		if (p == NULL) {
+			rte_pktmbuf_free(m);
+			return NULL;
+		}
+		for (j = 0; j != len; j++)
+			p[j] = payload_byte(ofs + j);
+		ofs += len;
+	}
+
+	return m;
+}
+
+static void
+pkts_free(struct rte_mbuf **pkts, uint32_t n)
+{
+	uint32_t i;
+
+	for (i = 0; i != n; i++)
+		rte_pktmbuf_free(pkts[i]);
+}
+
+static int
+tcp_check(const struct tcp_hdr *tcp, uint32_t ofs, int last)
+{
+	if (rte_be_to_cpu_32(tcp->sent_seq) != TCP_ISN + ofs)
+		return -1;
+	/* only the last segment keeps the PSH flag */
+	if (!!(tcp->tcp_flags & TCP_PSH_FLAG) != last)
+		return -1;
+	return 0;
+}
+
+static int
+ipv4_check(const struct ipv4_hdr *ip, uint32_t len, uint16_t ip_id)
+{
+	if (rte_be_to_cpu_16(ip->total_length) != len ||
+			rte_be_to_cpu_16(ip->packet_id) != ip_id)
+		return -1;
+	return 0;
+}
+
+/*
+ * check the headers and the data of the GSO segment *idx* of *nb*,
+ * which starts at offset *ofs* of the data following the copied
+ * headers. Return the length of its data, or -1 on error.
+ */
+static int
+seg_check(enum gso_test_type type, struct rte_mbuf *m, uint16_t gso_size,
+	uint32_t idx, uint32_t nb, uint32_t ofs)
+{
+	uint32_t hdr_len = gso_test_types[type].hdr_len;
+	uint8_t buf[UINT16_MAX];
+	const struct ipv6_hdr *ip6;
+	const struct udp_hdr *udp;
+	const uint8_t *p, *l3;
+	uint32_t len, l4, i;
+	uint16_t fo;
+	int last = (idx == nb - 1);
+
+	if (m->pkt_len > gso_size || m->pkt_len <= hdr_len ||
+			(m->ol_flags & (PKT_TX_TCP_SEG | PKT_TX_UDP_SEG)))
+		return -1;
+	p = rte_pktmbuf_read(m, 0, m->pkt_len, buf);
+	if (p == NULL)
+		return -1;
+	len = m->pkt_len - hdr_len;
+	l3 = p + sizeof(struct ether_hdr);
+
+	switch (type) {
+	case GSO_TEST_TCP4:
+		if (ipv4_check((const struct ipv4_hdr *)l3,
+				m->pkt_len - sizeof(struct ether_hdr),
+				IP_ID + idx) != 0 ||
+				tcp_check((const struct tcp_hdr *)(l3 +
+				sizeof(struct ipv4_hdr)), ofs, last) != 0)
+			return -1;
+		break;
+	case GSO_TEST_TCP6:
+		ip6 = (const struct ipv6_hdr *)l3;
+		if (rte_be_to_cpu_16(ip6->payload_len) != m->pkt_len -
+				sizeof(struct ether_hdr) - sizeof(*ip6) ||
+				tcp_check((const struct tcp_hdr *)(ip6 + 1),
+				ofs, last) != 0)
+			return -1;
+		break;
+	case GSO_TEST_UDP4:
+		/* all the fragments keep the ID of the datagram */
+		if (ipv4_check((const struct ipv4_hdr *)l3,
+				m->pkt_len - sizeof(struct ether_hdr),
+				IP_ID) != 0)
+			return -1;
+		fo = rte_be_to_cpu_16(
+			((const struct ipv4_hdr *)l3)->fragment_offset);
+		if ((fo & IPV4_HDR_OFFSET_MASK) * IPV4_HDR_OFFSET_UNITS !=
+				ofs || !!(fo & IPV4_HDR_MF_FLAG) == last ||
+				(!last && len % IPV4_HDR_OFFSET_UNITS != 0))
+			return -1;
+		break;
+	case GSO_TEST_VXLAN:
+		udp = (const struct udp_hdr *)(l3 + sizeof(struct ipv4_hdr));
+		l4 = sizeof(struct ether_hdr) + sizeof(struct ipv4_hdr);
+		if (ipv4_check((const struct ipv4_hdr *)l3,
+				m->pkt_len - sizeof(struct ether_hdr),
+				IP_ID + idx) != 0 ||
+				rte_be_to_cpu_16(udp->dgram_len) !=
+				m->pkt_len - l4)
+			return -1;
+		l4 += ETHER_VXLAN_HLEN + sizeof(struct ether_hdr);
+		if (ipv4_check((const struct ipv4_hdr *)(p + l4),
+				m->pkt_len - l4, IP_ID + idx) != 0 ||
+				tcp_check((const struct tcp_hdr *)(p + l4 +
+				sizeof(struct ipv4_hdr)), ofs, last) != 0)
+			return -1;
+		break;
+	case GSO_TEST_GRE:
+	default:
+		l4 = sizeof(struct ether_hdr) + sizeof(struct ipv4_hdr) +
+			sizeof(struct gre_hdr);
+		if (ipv4_check((const struct ipv4_hdr *)l3,
+				m->pkt_len - sizeof(struct ether_hdr),
+				IP_ID + idx) != 0 ||
+				ipv4_check((const struct ipv4_hdr *)(p + l4),
+				m->pkt_len - l4, IP_ID + idx) != 0 ||
+				tcp_check((const struct tcp_hdr *)(p + l4 +
+				sizeof(struct ipv4_hdr)), ofs, last) != 0)
+			return -1;
+		break;
+	}
+
+	for (i = 0; i != len; i++)
+		if (p[hdr_len + i] != stream_byte(type, ofs + i))
+			return -1;
+
+	return len;
+}
+
+static void
+gso_ctx_init(struct rte_gso_ctx *ctx, enum gso_test_type type,
+	uint16_t gso_size)
+{
+	ctx->direct_pool = direct_pool;
+	ctx->indirect_pool = indirect_pool;
+	ctx->flag = 0;
+	ctx->gso_types = gso_test_types[type].gso_type;
+	ctx->gso_size = gso_size;
+}
+
+static uint32_t
+pools_avail(void)
+{
+	return rte_mempool_avail_count(pkt_pool) +
+		rte_mempool_avail_count(direct_pool) +
+		rte_mempool_avail_count(indirect_pool);
+}
+
+static int
+test_gso_segment_type(enum gso_test_type type, uint16_t gso_size,
+	uint32_t nb_bufs)
+{
+	struct rte_mbuf *pkts[MAX_SEGS];
+	struct rte_gso_ctx ctx;
+	struct rte_mbuf *m;
+	uint32_t avail, unit, nb_expected, ofs, i;
+	int ret, len;
+
+	avail = pools_avail();
+	gso_ctx_init(&ctx, type, gso_size);
+	unit = gso_size - gso_test_types[type].hdr_len;
+	if (type == GSO_TEST_UDP4)
+		unit = RTE_ALIGN_FLOOR(unit, IPV4_HDR_OFFSET_UNITS);
+	nb_expected = (stream_len(type) + unit - 1) / unit;
+
+	m = pkt_build(type, nb_bufs);
+	TEST_ASSERT_NOT_NULL(m, "mbuf allocation failed");
+
+	ret = rte_gso_segment(m, &ctx, pkts, RTE_DIM(pkts));
+	if (ret != (int)nb_expected) {
+		printf("%s, gso_size %u, %u mbufs: %d segments instead "
+			"of %u\n", gso_test_types[type].name, gso_size,
+			nb_bufs, ret, nb_expected);
+		if (ret > 0)
+			pkts_free(pkts, ret);
+		else
+			rte_pktmbuf_free(m);
+		return TEST_FAILED;
+	}
+
+	for (i = 0, ofs = 0; i != nb_expected; i++, ofs += len) {
+		len = seg_check(type, pkts[i], gso_size, i, nb_expected, ofs);
+		if (len < 0) {
+			printf("%s, gso_size %u, %u mbufs: segment %u is "
+				"invalid\n", gso_test_types[type].name,
+				gso_size, nb_bufs, i);
+			pkts_free(pkts, nb_expected);
+			return TEST_FAILED;
+		}
+	}
+	pkts_free(pkts, nb_expected);
+
+	TEST_ASSERT_EQUAL(ofs, stream_len(type),
+		"%s: %u bytes of data instead of %u",
+		gso_test_types[type].name, ofs, stream_len(type));
+	/* freeing the segments frees the input packet */
+	TEST_ASSERT_EQUAL(pools_avail(), avail, "%s: mbuf leak",
+		gso_test_types[type].name);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gso_segment(void)
+{
+	static const uint16_t gso_sizes[] = {256, 1518};
+	enum gso_test_type type;
+	uint32_t i, nb_bufs;
+
+	for (type = 0; type != GSO_TEST_NUM; type++)
+		for (i = 0; i != RTE_DIM(gso_sizes); i++)
+			for (nb_bufs = PKT_MIN_BUFS; nb_bufs <= 8;
+					nb_bufs += 5)
+				if (test_gso_segment_type(type, gso_sizes[i],
+						nb_bufs) != TEST_SUCCESS)
+					return TEST_FAILED;
+
+	return TEST_SUCCESS;
+}
+
+/* packets which are returned as they are, or rejected */
+static int
+test_gso_no_segment(void)
+{
+	struct rte_mbuf *pkts[MAX_SEGS];
+	struct rte_gso_ctx ctx;
+	struct ipv4_hdr *ip;
+	struct rte_mbuf *m;
+	uint32_t avail;
+	int ret;
+
+	avail = pools_avail();
+
+	/* GSO is not required */
+	gso_ctx_init(&ctx, GSO_TEST_TCP4, UINT16_MAX);
+	m = pkt_build(GSO_TEST_TCP4, PKT_MIN_BUFS);
+	TEST_ASSERT_NOT_NULL(m, "mbuf allocation failed");
+	ret = rte_gso_segment(m, &ctx, pkts, RTE_DIM(pkts));
+	TEST_ASSERT(ret == 1 && pkts[0] == m &&
+		(m->ol_flags & PKT_TX_TCP_SEG) == 0,
+		"small packet is not returned as is");
+	rte_pktmbuf_free(m);
+
+	/* GSO type not enabled in the context */
+	gso_ctx_init(&ctx, GSO_TEST_TCP4, 1518);
+	m = pkt_build(GSO_TEST_UDP4, PKT_MIN_BUFS);
+	TEST_ASSERT_NOT_NULL(m, "mbuf allocation failed");
+	ret = rte_gso_segment(m, &ctx, pkts, RTE_DIM(pkts));
+	TEST_ASSERT(ret == 1 && pkts[0] == m &&
+		(m->ol_flags & PKT_TX_UDP_SEG) != 0,
+		"packet of a disabled GSO type is not returned as is");
+
+	/* IP fragments are not fragmented again */
+	gso_ctx_init(&ctx, GSO_TEST_UDP4, 1518);
+	ip = rte_pktmbuf_mtod_offset(m, struct ipv4_hdr *,
+		sizeof(struct ether_hdr));
+	ip->fragment_offset = rte_cpu_to_be_16(IPV4_HDR_MF_FLAG);
+	ret = rte_gso_segment(m, &ctx, pkts, RTE_DIM(pkts));
+	TEST_ASSERT(ret == 1 && pkts[0] == m,
+		"IP fragment is not returned as is");
+	rte_pktmbuf_free(m);
+
+	/* not enough room for the segments */
+	gso_ctx_init(&ctx, GSO_TEST_TCP6, 1518);
+	m = pkt_build(GSO_TEST_TCP6, PKT_MIN_BUFS);
+	TEST_ASSERT_NOT_NULL(m, "mbuf allocation failed");
+	ret = rte_gso_segment(m, &ctx, pkts, 2);
+	TEST_ASSERT(ret == -EINVAL && rte_mbuf_refcnt_read(m) == 1 &&
+		m->ol_flags == gso_test_types[GSO_TEST_TCP6].ol_flags,
+		"segmentation without room for the output did not fail");
+
+	/* segment size smaller than the headers */
+	gso_ctx_init(&ctx, GSO_TEST_TCP6, RTE_GSO_SEG_SIZE_MIN);
+	ret = rte_gso_segment(m, &ctx, pkts, RTE_DIM(pkts));
+	TEST_ASSERT(ret == -EINVAL &&
+		m->ol_flags == gso_test_types[GSO_TEST_TCP6].ol_flags,
+		"segmentation below the header size did not fail");
+	rte_pktmbuf_free(m);
+
+	TEST_ASSERT_EQUAL(pools_avail(), avail, "mbuf leak");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gso_setup(void)
+{
+	if (pkt_pool == NULL)
+		pkt_pool = rte_pktmbuf_pool_create("GSO_PKT_POOL", NB_MBUF,
+			MBUF_CACHE, 0, PKT_DATA_SIZE, SOCKET_ID_ANY);
+	if (direct_pool == NULL)
+		direct_pool = rte_pktmbuf_pool_create("GSO_DIRECT_POOL",
+			NB_MBUF, MBUF_CACHE, 0, HDR_DATA_SIZE, SOCKET_ID_ANY);
+	if (indirect_pool == NULL)
+		indirect_pool = rte_pktmbuf_pool_create("GSO_INDIRECT_POOL",
+			NB_MBUF, MBUF_CACHE, 0, 0, SOCKET_ID_ANY);
+	if (pkt_pool == NULL || direct_pool == NULL ||
+			indirect_pool == NULL) {
+		printf("Error creating mempools\n");
+		return -1;
+	}
+	return 0;
+}
+
+static struct unit_test_suite gso_test_suite  = {
+	.setup = test_gso_setup,
+	.suite_name = "GSO Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_gso_segment),
+		TEST_CASE(test_gso_no_segment),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_gso(void)
+{
+	return unit_test_suite_runner(&gso_test_suite);
+}
+
+/*
+ * Segments per second of each GSO type, for a PAYLOAD_LEN bytes input
+ * packet of PKT_MIN_BUFS mbufs and a varying segment size.
+ */
+static int
+test_gso_perf_type(enum gso_test_type type, uint16_t gso_size)
+{
+	struct rte_mbuf *pkts[MAX_SEGS];
+	struct rte_gso_ctx ctx;
+	struct rte_mbuf *m;
+	uint64_t start, cycles = 0, nb_segs = 0;
+	uint32_t round;
+	int ret;
+
+	gso_ctx_init(&ctx, type, gso_size);
+
+	for (round = 0; round != PERF_ROUNDS; round++) {
+		m = pkt_build(type, PKT_MIN_BUFS);
+		if (m == NULL) {
+			printf("mbuf allocation failed\n");
+			return -1;
+		}
+
+		start = rte_rdtsc();
+		ret = rte_gso_segment(m, &ctx, pkts, RTE_DIM(pkts));
+		cycles += rte_rdtsc() - start;
+
+		if (ret < 0) {
+			printf("%s: segmentation failed (%d)\n",
+				gso_test_types[type].name, ret);
+			rte_pktmbuf_free(m);
+			return -1;
+		}
+		nb_segs += ret;
+		pkts_free(pkts, ret);
+	}
+
+	printf("%-16s gso_size %5u: %3"PRIu64" segments/packet, "
+		"%6.1f cycles/segment, %7.2f Msegments/s\n",
+		gso_test_types[type].name, gso_size, nb_segs / PERF_ROUNDS,
+		(double)cycles / nb_segs,
+		(double)nb_segs * rte_get_tsc_hz() / cycles / 1e6);
+	return 0;
+}
+
+static int
+test_gso_perf(void)
+{
+	static const uint16_t gso_sizes[] = {256, 1518, 4096};
+	enum gso_test_type type;
+	uint32_t i;
+
+	if (test_gso_setup() != 0)
+		return -1;
+
+	for (type = 0; type != GSO_TEST_NUM; type++)
+		for (i = 0; i != RTE_DIM(gso_sizes); i++)
+			if (test_gso_perf_type(type, gso_sizes[i]) != 0)
+				return -1;
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(gso_autotest, test_gso);
+REGISTER_TEST_COMMAND(gso_perf_autotest, test_gso_perf);
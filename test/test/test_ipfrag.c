@@ -0,0 +1,381 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_mbuf.h>
+#include <rte_ip.h>
+#include <rte_ip_frag.h>
+
+#include "test.h"
+
+#define NB_MBUF		8191
+#define MBUF_CACHE	32
+
+#define NB_TABLES	4
+#define NB_DGRAMS	256
+#define NB_FRAGS	4
+#define FRAG_LEN	256
+#define LAST_FRAG_LEN	100
+#define DGRAM_LEN	((NB_FRAGS - 1) * FRAG_LEN + LAST_FRAG_LEN)
+
+#define TBL_BUCKETS	NB_DGRAMS
+#define TBL_ASSOC	8
+#define TBL_TTL		1000
+
+static struct rte_mempool *pkt_pool;
+
+static uint8_t
+frag_payload_byte(uint32_t dgram, uint32_t ofs)
+{
+	return (uint8_t)(dgram * 7 + ofs);
+}
+
+/* build one IPv4 fragment of datagram *dgram*, L2 header stripped. */
+static struct rte_mbuf *
+frag_build(uint32_t dgram, uint32_t frag)
+{
+	struct rte_mbuf *m;
+	struct ipv4_hdr *ip;
+	uint8_t *payload;
+	uint16_t ofs, len, fo;
+	uint32_t i;
+
+	m = rte_pktmbuf_alloc(pkt_pool);
+	if (m == NULL)
+		return NULL;
+
+	ofs = frag * FRAG_LEN;
+	len = (frag == NB_FRAGS - 1) ? LAST_FRAG_LEN : FRAG_LEN;
+
+	ip = (struct ipv4_hdr *)rte_pktmbuf_append(m, sizeof(*ip) + len);
+	if (ip == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	memset(ip, 0, sizeof(*ip));
+	ip->version_ihl = 0x45;
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->total_length = rte_cpu_to_be_16(sizeof(*ip) + len);
+	ip->packet_id = rte_cpu_to_be_16(dgram);
+	ip->src_addr = rte_cpu_to_be_32(IPv4(10, 0, dgram >> 8, dgram));
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(192, 168, 0, 1));
+
+	fo = ofs / IPV4_HDR_OFFSET_UNITS;
+	if (frag != NB_FRAGS - 1)
+		fo |= IPV4_HDR_MF_FLAG;
+	ip->fragment_offset = rte_cpu_to_be_16(fo);
+
+	payload = (uint8_t *)(ip + 1);
+	for (i = 0; i != len; i++)
+		payload[i] = frag_payload_byte(dgram, ofs + i);
+
+	m->l2_len = 0;
+	m->l3_len = sizeof(*ip);
+	return m;
+}
+
+/* check length and content of a reassembled datagram. */
+static int
+dgram_check(struct rte_mbuf *m)
+{
+	const struct ipv4_hdr *ip;
+	uint8_t buf[DGRAM_LEN];
+	const uint8_t *p;
+	uint32_t dgram, i;
+
+	ip = rte_pktmbuf_mtod(m, const struct ipv4_hdr *);
+	dgram = rte_be_to_cpu_16(ip->packet_id);
+
+	if (m->pkt_len != sizeof(*ip) + DGRAM_LEN ||
+			rte_be_to_cpu_16(ip->total_length) != m->pkt_len ||
+			rte_ipv4_frag_pkt_is_fragmented(ip))
+		return -1;
+
+	p = rte_pktmbuf_read(m, sizeof(*ip), DGRAM_LEN, buf);
+	if (p == NULL)
+		return -1;
+
+	for (i = 0; i != DGRAM_LEN; i++)
+		if (p[i] != frag_payload_byte(dgram, i))
+			return -1;
+
+	return 0;
+}
+
+static int
+test_ipfrag_hash(void)
+{
+	struct ipv6_hdr ip6[2];
+	struct ipv6_extension_fragment fh[2];
+	uint32_t d, f, h, h0;
+	uint32_t nb_per_table[NB_TABLES] = {0};
+
+	for (d = 0; d != NB_DGRAMS; d++) {
+		h0 = 0;
+		for (f = 0; f != NB_FRAGS; f++) {
+			struct rte_mbuf *m = frag_build(d, f);
+
+			TEST_ASSERT_NOT_NULL(m, "mbuf allocation failed");
+			h = rte_ipv4_frag_hash(
+				rte_pktmbuf_mtod(m, struct ipv4_hdr *));
+			rte_pktmbuf_free(m);
+
+			if (f == 0)
+				h0 = h;
+			TEST_ASSERT_EQUAL(h, h0,
+				"datagram %u: fragment %u hash mismatch", d, f);
+		}
+
+		h = rte_ip_frag_table_select(h0, NB_TABLES);
+		TEST_ASSERT(h < NB_TABLES, "invalid table index %u", h);
+		nb_per_table[h]++;
+	}
+
+	/* every table gets a share of the datagrams. */
+	for (h = 0; h != NB_TABLES; h++)
+		TEST_ASSERT(nb_per_table[h] != 0, "table %u not selected", h);
+
+	/* IPv6: hash ignores the offset, depends on the id. */
+	memset(ip6, 0, sizeof(ip6));
+	memset(fh, 0, sizeof(fh));
+	ip6[0].src_addr[15] = 1;
+	ip6[0].dst_addr[15] = 2;
+	ip6[1] = ip6[0];
+	fh[0].id = rte_cpu_to_be_32(1);
+	fh[1] = fh[0];
+	fh[1].frag_data = rte_cpu_to_be_16(RTE_IPV6_SET_FRAG_DATA(64, 1));
+
+	TEST_ASSERT_EQUAL(rte_ipv6_frag_hash(&ip6[0], &fh[0]),
+		rte_ipv6_frag_hash(&ip6[1], &fh[1]),
+		"IPv6 fragments hash mismatch");
+
+	fh[1].id = rte_cpu_to_be_32(2);
+	TEST_ASSERT_NOT_EQUAL(rte_ipv6_frag_hash(&ip6[0], &fh[0]),
+		rte_ipv6_frag_hash(&ip6[1], &fh[1]),
+		"IPv6 datagrams with different ids hash the same");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_ipfrag_steer_reassemble(void)
+{
+	static const uint32_t frag_order[NB_FRAGS] = {2, 0, 3, 1};
+	struct rte_ip_frag_tbl *tbl[NB_TABLES];
+	struct rte_ip_frag_death_row dr;
+	uint32_t d, f, t, nb_done;
+	int ret = TEST_FAILED;
+
+	memset(&dr, 0, sizeof(dr));
+	memset(tbl, 0, sizeof(tbl));
+	nb_done = 0;
+
+	for (t = 0; t != NB_TABLES; t++) {
+		tbl[t] = rte_ip_frag_table_create(TBL_BUCKETS, TBL_ASSOC,
+			NB_DGRAMS, TBL_TTL, SOCKET_ID_ANY);
+		if (tbl[t] == NULL) {
+			printf("Error creating fragmentation table %u\n", t);
+			goto exit;
+		}
+	}
+
+	/* all datagrams in flight: fragments arrive interleaved. */
+	for (f = 0; f != NB_FRAGS; f++) {
+		for (d = 0; d != NB_DGRAMS; d++) {
+			struct rte_mbuf *m;
+			struct ipv4_hdr *ip;
+
+			m = frag_build(d, frag_order[f]);
+			if (m == NULL) {
+				printf("mbuf allocation failed\n");
+				goto exit;
+			}
+
+			ip = rte_pktmbuf_mtod(m, struct ipv4_hdr *);
+			t = rte_ip_frag_table_select(rte_ipv4_frag_hash(ip),
+				NB_TABLES);
+
+			m = rte_ipv4_frag_reassemble_packet(tbl[t], &dr, m, 0,
+				ip);
+			if (m == NULL)
+				continue;
+
+			if (f != NB_FRAGS - 1 || dgram_check(m) != 0) {
+				printf("datagram %u: invalid reassembly\n", d);
+				rte_pktmbuf_free(m);
+				goto exit;
+			}
+			rte_pktmbuf_free(m);
+			nb_done++;
+		}
+	}
+
+	if (nb_done != NB_DGRAMS || dr.cnt != 0) {
+		printf("%u datagrams reassembled, %u mbufs dropped\n",
+			nb_done, dr.cnt);
+		goto exit;
+	}
+
+	for (t = 0; t != NB_TABLES; t++) {
+		if (tbl[t]->use_entries != 0) {
+			printf("table %u: %u entries left\n", t,
+				tbl[t]->use_entries);
+			goto exit;
+		}
+	}
+
+	ret = TEST_SUCCESS;
+exit:
+	rte_ip_frag_free_death_row(&dr, 0);
+	for (t = 0; t != NB_TABLES; t++)
+		if (tbl[t] != NULL)
+			rte_ip_frag_table_destroy(tbl[t]);
+	return ret;
+}
+
+static int
+test_ipfrag_del_expired(void)
+{
+	struct rte_ip_frag_tbl *tbl;
+	struct rte_ip_frag_death_row dr;
+	struct ip_frag_tbl_stat stat;
+	uint32_t d, n;
+	int ret = TEST_FAILED;
+
+	memset(&dr, 0, sizeof(dr));
+
+	tbl = rte_ip_frag_table_create(TBL_BUCKETS, TBL_ASSOC, NB_DGRAMS,
+		TBL_TTL, SOCKET_ID_ANY);
+	TEST_ASSERT_NOT_NULL(tbl, "Error creating fragmentation table");
+
+	/* one fragment per datagram, one datagram per time unit. */
+	for (d = 0; d != NB_DGRAMS / 4; d++) {
+		struct rte_mbuf *m = frag_build(d, 0);
+
+		if (m == NULL) {
+			printf("mbuf allocation failed\n");
+			goto exit;
+		}
+		m = rte_ipv4_frag_reassemble_packet(tbl, &dr, m, d,
+			rte_pktmbuf_mtod(m, struct ipv4_hdr *));
+		if (m != NULL) {
+			printf("unexpected reassembled datagram\n");
+			rte_pktmbuf_free(m);
+			goto exit;
+		}
+	}
+
+	if (tbl->use_entries != NB_DGRAMS / 4) {
+		printf("%u entries in use instead of %u\n",
+			tbl->use_entries, NB_DGRAMS / 4);
+		goto exit;
+	}
+
+	/* nothing expired yet. */
+	n = rte_ip_frag_table_del_expired_entries(tbl, &dr, TBL_TTL);
+	if (n != 0 || dr.cnt != 0) {
+		printf("%u entries deleted before their TTL\n", n);
+		goto exit;
+	}
+
+	/* first half expires. */
+	n = rte_ip_frag_table_del_expired_entries(tbl, &dr,
+		TBL_TTL + NB_DGRAMS / 8);
+	if (n != NB_DGRAMS / 8 || dr.cnt != n ||
+			tbl->use_entries != NB_DGRAMS / 8) {
+		printf("%u entries deleted, %u mbufs on death row, "
+			"%u entries left\n", n, dr.cnt, tbl->use_entries);
+		goto exit;
+	}
+	rte_ip_frag_free_death_row(&dr, 0);
+
+	/* second half expires. */
+	n = rte_ip_frag_table_del_expired_entries(tbl, &dr, UINT64_MAX);
+	if (n != NB_DGRAMS / 8 || tbl->use_entries != 0) {
+		printf("%u entries deleted, %u entries left\n",
+			n, tbl->use_entries);
+		goto exit;
+	}
+
+	if (rte_ip_frag_table_statistics_get(tbl, NULL) != -EINVAL ||
+			rte_ip_frag_table_statistics_get(NULL, &stat) !=
+				-EINVAL ||
+			rte_ip_frag_table_statistics_get(tbl, &stat) != 0) {
+		printf("rte_ip_frag_table_statistics_get failed\n");
+		goto exit;
+	}
+
+	ret = TEST_SUCCESS;
+exit:
+	rte_ip_frag_free_death_row(&dr, 0);
+	rte_ip_frag_table_destroy(tbl);
+	return ret;
+}
+
+static int
+test_ipfrag_setup(void)
+{
+	if (pkt_pool == NULL) {
+		pkt_pool = rte_pktmbuf_pool_create("IPFRAG_MBUF_POOL",
+			NB_MBUF, MBUF_CACHE, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+			SOCKET_ID_ANY);
+		if (pkt_pool == NULL) {
+			printf("Error creating mempool\n");
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static struct unit_test_suite ipfrag_test_suite  = {
+	.setup = test_ipfrag_setup,
+	.suite_name = "IP Fragmentation Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_ipfrag_hash),
+		TEST_CASE(test_ipfrag_steer_reassemble),
+		TEST_CASE(test_ipfrag_del_expired),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_ipfrag(void)
+{
+	return unit_test_suite_runner(&ipfrag_test_suite);
+}
+
+REGISTER_TEST_COMMAND(ipfrag_autotest, test_ipfrag);
@@ -0,0 +1,454 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_random.h>
+#include <rte_ring.h>
+#include <rte_ip.h>
+#include <rte_ip_frag.h>
+
+#include "test.h"
+
+/*
+ * Reassembly throughput under a fragment storm: the fragments of a large
+ * number of datagrams arrive in random order, so that all the datagrams are
+ * in flight at the same time. The storm is reassembled with one table, with
+ * several tables selected by fragment hash on a single lcore, and with one
+ * table per worker lcore, the fragments being steered to the workers
+ * through rings.
+ */
+
+#define NB_DGRAMS	4096
+#define NB_FRAGS	4
+#define NB_STORM	(NB_DGRAMS * NB_FRAGS)
+#define FRAG_LEN	64
+#define NB_ROUNDS	16
+#define BURST_SIZE	32
+
+#define MAX_TABLES	8
+#define NB_TABLES_SINGLE	4
+#define TBL_ASSOC	4
+
+#define NB_MBUF		(NB_STORM + MAX_TABLES * BURST_SIZE * 4)
+#define MBUF_CACHE	32
+#define RING_SIZE	(NB_STORM * 2)
+
+struct ipfrag_perf_worker {
+	struct rte_ring *ring;
+	struct rte_ip_frag_tbl *tbl;
+	uint32_t nb_done;
+	uint32_t nb_drop;
+} __rte_cache_aligned;
+
+static struct rte_mempool *pkt_pool;
+static struct rte_ip_frag_tbl *tbl[MAX_TABLES];
+static struct ipfrag_perf_worker workers[MAX_TABLES];
+static struct rte_mbuf *storm[NB_STORM];
+
+static int
+storm_build(uint32_t round)
+{
+	uint32_t d, f, i;
+
+	for (d = 0; d != NB_DGRAMS; d++) {
+		for (f = 0; f != NB_FRAGS; f++) {
+			struct rte_mbuf *m;
+			struct ipv4_hdr *ip;
+			uint16_t fo;
+
+			m = rte_pktmbuf_alloc(pkt_pool);
+			if (m == NULL)
+				return -1;
+
+			ip = (struct ipv4_hdr *)rte_pktmbuf_append(m,
+				sizeof(*ip) + FRAG_LEN);
+			memset(ip, 0, sizeof(*ip));
+			ip->version_ihl = 0x45;
+			ip->time_to_live = 64;
+			ip->next_proto_id = IPPROTO_UDP;
+			ip->total_length =
+				rte_cpu_to_be_16(sizeof(*ip) + FRAG_LEN);
+			ip->packet_id = rte_cpu_to_be_16(round);
+			ip->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 0) + d);
+			ip->dst_addr = rte_cpu_to_be_32(IPv4(192, 168, 0, 1));
+
+			fo = f * FRAG_LEN / IPV4_HDR_OFFSET_UNITS;
+			if (f != NB_FRAGS - 1)
+				fo |= IPV4_HDR_MF_FLAG;
+			ip->fragment_offset = rte_cpu_to_be_16(fo);
+
+			m->l2_len = 0;
+			m->l3_len = sizeof(*ip);
+			storm[d * NB_FRAGS + f] = m;
+		}
+	}
+
+	/* shuffle. */
+	for (i = NB_STORM - 1; i != 0; i--) {
+		struct rte_mbuf *m;
+		uint32_t j;
+
+		j = rte_rand() % (i + 1);
+		m = storm[i];
+		storm[i] = storm[j];
+		storm[j] = m;
+	}
+
+	return 0;
+}
+
+static uint32_t
+storm_reassemble(struct rte_ip_frag_tbl *t, struct rte_ip_frag_death_row *dr,
+	struct rte_mbuf **mb, uint32_t n, uint64_t tms)
+{
+	uint32_t i, nb_done;
+
+	nb_done = 0;
+	for (i = 0; i != n; i++) {
+		struct rte_mbuf *m;
+
+		m = rte_ipv4_frag_reassemble_packet(t, dr, mb[i], tms,
+			rte_pktmbuf_mtod(mb[i], struct ipv4_hdr *));
+		if (m != NULL) {
+			rte_pktmbuf_free(m);
+			nb_done++;
+		}
+	}
+
+	return nb_done;
+}
+
+/* reassemble the storm on the master lcore, *nb_tbl* tables. */
+static int
+ipfrag_perf_local(uint32_t nb_tbl, uint64_t *cycles)
+{
+	struct rte_ip_frag_death_row dr;
+	uint32_t round, i, nb_done, nb_drop;
+	uint64_t start;
+
+	memset(&dr, 0, sizeof(dr));
+	*cycles = 0;
+
+	for (round = 0; round != NB_ROUNDS; round++) {
+		if (storm_build(round) != 0) {
+			printf("mbuf allocation failed\n");
+			return -1;
+		}
+
+		nb_done = 0;
+		nb_drop = 0;
+		start = rte_rdtsc();
+
+		for (i = 0; i != NB_STORM; i++) {
+			struct ipv4_hdr *ip;
+			uint32_t t;
+
+			ip = rte_pktmbuf_mtod(storm[i], struct ipv4_hdr *);
+			t = (nb_tbl == 1) ? 0 : rte_ip_frag_table_select(
+				rte_ipv4_frag_hash(ip), nb_tbl);
+			nb_done += storm_reassemble(tbl[t], &dr, &storm[i], 1,
+				start);
+
+			if (dr.cnt != 0) {
+				nb_drop += dr.cnt;
+				rte_ip_frag_free_death_row(&dr, 0);
+			}
+		}
+
+		*cycles += rte_rdtsc() - start;
+
+		if (nb_done != NB_DGRAMS || nb_drop != 0) {
+			printf("round %u: %u datagrams reassembled, "
+				"%u fragments dropped\n",
+				round, nb_done, nb_drop);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+ipfrag_perf_worker_main(void *arg)
+{
+	struct ipfrag_perf_worker *w = arg;
+	struct rte_ip_frag_death_row dr;
+	struct rte_mbuf *mb[BURST_SIZE];
+	uint32_t i, n;
+	int done = 0;
+
+	memset(&dr, 0, sizeof(dr));
+
+	while (!done) {
+		n = rte_ring_sc_dequeue_burst(w->ring, (void **)mb,
+			BURST_SIZE, NULL);
+
+		/* a NULL mbuf marks the end of the storm. */
+		for (i = 0; i != n; i++) {
+			if (mb[i] == NULL) {
+				done = 1;
+				break;
+			}
+		}
+
+		w->nb_done += storm_reassemble(w->tbl, &dr, mb, i,
+			rte_rdtsc());
+
+		if (dr.cnt != 0) {
+			w->nb_drop += dr.cnt;
+			rte_ip_frag_free_death_row(&dr, 0);
+		}
+	}
+
+	return 0;
+}
+
+static void
+steer_flush(struct ipfrag_perf_worker *w, struct rte_mbuf **mb, uint32_t *n)
+{
+	uint32_t k;
+
+	for (k = 0; k != *n; )
+		k += rte_ring_sp_enqueue_burst(w->ring, (void **)&mb[k],
+			*n - k, NULL);
+	*n = 0;
+}
+
+/* steer the storm to *nb_workers* lcores, one table each. */
+static int
+ipfrag_perf_workers(uint32_t nb_workers, uint64_t *cycles)
+{
+	static struct rte_mbuf *pending[MAX_TABLES][BURST_SIZE];
+	uint32_t nb_pending[MAX_TABLES];
+	struct rte_mbuf *end = NULL;
+	uint32_t round, i, w, nb_done, nb_drop;
+	unsigned int lcore_id;
+	uint64_t start;
+
+	*cycles = 0;
+
+	for (round = 0; round != NB_ROUNDS; round++) {
+		if (storm_build(round) != 0) {
+			printf("mbuf allocation failed\n");
+			return -1;
+		}
+
+		for (w = 0; w != nb_workers; w++) {
+			workers[w].nb_done = 0;
+			workers[w].nb_drop = 0;
+			nb_pending[w] = 0;
+		}
+
+		start = rte_rdtsc();
+
+		w = 0;
+		RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+			if (w == nb_workers)
+				break;
+			rte_eal_remote_launch(ipfrag_perf_worker_main,
+				&workers[w++], lcore_id);
+		}
+
+		for (i = 0; i != NB_STORM; i++) {
+			struct ipv4_hdr *ip;
+
+			ip = rte_pktmbuf_mtod(storm[i], struct ipv4_hdr *);
+			w = rte_ip_frag_table_select(rte_ipv4_frag_hash(ip),
+				nb_workers);
+
+			pending[w][nb_pending[w]++] = storm[i];
+			if (nb_pending[w] == BURST_SIZE)
+				steer_flush(&workers[w], pending[w],
+					&nb_pending[w]);
+		}
+
+		for (w = 0; w != nb_workers; w++) {
+			steer_flush(&workers[w], pending[w], &nb_pending[w]);
+			while (rte_ring_sp_enqueue(workers[w].ring, end) != 0)
+				;
+		}
+
+		rte_eal_mp_wait_lcore();
+		*cycles += rte_rdtsc() - start;
+
+		nb_done = 0;
+		nb_drop = 0;
+		for (w = 0; w != nb_workers; w++) {
+			nb_done += workers[w].nb_done;
+			nb_drop += workers[w].nb_drop;
+		}
+
+		if (nb_done != NB_DGRAMS || nb_drop != 0) {
+			printf("round %u: %u datagrams reassembled, "
+				"%u fragments dropped\n",
+				round, nb_done, nb_drop);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static void
+ipfrag_perf_report(const char *name, uint32_t nb_tbl, uint64_t cycles)
+{
+	printf("%-32s %8.1f cycles/fragment\n", name,
+		(double)cycles / (NB_ROUNDS * NB_STORM));
+
+#ifdef RTE_LIBRTE_IP_FRAG_TBL_STAT
+	struct ip_frag_tbl_stat stat;
+	uint32_t t;
+
+	for (t = 0; t != nb_tbl; t++) {
+		rte_ip_frag_table_statistics_get(tbl[t], &stat);
+		printf("  table %u: find %" PRIu64 ", add %" PRIu64
+			", fail %" PRIu64 "\n",
+			t, stat.find_num, stat.add_num, stat.fail_total);
+	}
+#else
+	RTE_SET_USED(nb_tbl);
+#endif
+}
+
+static int
+ipfrag_perf_setup(uint32_t nb_tbl)
+{
+	uint64_t max_cycles = rte_get_tsc_hz();
+	uint32_t t;
+
+	for (t = 0; t != nb_tbl; t++) {
+		tbl[t] = rte_ip_frag_table_create(NB_DGRAMS, TBL_ASSOC,
+			NB_DGRAMS, max_cycles, SOCKET_ID_ANY);
+		if (tbl[t] == NULL) {
+			printf("Error creating fragmentation table %u\n", t);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static void
+ipfrag_perf_free(uint32_t nb_tbl)
+{
+	uint32_t t;
+
+	for (t = 0; t != nb_tbl; t++) {
+		rte_ip_frag_table_destroy(tbl[t]);
+		tbl[t] = NULL;
+	}
+}
+
+static int
+test_ipfrag_perf(void)
+{
+	uint32_t nb_workers, w;
+	uint64_t cycles;
+	int ret;
+
+	if (pkt_pool == NULL) {
+		pkt_pool = rte_pktmbuf_pool_create("IPFRAG_PERF_POOL",
+			NB_MBUF, MBUF_CACHE, 0,
+			RTE_PKTMBUF_HEADROOM + 2 * FRAG_LEN, SOCKET_ID_ANY);
+		if (pkt_pool == NULL) {
+			printf("Error creating mempool\n");
+			return -1;
+		}
+	}
+
+	printf("%u datagrams of %u fragments in flight, %u rounds\n",
+		NB_DGRAMS, NB_FRAGS, NB_ROUNDS);
+
+	/* one table. */
+	ret = ipfrag_perf_setup(1);
+	if (ret == 0)
+		ret = ipfrag_perf_local(1, &cycles);
+	if (ret == 0)
+		ipfrag_perf_report("single table", 1, cycles);
+	ipfrag_perf_free(1);
+	if (ret != 0)
+		return -1;
+
+	/* several tables, hash-selected on one lcore. */
+	ret = ipfrag_perf_setup(NB_TABLES_SINGLE);
+	if (ret == 0)
+		ret = ipfrag_perf_local(NB_TABLES_SINGLE, &cycles);
+	if (ret == 0)
+		ipfrag_perf_report("hash-selected tables, one lcore",
+			NB_TABLES_SINGLE, cycles);
+	ipfrag_perf_free(NB_TABLES_SINGLE);
+	if (ret != 0)
+		return -1;
+
+	/* one table per worker lcore. */
+	nb_workers = RTE_MIN(rte_lcore_count() - 1, (uint32_t)MAX_TABLES);
+	if (nb_workers == 0) {
+		printf("No worker lcore, skipping steered reassembly\n");
+		return 0;
+	}
+
+	ret = ipfrag_perf_setup(nb_workers);
+	for (w = 0; w != nb_workers && ret == 0; w++) {
+		char name[RTE_RING_NAMESIZE];
+
+		snprintf(name, sizeof(name), "IPFRAG_PERF_%u", w);
+		workers[w].tbl = tbl[w];
+		workers[w].ring = rte_ring_lookup(name);
+		if (workers[w].ring == NULL)
+			workers[w].ring = rte_ring_create(name, RING_SIZE,
+				SOCKET_ID_ANY,
+				RING_F_SP_ENQ | RING_F_SC_DEQ);
+		if (workers[w].ring == NULL) {
+			printf("Error creating ring %u\n", w);
+			ret = -1;
+		}
+	}
+	if (ret == 0)
+		ret = ipfrag_perf_workers(nb_workers, &cycles);
+	if (ret == 0)
+		ipfrag_perf_report("per-lcore tables, steered",
+			nb_workers, cycles);
+	ipfrag_perf_free(nb_workers);
+
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(ipfrag_perf_autotest, test_ipfrag_perf);
@@ -46,6 +46,8 @@
 struct rte_member_setsum *setsum_ht;
 struct rte_member_setsum *setsum_cache;
 struct rte_member_setsum *setsum_vbf;
+struct rte_member_setsum *setsum_cf;
+struct rte_member_setsum *setsum_cbf;
 
 /* 5-tuple key type */
 struct flow_key {
@@ -694,12 +696,174 @@ test_member_loadfactor(void)
 	return 0;
 }
 
+/*
+ * Functional test of the cuckoo filter and counting bloom filter types:
+ * insert, lookup, multimatch lookup and delete.
+ */
+static int
+test_member_cf_cbf(void)
+{
+	struct rte_member_setsum *setsum[2];
+	const void *key_array[NUM_SAMPLES];
+	member_set_t set_ids[NUM_SAMPLES];
+	member_set_t set_ids_m[NUM_SAMPLES][MAX_MATCH];
+	uint32_t match_count[NUM_SAMPLES];
+	member_set_t set_id;
+	uint32_t i, j, t;
+	int ret;
+
+	params.key_len = sizeof(struct flow_key);
+	params.name = "test_member_cf";
+	params.type = RTE_MEMBER_TYPE_CF;
+	setsum_cf = rte_member_create(&params);
+	params.name = "test_member_cbf";
+	params.type = RTE_MEMBER_TYPE_CBF;
+	setsum_cbf = rte_member_create(&params);
+	TEST_ASSERT(setsum_cf != NULL && setsum_cbf != NULL,
+			"Creation of CF/CBF setsums fail");
+	setsum[0] = setsum_cf;
+	setsum[1] = setsum_cbf;
+
+	for (i = 0; i < NUM_SAMPLES; i++)
+		key_array[i] = &keys[i];
+
+	for (t = 0; t < RTE_DIM(setsum); t++) {
+		for (i = 0; i < NUM_SAMPLES; i++)
+			TEST_ASSERT(rte_member_add(setsum[t], &keys[i],
+					test_set[i]) >= 0, "insert error");
+
+		for (i = 0; i < NUM_SAMPLES; i++) {
+			ret = rte_member_lookup(setsum[t], &keys[i], &set_id);
+			TEST_ASSERT(ret == 1 && set_id == test_set[i],
+					"single lookup error, type %u", t);
+		}
+		ret = rte_member_lookup_bulk(setsum[t], key_array,
+				NUM_SAMPLES, set_ids);
+		TEST_ASSERT(ret == NUM_SAMPLES, "bulk lookup error");
+		for (i = 0; i < NUM_SAMPLES; i++)
+			TEST_ASSERT(set_ids[i] == test_set[i],
+					"bulk lookup result error, type %u", t);
+
+		/* Both types support deletion */
+		for (i = 0; i < NUM_SAMPLES / 2; i++)
+			TEST_ASSERT(rte_member_delete(setsum[t], &keys[i],
+					test_set[i]) == 0,
+					"key deletion error, type %u", t);
+		TEST_ASSERT(rte_member_delete(setsum[t], &keys[0],
+				test_set[0]) == -ENOENT,
+				"deleted key deleted twice, type %u", t);
+
+		ret = rte_member_lookup_bulk(setsum[t], key_array,
+				NUM_SAMPLES, set_ids);
+		TEST_ASSERT(ret == NUM_SAMPLES - NUM_SAMPLES / 2,
+				"bulk lookup after delete error, type %u", t);
+		for (i = 0; i < NUM_SAMPLES; i++)
+			TEST_ASSERT(set_ids[i] == (i < NUM_SAMPLES / 2 ?
+					RTE_MEMBER_NO_MATCH : test_set[i]),
+					"key deletion failed, type %u", t);
+
+		rte_member_reset(setsum[t]);
+		for (i = 0; i < NUM_SAMPLES; i++) {
+			rte_member_lookup(setsum[t], &keys[i], &set_id);
+			TEST_ASSERT(set_id == RTE_MEMBER_NO_MATCH,
+					"reset failed, type %u", t);
+		}
+
+		/* Multimatch */
+		for (i = M_MATCH_S; i <= M_MATCH_E; i += M_MATCH_STEP) {
+			for (j = 0; j < NUM_SAMPLES; j++)
+				TEST_ASSERT(rte_member_add(setsum[t], &keys[j],
+						i) >= 0, "insert error");
+		}
+		for (i = 0; i < NUM_SAMPLES; i++) {
+			ret = rte_member_lookup_multi(setsum[t], &keys[i],
+					MAX_MATCH, set_ids_m[0]);
+			TEST_ASSERT(ret == M_MATCH_CNT,
+					"single lookup_multi error, type %u",
+					t);
+			for (j = 1; j <= M_MATCH_CNT; j++)
+				TEST_ASSERT(set_ids_m[0][j - 1] ==
+						j * M_MATCH_STEP - 1,
+						"single multimatch lookup "
+						"error, type %u", t);
+		}
+		ret = rte_member_lookup_multi_bulk(setsum[t], key_array,
+				NUM_SAMPLES, MAX_MATCH, match_count,
+				(member_set_t *)set_ids_m);
+		TEST_ASSERT(ret == NUM_SAMPLES,
+				"bulk multimatch lookup error, type %u", t);
+		for (i = 0; i < NUM_SAMPLES; i++) {
+			TEST_ASSERT(match_count[i] == M_MATCH_CNT,
+					"bulk multimatch lookup match count "
+					"error, type %u", t);
+			for (j = 1; j <= M_MATCH_CNT; j++)
+				TEST_ASSERT(set_ids_m[i][j - 1] ==
+						j * M_MATCH_STEP - 1,
+						"bulk multimatch lookup set "
+						"value error, type %u", t);
+		}
+	}
+
+	printf("CF and CBF setsums success\n");
+	return 0;
+}
+
+/* Fill a cuckoo filter until it is full and report its load */
+static int
+test_member_loadfactor_cf(void)
+{
+	unsigned int j;
+	unsigned int added_keys, average_keys_added = 0;
+	uint32_t num_entries;
+	int ret;
+
+	rte_member_free(setsum_cf);
+
+	params.key_len = KEY_SIZE;
+	params.name = "test_member_cf";
+	params.type = RTE_MEMBER_TYPE_CF;
+	params.num_keys = MAX_ENTRIES / 2;
+	setsum_cf = rte_member_create(&params);
+	params.num_keys = MAX_ENTRIES;
+	if (setsum_cf == NULL) {
+		printf("Creation of setsums fail\n");
+		return -1;
+	}
+	num_entries = setsum_cf->bucket_cnt * RTE_MEMBER_CF_BUCKET_ENTRIES;
+
+	for (j = 0; j < ITERATIONS; j++) {
+		/* Add random entries until key cannot be added */
+		ret = add_generated_keys(setsum_cf, &added_keys);
+		if (ret != -ENOSPC) {
+			printf("Unexpected error when adding keys\n");
+			return -1;
+		}
+		average_keys_added += added_keys;
+
+		/* Reset the table */
+		rte_member_reset(setsum_cf);
+
+		/* Print a dot to show progress on operations */
+		printf(".");
+		fflush(stdout);
+	}
+
+	average_keys_added /= ITERATIONS;
+
+	printf("\nKeys inserted when no space(cuckoo filter) = %.2f%% (%u/%u)\n",
+		((double) average_keys_added / num_entries * 100),
+		average_keys_added, num_entries);
+	return 0;
+}
+
 static void
 perform_free(void)
 {
 	rte_member_free(setsum_ht);
 	rte_member_free(setsum_cache);
 	rte_member_free(setsum_vbf);
+	rte_member_free(setsum_cf);
+	rte_member_free(setsum_cbf);
 }
 
 static int
@@ -731,9 +895,22 @@ test_member(void)
 		perform_free();
 		return -1;
 	}
+	if (test_member_cf_cbf() < 0) {
+		perform_free();
+		return -1;
+	}
 	if (test_member_loadfactor() < 0) {
 		rte_member_free(setsum_ht);
 		rte_member_free(setsum_cache);
+		rte_member_free(setsum_cf);
+		rte_member_free(setsum_cbf);
+		return -1;
+	}
+	if (test_member_loadfactor_cf() < 0) {
+		rte_member_free(setsum_ht);
+		rte_member_free(setsum_cache);
+		rte_member_free(setsum_cf);
+		rte_member_free(setsum_cbf);
 		return -1;
 	}
 
@@ -60,9 +60,19 @@ enum sstype {
 	HT = 0,
 	CACHE,
 	VBF,
+	CF,
+	CBF,
 	NUM_TYPE
 };
 
+static const char * const type_names[NUM_TYPE] = {
+	[HT] = "ht",
+	[CACHE] = "cache",
+	[VBF] = "vbf",
+	[CF] = "cf",
+	[CBF] = "cbf",
+};
+
 enum operations {
 	ADD = 0,
 	LOOKUP,
@@ -102,6 +112,9 @@ uint64_t false_data_multi_bulk[NUM_TYPE][NUM_KEYSIZES];
 
 uint64_t false_hit[NUM_TYPE][NUM_KEYSIZES];
 
+/* Memory used by each set-summary, in bytes */
+uint64_t mem_size[NUM_TYPE];
+
 member_set_t data[NUM_TYPE][/* Array to store the data */KEYS_TO_ADD];
 
 /* Array to store all input keys */
@@ -148,6 +161,28 @@ struct rte_member_parameters member_params = {
 		.socket_id = 0,			/* NUMA Socket ID for memory. */
 	};
 
+/* Memory footprint of the table of a set-summary */
+static uint64_t
+setsum_mem_size(const struct rte_member_setsum *ss)
+{
+	switch (ss->type) {
+	case RTE_MEMBER_TYPE_HT:
+		/* 16-bit signature and 16-bit set id per entry */
+		return (uint64_t)ss->bucket_cnt * RTE_MEMBER_BUCKET_ENTRIES *
+				(sizeof(uint16_t) + sizeof(member_set_t));
+	case RTE_MEMBER_TYPE_VBF:
+		return (uint64_t)ss->num_set * ss->bits / 8;
+	case RTE_MEMBER_TYPE_CBF:
+		/* Bit array plus one byte counter per bit */
+		return (uint64_t)ss->num_set * ss->bits / 8 +
+				(uint64_t)ss->num_set * ss->bits;
+	case RTE_MEMBER_TYPE_CF:
+		return (uint64_t)ss->bucket_cnt * ss->bucket_size;
+	default:
+		return 0;
+	}
+}
+
 static int
 setup_keys_and_data(struct member_perf_params *params, unsigned int cycle,
 		int miss)
@@ -168,7 +203,9 @@ setup_keys_and_data(struct member_perf_params *params, unsigned int cycle,
 			keys[i][j] = rte_rand() & 0xFF;
 
 		data[HT][i] = data[CACHE][i] = (rte_rand() & 0x7FFE) + 1;
+		data[CF][i] = data[HT][i];
 		data[VBF][i] = rte_rand() % VBF_SET_CNT + 1;
+		data[CBF][i] = data[VBF][i];
 	}
 
 	/* Remove duplicates from the keys array */
@@ -226,9 +263,23 @@ setup_keys_and_data(struct member_perf_params *params, unsigned int cycle,
 	params->setsum[VBF] = rte_member_create(&member_params);
 	if (params->setsum[VBF] == NULL)
 		fprintf(stderr, "VBF create fail\n");
+
+	member_params.name = "test_member_cbf";
+	member_params.type = RTE_MEMBER_TYPE_CBF;
+	params->setsum[CBF] = rte_member_create(&member_params);
+	if (params->setsum[CBF] == NULL)
+		fprintf(stderr, "CBF create fail\n");
+
+	member_params.name = "test_member_cf";
+	member_params.type = RTE_MEMBER_TYPE_CF;
+	params->setsum[CF] = rte_member_create(&member_params);
+	if (params->setsum[CF] == NULL)
+		fprintf(stderr, "CF create fail\n");
 	for (i = 0; i < NUM_TYPE; i++) {
 		if (params->setsum[i] == NULL)
 			return -1;
+		if (!miss)
+			mem_size[i] = setsum_mem_size(params->setsum[i]);
 	}
 
 	return 0;
@@ -280,7 +331,8 @@ timed_lookups(struct member_perf_params *params, int type)
 				printf("lookup wrong internally");
 				return -1;
 			}
-			if (type == HT && result == RTE_MEMBER_NO_MATCH) {
+			if ((type == HT || type == CF) &&
+					result == RTE_MEMBER_NO_MATCH) {
 				printf("HT mode shouldn't have false negative");
 				return -1;
 			}
@@ -324,7 +376,8 @@ timed_lookups_bulk(struct member_perf_params *params, int type)
 			}
 			for (k = 0; k < BURST_SIZE; k++) {
 				uint32_t data_idx = j * BURST_SIZE + k;
-				if (type == HT && result[k] ==
+				if ((type == HT || type == CF) &&
+						result[k] ==
 						RTE_MEMBER_NO_MATCH) {
 					printf("HT mode shouldn't have "
 						"false negative");
@@ -362,7 +415,7 @@ timed_lookups_multimatch(struct member_perf_params *params, int type)
 				printf("lookup multi has wrong return value %d,"
 					"type %d\n", ret, type);
 			}
-			if (type == HT && ret == 0) {
+			if ((type == HT || type == CF) && ret == 0) {
 				printf("HT mode shouldn't have false negative");
 				return -1;
 			}
@@ -418,7 +471,8 @@ timed_lookups_multimatch_bulk(struct member_perf_params *params, int type)
 						"wrong match count\n");
 					return -1;
 				}
-				if (type == HT && match_count[k] == 0) {
+				if ((type == HT || type == CF) &&
+						match_count[k] == 0) {
 					printf("HT mode shouldn't have "
 						"false negative");
 					return -1;
@@ -609,7 +663,7 @@ run_all_tbl_perf_tests(void)
 	for (i = 0; i < NUM_KEYSIZES; i++) {
 		for (j = 0; j < NUM_TYPE; j++) {
 			printf("%-18d", hashtest_key_lens[i]);
-			printf("%-18d", j);
+			printf("%-18s", type_names[j]);
 			for (k = 0; k < NUM_OPERATIONS; k++)
 				printf("%-18"PRIu64, cycles[j][i][k]);
 			printf("\n");
@@ -625,7 +679,7 @@ run_all_tbl_perf_tests(void)
 	for (i = 0; i < 1; i++) {
 		for (j = 0; j < NUM_TYPE; j++) {
 			printf("%-18d", hashtest_key_lens[i]);
-			printf("%-18d", j);
+			printf("%-18s", type_names[j]);
 			printf("%-18f", (float)false_data[j][i] / NUM_LOOKUPS);
 			printf("%-18f", (float)false_data_bulk[j][i] /
 						NUM_LOOKUPS);
@@ -638,6 +692,17 @@ run_all_tbl_perf_tests(void)
 			printf("\n");
 		}
 	}
+
+	/* Memory does not depend on key size either */
+	printf("\nMemory usage for %u keys\n", KEYS_TO_ADD);
+	printf("-----------------------------------\n");
+	printf("\n%-18s%-18s%-18s\n", "type", "bytes", "bytes_per_key");
+	for (j = 0; j < NUM_TYPE; j++) {
+		printf("%-18s", type_names[j]);
+		printf("%-18"PRIu64, mem_size[j]);
+		printf("%-18.2f", (double)mem_size[j] / KEYS_TO_ADD);
+		printf("\n");
+	}
 	return 0;
 }
 
@@ -39,6 +39,7 @@
 
 #include "test.h"
 
+#include <rte_common.h>
 #include <rte_cycles.h>
 #include <rte_meter.h>
 
@@ -75,6 +76,19 @@ static struct	rte_meter_trtcm_params tparams=
 				 .cbs = TM_TEST_TRTCM_CBS_DF,
 				 .pbs = TM_TEST_TRTCM_PBS_DF,};
 
+#define TM_TEST_TRTCM_RFC4115_CIR_DF 46000000
+#define TM_TEST_TRTCM_RFC4115_EIR_DF 69000000
+#define TM_TEST_TRTCM_RFC4115_CBS_DF 2048
+#define TM_TEST_TRTCM_RFC4115_EBS_DF 4096
+
+static struct rte_meter_trtcm_rfc4115_params rparams =
+				{.cir = TM_TEST_TRTCM_RFC4115_CIR_DF,
+				 .eir = TM_TEST_TRTCM_RFC4115_EIR_DF,
+				 .cbs = TM_TEST_TRTCM_RFC4115_CBS_DF,
+				 .ebs = TM_TEST_TRTCM_RFC4115_EBS_DF,};
+
+#define TM_TEST_BURST_SIZE 8
+
 /**
  * functional test for rte_meter_srtcm_config
  */
@@ -210,7 +224,7 @@ tm_test_srtcm_color_blind_check(void)
 		melog(SRTCM_BLIND_CHECK_MSG);
 	time = rte_get_tsc_cycles() + hz;
 	if(rte_meter_srtcm_color_blind_check(
-		&sm, time, (uint32_t)sm.ebs - 1) != e_RTE_METER_YELLOW)
+		&sm, time, TM_TEST_SRTCM_EBS_DF - 1) != e_RTE_METER_YELLOW)
 		melog(SRTCM_BLIND_CHECK_MSG" YELLOW");
 
 	/* Test red */
@@ -466,6 +480,223 @@ tm_test_trtcm_color_aware_check(void)
 	return 0;
 }
 
+/**
+ * functional test for rte_meter_trtcm_rfc4115_profile_config
+ */
+static inline int
+tm_test_trtcm_rfc4115_config(void)
+{
+#define TRTCM_RFC4115_CFG_MSG "trtcm_rfc4115_config"
+	struct rte_meter_trtcm_rfc4115_profile rp;
+	struct rte_meter_trtcm_rfc4115_runtime rm;
+	struct rte_meter_trtcm_rfc4115_params rparams1;
+
+	/* invalid parameter test */
+	if(rte_meter_trtcm_rfc4115_profile_config(NULL, NULL) == 0)
+		melog(TRTCM_RFC4115_CFG_MSG);
+	if(rte_meter_trtcm_rfc4115_profile_config(&rp, NULL) == 0)
+		melog(TRTCM_RFC4115_CFG_MSG);
+	if(rte_meter_trtcm_rfc4115_profile_config(NULL, &rparams) == 0)
+		melog(TRTCM_RFC4115_CFG_MSG);
+	if(rte_meter_trtcm_rfc4115_runtime_config(&rm, NULL) == 0)
+		melog(TRTCM_RFC4115_CFG_MSG);
+
+	/* cbs and ebs can't both be zero */
+	rparams1 = rparams;
+	rparams1.cbs = 0;
+	rparams1.ebs = 0;
+	if(rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams1) == 0)
+		melog(TRTCM_RFC4115_CFG_MSG);
+
+	/* cbs can't be zero when cir is not zero */
+	rparams1 = rparams;
+	rparams1.cbs = 0;
+	if(rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams1) == 0)
+		melog(TRTCM_RFC4115_CFG_MSG);
+
+	/* ebs can't be zero when eir is not zero */
+	rparams1 = rparams;
+	rparams1.ebs = 0;
+	if(rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams1) == 0)
+		melog(TRTCM_RFC4115_CFG_MSG);
+
+	/* usual parameter, should be successful */
+	if(rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams) != 0)
+		melog(TRTCM_RFC4115_CFG_MSG);
+	if(rte_meter_trtcm_rfc4115_runtime_config(&rm, &rp) != 0)
+		melog(TRTCM_RFC4115_CFG_MSG);
+
+	/* committed bucket only, should be successful */
+	rparams1 = rparams;
+	rparams1.eir = 0;
+	rparams1.ebs = 0;
+	if(rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams1) != 0)
+		melog(TRTCM_RFC4115_CFG_MSG);
+
+	return 0;
+}
+
+/**
+ * functional test for rte_meter_trtcm_rfc4115_runtime_color_blind_check
+ */
+static inline int
+tm_test_trtcm_rfc4115_color_blind_check(void)
+{
+#define TRTCM_RFC4115_BLIND_CHECK_MSG "trtcm_rfc4115_blind_check"
+	struct rte_meter_trtcm_rfc4115_profile rp;
+	struct rte_meter_trtcm_rfc4115_runtime rm;
+	uint64_t time;
+	uint64_t hz = rte_get_tsc_hz();
+
+	if(rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams) != 0)
+		melog(TRTCM_RFC4115_BLIND_CHECK_MSG);
+
+	/* Test green */
+	if(rte_meter_trtcm_rfc4115_runtime_config(&rm, &rp) != 0)
+		melog(TRTCM_RFC4115_BLIND_CHECK_MSG);
+	time = rte_get_tsc_cycles() + hz;
+	if(rte_meter_trtcm_rfc4115_runtime_color_blind_check(
+		&rm, &rp, time, TM_TEST_TRTCM_RFC4115_CBS_DF - 1)
+		!= e_RTE_METER_GREEN)
+		melog(TRTCM_RFC4115_BLIND_CHECK_MSG" GREEN");
+
+	/* Test yellow */
+	if(rte_meter_trtcm_rfc4115_runtime_config(&rm, &rp) != 0)
+		melog(TRTCM_RFC4115_BLIND_CHECK_MSG);
+	time = rte_get_tsc_cycles() + hz;
+	if(rte_meter_trtcm_rfc4115_runtime_color_blind_check(
+		&rm, &rp, time, TM_TEST_TRTCM_RFC4115_CBS_DF + 1)
+		!= e_RTE_METER_YELLOW)
+		melog(TRTCM_RFC4115_BLIND_CHECK_MSG" YELLOW");
+
+	if(rte_meter_trtcm_rfc4115_runtime_config(&rm, &rp) != 0)
+		melog(TRTCM_RFC4115_BLIND_CHECK_MSG);
+	time = rte_get_tsc_cycles() + hz;
+	if(rte_meter_trtcm_rfc4115_runtime_color_blind_check(
+		&rm, &rp, time, TM_TEST_TRTCM_RFC4115_EBS_DF - 1)
+		!= e_RTE_METER_YELLOW)
+		melog(TRTCM_RFC4115_BLIND_CHECK_MSG" YELLOW");
+
+	/* Test red */
+	if(rte_meter_trtcm_rfc4115_runtime_config(&rm, &rp) != 0)
+		melog(TRTCM_RFC4115_BLIND_CHECK_MSG);
+	time = rte_get_tsc_cycles() + hz;
+	if(rte_meter_trtcm_rfc4115_runtime_color_blind_check(
+		&rm, &rp, time, TM_TEST_TRTCM_RFC4115_EBS_DF + 1)
+		!= e_RTE_METER_RED)
+		melog(TRTCM_RFC4115_BLIND_CHECK_MSG" RED");
+
+	/* The committed bucket does not overflow into the excess bucket */
+	if(rte_meter_trtcm_rfc4115_runtime_config(&rm, &rp) != 0)
+		melog(TRTCM_RFC4115_BLIND_CHECK_MSG);
+	time = rte_get_tsc_cycles() + hz;
+	if(rte_meter_trtcm_rfc4115_runtime_color_blind_check(
+		&rm, &rp, time, TM_TEST_TRTCM_RFC4115_EBS_DF)
+		!= e_RTE_METER_YELLOW)
+		melog(TRTCM_RFC4115_BLIND_CHECK_MSG" YELLOW");
+	if(rte_meter_trtcm_rfc4115_runtime_color_blind_check(
+		&rm, &rp, time, TM_TEST_TRTCM_RFC4115_CBS_DF + 1)
+		!= e_RTE_METER_RED)
+		melog(TRTCM_RFC4115_BLIND_CHECK_MSG" RED");
+
+	return 0;
+}
+
+/**
+ * functional test for rte_meter_trtcm_rfc4115_runtime_color_aware_check
+ */
+static inline int
+tm_test_trtcm_rfc4115_color_aware_check(void)
+{
+#define TRTCM_RFC4115_AWARE_CHECK_MSG "trtcm_rfc4115_aware_check"
+	struct rte_meter_trtcm_rfc4115_profile rp;
+	struct rte_meter_trtcm_rfc4115_runtime rm;
+	enum rte_meter_color in[3], out[3];
+	uint64_t time;
+	uint64_t hz = rte_get_tsc_hz();
+	uint32_t i;
+
+	/* packets of cbs - 1 bytes, fitting both buckets */
+	in[0] = e_RTE_METER_GREEN;
+	in[1] = e_RTE_METER_YELLOW;
+	in[2] = e_RTE_METER_RED;
+	out[0] = e_RTE_METER_GREEN;
+	out[1] = e_RTE_METER_YELLOW;
+	out[2] = e_RTE_METER_RED;
+
+	if(rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams) != 0)
+		melog(TRTCM_RFC4115_AWARE_CHECK_MSG);
+
+	for (i = 0; i < 3; i++) {
+		if(rte_meter_trtcm_rfc4115_runtime_config(&rm, &rp) != 0)
+			melog(TRTCM_RFC4115_AWARE_CHECK_MSG);
+		time = rte_get_tsc_cycles() + hz;
+		if(rte_meter_trtcm_rfc4115_runtime_color_aware_check(
+			&rm, &rp, time, TM_TEST_TRTCM_RFC4115_CBS_DF - 1, in[i])
+			!= out[i])
+			melog(TRTCM_RFC4115_AWARE_CHECK_MSG" %u:%u", in[i], out[i]);
+	}
+
+	return 0;
+}
+
+/**
+ * functional test for the burst API, with several meters sharing a profile
+ */
+static inline int
+tm_test_srtcm_burst_check(void)
+{
+#define SRTCM_BURST_CHECK_MSG "srtcm_burst_check"
+	struct rte_meter_srtcm_profile sp;
+	struct rte_meter_srtcm_runtime sm[TM_TEST_BURST_SIZE];
+	struct rte_meter_srtcm_runtime *m[TM_TEST_BURST_SIZE];
+	struct rte_meter_srtcm_profile *p[TM_TEST_BURST_SIZE];
+	uint32_t pkt_len[TM_TEST_BURST_SIZE];
+	enum rte_meter_color color[TM_TEST_BURST_SIZE];
+	/* tc is consumed first, then te, until red */
+	enum rte_meter_color out[4] = {e_RTE_METER_GREEN, e_RTE_METER_YELLOW,
+		e_RTE_METER_YELLOW, e_RTE_METER_RED};
+	uint64_t time;
+	uint64_t hz = rte_get_tsc_hz();
+	uint32_t i, j;
+
+	if(rte_meter_srtcm_profile_config(&sp, &sparams) != 0)
+		melog(SRTCM_BURST_CHECK_MSG);
+
+	for (i = 0; i < TM_TEST_BURST_SIZE; i++) {
+		if(rte_meter_srtcm_runtime_config(&sm[i], &sp) != 0)
+			melog(SRTCM_BURST_CHECK_MSG);
+		m[i] = &sm[i];
+		p[i] = &sp;
+		pkt_len[i] = TM_TEST_SRTCM_CBS_DF - 1;
+	}
+
+	time = rte_get_tsc_cycles() + hz;
+	for (j = 0; j < RTE_DIM(out); j++) {
+		rte_meter_srtcm_runtime_color_blind_check_burst(m, p, time,
+			pkt_len, color, TM_TEST_BURST_SIZE);
+		for (i = 0; i < TM_TEST_BURST_SIZE; i++)
+			if(color[i] != out[j])
+				melog(SRTCM_BURST_CHECK_MSG" %u:%u", j, i);
+	}
+
+	/* color aware: red packets stay red */
+	for (i = 0; i < TM_TEST_BURST_SIZE; i++) {
+		if(rte_meter_srtcm_runtime_config(&sm[i], &sp) != 0)
+			melog(SRTCM_BURST_CHECK_MSG);
+		color[i] = (i & 1) ? e_RTE_METER_RED : e_RTE_METER_GREEN;
+	}
+
+	time = rte_get_tsc_cycles() + hz;
+	rte_meter_srtcm_runtime_color_aware_check_burst(m, p, time,
+		pkt_len, color, TM_TEST_BURST_SIZE);
+	for (i = 0; i < TM_TEST_BURST_SIZE; i++)
+		if(color[i] != ((i & 1) ? e_RTE_METER_RED : e_RTE_METER_GREEN))
+			melog(SRTCM_BURST_CHECK_MSG" aware %u", i);
+
+	return 0;
+}
+
 /**
  * test main entrance for library meter
  */
@@ -490,6 +721,18 @@ test_meter(void)
 	if(tm_test_trtcm_color_aware_check()!= 0)
 		return -1;
 
+	if(tm_test_trtcm_rfc4115_config() != 0)
+		return -1;
+
+	if(tm_test_trtcm_rfc4115_color_blind_check() != 0)
+		return -1;
+
+	if(tm_test_trtcm_rfc4115_color_aware_check() != 0)
+		return -1;
+
+	if(tm_test_srtcm_burst_check() != 0)
+		return -1;
+
 	return 0;
 
 }
@@ -0,0 +1,246 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
+#include <rte_meter.h>
+
+#include "test.h"
+
+/*
+ * Traffic metering performance with a large number of flows, each one with
+ * its own meter, comparing the self-contained meter objects with the run-time
+ * contexts sharing a few meter profiles, metered one packet at a time or a
+ * burst at a time. The flow of each packet is random, so the meter accesses
+ * are cache misses.
+ */
+
+#define N_FLOWS		(1 << 20)
+#define N_PROFILES	16
+#define N_PKTS		(1 << 22)
+#define BURST_SIZE	32
+#define PKT_LEN		64
+
+static const struct rte_meter_trtcm_params meter_params = {
+	.cir = 1000000,
+	.pir = 2000000,
+	.cbs = 4096,
+	.pbs = 8192,
+};
+
+struct meter_perf {
+	struct rte_meter_trtcm *meters;
+	struct rte_meter_trtcm_runtime *rt;
+	struct rte_meter_trtcm_profile profiles[N_PROFILES];
+	uint32_t *flow_id;
+	uint64_t n_colors[e_RTE_METER_COLORS];
+};
+
+static struct meter_perf mp;
+
+static int
+meter_perf_setup(void)
+{
+	struct rte_meter_trtcm_params params = meter_params;
+	uint32_t i;
+
+	mp.meters = rte_zmalloc(NULL, N_FLOWS * sizeof(mp.meters[0]),
+		RTE_CACHE_LINE_SIZE);
+	mp.rt = rte_zmalloc(NULL, N_FLOWS * sizeof(mp.rt[0]),
+		RTE_CACHE_LINE_SIZE);
+	mp.flow_id = rte_zmalloc(NULL, N_PKTS * sizeof(mp.flow_id[0]),
+		RTE_CACHE_LINE_SIZE);
+	if ((mp.meters == NULL) || (mp.rt == NULL) || (mp.flow_id == NULL)) {
+		printf("Memory allocation failed\n");
+		return -1;
+	}
+
+	for (i = 0; i < N_PROFILES; i++) {
+		params.cir = meter_params.cir * (i + 1);
+		params.pir = meter_params.pir * (i + 1);
+		if (rte_meter_trtcm_profile_config(&mp.profiles[i], &params))
+			return -1;
+	}
+
+	for (i = 0; i < N_FLOWS; i++) {
+		struct rte_meter_trtcm_profile *p = &mp.profiles[i % N_PROFILES];
+
+		params.cir = meter_params.cir * (i % N_PROFILES + 1);
+		params.pir = meter_params.pir * (i % N_PROFILES + 1);
+		if (rte_meter_trtcm_config(&mp.meters[i], &params) ||
+			rte_meter_trtcm_runtime_config(&mp.rt[i], p))
+			return -1;
+	}
+
+	for (i = 0; i < N_PKTS; i++)
+		mp.flow_id[i] = rte_rand() & (N_FLOWS - 1);
+
+	return 0;
+}
+
+static void
+meter_perf_free(void)
+{
+	rte_free(mp.meters);
+	rte_free(mp.rt);
+	rte_free(mp.flow_id);
+	memset(&mp, 0, sizeof(mp));
+}
+
+static void
+meter_perf_single_object(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < N_PKTS; i += BURST_SIZE) {
+		uint64_t time = rte_rdtsc();
+		uint32_t j;
+
+		for (j = 0; j < BURST_SIZE; j++) {
+			enum rte_meter_color color;
+
+			color = rte_meter_trtcm_color_blind_check(
+				&mp.meters[mp.flow_id[i + j]], time, PKT_LEN);
+			mp.n_colors[color]++;
+		}
+	}
+}
+
+static void
+meter_perf_single_profile(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < N_PKTS; i += BURST_SIZE) {
+		uint64_t time = rte_rdtsc();
+		uint32_t j;
+
+		for (j = 0; j < BURST_SIZE; j++) {
+			uint32_t flow_id = mp.flow_id[i + j];
+			enum rte_meter_color color;
+
+			color = rte_meter_trtcm_runtime_color_blind_check(
+				&mp.rt[flow_id],
+				&mp.profiles[flow_id % N_PROFILES],
+				time, PKT_LEN);
+			mp.n_colors[color]++;
+		}
+	}
+}
+
+static void
+meter_perf_burst_profile(void)
+{
+	struct rte_meter_trtcm_runtime *m[BURST_SIZE];
+	struct rte_meter_trtcm_profile *p[BURST_SIZE];
+	uint32_t pkt_len[BURST_SIZE];
+	enum rte_meter_color color[BURST_SIZE];
+	uint32_t i, j;
+
+	for (j = 0; j < BURST_SIZE; j++)
+		pkt_len[j] = PKT_LEN;
+
+	for (i = 0; i < N_PKTS; i += BURST_SIZE) {
+		uint64_t time = rte_rdtsc();
+
+		for (j = 0; j < BURST_SIZE; j++) {
+			uint32_t flow_id = mp.flow_id[i + j];
+
+			m[j] = &mp.rt[flow_id];
+			p[j] = &mp.profiles[flow_id % N_PROFILES];
+		}
+
+		rte_meter_trtcm_runtime_color_blind_check_burst(m, p, time,
+			pkt_len, color, BURST_SIZE);
+
+		for (j = 0; j < BURST_SIZE; j++)
+			mp.n_colors[color[j]]++;
+	}
+}
+
+static const struct {
+	const char *name;
+	void (*run)(void);
+} meter_perf_tests[] = {
+	{"meter object, single", meter_perf_single_object},
+	{"profile + run-time, single", meter_perf_single_profile},
+	{"profile + run-time, burst", meter_perf_burst_profile},
+};
+
+static int
+test_meter_perf(void)
+{
+	uint32_t i;
+
+	if (meter_perf_setup()) {
+		meter_perf_free();
+		return -1;
+	}
+
+	printf("\n%u trTCM meters, %u profiles, %u packets, burst size %u\n",
+		N_FLOWS, N_PROFILES, N_PKTS, BURST_SIZE);
+	printf("Memory per flow: meter object = %zu bytes, "
+		"run-time context = %zu bytes\n",
+		sizeof(struct rte_meter_trtcm),
+		sizeof(struct rte_meter_trtcm_runtime));
+
+	for (i = 0; i < RTE_DIM(meter_perf_tests); i++) {
+		uint64_t start, cycles;
+
+		memset(mp.n_colors, 0, sizeof(mp.n_colors));
+
+		start = rte_rdtsc();
+		meter_perf_tests[i].run();
+		cycles = rte_rdtsc() - start;
+
+		printf("%-28s: %6.1f cycles/packet "
+			"(green %" PRIu64 ", yellow %" PRIu64 ", red %" PRIu64 ")\n",
+			meter_perf_tests[i].name,
+			(double)cycles / N_PKTS,
+			mp.n_colors[e_RTE_METER_GREEN],
+			mp.n_colors[e_RTE_METER_YELLOW],
+			mp.n_colors[e_RTE_METER_RED]);
+	}
+
+	meter_perf_free();
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(meter_perf_autotest, test_meter_perf);
@@ -40,7 +40,9 @@
 #include <rte_mbuf.h>
 #include <rte_reorder.h>
 #include <rte_lcore.h>
+#include <rte_launch.h>
 #include <rte_malloc.h>
+#include <rte_pause.h>
 
 #include "test.h"
 
@@ -48,14 +50,18 @@
 #define REORDER_BUFFER_SIZE 16384
 #define NUM_MBUFS (2*REORDER_BUFFER_SIZE)
 #define REORDER_BUFFER_SIZE_INVALID 2049
+#define REORDER_MP_NUM_BUFS 4096
+#define REORDER_MP_BUFFER_SIZE 256
 
 struct reorder_unittest_params {
 	struct rte_mempool *p;
+	struct rte_mempool *mp_p;
 	struct rte_reorder_buffer *b;
 };
 
 static struct reorder_unittest_params default_params  = {
 	.p = NULL,
+	.mp_p = NULL,
 	.b = NULL
 };
 
@@ -332,6 +338,313 @@ test_reorder_drain(void)
 	return ret;
 }
 
+static int
+test_reorder_mp_create(void)
+{
+	struct rte_reorder_mp_buffer *b = NULL;
+
+	b = rte_reorder_mp_create(NULL, rte_socket_id(), REORDER_BUFFER_SIZE,
+			0);
+	TEST_ASSERT((b == NULL) && (rte_errno == EINVAL),
+			"No error on mp_create() with NULL name");
+
+	b = rte_reorder_mp_create("PKT_MP", rte_socket_id(),
+			REORDER_BUFFER_SIZE_INVALID, 0);
+	TEST_ASSERT((b == NULL) && (rte_errno == EINVAL),
+			"No error on mp_create() with invalid buffer size param.");
+
+	b = rte_reorder_mp_create("PKT_MP", rte_socket_id(),
+			REORDER_BUFFER_SIZE, 0);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+	rte_reorder_mp_free(b);
+
+	return 0;
+}
+
+static int
+test_reorder_mp_insert_drain(void)
+{
+	struct rte_reorder_mp_buffer *b = NULL;
+	struct rte_mempool *p = test_params->mp_p;
+	const unsigned int size = 4;
+	const unsigned int num_bufs = 8;
+	struct rte_mbuf *bufs[num_bufs];
+	struct rte_mbuf *robufs[num_bufs];
+	int ret = 0;
+	unsigned int i, cnt;
+
+	b = rte_reorder_mp_create("test_mp_drain", rte_socket_id(), size, 0);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+
+	ret = rte_mempool_get_bulk(p, (void *)bufs, num_bufs);
+	TEST_ASSERT_SUCCESS(ret, "Error getting mbuf from pool");
+
+	for (i = 0; i < num_bufs; i++)
+		bufs[i]->seqn = i;
+
+	/* Check no drained packets if reorder is empty */
+	cnt = rte_reorder_mp_drain(b, robufs, num_bufs);
+	if (cnt != 0) {
+		printf("%s:%d: drained packets from empty reorder buffer\n",
+				__func__, __LINE__);
+		ret = -1;
+		goto exit;
+	}
+
+	/* seqn 0 is missing, nothing can be drained */
+	rte_reorder_mp_insert(b, bufs[1]);
+	cnt = rte_reorder_mp_drain(b, robufs, num_bufs);
+	if (cnt != 0) {
+		printf("%s:%d:%u: drained packets past a missing one\n",
+				__func__, __LINE__, cnt);
+		ret = -1;
+		goto exit;
+	}
+
+	/* window is now [2, 5] */
+	rte_reorder_mp_insert(b, bufs[0]);
+	rte_reorder_mp_insert(b, bufs[3]);
+	cnt = rte_reorder_mp_drain(b, robufs, num_bufs);
+	if (cnt != 2 || robufs[0] != bufs[0] || robufs[1] != bufs[1]) {
+		printf("%s:%d:%u: expected packets not drained\n",
+				__func__, __LINE__, cnt);
+		ret = -1;
+		goto exit;
+	}
+
+	/* early packet */
+	ret = rte_reorder_mp_insert(b, bufs[6]);
+	if (!((ret == -1) && (rte_errno == ENOSPC))) {
+		printf("%s:%d: No error inserting early packet\n",
+				__func__, __LINE__);
+		ret = -1;
+		goto exit;
+	}
+
+	/* late packet */
+	bufs[7]->seqn = 1;
+	ret = rte_reorder_mp_insert(b, bufs[7]);
+	if (!((ret == -1) && (rte_errno == ERANGE))) {
+		printf("%s:%d: No error inserting late packet\n",
+				__func__, __LINE__);
+		ret = -1;
+		goto exit;
+	}
+
+	/* duplicate packet */
+	bufs[7]->seqn = 3;
+	ret = rte_reorder_mp_insert(b, bufs[7]);
+	if (!((ret == -1) && (rte_errno == ERANGE))) {
+		printf("%s:%d: No error inserting duplicate packet\n",
+				__func__, __LINE__);
+		ret = -1;
+		goto exit;
+	}
+
+	rte_reorder_mp_insert(b, bufs[2]);
+	cnt = rte_reorder_mp_drain(b, robufs, 1);
+	cnt += rte_reorder_mp_drain(b, &robufs[1], num_bufs);
+	if (cnt != 2 || robufs[0] != bufs[2] || robufs[1] != bufs[3]) {
+		printf("%s:%d:%u: expected packets not drained\n",
+				__func__, __LINE__, cnt);
+		ret = -1;
+		goto exit;
+	}
+	ret = 0;
+exit:
+	/* the buffer holds no mbuf once all the inserted ones are drained */
+	if (ret == 0)
+		rte_mempool_put_bulk(p, (void *)bufs, num_bufs);
+	rte_reorder_mp_free(b);
+	return ret;
+}
+
+static int
+test_reorder_mp_timeout(void)
+{
+	struct rte_reorder_mp_buffer *b = NULL;
+	struct rte_mempool *p = test_params->mp_p;
+	const unsigned int size = 8;
+	const unsigned int num_bufs = 4;
+	struct rte_mbuf *bufs[num_bufs];
+	struct rte_mbuf *robufs[num_bufs];
+	int ret = 0;
+	unsigned int i, cnt;
+
+	b = rte_reorder_mp_create("test_mp_timeout", rte_socket_id(), size,
+			rte_get_timer_hz() / 1000);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+
+	ret = rte_mempool_get_bulk(p, (void *)bufs, num_bufs);
+	TEST_ASSERT_SUCCESS(ret, "Error getting mbuf from pool");
+
+	for (i = 0; i < num_bufs; i++)
+		bufs[i]->seqn = i;
+
+	/* nothing is waiting, so an empty buffer has no gap to skip */
+	rte_reorder_mp_drain(b, robufs, num_bufs);
+	rte_delay_ms(2);
+	cnt = rte_reorder_mp_drain(b, robufs, num_bufs);
+	if (cnt != 0) {
+		printf("%s:%d:%u: drained packets from empty reorder buffer\n",
+				__func__, __LINE__, cnt);
+		ret = -1;
+		goto exit;
+	}
+
+	/* seqn 0 is missing, it is skipped after the timeout */
+	rte_reorder_mp_insert(b, bufs[2]);
+	rte_reorder_mp_insert(b, bufs[1]);
+	cnt = rte_reorder_mp_drain(b, robufs, num_bufs);
+	if (cnt != 0) {
+		printf("%s:%d:%u: gap skipped before the timeout\n",
+				__func__, __LINE__, cnt);
+		ret = -1;
+		goto exit;
+	}
+	rte_delay_ms(2);
+	cnt = rte_reorder_mp_drain(b, robufs, num_bufs);
+	if (cnt != 2 || robufs[0] != bufs[1] || robufs[1] != bufs[2]) {
+		printf("%s:%d:%u: gap not skipped after the timeout\n",
+				__func__, __LINE__, cnt);
+		ret = -1;
+		goto exit;
+	}
+
+	ret = rte_reorder_mp_insert(b, bufs[0]);
+	if (!((ret == -1) && (rte_errno == ERANGE))) {
+		printf("%s:%d: No error inserting skipped packet\n",
+				__func__, __LINE__);
+		ret = -1;
+		goto exit;
+	}
+
+	/* window is [3, 10], the gap is skipped to make room for seqn 12 */
+	bufs[3]->seqn = 12;
+	ret = rte_reorder_mp_insert(b, bufs[3]);
+	if (!((ret == -1) && (rte_errno == ENOSPC))) {
+		printf("%s:%d: No error inserting early packet\n",
+				__func__, __LINE__);
+		ret = -1;
+		goto exit;
+	}
+	rte_reorder_mp_drain(b, robufs, num_bufs);
+	rte_delay_ms(2);
+	rte_reorder_mp_drain(b, robufs, num_bufs);
+	ret = rte_reorder_mp_insert(b, bufs[3]);
+	if (ret != 0) {
+		printf("%s:%d: No room made for early packet\n",
+				__func__, __LINE__);
+		ret = -1;
+		goto exit;
+	}
+	rte_delay_ms(2);
+	cnt = rte_reorder_mp_drain(b, robufs, num_bufs);
+	cnt += rte_reorder_mp_drain(b, robufs, num_bufs);
+	if (cnt != 1 || robufs[0] != bufs[3]) {
+		printf("%s:%d:%u: early packet not drained\n",
+				__func__, __LINE__, cnt);
+		ret = -1;
+		goto exit;
+	}
+	ret = 0;
+exit:
+	if (ret == 0)
+		rte_mempool_put_bulk(p, (void *)bufs, num_bufs);
+	rte_reorder_mp_free(b);
+	return ret;
+}
+
+struct reorder_mp_producer_args {
+	struct rte_reorder_mp_buffer *b;
+	struct rte_mbuf **bufs;
+	unsigned int nb_producers;
+};
+
+static volatile unsigned int reorder_mp_producer_idx;
+static volatile int reorder_mp_quit;
+
+/* inserts the mbufs whose index is its id modulo the number of producers */
+static int
+reorder_mp_producer(void *arg)
+{
+	struct reorder_mp_producer_args *args = arg;
+	unsigned int i = __sync_fetch_and_add(&reorder_mp_producer_idx, 1);
+
+	for (; i < REORDER_MP_NUM_BUFS; i += args->nb_producers)
+		while (rte_reorder_mp_insert(args->b, args->bufs[i]) != 0) {
+			if (rte_errno != ENOSPC || reorder_mp_quit)
+				return -1;
+			rte_pause();
+		}
+
+	return 0;
+}
+
+static int
+test_reorder_mp_multi_producer(void)
+{
+	static struct rte_mbuf *bufs[REORDER_MP_NUM_BUFS];
+	struct rte_mbuf *robufs[BURST];
+	struct reorder_mp_producer_args args;
+	struct rte_mempool *p = test_params->mp_p;
+	unsigned int i, cnt, lcore_id, num_drained = 0;
+	uint64_t deadline;
+	int ret = 0;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough cores for %s, expecting at least 2\n",
+				__func__);
+		return 0;
+	}
+
+	args.b = rte_reorder_mp_create("test_mp_multi", rte_socket_id(),
+			REORDER_MP_BUFFER_SIZE, 0);
+	TEST_ASSERT_NOT_NULL(args.b, "Failed to create reorder buffer");
+	args.bufs = bufs;
+	args.nb_producers = rte_lcore_count() - 1;
+
+	ret = rte_mempool_get_bulk(p, (void *)bufs, REORDER_MP_NUM_BUFS);
+	TEST_ASSERT_SUCCESS(ret, "Error getting mbuf from pool");
+
+	for (i = 0; i < REORDER_MP_NUM_BUFS; i++)
+		bufs[i]->seqn = i;
+
+	reorder_mp_producer_idx = 0;
+	reorder_mp_quit = 0;
+	rte_eal_mp_remote_launch(reorder_mp_producer, &args, SKIP_MASTER);
+
+	deadline = rte_get_timer_cycles() + 10 * rte_get_timer_hz();
+	while (num_drained < REORDER_MP_NUM_BUFS &&
+			rte_get_timer_cycles() < deadline) {
+		cnt = rte_reorder_mp_drain(args.b, robufs, BURST);
+		for (i = 0; i < cnt; i++, num_drained++)
+			if (robufs[i] != bufs[num_drained]) {
+				printf("%s:%d: packet %u drained out of order\n",
+						__func__, __LINE__,
+						num_drained);
+				ret = -1;
+			}
+	}
+	reorder_mp_quit = 1;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			ret = -1;
+
+	if (num_drained != REORDER_MP_NUM_BUFS) {
+		printf("%s:%d: drained %u packets, expected %u\n",
+				__func__, __LINE__, num_drained,
+				REORDER_MP_NUM_BUFS);
+		ret = -1;
+	}
+
+	if (ret == 0)
+		rte_mempool_put_bulk(p, (void *)bufs, REORDER_MP_NUM_BUFS);
+	rte_reorder_mp_free(args.b);
+	return ret;
+}
+
 static int
 test_setup(void)
 {
@@ -357,6 +670,17 @@ test_setup(void)
 			return -1;
 		}
 	}
+
+	/* separate mempool for the multi-producer reorder buffer tests */
+	if (test_params->mp_p == NULL) {
+		test_params->mp_p = rte_pktmbuf_pool_create("RO_MP_MBUF_POOL",
+			2 * REORDER_MP_NUM_BUFS, BURST, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+		if (test_params->mp_p == NULL) {
+			printf("%s: Error creating mempool\n", __func__);
+			return -1;
+		}
+	}
 	return 0;
 }
 
@@ -371,6 +695,10 @@ static struct unit_test_suite reorder_test_suite  = {
 		TEST_CASE(test_reorder_free),
 		TEST_CASE(test_reorder_insert),
 		TEST_CASE(test_reorder_drain),
+		TEST_CASE(test_reorder_mp_create),
+		TEST_CASE(test_reorder_mp_insert_drain),
+		TEST_CASE(test_reorder_mp_timeout),
+		TEST_CASE(test_reorder_mp_multi_producer),
 		TEST_CASES_END()
 	}
 };
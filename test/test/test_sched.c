@@ -132,6 +132,315 @@ prepare_pkt(struct rte_mbuf *mbuf)
 }
 
 
+#define TC_LAYOUT_N_TCS       RTE_SCHED_TRAFFIC_CLASSES_MAX
+#define TC_LAYOUT_TC_BE       (TC_LAYOUT_N_TCS - 1)
+#define TC_LAYOUT_BE_QUEUES   4
+#define TC_LAYOUT_N_PKTS      (TC_LAYOUT_TC_BE + TC_LAYOUT_BE_QUEUES)
+
+static struct rte_sched_subport_params subport_param_tc_layout[] = {
+	{
+		.tb_rate = 1250000000,
+		.tb_size = 1000000,
+
+		.tc_rate = {1250000000, 1250000000, 1250000000, 1250000000,
+			1250000000, 1250000000, 1250000000, 1250000000,
+			1250000000, 1250000000, 1250000000, 1250000000,
+			1250000000},
+		.tc_period = 10,
+	},
+};
+
+static struct rte_sched_pipe_params pipe_profile_tc_layout[] = {
+	{ /* Profile #0 */
+		.tb_rate = 305175,
+		.tb_size = 1000000,
+
+		.tc_rate = {305175, 305175, 305175, 305175, 305175, 305175,
+			305175, 305175, 305175, 305175, 305175, 305175,
+			305175},
+		.tc_period = 40,
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+		.tc_ov_weight = 1,
+#endif
+
+		.wrr_weights = {1, 1, 1, 1,  1, 1, 1, 1,  1, 1, 1, 1,  1, 2, 4, 8},
+	},
+};
+
+/*
+ * 12 strict priority traffic classes with one queue each, followed by a best
+ * effort traffic class with 4 WRR queues.
+ */
+static int
+test_sched_tc_layout(struct rte_mempool *mp)
+{
+	struct rte_sched_port_params params = port_param;
+	struct rte_sched_port *port;
+	struct rte_mbuf *in_mbufs[TC_LAYOUT_N_PKTS];
+	struct rte_mbuf *out_mbufs[TC_LAYOUT_N_PKTS];
+	uint32_t i;
+	int err;
+
+	params.n_pipes_per_subport = 64;
+	params.pipe_profiles = pipe_profile_tc_layout;
+	for (i = 0; i < TC_LAYOUT_N_TCS; i++) {
+		params.tc_n_queues[i] = 1;
+		params.qsize[i] = 32;
+	}
+	params.tc_n_queues[TC_LAYOUT_TC_BE] = TC_LAYOUT_BE_QUEUES;
+
+	/* Invalid layouts: gap between TCs, more than 16 queues per pipe */
+	params.tc_n_queues[1] = 0;
+	port = rte_sched_port_config(&params);
+	TEST_ASSERT_NULL(port, "Layout with gap accepted\n");
+	params.tc_n_queues[1] = 2;
+	port = rte_sched_port_config(&params);
+	TEST_ASSERT_NULL(port, "Layout with 17 queues accepted\n");
+	params.tc_n_queues[1] = 1;
+
+	port = rte_sched_port_config(&params);
+	TEST_ASSERT_NOT_NULL(port, "Error config sched port\n");
+
+	err = rte_sched_subport_config(port, SUBPORT, subport_param_tc_layout);
+	TEST_ASSERT_SUCCESS(err, "Error config sched, err=%d\n", err);
+
+	for (i = 0; i < params.n_pipes_per_subport; i++) {
+		err = rte_sched_pipe_config(port, SUBPORT, i, 0);
+		TEST_ASSERT_SUCCESS(err, "Error config sched pipe %u, err=%d\n",
+			i, err);
+	}
+
+	/* Enqueue in reverse priority order: best effort first */
+	for (i = 0; i < TC_LAYOUT_N_PKTS; i++) {
+		uint32_t tc, queue;
+
+		if (i < TC_LAYOUT_BE_QUEUES) {
+			tc = TC_LAYOUT_TC_BE;
+			queue = i;
+		} else {
+			tc = TC_LAYOUT_N_PKTS - 1 - i;
+			queue = 0;
+		}
+
+		in_mbufs[i] = rte_pktmbuf_alloc(mp);
+		TEST_ASSERT_NOT_NULL(in_mbufs[i], "Packet allocation failed\n");
+		rte_sched_port_pkt_write(in_mbufs[i], SUBPORT, PIPE, tc, queue,
+			e_RTE_METER_GREEN);
+		in_mbufs[i]->pkt_len = 60;
+		in_mbufs[i]->data_len = 60;
+	}
+
+	err = rte_sched_port_enqueue(port, in_mbufs, TC_LAYOUT_N_PKTS);
+	TEST_ASSERT_EQUAL(err, TC_LAYOUT_N_PKTS, "Wrong enqueue, err=%d\n", err);
+
+	err = rte_sched_port_dequeue(port, out_mbufs, TC_LAYOUT_N_PKTS);
+	TEST_ASSERT_EQUAL(err, TC_LAYOUT_N_PKTS, "Wrong dequeue, err=%d\n", err);
+
+	/* Strict priority TCs first, in priority order */
+	for (i = 0; i < TC_LAYOUT_N_PKTS; i++) {
+		uint32_t subport, pipe, traffic_class, queue;
+
+		rte_sched_port_pkt_read_tree_path(out_mbufs[i],
+				&subport, &pipe, &traffic_class, &queue);
+
+		TEST_ASSERT_EQUAL(subport, SUBPORT, "Wrong subport\n");
+		TEST_ASSERT_EQUAL(pipe, PIPE, "Wrong pipe\n");
+		if (i < TC_LAYOUT_TC_BE)
+			TEST_ASSERT_EQUAL(traffic_class, i,
+				"Wrong traffic_class %u at position %u\n",
+				traffic_class, i);
+		else
+			TEST_ASSERT_EQUAL(traffic_class, TC_LAYOUT_TC_BE,
+				"Wrong traffic_class %u at position %u\n",
+				traffic_class, i);
+
+		rte_pktmbuf_free(out_mbufs[i]);
+	}
+
+	rte_sched_port_free(port);
+
+	return 0;
+}
+
+#define GROUP_N_PORTS           2
+#define GROUP_RATE              1000000
+#define GROUP_PKT_LEN           60
+#define GROUP_PKT_CREDITS       (GROUP_PKT_LEN + RTE_SCHED_FRAME_OVERHEAD_DEFAULT)
+#define GROUP_N_PKTS            512
+#define GROUP_CREDITS_MAX       2000
+#define GROUP_BYTES             20000
+
+static struct rte_sched_subport_params subport_param_group[] = {
+	{
+		.tb_rate = GROUP_RATE,
+		.tb_size = 1000000,
+
+		.tc_rate = {GROUP_RATE, GROUP_RATE, GROUP_RATE, GROUP_RATE},
+		.tc_period = 10,
+	},
+};
+
+static struct rte_sched_pipe_params pipe_profile_group[] = {
+	{ /* Profile #0 */
+		.tb_rate = GROUP_RATE,
+		.tb_size = 1000000,
+
+		.tc_rate = {GROUP_RATE, GROUP_RATE, GROUP_RATE, GROUP_RATE},
+		.tc_period = 40,
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+		.tc_ov_weight = 1,
+#endif
+
+		.wrr_weights = {1, 1, 1, 1,  1, 1, 1, 1,  1, 1, 1, 1,  1, 1, 1, 1},
+	},
+};
+
+/*
+ * Dequeue from the given group ports (round robin) until GROUP_BYTES are
+ * sent, return the number of CPU cycles it took.
+ */
+static uint64_t
+test_sched_port_group_run(struct rte_sched_port **ports, uint32_t n_ports,
+	uint32_t *n_pkts)
+{
+	struct rte_mbuf *out_mbufs[4];
+	uint64_t start = rte_get_tsc_cycles();
+	uint64_t timeout = start + rte_get_tsc_hz();
+	uint32_t bytes = 0, i;
+	int n, j;
+
+	for (i = 0; bytes < GROUP_BYTES; i = (i + 1) % n_ports) {
+		n = rte_sched_port_dequeue(ports[i], out_mbufs,
+			RTE_DIM(out_mbufs));
+
+		for (j = 0; j < n; j++)
+			rte_pktmbuf_free(out_mbufs[j]);
+
+		n_pkts[i] += n;
+		bytes += n * GROUP_PKT_CREDITS;
+
+		if (rte_get_tsc_cycles() > timeout)
+			break;
+	}
+
+	return rte_get_tsc_cycles() - start;
+}
+
+/*
+ * Two ports sharing the same output port rate: the aggregate rate is capped
+ * to the output port rate, and each port can use the whole of it when the
+ * other one is idle.
+ */
+static int
+test_sched_port_group(void)
+{
+	struct rte_sched_port_group_params group_params = {
+		.name = "test_sched_group",
+		.socket = SOCKET,
+		.rate = GROUP_RATE,
+		.n_ports = GROUP_N_PORTS,
+		.credits_per_dequeue = 4 * GROUP_PKT_CREDITS,
+		.credits_max = GROUP_CREDITS_MAX,
+	};
+	struct rte_sched_port_params params = port_param;
+	struct rte_sched_port *ports[GROUP_N_PORTS];
+	struct rte_sched_port_group *group;
+	struct rte_mempool *mp;
+	uint32_t n_pkts[GROUP_N_PORTS];
+	uint64_t cycles, cycles_min, cycles_max;
+	uint32_t i, j;
+	int err;
+
+	mp = rte_pktmbuf_pool_create("test_sched_group",
+		GROUP_N_PORTS * GROUP_N_PKTS, 0, 0, MBUF_DATA_SZ, SOCKET);
+	TEST_ASSERT_NOT_NULL(mp, "Error creating mempool\n");
+
+	group = rte_sched_port_group_create(&group_params);
+	TEST_ASSERT_NOT_NULL(group, "Error creating port group\n");
+
+	params.rate = GROUP_RATE;
+	params.n_pipes_per_subport = 64;
+	params.qsize[0] = GROUP_N_PKTS;
+	params.pipe_profiles = pipe_profile_group;
+
+	for (i = 0; i < GROUP_N_PORTS; i++) {
+		struct rte_mbuf *in_mbufs[GROUP_N_PKTS];
+		char name[32];
+
+		snprintf(name, sizeof(name), "test_sched_group_%u", i);
+		params.name = name;
+		ports[i] = rte_sched_port_config(&params);
+		TEST_ASSERT_NOT_NULL(ports[i], "Error config sched port\n");
+
+		err = rte_sched_subport_config(ports[i], SUBPORT,
+			subport_param_group);
+		TEST_ASSERT_SUCCESS(err, "Error config sched, err=%d\n", err);
+
+		err = rte_sched_pipe_config(ports[i], SUBPORT, PIPE, 0);
+		TEST_ASSERT_SUCCESS(err, "Error config sched pipe, err=%d\n",
+			err);
+
+		err = rte_sched_port_group_add(group, ports[i]);
+		TEST_ASSERT_SUCCESS(err, "Error adding port to group, err=%d\n",
+			err);
+
+		for (j = 0; j < GROUP_N_PKTS; j++) {
+			in_mbufs[j] = rte_pktmbuf_alloc(mp);
+			TEST_ASSERT_NOT_NULL(in_mbufs[j],
+				"Packet allocation failed\n");
+			rte_sched_port_pkt_write(in_mbufs[j], SUBPORT, PIPE, 0, 0,
+				e_RTE_METER_GREEN);
+			in_mbufs[j]->pkt_len = GROUP_PKT_LEN;
+			in_mbufs[j]->data_len = GROUP_PKT_LEN;
+		}
+
+		err = rte_sched_port_enqueue(ports[i], in_mbufs, GROUP_N_PKTS);
+		TEST_ASSERT_EQUAL(err, GROUP_N_PKTS, "Wrong enqueue, err=%d\n",
+			err);
+	}
+
+	err = rte_sched_port_group_add(group, ports[0]);
+	TEST_ASSERT_FAIL(err, "Port added twice to group\n");
+
+	/* Lower bound: all the pool credits plus one packet per dequeue in
+	 * progress can be used at once, the rest is paced at the group rate.
+	 */
+	cycles_min = (GROUP_BYTES - GROUP_CREDITS_MAX - GROUP_PKT_CREDITS) *
+		rte_get_tsc_hz() / GROUP_RATE;
+	/* Upper bound: generous, for loaded test machines */
+	cycles_max = 10 * GROUP_BYTES * rte_get_tsc_hz() / GROUP_RATE;
+
+	/* Both ports busy: aggregate rate capped, bandwidth shared */
+	memset(n_pkts, 0, sizeof(n_pkts));
+	cycles = test_sched_port_group_run(ports, GROUP_N_PORTS, n_pkts);
+	TEST_ASSERT(cycles >= cycles_min,
+		"Group rate exceeded: %" PRIu64 " cycles < %" PRIu64 "\n",
+		cycles, cycles_min);
+	TEST_ASSERT(cycles <= cycles_max,
+		"Group rate too low: %" PRIu64 " cycles > %" PRIu64 "\n",
+		cycles, cycles_max);
+	for (i = 0; i < GROUP_N_PORTS; i++)
+		TEST_ASSERT(n_pkts[i] * GROUP_N_PORTS * 2 >= n_pkts[0] + n_pkts[1],
+			"Port %u starved: %u packets\n", i, n_pkts[i]);
+
+	/* Second port idle: the first one gets the whole group rate */
+	memset(n_pkts, 0, sizeof(n_pkts));
+	cycles = test_sched_port_group_run(ports, 1, n_pkts);
+	TEST_ASSERT(cycles >= cycles_min,
+		"Group rate exceeded: %" PRIu64 " cycles < %" PRIu64 "\n",
+		cycles, cycles_min);
+	TEST_ASSERT(cycles <= cycles_max,
+		"Group rate not reused: %" PRIu64 " cycles > %" PRIu64 "\n",
+		cycles, cycles_max);
+
+	for (i = 0; i < GROUP_N_PORTS; i++)
+		rte_sched_port_free(ports[i]);
+	rte_sched_port_group_free(group);
+	rte_mempool_free(mp);
+
+	return 0;
+}
+
 /**
  * test main entrance for library sched
  */
@@ -210,7 +519,11 @@ test_sched(void)
 
 	rte_sched_port_free(port);
 
-	return 0;
+	err = test_sched_tc_layout(mp);
+	if (err != 0)
+		return err;
+
+	return test_sched_port_group();
 }
 
 REGISTER_TEST_COMMAND(sched_autotest, test_sched);
@@ -0,0 +1,946 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+#include <rte_cycles.h>
+#include <rte_mbuf.h>
+#include <rte_ring.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
+#include <rte_tcp.h>
+#include <rte_port_ring.h>
+#include <rte_table_array.h>
+#include <rte_pipeline.h>
+#include <rte_table_action.h>
+
+#include "test.h"
+
+#define NB_MBUF             1024
+#define BURST_SIZE          32
+#define N_ENTRIES           16
+#define MAX_ENTRY_SIZE      1024
+
+/* The array table lookup key is stored in the first bytes of the headroom */
+#define KEY_OFFSET          (sizeof(struct rte_mbuf))
+#define IP_OFFSET           (sizeof(struct rte_mbuf) + \
+				RTE_PKTMBUF_HEADROOM + sizeof(struct ether_hdr))
+
+#define IPV4(a, b, c, d)    ((uint32_t)(((a) << 24) | ((b) << 16) | \
+				((c) << 8) | (d)))
+
+static struct rte_mempool *pool;
+static struct rte_ring *ring_in;
+static struct rte_ring *ring_out;
+
+struct test_pipeline {
+	struct rte_pipeline *p;
+	struct rte_table_action *action;
+	uint32_t table_id;
+	uint32_t port_out_id;
+	uint32_t entry_size;
+};
+
+static const uint8_t ipv6_src[16] = {
+	0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01};
+static const uint8_t ipv6_dst[16] = {
+	0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02};
+static const uint8_t ipv6_nat[16] = {
+	0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xab, 0xcd};
+
+static int
+test_pipeline_create(struct test_pipeline *t,
+	struct rte_table_action_profile *profile)
+{
+	struct rte_pipeline_params pipeline_params = {
+		.name = "table_action",
+		.socket_id = 0,
+		.offset_port_id = 0,
+	};
+	struct rte_port_ring_reader_params reader_params = {
+		.ring = ring_in,
+	};
+	struct rte_port_ring_writer_params writer_params = {
+		.ring = ring_out,
+		.tx_burst_sz = BURST_SIZE,
+	};
+	struct rte_pipeline_port_in_params port_in_params = {
+		.ops = &rte_port_ring_reader_ops,
+		.arg_create = &reader_params,
+		.burst_size = BURST_SIZE,
+	};
+	struct rte_pipeline_port_out_params port_out_params = {
+		.ops = &rte_port_ring_writer_ops,
+		.arg_create = &writer_params,
+	};
+	struct rte_table_array_params array_params = {
+		.n_entries = N_ENTRIES,
+		.offset = KEY_OFFSET,
+	};
+	struct rte_pipeline_table_params table_params = {
+		.ops = &rte_table_array_ops,
+		.arg_create = &array_params,
+	};
+	uint32_t port_in_id;
+
+	memset(t, 0, sizeof(*t));
+
+	t->action = rte_table_action_create(profile, 0);
+	if (t->action == NULL)
+		return -1;
+
+	if (rte_table_action_table_params_get(t->action, &table_params))
+		return -1;
+	t->entry_size = sizeof(struct rte_pipeline_table_entry) +
+		table_params.action_data_size;
+	if (t->entry_size > MAX_ENTRY_SIZE)
+		return -1;
+
+	t->p = rte_pipeline_create(&pipeline_params);
+	if (t->p == NULL)
+		return -1;
+
+	if (rte_pipeline_port_in_create(t->p, &port_in_params, &port_in_id) ||
+		rte_pipeline_port_out_create(t->p, &port_out_params,
+			&t->port_out_id) ||
+		rte_pipeline_table_create(t->p, &table_params, &t->table_id) ||
+		rte_pipeline_port_in_connect_to_table(t->p, port_in_id,
+			t->table_id) ||
+		rte_pipeline_port_in_enable(t->p, port_in_id) ||
+		rte_pipeline_check(t->p))
+		return -1;
+
+	return 0;
+}
+
+static void
+test_pipeline_free(struct test_pipeline *t)
+{
+	struct rte_mbuf *m;
+
+	if (t->p)
+		rte_pipeline_free(t->p);
+	rte_table_action_free(t->action);
+
+	while (rte_ring_dequeue(ring_in, (void **)&m) == 0)
+		rte_pktmbuf_free(m);
+	while (rte_ring_dequeue(ring_out, (void **)&m) == 0)
+		rte_pktmbuf_free(m);
+}
+
+/* Add table rule *pos* after running *apply* on a zeroed entry buffer */
+static struct rte_pipeline_table_entry *
+test_pipeline_rule_add(struct test_pipeline *t,
+	uint32_t pos,
+	uint8_t *entry_buf)
+{
+	struct rte_table_array_key key = { .pos = pos };
+	struct rte_pipeline_table_entry *entry_ptr;
+	int key_found;
+
+	if (rte_pipeline_table_entry_add(t->p, t->table_id, &key,
+			(struct rte_pipeline_table_entry *)entry_buf,
+			&key_found, &entry_ptr))
+		return NULL;
+
+	return entry_ptr;
+}
+
+static int
+test_fwd_apply(struct test_pipeline *t, uint8_t *entry_buf)
+{
+	struct rte_table_action_fwd_params fwd = {
+		.action = RTE_PIPELINE_ACTION_PORT,
+		.id = t->port_out_id,
+	};
+
+	memset(entry_buf, 0, MAX_ENTRY_SIZE);
+	return rte_table_action_apply(t->action, entry_buf,
+		RTE_TABLE_ACTION_FWD, &fwd);
+}
+
+static struct rte_mbuf *
+test_pkt_ipv4(uint32_t pos, uint8_t proto, uint8_t ttl)
+{
+	struct rte_mbuf *m = rte_pktmbuf_alloc(pool);
+	struct ether_hdr *eth;
+	struct ipv4_hdr *ip;
+	uint16_t l4_len = (proto == IPPROTO_TCP) ?
+		sizeof(struct tcp_hdr) : sizeof(struct udp_hdr);
+	uint16_t len = sizeof(*eth) + sizeof(*ip) + l4_len + 18;
+
+	if (m == NULL)
+		return NULL;
+
+	eth = (struct ether_hdr *)rte_pktmbuf_append(m, len);
+	memset(eth, 0, len);
+	eth->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+
+	ip = (struct ipv4_hdr *)&eth[1];
+	ip->version_ihl = 0x45;
+	ip->total_length = rte_cpu_to_be_16(len - sizeof(*eth));
+	ip->time_to_live = ttl;
+	ip->next_proto_id = proto;
+	ip->src_addr = rte_cpu_to_be_32(IPV4(10, 0, 0, 1));
+	ip->dst_addr = rte_cpu_to_be_32(IPV4(10, 0, 0, 2));
+
+	if (proto == IPPROTO_TCP) {
+		struct tcp_hdr *tcp = (struct tcp_hdr *)&ip[1];
+
+		tcp->src_port = rte_cpu_to_be_16(1000);
+		tcp->dst_port = rte_cpu_to_be_16(2000);
+		tcp->data_off = 0x50;
+		tcp->cksum = rte_ipv4_udptcp_cksum(ip, tcp);
+	} else {
+		struct udp_hdr *udp = (struct udp_hdr *)&ip[1];
+
+		udp->src_port = rte_cpu_to_be_16(1000);
+		udp->dst_port = rte_cpu_to_be_16(2000);
+		udp->dgram_len = rte_cpu_to_be_16(l4_len + 18);
+		udp->dgram_cksum = rte_ipv4_udptcp_cksum(ip, udp);
+	}
+	ip->hdr_checksum = rte_ipv4_cksum(ip);
+
+	*RTE_MBUF_METADATA_UINT32_PTR(m, KEY_OFFSET) = pos;
+
+	return m;
+}
+
+static struct rte_mbuf *
+test_pkt_ipv6(uint32_t pos, uint8_t proto, uint8_t hop_limit)
+{
+	struct rte_mbuf *m = rte_pktmbuf_alloc(pool);
+	struct ether_hdr *eth;
+	struct ipv6_hdr *ip;
+	uint16_t l4_len = (proto == IPPROTO_TCP) ?
+		sizeof(struct tcp_hdr) : sizeof(struct udp_hdr);
+	uint16_t len = sizeof(*eth) + sizeof(*ip) + l4_len + 18;
+
+	if (m == NULL)
+		return NULL;
+
+	eth = (struct ether_hdr *)rte_pktmbuf_append(m, len);
+	memset(eth, 0, len);
+	eth->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv6);
+
+	ip = (struct ipv6_hdr *)&eth[1];
+	ip->vtc_flow = rte_cpu_to_be_32(6 << 28);
+	ip->payload_len = rte_cpu_to_be_16(l4_len + 18);
+	ip->proto = proto;
+	ip->hop_limits = hop_limit;
+	memcpy(ip->src_addr, ipv6_src, 16);
+	memcpy(ip->dst_addr, ipv6_dst, 16);
+
+	if (proto == IPPROTO_TCP) {
+		struct tcp_hdr *tcp = (struct tcp_hdr *)&ip[1];
+
+		tcp->src_port = rte_cpu_to_be_16(1000);
+		tcp->dst_port = rte_cpu_to_be_16(2000);
+		tcp->data_off = 0x50;
+		tcp->cksum = rte_ipv6_udptcp_cksum(ip, tcp);
+	} else {
+		struct udp_hdr *udp = (struct udp_hdr *)&ip[1];
+
+		udp->src_port = rte_cpu_to_be_16(1000);
+		udp->dst_port = rte_cpu_to_be_16(2000);
+		udp->dgram_len = rte_cpu_to_be_16(l4_len + 18);
+		udp->dgram_cksum = rte_ipv6_udptcp_cksum(ip, udp);
+	}
+
+	*RTE_MBUF_METADATA_UINT32_PTR(m, KEY_OFFSET) = pos;
+
+	return m;
+}
+
+/* Push the packets through the pipeline, return the number of output ones */
+static unsigned int
+test_pipeline_run(struct test_pipeline *t,
+	struct rte_mbuf **pkts,
+	unsigned int n_pkts,
+	struct rte_mbuf **pkts_out)
+{
+	unsigned int i;
+
+	for (i = 0; i < n_pkts; i++)
+		if (pkts[i] == NULL ||
+			rte_ring_enqueue(ring_in, pkts[i]) != 0)
+			return 0;
+
+	rte_pipeline_run(t->p);
+	rte_pipeline_flush(t->p);
+
+	return rte_ring_dequeue_burst(ring_out, (void **)pkts_out,
+		BURST_SIZE, NULL);
+}
+
+static int
+test_table_action_profile(void)
+{
+	struct rte_table_action_common_config common = {
+		.ip_version = 1,
+		.ip_offset = IP_OFFSET,
+	};
+	struct rte_table_action_mtr_config mtr = { .n_tc = 0 };
+	struct rte_table_action_nat_config nat = {
+		.source_nat = 1,
+		.proto = IPPROTO_ICMP,
+	};
+	struct rte_table_action_encap_config encap = { .encap_mask = 0 };
+	struct rte_table_action_profile *profile;
+
+	TEST_ASSERT_NULL(rte_table_action_profile_create(NULL),
+		"Profile created without common config");
+
+	profile = rte_table_action_profile_create(&common);
+	TEST_ASSERT_NOT_NULL(profile, "Profile create failed");
+
+	TEST_ASSERT_FAIL(rte_table_action_profile_action_register(profile,
+		RTE_TABLE_ACTION_MTR, &mtr), "Meter with no TC accepted");
+	mtr.n_tc = RTE_TABLE_ACTION_TC_MAX + 1;
+	TEST_ASSERT_FAIL(rte_table_action_profile_action_register(profile,
+		RTE_TABLE_ACTION_MTR, &mtr), "Meter with too many TCs accepted");
+	TEST_ASSERT_FAIL(rte_table_action_profile_action_register(profile,
+		RTE_TABLE_ACTION_MTR, NULL), "Meter without config accepted");
+	TEST_ASSERT_FAIL(rte_table_action_profile_action_register(profile,
+		RTE_TABLE_ACTION_NAT, &nat), "NAT for ICMP accepted");
+	TEST_ASSERT_FAIL(rte_table_action_profile_action_register(profile,
+		RTE_TABLE_ACTION_ENCAP, &encap), "Empty encap mask accepted");
+	TEST_ASSERT_FAIL(rte_table_action_profile_action_register(profile,
+		RTE_TABLE_ACTION_STATS, &nat), "Stats with config accepted");
+
+	TEST_ASSERT_SUCCESS(rte_table_action_profile_action_register(profile,
+		RTE_TABLE_ACTION_STATS, NULL), "Stats register failed");
+	TEST_ASSERT_FAIL(rte_table_action_profile_action_register(profile,
+		RTE_TABLE_ACTION_STATS, NULL), "Stats registered twice");
+
+	TEST_ASSERT_NULL(rte_table_action_create(profile, SOCKET_ID_ANY),
+		"Action created from a profile that is not frozen");
+
+	TEST_ASSERT_SUCCESS(rte_table_action_profile_freeze(profile),
+		"Profile freeze failed");
+	TEST_ASSERT_FAIL(rte_table_action_profile_freeze(profile),
+		"Profile frozen twice");
+	TEST_ASSERT_FAIL(rte_table_action_profile_action_register(profile,
+		RTE_TABLE_ACTION_TIME, NULL), "Register after freeze accepted");
+
+	rte_table_action_profile_free(profile);
+
+	return TEST_SUCCESS;
+}
+
+/* IPv4: TTL decrement, UDP source NAT, VLAN encap, stats and timestamp */
+static int
+test_table_action_ipv4(void)
+{
+	struct rte_table_action_common_config common = {
+		.ip_version = 1,
+		.ip_offset = IP_OFFSET,
+	};
+	struct rte_table_action_encap_config encap = {
+		.encap_mask = (1LLU << RTE_TABLE_ACTION_ENCAP_ETHER) |
+			(1LLU << RTE_TABLE_ACTION_ENCAP_VLAN),
+	};
+	struct rte_table_action_nat_config nat = {
+		.source_nat = 1,
+		.proto = IPPROTO_UDP,
+	};
+	struct rte_table_action_ttl_config ttl = { .drop = 1 };
+	struct rte_table_action_encap_params encap_params = {
+		.type = RTE_TABLE_ACTION_ENCAP_VLAN,
+		.vlan = {
+			.ether = {
+				.da = {{0x00, 0x11, 0x22, 0x33, 0x44, 0x55}},
+				.sa = {{0x00, 0x66, 0x77, 0x88, 0x99, 0xaa}},
+			},
+			.vlan = { .pcp = 5, .dei = 0, .vid = 100 },
+		},
+	};
+	struct rte_table_action_nat_params nat_params = {
+		.ip_version = 1,
+		.addr.ipv4 = IPV4(192, 168, 1, 1),
+		.port = 5000,
+	};
+	struct rte_table_action_ttl_params ttl_params = { .decrement = 1 };
+	struct rte_table_action_stats_params stats_params = { 0, 0 };
+	struct rte_table_action_time_params time_params = { .time = 0 };
+	struct rte_table_action_stats_counters stats;
+	struct rte_table_action_ttl_counters ttl_stats;
+	struct rte_table_action_profile *profile;
+	struct rte_pipeline_table_entry *e0, *e1;
+	struct rte_mbuf *pkts[BURST_SIZE], *out[BURST_SIZE];
+	static uint8_t entry_buf[MAX_ENTRY_SIZE];
+	struct test_pipeline t = { .p = NULL };
+	uint64_t timestamp;
+	unsigned int i, n;
+	int ret = TEST_FAILED;
+
+	profile = rte_table_action_profile_create(&common);
+	TEST_ASSERT_NOT_NULL(profile, "Profile create failed");
+	if (rte_table_action_profile_action_register(profile,
+			RTE_TABLE_ACTION_ENCAP, &encap) ||
+		rte_table_action_profile_action_register(profile,
+			RTE_TABLE_ACTION_NAT, &nat) ||
+		rte_table_action_profile_action_register(profile,
+			RTE_TABLE_ACTION_TTL, &ttl) ||
+		rte_table_action_profile_action_register(profile,
+			RTE_TABLE_ACTION_STATS, NULL) ||
+		rte_table_action_profile_action_register(profile,
+			RTE_TABLE_ACTION_TIME, NULL) ||
+		rte_table_action_profile_freeze(profile) ||
+		test_pipeline_create(&t, profile)) {
+		printf("Pipeline setup failed\n");
+		goto exit;
+	}
+
+	/* Rule 0: all actions, rule 1: same but the packets expire */
+	if (test_fwd_apply(&t, entry_buf) ||
+		rte_table_action_apply(t.action, entry_buf,
+			RTE_TABLE_ACTION_ENCAP, &encap_params) ||
+		rte_table_action_apply(t.action, entry_buf,
+			RTE_TABLE_ACTION_NAT, &nat_params) ||
+		rte_table_action_apply(t.action, entry_buf,
+			RTE_TABLE_ACTION_TTL, &ttl_params) ||
+		rte_table_action_apply(t.action, entry_buf,
+			RTE_TABLE_ACTION_STATS, &stats_params) ||
+		rte_table_action_apply(t.action, entry_buf,
+			RTE_TABLE_ACTION_TIME, &time_params)) {
+		printf("Rule apply failed\n");
+		goto exit;
+	}
+	e0 = test_pipeline_rule_add(&t, 0, entry_buf);
+	e1 = test_pipeline_rule_add(&t, 1, entry_buf);
+	if (e0 == NULL || e1 == NULL) {
+		printf("Rule add failed\n");
+		goto exit;
+	}
+
+	/* Wrong IP version for NAT, encap type not enabled */
+	nat_params.ip_version = 0;
+	encap_params.type = RTE_TABLE_ACTION_ENCAP_MPLS;
+	if (rte_table_action_apply(t.action, entry_buf,
+			RTE_TABLE_ACTION_NAT, &nat_params) == 0 ||
+		rte_table_action_apply(t.action, entry_buf,
+			RTE_TABLE_ACTION_ENCAP, &encap_params) == 0 ||
+		rte_table_action_apply(t.action, entry_buf,
+			RTE_TABLE_ACTION_MTR, &ttl_params) == 0) {
+		printf("Invalid rule apply accepted\n");
+		goto exit;
+	}
+
+	for (i = 0; i < 8; i++)
+		pkts[i] = test_pkt_ipv4(i & 1, IPPROTO_UDP, (i & 1) ? 1 : 64);
+
+	n = test_pipeline_run(&t, pkts, 8, out);
+	if (n != 4) {
+		printf("Expected 4 output packets, got %u\n", n);
+		goto exit;
+	}
+
+	for (i = 0; i < n; i++) {
+		struct ether_hdr *eth = rte_pktmbuf_mtod(out[i],
+			struct ether_hdr *);
+		struct vlan_hdr *vlan = (struct vlan_hdr *)&eth[1];
+		struct ipv4_hdr *ip = (struct ipv4_hdr *)&vlan[1];
+		struct udp_hdr *udp = (struct udp_hdr *)&ip[1];
+
+		if (eth->ether_type != rte_cpu_to_be_16(ETHER_TYPE_VLAN) ||
+			vlan->vlan_tci != rte_cpu_to_be_16((5 << 13) | 100) ||
+			vlan->eth_proto != rte_cpu_to_be_16(ETHER_TYPE_IPv4) ||
+			eth->d_addr.addr_bytes[5] != 0x55 ||
+			out[i]->pkt_len != sizeof(*eth) + sizeof(*vlan) +
+				rte_be_to_cpu_16(ip->total_length)) {
+			printf("Bad VLAN encapsulation\n");
+			goto exit;
+		}
+
+		if (ip->time_to_live != 63 ||
+			ip->src_addr != rte_cpu_to_be_32(IPV4(192, 168, 1, 1)) ||
+			udp->src_port != rte_cpu_to_be_16(5000)) {
+			printf("Bad TTL or NAT update\n");
+			goto exit;
+		}
+
+		/* Both checksums must verify after the incremental updates */
+		if (rte_raw_cksum(ip, sizeof(*ip)) != 0xFFFF ||
+			rte_ipv4_udptcp_cksum(ip, udp) != 0xFFFF) {
+			printf("Bad checksum after update\n");
+			goto exit;
+		}
+	}
+
+	for (i = 0; i < n; i++)
+		rte_pktmbuf_free(out[i]);
+
+	if (rte_table_action_stats_read(t.action, e0, &stats, 1) ||
+		stats.n_packets != 4 ||
+		stats.n_bytes != 4 * (sizeof(struct ipv4_hdr) +
+			sizeof(struct udp_hdr) + 18)) {
+		printf("Bad stats counters\n");
+		goto exit;
+	}
+
+	if (rte_table_action_stats_read(t.action, e0, &stats, 0) ||
+		stats.n_packets != 0) {
+		printf("Stats counters not cleared\n");
+		goto exit;
+	}
+
+	if (rte_table_action_ttl_read(t.action, e1, &ttl_stats, 1) ||
+		ttl_stats.n_packets != 4) {
+		printf("Bad TTL counters\n");
+		goto exit;
+	}
+
+	if (rte_table_action_time_read(t.action, e0, &timestamp) ||
+		timestamp == 0) {
+		printf("Timestamp not updated\n");
+		goto exit;
+	}
+
+	if (rte_table_action_meter_read(t.action, e0, 1, NULL, 1) == 0) {
+		printf("Meter read accepted without meter action\n");
+		goto exit;
+	}
+
+	ret = TEST_SUCCESS;
+
+exit:
+	test_pipeline_free(&t);
+	rte_table_action_profile_free(profile);
+	return ret;
+}
+
+/* IPv6: hop limit decrement, TCP destination NAT, MPLS encap */
+static int
+test_table_action_ipv6(void)
+{
+	struct rte_table_action_common_config common = {
+		.ip_version = 0,
+		.ip_offset = IP_OFFSET,
+	};
+	struct rte_table_action_encap_config encap = {
+		.encap_mask = 1LLU << RTE_TABLE_ACTION_ENCAP_MPLS,
+	};
+	struct rte_table_action_nat_config nat = {
+		.source_nat = 0,
+		.proto = IPPROTO_TCP,
+	};
+	struct rte_table_action_ttl_config ttl = { .drop = 0 };
+	struct rte_table_action_encap_params encap_params = {
+		.type = RTE_TABLE_ACTION_ENCAP_MPLS,
+		.mpls = {
+			.mpls = {
+				{ .label = 100, .tc = 1, .ttl = 64 },
+				{ .label = 200, .tc = 2, .ttl = 32 },
+			},
+			.mpls_count = 2,
+			.unicast = 1,
+		},
+	};
+	struct rte_table_action_nat_params nat_params = {
+		.ip_version = 0,
+		.port = 8080,
+	};
+	struct rte_table_action_ttl_params ttl_params = { .decrement = 1 };
+	struct rte_table_action_profile *profile;
+	struct rte_mbuf *pkts[BURST_SIZE], *out[BURST_SIZE];
+	static uint8_t entry_buf[MAX_ENTRY_SIZE];
+	struct test_pipeline t = { .p = NULL };
+	unsigned int i, n;
+	int ret = TEST_FAILED;
+
+	memcpy(nat_params.addr.ipv6, ipv6_nat, 16);
+
+	profile = rte_table_action_profile_create(&common);
+	TEST_ASSERT_NOT_NULL(profile, "Profile create failed");
+	if (rte_table_action_profile_action_register(profile,
+			RTE_TABLE_ACTION_ENCAP, &encap) ||
+		rte_table_action_profile_action_register(profile,
+			RTE_TABLE_ACTION_NAT, &nat) ||
+		rte_table_action_profile_action_register(profile,
+			RTE_TABLE_ACTION_TTL, &ttl) ||
+		rte_table_action_profile_freeze(profile) ||
+		test_pipeline_create(&t, profile)) {
+		printf("Pipeline setup failed\n");
+		goto exit;
+	}
+
+	if (test_fwd_apply(&t, entry_buf) ||
+		rte_table_action_apply(t.action, entry_buf,
+			RTE_TABLE_ACTION_ENCAP, &encap_params) ||
+		rte_table_action_apply(t.action, entry_buf,
+			RTE_TABLE_ACTION_NAT, &nat_params) ||
+		rte_table_action_apply(t.action, entry_buf,
+			RTE_TABLE_ACTION_TTL, &ttl_params) ||
+		test_pipeline_rule_add(&t, 3, entry_buf) == NULL) {
+		printf("Rule add failed\n");
+		goto exit;
+	}
+
+	/* TTL drop is disabled, so the packets with hop limit 1 go through */
+	for (i = 0; i < 6; i++)
+		pkts[i] = test_pkt_ipv6(3, IPPROTO_TCP, (i & 1) ? 1 : 64);
+
+	n = test_pipeline_run(&t, pkts, 6, out);
+	if (n != 6) {
+		printf("Expected 6 output packets, got %u\n", n);
+		goto exit;
+	}
+
+	for (i = 0; i < n; i++) {
+		struct ether_hdr *eth = rte_pktmbuf_mtod(out[i],
+			struct ether_hdr *);
+		uint32_t *mpls = (uint32_t *)&eth[1];
+		struct ipv6_hdr *ip = (struct ipv6_hdr *)&mpls[2];
+		struct tcp_hdr *tcp = (struct tcp_hdr *)&ip[1];
+
+		if (eth->ether_type != rte_cpu_to_be_16(0x8847) ||
+			mpls[0] != rte_cpu_to_be_32((100 << 12) | (1 << 9) |
+				64) ||
+			mpls[1] != rte_cpu_to_be_32((200 << 12) | (2 << 9) |
+				(1 << 8) | 32)) {
+			printf("Bad MPLS encapsulation\n");
+			goto exit;
+		}
+
+		if (ip->hop_limits != ((i & 1) ? 0 : 63) ||
+			memcmp(ip->dst_addr, ipv6_nat, 16) ||
+			tcp->dst_port != rte_cpu_to_be_16(8080) ||
+			rte_ipv6_udptcp_cksum(ip, tcp) != 0xFFFF) {
+			printf("Bad hop limit or NAT update\n");
+			goto exit;
+		}
+
+		rte_pktmbuf_free(out[i]);
+		out[i] = NULL;
+	}
+
+	ret = TEST_SUCCESS;
+
+exit:
+	test_pipeline_free(&t);
+	rte_table_action_profile_free(profile);
+	return ret;
+}
+
+/* IPv4 packets tunnelled into VXLAN over IPv4 with an outer VLAN tag */
+static int
+test_table_action_vxlan(void)
+{
+	struct rte_table_action_common_config common = {
+		.ip_version = 1,
+		.ip_offset = IP_OFFSET,
+	};
+	struct rte_table_action_encap_config encap = {
+		.encap_mask = 1LLU << RTE_TABLE_ACTION_ENCAP_VXLAN,
+		.vxlan = { .ip_version = 1, .vlan = 1 },
+	};
+	struct rte_table_action_encap_params encap_params = {
+		.type = RTE_TABLE_ACTION_ENCAP_VXLAN,
+		.vxlan = {
+			.vlan = { .vid = 10 },
+			.ipv4 = {
+				.sa = IPV4(1, 1, 1, 1),
+				.da = IPV4(2, 2, 2, 2),
+				.ttl = 64,
+			},
+			.udp = { .sp = 4000, .dp = 4789 },
+			.vni = 0x123456,
+		},
+	};
+	struct rte_table_action_profile *profile;
+	struct rte_mbuf *pkts[BURST_SIZE], *out[BURST_SIZE];
+	static uint8_t entry_buf[MAX_ENTRY_SIZE];
+	struct test_pipeline t = { .p = NULL };
+	uint32_t inner_len = 0;
+	unsigned int i, n;
+	int ret = TEST_FAILED;
+
+	profile = rte_table_action_profile_create(&common);
+	TEST_ASSERT_NOT_NULL(profile, "Profile create failed");
+	if (rte_table_action_profile_action_register(profile,
+			RTE_TABLE_ACTION_ENCAP, &encap) ||
+		rte_table_action_profile_freeze(profile) ||
+		test_pipeline_create(&t, profile)) {
+		printf("Pipeline setup failed\n");
+		goto exit;
+	}
+
+	if (test_fwd_apply(&t, entry_buf) ||
+		rte_table_action_apply(t.action, entry_buf,
+			RTE_TABLE_ACTION_ENCAP, &encap_params) ||
+		test_pipeline_rule_add(&t, 2, entry_buf) == NULL) {
+		printf("Rule add failed\n");
+		goto exit;
+	}
+
+	for (i = 0; i < 5; i++) {
+		pkts[i] = test_pkt_ipv4(2, IPPROTO_UDP, 64);
+		if (pkts[i])
+			inner_len = pkts[i]->pkt_len;
+	}
+
+	n = test_pipeline_run(&t, pkts, 5, out);
+	if (n != 5) {
+		printf("Expected 5 output packets, got %u\n", n);
+		goto exit;
+	}
+
+	for (i = 0; i < n; i++) {
+		struct ether_hdr *eth = rte_pktmbuf_mtod(out[i],
+			struct ether_hdr *);
+		struct vlan_hdr *vlan = (struct vlan_hdr *)&eth[1];
+		struct ipv4_hdr *ip = (struct ipv4_hdr *)&vlan[1];
+		struct udp_hdr *udp = (struct udp_hdr *)&ip[1];
+		struct vxlan_hdr *vxlan = (struct vxlan_hdr *)&udp[1];
+		struct ether_hdr *inner = (struct ether_hdr *)&vxlan[1];
+		uint32_t outer_len = sizeof(*eth) + sizeof(*vlan) +
+			sizeof(*ip) + sizeof(*udp) + sizeof(*vxlan);
+
+		if (out[i]->pkt_len != inner_len + outer_len ||
+			out[i]->data_len != out[i]->pkt_len ||
+			rte_be_to_cpu_16(ip->total_length) !=
+				inner_len + outer_len - sizeof(*eth) -
+				sizeof(*vlan) ||
+			rte_be_to_cpu_16(udp->dgram_len) !=
+				inner_len + sizeof(*udp) + sizeof(*vxlan) ||
+			udp->dst_port != rte_cpu_to_be_16(4789) ||
+			vxlan->vx_vni != rte_cpu_to_be_32(0x123456 << 8) ||
+			inner->ether_type !=
+				rte_cpu_to_be_16(ETHER_TYPE_IPv4)) {
+			printf("Bad VXLAN encapsulation\n");
+			goto exit;
+		}
+
+		if (rte_raw_cksum(ip, sizeof(*ip)) != 0xFFFF) {
+			printf("Bad outer IPv4 checksum\n");
+			goto exit;
+		}
+
+		rte_pktmbuf_free(out[i]);
+		out[i] = NULL;
+	}
+
+	ret = TEST_SUCCESS;
+
+exit:
+	test_pipeline_free(&t);
+	rte_table_action_profile_free(profile);
+	return ret;
+}
+
+/* trTCM with tiny buckets: the first packet is green, the rest turn red and
+ * are dropped by the policer.
+ */
+static int
+test_table_action_meter(void)
+{
+	struct rte_table_action_common_config common = {
+		.ip_version = 1,
+		.ip_offset = IP_OFFSET,
+	};
+	struct rte_table_action_mtr_config mtr = { .n_tc = 2 };
+	struct rte_meter_trtcm_params meter = {
+		.cir = 1,
+		.pir = 1,
+		.cbs = 64,
+		.pbs = 64,
+	};
+	struct rte_table_action_mtr_params mtr_params;
+	struct rte_table_action_mtr_counters counters;
+	struct rte_table_action_dscp_table dscp_table;
+	struct rte_table_action_profile *profile;
+	struct rte_pipeline_table_entry *e;
+	struct rte_mbuf *pkts[BURST_SIZE], *out[BURST_SIZE];
+	static uint8_t entry_buf[MAX_ENTRY_SIZE];
+	struct test_pipeline t = { .p = NULL };
+	unsigned int i, n;
+	int ret = TEST_FAILED;
+
+	memset(&mtr_params, 0, sizeof(mtr_params));
+	for (i = 0; i < mtr.n_tc; i++) {
+		struct rte_table_action_mtr_tc_params *tc = &mtr_params.mtr[i];
+
+		tc->meter_profile_id = 7;
+		tc->policer[e_RTE_METER_GREEN] =
+			RTE_TABLE_ACTION_POLICER_COLOR_GREEN;
+		tc->policer[e_RTE_METER_YELLOW] =
+			RTE_TABLE_ACTION_POLICER_COLOR_YELLOW;
+		tc->policer[e_RTE_METER_RED] = RTE_TABLE_ACTION_POLICER_DROP;
+	}
+	mtr_params.tc_mask = 0x3;
+
+	memset(&dscp_table, 0, sizeof(dscp_table));
+	dscp_table.entry[0].tc_id = 1;
+	dscp_table.entry[0].color = e_RTE_METER_GREEN;
+
+	profile = rte_table_action_profile_create(&common);
+	TEST_ASSERT_NOT_NULL(profile, "Profile create failed");
+	if (rte_table_action_profile_action_register(profile,
+			RTE_TABLE_ACTION_MTR, &mtr) ||
+		rte_table_action_profile_freeze(profile) ||
+		test_pipeline_create(&t, profile)) {
+		printf("Pipeline setup failed\n");
+		goto exit;
+	}
+
+	if (test_fwd_apply(&t, entry_buf) ||
+		rte_table_action_apply(t.action, entry_buf,
+			RTE_TABLE_ACTION_MTR, &mtr_params) == 0) {
+		printf("Rule with unknown meter profile accepted\n");
+		goto exit;
+	}
+
+	if (rte_table_action_meter_profile_add(t.action, 7, &meter) ||
+		rte_table_action_meter_profile_add(t.action, 7, &meter) == 0) {
+		printf("Meter profile add failed\n");
+		goto exit;
+	}
+
+	dscp_table.entry[1].tc_id = 2;
+	if (rte_table_action_dscp_table_update(t.action, 0x2,
+			&dscp_table) == 0) {
+		printf("DSCP entry with invalid TC accepted\n");
+		goto exit;
+	}
+
+	if (rte_table_action_dscp_table_update(t.action, 0x1, &dscp_table)) {
+		printf("DSCP table update failed\n");
+		goto exit;
+	}
+
+	if (test_fwd_apply(&t, entry_buf) ||
+		rte_table_action_apply(t.action, entry_buf,
+			RTE_TABLE_ACTION_MTR, &mtr_params)) {
+		printf("Rule apply failed\n");
+		goto exit;
+	}
+
+	e = test_pipeline_rule_add(&t, 5, entry_buf);
+	if (e == NULL) {
+		printf("Rule add failed\n");
+		goto exit;
+	}
+
+	/* All packets have DSCP 0, so they are metered on TC 1 */
+	for (i = 0; i < 8; i++)
+		pkts[i] = test_pkt_ipv4(5, IPPROTO_UDP, 64);
+
+	n = test_pipeline_run(&t, pkts, 8, out);
+	for (i = 0; i < n; i++)
+		rte_pktmbuf_free(out[i]);
+	if (n != 1) {
+		printf("Expected 1 output packet, got %u\n", n);
+		goto exit;
+	}
+
+	if (rte_table_action_meter_read(t.action, e, 0x3, &counters, 1) ||
+		counters.stats[0].n_packets[e_RTE_METER_GREEN] != 0 ||
+		counters.stats[0].n_packets_drop != 0 ||
+		counters.stats[1].n_packets[e_RTE_METER_GREEN] != 1 ||
+		counters.stats[1].n_packets[e_RTE_METER_YELLOW] != 0 ||
+		counters.stats[1].n_packets_drop != 7) {
+		printf("Bad meter counters\n");
+		goto exit;
+	}
+
+	if (rte_table_action_meter_read(t.action, e, 0x3, &counters, 0) ||
+		counters.stats[1].n_packets_drop != 0) {
+		printf("Meter counters not cleared\n");
+		goto exit;
+	}
+
+	if (rte_table_action_meter_read(t.action, e, 0x4, NULL, 0) == 0) {
+		printf("Meter read of unconfigured TC accepted\n");
+		goto exit;
+	}
+
+	if (rte_table_action_meter_profile_delete(t.action, 7) ||
+		rte_table_action_meter_profile_delete(t.action, 7) == 0) {
+		printf("Meter profile delete failed\n");
+		goto exit;
+	}
+
+	ret = TEST_SUCCESS;
+
+exit:
+	test_pipeline_free(&t);
+	rte_table_action_profile_free(profile);
+	return ret;
+}
+
+static int
+test_table_action_setup(void)
+{
+	if (pool == NULL) {
+		pool = rte_pktmbuf_pool_create("table_action_pool", NB_MBUF,
+			32, 0, RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+		if (pool == NULL)
+			return TEST_FAILED;
+	}
+
+	if (ring_in == NULL) {
+		ring_in = rte_ring_create("table_action_in", 64,
+			SOCKET_ID_ANY, RING_F_SP_ENQ | RING_F_SC_DEQ);
+		ring_out = rte_ring_create("table_action_out", 64,
+			SOCKET_ID_ANY, RING_F_SP_ENQ | RING_F_SC_DEQ);
+		if (ring_in == NULL || ring_out == NULL)
+			return TEST_FAILED;
+	}
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite table_action_testsuite = {
+	.suite_name = "table action unit test suite",
+	.setup = test_table_action_setup,
+	.unit_test_cases = {
+		TEST_CASE(test_table_action_profile),
+		TEST_CASE(test_table_action_ipv4),
+		TEST_CASE(test_table_action_ipv6),
+		TEST_CASE(test_table_action_vxlan),
+		TEST_CASE(test_table_action_meter),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_table_action(void)
+{
+	return unit_test_suite_runner(&table_action_testsuite);
+}
+
+REGISTER_TEST_COMMAND(table_action_autotest, test_table_action);
@@ -0,0 +1,691 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_meter.h>
+#include <rte_random.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
+#include <rte_pipeline.h>
+#include <rte_table_action.h>
+
+#include "test.h"
+
+/*
+ * Compares the table action handler against the hand-written action handlers
+ * of the ip_pipeline example back-ends it replaces:
+ *  - flow_actions: trTCM metering and policing per traffic class;
+ *  - routing: Ethernet QinQ encapsulation using the pre-computed slabs;
+ *  - both of the above applied to the same burst, as done by a pipeline with
+ *    two chained tables, versus a single profile with both actions.
+ * The action handlers are called directly on the same packet bursts, with the
+ * table entries picked randomly out of a large set, so the lookup cost is left
+ * out and the cache behavior of the entry data is accounted for.
+ */
+
+#define BURST_SIZE          64
+#define N_ENTRIES           (1 << 14)
+#define N_BURSTS            1024
+#define N_ITERATIONS        (1 << 16)
+#define N_TC                4
+
+#define IP_OFFSET           (sizeof(struct rte_mbuf) + \
+				RTE_PKTMBUF_HEADROOM + sizeof(struct ether_hdr))
+
+static struct rte_mempool *pool;
+static struct rte_pipeline *pipeline;
+static struct rte_mbuf *pkts[BURST_SIZE];
+static uint32_t burst_pos[N_BURSTS][BURST_SIZE];
+static struct rte_pipeline_table_entry *burst_entries[N_BURSTS][BURST_SIZE];
+
+static struct rte_meter_trtcm_params meter_params = {
+	.cir = 1000000000000ULL,
+	.pir = 1000000000000ULL,
+	.cbs = 1 << 30,
+	.pbs = 1 << 30,
+};
+
+/*
+ * flow_actions back-end (examples/ip_pipeline/pipeline_flow_actions_be.c)
+ */
+struct fa_policer_action {
+	uint32_t drop;
+	enum rte_meter_color color;
+};
+
+struct fa_policer_params {
+	struct fa_policer_action action[e_RTE_METER_COLORS];
+};
+
+struct fa_policer_stats {
+	uint64_t n_pkts[e_RTE_METER_COLORS];
+	uint64_t n_pkts_drop;
+};
+
+struct fa_meter_policer {
+	struct rte_meter_trtcm meter;
+	struct fa_policer_params policer;
+	struct fa_policer_stats stats;
+};
+
+struct fa_table_entry {
+	struct rte_pipeline_table_entry head;
+	struct fa_meter_policer mp[N_TC];
+};
+
+struct fa_dscp_entry {
+	uint32_t traffic_class;
+	enum rte_meter_color color;
+};
+
+struct fa_pipeline {
+	uint32_t ip_hdr_offset;
+	uint32_t color_offset;
+	struct fa_dscp_entry dscp[64];
+};
+
+static struct fa_pipeline fa;
+
+static inline uint64_t
+fa_pkt_work(struct rte_mbuf *pkt,
+	struct rte_pipeline_table_entry *table_entry,
+	void *arg,
+	uint64_t time)
+{
+	struct fa_pipeline *p = arg;
+	struct fa_table_entry *entry = (struct fa_table_entry *) table_entry;
+
+	struct ipv4_hdr *pkt_ip = (struct ipv4_hdr *)
+		RTE_MBUF_METADATA_UINT32_PTR(pkt, p->ip_hdr_offset);
+	enum rte_meter_color *pkt_color = (enum rte_meter_color *)
+		RTE_MBUF_METADATA_UINT32_PTR(pkt, p->color_offset);
+
+	/* Read (IP header) */
+	uint32_t total_length = rte_bswap16(pkt_ip->total_length);
+	uint32_t dscp = pkt_ip->type_of_service >> 2;
+
+	uint32_t tc = p->dscp[dscp].traffic_class;
+	enum rte_meter_color color = p->dscp[dscp].color;
+
+	struct rte_meter_trtcm *meter = &entry->mp[tc].meter;
+	struct fa_policer_params *policer = &entry->mp[tc].policer;
+	struct fa_policer_stats *stats = &entry->mp[tc].stats;
+
+	/* Read (entry), compute */
+	enum rte_meter_color color2 = rte_meter_trtcm_color_aware_check(meter,
+		time,
+		total_length,
+		color);
+
+	enum rte_meter_color color3 = policer->action[color2].color;
+	uint64_t drop = policer->action[color2].drop;
+
+	/* Read (entry), write (entry, color) */
+	stats->n_pkts[color3] += drop ^ 1LLU;
+	stats->n_pkts_drop += drop;
+	*pkt_color = color3;
+
+	return drop;
+}
+
+static int
+fa_table_ah_hit(struct rte_pipeline *p,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	struct rte_pipeline_table_entry **entries,
+	void *arg)
+{
+	uint64_t pkts_out_mask = pkts_mask;
+	uint64_t n_pkts = __builtin_popcountll(pkts_mask);
+	uint64_t time = rte_rdtsc();
+	uint32_t i;
+
+	for (i = 0; i < n_pkts; i++) {
+		uint64_t mask = fa_pkt_work(pkts[i], entries[i], arg, time);
+
+		pkts_out_mask ^= mask << i;
+	}
+
+	rte_pipeline_ah_packet_drop(p, pkts_out_mask ^ pkts_mask);
+
+	return 0;
+}
+
+static void
+fa_entry_init(struct fa_table_entry *entry)
+{
+	uint32_t i, j;
+
+	memset(entry, 0, sizeof(*entry));
+	entry->head.action = RTE_PIPELINE_ACTION_PORT;
+
+	for (i = 0; i < N_TC; i++) {
+		rte_meter_trtcm_config(&entry->mp[i].meter,
+			&meter_params);
+
+		for (j = 0; j < e_RTE_METER_COLORS; j++) {
+			entry->mp[i].policer.action[j].drop = 0;
+			entry->mp[i].policer.action[j].color =
+				(enum rte_meter_color) j;
+		}
+	}
+}
+
+/*
+ * routing back-end (examples/ip_pipeline/pipeline_routing_be.c), Ethernet QinQ
+ * encapsulation with static MAC addresses (no ARP)
+ */
+struct rt_table_entry {
+	struct rte_pipeline_table_entry head;
+	uint32_t flags;
+	uint32_t port_id;
+	uint32_t ip;
+
+	uint16_t data_offset;
+	uint16_t ether_l2_length;
+	uint64_t slab[4];
+	uint16_t slab_offset[4];
+};
+
+struct rt_layout {
+	uint16_t a;
+	uint32_t b;
+	uint16_t c;
+} __attribute__((__packed__));
+
+#define MACADDR_DST_WRITE(slab_ptr, slab)				\
+{									\
+	struct rt_layout *dst = (struct rt_layout *) (slab_ptr);	\
+	struct rt_layout *src = (struct rt_layout *) &(slab);		\
+									\
+	dst->b = src->b;						\
+	dst->c = src->c;						\
+}
+
+#define SLAB_NBO_MACADDRSRC_ETHERTYPE(macaddr, ethertype)		\
+	(((uint64_t) macaddr) | (((uint64_t) rte_cpu_to_be_16(ethertype)) << 48))
+
+static inline void
+rt_pkt_work(struct rte_mbuf *pkt,
+	struct rte_pipeline_table_entry *table_entry,
+	void *arg __rte_unused)
+{
+	struct rt_table_entry *entry = (struct rt_table_entry *) table_entry;
+	struct ipv4_hdr *ip = (struct ipv4_hdr *)
+		RTE_MBUF_METADATA_UINT8_PTR(pkt, IP_OFFSET);
+	uint64_t *slab0_ptr, *slab1_ptr, *slab2_ptr;
+	uint16_t total_length, data_offset, ether_l2_length;
+
+	/* Read */
+	total_length = rte_bswap16(ip->total_length);
+	data_offset = entry->data_offset;
+	ether_l2_length = entry->ether_l2_length;
+	slab0_ptr = RTE_MBUF_METADATA_UINT64_PTR(pkt, entry->slab_offset[0]);
+	slab1_ptr = RTE_MBUF_METADATA_UINT64_PTR(pkt, entry->slab_offset[1]);
+	slab2_ptr = RTE_MBUF_METADATA_UINT64_PTR(pkt, entry->slab_offset[2]);
+
+	/* Compute */
+	total_length += ether_l2_length;
+
+	/* Write */
+	pkt->data_off = data_offset;
+	pkt->data_len = total_length;
+	pkt->pkt_len = total_length;
+
+	*slab0_ptr = entry->slab[0];
+	*slab1_ptr = entry->slab[1];
+	MACADDR_DST_WRITE(slab2_ptr, entry->slab[2]);
+}
+
+static int
+rt_table_ah_hit(struct rte_pipeline *p __rte_unused,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	struct rte_pipeline_table_entry **entries,
+	void *arg)
+{
+	uint64_t n_pkts = __builtin_popcountll(pkts_mask);
+	uint32_t i;
+
+	for (i = 0; i < n_pkts; i++)
+		rt_pkt_work(pkts[i], entries[i], arg);
+
+	return 0;
+}
+
+static void
+rt_entry_init(struct rt_table_entry *entry)
+{
+	uint64_t macaddr_dst = 0x0000554433221100ULL;
+	uint64_t macaddr_src = 0x0000aa9988776600ULL;
+	uint64_t svlan = 100, cvlan = 200;
+
+	memset(entry, 0, sizeof(*entry));
+	entry->head.action = RTE_PIPELINE_ACTION_PORT;
+
+	entry->slab[0] = rte_bswap64((svlan << 48) |
+		(((uint64_t) ETHER_TYPE_VLAN) << 32) |
+		(cvlan << 16) |
+		ETHER_TYPE_IPv4);
+	entry->slab_offset[0] = IP_OFFSET - 8;
+
+	entry->slab[1] =
+		SLAB_NBO_MACADDRSRC_ETHERTYPE(macaddr_src, ETHER_TYPE_QINQ);
+	entry->slab_offset[1] = IP_OFFSET - 2 * 8;
+
+	entry->slab[2] = rte_bswap64(macaddr_dst);
+	entry->slab_offset[2] = IP_OFFSET - 3 * 8;
+
+	entry->data_offset = entry->slab_offset[2] + 2 -
+		sizeof(struct rte_mbuf);
+	entry->ether_l2_length = 22;
+}
+
+/* Both back-ends chained on the same burst (two tables in a row) */
+static int
+fa_rt_table_ah_hit(struct rte_pipeline *p,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	struct rte_pipeline_table_entry **entries,
+	void *arg __rte_unused)
+{
+	struct rte_pipeline_table_entry *fa_entries[BURST_SIZE];
+	struct rte_pipeline_table_entry *rt_entries[BURST_SIZE];
+	uint32_t i;
+
+	for (i = 0; i < BURST_SIZE; i++) {
+		fa_entries[i] = entries[i];
+		rt_entries[i] = (struct rte_pipeline_table_entry *)
+			&((struct fa_table_entry *) entries[i])[1];
+	}
+
+	fa_table_ah_hit(p, pkts, pkts_mask, fa_entries, &fa);
+	rt_table_ah_hit(p, pkts, pkts_mask, rt_entries, NULL);
+
+	return 0;
+}
+
+/*
+ * Table action
+ */
+static struct rte_table_action *
+ta_create(uint64_t action_mask)
+{
+	struct rte_table_action_common_config common = {
+		.ip_version = 1,
+		.ip_offset = IP_OFFSET,
+	};
+	struct rte_table_action_mtr_config mtr = { .n_tc = N_TC };
+	struct rte_table_action_encap_config encap = {
+		.encap_mask = 1LLU << RTE_TABLE_ACTION_ENCAP_QINQ,
+	};
+	struct rte_table_action_dscp_table dscp_table;
+	struct rte_table_action_profile *profile;
+	struct rte_table_action *action = NULL;
+	uint32_t i;
+
+	profile = rte_table_action_profile_create(&common);
+	if (profile == NULL)
+		return NULL;
+
+	if ((action_mask & (1LLU << RTE_TABLE_ACTION_MTR)) &&
+		rte_table_action_profile_action_register(profile,
+			RTE_TABLE_ACTION_MTR, &mtr))
+		goto exit;
+
+	if ((action_mask & (1LLU << RTE_TABLE_ACTION_ENCAP)) &&
+		rte_table_action_profile_action_register(profile,
+			RTE_TABLE_ACTION_ENCAP, &encap))
+		goto exit;
+
+	if (rte_table_action_profile_freeze(profile))
+		goto exit;
+
+	action = rte_table_action_create(profile, 0);
+	if (action == NULL)
+		goto exit;
+
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_MTR)) {
+		if (rte_table_action_meter_profile_add(action, 0,
+				&meter_params)) {
+			rte_table_action_free(action);
+			action = NULL;
+			goto exit;
+		}
+
+		for (i = 0; i < RTE_TABLE_ACTION_DSCP_MAX; i++) {
+			dscp_table.entry[i].tc_id = fa.dscp[i].traffic_class;
+			dscp_table.entry[i].color = fa.dscp[i].color;
+		}
+
+		if (rte_table_action_dscp_table_update(action, UINT64_MAX,
+				&dscp_table)) {
+			rte_table_action_free(action);
+			action = NULL;
+		}
+	}
+
+exit:
+	rte_table_action_profile_free(profile);
+	return action;
+}
+
+static int
+ta_entry_init(struct rte_table_action *action,
+	uint64_t action_mask,
+	void *entry)
+{
+	struct rte_table_action_fwd_params fwd = {
+		.action = RTE_PIPELINE_ACTION_PORT,
+		.id = 0,
+	};
+	struct rte_table_action_mtr_params mtr;
+	struct rte_table_action_encap_params encap = {
+		.type = RTE_TABLE_ACTION_ENCAP_QINQ,
+		.qinq = {
+			.ether = {
+				.da = {{0x00, 0x11, 0x22, 0x33, 0x44, 0x55}},
+				.sa = {{0x00, 0x66, 0x77, 0x88, 0x99, 0xaa}},
+			},
+			.svlan = { .vid = 100 },
+			.cvlan = { .vid = 200 },
+		},
+	};
+	uint32_t i, j;
+
+	if (rte_table_action_apply(action, entry, RTE_TABLE_ACTION_FWD, &fwd))
+		return -1;
+
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_MTR)) {
+		memset(&mtr, 0, sizeof(mtr));
+		mtr.tc_mask = RTE_LEN2MASK(N_TC, uint32_t);
+		for (i = 0; i < N_TC; i++) {
+			mtr.mtr[i].meter_profile_id = 0;
+			for (j = 0; j < e_RTE_METER_COLORS; j++)
+				mtr.mtr[i].policer[j] =
+					(enum rte_table_action_policer) j;
+		}
+
+		if (rte_table_action_apply(action, entry,
+				RTE_TABLE_ACTION_MTR, &mtr))
+			return -1;
+	}
+
+	if ((action_mask & (1LLU << RTE_TABLE_ACTION_ENCAP)) &&
+		rte_table_action_apply(action, entry,
+			RTE_TABLE_ACTION_ENCAP, &encap))
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Benchmark
+ */
+static void
+pkts_init(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < BURST_SIZE; i++) {
+		struct rte_mbuf *m = pkts[i];
+		struct ether_hdr *eth;
+		struct ipv4_hdr *ip;
+		struct udp_hdr *udp;
+		uint16_t len = sizeof(*eth) + sizeof(*ip) + sizeof(*udp) + 22;
+
+		rte_pktmbuf_reset(m);
+		eth = (struct ether_hdr *) rte_pktmbuf_append(m, len);
+		memset(eth, 0, len);
+		eth->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+
+		ip = (struct ipv4_hdr *) &eth[1];
+		ip->version_ihl = 0x45;
+		ip->type_of_service = (rte_rand() & 0x3F) << 2;
+		ip->total_length = rte_cpu_to_be_16(len - sizeof(*eth));
+		ip->time_to_live = 64;
+		ip->next_proto_id = IPPROTO_UDP;
+		ip->hdr_checksum = rte_ipv4_cksum(ip);
+
+		udp = (struct udp_hdr *) &ip[1];
+		udp->dgram_len = rte_cpu_to_be_16(sizeof(*udp) + 22);
+	}
+}
+
+static void
+bursts_init(uint8_t *entries_mem, size_t entry_size)
+{
+	uint32_t i, j;
+
+	for (i = 0; i < N_BURSTS; i++)
+		for (j = 0; j < BURST_SIZE; j++)
+			burst_entries[i][j] = (struct rte_pipeline_table_entry *)
+				&entries_mem[burst_pos[i][j] * entry_size];
+}
+
+static double
+run(rte_pipeline_table_action_handler_hit f_action_hit, void *arg)
+{
+	uint64_t start, cycles;
+	uint32_t i;
+
+	pkts_init();
+
+	/* Warm up */
+	for (i = 0; i < N_BURSTS; i++)
+		f_action_hit(pipeline, pkts, UINT64_MAX, burst_entries[i], arg);
+
+	start = rte_rdtsc();
+	for (i = 0; i < N_ITERATIONS; i++)
+		f_action_hit(pipeline, pkts, UINT64_MAX,
+			burst_entries[i & (N_BURSTS - 1)], arg);
+	cycles = rte_rdtsc() - start;
+
+	return (double) cycles / (N_ITERATIONS * BURST_SIZE);
+}
+
+static int
+run_table_action(uint64_t action_mask, double *cycles)
+{
+	struct rte_pipeline_table_params params;
+	struct rte_table_action *action;
+	uint8_t *entries_mem;
+	size_t entry_size;
+	uint32_t i;
+
+	action = ta_create(action_mask);
+	if (action == NULL)
+		return -1;
+
+	if (rte_table_action_table_params_get(action, &params)) {
+		rte_table_action_free(action);
+		return -1;
+	}
+
+	entry_size = RTE_ALIGN_CEIL(sizeof(struct rte_pipeline_table_entry) +
+		params.action_data_size, sizeof(uint64_t));
+	entries_mem = rte_zmalloc(NULL, N_ENTRIES * entry_size,
+		RTE_CACHE_LINE_SIZE);
+	if (entries_mem == NULL) {
+		rte_table_action_free(action);
+		return -1;
+	}
+
+	/* Configure the meter once, then replicate it to all the entries */
+	if (ta_entry_init(action, action_mask, entries_mem)) {
+		rte_free(entries_mem);
+		rte_table_action_free(action);
+		return -1;
+	}
+	for (i = 1; i < N_ENTRIES; i++)
+		memcpy(&entries_mem[i * entry_size], entries_mem, entry_size);
+
+	bursts_init(entries_mem, entry_size);
+	*cycles = run(params.f_action_hit, params.arg_ah);
+
+	rte_free(entries_mem);
+	rte_table_action_free(action);
+
+	return 0;
+}
+
+static int
+run_ip_pipeline(int fa_enabled, int rt_enabled, double *cycles)
+{
+	rte_pipeline_table_action_handler_hit f_action_hit;
+	uint8_t *entries_mem;
+	size_t entry_size = 0;
+	void *arg = NULL;
+	uint32_t i;
+
+	if (fa_enabled)
+		entry_size += sizeof(struct fa_table_entry);
+	if (rt_enabled)
+		entry_size += sizeof(struct rt_table_entry);
+
+	entries_mem = rte_zmalloc(NULL, N_ENTRIES * entry_size,
+		RTE_CACHE_LINE_SIZE);
+	if (entries_mem == NULL)
+		return -1;
+
+	if (fa_enabled && rt_enabled) {
+		fa_entry_init((struct fa_table_entry *) entries_mem);
+		rt_entry_init((struct rt_table_entry *)
+			&((struct fa_table_entry *) entries_mem)[1]);
+		f_action_hit = fa_rt_table_ah_hit;
+	} else if (fa_enabled) {
+		fa_entry_init((struct fa_table_entry *) entries_mem);
+		f_action_hit = fa_table_ah_hit;
+		arg = &fa;
+	} else {
+		rt_entry_init((struct rt_table_entry *) entries_mem);
+		f_action_hit = rt_table_ah_hit;
+	}
+
+	for (i = 1; i < N_ENTRIES; i++)
+		memcpy(&entries_mem[i * entry_size], entries_mem, entry_size);
+
+	bursts_init(entries_mem, entry_size);
+	*cycles = run(f_action_hit, arg);
+
+	rte_free(entries_mem);
+
+	return 0;
+}
+
+static int
+test_table_action_perf(void)
+{
+	static const struct {
+		const char *name;
+		uint64_t action_mask;
+		int fa;
+		int rt;
+	} tests[] = {
+		{"trTCM meter + policer",
+			1LLU << RTE_TABLE_ACTION_MTR, 1, 0},
+		{"QinQ encap",
+			1LLU << RTE_TABLE_ACTION_ENCAP, 0, 1},
+		{"meter + QinQ encap",
+			(1LLU << RTE_TABLE_ACTION_MTR) |
+			(1LLU << RTE_TABLE_ACTION_ENCAP), 1, 1},
+	};
+	struct rte_pipeline_params pipeline_params = {
+		.name = "table_action_perf",
+		.socket_id = 0,
+		.offset_port_id = 0,
+	};
+	uint32_t i, j;
+	int ret = -1;
+
+	pool = rte_pktmbuf_pool_create("table_action_perf_pool",
+		BURST_SIZE * 2, 0, 0, RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	pipeline = rte_pipeline_create(&pipeline_params);
+	if (pool == NULL || pipeline == NULL) {
+		printf("Setup failed\n");
+		goto exit;
+	}
+
+	if (rte_pktmbuf_alloc_bulk(pool, pkts, BURST_SIZE)) {
+		printf("Packet allocation failed\n");
+		goto exit;
+	}
+
+	fa.ip_hdr_offset = IP_OFFSET;
+	fa.color_offset = sizeof(struct rte_mbuf);
+	for (i = 0; i < RTE_DIM(fa.dscp); i++) {
+		fa.dscp[i].traffic_class = i & (N_TC - 1);
+		fa.dscp[i].color = e_RTE_METER_GREEN;
+	}
+
+	for (i = 0; i < N_BURSTS; i++)
+		for (j = 0; j < BURST_SIZE; j++)
+			burst_pos[i][j] = rte_rand() & (N_ENTRIES - 1);
+
+	printf("\nCycles per packet, %u entries, bursts of %u packets\n",
+		N_ENTRIES, BURST_SIZE);
+	printf("%-24s%16s%16s\n", "Actions", "ip_pipeline", "table action");
+
+	for (i = 0; i < RTE_DIM(tests); i++) {
+		double ref, ta;
+
+		if (run_ip_pipeline(tests[i].fa, tests[i].rt, &ref) ||
+			run_table_action(tests[i].action_mask, &ta)) {
+			printf("Test %s failed\n", tests[i].name);
+			goto exit;
+		}
+
+		printf("%-24s%16.1f%16.1f\n", tests[i].name, ref, ta);
+	}
+
+	ret = 0;
+
+exit:
+	for (i = 0; i < BURST_SIZE; i++)
+		rte_pktmbuf_free(pkts[i]);
+	if (pipeline)
+		rte_pipeline_free(pipeline);
+	rte_mempool_free(pool);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(table_action_perf_autotest, test_table_action_perf);
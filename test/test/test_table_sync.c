@@ -0,0 +1,601 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+#include <rte_cycles.h>
+#include <rte_ip.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_table_hash.h>
+#include <rte_table_lpm.h>
+#include <rte_table_lpm_ipv6.h>
+#include <rte_table_wildcard.h>
+#ifdef RTE_LIBRTE_ACL
+#include <rte_table_acl.h>
+#endif
+
+#include "test.h"
+
+/*
+ * Table update while the table is looked up: the writer lcore keeps adding
+ * and deleting keys, while the master lcore looks up bursts mixing these
+ * keys with keys that are never changed. The latter must always be found,
+ * with the right data.
+ */
+
+#define N_KEYS_STABLE_MAX		64
+#define N_KEYS_CHURN			64
+#define N_KEYS_MAX			(N_KEYS_STABLE_MAX + N_KEYS_CHURN)
+#define BURST_SIZE			64
+#define BURST_STABLE			48
+
+#define N_BURSTS_MIN			2000
+#define N_UPDATES_MIN			500
+#define N_UPDATES_MIN_SLOW		50
+#define TIMEOUT_S			30
+
+#define PKT_SIZE			256
+#define META_OFFSET			(sizeof(struct rte_mbuf))
+#define ACL_OFFSET			META_OFFSET
+#define LPM_OFFSET			(META_OFFSET + 4)
+#define LPM6_OFFSET			(META_OFFSET + 16)
+#define HASH_OFFSET			(META_OFFSET + 32)
+
+#define ENTRY_VALUE(id)			(0xC0FFEE0000000000LLU | (id))
+
+#define HASH_N_KEYS_LRU			64
+#define HASH_N_KEYS_EXT			128
+#define HASH_N_BUCKETS			16
+
+struct sync_test_key {
+	union {
+		uint8_t hash[32];
+		struct rte_table_lpm_key lpm;
+		struct rte_table_lpm_ipv6_key lpm6;
+		struct rte_table_wildcard_rule_add_params wildcard_add;
+#ifdef RTE_LIBRTE_ACL
+		struct rte_table_acl_rule_add_params acl_add;
+#endif
+	};
+	struct rte_table_wildcard_rule_delete_params wildcard_delete;
+#ifdef RTE_LIBRTE_ACL
+	struct rte_table_acl_rule_delete_params acl_delete;
+#endif
+	void *key_delete;
+};
+
+struct sync_test_table;
+
+typedef void (*sync_test_key_set)(struct sync_test_table *tt, uint32_t id,
+	struct sync_test_key *key, uint8_t *pkt_meta);
+
+struct sync_test_table {
+	const char *name;
+	struct rte_table_ops *ops;
+	void *params;
+	sync_test_key_set f_key;
+	uint32_t n_keys_stable;
+	uint32_t n_updates_min;
+
+	/* Runtime */
+	void *table;
+	volatile int stop;
+	volatile uint64_t n_updates;
+	int status;
+	struct sync_test_key keys[N_KEYS_MAX];
+};
+
+static uint8_t pkts_mem[N_KEYS_MAX][PKT_SIZE] __rte_cache_aligned;
+
+static uint64_t
+sync_test_hash(void *key, __rte_unused void *key_mask,
+	__rte_unused uint32_t key_size, __rte_unused uint64_t seed)
+{
+	uint64_t k = *((uint64_t *) key);
+
+	/* The low bits select the bucket, the high bits the signature */
+	return k | (k << 24);
+}
+
+static void
+hash_key_set(__rte_unused struct sync_test_table *tt, uint32_t id,
+	struct sync_test_key *key, uint8_t *pkt_meta)
+{
+	uint64_t k = id + 1;
+
+	memset(key->hash, 0, sizeof(key->hash));
+	memcpy(key->hash, &k, sizeof(k));
+	key->key_delete = key->hash;
+	memcpy(&pkt_meta[HASH_OFFSET - META_OFFSET], key->hash,
+		sizeof(key->hash));
+}
+
+/* Stable prefixes use the low half of each /24, churn ones the high half */
+static uint32_t
+lpm_ip(struct sync_test_table *tt, uint32_t id)
+{
+	uint32_t churn = id >= tt->n_keys_stable;
+	uint32_t pos = churn ? id - tt->n_keys_stable : id;
+
+	return IPv4(10, 0, pos >> 3, (churn << 7) | ((pos & 7) << 4));
+}
+
+static void
+lpm_key_set(struct sync_test_table *tt, uint32_t id,
+	struct sync_test_key *key, uint8_t *pkt_meta)
+{
+	uint32_t ip = lpm_ip(tt, id);
+	uint32_t ip_pkt = rte_cpu_to_be_32(ip + 1);
+
+	key->lpm.ip = ip;
+	key->lpm.depth = 28;
+	key->key_delete = &key->lpm;
+	memcpy(&pkt_meta[LPM_OFFSET - META_OFFSET], &ip_pkt, sizeof(ip_pkt));
+}
+
+static void
+lpm6_key_set(struct sync_test_table *tt, uint32_t id,
+	struct sync_test_key *key, uint8_t *pkt_meta)
+{
+	uint32_t ip = lpm_ip(tt, id);
+	uint8_t *ip_pkt = &pkt_meta[LPM6_OFFSET - META_OFFSET];
+
+	memset(key->lpm6.ip, 0, sizeof(key->lpm6.ip));
+	key->lpm6.ip[0] = 0x20;
+	key->lpm6.ip[1] = 0x01;
+	key->lpm6.ip[2] = 0x0d;
+	key->lpm6.ip[3] = 0xb8;
+	key->lpm6.ip[6] = (uint8_t) (ip >> 8);
+	key->lpm6.ip[7] = (uint8_t) ip;
+	key->lpm6.depth = 60;
+	key->key_delete = &key->lpm6;
+
+	memcpy(ip_pkt, key->lpm6.ip, sizeof(key->lpm6.ip));
+	ip_pkt[15] = 1;
+}
+
+/*
+ * Stable keys only match on the first 8 key bytes, churn keys on all the 16
+ * key bytes and with lower priority, so the two sets use different tuples.
+ */
+static void
+wildcard_key_set(struct sync_test_table *tt, uint32_t id,
+	struct sync_test_key *key, uint8_t *pkt_meta)
+{
+	uint32_t churn = id >= tt->n_keys_stable;
+	uint64_t k = id + 1;
+
+	memset(&key->wildcard_add, 0, sizeof(key->wildcard_add));
+	key->wildcard_add.priority = churn;
+	memcpy(key->wildcard_add.key, &k, sizeof(k));
+	memset(key->wildcard_add.mask, 0xFF, churn ? 16 : 8);
+	memcpy(key->wildcard_delete.key, key->wildcard_add.key,
+		sizeof(key->wildcard_delete.key));
+	memcpy(key->wildcard_delete.mask, key->wildcard_add.mask,
+		sizeof(key->wildcard_delete.mask));
+	key->key_delete = &key->wildcard_delete;
+
+	memset(&pkt_meta[HASH_OFFSET - META_OFFSET], 0, 16);
+	memcpy(&pkt_meta[HASH_OFFSET - META_OFFSET], &k, sizeof(k));
+}
+
+#ifdef RTE_LIBRTE_ACL
+
+struct acl_tuple {
+	uint8_t proto;
+	uint32_t ip_src;
+	uint32_t ip_dst;
+};
+
+enum {
+	ACL_FIELD_PROTO,
+	ACL_FIELD_SRC,
+	ACL_FIELD_DST,
+	ACL_N_FIELDS
+};
+
+static void
+acl_key_set(__rte_unused struct sync_test_table *tt, uint32_t id,
+	struct sync_test_key *key, uint8_t *pkt_meta)
+{
+	struct acl_tuple *t = (struct acl_tuple *) pkt_meta;
+	struct rte_acl_field *f = key->acl_add.field_value;
+	uint32_t ip = IPv4(10, 1, 0, id);
+
+	memset(key, 0, sizeof(*key));
+	key->acl_add.priority = 0;
+	f[ACL_FIELD_PROTO].value.u8 = 0;
+	f[ACL_FIELD_PROTO].mask_range.u8 = 0;
+	f[ACL_FIELD_SRC].value.u32 = ip;
+	f[ACL_FIELD_SRC].mask_range.u32 = 32;
+	f[ACL_FIELD_DST].value.u32 = 0;
+	f[ACL_FIELD_DST].mask_range.u32 = 0;
+	memcpy(key->acl_delete.field_value, f,
+		sizeof(key->acl_delete.field_value));
+	key->key_delete = &key->acl_delete;
+
+	t->proto = 17;
+	t->ip_src = rte_cpu_to_be_32(ip);
+	t->ip_dst = rte_cpu_to_be_32(IPv4(10, 2, 0, 1));
+}
+
+static struct rte_table_acl_params acl_params = {
+	.name = "sync_acl",
+	.n_rules = 2 * N_KEYS_MAX,
+	.n_rule_fields = ACL_N_FIELDS,
+	.field_format = {
+		{
+			.type = RTE_ACL_FIELD_TYPE_BITMASK,
+			.size = sizeof(uint8_t),
+			.field_index = ACL_FIELD_PROTO,
+			.input_index = ACL_FIELD_PROTO,
+			.offset = offsetof(struct acl_tuple, proto),
+		},
+		{
+			.type = RTE_ACL_FIELD_TYPE_MASK,
+			.size = sizeof(uint32_t),
+			.field_index = ACL_FIELD_SRC,
+			.input_index = ACL_FIELD_SRC,
+			.offset = offsetof(struct acl_tuple, ip_src),
+		},
+		{
+			.type = RTE_ACL_FIELD_TYPE_MASK,
+			.size = sizeof(uint32_t),
+			.field_index = ACL_FIELD_DST,
+			.input_index = ACL_FIELD_DST,
+			.offset = offsetof(struct acl_tuple, ip_dst),
+		},
+	},
+};
+
+#endif
+
+#define HASH_PARAMS(key_sz, keys)					\
+{									\
+	.name = "sync_hash",						\
+	.key_size = key_sz,						\
+	.key_offset = HASH_OFFSET,					\
+	.key_mask = NULL,						\
+	.n_keys = keys,							\
+	.n_buckets = HASH_N_BUCKETS,					\
+	.f_hash = sync_test_hash,					\
+	.seed = 0,							\
+}
+
+static struct rte_table_hash_params hash8_lru_params =
+	HASH_PARAMS(8, HASH_N_KEYS_LRU);
+static struct rte_table_hash_params hash8_ext_params =
+	HASH_PARAMS(8, HASH_N_KEYS_EXT);
+static struct rte_table_hash_params hash16_lru_params =
+	HASH_PARAMS(16, HASH_N_KEYS_LRU);
+static struct rte_table_hash_params hash16_ext_params =
+	HASH_PARAMS(16, HASH_N_KEYS_EXT);
+static struct rte_table_hash_params hash32_lru_params =
+	HASH_PARAMS(32, HASH_N_KEYS_LRU);
+static struct rte_table_hash_params hash32_ext_params =
+	HASH_PARAMS(32, HASH_N_KEYS_EXT);
+
+static struct rte_table_lpm_params lpm_params = {
+	.name = "sync_lpm",
+	.n_rules = 2 * N_KEYS_MAX,
+	.number_tbl8s = 64,
+	.flags = 0,
+	.entry_unique_size = sizeof(uint64_t),
+	.offset = LPM_OFFSET,
+};
+
+static struct rte_table_lpm_ipv6_params lpm6_params = {
+	.name = "sync_lpm6",
+	.n_rules = 2 * N_KEYS_MAX,
+	.number_tbl8s = 1 << 12,
+	.entry_unique_size = sizeof(uint64_t),
+	.offset = LPM6_OFFSET,
+	.concurrent_update = 1,
+};
+
+static struct rte_table_wildcard_params wildcard_params = {
+	.name = "sync_wildcard",
+	.key_size = 16,
+	.key_offset = HASH_OFFSET,
+	.n_rules = 2 * N_KEYS_MAX,
+	.n_masks = 2,
+};
+
+/*
+ * LRU tables get two stable keys per bucket, so that the churn keys never
+ * evict them, extendible bucket tables get four, so that the churn keys
+ * always go to chained buckets.
+ */
+#define SYNC_TEST_TABLE(table_name, table_ops, table_params, key_set,	\
+	n_stable, n_updates)						\
+{									\
+	.name = table_name,						\
+	.ops = table_ops,						\
+	.params = table_params,						\
+	.f_key = key_set,						\
+	.n_keys_stable = n_stable,					\
+	.n_updates_min = n_updates,					\
+}
+
+static struct sync_test_table sync_test_tables[] = {
+	SYNC_TEST_TABLE("hash key8 LRU", &rte_table_hash_key8_lru_ops,
+		&hash8_lru_params, hash_key_set, 2 * HASH_N_BUCKETS,
+		N_UPDATES_MIN),
+	SYNC_TEST_TABLE("hash key8 ext", &rte_table_hash_key8_ext_ops,
+		&hash8_ext_params, hash_key_set, 4 * HASH_N_BUCKETS,
+		N_UPDATES_MIN),
+	SYNC_TEST_TABLE("hash key16 LRU", &rte_table_hash_key16_lru_ops,
+		&hash16_lru_params, hash_key_set, 2 * HASH_N_BUCKETS,
+		N_UPDATES_MIN),
+	SYNC_TEST_TABLE("hash key16 ext", &rte_table_hash_key16_ext_ops,
+		&hash16_ext_params, hash_key_set, 4 * HASH_N_BUCKETS,
+		N_UPDATES_MIN),
+	SYNC_TEST_TABLE("hash key32 LRU", &rte_table_hash_key32_lru_ops,
+		&hash32_lru_params, hash_key_set, 2 * HASH_N_BUCKETS,
+		N_UPDATES_MIN),
+	SYNC_TEST_TABLE("hash key32 ext", &rte_table_hash_key32_ext_ops,
+		&hash32_ext_params, hash_key_set, 4 * HASH_N_BUCKETS,
+		N_UPDATES_MIN),
+	SYNC_TEST_TABLE("hash LRU", &rte_table_hash_lru_ops,
+		&hash16_lru_params, hash_key_set, 2 * HASH_N_BUCKETS,
+		N_UPDATES_MIN),
+	SYNC_TEST_TABLE("hash ext", &rte_table_hash_ext_ops,
+		&hash16_ext_params, hash_key_set, 4 * HASH_N_BUCKETS,
+		N_UPDATES_MIN),
+	SYNC_TEST_TABLE("LPM", &rte_table_lpm_ops,
+		&lpm_params, lpm_key_set, N_KEYS_STABLE_MAX,
+		N_UPDATES_MIN),
+	SYNC_TEST_TABLE("LPM IPv6", &rte_table_lpm_ipv6_ops,
+		&lpm6_params, lpm6_key_set, N_KEYS_STABLE_MAX,
+		N_UPDATES_MIN_SLOW),
+	SYNC_TEST_TABLE("wildcard", &rte_table_wildcard_ops,
+		&wildcard_params, wildcard_key_set, N_KEYS_STABLE_MAX,
+		N_UPDATES_MIN),
+#ifdef RTE_LIBRTE_ACL
+	SYNC_TEST_TABLE("ACL", &rte_table_acl_ops,
+		&acl_params, acl_key_set, N_KEYS_STABLE_MAX,
+		N_UPDATES_MIN_SLOW),
+#endif
+};
+
+static inline struct rte_mbuf *
+sync_test_pkt(uint32_t id)
+{
+	return (struct rte_mbuf *) pkts_mem[id];
+}
+
+static int
+sync_test_add(struct sync_test_table *tt, uint32_t id)
+{
+	uint64_t entry = ENTRY_VALUE(id);
+	void *entry_ptr;
+	int key_found;
+
+	return tt->ops->f_add(tt->table, &tt->keys[id], &entry, &key_found,
+		&entry_ptr);
+}
+
+static int
+sync_test_delete(struct sync_test_table *tt, uint32_t id)
+{
+	int key_found, status;
+
+	status = tt->ops->f_delete(tt->table, tt->keys[id].key_delete,
+		&key_found, NULL);
+	if ((status == 0) && (key_found == 0))
+		return -ENOENT;
+
+	return status;
+}
+
+/* Writer lcore: keep a sliding window of two churn keys in the table */
+static int
+sync_test_writer(void *arg)
+{
+	struct sync_test_table *tt = arg;
+	uint32_t i;
+
+	for (i = 0; tt->stop == 0; i++) {
+		uint32_t id = tt->n_keys_stable + (i % N_KEYS_CHURN);
+		uint32_t id_prev = tt->n_keys_stable +
+			((i + N_KEYS_CHURN - 2) % N_KEYS_CHURN);
+		int status;
+
+		status = sync_test_add(tt, id);
+		if ((status == 0) && (i >= 2))
+			status = sync_test_delete(tt, id_prev);
+		if (status != 0) {
+			printf("%s: writer update %" PRIu32 " failed (%d)\n",
+				tt->name, i, status);
+			tt->status = -1;
+			return -1;
+		}
+
+		tt->n_updates++;
+	}
+
+	return 0;
+}
+
+static int
+sync_test_reader(struct sync_test_table *tt, uint64_t *n_bursts)
+{
+	struct rte_mbuf *pkts[BURST_SIZE];
+	uint32_t ids[BURST_SIZE];
+	void *entries[BURST_SIZE];
+	uint64_t timeout, n_churn_hits = 0;
+	uint32_t b, i;
+	int status = 0;
+
+	timeout = rte_get_timer_cycles() + TIMEOUT_S * rte_get_timer_hz();
+
+	for (b = 0; (b < N_BURSTS_MIN) || (tt->n_updates < tt->n_updates_min);
+		b++) {
+		uint64_t hit_mask = 0;
+
+		if (tt->status != 0)
+			return -1;
+
+		if (rte_get_timer_cycles() > timeout) {
+			printf("%s: timeout (%" PRIu64 " updates)\n",
+				tt->name, tt->n_updates);
+			return -1;
+		}
+
+		for (i = 0; i < BURST_SIZE; i++) {
+			if (i < BURST_STABLE)
+				ids[i] = (b * BURST_STABLE + i) %
+					tt->n_keys_stable;
+			else
+				ids[i] = tt->n_keys_stable +
+					((b + i) % N_KEYS_CHURN);
+			pkts[i] = sync_test_pkt(ids[i]);
+		}
+
+		/*
+		 * The read-side section covers the entry checks, so the entry
+		 * of a churn key deleted after the lookup is not reused by the
+		 * writer before its data has been checked.
+		 */
+		tt->ops->f_reader_enter(tt->table);
+		tt->ops->f_lookup(tt->table, pkts, UINT64_MAX, &hit_mask,
+			entries);
+
+		for (i = 0; i < BURST_SIZE; i++) {
+			if (((hit_mask >> i) & 1) == 0) {
+				if (i >= BURST_STABLE)
+					continue;
+
+				printf("%s: burst %" PRIu32 ": stable key %"
+					PRIu32 " not found\n",
+					tt->name, b, ids[i]);
+				status = -1;
+				break;
+			}
+
+			if (*(uint64_t *) entries[i] != ENTRY_VALUE(ids[i])) {
+				printf("%s: burst %" PRIu32 ": key %"
+					PRIu32 " has wrong data\n",
+					tt->name, b, ids[i]);
+				status = -1;
+				break;
+			}
+		}
+		tt->ops->f_reader_exit(tt->table);
+		if (status != 0)
+			return status;
+
+		n_churn_hits += __builtin_popcountll(hit_mask >> BURST_STABLE);
+	}
+
+	printf("%s: %" PRIu32 " bursts, %" PRIu64 " updates, %" PRIu64
+		" churn key hits\n",
+		tt->name, b, tt->n_updates, n_churn_hits);
+	*n_bursts = b;
+	return 0;
+}
+
+static int
+sync_test_run(struct sync_test_table *tt, unsigned int lcore_writer)
+{
+	uint64_t n_bursts = 0;
+	uint32_t id;
+	int status = 0;
+
+	memset(pkts_mem, 0, sizeof(pkts_mem));
+	for (id = 0; id < tt->n_keys_stable + N_KEYS_CHURN; id++) {
+		struct rte_mbuf *m = sync_test_pkt(id);
+
+		tt->f_key(tt, id, &tt->keys[id], &pkts_mem[id][META_OFFSET]);
+		m->buf_addr = &pkts_mem[id][META_OFFSET];
+		m->data_off = 0;
+	}
+
+	tt->table = tt->ops->f_create(tt->params, 0, sizeof(uint64_t));
+	if (tt->table == NULL) {
+		printf("%s: table create failed\n", tt->name);
+		return -1;
+	}
+
+	for (id = 0; id < tt->n_keys_stable; id++)
+		if (sync_test_add(tt, id) != 0) {
+			printf("%s: stable key %" PRIu32 " add failed\n",
+				tt->name, id);
+			tt->ops->f_free(tt->table);
+			return -1;
+		}
+
+	tt->stop = 0;
+	tt->n_updates = 0;
+	tt->status = 0;
+	rte_eal_remote_launch(sync_test_writer, tt, lcore_writer);
+
+	if (sync_test_reader(tt, &n_bursts) != 0)
+		status = -1;
+
+	tt->stop = 1;
+	if (rte_eal_wait_lcore(lcore_writer) != 0)
+		status = -1;
+
+	tt->ops->f_free(tt->table);
+	return status;
+}
+
+static int
+test_table_sync(void)
+{
+	unsigned int lcore_writer;
+	uint32_t i;
+
+	if (rte_lcore_count() < 2) {
+		printf("ERROR: not enough lcores to test table sync\n");
+		return -1;
+	}
+
+	lcore_writer = rte_get_next_lcore(rte_lcore_id(), 1, 0);
+
+	for (i = 0; i < RTE_DIM(sync_test_tables); i++)
+		if (sync_test_run(&sync_test_tables[i], lcore_writer) != 0)
+			return -1;
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(table_sync_autotest, test_table_sync);
@@ -47,6 +47,7 @@ table_test table_tests[] = {
 	test_table_hash_lru,
 	test_table_hash_ext,
 	test_table_hash_cuckoo,
+	test_table_wildcard,
 };
 
 #define PREPARE_PACKET(mbuf, value) do {				\
@@ -1081,3 +1082,217 @@ test_table_hash_cuckoo(void)
 	return 0;
 }
 
+int
+test_table_wildcard(void)
+{
+	int status, i;
+	uint64_t expected_mask = 0, result_mask;
+	struct rte_mbuf *mbufs[RTE_PORT_IN_BURST_SIZE_MAX];
+	void *table;
+	char *entries[RTE_PORT_IN_BURST_SIZE_MAX];
+	char entry;
+	void *entry_ptr;
+	int key_found;
+	uint32_t entry_size = 1;
+	uint32_t value = 0xadadadad;
+
+	/* Initialize params and create tables */
+	struct rte_table_wildcard_params wildcard_params = {
+		.name = "WILDCARD",
+		.key_size = 16,
+		.key_offset = APP_METADATA_OFFSET(32),
+		.n_rules = 1 << 10,
+		.n_masks = 2,
+	};
+
+	table = rte_table_wildcard_ops.f_create(NULL, 0, entry_size);
+	if (table != NULL)
+		return -1;
+
+	wildcard_params.key_size = 12;
+
+	table = rte_table_wildcard_ops.f_create(&wildcard_params, 0,
+		entry_size);
+	if (table != NULL)
+		return -2;
+
+	wildcard_params.key_size = 16;
+	wildcard_params.n_masks = 0;
+
+	table = rte_table_wildcard_ops.f_create(&wildcard_params, 0,
+		entry_size);
+	if (table != NULL)
+		return -3;
+
+	wildcard_params.n_masks = RTE_TABLE_WILDCARD_MASKS_MAX + 1;
+
+	table = rte_table_wildcard_ops.f_create(&wildcard_params, 0,
+		entry_size);
+	if (table != NULL)
+		return -4;
+
+	wildcard_params.n_masks = 2;
+	wildcard_params.n_rules = 0;
+
+	table = rte_table_wildcard_ops.f_create(&wildcard_params, 0,
+		entry_size);
+	if (table != NULL)
+		return -5;
+
+	wildcard_params.n_rules = 1 << 10;
+
+	table = rte_table_wildcard_ops.f_create(&wildcard_params, 0,
+		entry_size);
+	if (table == NULL)
+		return -6;
+
+	/* Free */
+	status = rte_table_wildcard_ops.f_free(table);
+	if (status < 0)
+		return -7;
+
+	status = rte_table_wildcard_ops.f_free(NULL);
+	if (status == 0)
+		return -8;
+
+	/* Add: exact rule for the even packets, wide rule for all packets */
+	struct rte_table_wildcard_rule_add_params exact_rule, wide_rule,
+		other_rule;
+	struct rte_table_wildcard_rule_delete_params wide_delete;
+
+	memset(&exact_rule, 0, sizeof(exact_rule));
+	exact_rule.priority = 1;
+	memcpy(exact_rule.key, &value, sizeof(value));
+	memset(exact_rule.mask, 0xFF, sizeof(value));
+
+	/* Most significant byte of the first key word only */
+	memset(&wide_rule, 0, sizeof(wide_rule));
+	wide_rule.priority = 2;
+	memcpy(wide_rule.key, &value, sizeof(value));
+	memcpy(wide_rule.mask, &(uint32_t){0xFF000000}, sizeof(uint32_t));
+
+	memset(&wide_delete, 0, sizeof(wide_delete));
+	memcpy(wide_delete.key, wide_rule.key, sizeof(wide_delete.key));
+	memcpy(wide_delete.mask, wide_rule.mask, sizeof(wide_delete.mask));
+
+	/* Third distinct mask */
+	memset(&other_rule, 0, sizeof(other_rule));
+	other_rule.priority = 0;
+	memset(other_rule.mask, 0xFF, 16);
+
+	table = rte_table_wildcard_ops.f_create(&wildcard_params, 0,
+		entry_size);
+	if (table == NULL)
+		return -9;
+
+	entry = 'A';
+	status = rte_table_wildcard_ops.f_add(NULL, &exact_rule, &entry,
+		&key_found, &entry_ptr);
+	if (status == 0)
+		return -10;
+
+	status = rte_table_wildcard_ops.f_add(table, NULL, &entry,
+		&key_found, &entry_ptr);
+	if (status == 0)
+		return -11;
+
+	status = rte_table_wildcard_ops.f_add(table, &exact_rule, NULL,
+		&key_found, &entry_ptr);
+	if (status == 0)
+		return -12;
+
+	status = rte_table_wildcard_ops.f_add(table, &exact_rule, &entry,
+		&key_found, &entry_ptr);
+	if ((status != 0) || (key_found != 0))
+		return -13;
+
+	entry = 'B';
+	status = rte_table_wildcard_ops.f_add(table, &wide_rule, &entry,
+		&key_found, &entry_ptr);
+	if ((status != 0) || (key_found != 0))
+		return -14;
+
+	status = rte_table_wildcard_ops.f_add(table, &other_rule, &entry,
+		&key_found, &entry_ptr);
+	if (status != -ENOSPC)
+		return -15;
+
+	/* Traffic flow */
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		if (i % 2 == 0)
+			PREPARE_PACKET(mbufs[i], 0xadadadad);
+		else
+			PREPARE_PACKET(mbufs[i], 0xadadadab);
+
+	rte_table_wildcard_ops.f_lookup(table, mbufs, -1,
+		&result_mask, (void **)entries);
+	if (result_mask != UINT64_MAX)
+		return -16;
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		if (*entries[i] != ((i % 2 == 0) ? 'A' : 'B'))
+			return -17;
+
+	/* Wide rule priority raised over the exact rule */
+	wide_rule.priority = 0;
+	status = rte_table_wildcard_ops.f_add(table, &wide_rule, &entry,
+		&key_found, &entry_ptr);
+	if ((status != 0) || (key_found != 1))
+		return -18;
+
+	rte_table_wildcard_ops.f_lookup(table, mbufs, -1,
+		&result_mask, (void **)entries);
+	if (result_mask != UINT64_MAX)
+		return -19;
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		if (*entries[i] != 'B')
+			return -20;
+
+	/* Delete */
+	status = rte_table_wildcard_ops.f_delete(NULL, &wide_delete,
+		&key_found, NULL);
+	if (status == 0)
+		return -21;
+
+	status = rte_table_wildcard_ops.f_delete(table, NULL,
+		&key_found, NULL);
+	if (status == 0)
+		return -22;
+
+	status = rte_table_wildcard_ops.f_delete(table, &wide_delete,
+		&key_found, &entry);
+	if ((status != 0) || (key_found != 1) || (entry != 'B'))
+		return -23;
+
+	status = rte_table_wildcard_ops.f_delete(table, &wide_delete,
+		&key_found, NULL);
+	if ((status != 0) || (key_found != 0))
+		return -24;
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i += 2)
+		expected_mask |= (uint64_t)1 << i;
+
+	rte_table_wildcard_ops.f_lookup(table, mbufs, -1,
+		&result_mask, (void **)entries);
+	if (result_mask != expected_mask)
+		return -25;
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i += 2)
+		if (*entries[i] != 'A')
+			return -26;
+
+	/* The mask of the deleted rule is available again */
+	status = rte_table_wildcard_ops.f_add(table, &other_rule, &entry,
+		&key_found, &entry_ptr);
+	if ((status != 0) || (key_found != 0))
+		return -27;
+
+	/* Free resources */
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		rte_pktmbuf_free(mbufs[i]);
+
+	status = rte_table_wildcard_ops.f_free(table);
+
+	return 0;
+}
@@ -43,6 +43,7 @@ int test_table_hash_unoptimized(void);
 int test_table_hash_lru(void);
 int test_table_hash_ext(void);
 int test_table_stub(void);
+int test_table_wildcard(void);
 
 /* Extern variables */
 typedef int (*table_test)(void);